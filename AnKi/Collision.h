@@ -15,5 +15,7 @@
 #include <AnKi/Collision/Cone.h>
 
 #include <AnKi/Collision/Functions.h>
+#include <AnKi/Collision/BatchCulling.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 /// @defgroup collision Collision detection module
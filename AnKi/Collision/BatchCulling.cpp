@@ -0,0 +1,219 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Collision/BatchCulling.h>
+#include <AnKi/Util/ThreadJobManager.h>
+
+namespace anki {
+
+namespace {
+
+constexpr U32 kMaxPlanesPerPass = 8;
+
+/// A plane prepared for a batch of shapes. For AABBs the components point to the corner that is the furthest along the normal.
+class BatchPlane
+{
+public:
+	Array<F32, 3> m_normal;
+	Array<const F32*, 3> m_components;
+	F32 m_offset;
+};
+
+/// Everything the tasks need to cull a batch. Spheres use the centers as both the min and max.
+class BatchContext
+{
+public:
+	ConstWeakArray<Plane> m_planes;
+	Array<const F32*, 3> m_min;
+	Array<const F32*, 3> m_max;
+	const F32* m_radius = nullptr;
+	U32 m_count = 0;
+	U64* m_insideMask = nullptr;
+};
+
+} // end namespace
+
+#if ANKI_SIMD_NEON
+static U32 neonMoveMask(uint32x4_t mask)
+{
+	const uint32x4_t bits = {1, 2, 4, 8};
+	return vaddvq_u32(vandq_u32(mask, bits));
+}
+#endif
+
+/// Cull the shapes of some U64 words of the mask.
+template<Bool kSpheres>
+static void testPlanesRange(const BatchContext& ctx, U32 firstWord, U32 endWord)
+{
+	for(U32 wordIdx = firstWord; wordIdx < endWord; ++wordIdx)
+	{
+		const U32 begin = wordIdx * 64;
+		const U32 end = min(begin + 64, ctx.m_count);
+		U64 word = (end - begin == 64) ? kMaxU64 : ((1_U64 << (end - begin)) - 1);
+
+		for(U32 firstPlane = 0; firstPlane < ctx.m_planes.getSize() && word; firstPlane += kMaxPlanesPerPass)
+		{
+			const U32 planeCount = min(ctx.m_planes.getSize() - firstPlane, kMaxPlanesPerPass);
+			Array<BatchPlane, kMaxPlanesPerPass> planes;
+			for(U32 p = 0; p < planeCount; ++p)
+			{
+				const Plane& plane = ctx.m_planes[firstPlane + p];
+				for(U32 c = 0; c < 3; ++c)
+				{
+					planes[p].m_normal[c] = plane.getNormal()[c];
+					planes[p].m_components[c] = (plane.getNormal()[c] >= 0.0f) ? ctx.m_max[c] : ctx.m_min[c];
+				}
+				planes[p].m_offset = plane.getOffset();
+			}
+
+			U32 i = begin;
+#if ANKI_SIMD_SSE || ANKI_SIMD_NEON
+			for(; i + 4 <= end; i += 4)
+			{
+				const U32 shift = i - begin;
+				if(((word >> shift) & 0xF) == 0)
+				{
+					continue;
+				}
+
+				U32 outsideBits = 0;
+				for(U32 p = 0; p < planeCount && outsideBits != 0xF; ++p)
+				{
+					const BatchPlane& plane = planes[p];
+#	if ANKI_SIMD_SSE
+					__m128 dist = _mm_mul_ps(_mm_set1_ps(plane.m_normal[0]), _mm_loadu_ps(plane.m_components[0] + i));
+					dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.m_normal[1]), _mm_loadu_ps(plane.m_components[1] + i)));
+					dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.m_normal[2]), _mm_loadu_ps(plane.m_components[2] + i)));
+					dist = _mm_sub_ps(dist, _mm_set1_ps(plane.m_offset));
+					if constexpr(kSpheres)
+					{
+						dist = _mm_add_ps(dist, _mm_loadu_ps(ctx.m_radius + i));
+					}
+
+					outsideBits |= U32(_mm_movemask_ps(_mm_cmplt_ps(dist, _mm_setzero_ps())));
+#	else
+					float32x4_t dist = vmulq_n_f32(vld1q_f32(plane.m_components[0] + i), plane.m_normal[0]);
+					dist = vaddq_f32(dist, vmulq_n_f32(vld1q_f32(plane.m_components[1] + i), plane.m_normal[1]));
+					dist = vaddq_f32(dist, vmulq_n_f32(vld1q_f32(plane.m_components[2] + i), plane.m_normal[2]));
+					dist = vsubq_f32(dist, vdupq_n_f32(plane.m_offset));
+					if constexpr(kSpheres)
+					{
+						dist = vaddq_f32(dist, vld1q_f32(ctx.m_radius + i));
+					}
+
+					outsideBits |= neonMoveMask(vcltq_f32(dist, vdupq_n_f32(0.0f)));
+#	endif
+				}
+
+				word &= ~(U64(outsideBits) << shift);
+			}
+#endif
+
+			// Remainder or the whole thing if there is no SIMD
+			for(; i < end; ++i)
+			{
+				const U64 bit = 1_U64 << (i - begin);
+				if(!(word & bit))
+				{
+					continue;
+				}
+
+				for(U32 p = 0; p < planeCount; ++p)
+				{
+					const BatchPlane& plane = planes[p];
+					F32 dist = plane.m_normal[0] * plane.m_components[0][i] + plane.m_normal[1] * plane.m_components[1][i]
+							   + plane.m_normal[2] * plane.m_components[2][i] - plane.m_offset;
+					if constexpr(kSpheres)
+					{
+						dist += ctx.m_radius[i];
+					}
+
+					if(dist < 0.0f)
+					{
+						word &= ~bit;
+						break;
+					}
+				}
+			}
+		}
+
+		ctx.m_insideMask[wordIdx] = word;
+	}
+}
+
+template<Bool kSpheres>
+static void testPlanesParallel(const BatchContext& ctx, ThreadJobManager& jobManager)
+{
+	// Every task writes whole words of the mask so there is no need for atomics. Don't make the tasks too small or dispatching will cost more than
+	// culling
+	constexpr U32 kMinWordsPerTask = 16;
+	const U32 wordCount = getBatchCullingMaskWordCount(ctx.m_count);
+	const U32 wordsPerTask = max(kMinWordsPerTask, (wordCount + jobManager.getThreadCount() - 1) / jobManager.getThreadCount());
+
+	if(wordsPerTask >= wordCount)
+	{
+		testPlanesRange<kSpheres>(ctx, 0, wordCount);
+		return;
+	}
+
+	for(U32 firstWord = 0; firstWord < wordCount; firstWord += wordsPerTask)
+	{
+		const U32 endWord = min(firstWord + wordsPerTask, wordCount);
+		jobManager.dispatchTask([&ctx, firstWord, endWord]([[maybe_unused]] U32 tid) {
+			testPlanesRange<kSpheres>(ctx, firstWord, endWord);
+		});
+	}
+
+	jobManager.waitForAllTasksToFinish();
+}
+
+static BatchContext makeBatchContext(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> insideMask)
+{
+	ANKI_ASSERT(insideMask.getSize() >= getBatchCullingMaskWordCount(aabbs.m_count));
+	BatchContext ctx;
+	ctx.m_planes = planes;
+	ctx.m_min = aabbs.m_min;
+	ctx.m_max = aabbs.m_max;
+	ctx.m_count = aabbs.m_count;
+	ctx.m_insideMask = insideMask.getBegin();
+	return ctx;
+}
+
+static BatchContext makeBatchContext(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> insideMask)
+{
+	ANKI_ASSERT(insideMask.getSize() >= getBatchCullingMaskWordCount(spheres.m_count));
+	BatchContext ctx;
+	ctx.m_planes = planes;
+	ctx.m_min = spheres.m_center;
+	ctx.m_max = spheres.m_center;
+	ctx.m_radius = spheres.m_radius;
+	ctx.m_count = spheres.m_count;
+	ctx.m_insideMask = insideMask.getBegin();
+	return ctx;
+}
+
+void testPlanes(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> insideMask)
+{
+	const BatchContext ctx = makeBatchContext(planes, aabbs, insideMask);
+	testPlanesRange<false>(ctx, 0, getBatchCullingMaskWordCount(ctx.m_count));
+}
+
+void testPlanes(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> insideMask)
+{
+	const BatchContext ctx = makeBatchContext(planes, spheres, insideMask);
+	testPlanesRange<true>(ctx, 0, getBatchCullingMaskWordCount(ctx.m_count));
+}
+
+void testPlanes(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> insideMask, ThreadJobManager& jobManager)
+{
+	testPlanesParallel<false>(makeBatchContext(planes, aabbs, insideMask), jobManager);
+}
+
+void testPlanes(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> insideMask, ThreadJobManager& jobManager)
+{
+	testPlanesParallel<true>(makeBatchContext(planes, spheres, insideMask), jobManager);
+}
+
+} // end namespace anki
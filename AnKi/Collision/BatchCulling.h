@@ -0,0 +1,57 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Collision/Plane.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup collision
+/// @{
+
+/// A number of AABBs in structure of arrays layout. It doesn't own the memory.
+class AabbSoa
+{
+public:
+	Array<const F32*, 3> m_min = {}; ///< The X, Y and Z components of the min corners.
+	Array<const F32*, 3> m_max = {}; ///< The X, Y and Z components of the max corners.
+	U32 m_count = 0;
+};
+
+/// A number of spheres in structure of arrays layout. It doesn't own the memory.
+class SphereSoa
+{
+public:
+	Array<const F32*, 3> m_center = {}; ///< The X, Y and Z components of the centers.
+	const F32* m_radius = nullptr;
+	U32 m_count = 0;
+};
+
+/// Get the number of U64 words that hold the bitmask of a batch of shapes.
+inline constexpr U32 getBatchCullingMaskWordCount(U32 shapeCount)
+{
+	return (shapeCount + 63) / 64;
+}
+
+/// Test a batch of AABBs against a number of planes. Bit i of the mask is set if the i-th AABB is not behind any of the planes. The results are the
+/// same as testing testPlane(plane, aabb) >= 0.0f for all planes.
+/// @param planes The planes. Typically the planes of a frustum.
+/// @param aabbs The AABBs.
+/// @param[out] insideMask The output mask. It should have at least getBatchCullingMaskWordCount() elements.
+void testPlanes(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> insideMask);
+
+/// @copydoc testPlanes(ConstWeakArray<Plane>, const AabbSoa&, WeakArray<U64>)
+void testPlanes(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> insideMask);
+
+/// Same as testPlanes(ConstWeakArray<Plane>, const AabbSoa&, WeakArray<U64>) but it splits the batch into tasks and waits for them to finish.
+void testPlanes(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> insideMask, ThreadJobManager& jobManager);
+
+/// @copydoc testPlanes(ConstWeakArray<Plane>, const AabbSoa&, WeakArray<U64>, ThreadJobManager&)
+void testPlanes(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> insideMask, ThreadJobManager& jobManager);
+/// @}
+
+} // end namespace anki
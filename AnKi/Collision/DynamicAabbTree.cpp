@@ -0,0 +1,556 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Collision/DynamicAabbTree.h>
+#include <AnKi/Util/ThreadJobManager.h>
+
+namespace anki {
+
+static F32 computeSurfaceArea(const Vec4& min, const Vec4& max)
+{
+	const Vec4 d = max - min;
+	return 2.0f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+static F32 computeUnionSurfaceArea(const Vec4& minA, const Vec4& maxA, const Vec4& minB, const Vec4& maxB)
+{
+	return computeSurfaceArea(minA.min(minB), maxA.max(maxB));
+}
+
+DynamicAabbTreeProxy::~DynamicAabbTreeProxy()
+{
+	if(m_tree)
+	{
+		m_tree->removeProxy(*this);
+	}
+}
+
+DynamicAabbTree::DynamicAabbTree(BaseMemoryPool* pool, F32 fatMargin)
+	: m_nodes(pool)
+	, m_fatMargin(fatMargin)
+	, m_pendingProxies(pool)
+	, m_nodesToVisit(pool)
+	, m_nodesToVisitCosts(pool)
+{
+	ANKI_ASSERT(fatMargin >= 0.0f);
+}
+
+DynamicAabbTree::~DynamicAabbTree()
+{
+	// Detach the proxies that outlive the tree
+	for(Node& node : m_nodes)
+	{
+		if(node.m_height == 0)
+		{
+			node.m_proxy->m_leaf = kMaxU32;
+			node.m_proxy->m_tree = nullptr;
+		}
+	}
+
+	for(U32 i = 0; i < m_pendingProxyCount; ++i)
+	{
+		m_pendingProxies[i]->m_pending.setNonAtomically(0);
+		m_pendingProxies[i]->m_tree = nullptr;
+	}
+}
+
+void DynamicAabbTree::updateProxy(DynamicAabbTreeProxy& proxy, const Aabb& aabb)
+{
+	ANKI_ASSERT(proxy.m_tree == nullptr || proxy.m_tree == this);
+	proxy.m_min = aabb.getMin();
+	proxy.m_max = aabb.getMax();
+	proxy.m_tree = this;
+
+	if(proxy.m_pending.exchange(1) == 0)
+	{
+		LockGuard lock(m_pendingProxiesMtx);
+
+		if(m_pendingProxyCount == m_pendingProxies.getSize())
+		{
+			m_pendingProxies.resize(m_pendingProxies.getSize() * 2 + 64, nullptr);
+		}
+
+		m_pendingProxies[m_pendingProxyCount++] = &proxy;
+	}
+}
+
+void DynamicAabbTree::removeProxy(DynamicAabbTreeProxy& proxy)
+{
+	ANKI_ASSERT(proxy.m_tree == this);
+
+	if(proxy.m_pending.load())
+	{
+		LockGuard lock(m_pendingProxiesMtx);
+
+		for(U32 i = 0; i < m_pendingProxyCount; ++i)
+		{
+			if(m_pendingProxies[i] == &proxy)
+			{
+				m_pendingProxies[i] = m_pendingProxies[--m_pendingProxyCount];
+				break;
+			}
+		}
+
+		proxy.m_pending.store(0);
+	}
+
+	if(proxy.m_leaf != kMaxU32)
+	{
+		removeLeaf(proxy.m_leaf);
+		freeNode(proxy.m_leaf);
+		proxy.m_leaf = kMaxU32;
+		--m_leafCount;
+	}
+
+	proxy.m_tree = nullptr;
+}
+
+void DynamicAabbTree::update(ThreadJobManager* jobManager)
+{
+	// Insert the new proxies and gather the ones that escaped their fat AABBs
+	DynamicArray<U32, PoolWrapper> escapedLeaves(m_nodes.getMemoryPool());
+	for(U32 i = 0; i < m_pendingProxyCount; ++i)
+	{
+		DynamicAabbTreeProxy& proxy = *m_pendingProxies[i];
+		proxy.m_pending.setNonAtomically(0);
+
+		if(proxy.m_leaf == kMaxU32)
+		{
+			const U32 leaf = allocateNode();
+			m_nodes[leaf].m_proxy = &proxy;
+			setFatAabb(m_nodes[leaf], proxy);
+			proxy.m_leaf = leaf;
+			insertLeaf(leaf);
+			++m_leafCount;
+		}
+		else
+		{
+			const Node& leaf = m_nodes[proxy.m_leaf];
+			if(!(proxy.m_min >= leaf.m_min && proxy.m_max <= leaf.m_max))
+			{
+				escapedLeaves.emplaceBack(proxy.m_leaf);
+			}
+		}
+	}
+
+	m_pendingProxyCount = 0;
+
+	if(escapedLeaves.getSize() == 0)
+	{
+		return;
+	}
+
+	// Too many to re-insert, refit some of them. Do that first because the re-insertions need valid bounds
+	const U32 reinsertCount = min(escapedLeaves.getSize(), m_maxReinsertsPerUpdate);
+	if(escapedLeaves.getSize() > reinsertCount)
+	{
+		refitEscapedLeaves(ConstWeakArray<U32>(&escapedLeaves[reinsertCount], escapedLeaves.getSize() - reinsertCount), jobManager);
+	}
+
+	for(U32 i = 0; i < reinsertCount; ++i)
+	{
+		const U32 leaf = escapedLeaves[i];
+		removeLeaf(leaf);
+		setFatAabb(m_nodes[leaf], *m_nodes[leaf].m_proxy);
+		insertLeaf(leaf);
+	}
+}
+
+void DynamicAabbTree::refitEscapedLeaves(ConstWeakArray<U32> leaves, ThreadJobManager* jobManager)
+{
+	// Update the leaves and gather their ancestors once
+	++m_refitStamp;
+	if(m_refitStamp == 0) [[unlikely]]
+	{
+		for(Node& node : m_nodes)
+		{
+			node.m_refitStamp = 0;
+		}
+		m_refitStamp = 1;
+	}
+
+	DynamicArray<U32, PoolWrapper> nodes(m_nodes.getMemoryPool());
+	for(U32 leaf : leaves)
+	{
+		setFatAabb(m_nodes[leaf], *m_nodes[leaf].m_proxy);
+
+		U32 idx = m_nodes[leaf].m_parent;
+		while(idx != kMaxU32 && m_nodes[idx].m_refitStamp != m_refitStamp)
+		{
+			m_nodes[idx].m_refitStamp = m_refitStamp;
+			nodes.emplaceBack(idx);
+			idx = m_nodes[idx].m_parent;
+		}
+	}
+
+	if(nodes.getSize() == 0)
+	{
+		return;
+	}
+
+	// Sort them by height. A node can be refit when all the nodes with smaller heights are done so the nodes of the same height are independent
+	const U32 maxHeight = m_nodes[m_root].m_height;
+	DynamicArray<U32, PoolWrapper> heightEnds(m_nodes.getMemoryPool());
+	heightEnds.resize(maxHeight + 1, 0);
+	for(U32 idx : nodes)
+	{
+		++heightEnds[m_nodes[idx].m_height];
+	}
+
+	U32 offset = 0;
+	for(U32& count : heightEnds)
+	{
+		const U32 c = count;
+		count = offset;
+		offset += c;
+	}
+
+	DynamicArray<U32, PoolWrapper> sortedNodes(m_nodes.getMemoryPool());
+	sortedNodes.resize(nodes.getSize());
+	for(U32 idx : nodes)
+	{
+		sortedNodes[heightEnds[m_nodes[idx].m_height]++] = idx;
+	}
+
+	// Refit one height at a time. Don't make the tasks too small or dispatching will cost more than refitting
+	constexpr U32 kMinNodesPerTask = 512;
+	for(U32 height = 1; height <= maxHeight; ++height)
+	{
+		const U32 begin = heightEnds[height - 1];
+		const U32 end = heightEnds[height];
+		const U32 count = end - begin;
+
+		if(jobManager && count >= kMinNodesPerTask * 2)
+		{
+			const U32 nodesPerTask = max(kMinNodesPerTask, (count + jobManager->getThreadCount() - 1) / jobManager->getThreadCount());
+			for(U32 first = begin; first < end; first += nodesPerTask)
+			{
+				const U32 last = min(first + nodesPerTask, end);
+				jobManager->dispatchTask([this, &sortedNodes, first, last]([[maybe_unused]] U32 tid) {
+					for(U32 i = first; i < last; ++i)
+					{
+						refitNode(sortedNodes[i]);
+					}
+				});
+			}
+
+			jobManager->waitForAllTasksToFinish();
+		}
+		else
+		{
+			for(U32 i = begin; i < end; ++i)
+			{
+				refitNode(sortedNodes[i]);
+			}
+		}
+	}
+}
+
+U32 DynamicAabbTree::allocateNode()
+{
+	U32 idx;
+	if(m_freeList != kMaxU32)
+	{
+		idx = m_freeList;
+		m_freeList = m_nodes[idx].m_parent;
+	}
+	else
+	{
+		idx = m_nodes.getSize();
+		m_nodes.emplaceBack();
+	}
+
+	Node& node = m_nodes[idx];
+	node.m_parent = kMaxU32;
+	node.m_children = {kMaxU32, kMaxU32};
+	node.m_height = 0;
+	node.m_proxy = nullptr;
+	node.m_refitStamp = 0;
+	return idx;
+}
+
+void DynamicAabbTree::freeNode(U32 idx)
+{
+	Node& node = m_nodes[idx];
+	node.m_height = kMaxU32;
+	node.m_proxy = nullptr;
+	node.m_parent = m_freeList;
+	m_freeList = idx;
+}
+
+void DynamicAabbTree::refitNode(U32 idx)
+{
+	Node& node = m_nodes[idx];
+	const Node& child0 = m_nodes[node.m_children[0]];
+	const Node& child1 = m_nodes[node.m_children[1]];
+	node.m_min = child0.m_min.min(child1.m_min);
+	node.m_max = child0.m_max.max(child1.m_max);
+}
+
+U32 DynamicAabbTree::findBestSibling(const Vec4& min, const Vec4& max)
+{
+	// Branch and bound. The cost of making a node the sibling is the area of the new parent plus the area that the ancestors will grow. The
+	// children of a node can't cost less than the area of the new leaf plus the growth of the node and its ancestors
+	const F32 leafArea = computeSurfaceArea(min, max);
+
+	U32 bestSibling = m_root;
+	F32 bestCost = computeUnionSurfaceArea(m_nodes[m_root].m_min, m_nodes[m_root].m_max, min, max);
+
+	U32 stackSize = 0;
+	auto push = [&](U32 idx, F32 inheritedCost) {
+		if(stackSize == m_nodesToVisit.getSize())
+		{
+			m_nodesToVisit.resize(stackSize * 2 + 64);
+			m_nodesToVisitCosts.resize(stackSize * 2 + 64);
+		}
+
+		m_nodesToVisit[stackSize] = idx;
+		m_nodesToVisitCosts[stackSize] = inheritedCost;
+		++stackSize;
+	};
+
+	push(m_root, 0.0f);
+	while(stackSize)
+	{
+		--stackSize;
+		const Node& node = m_nodes[m_nodesToVisit[stackSize]];
+		const F32 inheritedCost = m_nodesToVisitCosts[stackSize];
+
+		const F32 unionArea = computeUnionSurfaceArea(node.m_min, node.m_max, min, max);
+		const F32 cost = unionArea + inheritedCost;
+		if(cost < bestCost)
+		{
+			bestCost = cost;
+			bestSibling = m_nodesToVisit[stackSize];
+		}
+
+		if(!node.isLeaf())
+		{
+			const F32 childInheritedCost = inheritedCost + unionArea - computeSurfaceArea(node.m_min, node.m_max);
+			if(leafArea + childInheritedCost < bestCost)
+			{
+				push(node.m_children[0], childInheritedCost);
+				push(node.m_children[1], childInheritedCost);
+			}
+		}
+	}
+
+	return bestSibling;
+}
+
+void DynamicAabbTree::insertLeaf(U32 leaf)
+{
+	if(m_root == kMaxU32)
+	{
+		m_root = leaf;
+		m_nodes[leaf].m_parent = kMaxU32;
+		return;
+	}
+
+	const U32 sibling = findBestSibling(m_nodes[leaf].m_min, m_nodes[leaf].m_max);
+	const U32 oldParent = m_nodes[sibling].m_parent;
+
+	const U32 newParent = allocateNode();
+	Node& parent = m_nodes[newParent];
+	parent.m_parent = oldParent;
+	parent.m_children = {sibling, leaf};
+	m_nodes[sibling].m_parent = newParent;
+	m_nodes[leaf].m_parent = newParent;
+
+	if(oldParent == kMaxU32)
+	{
+		m_root = newParent;
+	}
+	else
+	{
+		Node& p = m_nodes[oldParent];
+		p.m_children[(p.m_children[0] == sibling) ? 0 : 1] = newParent;
+	}
+
+	refitAncestors(newParent);
+}
+
+void DynamicAabbTree::removeLeaf(U32 leaf)
+{
+	if(leaf == m_root)
+	{
+		m_root = kMaxU32;
+		return;
+	}
+
+	const U32 parent = m_nodes[leaf].m_parent;
+	const U32 grandParent = m_nodes[parent].m_parent;
+	const U32 sibling = m_nodes[parent].m_children[(m_nodes[parent].m_children[0] == leaf) ? 1 : 0];
+
+	m_nodes[sibling].m_parent = grandParent;
+	m_nodes[leaf].m_parent = kMaxU32;
+	freeNode(parent);
+
+	if(grandParent == kMaxU32)
+	{
+		m_root = sibling;
+	}
+	else
+	{
+		Node& g = m_nodes[grandParent];
+		g.m_children[(g.m_children[0] == parent) ? 0 : 1] = sibling;
+		refitAncestors(grandParent);
+	}
+}
+
+void DynamicAabbTree::refitAncestors(U32 idx)
+{
+	while(idx != kMaxU32)
+	{
+		refitNode(idx);
+		Node& node = m_nodes[idx];
+		node.m_height = 1 + max(m_nodes[node.m_children[0]].m_height, m_nodes[node.m_children[1]].m_height);
+
+		rotate(idx);
+
+		idx = node.m_parent;
+	}
+}
+
+void DynamicAabbTree::rotate(U32 idx)
+{
+	Node& a = m_nodes[idx];
+	if(a.m_height < 2)
+	{
+		return;
+	}
+
+	// Try swapping a child with one of the children of its sibling. Pick the swap that shrinks the surface area of the sibling the most. The
+	// bounds of the node stay the same
+	U32 bestChild = kMaxU32;
+	U32 bestGrandChild = kMaxU32;
+	F32 bestDiff = 0.0f;
+	for(U32 child = 0; child < 2; ++child)
+	{
+		const Node& x = m_nodes[a.m_children[child]];
+		const Node& y = m_nodes[a.m_children[1 - child]];
+		if(y.isLeaf())
+		{
+			continue;
+		}
+
+		const F32 yArea = computeSurfaceArea(y.m_min, y.m_max);
+		for(U32 grandChild = 0; grandChild < 2; ++grandChild)
+		{
+			// Y will have X and the other grand child as children
+			const Node& other = m_nodes[y.m_children[1 - grandChild]];
+			const F32 diff = computeUnionSurfaceArea(x.m_min, x.m_max, other.m_min, other.m_max) - yArea;
+			if(diff < bestDiff)
+			{
+				bestDiff = diff;
+				bestChild = child;
+				bestGrandChild = grandChild;
+			}
+		}
+	}
+
+	if(bestChild == kMaxU32)
+	{
+		return;
+	}
+
+	const U32 xIdx = a.m_children[bestChild];
+	const U32 yIdx = a.m_children[1 - bestChild];
+	Node& y = m_nodes[yIdx];
+	const U32 zIdx = y.m_children[bestGrandChild];
+
+	a.m_children[bestChild] = zIdx;
+	m_nodes[zIdx].m_parent = idx;
+	y.m_children[bestGrandChild] = xIdx;
+	m_nodes[xIdx].m_parent = yIdx;
+
+	refitNode(yIdx);
+	y.m_height = 1 + max(m_nodes[y.m_children[0]].m_height, m_nodes[y.m_children[1]].m_height);
+	a.m_height = 1 + max(m_nodes[a.m_children[0]].m_height, m_nodes[a.m_children[1]].m_height);
+}
+
+F32 DynamicAabbTree::computeSahCost() const
+{
+	if(m_root == kMaxU32 || m_nodes[m_root].isLeaf())
+	{
+		return 0.0f;
+	}
+
+	F32 area = 0.0f;
+	for(const Node& node : m_nodes)
+	{
+		if(node.m_height != kMaxU32 && !node.isLeaf())
+		{
+			area += computeSurfaceArea(node.m_min, node.m_max);
+		}
+	}
+
+	return area / computeSurfaceArea(m_nodes[m_root].m_min, m_nodes[m_root].m_max);
+}
+
+Bool DynamicAabbTree::isValid() const
+{
+	U32 freeCount = 0;
+	for(U32 idx = m_freeList; idx != kMaxU32; idx = m_nodes[idx].m_parent)
+	{
+		if(m_nodes[idx].m_height != kMaxU32)
+		{
+			return false;
+		}
+		++freeCount;
+	}
+
+	if(m_root == kMaxU32)
+	{
+		return m_leafCount == 0 && freeCount == m_nodes.getSize();
+	}
+
+	if(m_nodes[m_root].m_parent != kMaxU32)
+	{
+		return false;
+	}
+
+	U32 leafCount = 0;
+	U32 internalCount = 0;
+	for(U32 idx = 0; idx < m_nodes.getSize(); ++idx)
+	{
+		const Node& node = m_nodes[idx];
+		if(node.m_height == kMaxU32)
+		{
+			continue;
+		}
+
+		if(node.isLeaf())
+		{
+			if(node.m_height != 0 || node.m_proxy == nullptr || node.m_proxy->m_leaf != idx || node.m_proxy->m_tree != this)
+			{
+				return false;
+			}
+			++leafCount;
+			continue;
+		}
+
+		++internalCount;
+		U32 height = 0;
+		for(U32 childIdx : node.m_children)
+		{
+			const Node& child = m_nodes[childIdx];
+			if(child.m_parent != idx || !(child.m_min >= node.m_min && child.m_max <= node.m_max))
+			{
+				return false;
+			}
+			height = max(height, child.m_height + 1);
+		}
+
+		if(height != node.m_height)
+		{
+			return false;
+		}
+	}
+
+	return leafCount == m_leafCount && internalCount + 1 == leafCount && leafCount + internalCount + freeCount == m_nodes.getSize();
+}
+
+} // end namespace anki
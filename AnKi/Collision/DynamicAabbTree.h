@@ -0,0 +1,453 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/Sphere.h>
+#include <AnKi/Collision/Plane.h>
+#include <AnKi/Collision/Ray.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Atomic.h>
+
+namespace anki {
+
+// Forward
+class DynamicAabbTree;
+
+/// @addtogroup collision
+/// @{
+
+/// An object in a DynamicAabbTree. The users of the tree embed it in their objects. It removes itself from the tree when destroyed.
+class DynamicAabbTreeProxy
+{
+	friend class DynamicAabbTree;
+
+public:
+	void* m_userData = nullptr; ///< Passed to the query callbacks.
+
+	DynamicAabbTreeProxy() = default;
+
+	DynamicAabbTreeProxy(const DynamicAabbTreeProxy&) = delete; // Non-copyable
+
+	~DynamicAabbTreeProxy();
+
+	DynamicAabbTreeProxy& operator=(const DynamicAabbTreeProxy&) = delete; // Non-copyable
+
+	/// The latest AABB given to DynamicAabbTree::updateProxy().
+	Aabb getAabb() const
+	{
+		return Aabb(m_min, m_max);
+	}
+
+	/// True if it's in a tree or it will be after the next update.
+	Bool isRegistered() const
+	{
+		return m_tree != nullptr;
+	}
+
+private:
+	Vec4 m_min = Vec4(0.0f);
+	Vec4 m_max = Vec4(0.0f);
+	DynamicAabbTree* m_tree = nullptr;
+	U32 m_leaf = kMaxU32;
+	Atomic<U32> m_pending = {0};
+};
+
+/// An incremental bounding volume hierarchy of AABBs that supports moving objects. The leaves store enlarged ("fat") AABBs so objects that move a
+/// little don't change the tree. The leaves are inserted using the surface area heuristic and tree rotations keep the tree balanced.
+///
+/// Adding and moving proxies is thread-safe and deferred until update(). Proxies that escaped their fat AABBs are re-inserted if they are few.
+/// If they are many their fat AABBs are recomputed in place and the tree is refit in parallel. The queries see the state of the last update().
+class DynamicAabbTree
+{
+public:
+	/// The max number of shapes in a single pass of the batched queries. The batches are split if they have more.
+	static constexpr U32 kMaxQueriesPerPass = 64;
+
+	/// @param pool The memory pool of the tree.
+	/// @param fatMargin The amount the AABBs of the leaves are enlarged in all directions.
+	DynamicAabbTree(BaseMemoryPool* pool, F32 fatMargin = 0.1f);
+
+	DynamicAabbTree(const DynamicAabbTree&) = delete; // Non-copyable
+
+	~DynamicAabbTree();
+
+	DynamicAabbTree& operator=(const DynamicAabbTree&) = delete; // Non-copyable
+
+	/// Add a proxy to the tree or move it. It will take effect in the next update().
+	/// @note It's thread-safe against other updateProxy() calls.
+	void updateProxy(DynamicAabbTreeProxy& proxy, const Aabb& aabb);
+
+	/// Remove the proxy from the tree immediately.
+	/// @note It's not thread-safe.
+	void removeProxy(DynamicAabbTreeProxy& proxy);
+
+	/// Apply the pending additions and moves.
+	/// @param jobManager If not nullptr it will be used to refit the tree in parallel. The method waits for the tasks to finish.
+	/// @note Call it when no other thread updates proxies or queries the tree.
+	void update(ThreadJobManager* jobManager = nullptr);
+
+	/// The max number of proxies that update() will re-insert. The rest will be refit. Re-inserting produces a better tree but it's serial.
+	void setMaxReinsertsPerUpdate(U32 count)
+	{
+		m_maxReinsertsPerUpdate = count;
+	}
+
+	U32 getProxyCount() const
+	{
+		return m_leafCount;
+	}
+
+	/// The height of the tree. 0 if it's empty or it has a single proxy.
+	U32 getHeight() const
+	{
+		return (m_root != kMaxU32) ? m_nodes[m_root].m_height : 0;
+	}
+
+	/// Sum of the surface areas of the internal nodes divided by the area of the root. A measure of the quality of the tree, lower is better.
+	F32 computeSahCost() const;
+
+	/// Visit the proxies that overlap with some AABBs. The leaves are tested against the AABBs given to updateProxy() so the fat AABBs don't
+	/// produce false positives.
+	/// @param aabbs The AABBs to test.
+	/// @param func A functor with signature void(U32 queryIdx, void* userData). It's called once per overlapping AABB and proxy pair.
+	template<typename TFunc>
+	void queryAabbs(ConstWeakArray<Aabb> aabbs, TFunc func) const;
+
+	/// Visit the proxies that overlap with some spheres.
+	/// @param spheres The spheres to test.
+	/// @param func A functor with signature void(U32 queryIdx, void* userData). It's called once per overlapping sphere and proxy pair.
+	template<typename TFunc>
+	void querySpheres(ConstWeakArray<Sphere> spheres, TFunc func) const;
+
+	/// Visit the proxies that are inside or intersect some convex volumes. A proxy is visited if it's not behind any of the planes of a volume.
+	/// @param frustums The planes of every volume. Typically the 6 planes of a frustum.
+	/// @param func A functor with signature void(U32 queryIdx, void* userData). It's called once per volume and proxy pair.
+	template<typename TFunc>
+	void queryFrustums(ConstWeakArray<ConstWeakArray<Plane>> frustums, TFunc func) const;
+
+	/// Visit the proxies that some rays hit.
+	/// @param rays The rays to test.
+	/// @param maxDistance The max distance of all the rays in units of the ray directions.
+	/// @param func A functor with signature F32(U32 queryIdx, void* userData, F32 distance). Distance is where the ray enters the AABB of the
+	///             proxy. It returns the new max distance of the ray. Return a smaller value to prune the rest of the tree (eg the distance of a
+	///             finer hit), a negative value to stop or the old value to continue.
+	template<typename TFunc>
+	void queryRays(ConstWeakArray<Ray> rays, F32 maxDistance, TFunc func) const;
+
+	/// Single AABB version of queryAabbs(). The func has signature void(void* userData).
+	template<typename TFunc>
+	void queryAabb(const Aabb& aabb, TFunc func) const
+	{
+		queryAabbs(ConstWeakArray<Aabb>(&aabb, 1), [&func]([[maybe_unused]] U32 queryIdx, void* userData) {
+			func(userData);
+		});
+	}
+
+	/// Single sphere version of querySpheres(). The func has signature void(void* userData).
+	template<typename TFunc>
+	void querySphere(const Sphere& sphere, TFunc func) const
+	{
+		querySpheres(ConstWeakArray<Sphere>(&sphere, 1), [&func]([[maybe_unused]] U32 queryIdx, void* userData) {
+			func(userData);
+		});
+	}
+
+	/// Single volume version of queryFrustums(). The func has signature void(void* userData).
+	template<typename TFunc>
+	void queryFrustum(ConstWeakArray<Plane> planes, TFunc func) const
+	{
+		queryFrustums(ConstWeakArray<ConstWeakArray<Plane>>(&planes, 1), [&func]([[maybe_unused]] U32 queryIdx, void* userData) {
+			func(userData);
+		});
+	}
+
+	/// Single ray version of queryRays(). The func has signature F32(void* userData, F32 distance).
+	template<typename TFunc>
+	void queryRay(const Ray& ray, F32 maxDistance, TFunc func) const
+	{
+		queryRays(ConstWeakArray<Ray>(&ray, 1), maxDistance, [&func]([[maybe_unused]] U32 queryIdx, void* userData, F32 distance) {
+			return func(userData, distance);
+		});
+	}
+
+	/// Check the integrity of the tree. Only for testing.
+	ANKI_INTERNAL Bool isValid() const;
+
+private:
+	static constexpr U32 kMaxTraversalStackSize = 128;
+
+	class alignas(16) Node
+	{
+	public:
+		Vec4 m_min; ///< For leaves it's the fat AABB.
+		Vec4 m_max;
+		U32 m_parent; ///< The next free node if the node is free.
+		Array<U32, 2> m_children; ///< kMaxU32 for leaves.
+		U32 m_height; ///< 0 for leaves, kMaxU32 for free nodes.
+		DynamicAabbTreeProxy* m_proxy; ///< Only for leaves.
+		U32 m_refitStamp;
+
+		Bool isLeaf() const
+		{
+			return m_children[0] == kMaxU32;
+		}
+	};
+
+	static_assert(sizeof(Node) == 64, "Keep it a cache line");
+
+	using PoolWrapper = MemoryPoolPtrWrapper<BaseMemoryPool>;
+
+	DynamicArray<Node, PoolWrapper> m_nodes;
+	U32 m_root = kMaxU32;
+	U32 m_freeList = kMaxU32;
+	U32 m_leafCount = 0;
+
+	F32 m_fatMargin;
+	U32 m_maxReinsertsPerUpdate = 1024;
+	U32 m_refitStamp = 0;
+
+	/// Grows but never shrinks to avoid allocations every frame. The first m_pendingProxyCount elements are valid.
+	DynamicArray<DynamicAabbTreeProxy*, PoolWrapper> m_pendingProxies;
+	U32 m_pendingProxyCount = 0;
+	SpinLock m_pendingProxiesMtx;
+
+	// Scratch memory of findBestSibling(). It grows but never shrinks
+	DynamicArray<U32, PoolWrapper> m_nodesToVisit;
+	DynamicArray<F32, PoolWrapper> m_nodesToVisitCosts;
+
+	U32 allocateNode();
+	void freeNode(U32 idx);
+
+	void insertLeaf(U32 leaf);
+	void removeLeaf(U32 leaf);
+	U32 findBestSibling(const Vec4& min, const Vec4& max);
+	void refitAncestors(U32 idx);
+	void rotate(U32 idx);
+	void refitNode(U32 idx);
+	void refitEscapedLeaves(ConstWeakArray<U32> leaves, ThreadJobManager* jobManager);
+
+	void setFatAabb(Node& leaf, const DynamicAabbTreeProxy& proxy) const
+	{
+		leaf.m_min = proxy.m_min - Vec4(m_fatMargin, m_fatMargin, m_fatMargin, 0.0f);
+		leaf.m_max = proxy.m_max + Vec4(m_fatMargin, m_fatMargin, m_fatMargin, 0.0f);
+	}
+
+	/// Traverse the tree for a batch of queries. Each query is a bit in a mask.
+	/// @param nodeTest Signature U64(const Vec4& min, const Vec4& max, U64 mask). Returns the queries of the mask that overlap with the AABB.
+	/// @param leafFunc Signature void(DynamicAabbTreeProxy& proxy, U64 mask). Called for the leaves that overlap with some queries.
+	template<typename TNodeTest, typename TLeafFunc>
+	void traverse(U64 queryMask, TNodeTest nodeTest, TLeafFunc leafFunc) const;
+
+	template<typename TShape, typename TNodeTest, typename TFunc>
+	void batchQuery(ConstWeakArray<TShape> shapes, TNodeTest nodeTest, TFunc func) const;
+
+	static Bool aabbsOverlap(const Vec4& minA, const Vec4& maxA, const Vec4& minB, const Vec4& maxB)
+	{
+#if ANKI_SIMD_SSE
+		const __m128 outside = _mm_or_ps(_mm_cmpgt_ps(minA.getSimd(), maxB.getSimd()), _mm_cmpgt_ps(minB.getSimd(), maxA.getSimd()));
+		return _mm_movemask_ps(outside) == 0;
+#elif ANKI_SIMD_NEON
+		const uint32x4_t outside = vorrq_u32(vcgtq_f32(minA.getSimd(), maxB.getSimd()), vcgtq_f32(minB.getSimd(), maxA.getSimd()));
+		return vmaxvq_u32(outside) == 0;
+#else
+		return minA <= maxB && minB <= maxA;
+#endif
+	}
+};
+
+template<typename TNodeTest, typename TLeafFunc>
+void DynamicAabbTree::traverse(U64 queryMask, TNodeTest nodeTest, TLeafFunc leafFunc) const
+{
+	if(m_root == kMaxU32 || queryMask == 0)
+	{
+		return;
+	}
+
+	// Every visited node pushes at most 2 children so the stack needs to be as big as the height of the tree
+	ANKI_ASSERT(getHeight() < kMaxTraversalStackSize);
+
+	class StackEntry
+	{
+	public:
+		U64 m_mask;
+		U32 m_node;
+	};
+
+	Array<StackEntry, kMaxTraversalStackSize> stack;
+	U32 stackSize = 0;
+	stack[stackSize++] = {queryMask, m_root};
+
+	while(stackSize)
+	{
+		const StackEntry entry = stack[--stackSize];
+		const Node& node = m_nodes[entry.m_node];
+
+		if(node.isLeaf())
+		{
+			// Test the current AABB of the proxy which is tighter
+			const U64 mask = nodeTest(node.m_proxy->m_min, node.m_proxy->m_max, entry.m_mask);
+			if(mask)
+			{
+				leafFunc(*node.m_proxy, mask);
+			}
+		}
+		else
+		{
+			const U64 mask = nodeTest(node.m_min, node.m_max, entry.m_mask);
+			if(mask)
+			{
+				stack[stackSize++] = {mask, node.m_children[1]};
+				stack[stackSize++] = {mask, node.m_children[0]};
+			}
+		}
+	}
+}
+
+template<typename TShape, typename TNodeTest, typename TFunc>
+void DynamicAabbTree::batchQuery(ConstWeakArray<TShape> shapes, TNodeTest nodeTest, TFunc func) const
+{
+	for(U32 first = 0; first < shapes.getSize(); first += kMaxQueriesPerPass)
+	{
+		const U32 count = min(kMaxQueriesPerPass, shapes.getSize() - first);
+		const U64 queryMask = (count == 64) ? kMaxU64 : ((1_U64 << count) - 1);
+
+		traverse(
+			queryMask,
+			[&](const Vec4& min, const Vec4& max, U64 mask) {
+				U64 outMask = 0;
+				while(mask)
+				{
+					const U32 bit = U32(__builtin_ctzll(mask));
+					mask &= mask - 1;
+					if(nodeTest(shapes[first + bit], min, max))
+					{
+						outMask |= 1_U64 << bit;
+					}
+				}
+				return outMask;
+			},
+			[&](const DynamicAabbTreeProxy& proxy, U64 mask) {
+				while(mask)
+				{
+					const U32 bit = U32(__builtin_ctzll(mask));
+					mask &= mask - 1;
+					func(first + bit, proxy.m_userData);
+				}
+			});
+	}
+}
+
+template<typename TFunc>
+void DynamicAabbTree::queryAabbs(ConstWeakArray<Aabb> aabbs, TFunc func) const
+{
+	batchQuery(
+		aabbs,
+		[](const Aabb& aabb, const Vec4& min, const Vec4& max) {
+			return aabbsOverlap(aabb.getMin(), aabb.getMax(), min, max);
+		},
+		func);
+}
+
+template<typename TFunc>
+void DynamicAabbTree::querySpheres(ConstWeakArray<Sphere> spheres, TFunc func) const
+{
+	batchQuery(
+		spheres,
+		[](const Sphere& sphere, const Vec4& min, const Vec4& max) {
+			const Vec4 closest = sphere.getCenter().max(min).min(max);
+			const Vec4 diff = closest - sphere.getCenter();
+			return diff.dot(diff) <= sphere.getRadius() * sphere.getRadius();
+		},
+		func);
+}
+
+template<typename TFunc>
+void DynamicAabbTree::queryFrustums(ConstWeakArray<ConstWeakArray<Plane>> frustums, TFunc func) const
+{
+	batchQuery(
+		frustums,
+		[](ConstWeakArray<Plane> planes, const Vec4& min, const Vec4& max) {
+			const Vec4 center = (min + max) * 0.5f;
+			const Vec4 extend = (max - min) * 0.5f;
+			for(const Plane& plane : planes)
+			{
+				const F32 dist = plane.getNormal().dot(center) - plane.getOffset();
+				const F32 radius = plane.getNormal().abs().dot(extend);
+				if(dist + radius < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		},
+		func);
+}
+
+template<typename TFunc>
+void DynamicAabbTree::queryRays(ConstWeakArray<Ray> rays, F32 maxDistance, TFunc func) const
+{
+	for(U32 first = 0; first < rays.getSize(); first += kMaxQueriesPerPass)
+	{
+		const U32 count = min(kMaxQueriesPerPass, rays.getSize() - first);
+		const U64 queryMask = (count == 64) ? kMaxU64 : ((1_U64 << count) - 1);
+
+		// Precompute the inverse directions. Avoid infinities because 0*inf is NaN
+		Array<Vec4, kMaxQueriesPerPass> invDirs;
+		Array<F32, kMaxQueriesPerPass> maxDistances;
+		for(U32 i = 0; i < count; ++i)
+		{
+			const Vec4& dir = rays[first + i].getDirection();
+			for(U32 c = 0; c < 3; ++c)
+			{
+				invDirs[i][c] = (dir[c] != 0.0f) ? 1.0f / dir[c] : kMaxF32;
+			}
+			invDirs[i].w() = 0.0f;
+			maxDistances[i] = maxDistance;
+		}
+
+		Array<F32, kMaxQueriesPerPass> enterDistances;
+
+		traverse(
+			queryMask,
+			[&](const Vec4& min, const Vec4& max, U64 mask) {
+				U64 outMask = 0;
+				while(mask)
+				{
+					const U32 bit = U32(__builtin_ctzll(mask));
+					mask &= mask - 1;
+
+					const Vec4& origin = rays[first + bit].getOrigin();
+					const Vec4 t0 = (min - origin) * invDirs[bit];
+					const Vec4 t1 = (max - origin) * invDirs[bit];
+					const Vec4 tNear = t0.min(t1);
+					const Vec4 tFar = t0.max(t1);
+					const F32 enter = anki::max(anki::max(tNear.x(), tNear.y()), anki::max(tNear.z(), 0.0f));
+					const F32 exit = anki::min(anki::min(tFar.x(), tFar.y()), tFar.z());
+
+					if(enter <= exit && enter <= maxDistances[bit])
+					{
+						enterDistances[bit] = enter;
+						outMask |= 1_U64 << bit;
+					}
+				}
+				return outMask;
+			},
+			[&](const DynamicAabbTreeProxy& proxy, U64 mask) {
+				while(mask)
+				{
+					const U32 bit = U32(__builtin_ctzll(mask));
+					mask &= mask - 1;
+					maxDistances[bit] = anki::min(maxDistances[bit], F32(func(first + bit, proxy.m_userData, enterDistances[bit])));
+				}
+			});
+	}
+}
+/// @}
+
+} // end namespace anki
@@ -142,13 +142,26 @@
 #	define ANKI_SIMD_NEON 1
 #endif
 
+// AVX2 is optional on top of SSE. It's enabled if the compiler targets it (eg -mavx2 or /arch:AVX2)
+#if ANKI_SIMD_SSE && defined(__AVX2__)
+#	define ANKI_SIMD_AVX2 1
+#else
+#	define ANKI_SIMD_AVX2 0
+#endif
+
 // Graphics backend
 #if ${_ANKI_GR_BACKEND} == 0
 #	define ANKI_GR_BACKEND_VULKAN 1
 #	define ANKI_GR_BACKEND_DIRECT3D 0
-#else
+#	define ANKI_GR_BACKEND_NULL 0
+#elif ${_ANKI_GR_BACKEND} == 1
 #	define ANKI_GR_BACKEND_VULKAN 0
 #	define ANKI_GR_BACKEND_DIRECT3D 1
+#	define ANKI_GR_BACKEND_NULL 0
+#else
+#	define ANKI_GR_BACKEND_VULKAN 0
+#	define ANKI_GR_BACKEND_DIRECT3D 0
+#	define ANKI_GR_BACKEND_NULL 1
 #endif
 
 // Windowing system
@@ -48,6 +48,12 @@ StatCounter g_cpuTotalTimeStatVar(StatCategory::kTime, "CPU total", StatFlag::kM
 static StatCounter g_cpuAllocatedMemStatVar(StatCategory::kCpuMem, "Total", StatFlag::kBytes);
 static StatCounter g_cpuAllocationCountStatVar(StatCategory::kCpuMem, "Allocations/frame", StatFlag::kBytes | StatFlag::kZeroEveryFrame);
 static StatCounter g_cpuFreesCountStatVar(StatCategory::kCpuMem, "Frees/frame", StatFlag::kBytes | StatFlag::kZeroEveryFrame);
+static StatCounter g_frameTimeStatVar(StatCategory::kTime, "Frame time",
+									  StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
+static StatCounter g_frameLatencyStatVar(StatCategory::kTime, "Frame latency",
+										 StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
+static StatCounter g_sceneUpdateWaitStatVar(StatCategory::kTime, "Scene update wait",
+											StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
 
 NumericCVar<U32> g_windowWidthCVar(CVarSubsystem::kCore, "Width", 1920, 16, 16 * 1024, "Width");
 NumericCVar<U32> g_windowHeightCVar(CVarSubsystem::kCore, "Height", 1080, 16, 16 * 1024, "Height");
@@ -63,6 +69,8 @@ BoolCVar g_benchmarkModeCVar(CVarSubsystem::kCore, "BenchmarkMode", false, "Run
 NumericCVar<U32> g_benchmarkModeFrameCountCVar(CVarSubsystem::kCore, "BenchmarkModeFrameCount", 60 * 60 * 2, 1, kMaxU32,
 											   "How many frames the benchmark will run before it quits");
 BoolCVar g_meshletRenderingCVar(CVarSubsystem::kCore, "MeshletRendering", false, "Do meshlet culling and rendering");
+BoolCVar g_pipelinedFramesCVar(CVarSubsystem::kCore, "PipelinedFrames", false,
+							   "Update the scene of the next frame in parallel with the render recording of the current. Adds a frame of latency");
 
 #if ANKI_PLATFORM_MOBILE
 static StatCounter g_maliGpuActiveStatVar(StatCategory::kGpuMisc, "Mali active cycles", StatFlag::kMainThreadUpdates);
@@ -238,6 +246,7 @@ Error App::initInternal()
 #endif
 
 	ANKI_CORE_LOGI("Number of job threads: %u", g_jobThreadCountCVar.get());
+	ANKI_CORE_LOGI("Pipelined frames: %s", (g_pipelinedFramesCVar.get()) ? "on" : "off");
 
 	if(g_benchmarkModeCVar.get() && g_vsyncCVar.get())
 	{
@@ -355,7 +364,7 @@ Error App::initInternal()
 	//
 	// Script
 	//
-	ScriptManager::allocateSingleton(allocCb, allocCbUserData);
+	ScriptManager::allocateSingleton(allocCb, allocCbUserData, m_cacheDir.toCString(), g_jobThreadCountCVar.get());
 
 	//
 	// Scene
@@ -408,6 +417,111 @@ Error App::initDirs()
 	return Error::kNone;
 }
 
+/// Runs SceneGraph::pipelinedUpdate in a dedicated thread. It's not a job of the CoreThreadJobManager because the scene update waits for jobs
+/// itself and the render recording does the same.
+class SceneUpdateThread
+{
+public:
+	SceneUpdateThread(Bool enabled)
+		: m_thread("SceneUpdate")
+		, m_enabled(enabled)
+	{
+		if(m_enabled)
+		{
+			m_thread.start(this, [](ThreadCallbackInfo& info) -> Error {
+				return static_cast<SceneUpdateThread*>(info.m_userData)->threadWorker();
+			});
+		}
+	}
+
+	~SceneUpdateThread()
+	{
+		if(m_enabled)
+		{
+			[[maybe_unused]] Error err = wait();
+
+			{
+				LockGuard<Mutex> lock(m_mtx);
+				m_quit = true;
+				m_cvar.notifyAll();
+			}
+
+			err = m_thread.join();
+		}
+	}
+
+	/// Start updating the scene.
+	void kick(Second prevUpdateTime, Second crntTime)
+	{
+		ANKI_ASSERT(m_enabled);
+		LockGuard<Mutex> lock(m_mtx);
+		ANKI_ASSERT(!m_pending);
+		m_prevUpdateTime = prevUpdateTime;
+		m_crntTime = crntTime;
+		m_pending = true;
+		m_cvar.notifyAll();
+	}
+
+	/// Wait for the update that was kicked to finish.
+	Error wait()
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_pending)
+		{
+			m_cvar.wait(m_mtx);
+		}
+
+		const Error err = m_err;
+		m_err = Error::kNone;
+		return err;
+	}
+
+private:
+	Thread m_thread;
+	Mutex m_mtx;
+	ConditionVariable m_cvar;
+	Second m_prevUpdateTime = 0.0;
+	Second m_crntTime = 0.0;
+	Error m_err = Error::kNone;
+	Bool m_pending = false;
+	Bool m_quit = false;
+	Bool m_enabled = false;
+
+	Error threadWorker()
+	{
+		while(true)
+		{
+			Second prevUpdateTime, crntTime;
+			{
+				LockGuard<Mutex> lock(m_mtx);
+				while(!m_pending && !m_quit)
+				{
+					m_cvar.wait(m_mtx);
+				}
+
+				if(m_quit)
+				{
+					break;
+				}
+
+				prevUpdateTime = m_prevUpdateTime;
+				crntTime = m_crntTime;
+			}
+
+			const Error err = SceneGraph::getSingleton().pipelinedUpdate(prevUpdateTime, crntTime);
+
+			{
+				LockGuard<Mutex> lock(m_mtx);
+				m_err = err;
+				m_pending = false;
+				m_cvar.notifyAll();
+			}
+		}
+
+		return Error::kNone;
+	}
+};
+
 Error App::mainLoop()
 {
 	ANKI_CORE_LOGI("Entering main loop");
@@ -431,26 +545,84 @@ Error App::mainLoop()
 		ANKI_CHECK(benchmarkCsvFile.writeText("CPU, GPU\n"));
 	}
 
+	// With pipelined frames the scene update of the next frame runs in parallel with the recording of the current one. The scene and the
+	// renderer sync in the main thread: The deletions and the handoff to the renderer happen while nothing else is running
+	const Bool pipelined = g_pipelinedFramesCVar.get();
+	SceneUpdateThread sceneUpdateThread(pipelined);
+	Bool firstFrame = true;
+	Second sceneUpdateStartTime = 0.0; // The start of the last scene update
+	Second prevFrameStartTime = 0.0;
+
 	while(!quit)
 	{
 		{
 			ANKI_TRACE_SCOPED_EVENT(Frame);
 			const Second startTime = HighRezTimer::getCurrentTime();
 
-			prevUpdateTime = crntTime;
-			crntTime = (!benchmarkMode) ? HighRezTimer::getCurrentTime() : (prevUpdateTime + 1.0_sec / 60.0_sec);
+			if(!firstFrame)
+			{
+				g_frameTimeStatVar.set((startTime - prevFrameStartTime) * 1000.0);
+			}
+			prevFrameStartTime = startTime;
+
+			Second presentedSceneUpdateStartTime; // The start of the scene update that this frame will present
+			if(!pipelined)
+			{
+				prevUpdateTime = crntTime;
+				crntTime = (!benchmarkMode) ? HighRezTimer::getCurrentTime() : (prevUpdateTime + 1.0_sec / 60.0_sec);
+
+				// Update
+				ANKI_CHECK(Input::getSingleton().handleEvents());
+
+				// User update
+				ANKI_CHECK(userMainLoop(quit, crntTime - prevUpdateTime));
+
+				sceneUpdateStartTime = HighRezTimer::getCurrentTime();
+				presentedSceneUpdateStartTime = sceneUpdateStartTime;
+				ANKI_CHECK(SceneGraph::getSingleton().update(prevUpdateTime, crntTime));
+
+				// Render
+				TexturePtr presentableTex = GrManager::getSingleton().acquireNextPresentableTexture();
+				ANKI_CHECK(MainRenderer::getSingleton().render(presentableTex.get()));
+			}
+			else
+			{
+				if(firstFrame)
+				{
+					// Nothing to overlap with in the 1st frame
+					sceneUpdateStartTime = HighRezTimer::getCurrentTime();
+					ANKI_CHECK(SceneGraph::getSingleton().pipelinedUpdate(prevUpdateTime, crntTime));
+				}
+
+				// At this point the scene is not updating. Do what needs to touch the scene from the main thread
+				ANKI_CHECK(Input::getSingleton().handleEvents());
+				ANKI_CHECK(userMainLoop(quit, crntTime - prevUpdateTime));
 
-			// Update
-			ANKI_CHECK(Input::getSingleton().handleEvents());
+				SceneGraph::getSingleton().deleteMarkedForDeletion();
+				SceneGraph::getSingleton().handoffToRenderer();
 
-			// User update
-			ANKI_CHECK(userMainLoop(quit, crntTime - prevUpdateTime));
+				presentedSceneUpdateStartTime = sceneUpdateStartTime;
+				TexturePtr presentableTex = GrManager::getSingleton().acquireNextPresentableTexture();
+				ANKI_CHECK(MainRenderer::getSingleton().populateRenderGraph(presentableTex.get()));
 
-			ANKI_CHECK(SceneGraph::getSingleton().update(prevUpdateTime, crntTime));
+				// The update that follows belongs to the next frame
+				++GlobalFrameIndex::getSingleton().m_value;
+				if(benchmarkMode && GlobalFrameIndex::getSingleton().m_value >= g_benchmarkModeFrameCountCVar.get()) [[unlikely]]
+				{
+					quit = true;
+				}
+
+				if(!quit)
+				{
+					prevUpdateTime = crntTime;
+					crntTime = (!benchmarkMode) ? HighRezTimer::getCurrentTime() : (prevUpdateTime + 1.0_sec / 60.0_sec);
+
+					sceneUpdateStartTime = HighRezTimer::getCurrentTime();
+					sceneUpdateThread.kick(prevUpdateTime, crntTime);
+				}
 
-			// Render
-			TexturePtr presentableTex = GrManager::getSingleton().acquireNextPresentableTexture();
-			ANKI_CHECK(MainRenderer::getSingleton().render(presentableTex.get()));
+				MainRenderer::getSingleton().recordAndSubmit();
+			}
 
 			// If we get stats exclude the time of GR because it forces some GPU-CPU serialization. We don't want to count that
 			Second grTime = 0.0;
@@ -466,6 +638,16 @@ Error App::mainLoop()
 				grTime = HighRezTimer::getCurrentTime() - grTime;
 			}
 
+			g_frameLatencyStatVar.set((HighRezTimer::getCurrentTime() - presentedSceneUpdateStartTime) * 1000.0);
+
+			if(pipelined)
+			{
+				ANKI_TRACE_SCOPED_EVENT(SceneUpdateWait);
+				const Second waitStartTime = HighRezTimer::getCurrentTime();
+				ANKI_CHECK(sceneUpdateThread.wait());
+				g_sceneUpdateWaitStatVar.set((HighRezTimer::getCurrentTime() - waitStartTime) * 1000.0);
+			}
+
 			RebarTransientMemoryPool::getSingleton().endFrame();
 			UnifiedGeometryBuffer::getSingleton().endFrame();
 			GpuSceneBuffer::getSingleton().endFrame();
@@ -517,15 +699,20 @@ Error App::mainLoop()
 
 			StatsSet::getSingleton().endFrame();
 
-			++GlobalFrameIndex::getSingleton().m_value;
-
-			if(benchmarkMode) [[unlikely]]
+			if(!pipelined)
 			{
-				if(GlobalFrameIndex::getSingleton().m_value >= g_benchmarkModeFrameCountCVar.get())
+				++GlobalFrameIndex::getSingleton().m_value;
+
+				if(benchmarkMode) [[unlikely]]
 				{
-					quit = true;
+					if(GlobalFrameIndex::getSingleton().m_value >= g_benchmarkModeFrameCountCVar.get())
+					{
+						quit = true;
+					}
 				}
 			}
+
+			firstFrame = false;
 		}
 
 #if ANKI_TRACING_ENABLED
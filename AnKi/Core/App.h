@@ -22,6 +22,7 @@ extern NumericCVar<U32> g_windowFullscreenCVar;
 extern NumericCVar<U32> g_targetFpsCVar;
 extern NumericCVar<U32> g_displayStatsCVar;
 extern BoolCVar g_meshletRenderingCVar;
+extern BoolCVar g_pipelinedFramesCVar;
 extern StatCounter g_cpuTotalTimeStatVar;
 extern StatCounter g_rendererGpuTimeStatVar;
 
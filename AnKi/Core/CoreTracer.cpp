@@ -7,11 +7,27 @@
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/System.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Math/Functions.h>
+#if ANKI_TRACING_ENABLED && ANKI_POSIX
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#	include <cerrno>
+#	include <cstring>
+#endif
 
 namespace anki {
 
 BoolCVar g_tracingEnabledCVar(CVarSubsystem::kCore, "Tracing", false, "Enable or disable tracing");
+BoolCVar g_tracingBinaryCVar(CVarSubsystem::kCore, "TracingBinary", false,
+							 "Write the trace in the compact binary format instead of JSON. Use the TraceConverter tool to convert it");
+NumericCVar<U32> g_tracingMemoryBudgetCVar(CVarSubsystem::kCore, "TracingMemoryBudget", 64, 1, 4 * 1024,
+										   "Max MB of trace data waiting to be written. Anything above that will be dropped");
+NumericCVar<U32> g_tracingFileBudgetCVar(CVarSubsystem::kCore, "TracingFileBudget", 2 * 1024, 0, kMaxU32,
+										 "Max MB that will be written to the trace file. 0 means unlimited");
+StringCVar g_tracingStreamSocketCVar(CVarSubsystem::kCore, "TracingStreamSocket", "",
+									 "Path to a local socket of a viewer that will receive the binary trace live");
 #if ANKI_OS_ANDROID
 BoolCVar g_streamlineEnabledCVar(CVarSubsystem::kCore, "StreamlineAnnotations", false, "Enable or disable Streamline annotations");
 #endif
@@ -44,6 +60,17 @@ public:
 	CoreDynamicArray<TracerCounter> m_counters;
 	ThreadId m_tid;
 	U64 m_frame;
+	Second m_flushTime;
+
+	static PtrSize computeSizeInBytes(U32 eventCount, U32 counterCount)
+	{
+		return sizeof(ThreadWorkItem) + eventCount * sizeof(TracerEvent) + counterCount * sizeof(TracerCounter);
+	}
+
+	PtrSize getSizeInBytes() const
+	{
+		return computeSizeInBytes(m_events.getSize(), m_counters.getSize());
+	}
 };
 
 class CoreTracer::PerFrameCounters : public IntrusiveListEnabled<PerFrameCounters>
@@ -53,8 +80,33 @@ public:
 	U64 m_frame;
 };
 
+/// Sort and merge counters with the same name.
+static void mergeCounters(CoreDynamicArray<TracerCounter>& counters, CoreDynamicArray<TracerCounter>& mergedCounters)
+{
+	// Sort
+	std::sort(counters.getBegin(), counters.getEnd(), [](const TracerCounter& a, const TracerCounter& b) {
+		return a.m_name < b.m_name;
+	});
+
+	// Merge same
+	for(U32 i = 0; i < counters.getSize(); ++i)
+	{
+		if(mergedCounters.getSize() == 0 || mergedCounters.getBack().m_name != counters[i].m_name)
+		{
+			// New
+			mergedCounters.emplaceBack(counters[i]);
+		}
+		else
+		{
+			// Merge
+			mergedCounters.getBack().m_value += counters[i].m_value;
+		}
+	}
+}
+
 CoreTracer::CoreTracer()
 	: m_thread("Tracer")
+	, m_binaryWriter(&CoreMemoryPool::getSingleton())
 {
 }
 
@@ -74,6 +126,16 @@ CoreTracer::~CoreTracer()
 		err = m_traceJsonFile.writeText("{}\n]\n");
 	}
 
+	disconnectStream();
+
+	m_totalDroppedEventCount += m_droppedEventCount;
+	m_totalDroppedCounterCount += m_droppedCounterCount;
+	if(m_totalDroppedEventCount || m_totalDroppedCounterCount)
+	{
+		ANKI_CORE_LOGW("Tracer dropped %" PRIu64 " events and %" PRIu64 " counters because of the memory or file budgets", m_totalDroppedEventCount,
+					   m_totalDroppedCounterCount);
+	}
+
 	// Write counter file
 	err = writeCountersOnShutdown();
 
@@ -118,8 +180,16 @@ Error CoreTracer::init(CString directory)
 	fname.sprintf("%s/%d%02d%02d-%02d%02d_", directory.cstr(), tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min);
 
 	m_traceJsonFilename.sprintf("%strace.json", fname.cstr());
+	m_traceBinaryFilename.sprintf("%strace.ankitrace", fname.cstr());
 	m_countersCsvFilename.sprintf("%scounters.csv", fname.cstr());
 
+	m_binaryFormat = g_tracingBinaryCVar.get();
+
+	if(g_tracingStreamSocketCVar.get() != CString())
+	{
+		connectStream(g_tracingStreamSocketCVar.get());
+	}
+
 	return Error::kNone;
 }
 
@@ -131,6 +201,8 @@ Error CoreTracer::threadWorker()
 	while(!err && !quit)
 	{
 		ThreadWorkItem* item = nullptr;
+		U64 droppedEventCount = 0;
+		U64 droppedCounterCount = 0;
 
 		// Get some work
 		{
@@ -145,6 +217,13 @@ Error CoreTracer::threadWorker()
 			if(!m_workItems.isEmpty())
 			{
 				item = m_workItems.popFront();
+				ANKI_ASSERT(m_workItemsSizeInBytes >= item->getSizeInBytes());
+				m_workItemsSizeInBytes -= item->getSizeInBytes();
+
+				droppedEventCount = m_droppedEventCount;
+				droppedCounterCount = m_droppedCounterCount;
+				m_droppedEventCount = 0;
+				m_droppedCounterCount = 0;
 			}
 			else if(m_quit)
 			{
@@ -155,11 +234,25 @@ Error CoreTracer::threadWorker()
 		// Do some work using the frame and delete it
 		if(item)
 		{
-			err = writeEvents(*item);
+			m_totalDroppedEventCount += droppedEventCount;
+			m_totalDroppedCounterCount += droppedCounterCount;
+
+			if(m_binaryFormat || isStreaming())
+			{
+				err = writeBinary(*item, droppedEventCount, droppedCounterCount);
+			}
 
-			if(!err)
+			if(!m_binaryFormat)
 			{
-				gatherCounters(*item);
+				if(!err)
+				{
+					err = writeEvents(*item);
+				}
+
+				if(!err)
+				{
+					gatherCounters(*item);
+				}
 			}
 
 			deleteInstance(CoreMemoryPool::getSingleton(), item);
@@ -191,6 +284,14 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 	// Write events
 	for(const TracerEvent& event : item.m_events)
 	{
+		// A JSON line is roughly that big
+		constexpr PtrSize kApproxEventJsonSize = 128;
+		if(!checkFileBudget(kApproxEventJsonSize))
+		{
+			++m_totalDroppedEventCount;
+			continue;
+		}
+
 		const I64 startMicroSec = I64(event.m_start * 1000000.0);
 		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
 
@@ -208,28 +309,77 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 	return Error::kNone;
 }
 
-void CoreTracer::gatherCounters(ThreadWorkItem& item)
+Error CoreTracer::writeBinary(ThreadWorkItem& item, U64 droppedEventCount, U64 droppedCounterCount)
 {
-	// Sort
-	std::sort(item.m_counters.getBegin(), item.m_counters.getEnd(), [](const TracerCounter& a, const TracerCounter& b) {
-		return a.m_name < b.m_name;
+	if(m_binaryFormat && !m_traceBinaryFile.isOpen())
+	{
+		ANKI_CHECK(m_traceBinaryFile.open(m_traceBinaryFilename, FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		ANKI_CORE_LOGI("Trace file created: %s", m_traceBinaryFilename.cstr());
+	}
+
+	if(!m_binaryHeaderWritten)
+	{
+		// The file and the stream share the same header
+		m_binaryWriter.writeHeader();
+		m_binaryHeaderWritten = true;
+	}
+
+	if(droppedEventCount || droppedCounterCount)
+	{
+		m_binaryWriter.writeDropped(item.m_frame, droppedEventCount, droppedCounterCount);
+	}
+
+	// Sort them for a better delta encoding and move the GPU events to their own block (same hack as the JSON)
+	auto gpuEventsBegin = std::partition(item.m_events.getBegin(), item.m_events.getEnd(), [](const TracerEvent& e) {
+		return e.m_name != "tGpuFrameTime";
 	});
 
-	// Merge same
-	CoreDynamicArray<TracerCounter> mergedCounters;
-	for(U32 i = 0; i < item.m_counters.getSize(); ++i)
+	auto sortEvents = [](TracerEvent* begin, TracerEvent* end) {
+		std::sort(begin, end, [](const TracerEvent& a, const TracerEvent& b) {
+			return a.m_start < b.m_start;
+		});
+	};
+	sortEvents(item.m_events.getBegin(), gpuEventsBegin);
+	sortEvents(gpuEventsBegin, item.m_events.getEnd());
+
+	const U32 cpuEventCount = U32(gpuEventsBegin - item.m_events.getBegin());
+	m_binaryWriter.writeThreadEvents(item.m_tid, item.m_frame, ConstWeakArray<TracerEvent>(item.m_events.getBegin(), cpuEventCount));
+	m_binaryWriter.writeThreadEvents(1, item.m_frame, ConstWeakArray<TracerEvent>(gpuEventsBegin, item.m_events.getSize() - cpuEventCount));
+
+	if(item.m_counters.getSize())
+	{
+		CoreDynamicArray<TracerCounter> mergedCounters;
+		mergeCounters(item.m_counters, mergedCounters);
+		m_binaryWriter.writeCounters(item.m_frame, item.m_flushTime, ConstWeakArray<TracerCounter>(mergedCounters));
+	}
+
+	// Write
+	const ConstWeakArray<U8, PtrSize> data = m_binaryWriter.getBuffer();
+
+	sendToStream(data);
+
+	if(m_binaryFormat)
 	{
-		if(mergedCounters.getSize() == 0 || mergedCounters.getBack().m_name != item.m_counters[i].m_name)
+		if(checkFileBudget(data.getSize()))
 		{
-			// New
-			mergedCounters.emplaceBack(item.m_counters[i]);
+			ANKI_CHECK(m_traceBinaryFile.write(data.getBegin(), data.getSize()));
 		}
 		else
 		{
-			// Merge
-			mergedCounters.getBack().m_value += item.m_counters[i].m_value;
+			m_totalDroppedEventCount += item.m_events.getSize();
+			m_totalDroppedCounterCount += item.m_counters.getSize();
 		}
 	}
+
+	m_binaryWriter.resetBuffer();
+
+	return Error::kNone;
+}
+
+void CoreTracer::gatherCounters(ThreadWorkItem& item)
+{
+	CoreDynamicArray<TracerCounter> mergedCounters;
+	mergeCounters(item.m_counters, mergedCounters);
 	ANKI_ASSERT(mergedCounters.getSize() > 0 && mergedCounters.getSize() <= item.m_counters.getSize());
 
 	// Add missing counter names
@@ -312,9 +462,25 @@ void CoreTracer::flushFrame(U64 frame)
 			Ctx& ctx = *static_cast<Ctx*>(ud);
 			CoreTracer& self = *ctx.m_self;
 
+			// Reserve memory from the budget. If the thread can't keep up drop the data instead of growing forever
+			const PtrSize itemSize = ThreadWorkItem::computeSizeInBytes(events.getSize(), counters.getSize());
+			{
+				LockGuard<Mutex> lock(self.m_mtx);
+				const PtrSize budget = PtrSize(g_tracingMemoryBudgetCVar.get()) * 1_MB;
+				if(self.m_workItemsSizeInBytes + itemSize > budget)
+				{
+					self.m_droppedEventCount += events.getSize();
+					self.m_droppedCounterCount += counters.getSize();
+					return;
+				}
+
+				self.m_workItemsSizeInBytes += itemSize;
+			}
+
 			ThreadWorkItem* item = newInstance<ThreadWorkItem>(CoreMemoryPool::getSingleton());
 			item->m_tid = tid;
 			item->m_frame = ctx.m_frame;
+			item->m_flushTime = HighRezTimer::getCurrentTime();
 
 			if(events.getSize() > 0)
 			{
@@ -408,6 +574,110 @@ Error CoreTracer::writeCountersOnShutdown()
 	return Error::kNone;
 }
 
+Bool CoreTracer::checkFileBudget(PtrSize bytesToWrite)
+{
+	// Once the budget is reached stop writing for good. The binary format can't skip data because it might contain interned strings
+	const PtrSize budget = PtrSize(g_tracingFileBudgetCVar.get()) * 1_MB;
+	if(!m_fileBudgetReached && (budget == 0 || m_traceFileSize + bytesToWrite <= budget))
+	{
+		m_traceFileSize += bytesToWrite;
+		return true;
+	}
+
+	if(!m_fileBudgetReached)
+	{
+		ANKI_CORE_LOGW("Trace file budget reached. Will start dropping events");
+		m_fileBudgetReached = true;
+	}
+
+	return false;
+}
+
+#	if ANKI_POSIX
+Bool CoreTracer::isStreaming() const
+{
+	return m_streamSocket >= 0;
+}
+
+void CoreTracer::connectStream(CString socketPath)
+{
+	sockaddr_un addr = {};
+	if(socketPath.getLength() >= sizeof(addr.sun_path))
+	{
+		ANKI_CORE_LOGE("Trace stream socket path is too long: %s", socketPath.cstr());
+		return;
+	}
+
+	m_streamSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(m_streamSocket < 0)
+	{
+		ANKI_CORE_LOGE("socket() failed: %s", strerror(errno));
+		return;
+	}
+
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, socketPath.cstr(), socketPath.getLength() + 1);
+	if(connect(m_streamSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		ANKI_CORE_LOGW("Can't connect to the trace viewer at %s: %s", socketPath.cstr(), strerror(errno));
+		disconnectStream();
+		return;
+	}
+
+	ANKI_CORE_LOGI("Streaming the trace to: %s", socketPath.cstr());
+}
+
+void CoreTracer::sendToStream(ConstWeakArray<U8, PtrSize> data)
+{
+	PtrSize offset = 0;
+	while(isStreaming() && offset < data.getSize())
+	{
+		const ssize_t sent = send(m_streamSocket, data.getBegin() + offset, data.getSize() - offset, MSG_NOSIGNAL);
+		if(sent < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			ANKI_CORE_LOGW("Trace viewer disconnected: %s", strerror(errno));
+			disconnectStream();
+		}
+		else
+		{
+			offset += PtrSize(sent);
+		}
+	}
+}
+
+void CoreTracer::disconnectStream()
+{
+	if(m_streamSocket >= 0)
+	{
+		close(m_streamSocket);
+		m_streamSocket = -1;
+	}
+}
+#	else
+Bool CoreTracer::isStreaming() const
+{
+	return false;
+}
+
+void CoreTracer::connectStream([[maybe_unused]] CString socketPath)
+{
+	ANKI_CORE_LOGW("Trace streaming is not supported on this platform");
+}
+
+void CoreTracer::sendToStream([[maybe_unused]] ConstWeakArray<U8, PtrSize> data)
+{
+}
+
+void CoreTracer::disconnectStream()
+{
+}
+#	endif
+
 #endif
 
 } // end namespace anki
@@ -9,6 +9,7 @@
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/List.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/BinaryTrace.h>
 #include <AnKi/Core/CVarSet.h>
 
 namespace anki {
@@ -17,6 +18,10 @@ namespace anki {
 /// @{
 
 extern BoolCVar g_tracingEnabledCVar;
+extern BoolCVar g_tracingBinaryCVar;
+extern NumericCVar<U32> g_tracingMemoryBudgetCVar;
+extern NumericCVar<U32> g_tracingFileBudgetCVar;
+extern StringCVar g_tracingStreamSocketCVar;
 #if ANKI_OS_ANDROID
 extern BoolCVar g_streamlineEnabledCVar;
 #endif
@@ -48,11 +53,28 @@ private:
 	IntrusiveList<PerFrameCounters> m_frameCounters;
 
 	IntrusiveList<ThreadWorkItem> m_workItems; ///< Items for the thread to process.
+	PtrSize m_workItemsSizeInBytes = 0; ///< The memory the m_workItems hold. Protected by m_mtx.
+	U64 m_droppedEventCount = 0; ///< Events dropped since the last time the thread reported them. Protected by m_mtx.
+	U64 m_droppedCounterCount = 0; ///< Same as m_droppedEventCount.
+	U64 m_totalDroppedEventCount = 0;
+	U64 m_totalDroppedCounterCount = 0;
+
 	CoreString m_traceJsonFilename;
+	CoreString m_traceBinaryFilename;
 	CoreString m_countersCsvFilename;
 	File m_traceJsonFile;
+	File m_traceBinaryFile;
+	BinaryTraceWriter m_binaryWriter;
+	PtrSize m_traceFileSize = 0;
+	Bool m_binaryFormat = false;
+	Bool m_binaryHeaderWritten = false;
+	Bool m_fileBudgetReached = false;
 	Bool m_quit = false;
 
+#	if ANKI_POSIX
+	I32 m_streamSocket = -1;
+#	endif
+
 	CoreTracer();
 
 	~CoreTracer();
@@ -60,8 +82,16 @@ private:
 	Error threadWorker();
 
 	Error writeEvents(ThreadWorkItem& item);
+	Error writeBinary(ThreadWorkItem& item, U64 droppedEventCount, U64 droppedCounterCount);
 	void gatherCounters(ThreadWorkItem& item);
 	Error writeCountersOnShutdown();
+
+	Bool checkFileBudget(PtrSize bytesToWrite);
+
+	Bool isStreaming() const;
+	void connectStream(CString socketPath);
+	void sendToStream(ConstWeakArray<U8, PtrSize> data);
+	void disconnectStream();
 };
 
 #endif
@@ -28,7 +28,7 @@ void GpuSceneBuffer::init()
 
 	const Array classes = {32_B, 64_B, 128_B, 256_B, poolSize};
 
-	BufferUsageBit buffUsage = BufferUsageBit::kAllStorage | BufferUsageBit::kTransferDestination;
+	BufferUsageBit buffUsage = BufferUsageBit::kAllStorage | BufferUsageBit::kAllTransfer;
 
 	m_pool.init(buffUsage, classes, poolSize, "GpuScene", true);
 
@@ -56,6 +56,15 @@ public:
 	U32 m_dstDwordOffset;
 };
 
+class GpuSceneMicroPatcher::Relocation
+{
+public:
+	PtrSize m_srcOffset;
+	PtrSize m_dstOffset;
+	PtrSize m_size;
+	Bool m_gpuCopy; ///< False if the source was written only by this frame's patches and there is nothing to copy.
+};
+
 GpuSceneMicroPatcher::GpuSceneMicroPatcher()
 {
 }
@@ -118,40 +127,119 @@ void GpuSceneMicroPatcher::newCopy(StackMemoryPool& frameCpuPool, PtrSize gpuSce
 	}
 }
 
+void GpuSceneMicroPatcher::relocate(StackMemoryPool& frameCpuPool, PtrSize srcOffset, PtrSize dstOffset, PtrSize size)
+{
+	ANKI_ASSERT(size > 0 && (srcOffset % 4) == 0 && (dstOffset % 4) == 0 && (size % 4) == 0);
+	ANKI_ASSERT(srcOffset + size <= dstOffset || dstOffset + size <= srcOffset);
+
+	LockGuard lock(m_mtx);
+
+	if(m_crntFrameRelocations.getSize() == 0)
+	{
+		m_crntFrameRelocations = DynamicArray<Relocation, MemoryPoolPtrWrapper<StackMemoryPool>>(&frameCpuPool);
+	}
+
+	// If the source is the destination of an earlier relocation of this frame then skip the middle man
+	Bool gpuCopy = true;
+	for(Relocation& r : m_crntFrameRelocations)
+	{
+		if(r.m_dstOffset == srcOffset)
+		{
+			r.m_dstOffset = dstOffset;
+			gpuCopy = false;
+		}
+	}
+
+	m_crntFrameRelocations.emplaceBack(Relocation{srcOffset, dstOffset, size, gpuCopy});
+}
+
+void GpuSceneMicroPatcher::latchCopies()
+{
+	ANKI_ASSERT(m_latchedPatchHeaders.getSize() == 0 && m_latchedRelocations.getSize() == 0
+				&& "The previous copies were not consumed by patchGpuScene()");
+
+	// Some copies might have been computed using the old offsets, redirect them
+	for(const Relocation& r : m_crntFrameRelocations)
+	{
+		const U32 srcDwordBegin = U32(r.m_srcOffset / 4);
+		const U32 srcDwordEnd = U32((r.m_srcOffset + r.m_size) / 4);
+		const U32 dstDwordOffset = U32(r.m_dstOffset / 4);
+
+		for(PatchHeader& header : m_crntFramePatchHeaders)
+		{
+			if(header.m_dstDwordOffset >= srcDwordBegin && header.m_dstDwordOffset < srcDwordEnd)
+			{
+				header.m_dstDwordOffset = header.m_dstDwordOffset - srcDwordBegin + dstDwordOffset;
+			}
+		}
+	}
+
+	m_latchedPatchHeaders = std::move(m_crntFramePatchHeaders);
+	m_latchedPatchData = std::move(m_crntFramePatchData);
+	m_latchedRelocations = std::move(m_crntFrameRelocations);
+}
+
 void GpuSceneMicroPatcher::patchGpuScene(CommandBuffer& cmdb)
 {
-	if(m_crntFramePatchHeaders.getSize() == 0)
+	Buffer& gpuSceneBuffer = GpuSceneBuffer::getSingleton().getBuffer();
+
+	// Move the data of the relocated regions first
+	if(m_latchedRelocations.getSize())
+	{
+		CoreDynamicArray<CopyBufferToBufferInfo> copies;
+		for(const Relocation& r : m_latchedRelocations)
+		{
+			if(r.m_gpuCopy)
+			{
+				copies.emplaceBack(CopyBufferToBufferInfo{r.m_srcOffset, r.m_dstOffset, r.m_size});
+			}
+		}
+
+		if(copies.getSize())
+		{
+			cmdb.copyBufferToBuffer(&gpuSceneBuffer, &gpuSceneBuffer, copies);
+		}
+
+		const BufferBarrierInfo barrier = {BufferView(&gpuSceneBuffer), BufferUsageBit::kAllTransfer, BufferUsageBit::kStorageComputeWrite};
+		cmdb.setPipelineBarrier({}, {&barrier, 1}, {});
+
+		Relocation* data;
+		U32 size, storage;
+		m_latchedRelocations.moveAndReset(data, size, storage);
+	}
+
+	if(m_latchedPatchHeaders.getSize() == 0)
 	{
 		return;
 	}
 
-	ANKI_ASSERT(m_crntFramePatchData.getSize() > 0);
+	ANKI_ASSERT(m_latchedPatchData.getSize() > 0);
 
-	ANKI_TRACE_INC_COUNTER(GpuSceneMicroPatches, m_crntFramePatchHeaders.getSize());
-	ANKI_TRACE_INC_COUNTER(GpuSceneMicroPatchUploadData, m_crntFramePatchData.getSizeInBytes());
+	ANKI_TRACE_INC_COUNTER(GpuSceneMicroPatches, m_latchedPatchHeaders.getSize());
+	ANKI_TRACE_INC_COUNTER(GpuSceneMicroPatchUploadData, m_latchedPatchData.getSizeInBytes());
 
 	void* mapped;
-	const RebarAllocation headersToken = RebarTransientMemoryPool::getSingleton().allocateFrame(m_crntFramePatchHeaders.getSizeInBytes(), mapped);
-	memcpy(mapped, &m_crntFramePatchHeaders[0], m_crntFramePatchHeaders.getSizeInBytes());
+	const RebarAllocation headersToken = RebarTransientMemoryPool::getSingleton().allocateFrame(m_latchedPatchHeaders.getSizeInBytes(), mapped);
+	memcpy(mapped, &m_latchedPatchHeaders[0], m_latchedPatchHeaders.getSizeInBytes());
 
-	const RebarAllocation dataToken = RebarTransientMemoryPool::getSingleton().allocateFrame(m_crntFramePatchData.getSizeInBytes(), mapped);
-	memcpy(mapped, &m_crntFramePatchData[0], m_crntFramePatchData.getSizeInBytes());
+	const RebarAllocation dataToken = RebarTransientMemoryPool::getSingleton().allocateFrame(m_latchedPatchData.getSizeInBytes(), mapped);
+	memcpy(mapped, &m_latchedPatchData[0], m_latchedPatchData.getSizeInBytes());
 
 	cmdb.bindStorageBuffer(ANKI_REG(t0), headersToken);
 	cmdb.bindStorageBuffer(ANKI_REG(t1), dataToken);
-	cmdb.bindStorageBuffer(ANKI_REG(u0), BufferView(&GpuSceneBuffer::getSingleton().getBuffer()));
+	cmdb.bindStorageBuffer(ANKI_REG(u0), BufferView(&gpuSceneBuffer));
 
 	cmdb.bindShaderProgram(m_grProgram.get());
 
-	const U32 workgroupCountX = m_crntFramePatchHeaders.getSize();
+	const U32 workgroupCountX = m_latchedPatchHeaders.getSize();
 	cmdb.dispatchCompute(workgroupCountX, 1, 1);
 
 	// Cleanup to prepare for the new frame
 	U32* data;
 	U32 size, storage;
-	m_crntFramePatchData.moveAndReset(data, size, storage);
+	m_latchedPatchData.moveAndReset(data, size, storage);
 	PatchHeader* datah;
-	m_crntFramePatchHeaders.moveAndReset(datah, size, storage);
+	m_latchedPatchHeaders.moveAndReset(datah, size, storage);
 }
 
 } // end namespace anki
@@ -159,11 +159,21 @@ public:
 		newCopy(frameCpuPool, dest.getOffset(), sizeof(value), &value);
 	}
 
+	/// Some GPU scene data moved from [srcOffset, srcOffset + size) to dstOffset. The data will be copied on the GPU before the next patching and
+	/// the copies of the current frame that target the old range will be redirected to the new one.
+	/// @note It's thread-safe.
+	void relocate(StackMemoryPool& frameCpuPool, PtrSize srcOffset, PtrSize dstOffset, PtrSize size);
+
+	/// Hand the copies gathered so far to patchGpuScene. The copies that will follow will be part of the next patching. That way newCopy can
+	/// run in parallel with patchGpuScene.
+	/// @note Not thread-safe. Nothing else should be happening before calling it.
+	void latchCopies();
+
 	/// Check if there is a need to call patchGpuScene or if no copies are needed.
 	/// @note Not thread-safe. Nothing else should be happening before calling it.
 	Bool patchingIsNeeded() const
 	{
-		return m_crntFramePatchHeaders.getSize() > 0;
+		return m_latchedPatchHeaders.getSize() > 0 || m_latchedRelocations.getSize() > 0;
 	}
 
 	/// Copy the data to the GPU scene buffer.
@@ -174,11 +184,18 @@ private:
 	static constexpr U32 kDwordsPerPatch = 64;
 
 	class PatchHeader;
+	class Relocation;
 
 	DynamicArray<PatchHeader, MemoryPoolPtrWrapper<StackMemoryPool>> m_crntFramePatchHeaders;
 	DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> m_crntFramePatchData;
+	DynamicArray<Relocation, MemoryPoolPtrWrapper<StackMemoryPool>> m_crntFrameRelocations;
 	Mutex m_mtx;
 
+	/// The copies that patchGpuScene will consume.
+	DynamicArray<PatchHeader, MemoryPoolPtrWrapper<StackMemoryPool>> m_latchedPatchHeaders;
+	DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> m_latchedPatchData;
+	DynamicArray<Relocation, MemoryPoolPtrWrapper<StackMemoryPool>> m_latchedRelocations;
+
 	ShaderProgramResourcePtr m_copyProgram;
 	ShaderProgramPtr m_grProgram;
 
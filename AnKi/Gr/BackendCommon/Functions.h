@@ -31,6 +31,23 @@ inline Bool blendingEnabled(BlendFactor srcFactorRgb, BlendFactor dstFactorRgb,
 	return !dontWantBlend;
 }
 
+/// Topologies of the same class (points, lines, triangles or patches) can be changed dynamically without changing the pipeline. Return the list
+/// topology that represents the class.
+inline PrimitiveTopology getPrimitiveTopologyClass(PrimitiveTopology topology)
+{
+	switch(topology)
+	{
+	case PrimitiveTopology::kLines:
+	case PrimitiveTopology::kLineStip:
+		return PrimitiveTopology::kLines;
+	case PrimitiveTopology::kTriangles:
+	case PrimitiveTopology::kTriangleStrip:
+		return PrimitiveTopology::kTriangles;
+	default:
+		return topology;
+	}
+}
+
 /// Using an AnKi typename get the ShaderVariableDataType. Used for debugging.
 template<typename T>
 ShaderVariableDataType getShaderVariableTypeFromTypename();
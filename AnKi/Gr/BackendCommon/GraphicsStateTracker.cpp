@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
+#include <AnKi/Gr/BackendCommon/Functions.h>
 
 namespace anki {
 
@@ -40,6 +41,40 @@ Bool GraphicsStateTracker::updateHashes()
 		someHashWasDirty = true;
 	}
 
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
+	if(m_extendedDynamicState)
+	{
+		// Only the state that can't be dynamic goes into the hashes. Mark the rest dirty so the backend can set it
+
+		if(m_hashes.m_rast == 0)
+		{
+			m_hashes.m_rast = U64(m_staticState.m_rast.m_fillMode) + 1;
+			m_dynState.m_rastDirty = true;
+			someHashWasDirty = true;
+		}
+
+		if(m_hashes.m_ia == 0)
+		{
+			m_hashes.m_ia = U64(getPrimitiveTopologyClass(m_staticState.m_ia.m_topology)) + 1;
+			m_dynState.m_iaDirty = true;
+			someHashWasDirty = true;
+		}
+
+		if(m_hashes.m_depthStencil == 0)
+		{
+			m_hashes.m_depthStencil = 0xC0FEE;
+			m_dynState.m_depthStencilDirty = true;
+			someHashWasDirty = true;
+		}
+
+		if(m_hashes.m_misc == 0)
+		{
+			// The front face depends on the swapchain
+			m_dynState.m_rastDirty = true;
+		}
+	}
+#endif
+
 	if(m_hashes.m_rast == 0)
 	{
 		static_assert(sizeof(m_staticState.m_rast) < kMaxU64);
@@ -20,7 +20,7 @@ class GraphicsStateTracker
 
 public:
 	void bindVertexBuffer(U32 binding, VertexStepRate stepRate
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 						  ,
 						  U32 stride
 #endif
@@ -28,13 +28,13 @@ public:
 	{
 		auto& vertState = m_staticState.m_vert;
 		if(!vertState.m_bindingsSetMask.get(binding) || vertState.m_bindings[binding].m_stepRate != stepRate
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		   || vertState.m_bindings[binding].m_stride != stride
 #endif
 		)
 		{
 			vertState.m_bindingsSetMask.set(binding);
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 			vertState.m_bindings[binding].m_stride = stride;
 #endif
 			vertState.m_bindings[binding].m_stepRate = stepRate;
@@ -122,7 +122,7 @@ public:
 	{
 		ANKI_ASSERT(face != FaceSelectionBit::kNone);
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		if(!!(face & FaceSelectionBit::kFront) && m_dynState.m_stencilFaces[0].m_compareMask != mask)
 		{
 			m_dynState.m_stencilFaces[0].m_compareMask = mask;
@@ -153,7 +153,7 @@ public:
 	{
 		ANKI_ASSERT(face != FaceSelectionBit::kNone);
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		if(!!(face & FaceSelectionBit::kFront) && m_dynState.m_stencilFaces[0].m_writeMask != mask)
 		{
 			m_dynState.m_stencilFaces[0].m_writeMask = mask;
@@ -183,7 +183,7 @@ public:
 	void setStencilReference(FaceSelectionBit face, U32 ref)
 	{
 		ANKI_ASSERT(face != FaceSelectionBit::kNone);
-		ANKI_ASSERT((ANKI_GR_BACKEND_VULKAN || face == FaceSelectionBit::kFrontAndBack) && "D3D only supports a single value for both sides");
+		ANKI_ASSERT((!ANKI_GR_BACKEND_DIRECT3D || face == FaceSelectionBit::kFrontAndBack) && "D3D only supports a single value for both sides");
 
 		if(!!(face & FaceSelectionBit::kFront) && m_dynState.m_stencilFaces[0].m_ref != ref)
 		{
@@ -219,7 +219,7 @@ public:
 
 	void setPolygonOffset(F32 factor, F32 units)
 	{
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		if(m_dynState.m_depthBiasConstantFactor != factor || m_dynState.m_depthBiasSlopeFactor != units)
 		{
 			m_dynState.m_depthBiasConstantFactor = factor;
@@ -274,7 +274,7 @@ public:
 	}
 
 	void beginRenderPass(ConstWeakArray<Format> colorFormats, Format depthStencilFormat, UVec2 rtsSize
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 						 ,
 						 Bool rendersToSwapchain
 #endif
@@ -293,7 +293,7 @@ public:
 		m_hashes.m_misc = 0; // Always mark it dirty because calling beginRenderPass is a rare occurance and we want to avoid extra checks
 
 		if(m_rtsSize != rtsSize
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		   || m_staticState.m_misc.m_rendersToSwapchain != rendersToSwapchain
 #endif
 		)
@@ -305,7 +305,7 @@ public:
 			m_dynState.m_viewportDirty = true;
 		}
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		m_staticState.m_misc.m_rendersToSwapchain = rendersToSwapchain;
 #endif
 	}
@@ -334,7 +334,7 @@ public:
 					}
 				}
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 				for(VertexAttributeSemantic s : EnumIterable<VertexAttributeSemantic>())
 				{
 					m_staticState.m_vert.m_attribs[s].m_semanticToVertexAttributeLocation = refl.m_vertex.m_vkVertexAttributeLocations[s];
@@ -396,7 +396,7 @@ public:
 
 	void setLineWidth(F32 width)
 	{
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		if(m_dynState.m_lineWidth != width)
 		{
 			m_dynState.m_lineWidth = width;
@@ -407,11 +407,25 @@ public:
 #endif
 	}
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 	void setEnablePipelineStatistics(Bool enable)
 	{
 		m_staticState.m_misc.m_pipelineStatisticsEnabled = enable;
 	}
+
+	/// If enabled the cull mode, front face, depth bias enable, topology (only its class is part of the pipeline), primitive restart and
+	/// all the depth and stencil state are not part of the pipeline hash. The backend should set them using the extended dynamic state.
+	/// Needs to be called before any other state is set.
+	void setExtendedDynamicState(Bool enable)
+	{
+		m_extendedDynamicState = enable;
+		m_hashes = {};
+	}
+
+	Bool getExtendedDynamicState() const
+	{
+		return m_extendedDynamicState;
+	}
 #endif
 
 	void setPrimitiveRestart(Bool enable)
@@ -449,7 +463,7 @@ private:
 			class Binding
 			{
 			public:
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 				U32 m_stride;
 #endif
 				VertexStepRate m_stepRate;
@@ -466,7 +480,7 @@ private:
 				U32 m_relativeOffset;
 				Format m_fmt;
 				U32 m_binding;
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 				U8 m_semanticToVertexAttributeLocation;
 #endif
 
@@ -496,7 +510,7 @@ private:
 		public:
 			FillMode m_fillMode = FillMode::kSolid;
 			FaceSelectionBit m_cullMode = FaceSelectionBit::kBack;
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 			Bool m_depthBiasEnabled = false;
 #else
 			F32 m_depthBias = 0.0f;
@@ -557,7 +571,7 @@ private:
 			Format m_depthStencilFormat = Format::kNone;
 			BitSet<kMaxColorRenderTargets> m_colorRtMask = {false};
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 			Bool m_rendersToSwapchain = false;
 			Bool m_pipelineStatisticsEnabled = false;
 #endif
@@ -573,7 +587,7 @@ private:
 		class StencilFace
 		{
 		public:
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 			U32 m_compareMask = 0x5A5A5A5A; ///< Use a stupid number to initialize.
 			U32 m_writeMask = 0x5A5A5A5A; ///< Use a stupid number to initialize.
 #endif
@@ -585,7 +599,7 @@ private:
 		Array<U32, 4> m_viewport = {};
 		Array<U32, 4> m_scissor = {0, 0, kMaxU32, kMaxU32};
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		F32 m_depthBiasConstantFactor = 0.0f;
 		F32 m_depthBiasClamp = 0.0f;
 		F32 m_depthBiasSlopeFactor = 0.0f;
@@ -593,11 +607,16 @@ private:
 		F32 m_lineWidth = 1.0f;
 #endif
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 		Bool m_stencilCompareMaskDirty : 1 = true;
 		Bool m_stencilWriteMaskDirty : 1 = true;
 		Bool m_depthBiasDirty : 1 = true;
 		Bool m_lineWidthDirty : 1 = true;
+
+		// The following are only used with the extended dynamic state
+		Bool m_rastDirty : 1 = true;
+		Bool m_iaDirty : 1 = true;
+		Bool m_depthStencilDirty : 1 = true;
 #else
 		Bool m_topologyDirty : 1 = true;
 #endif
@@ -622,6 +641,10 @@ private:
 
 	UVec2 m_rtsSize = UVec2(0u);
 
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
+	Bool m_extendedDynamicState = false;
+#endif
+
 	Bool updateHashes();
 };
 /// @}
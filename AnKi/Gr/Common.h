@@ -403,7 +403,7 @@ enum class Format : U32
 {
 	kNone = 0,
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 #	define ANKI_FORMAT_DEF(type, vk, d3d, componentCount, texelSize, blockWidth, blockHeight, blockSize, shaderType, depthStencil) k##type = vk,
 #else
 #	define ANKI_FORMAT_DEF(type, vk, d3d, componentCount, texelSize, blockWidth, blockHeight, blockSize, shaderType, depthStencil) k##type = d3d,
@@ -967,7 +967,7 @@ public:
 		ANKI_ASSERT(m_type < DescriptorType::kCount);
 		ANKI_ASSERT(m_flags != DescriptorFlag::kNone);
 		ANKI_ASSERT(m_arraySize > 0);
-		ANKI_ASSERT(ANKI_GR_BACKEND_VULKAN || m_type != DescriptorType::kStorageBuffer || m_d3dStructuredBufferStride != 0);
+		ANKI_ASSERT(!ANKI_GR_BACKEND_DIRECT3D || m_type != DescriptorType::kStorageBuffer || m_d3dStructuredBufferStride != 0);
 	}
 };
 ANKI_END_PACKED_STRUCT
@@ -209,6 +209,7 @@ void GrManager::swapBuffers()
 	self.m_crntFrame = (self.m_crntFrame + 1) % self.m_frames.getSize();
 
 	FrameGarbageCollector::getSingleton().endFrame(presentFence.get());
+	self.m_frameEpoch.fetchAdd(1);
 }
 
 void GrManager::finish()
@@ -216,6 +217,13 @@ void GrManager::finish()
 	ANKI_ASSERT(!"TODO");
 }
 
+void GrManager::deleteObjectDeferred(GrObject* obj)
+{
+	// The D3D command buffers hold references to the objects they use so they are never marked with a frame
+	ANKI_ASSERT(!"Shouldn't be called");
+	deleteInstance(GrMemoryPool::getSingleton(), obj);
+}
+
 #define ANKI_NEW_GR_OBJECT(type) \
 	type##Ptr GrManager::new##type(const type##InitInfo& init) \
 	{ \
@@ -6,7 +6,7 @@
 #include <AnKi/Gr/D3D/D3DCommon.h>
 #include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
 #include <AnKi/Util/WeakArray.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 
 namespace anki {
 
@@ -23,7 +23,7 @@ public:
 	void flushState(GraphicsStateTracker& state, D3D12GraphicsCommandListX& cmdList);
 
 private:
-	GrHashMap<U64, ID3D12PipelineState*> m_map;
+	GrSwissHashMap<U64, ID3D12PipelineState*> m_map;
 	RWMutex m_mtx;
 };
 /// @}
@@ -94,9 +94,21 @@ public:
 		return m_uuidIndex.fetchAdd(1);
 	}
 
+	/// The frame the CPU is recording. It starts from 1 and it's incremented by swapBuffers. Command buffers stamp the GrObjects they use with
+	/// it.
+	ANKI_INTERNAL U64 getFrameEpoch() const
+	{
+		return m_frameEpoch.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	/// Delete an object that might still be used by the GPU. The backend will delete it when the frame that last used it is done.
+	/// @note It's thread-safe.
+	ANKI_INTERNAL void deleteObjectDeferred(GrObject* obj);
+
 protected:
 	GrString m_cacheDir;
 	Atomic<U64> m_uuidIndex = {1};
+	Atomic<U64> m_frameEpoch = {1};
 	GpuDeviceCapabilities m_capabilities;
 
 	GrManager();
@@ -30,4 +30,17 @@ GrObject::~GrObject()
 	}
 }
 
+void GrObjectDeleter::operator()(GrObject* ptr)
+{
+	if(ptr->getLastUsedFrame() == 0)
+	{
+		// Never used by the GPU, delete it right away
+		deleteInstance(GrMemoryPool::getSingleton(), ptr);
+	}
+	else
+	{
+		GrManager::getSingleton().deleteObjectDeferred(ptr);
+	}
+}
+
 } // end namespace anki
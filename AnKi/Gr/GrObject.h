@@ -74,9 +74,32 @@ public:
 		return m_name;
 	}
 
+	/// Command buffers call this to mark that the GPU work of a frame is using the object. When the last reference is dropped the backend will
+	/// defer the deletion of the object until that frame is done. It's cheaper than holding references because it's a plain load most of the
+	/// time.
+	/// @return True if it's the first time the object is marked in that frame.
+	ANKI_INTERNAL Bool markUsedInFrame(U64 frameEpoch) const
+	{
+		ANKI_ASSERT(frameEpoch > 0);
+		if(m_lastUsedFrame.load(AtomicMemoryOrder::kRelaxed) >= frameEpoch) [[likely]]
+		{
+			return false;
+		}
+
+		m_lastUsedFrame.max(frameEpoch);
+		return true;
+	}
+
+	/// The frame epoch that last used that object. Zero if the GPU has never used it.
+	ANKI_INTERNAL U64 getLastUsedFrame() const
+	{
+		return m_lastUsedFrame.load(AtomicMemoryOrder::kRelaxed);
+	}
+
 private:
 	Char* m_name = nullptr;
 	U64 m_uuid;
+	mutable Atomic<U64> m_lastUsedFrame = {0};
 	mutable Atomic<I32> m_refcount;
 	GrObjectType m_type;
 };
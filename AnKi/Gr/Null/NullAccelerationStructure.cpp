@@ -0,0 +1,53 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullAccelerationStructure.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+AccelerationStructure* AccelerationStructure::newInstance(const AccelerationStructureInitInfo& init)
+{
+	AccelerationStructureImpl* impl = anki::newInstance<AccelerationStructureImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+U64 AccelerationStructure::getGpuAddress() const
+{
+	ANKI_NULL_SELF_CONST(AccelerationStructureImpl);
+	return self.m_gpuAddress;
+}
+
+Error AccelerationStructureImpl::init(const AccelerationStructureInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+	m_type = inf.m_type;
+
+	// Roughly what a driver asks for. There is no real build so it only matters for the scratch memory bookkeeping of the callers
+	PtrSize size;
+	if(m_type == AccelerationStructureType::kBottomLevel)
+	{
+		size = PtrSize(inf.m_bottomLevel.m_positionCount) * 32 + PtrSize(inf.m_bottomLevel.m_indexCount) * 16;
+	}
+	else
+	{
+		const U32 instanceCount = (inf.m_topLevel.m_directArgs.m_instances.getSize()) ? inf.m_topLevel.m_directArgs.m_instances.getSize()
+																					  : inf.m_topLevel.m_indirectArgs.m_maxInstanceCount;
+		size = PtrSize(instanceCount) * 128;
+	}
+
+	m_scratchBufferSize = getAlignedRoundUp(256, size);
+	m_gpuAddress = getGrManagerImpl().allocateFakeGpuAddress(size);
+
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,38 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/AccelerationStructure.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// AccelerationStructure implementation.
+class AccelerationStructureImpl final : public AccelerationStructure
+{
+	friend class AccelerationStructure;
+
+public:
+	AccelerationStructureImpl(CString name)
+		: AccelerationStructure(name)
+	{
+	}
+
+	~AccelerationStructureImpl()
+	{
+	}
+
+	Error init(const AccelerationStructureInitInfo& inf);
+
+private:
+	U64 m_gpuAddress = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,96 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullBuffer.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+Buffer* Buffer::newInstance(const BufferInitInfo& init)
+{
+	BufferImpl* impl = anki::newInstance<BufferImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void* Buffer::map(PtrSize offset, PtrSize range, [[maybe_unused]] BufferMapAccessBit access)
+{
+	ANKI_NULL_SELF(BufferImpl);
+
+	ANKI_ASSERT(access != BufferMapAccessBit::kNone);
+	ANKI_ASSERT((access & m_access) != BufferMapAccessBit::kNone);
+	ANKI_ASSERT(!self.m_mapped);
+	ANKI_ASSERT(offset < m_size);
+	if(range == kMaxPtrSize)
+	{
+		range = m_size - offset;
+	}
+	ANKI_ASSERT(offset + range <= m_size);
+	ANKI_ASSERT(self.m_mappedMemory);
+
+#if ANKI_ASSERTIONS_ENABLED
+	self.m_mapped = true;
+#endif
+
+	return self.m_mappedMemory + offset;
+}
+
+void Buffer::unmap()
+{
+#if ANKI_ASSERTIONS_ENABLED
+	ANKI_NULL_SELF(BufferImpl);
+	ANKI_ASSERT(self.m_mapped);
+	self.m_mapped = false;
+#endif
+}
+
+void Buffer::flush([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize range) const
+{
+	// No-op
+}
+
+void Buffer::invalidate([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize range) const
+{
+	// No-op
+}
+
+BufferImpl::~BufferImpl()
+{
+	ANKI_ASSERT(!m_mapped);
+
+	if(m_mappedMemory)
+	{
+		GrMemoryPool::getSingleton().free(m_mappedMemory);
+	}
+}
+
+Error BufferImpl::init(const BufferInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+	m_access = inf.m_mapAccess;
+	m_usage = inf.m_usage;
+	m_size = inf.m_size;
+
+	if(m_access != BufferMapAccessBit::kNone)
+	{
+		m_mappedMemory = static_cast<U8*>(GrMemoryPool::getSingleton().allocate(m_size, ANKI_SAFE_ALIGNMENT));
+		if(!m_mappedMemory) [[unlikely]]
+		{
+			ANKI_NULL_LOGE("Out of memory while creating buffer: %s", getName().cstr());
+			return Error::kOutOfMemory;
+		}
+	}
+
+	m_gpuAddress = getGrManagerImpl().allocateFakeGpuAddress(m_size);
+
+	return Error::kNone;
+}
+
+} // end namespace anki
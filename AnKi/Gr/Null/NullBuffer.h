@@ -0,0 +1,45 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Buffer.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Buffer implementation. Only the mappable buffers get some CPU memory to back them.
+class BufferImpl final : public Buffer
+{
+	friend class Buffer;
+
+public:
+	BufferImpl(CString name)
+		: Buffer(name)
+	{
+	}
+
+	~BufferImpl();
+
+	Error init(const BufferInitInfo& inf);
+
+	Bool usageValid(BufferUsageBit usage) const
+	{
+		return (m_usage & usage) == usage;
+	}
+
+private:
+	U8* m_mappedMemory = nullptr;
+
+#if ANKI_ASSERTIONS_ENABLED
+	Bool m_mapped = false;
+#endif
+};
+/// @}
+
+} // end namespace anki
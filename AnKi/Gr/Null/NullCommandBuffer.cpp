@@ -0,0 +1,1127 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullCommandBuffer.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+#include <AnKi/Gr/Null/NullBuffer.h>
+#include <AnKi/Gr/Null/NullTexture.h>
+#include <AnKi/Gr/Null/NullAccelerationStructure.h>
+#include <AnKi/Gr/Null/NullGrUpscaler.h>
+#include <AnKi/Gr/Null/NullOcclusionQuery.h>
+#include <AnKi/Gr/Null/NullPipelineQuery.h>
+#include <AnKi/Gr/Null/NullTimestampQuery.h>
+#include <AnKi/Gr/Null/NullSampler.h>
+#include <AnKi/Core/StatsSet.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+static StatCounter g_nullCommandsStatVar(StatCategory::kMisc, "NULL commands recorded", StatFlag::kZeroEveryFrame);
+static StatCounter g_nullCommandBytesStatVar(StatCategory::kMisc, "NULL command bytes", StatFlag::kZeroEveryFrame | StatFlag::kBytes);
+static StatCounter g_trackedObjectsStatVar(StatCategory::kMisc, "CommandBuffer tracked objects", StatFlag::kZeroEveryFrame);
+
+CommandBuffer* CommandBuffer::newInstance(const CommandBufferInitInfo& init)
+{
+	ANKI_TRACE_SCOPED_EVENT(NullNewCommandBuffer);
+	CommandBufferImpl* impl = anki::newInstance<CommandBufferImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void CommandBuffer::endRecording()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRecording();
+}
+
+void CommandBuffer::bindVertexBuffer(U32 binding, const BufferView& buff, U32 stride, VertexStepRate stepRate)
+{
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.bindVertexBuffer(binding, stepRate, stride);
+
+	NullCmdBindVertexBuffer cmd;
+	cmd.m_buffer = buff.getBuffer().getUuid();
+	cmd.m_offset = buff.getOffset();
+	cmd.m_binding = binding;
+	cmd.m_stride = stride;
+	cmd.m_stepRate = stepRate;
+	self.m_stream->pushCommand(NullCommandType::kBindVertexBuffer, cmd);
+}
+
+void CommandBuffer::setVertexAttribute(VertexAttributeSemantic attribute, U32 buffBinding, Format fmt, U32 relativeOffset)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setVertexAttribute(attribute, buffBinding, fmt, relativeOffset);
+}
+
+void CommandBuffer::bindIndexBuffer(const BufferView& buff, IndexType type)
+{
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(static_cast<const BufferImpl&>(buff.getBuffer()).usageValid(BufferUsageBit::kIndex));
+
+	NullCmdBindIndexBuffer cmd;
+	cmd.m_buffer = buff.getBuffer().getUuid();
+	cmd.m_offset = buff.getOffset();
+	cmd.m_indexType = type;
+	self.m_stream->pushCommand(NullCommandType::kBindIndexBuffer, cmd);
+}
+
+void CommandBuffer::setPrimitiveRestart(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setPrimitiveRestart(enable);
+}
+
+void CommandBuffer::setViewport(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.commandCommon();
+	self.m_graphicsState.setViewport(minx, miny, width, height);
+}
+
+void CommandBuffer::setScissor(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.commandCommon();
+	self.m_graphicsState.setScissor(minx, miny, width, height);
+}
+
+void CommandBuffer::setFillMode(FillMode mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setFillMode(mode);
+}
+
+void CommandBuffer::setCullMode(FaceSelectionBit mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setCullMode(mode);
+}
+
+void CommandBuffer::setPolygonOffset(F32 factor, F32 units)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setPolygonOffset(factor, units);
+}
+
+void CommandBuffer::setStencilOperations(FaceSelectionBit face, StencilOperation stencilFail, StencilOperation stencilPassDepthFail,
+										 StencilOperation stencilPassDepthPass)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setStencilOperations(face, stencilFail, stencilPassDepthFail, stencilPassDepthPass);
+}
+
+void CommandBuffer::setStencilCompareOperation(FaceSelectionBit face, CompareOperation comp)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setStencilCompareOperation(face, comp);
+}
+
+void CommandBuffer::setStencilCompareMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setStencilCompareMask(face, mask);
+}
+
+void CommandBuffer::setStencilWriteMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setStencilWriteMask(face, mask);
+}
+
+void CommandBuffer::setStencilReference(FaceSelectionBit face, U32 ref)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setStencilReference(face, ref);
+}
+
+void CommandBuffer::setDepthWrite(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setDepthWrite(enable);
+}
+
+void CommandBuffer::setDepthCompareOperation(CompareOperation op)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setDepthCompareOperation(op);
+}
+
+void CommandBuffer::setAlphaToCoverage(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setAlphaToCoverage(enable);
+}
+
+void CommandBuffer::setColorChannelWriteMask(U32 attachment, ColorBit mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setColorChannelWriteMask(attachment, mask);
+}
+
+void CommandBuffer::setBlendFactors(U32 attachment, BlendFactor srcRgb, BlendFactor dstRgb, BlendFactor srcA, BlendFactor dstA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setBlendFactors(attachment, srcRgb, dstRgb, srcA, dstA);
+}
+
+void CommandBuffer::setBlendOperation(U32 attachment, BlendOperation funcRgb, BlendOperation funcA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setBlendOperation(attachment, funcRgb, funcA);
+}
+
+void CommandBuffer::bindTexture(Register reg, const TextureView& texView)
+{
+	reg.validate();
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	const U64 subresourceHash = computeObjectHash(texView.getSubresource());
+	if(reg.m_resourceType == HlslResourceType::kSrv)
+	{
+		ANKI_ASSERT(texView.isGoodForSampling());
+		self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, texView.getTexture().getUuid(), subresourceHash, 0,
+										  DescriptorType::kTexture, DescriptorFlag::kRead);
+	}
+	else
+	{
+		ANKI_ASSERT(texView.isGoodForStorage());
+		self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, texView.getTexture().getUuid(), subresourceHash, 0,
+										  DescriptorType::kTexture, DescriptorFlag::kReadWrite);
+	}
+}
+
+void CommandBuffer::bindSampler(Register reg, Sampler* sampler)
+{
+	reg.validate();
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, sampler->getUuid(), 0, 0, DescriptorType::kSampler,
+									  DescriptorFlag::kRead);
+	self.m_stream->pushObjectRef(sampler);
+}
+
+void CommandBuffer::bindUniformBuffer(Register reg, const BufferView& buff)
+{
+	reg.validate();
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, buff.getBuffer().getUuid(), buff.getOffset(), buff.getRange(),
+									  DescriptorType::kUniformBuffer, DescriptorFlag::kRead);
+}
+
+void CommandBuffer::bindStorageBuffer(Register reg, const BufferView& buff)
+{
+	reg.validate();
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	const DescriptorFlag flags = (reg.m_resourceType == HlslResourceType::kSrv) ? DescriptorFlag::kRead : DescriptorFlag::kReadWrite;
+	self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, buff.getBuffer().getUuid(), buff.getOffset(), buff.getRange(),
+									  DescriptorType::kStorageBuffer, flags);
+}
+
+void CommandBuffer::bindAccelerationStructure(Register reg, AccelerationStructure* as)
+{
+	reg.validate();
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, as->getUuid(), 0, 0, DescriptorType::kAccelerationStructure,
+									  DescriptorFlag::kRead);
+	self.m_stream->pushObjectRef(as);
+}
+
+void CommandBuffer::bindTexelBuffer(Register reg, const BufferView& buff, [[maybe_unused]] Format fmt)
+{
+	reg.validate();
+	ANKI_ASSERT(fmt != Format::kNone);
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	ANKI_ASSERT(reg.m_resourceType == HlslResourceType::kSrv || reg.m_resourceType == HlslResourceType::kUav);
+	const DescriptorFlag flags = (reg.m_resourceType == HlslResourceType::kSrv) ? DescriptorFlag::kRead : DescriptorFlag::kReadWrite;
+	self.m_descriptorState.bindObject(reg.m_resourceType, reg.m_space, reg.m_bindPoint, buff.getBuffer().getUuid(), buff.getOffset(), buff.getRange(),
+									  DescriptorType::kTexelBuffer, flags);
+}
+
+void CommandBuffer::bindShaderProgram(ShaderProgram* prog)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	ShaderProgramImpl& impl = static_cast<ShaderProgramImpl&>(*prog);
+
+	if(!!(impl.getShaderTypes() & ShaderTypeBit::kAllGraphics))
+	{
+		self.m_graphicsProg = &impl;
+		self.m_computeProg = nullptr; // Unbind the compute prog. Doesn't work like vulkan
+		self.m_rtProg = nullptr; // See above
+		self.m_graphicsState.bindShaderProgram(&impl);
+	}
+	else if(!!(impl.getShaderTypes() & ShaderTypeBit::kCompute))
+	{
+		self.m_computeProg = &impl;
+		self.m_graphicsProg = nullptr; // See comment in the if()
+		self.m_rtProg = nullptr; // See above
+	}
+	else
+	{
+		ANKI_ASSERT(!!(impl.getShaderTypes() & ShaderTypeBit::kAllRayTracing));
+		self.m_computeProg = nullptr;
+		self.m_graphicsProg = nullptr;
+		self.m_rtProg = &impl;
+	}
+
+	self.m_descriptorState.setReflection(&impl.getReflection().m_descriptor);
+
+	// Graphics programs are bound when the pipeline gets flushed
+	if(!self.m_graphicsProg)
+	{
+		NullCmdBindShaderProgram cmd;
+		cmd.m_program = impl.getUuid();
+		cmd.m_shaderTypes = impl.getShaderTypes();
+		self.m_stream->pushCommand(NullCommandType::kBindShaderProgram, cmd);
+	}
+
+	self.m_stream->pushObjectRef(prog);
+}
+
+void CommandBuffer::beginRenderPass(ConstWeakArray<RenderTarget> colorRts, RenderTarget* depthStencilRt, U32 minx, U32 miny, U32 width, U32 height,
+									[[maybe_unused]] const TextureView& vrsRt, [[maybe_unused]] U8 vrsRtTexelSizeX,
+									[[maybe_unused]] U8 vrsRtTexelSizeY)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+
+	ANKI_ASSERT(!self.m_insideRenderpass);
+#if ANKI_ASSERTIONS_ENABLED
+	self.m_insideRenderpass = true;
+#endif
+
+	self.commandCommon();
+
+	NullCmdBeginRenderPass cmd = {};
+	Bool drawsToSwapchain = false;
+	U32 fbWidth = 0;
+	U32 fbHeight = 0;
+
+	Array<Format, kMaxColorRenderTargets> colorFormats = {};
+	Format dsFormat = Format::kNone;
+
+	// Do color targets
+	for(U32 i = 0; i < colorRts.getSize(); ++i)
+	{
+		const TextureView& view = colorRts[i].m_textureView;
+		ANKI_ASSERT(!view.getDepthStencilAspect());
+		const TextureImpl& tex = static_cast<const TextureImpl&>(view.getTexture());
+
+		if(!!(tex.getTextureUsage() & TextureUsageBit::kPresent))
+		{
+			drawsToSwapchain = true;
+		}
+
+		ANKI_ASSERT(fbWidth == 0 || (fbWidth == tex.getWidth() >> view.getFirstMipmap()));
+		ANKI_ASSERT(fbHeight == 0 || (fbHeight == tex.getHeight() >> view.getFirstMipmap()));
+		fbWidth = tex.getWidth() >> view.getFirstMipmap();
+		fbHeight = tex.getHeight() >> view.getFirstMipmap();
+
+		colorFormats[i] = tex.getFormat();
+		cmd.m_colorRts[i] = tex.getUuid();
+	}
+
+	ANKI_ASSERT((!drawsToSwapchain || colorRts.getSize() == 1) && "Can't handle that");
+
+	// DS
+	if(depthStencilRt)
+	{
+		const TextureView& view = depthStencilRt->m_textureView;
+		ANKI_ASSERT(!!view.getDepthStencilAspect());
+		const TextureImpl& tex = static_cast<const TextureImpl&>(view.getTexture());
+
+		ANKI_ASSERT(fbWidth == 0 || (fbWidth == tex.getWidth() >> view.getFirstMipmap()));
+		ANKI_ASSERT(fbHeight == 0 || (fbHeight == tex.getHeight() >> view.getFirstMipmap()));
+		fbWidth = tex.getWidth() >> view.getFirstMipmap();
+		fbHeight = tex.getHeight() >> view.getFirstMipmap();
+
+		dsFormat = tex.getFormat();
+		cmd.m_depthStencilRt = tex.getUuid();
+	}
+
+	// Set the render area
+	ANKI_ASSERT(minx < fbWidth && miny < fbHeight);
+
+	const U32 maxx = min<U32>(minx + width, fbWidth);
+	const U32 maxy = min<U32>(miny + height, fbHeight);
+	width = maxx - minx;
+	height = maxy - miny;
+	ANKI_ASSERT(minx + width <= fbWidth && miny + height <= fbHeight);
+
+	// State bookkeeping
+	self.m_graphicsState.beginRenderPass({colorFormats.getBegin(), colorRts.getSize()}, dsFormat, UVec2(fbWidth, fbHeight), drawsToSwapchain);
+
+	// Finaly
+	cmd.m_renderArea = {minx, miny, width, height};
+	cmd.m_colorRtCount = colorRts.getSize();
+	cmd.m_drawsToSwapchain = drawsToSwapchain;
+	self.m_stream->pushCommand(NullCommandType::kBeginRenderPass, cmd);
+}
+
+void CommandBuffer::endRenderPass()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+
+	ANKI_ASSERT(self.m_insideRenderpass);
+#if ANKI_ASSERTIONS_ENABLED
+	self.m_insideRenderpass = false;
+#endif
+
+	self.commandCommon();
+	self.m_stream->pushCommand(NullCommandType::kEndRenderPass, NullCmdEmpty());
+}
+
+void CommandBuffer::setVrsRate([[maybe_unused]] VrsRate rate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(getGrManagerImpl().getDeviceCapabilities().m_vrs);
+	ANKI_ASSERT(rate < VrsRate::kCount);
+	self.commandCommon();
+}
+
+void CommandBuffer::drawIndexed(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	NullCmdDraw cmd;
+	cmd.m_topology = topology;
+	cmd.m_count = count;
+	cmd.m_instanceCount = instanceCount;
+	cmd.m_first = firstIndex;
+	cmd.m_baseVertex = baseVertex;
+	cmd.m_baseInstance = baseInstance;
+	self.m_stream->pushCommand(NullCommandType::kDrawIndexed, cmd);
+}
+
+void CommandBuffer::draw(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	NullCmdDraw cmd;
+	cmd.m_topology = topology;
+	cmd.m_count = count;
+	cmd.m_instanceCount = instanceCount;
+	cmd.m_first = first;
+	cmd.m_baseVertex = 0;
+	cmd.m_baseInstance = baseInstance;
+	self.m_stream->pushCommand(NullCommandType::kDraw, cmd);
+}
+
+void CommandBuffer::drawIndirect(PrimitiveTopology topology, const BufferView& buff, U32 drawCount)
+{
+	ANKI_ASSERT(buff.isValid());
+	ANKI_ASSERT(drawCount > 0);
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(buff.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((buff.getOffset() % 4) == 0);
+	ANKI_ASSERT((buff.getRange() % sizeof(DrawIndirectArgs)) == 0);
+	ANKI_ASSERT(sizeof(DrawIndirectArgs) * drawCount == buff.getRange());
+
+	self.recordDrawIndirect(NullCommandType::kDrawIndirect, topology, buff, sizeof(DrawIndirectArgs), BufferView(), drawCount);
+}
+
+void CommandBuffer::drawIndexedIndirect(PrimitiveTopology topology, const BufferView& buff, U32 drawCount)
+{
+	ANKI_ASSERT(buff.isValid());
+	ANKI_ASSERT(drawCount > 0);
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(buff.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((buff.getOffset() % 4) == 0);
+	ANKI_ASSERT(sizeof(DrawIndexedIndirectArgs) * drawCount == buff.getRange());
+
+	self.recordDrawIndirect(NullCommandType::kDrawIndexedIndirect, topology, buff, sizeof(DrawIndexedIndirectArgs), BufferView(), drawCount);
+}
+
+void CommandBuffer::drawIndexedIndirectCount(PrimitiveTopology topology, const BufferView& argBuffer, U32 argBufferStride,
+											 const BufferView& countBuffer, U32 maxDrawCount)
+{
+	ANKI_ASSERT(argBuffer.isValid());
+	ANKI_ASSERT(countBuffer.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	ANKI_ASSERT(argBufferStride >= sizeof(DrawIndexedIndirectArgs));
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(argBuffer.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((argBuffer.getOffset() % 4) == 0);
+	ANKI_ASSERT((argBuffer.getRange() % argBufferStride) == 0);
+	ANKI_ASSERT(argBufferStride * maxDrawCount == argBuffer.getRange());
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(countBuffer.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((countBuffer.getOffset() % 4) == 0);
+	ANKI_ASSERT(countBuffer.getRange() == sizeof(U32));
+
+	ANKI_ASSERT(maxDrawCount > 0 && maxDrawCount <= getGrManagerImpl().getDeviceCapabilities().m_maxDrawIndirectCount);
+
+	self.recordDrawIndirect(NullCommandType::kDrawIndexedIndirectCount, topology, argBuffer, argBufferStride, countBuffer, maxDrawCount);
+}
+
+void CommandBuffer::drawIndirectCount(PrimitiveTopology topology, const BufferView& argBuffer, U32 argBufferStride, const BufferView& countBuffer,
+									  U32 maxDrawCount)
+{
+	ANKI_ASSERT(argBuffer.isValid());
+	ANKI_ASSERT(countBuffer.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.m_graphicsState.setPrimitiveTopology(topology);
+	self.drawcallCommon();
+
+	ANKI_ASSERT(argBufferStride >= sizeof(DrawIndirectArgs));
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(argBuffer.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((argBuffer.getOffset() % 4) == 0);
+	ANKI_ASSERT(maxDrawCount * argBufferStride == argBuffer.getRange());
+
+	ANKI_ASSERT(static_cast<const BufferImpl&>(countBuffer.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+	ANKI_ASSERT((countBuffer.getOffset() % 4) == 0);
+	ANKI_ASSERT(countBuffer.getRange() == sizeof(U32));
+
+	ANKI_ASSERT(maxDrawCount > 0 && maxDrawCount <= getGrManagerImpl().getDeviceCapabilities().m_maxDrawIndirectCount);
+
+	self.recordDrawIndirect(NullCommandType::kDrawIndirectCount, topology, argBuffer, argBufferStride, countBuffer, maxDrawCount);
+}
+
+void CommandBuffer::drawMeshTasks(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(getGrManagerImpl().getDeviceCapabilities().m_meshShaders);
+	self.drawcallCommon();
+
+	NullCmdDispatch cmd;
+	cmd.m_groupCount = {groupCountX, groupCountY, groupCountZ};
+	self.m_stream->pushCommand(NullCommandType::kDrawMeshTasks, cmd);
+}
+
+void CommandBuffer::drawMeshTasksIndirect(const BufferView& argBuffer, U32 drawCount)
+{
+	ANKI_ASSERT(argBuffer.isValid());
+	ANKI_ASSERT(drawCount > 0);
+	ANKI_ASSERT(getGrManagerImpl().getDeviceCapabilities().m_meshShaders);
+
+	ANKI_ASSERT((argBuffer.getOffset() % 4) == 0);
+	ANKI_ASSERT(drawCount * sizeof(DispatchIndirectArgs) == argBuffer.getRange());
+	ANKI_ASSERT(static_cast<const BufferImpl&>(argBuffer.getBuffer()).usageValid(BufferUsageBit::kIndirectDraw));
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+
+	self.m_graphicsState.setPrimitiveTopology(PrimitiveTopology::kTriangles);
+	self.drawcallCommon();
+
+	self.recordDrawIndirect(NullCommandType::kDrawMeshTasksIndirect, PrimitiveTopology::kTriangles, argBuffer, sizeof(DispatchIndirectArgs),
+							BufferView(), drawCount);
+}
+
+void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(groupCountX > 0 && groupCountY > 0 && groupCountZ > 0);
+	self.dispatchCommon();
+
+	NullCmdDispatch cmd;
+	cmd.m_groupCount = {groupCountX, groupCountY, groupCountZ};
+	self.m_stream->pushCommand(NullCommandType::kDispatchCompute, cmd);
+}
+
+void CommandBuffer::dispatchComputeIndirect(const BufferView& argBuffer)
+{
+	ANKI_ASSERT(argBuffer.isValid());
+
+	ANKI_ASSERT(sizeof(DispatchIndirectArgs) == argBuffer.getRange());
+	ANKI_ASSERT(argBuffer.getOffset() % 4 == 0);
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.dispatchCommon();
+
+	self.recordDrawIndirect(NullCommandType::kDispatchComputeIndirect, PrimitiveTopology::kPoints, argBuffer, sizeof(DispatchIndirectArgs),
+							BufferView(), 1);
+}
+
+void CommandBuffer::traceRays([[maybe_unused]] const BufferView& sbtBuffer, [[maybe_unused]] U32 sbtRecordSize32,
+							  [[maybe_unused]] U32 hitGroupSbtRecordCount, [[maybe_unused]] U32 rayTypeCount, U32 width, U32 height, U32 depth)
+{
+	ANKI_ASSERT(sbtBuffer.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(hitGroupSbtRecordCount > 0);
+	ANKI_ASSERT(width > 0 && height > 0 && depth > 0);
+	ANKI_ASSERT(self.m_rtProg);
+	ANKI_ASSERT((hitGroupSbtRecordCount % rayTypeCount) == 0);
+	ANKI_ASSERT((1 + rayTypeCount + hitGroupSbtRecordCount) * sbtRecordSize32 <= sbtBuffer.getRange());
+	ANKI_ASSERT(isAligned(getGrManagerImpl().getDeviceCapabilities().m_sbtRecordAlignment, sbtBuffer.getOffset()));
+
+	self.commandCommon();
+
+	// Bind descriptors
+	self.m_descriptorState.flush(*self.m_stream);
+
+	NullCmdDispatch cmd;
+	cmd.m_groupCount = {width, height, depth};
+	self.m_stream->pushCommand(NullCommandType::kTraceRays, cmd);
+}
+
+void CommandBuffer::blitTexture([[maybe_unused]] const TextureView& srcView, [[maybe_unused]] const TextureView& destView)
+{
+	ANKI_ASSERT(!"TODO");
+}
+
+void CommandBuffer::clearTexture(const TextureView& texView, [[maybe_unused]] const ClearValue& clearValue)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	const TextureSubresourceDesc& subresource = texView.getSubresource();
+
+	NullCmdTextureOp cmd = {};
+	cmd.m_texture = texView.getTexture().getUuid();
+	cmd.m_mipmap = subresource.m_mipmap;
+	cmd.m_face = subresource.m_face;
+	cmd.m_layer = subresource.m_layer;
+	cmd.m_allSurfacesOrVolumes = subresource.m_allSurfacesOrVolumes;
+	self.m_stream->pushCommand(NullCommandType::kClearTexture, cmd);
+}
+
+void CommandBuffer::copyBufferToTexture(const BufferView& buff, const TextureView& texView)
+{
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	const TextureImpl& tex = static_cast<const TextureImpl&>(texView.getTexture());
+	ANKI_ASSERT(tex.usageValid(TextureUsageBit::kTransferDestination));
+	ANKI_ASSERT(texView.isGoodForCopyBufferToTexture());
+	const TextureSubresourceDesc& subresource = texView.getSubresource();
+
+	// Compute the sizes of the mip
+	[[maybe_unused]] const U32 width = tex.getWidth() >> subresource.m_mipmap;
+	[[maybe_unused]] const U32 height = tex.getHeight() >> subresource.m_mipmap;
+	ANKI_ASSERT(width && height);
+
+	if(tex.getTextureType() != TextureType::k3D)
+	{
+		ANKI_ASSERT(buff.getRange() == computeSurfaceSize(width, height, tex.getFormat()));
+	}
+	else
+	{
+		ANKI_ASSERT(buff.getRange() == computeVolumeSize(width, height, tex.getDepth() >> subresource.m_mipmap, tex.getFormat()));
+	}
+
+	NullCmdTextureOp cmd = {};
+	cmd.m_texture = tex.getUuid();
+	cmd.m_buffer = buff.getBuffer().getUuid();
+	cmd.m_bufferOffset = buff.getOffset();
+	cmd.m_mipmap = subresource.m_mipmap;
+	cmd.m_face = subresource.m_face;
+	cmd.m_layer = subresource.m_layer;
+	cmd.m_allSurfacesOrVolumes = subresource.m_allSurfacesOrVolumes;
+	self.m_stream->pushCommand(NullCommandType::kCopyBufferToTexture, cmd);
+}
+
+void CommandBuffer::fillBuffer(const BufferView& buff, U32 value)
+{
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(!self.m_insideRenderpass);
+	BufferImpl& impl = static_cast<BufferImpl&>(buff.getBuffer());
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::kTransferDestination));
+
+	ANKI_ASSERT((buff.getOffset() % 4) == 0 && "Should be multiple of 4");
+	ANKI_ASSERT((buff.getRange() % 4) == 0 && "Should be multiple of 4");
+
+	NullCmdBufferOp cmd = {};
+	cmd.m_buffer = impl.getUuid();
+	cmd.m_offset = buff.getOffset();
+	cmd.m_range = buff.getRange();
+	cmd.m_value = value;
+	self.m_stream->pushCommand(NullCommandType::kFillBuffer, cmd);
+}
+
+void CommandBuffer::writeOcclusionQueriesResultToBuffer(ConstWeakArray<OcclusionQuery*> queries, const BufferView& buff)
+{
+	ANKI_ASSERT(buff.isValid());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(queries.getSize() > 0);
+	self.commandCommon();
+	ANKI_ASSERT(!self.m_insideRenderpass);
+
+	ANKI_ASSERT(sizeof(U32) * queries.getSize() <= buff.getRange());
+	ANKI_ASSERT((buff.getOffset() % 4) == 0);
+	ANKI_ASSERT(static_cast<const BufferImpl&>(buff.getBuffer()).usageValid(BufferUsageBit::kTransferDestination));
+
+	for(U32 i = 0; i < queries.getSize(); ++i)
+	{
+		ANKI_ASSERT(queries[i]);
+
+		NullCmdBufferOp cmd = {};
+		cmd.m_buffer = buff.getBuffer().getUuid();
+		cmd.m_offset = buff.getOffset() + sizeof(U32) * i;
+		cmd.m_range = sizeof(U32);
+		cmd.m_object = queries[i]->getUuid();
+		self.m_stream->pushCommand(NullCommandType::kWriteOcclusionQueriesResultToBuffer, cmd);
+
+		self.m_stream->pushObjectRef(queries[i]);
+	}
+}
+
+void CommandBuffer::copyBufferToBuffer(Buffer* src, Buffer* dst, ConstWeakArray<CopyBufferToBufferInfo> copies)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*src).usageValid(BufferUsageBit::kTransferSource));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*dst).usageValid(BufferUsageBit::kTransferDestination));
+	ANKI_ASSERT(copies.getSize() > 0);
+
+	self.commandCommon();
+
+	NullCmdCopyBufferToBuffer cmd;
+	cmd.m_srcBuffer = src->getUuid();
+	cmd.m_dstBuffer = dst->getUuid();
+	cmd.m_copyCount = copies.getSize();
+	self.m_stream->pushCommand(NullCommandType::kCopyBufferToBuffer, cmd, copies.getBegin(), U32(copies.getSizeInBytes()));
+}
+
+void CommandBuffer::buildAccelerationStructure(AccelerationStructure* as, const BufferView& scratchBuffer)
+{
+	ANKI_ASSERT(scratchBuffer.isValid());
+	ANKI_ASSERT(as);
+	ANKI_ASSERT(as->getBuildScratchBufferSize() <= scratchBuffer.getRange());
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdBufferOp cmd = {};
+	cmd.m_buffer = scratchBuffer.getBuffer().getUuid();
+	cmd.m_offset = scratchBuffer.getOffset();
+	cmd.m_range = scratchBuffer.getRange();
+	cmd.m_object = as->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kBuildAccelerationStructure, cmd);
+
+	self.m_stream->pushObjectRef(as);
+}
+
+void CommandBuffer::upscale(GrUpscaler* upscaler, [[maybe_unused]] const TextureView& inColor, [[maybe_unused]] const TextureView& outUpscaledColor,
+							[[maybe_unused]] const TextureView& motionVectors, [[maybe_unused]] const TextureView& depth,
+							[[maybe_unused]] const TextureView& exposure, [[maybe_unused]] Bool resetAccumulation,
+							[[maybe_unused]] const Vec2& jitterOffset, [[maybe_unused]] const Vec2& motionVectorsScale)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(upscaler);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = upscaler->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kUpscale, cmd);
+
+	self.m_stream->pushObjectRef(upscaler);
+}
+
+void CommandBuffer::setPipelineBarrier(ConstWeakArray<TextureBarrierInfo> textures, ConstWeakArray<BufferBarrierInfo> buffers,
+									   ConstWeakArray<AccelerationStructureBarrierInfo> accelerationStructures)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+#if ANKI_ASSERTIONS_ENABLED
+	for(const TextureBarrierInfo& barrier : textures)
+	{
+		ANKI_ASSERT(static_cast<const TextureImpl&>(barrier.m_textureView.getTexture()).usageValid(barrier.m_nextUsage));
+	}
+
+	for(const BufferBarrierInfo& barrier : buffers)
+	{
+		ANKI_ASSERT(barrier.m_bufferView.isValid());
+		ANKI_ASSERT(static_cast<const BufferImpl&>(barrier.m_bufferView.getBuffer()).usageValid(barrier.m_nextUsage));
+	}
+#endif
+
+	// Hash the barriers so that the dump can tell them apart without writing all of them
+	U64 hash = 1;
+	for(const TextureBarrierInfo& barrier : textures)
+	{
+		const Array<U64, 3> words = {barrier.m_textureView.getTexture().getUuid(), U64(barrier.m_previousUsage) | (U64(barrier.m_nextUsage) << 32u),
+									 computeObjectHash(barrier.m_textureView.getSubresource())};
+		hash = appendObjectHash(words, hash);
+	}
+
+	for(const BufferBarrierInfo& barrier : buffers)
+	{
+		const Array<U64, 5> words = {barrier.m_bufferView.getBuffer().getUuid(), barrier.m_bufferView.getOffset(), barrier.m_bufferView.getRange(),
+									 U64(barrier.m_previousUsage), U64(barrier.m_nextUsage)};
+		hash = appendObjectHash(words, hash);
+	}
+
+	for(const AccelerationStructureBarrierInfo& barrier : accelerationStructures)
+	{
+		ANKI_ASSERT(barrier.m_as);
+		self.m_stream->pushObjectRef(barrier.m_as);
+
+		const Array<U64, 2> words = {barrier.m_as->getUuid(), U64(barrier.m_previousUsage) | (U64(barrier.m_nextUsage) << 32u)};
+		hash = appendObjectHash(words, hash);
+	}
+
+	NullCmdPipelineBarrier cmd;
+	cmd.m_hash = hash;
+	cmd.m_textureBarrierCount = textures.getSize();
+	cmd.m_bufferBarrierCount = buffers.getSize();
+	cmd.m_asBarrierCount = accelerationStructures.getSize();
+	self.m_stream->pushCommand(NullCommandType::kPipelineBarrier, cmd);
+
+	ANKI_TRACE_INC_COUNTER(NullBarrier, 1);
+}
+
+void CommandBuffer::beginOcclusionQuery(OcclusionQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = query->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kBeginOcclusionQuery, cmd);
+
+	self.m_stream->pushObjectRef(query);
+}
+
+void CommandBuffer::endOcclusionQuery(OcclusionQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = query->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kEndOcclusionQuery, cmd);
+
+	self.m_stream->pushObjectRef(query);
+	self.m_queries.emplaceBack(query);
+}
+
+void CommandBuffer::beginPipelineQuery(PipelineQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = query->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kBeginPipelineQuery, cmd);
+
+	self.m_stream->pushObjectRef(query);
+}
+
+void CommandBuffer::endPipelineQuery(PipelineQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = query->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kEndPipelineQuery, cmd);
+
+	self.m_stream->pushObjectRef(query);
+	self.m_queries.emplaceBack(query);
+}
+
+void CommandBuffer::writeTimestamp(TimestampQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+
+	NullCmdObject cmd;
+	cmd.m_uuid = query->getUuid();
+	self.m_stream->pushCommand(NullCommandType::kWriteTimestamp, cmd);
+
+	self.m_stream->pushObjectRef(query);
+	self.m_queries.emplaceBack(query);
+}
+
+Bool CommandBuffer::isEmpty() const
+{
+	ANKI_NULL_SELF_CONST(CommandBufferImpl);
+	return self.isEmpty();
+}
+
+void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(data && dataSize && dataSize % 16 == 0);
+	ANKI_ASSERT(self.getBoundProgram().getReflection().m_descriptor.m_pushConstantsSize == dataSize
+				&& "The bound program should have push constants equal to the \"dataSize\" parameter");
+
+	self.commandCommon();
+	self.m_descriptorState.setPushConstants(data, dataSize);
+}
+
+void CommandBuffer::setLineWidth(F32 width)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	self.m_graphicsState.setLineWidth(width);
+}
+
+void CommandBuffer::pushDebugMarker(CString name, Vec3 color)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	if(self.m_debugMarkers) [[unlikely]]
+	{
+		self.commandCommon();
+
+		NullCmdPushDebugMarker cmd;
+		cmd.m_color = {color[0], color[1], color[2]};
+		cmd.m_nameLength = min<U32>(name.getLength(), kMaxU16 / 2);
+		self.m_stream->pushCommand(NullCommandType::kPushDebugMarker, cmd, name.cstr(), cmd.m_nameLength);
+	}
+
+#if ANKI_EXTRA_CHECKS
+	++self.m_debugMarkersPushed;
+#endif
+}
+
+void CommandBuffer::popDebugMarker()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	if(self.m_debugMarkers) [[unlikely]]
+	{
+		self.commandCommon();
+		self.m_stream->pushCommand(NullCommandType::kPopDebugMarker, NullCmdEmpty());
+	}
+
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(self.m_debugMarkersPushed > 0);
+	--self.m_debugMarkersPushed;
+#endif
+}
+
+CommandBufferImpl::~CommandBufferImpl()
+{
+	if(m_empty)
+	{
+		ANKI_NULL_LOGW("Command buffer was empty");
+	}
+
+	if(!m_finalized)
+	{
+		ANKI_NULL_LOGW("Command buffer was not flushed");
+	}
+
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(m_debugMarkersPushed == 0);
+
+	if(!m_submitted)
+	{
+		ANKI_NULL_LOGW("Command buffer not submitted");
+	}
+#endif
+
+	if(m_stream)
+	{
+		getGrManagerImpl().releaseCommandStream(m_stream);
+		m_stream = nullptr;
+	}
+
+	m_queries.destroy();
+}
+
+Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
+{
+	m_tid = Thread::getCurrentThreadId();
+	m_flags = init.m_flags;
+
+	m_stream = getGrManagerImpl().newCommandStream();
+	m_stream->setFrameEpoch(getGrManagerImpl().getFrameEpoch());
+
+	m_debugMarkers = g_debugMarkersCVar.get() || getGrManagerImpl().isDumpingCommands();
+
+	return Error::kNone;
+}
+
+void CommandBufferImpl::endRecording()
+{
+	commandCommon();
+
+	ANKI_ASSERT(!m_finalized);
+	ANKI_ASSERT(!m_empty);
+
+	m_finalized = true;
+
+#if ANKI_EXTRA_CHECKS
+	static Atomic<U32> messagePrintCount(0);
+	constexpr U32 MAX_PRINT_COUNT = 10;
+
+	CString message;
+	if(!!(m_flags & CommandBufferFlag::kSmallBatch))
+	{
+		if(m_commandCount > kCommandBufferSmallBatchMaxCommands * 4)
+		{
+			message = "Command buffer has too many commands%s: %u";
+		}
+	}
+	else
+	{
+		if(m_commandCount <= kCommandBufferSmallBatchMaxCommands / 4)
+		{
+			message = "Command buffer has too few commands%s: %u";
+		}
+	}
+
+	if(!message.isEmpty())
+	{
+		const U32 count = messagePrintCount.fetchAdd(1) + 1;
+		if(count < MAX_PRINT_COUNT)
+		{
+			ANKI_NULL_LOGW(message.cstr(), "", m_commandCount);
+		}
+		else if(count == MAX_PRINT_COUNT)
+		{
+			ANKI_NULL_LOGW(message.cstr(), " (will ignore further warnings)", m_commandCount);
+		}
+	}
+#endif
+}
+
+void CommandBufferImpl::postSubmitWork()
+{
+	ANKI_ASSERT(m_finalized);
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(!m_submitted);
+	m_submitted = true;
+#endif
+
+	g_nullCommandsStatVar.increment(m_stream->getCommandCount());
+	g_nullCommandBytesStatVar.increment(m_stream->getSizeInBytes());
+	g_trackedObjectsStatVar.increment(m_stream->getTrackedObjectCount());
+
+	getGrManagerImpl().dumpCommandStream(*m_stream, getName());
+
+	// "Execute" the queries
+	const Second now = HighRezTimer::getCurrentTime();
+	for(GrObject* obj : m_queries)
+	{
+		switch(obj->getType())
+		{
+		case GrObjectType::kTimstampQuery:
+		{
+			TimestampQueryImpl& q = static_cast<TimestampQueryImpl&>(*obj);
+			q.m_timestamp = now;
+			q.m_available = true;
+			break;
+		}
+		case GrObjectType::kOcclusionQuery:
+			static_cast<OcclusionQueryImpl&>(*obj).m_available = true;
+			break;
+		case GrObjectType::kPipelineQuery:
+			static_cast<PipelineQueryImpl&>(*obj).m_available = true;
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+	m_queries.destroy();
+
+	// The work is done so release the commands and the references now
+	getGrManagerImpl().releaseCommandStream(m_stream);
+	m_stream = nullptr;
+}
+
+void CommandBufferImpl::drawcallCommon()
+{
+	commandCommon();
+	ANKI_ASSERT(m_graphicsProg);
+	ANKI_ASSERT(m_insideRenderpass);
+
+	m_graphicsProg->m_graphics.m_pipelineFactory->flushState(m_graphicsState, *m_stream);
+
+	m_descriptorState.flush(*m_stream);
+
+	ANKI_TRACE_INC_COUNTER(NullDrawcall, 1);
+}
+
+ANKI_FORCE_INLINE void CommandBufferImpl::dispatchCommon()
+{
+	ANKI_ASSERT(m_computeProg);
+
+	commandCommon();
+
+	m_descriptorState.flush(*m_stream);
+}
+
+void CommandBufferImpl::recordDrawIndirect(NullCommandType type, PrimitiveTopology topology, const BufferView& argBuffer, U32 argBufferStride,
+										   const BufferView& countBuffer, U32 drawCount)
+{
+	NullCmdDrawIndirect cmd = {};
+	cmd.m_argBuffer = argBuffer.getBuffer().getUuid();
+	cmd.m_argBufferOffset = argBuffer.getOffset();
+	if(countBuffer.isValid())
+	{
+		cmd.m_countBuffer = countBuffer.getBuffer().getUuid();
+		cmd.m_countBufferOffset = countBuffer.getOffset();
+	}
+	cmd.m_drawCount = drawCount;
+	cmd.m_stride = argBufferStride;
+	cmd.m_topology = topology;
+	m_stream->pushCommand(type, cmd);
+}
+
+} // end namespace anki
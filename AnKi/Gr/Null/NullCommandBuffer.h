@@ -0,0 +1,115 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/CommandBuffer.h>
+#include <AnKi/Gr/Null/NullCommandStream.h>
+#include <AnKi/Gr/Null/NullDescriptor.h>
+#include <AnKi/Gr/Null/NullGraphicsState.h>
+#include <AnKi/Gr/Null/NullShaderProgram.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Command buffer implementation. It validates and records the commands into a NullCommandStream.
+class CommandBufferImpl final : public CommandBuffer
+{
+	friend class CommandBuffer;
+
+public:
+	/// Default constructor
+	CommandBufferImpl(CString name)
+		: CommandBuffer(name)
+	{
+	}
+
+	~CommandBufferImpl();
+
+	Error init(const CommandBufferInitInfo& init);
+
+	Bool isEmpty() const
+	{
+		return m_empty;
+	}
+
+	void endRecording();
+
+	Bool isFinalized() const
+	{
+		return m_finalized;
+	}
+
+	/// "Execute" the commands. Called by the GrManager on submit.
+	void postSubmitWork();
+
+private:
+	NullCommandStream* m_stream = nullptr;
+
+	/// The queries that will get their results when the command buffer is submitted. The stream holds the references.
+	GrDynamicArray<GrObject*> m_queries;
+
+	ThreadId m_tid = ~ThreadId(0);
+	Bool m_finalized : 1 = false;
+	Bool m_empty : 1 = true;
+	Bool m_debugMarkers : 1 = false;
+#if ANKI_ASSERTIONS_ENABLED
+	U32 m_commandCount = 0;
+	U32 m_debugMarkersPushed = 0;
+	Bool m_submitted = false;
+	Bool m_insideRenderpass = false;
+#endif
+
+	GraphicsStateTracker m_graphicsState;
+	DescriptorState m_descriptorState;
+
+	ShaderProgramImpl* m_graphicsProg ANKI_DEBUG_CODE(= nullptr); ///< Last bound graphics program
+	ShaderProgramImpl* m_computeProg ANKI_DEBUG_CODE(= nullptr);
+	ShaderProgramImpl* m_rtProg ANKI_DEBUG_CODE(= nullptr);
+
+	/// Some common operations per command.
+	ANKI_FORCE_INLINE void commandCommon()
+	{
+		ANKI_ASSERT(!m_finalized);
+#if ANKI_EXTRA_CHECKS
+		++m_commandCount;
+#endif
+		m_empty = false;
+
+		ANKI_ASSERT(Thread::getCurrentThreadId() == m_tid && "Commands must be recorder and flushed by the thread this command buffer was created");
+		ANKI_ASSERT(m_stream);
+	}
+
+	void drawcallCommon();
+
+	void dispatchCommon();
+
+	void recordDrawIndirect(NullCommandType type, PrimitiveTopology topology, const BufferView& argBuffer, U32 argBufferStride,
+							const BufferView& countBuffer, U32 drawCount);
+
+	const ShaderProgramImpl& getBoundProgram()
+	{
+		if(m_graphicsProg)
+		{
+			ANKI_ASSERT(m_computeProg == nullptr && m_rtProg == nullptr);
+			return *m_graphicsProg;
+		}
+		else if(m_computeProg)
+		{
+			ANKI_ASSERT(m_graphicsProg == nullptr && m_rtProg == nullptr);
+			return *m_computeProg;
+		}
+		else
+		{
+			ANKI_ASSERT(m_graphicsProg == nullptr && m_computeProg == nullptr && m_rtProg != nullptr);
+			return *m_rtProg;
+		}
+	}
+};
+/// @}
+
+} // end namespace anki
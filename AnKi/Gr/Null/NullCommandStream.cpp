@@ -0,0 +1,200 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullCommandStream.h>
+
+namespace anki {
+
+static Error dumpPayload(const NullCmdEmpty&, ConstWeakArray<U8>, File&)
+{
+	return Error::kNone;
+}
+
+static Error dumpPayload(const NullCmdObject& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" object:%" PRIu64, cmd.m_uuid);
+}
+
+static Error dumpPayload(const NullCmdBindVertexBuffer& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" binding:%u buffer:%" PRIu64 " offset:%zu stride:%u stepRate:%u", cmd.m_binding, cmd.m_buffer, cmd.m_offset, cmd.m_stride,
+						   U32(cmd.m_stepRate));
+}
+
+static Error dumpPayload(const NullCmdBindIndexBuffer& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" buffer:%" PRIu64 " offset:%zu type:%u", cmd.m_buffer, cmd.m_offset, U32(cmd.m_indexType));
+}
+
+static Error dumpPayload(const NullCmdBindShaderProgram& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" program:%" PRIu64 " shaderTypes:0x%x", cmd.m_program, U32(cmd.m_shaderTypes));
+}
+
+static Error dumpPayload(const NullCmdBindGraphicsPipeline& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" hash:0x%" PRIx64, cmd.m_hash);
+}
+
+static Error dumpPayload(const NullCmdRect& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" %u %u %u %u", cmd.m_rect[0], cmd.m_rect[1], cmd.m_rect[2], cmd.m_rect[3]);
+}
+
+static Error dumpPayload(const NullCmdBindDescriptorSet& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" set:%u descriptors:%u hash:0x%" PRIx64, cmd.m_set, cmd.m_descriptorCount, cmd.m_hash);
+}
+
+static Error dumpPayload(const NullCmdSetPushConstants& cmd, ConstWeakArray<U8> extra, File& file)
+{
+	ANKI_ASSERT(cmd.m_size == extra.getSize());
+	return file.writeTextf(" size:%u hash:0x%" PRIx64, cmd.m_size, computeHash(extra.getBegin(), extra.getSizeInBytes()));
+}
+
+static Error dumpPayload(const NullCmdBeginRenderPass& cmd, ConstWeakArray<U8>, File& file)
+{
+	for(U32 i = 0; i < cmd.m_colorRtCount; ++i)
+	{
+		ANKI_CHECK(file.writeTextf(" color%u:%" PRIu64, i, cmd.m_colorRts[i]));
+	}
+
+	if(cmd.m_depthStencilRt)
+	{
+		ANKI_CHECK(file.writeTextf(" depthStencil:%" PRIu64, cmd.m_depthStencilRt));
+	}
+
+	return file.writeTextf(" area:%u,%u,%u,%u%s", cmd.m_renderArea[0], cmd.m_renderArea[1], cmd.m_renderArea[2], cmd.m_renderArea[3],
+						   (cmd.m_drawsToSwapchain) ? " swapchain" : "");
+}
+
+static Error dumpPayload(const NullCmdDraw& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" topology:%u count:%u instances:%u first:%u baseVertex:%u baseInstance:%u", U32(cmd.m_topology), cmd.m_count,
+						   cmd.m_instanceCount, cmd.m_first, cmd.m_baseVertex, cmd.m_baseInstance);
+}
+
+static Error dumpPayload(const NullCmdDrawIndirect& cmd, ConstWeakArray<U8>, File& file)
+{
+	ANKI_CHECK(file.writeTextf(" topology:%u argBuffer:%" PRIu64 " argOffset:%zu drawCount:%u stride:%u", U32(cmd.m_topology), cmd.m_argBuffer,
+							   cmd.m_argBufferOffset, cmd.m_drawCount, cmd.m_stride));
+
+	if(cmd.m_countBuffer)
+	{
+		ANKI_CHECK(file.writeTextf(" countBuffer:%" PRIu64 " countOffset:%zu", cmd.m_countBuffer, cmd.m_countBufferOffset));
+	}
+
+	return Error::kNone;
+}
+
+static Error dumpPayload(const NullCmdDispatch& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" groups:%u,%u,%u", cmd.m_groupCount[0], cmd.m_groupCount[1], cmd.m_groupCount[2]);
+}
+
+static Error dumpPayload(const NullCmdTextureOp& cmd, ConstWeakArray<U8>, File& file)
+{
+	ANKI_CHECK(file.writeTextf(" texture:%" PRIu64 " mip:%u face:%u layer:%u%s", cmd.m_texture, cmd.m_mipmap, cmd.m_face, cmd.m_layer,
+							   (cmd.m_allSurfacesOrVolumes) ? " all" : ""));
+
+	if(cmd.m_buffer)
+	{
+		ANKI_CHECK(file.writeTextf(" buffer:%" PRIu64 " offset:%zu", cmd.m_buffer, cmd.m_bufferOffset));
+	}
+
+	return Error::kNone;
+}
+
+static Error dumpPayload(const NullCmdBufferOp& cmd, ConstWeakArray<U8>, File& file)
+{
+	ANKI_CHECK(file.writeTextf(" buffer:%" PRIu64 " offset:%zu range:%zu value:%u", cmd.m_buffer, cmd.m_offset, cmd.m_range, cmd.m_value));
+
+	if(cmd.m_object)
+	{
+		ANKI_CHECK(file.writeTextf(" object:%" PRIu64, cmd.m_object));
+	}
+
+	return Error::kNone;
+}
+
+static Error dumpPayload(const NullCmdCopyBufferToBuffer& cmd, ConstWeakArray<U8> extra, File& file)
+{
+	ANKI_ASSERT(cmd.m_copyCount * sizeof(CopyBufferToBufferInfo) == extra.getSize());
+	ANKI_CHECK(file.writeTextf(" src:%" PRIu64 " dst:%" PRIu64, cmd.m_srcBuffer, cmd.m_dstBuffer));
+
+	for(U32 i = 0; i < cmd.m_copyCount; ++i)
+	{
+		CopyBufferToBufferInfo copy;
+		memcpy(&copy, &extra[i * sizeof(CopyBufferToBufferInfo)], sizeof(copy));
+		ANKI_CHECK(file.writeTextf(" [%zu->%zu %zu]", copy.m_sourceOffset, copy.m_destinationOffset, copy.m_range));
+	}
+
+	return Error::kNone;
+}
+
+static Error dumpPayload(const NullCmdPipelineBarrier& cmd, ConstWeakArray<U8>, File& file)
+{
+	return file.writeTextf(" textures:%u buffers:%u accelerationStructures:%u hash:0x%" PRIx64, cmd.m_textureBarrierCount, cmd.m_bufferBarrierCount,
+						   cmd.m_asBarrierCount, cmd.m_hash);
+}
+
+static Error dumpPayload(const NullCmdPushDebugMarker& cmd, ConstWeakArray<U8> extra, File& file)
+{
+	ANKI_ASSERT(cmd.m_nameLength == extra.getSize());
+	return file.writeTextf(" \"%.*s\"", I32(cmd.m_nameLength), reinterpret_cast<const Char*>(extra.getBegin()));
+}
+
+Error NullCommandStream::dump(File& file) const
+{
+	PtrSize offset = 0;
+	U32 depth = 1;
+	while(offset < m_size)
+	{
+		NullCommandHeader header;
+		memcpy(&header, &m_data[offset], sizeof(header));
+		offset += sizeof(header);
+		ANKI_ASSERT(offset + header.m_payloadSize <= m_size);
+
+		if((header.m_type == NullCommandType::kPopDebugMarker || header.m_type == NullCommandType::kEndRenderPass) && depth > 1)
+		{
+			--depth;
+		}
+
+		ANKI_CHECK(file.writeTextf("%*s", I32(depth * 2), ""));
+
+		switch(header.m_type)
+		{
+#define ANKI_NULL_COMMAND_DEF(name, payload) \
+	case NullCommandType::k##name: \
+	{ \
+		payload cmd; \
+		ANKI_ASSERT(header.m_payloadSize >= sizeof(cmd)); \
+		memcpy(&cmd, &m_data[offset], sizeof(cmd)); \
+		const ConstWeakArray<U8> extra((header.m_payloadSize > sizeof(cmd)) ? &m_data[offset + sizeof(cmd)] : nullptr, \
+									   U32(header.m_payloadSize - sizeof(cmd))); \
+		ANKI_CHECK(file.writeText(ANKI_STRINGIZE(name))); \
+		ANKI_CHECK(dumpPayload(cmd, extra, file)); \
+		break; \
+	}
+#include <AnKi/Gr/Null/NullCommands.def.h>
+#undef ANKI_NULL_COMMAND_DEF
+		default:
+			ANKI_ASSERT(0);
+		}
+
+		ANKI_CHECK(file.writeText("\n"));
+
+		if(header.m_type == NullCommandType::kPushDebugMarker || header.m_type == NullCommandType::kBeginRenderPass)
+		{
+			++depth;
+		}
+
+		offset += header.m_payloadSize;
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
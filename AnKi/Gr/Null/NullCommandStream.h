@@ -0,0 +1,270 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Gr/CommandBuffer.h>
+#include <AnKi/Util/File.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// @name Command payloads. They are memcpy'ed into the stream so keep them POD.
+/// @{
+class NullCmdEmpty
+{
+public:
+	U8 m_unused = 0;
+};
+
+class NullCmdObject
+{
+public:
+	U64 m_uuid;
+};
+
+class NullCmdBindVertexBuffer
+{
+public:
+	U64 m_buffer;
+	PtrSize m_offset;
+	U32 m_binding;
+	U32 m_stride;
+	VertexStepRate m_stepRate;
+};
+
+class NullCmdBindIndexBuffer
+{
+public:
+	U64 m_buffer;
+	PtrSize m_offset;
+	IndexType m_indexType;
+};
+
+class NullCmdBindShaderProgram
+{
+public:
+	U64 m_program;
+	ShaderTypeBit m_shaderTypes;
+};
+
+class NullCmdBindGraphicsPipeline
+{
+public:
+	U64 m_hash;
+};
+
+class NullCmdRect
+{
+public:
+	Array<U32, 4> m_rect;
+};
+
+class NullCmdBindDescriptorSet
+{
+public:
+	U64 m_hash;
+	U32 m_set;
+	U32 m_descriptorCount;
+};
+
+/// Followed by the push constant data.
+class NullCmdSetPushConstants
+{
+public:
+	U32 m_size;
+};
+
+class NullCmdBeginRenderPass
+{
+public:
+	Array<U64, kMaxColorRenderTargets> m_colorRts;
+	U64 m_depthStencilRt;
+	Array<U32, 4> m_renderArea;
+	U32 m_colorRtCount;
+	Bool m_drawsToSwapchain;
+};
+
+class NullCmdDraw
+{
+public:
+	PrimitiveTopology m_topology;
+	U32 m_count;
+	U32 m_instanceCount;
+	U32 m_first;
+	U32 m_baseVertex;
+	U32 m_baseInstance;
+};
+
+class NullCmdDrawIndirect
+{
+public:
+	U64 m_argBuffer;
+	PtrSize m_argBufferOffset;
+	U64 m_countBuffer;
+	PtrSize m_countBufferOffset;
+	U32 m_drawCount;
+	U32 m_stride;
+	PrimitiveTopology m_topology;
+};
+
+class NullCmdDispatch
+{
+public:
+	Array<U32, 3> m_groupCount;
+};
+
+class NullCmdTextureOp
+{
+public:
+	U64 m_texture;
+	U64 m_buffer;
+	PtrSize m_bufferOffset;
+	U32 m_mipmap;
+	U32 m_face;
+	U32 m_layer;
+	Bool m_allSurfacesOrVolumes;
+};
+
+class NullCmdBufferOp
+{
+public:
+	U64 m_buffer;
+	PtrSize m_offset;
+	PtrSize m_range;
+	U64 m_object; ///< An optional object that participates in the operation.
+	U32 m_value;
+};
+
+/// Followed by an array of CopyBufferToBufferInfo.
+class NullCmdCopyBufferToBuffer
+{
+public:
+	U64 m_srcBuffer;
+	U64 m_dstBuffer;
+	U32 m_copyCount;
+};
+
+class NullCmdPipelineBarrier
+{
+public:
+	U64 m_hash; ///< Hash of all the barriers.
+	U32 m_textureBarrierCount;
+	U32 m_bufferBarrierCount;
+	U32 m_asBarrierCount;
+};
+
+/// Followed by the marker name (without the null terminator).
+class NullCmdPushDebugMarker
+{
+public:
+	Array<F32, 3> m_color;
+	U32 m_nameLength;
+};
+/// @}
+
+/// A linear stream of recorded commands. Every command is a NullCommandHeader followed by its payload and optionally some extra data.
+/// It also marks the objects that need to stay alive until the commands are "executed" with the frame the stream belongs to. The GrManagerImpl
+/// recycles the streams so the memory is reused from frame to frame.
+class NullCommandStream
+{
+public:
+	NullCommandStream() = default;
+
+	NullCommandStream(const NullCommandStream&) = delete; // Non-copyable
+
+	NullCommandStream& operator=(const NullCommandStream&) = delete; // Non-copyable
+
+	template<typename TPayload>
+	void pushCommand(NullCommandType type, const TPayload& payload, const void* extraData = nullptr, U32 extraDataSize = 0)
+	{
+		static_assert(std::is_trivially_copyable_v<TPayload>);
+		ANKI_ASSERT(type < NullCommandType::kCount);
+		ANKI_ASSERT(sizeof(TPayload) + extraDataSize <= kMaxU16);
+
+		NullCommandHeader header;
+		header.m_type = type;
+		header.m_payloadSize = U16(sizeof(TPayload) + extraDataSize);
+
+		U8* out = allocate(sizeof(header) + header.m_payloadSize);
+		memcpy(out, &header, sizeof(header));
+		memcpy(out + sizeof(header), &payload, sizeof(TPayload));
+		if(extraDataSize)
+		{
+			memcpy(out + sizeof(header) + sizeof(TPayload), extraData, extraDataSize);
+		}
+
+		++m_commandCount;
+	}
+
+	/// Keep the object alive until the frame of the stream is done.
+	template<typename T>
+	void pushObjectRef(T* x)
+	{
+		static_assert(T::kClassType != GrObjectType::kTexture && T::kClassType != GrObjectType::kBuffer,
+					  "No need to push references of buffers and textures");
+		ANKI_ASSERT(x);
+		m_trackedObjectCount += x->markUsedInFrame(m_frameEpoch);
+	}
+
+	/// Set the frame the commands are recorded.
+	void setFrameEpoch(U64 frameEpoch)
+	{
+		m_frameEpoch = frameEpoch;
+	}
+
+	/// Drop the commands but keep the memory.
+	void reset()
+	{
+		m_size = 0;
+		m_commandCount = 0;
+		m_trackedObjectCount = 0;
+	}
+
+	/// The number of objects that were marked for the 1st time in this frame by this stream.
+	U32 getTrackedObjectCount() const
+	{
+		return m_trackedObjectCount;
+	}
+
+	U32 getCommandCount() const
+	{
+		return m_commandCount;
+	}
+
+	PtrSize getSizeInBytes() const
+	{
+		return m_size;
+	}
+
+	/// Decode the stream and write it in a human readable form.
+	Error dump(File& file) const;
+
+private:
+	GrDynamicArray<U8, PtrSize> m_data;
+	PtrSize m_size = 0;
+	U32 m_commandCount = 0;
+
+	U64 m_frameEpoch = 0;
+	U32 m_trackedObjectCount = 0;
+
+	U8* allocate(PtrSize size)
+	{
+		if(m_size + size > m_data.getSize()) [[unlikely]]
+		{
+			m_data.resize(max<PtrSize>(m_size + size, max<PtrSize>(m_data.getSize() * 2, 4_KB)));
+		}
+
+		U8* out = &m_data[m_size];
+		m_size += size;
+		return out;
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,43 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// ANKI_NULL_COMMAND_DEF(name, payload class)
+
+ANKI_NULL_COMMAND_DEF(BindVertexBuffer, NullCmdBindVertexBuffer)
+ANKI_NULL_COMMAND_DEF(BindIndexBuffer, NullCmdBindIndexBuffer)
+ANKI_NULL_COMMAND_DEF(BindShaderProgram, NullCmdBindShaderProgram)
+ANKI_NULL_COMMAND_DEF(BindGraphicsPipeline, NullCmdBindGraphicsPipeline)
+ANKI_NULL_COMMAND_DEF(SetViewport, NullCmdRect)
+ANKI_NULL_COMMAND_DEF(SetScissor, NullCmdRect)
+ANKI_NULL_COMMAND_DEF(BindDescriptorSet, NullCmdBindDescriptorSet)
+ANKI_NULL_COMMAND_DEF(SetPushConstants, NullCmdSetPushConstants)
+ANKI_NULL_COMMAND_DEF(BeginRenderPass, NullCmdBeginRenderPass)
+ANKI_NULL_COMMAND_DEF(EndRenderPass, NullCmdEmpty)
+ANKI_NULL_COMMAND_DEF(Draw, NullCmdDraw)
+ANKI_NULL_COMMAND_DEF(DrawIndexed, NullCmdDraw)
+ANKI_NULL_COMMAND_DEF(DrawIndirect, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(DrawIndexedIndirect, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(DrawIndirectCount, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(DrawIndexedIndirectCount, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(DrawMeshTasks, NullCmdDispatch)
+ANKI_NULL_COMMAND_DEF(DrawMeshTasksIndirect, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(DispatchCompute, NullCmdDispatch)
+ANKI_NULL_COMMAND_DEF(DispatchComputeIndirect, NullCmdDrawIndirect)
+ANKI_NULL_COMMAND_DEF(TraceRays, NullCmdDispatch)
+ANKI_NULL_COMMAND_DEF(ClearTexture, NullCmdTextureOp)
+ANKI_NULL_COMMAND_DEF(CopyBufferToTexture, NullCmdTextureOp)
+ANKI_NULL_COMMAND_DEF(FillBuffer, NullCmdBufferOp)
+ANKI_NULL_COMMAND_DEF(CopyBufferToBuffer, NullCmdCopyBufferToBuffer)
+ANKI_NULL_COMMAND_DEF(WriteOcclusionQueriesResultToBuffer, NullCmdBufferOp)
+ANKI_NULL_COMMAND_DEF(BuildAccelerationStructure, NullCmdBufferOp)
+ANKI_NULL_COMMAND_DEF(Upscale, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(PipelineBarrier, NullCmdPipelineBarrier)
+ANKI_NULL_COMMAND_DEF(BeginOcclusionQuery, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(EndOcclusionQuery, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(BeginPipelineQuery, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(EndPipelineQuery, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(WriteTimestamp, NullCmdObject)
+ANKI_NULL_COMMAND_DEF(PushDebugMarker, NullCmdPushDebugMarker)
+ANKI_NULL_COMMAND_DEF(PopDebugMarker, NullCmdEmpty)
@@ -0,0 +1,54 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Common.h>
+#include <AnKi/Gr/BackendCommon/Common.h>
+#include <AnKi/Util/Logger.h>
+
+namespace anki {
+
+// Forward
+class GrManagerImpl;
+
+/// @addtogroup null
+/// @{
+
+#define ANKI_NULL_LOGI(...) ANKI_LOG("NULL", kNormal, __VA_ARGS__)
+#define ANKI_NULL_LOGE(...) ANKI_LOG("NULL", kError, __VA_ARGS__)
+#define ANKI_NULL_LOGW(...) ANKI_LOG("NULL", kWarning, __VA_ARGS__)
+#define ANKI_NULL_LOGF(...) ANKI_LOG("NULL", kFatal, __VA_ARGS__)
+#define ANKI_NULL_LOGV(...) ANKI_LOG("NULL", kVerbose, __VA_ARGS__)
+
+#define ANKI_NULL_SELF(class_) class_& self = *static_cast<class_*>(this)
+#define ANKI_NULL_SELF_CONST(class_) const class_& self = *static_cast<const class_*>(this)
+
+ANKI_PURE GrManagerImpl& getGrManagerImpl();
+
+/// The commands that the null backend records.
+enum class NullCommandType : U8
+{
+#define ANKI_NULL_COMMAND_DEF(name, payload) k##name,
+#include <AnKi/Gr/Null/NullCommands.def.h>
+#undef ANKI_NULL_COMMAND_DEF
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(NullCommandType)
+
+/// Precedes the payload of every recorded command.
+class NullCommandHeader
+{
+public:
+	NullCommandType m_type;
+	U8 m_padding = 0;
+	U16 m_payloadSize; ///< In bytes.
+};
+static_assert(sizeof(NullCommandHeader) == 4);
+/// @}
+
+} // end namespace anki
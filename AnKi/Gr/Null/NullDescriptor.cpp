@@ -0,0 +1,77 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullDescriptor.h>
+#include <AnKi/Gr/Null/NullCommandStream.h>
+#include <AnKi/Core/StatsSet.h>
+
+namespace anki {
+
+static StatCounter g_descriptorSetsWrittenStatVar(StatCategory::kMisc, "DescriptorSets written this frame", StatFlag::kZeroEveryFrame);
+
+void DescriptorState::flush(NullCommandStream& stream)
+{
+	ANKI_ASSERT(m_refl);
+	const ShaderReflectionDescriptorRelated& refl = *m_refl;
+
+	for(U32 iset = 0; iset < kMaxDescriptorSets; ++iset)
+	{
+		DescriptorSet& set = m_sets[iset];
+
+		// The bindless set has no bindings so it's skipped as well
+		if(!set.m_dirty || refl.m_bindingCounts[iset] == 0)
+		{
+			continue;
+		}
+
+		set.m_dirty = false;
+
+		// Hash the descriptors the program reads. That's the closest thing to writing a real descriptor set
+		StreamingHasher hasher;
+		U32 descriptorCount = 0;
+		for(U32 ibinding = 0; ibinding < refl.m_bindingCounts[iset]; ++ibinding)
+		{
+			const ShaderReflectionBinding& binding = refl.m_bindings[iset][ibinding];
+			const HlslResourceType hlslType = descriptorTypeToHlslResourceType(binding.m_type, binding.m_flags);
+
+			for(U32 arrayIdx = 0; arrayIdx < binding.m_arraySize; ++arrayIdx)
+			{
+				ANKI_ASSERT(binding.m_registerBindingPoint + arrayIdx < set.m_descriptors[hlslType].getSize() && "Forgot to bind something");
+				const Descriptor& desc = set.m_descriptors[hlslType][binding.m_registerBindingPoint + arrayIdx];
+
+				ANKI_ASSERT(desc.m_type == binding.m_type && desc.m_flags == binding.m_flags && "Have bound the wrong type");
+
+				hasher.appendObject(desc.m_uuid);
+				hasher.appendObject(desc.m_offset);
+				hasher.appendObject(desc.m_range);
+				++descriptorCount;
+			}
+		}
+
+		NullCmdBindDescriptorSet cmd;
+		cmd.m_hash = (descriptorCount) ? hasher.getHash() : 0;
+		cmd.m_set = iset;
+		cmd.m_descriptorCount = descriptorCount;
+		stream.pushCommand(NullCommandType::kBindDescriptorSet, cmd);
+
+		g_descriptorSetsWrittenStatVar.increment(1);
+	}
+
+	// Set push consts
+	if(refl.m_pushConstantsSize)
+	{
+		ANKI_ASSERT(refl.m_pushConstantsSize == m_pushConstSize && "Possibly forgot to set push constants");
+
+		if(m_pushConstantsDirty)
+		{
+			NullCmdSetPushConstants cmd;
+			cmd.m_size = m_pushConstSize;
+			stream.pushCommand(NullCommandType::kSetPushConstants, cmd, m_pushConsts.getBegin(), m_pushConstSize);
+			m_pushConstantsDirty = false;
+		}
+	}
+}
+
+} // end namespace anki
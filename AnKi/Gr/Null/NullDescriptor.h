@@ -0,0 +1,113 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Forward
+class NullCommandStream;
+
+/// @addtogroup null
+/// @{
+
+/// Part of the command buffer that deals with descriptors. It tracks the bindings the same way the other backends do and records a
+/// BindDescriptorSet command for every set that changed.
+class DescriptorState
+{
+public:
+	~DescriptorState()
+	{
+		for(DescriptorSet& set : m_sets)
+		{
+			for(auto& arr : set.m_descriptors)
+			{
+				arr.destroy();
+			}
+		}
+	}
+
+	void setReflection(const ShaderReflectionDescriptorRelated* refl)
+	{
+		ANKI_ASSERT(refl);
+		if(refl != m_refl)
+		{
+			m_refl = refl;
+			m_pushConstantsDirty = m_pushConstantsDirty || (m_pushConstSize != m_refl->m_pushConstantsSize);
+
+			for(DescriptorSet& set : m_sets)
+			{
+				set.m_dirty = true;
+			}
+		}
+	}
+
+	void bindObject(HlslResourceType hlslType, U32 space, U32 registerBinding, U64 uuid, PtrSize offset, PtrSize range,
+					[[maybe_unused]] DescriptorType type, [[maybe_unused]] DescriptorFlag flags)
+	{
+		ANKI_ASSERT(uuid);
+		Descriptor& desc = getDescriptor(hlslType, space, registerBinding);
+		desc.m_uuid = uuid;
+		desc.m_offset = offset;
+		desc.m_range = range;
+#if ANKI_ASSERTIONS_ENABLED
+		desc.m_type = type;
+		desc.m_flags = flags;
+#endif
+	}
+
+	void setPushConstants(const void* data, U32 dataSize)
+	{
+		ANKI_ASSERT(data && dataSize && dataSize <= kMaxPushConstantSize);
+		memcpy(m_pushConsts.getBegin(), data, dataSize);
+		m_pushConstSize = dataSize;
+		m_pushConstantsDirty = true;
+	}
+
+	void flush(NullCommandStream& stream);
+
+private:
+	class Descriptor
+	{
+	public:
+		U64 m_uuid = 0;
+		PtrSize m_offset = 0;
+		PtrSize m_range = 0;
+
+#if ANKI_ASSERTIONS_ENABLED
+		DescriptorType m_type = DescriptorType::kCount;
+		DescriptorFlag m_flags = DescriptorFlag::kNone;
+#endif
+	};
+
+	class DescriptorSet
+	{
+	public:
+		Array<GrDynamicArray<Descriptor>, U32(HlslResourceType::kCount)> m_descriptors;
+		Bool m_dirty = true; ///< Needs rebind
+	};
+
+	const ShaderReflectionDescriptorRelated* m_refl = nullptr;
+	Array<DescriptorSet, kMaxDescriptorSets> m_sets;
+
+	Array<U8, kMaxPushConstantSize> m_pushConsts;
+	U32 m_pushConstSize = 0;
+	Bool m_pushConstantsDirty = true;
+
+	Descriptor& getDescriptor(HlslResourceType svv, U32 space, U32 registerBinding)
+	{
+		if(registerBinding >= m_sets[space].m_descriptors[svv].getSize())
+		{
+			m_sets[space].m_descriptors[svv].resize(registerBinding + 1);
+		}
+		m_sets[space].m_dirty = true;
+		return m_sets[space].m_descriptors[svv][registerBinding];
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,20 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullFence.h>
+
+namespace anki {
+
+Fence* Fence::newInstance()
+{
+	return anki::newInstance<FenceImpl>(GrMemoryPool::getSingleton(), "N/A");
+}
+
+Bool Fence::clientWait([[maybe_unused]] Second seconds)
+{
+	return true;
+}
+
+} // end namespace anki
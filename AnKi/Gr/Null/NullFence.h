@@ -0,0 +1,31 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Fence.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Fence implementation. The work is "done" the moment it's submitted so fences are always signaled.
+class FenceImpl final : public Fence
+{
+public:
+	FenceImpl(CString name)
+		: Fence(name)
+	{
+	}
+
+	~FenceImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
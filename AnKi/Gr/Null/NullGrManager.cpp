@@ -0,0 +1,391 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullGrManager.h>
+#include <AnKi/Gr/Null/NullCommandStream.h>
+#include <AnKi/Gr/Null/NullAccelerationStructure.h>
+#include <AnKi/Gr/Null/NullBuffer.h>
+#include <AnKi/Gr/Null/NullCommandBuffer.h>
+#include <AnKi/Gr/Null/NullFence.h>
+#include <AnKi/Gr/Null/NullGrUpscaler.h>
+#include <AnKi/Gr/Null/NullOcclusionQuery.h>
+#include <AnKi/Gr/Null/NullPipelineQuery.h>
+#include <AnKi/Gr/Null/NullSampler.h>
+#include <AnKi/Gr/Null/NullShader.h>
+#include <AnKi/Gr/Null/NullShaderProgram.h>
+#include <AnKi/Gr/Null/NullTexture.h>
+#include <AnKi/Gr/Null/NullTimestampQuery.h>
+#include <AnKi/Gr/RenderGraph.h>
+#include <AnKi/Window/NativeWindow.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+BoolCVar g_validationCVar(CVarSubsystem::kGr, "Validation", false, "Enable or not validation");
+BoolCVar g_vsyncCVar(CVarSubsystem::kGr, "Vsync", false, "Enable or not vsync");
+BoolCVar g_debugMarkersCVar(CVarSubsystem::kGr, "DebugMarkers", false, "Enable or not debug markers");
+BoolCVar g_meshShadersCVar(CVarSubsystem::kGr, "MeshShaders", false, "Enable or not mesh shaders");
+StringCVar g_nullCommandDumpCVar(CVarSubsystem::kGr, "NullCommandDump", "",
+								 "If not empty the NULL backend will write the submitted commands to that file");
+
+template<>
+template<>
+GrManager& MakeSingletonPtr<GrManager>::allocateSingleton<>()
+{
+	ANKI_ASSERT(m_global == nullptr);
+	m_global = new GrManagerImpl;
+
+#if ANKI_ASSERTIONS_ENABLED
+	++g_singletonsAllocated;
+#endif
+
+	return *m_global;
+}
+
+template<>
+void MakeSingletonPtr<GrManager>::freeSingleton()
+{
+	if(m_global)
+	{
+		delete static_cast<GrManagerImpl*>(m_global);
+		m_global = nullptr;
+#if ANKI_ASSERTIONS_ENABLED
+		--g_singletonsAllocated;
+#endif
+	}
+}
+
+GrManager::GrManager()
+{
+}
+
+GrManager::~GrManager()
+{
+}
+
+Error GrManager::init(GrManagerInitInfo& inf)
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+	return self.initInternal(inf);
+}
+
+TexturePtr GrManager::acquireNextPresentableTexture()
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+	self.recreateSwapchainTextureIfNeeded();
+	return self.m_swapchainTexture;
+}
+
+void GrManager::swapBuffers()
+{
+	ANKI_TRACE_SCOPED_EVENT(NullSwapBuffers);
+	ANKI_NULL_SELF(GrManagerImpl);
+
+	const U64 endedFrame = self.m_frameEpoch.fetchAdd(1);
+
+	{
+		LockGuard lock(self.m_dumpFileMtx);
+		if(self.m_dumpFile.isOpen())
+		{
+			if(self.m_dumpFile.writeTextf("Frame %" PRIu64 "\n", endedFrame))
+			{
+				ANKI_NULL_LOGE("Failed to write to the command dump file");
+			}
+		}
+	}
+
+	// All the command buffers of the frame that ended have been submitted and the "GPU" is done with them
+	self.collectObjectGarbage(endedFrame + 1);
+}
+
+void GrManager::deleteObjectDeferred(GrObject* obj)
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+
+	if(obj->getLastUsedFrame() < self.getFrameEpoch())
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), obj);
+	}
+	else
+	{
+		LockGuard lock(self.m_objectGarbageMtx);
+		self.m_objectGarbage.emplaceBack(obj);
+	}
+}
+
+void GrManager::finish()
+{
+	// Everything is complete at submit time
+}
+
+#define ANKI_NEW_GR_OBJECT(type) \
+	type##Ptr GrManager::new##type(const type##InitInfo& init) \
+	{ \
+		type##Ptr ptr(type::newInstance(init)); \
+		if(!ptr.isCreated()) [[unlikely]] \
+		{ \
+			ANKI_NULL_LOGF("Failed to create a " ANKI_STRINGIZE(type) " object"); \
+		} \
+		return ptr; \
+	}
+
+#define ANKI_NEW_GR_OBJECT_NO_INIT_INFO(type) \
+	type##Ptr GrManager::new##type() \
+	{ \
+		type##Ptr ptr(type::newInstance()); \
+		if(!ptr.isCreated()) [[unlikely]] \
+		{ \
+			ANKI_NULL_LOGF("Failed to create a " ANKI_STRINGIZE(type) " object"); \
+		} \
+		return ptr; \
+	}
+
+ANKI_NEW_GR_OBJECT(Buffer)
+ANKI_NEW_GR_OBJECT(Texture)
+ANKI_NEW_GR_OBJECT(Sampler)
+ANKI_NEW_GR_OBJECT(Shader)
+ANKI_NEW_GR_OBJECT(ShaderProgram)
+ANKI_NEW_GR_OBJECT(CommandBuffer)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(OcclusionQuery)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(TimestampQuery)
+ANKI_NEW_GR_OBJECT(PipelineQuery)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(RenderGraph)
+ANKI_NEW_GR_OBJECT(AccelerationStructure)
+ANKI_NEW_GR_OBJECT(GrUpscaler)
+
+#undef ANKI_NEW_GR_OBJECT
+#undef ANKI_NEW_GR_OBJECT_NO_INIT_INFO
+
+void GrManager::submit(WeakArray<CommandBuffer*> cmdbs, [[maybe_unused]] WeakArray<Fence*> waitFences, FencePtr* signalFence)
+{
+	ANKI_TRACE_SCOPED_EVENT(NullSubmit);
+
+	// The "GPU" executes everything right here so there is nothing to wait for
+	for(CommandBuffer* cmdb : cmdbs)
+	{
+		static_cast<CommandBufferImpl&>(*cmdb).postSubmitWork();
+	}
+
+	if(signalFence)
+	{
+		FenceImpl* fenceImpl = anki::newInstance<FenceImpl>(GrMemoryPool::getSingleton(), "SignalFence");
+		signalFence->reset(fenceImpl);
+	}
+}
+
+GrManagerImpl::~GrManagerImpl()
+{
+	destroy();
+}
+
+Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
+{
+	ANKI_NULL_LOGI("Initializing NULL backend");
+
+	GrMemoryPool::allocateSingleton(init.m_allocCallback, init.m_allocCallbackUserData);
+
+	m_cacheDir = init.m_cacheDirectory;
+
+	// Capabilities. Pick values that don't restrict the renderer
+	m_capabilities.m_uniformBufferBindOffsetAlignment = 256;
+	m_capabilities.m_uniformBufferMaxRange = 64_KB;
+	m_capabilities.m_storageBufferBindOffsetAlignment = max<U32>(ANKI_SAFE_ALIGNMENT, 16);
+	m_capabilities.m_storageBufferMaxRange = 1_GB;
+	m_capabilities.m_texelBufferBindOffsetAlignment = max<U32>(ANKI_SAFE_ALIGNMENT, 16);
+	m_capabilities.m_textureBufferMaxRange = kMaxU32;
+	m_capabilities.m_pushConstantsSize = kMaxPushConstantSize;
+	m_capabilities.m_computeSharedMemorySize = 32_KB;
+	m_capabilities.m_accelerationStructureBuildScratchOffsetAlignment = 256;
+	m_capabilities.m_sbtRecordAlignment = 64;
+	m_capabilities.m_maxDrawIndirectCount = kMaxU32;
+	m_capabilities.m_minSubgroupSize = 32;
+	m_capabilities.m_maxSubgroupSize = 32;
+	m_capabilities.m_gpuVendor = GpuVendor::kUnknown;
+	m_capabilities.m_discreteGpu = false;
+	m_capabilities.m_majorApiVersion = 1;
+	m_capabilities.m_minorApiVersion = 3;
+	m_capabilities.m_rayTracingEnabled = false;
+	m_capabilities.m_64bitAtomics = true;
+	m_capabilities.m_vrs = false;
+	m_capabilities.m_samplingFilterMinMax = true;
+	m_capabilities.m_unalignedBbpTextureFormats = false;
+	m_capabilities.m_dlss = false;
+	m_capabilities.m_meshShaders = false;
+	m_capabilities.m_pipelineQuery = true;
+	m_capabilities.m_barycentrics = true;
+
+	if(g_meshShadersCVar.get())
+	{
+		ANKI_NULL_LOGW("Mesh shaders are not supported by the NULL backend");
+	}
+
+	// Dump file
+	if(!g_nullCommandDumpCVar.get().isEmpty())
+	{
+		ANKI_CHECK(m_dumpFile.open(g_nullCommandDumpCVar.get(), FileOpenFlag::kWrite));
+		ANKI_NULL_LOGI("Will dump the submitted commands to: %s", g_nullCommandDumpCVar.get().cstr());
+	}
+
+	recreateSwapchainTextureIfNeeded();
+
+	return Error::kNone;
+}
+
+void GrManagerImpl::destroy()
+{
+	ANKI_NULL_LOGI("Destroying NULL backend");
+
+	collectObjectGarbage(kMaxU64);
+	ANKI_ASSERT(m_objectGarbage.getSize() == 0);
+	m_objectGarbage.destroy();
+
+	m_swapchainTexture.reset(nullptr);
+
+	for(NullCommandStream* stream : m_freeCommandStreams)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), stream);
+	}
+	m_freeCommandStreams.destroy();
+
+	ANKI_ASSERT(m_freeBindlessIndices.getSize() == m_bindlessIndexCount && "Some bindless indices were not freed");
+	m_freeBindlessIndices.destroy();
+
+	m_dumpFile.close();
+
+	m_cacheDir.destroy();
+	GrMemoryPool::freeSingleton();
+}
+
+void GrManagerImpl::collectObjectGarbage(U64 firstFrameInFlight)
+{
+	GrDynamicArray<GrObject*> deadObjects;
+	do
+	{
+		deadObjects.destroy();
+
+		{
+			LockGuard lock(m_objectGarbageMtx);
+
+			U32 aliveCount = 0;
+			for(GrObject* obj : m_objectGarbage)
+			{
+				if(obj->getLastUsedFrame() < firstFrameInFlight)
+				{
+					deadObjects.emplaceBack(obj);
+				}
+				else
+				{
+					m_objectGarbage[aliveCount++] = obj;
+				}
+			}
+
+			m_objectGarbage.resize(aliveCount);
+		}
+
+		// Delete outside the lock because the objects might release other objects that come back to the m_objectGarbage
+		for(GrObject* obj : deadObjects)
+		{
+			deleteInstance(GrMemoryPool::getSingleton(), obj);
+		}
+	} while(deadObjects.getSize());
+}
+
+void GrManagerImpl::recreateSwapchainTextureIfNeeded()
+{
+	const U32 width = (NativeWindow::isAllocated()) ? NativeWindow::getSingleton().getWidth() : 1;
+	const U32 height = (NativeWindow::isAllocated()) ? NativeWindow::getSingleton().getHeight() : 1;
+
+	if(m_swapchainTexture.isCreated() && m_swapchainTexture->getWidth() == width && m_swapchainTexture->getHeight() == height) [[likely]]
+	{
+		return;
+	}
+
+	TextureInitInfo init("SwapchainImg");
+	init.m_width = width;
+	init.m_height = height;
+	init.m_format = Format::kR8G8B8A8_Unorm;
+	init.m_usage = TextureUsageBit::kStorageComputeWrite | TextureUsageBit::kStorageTraceRaysWrite | TextureUsageBit::kFramebufferRead
+				   | TextureUsageBit::kFramebufferWrite | TextureUsageBit::kPresent;
+	init.m_type = TextureType::k2D;
+
+	TextureImpl* tex = anki::newInstance<TextureImpl>(GrMemoryPool::getSingleton(), init.getName());
+	[[maybe_unused]] const Error err = tex->init(init);
+	ANKI_ASSERT(!err);
+	m_swapchainTexture.reset(tex);
+}
+
+NullCommandStream* GrManagerImpl::newCommandStream()
+{
+	{
+		LockGuard lock(m_commandStreamsMtx);
+		if(m_freeCommandStreams.getSize())
+		{
+			NullCommandStream* stream = m_freeCommandStreams.getBack();
+			m_freeCommandStreams.popBack();
+			return stream;
+		}
+	}
+
+	return anki::newInstance<NullCommandStream>(GrMemoryPool::getSingleton());
+}
+
+void GrManagerImpl::releaseCommandStream(NullCommandStream* stream)
+{
+	ANKI_ASSERT(stream);
+	stream->reset();
+
+	LockGuard lock(m_commandStreamsMtx);
+	m_freeCommandStreams.emplaceBack(stream);
+}
+
+U32 GrManagerImpl::allocateBindlessIndex()
+{
+	LockGuard lock(m_bindlessIndicesMtx);
+
+	if(m_freeBindlessIndices.getSize())
+	{
+		const U32 idx = m_freeBindlessIndices.getBack();
+		m_freeBindlessIndices.popBack();
+		return idx;
+	}
+
+	if(m_bindlessIndexCount >= g_maxBindlessSampledTextureCountCVar.get())
+	{
+		ANKI_NULL_LOGF("Out of bindless texture indices");
+	}
+
+	return m_bindlessIndexCount++;
+}
+
+void GrManagerImpl::freeBindlessIndex(U32 idx)
+{
+	LockGuard lock(m_bindlessIndicesMtx);
+	ANKI_ASSERT(idx < m_bindlessIndexCount);
+	m_freeBindlessIndices.emplaceBack(idx);
+}
+
+void GrManagerImpl::dumpCommandStream(const NullCommandStream& stream, CString cmdbName)
+{
+	LockGuard lock(m_dumpFileMtx);
+
+	if(!m_dumpFile.isOpen())
+	{
+		return;
+	}
+
+	Error err =
+		m_dumpFile.writeTextf("CommandBuffer \"%s\" commands:%u bytes:%zu\n", cmdbName.cstr(), stream.getCommandCount(), stream.getSizeInBytes());
+	if(!err)
+	{
+		err = stream.dump(m_dumpFile);
+	}
+
+	if(err)
+	{
+		ANKI_NULL_LOGE("Failed to write to the command dump file");
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,101 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/GrManager.h>
+#include <AnKi/Gr/Texture.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Util/File.h>
+
+namespace anki {
+
+// Forward
+class NullCommandStream;
+extern StringCVar g_nullCommandDumpCVar;
+
+/// @addtogroup null
+/// @{
+
+/// Null implementation of GrManager. There is no device. The command buffers record their commands into a NullCommandStream and the "GPU"
+/// completes all the work the moment it's submitted.
+class GrManagerImpl : public GrManager
+{
+	friend class GrManager;
+
+public:
+	GrManagerImpl()
+	{
+	}
+
+	~GrManagerImpl();
+
+	Error initInternal(const GrManagerInitInfo& cfg);
+
+	/// Return a GPU address that doesn't overlap with any other object. Thread-safe.
+	U64 allocateFakeGpuAddress(PtrSize size)
+	{
+		return m_fakeGpuAddress.fetchAdd(getAlignedRoundUp(kFakeGpuAddressAlignment, max<PtrSize>(size, 1)));
+	}
+
+	/// @name Command stream recycling. Thread-safe.
+	/// @{
+	NullCommandStream* newCommandStream();
+
+	void releaseCommandStream(NullCommandStream* stream);
+	/// @}
+
+	/// @name Bindless texture indices. Thread-safe.
+	/// @{
+	U32 allocateBindlessIndex();
+
+	void freeBindlessIndex(U32 idx);
+	/// @}
+
+	Bool isDumpingCommands() const
+	{
+		return m_dumpFile.isOpen();
+	}
+
+	/// Write the commands of a submitted stream to the dump file (if there is one). Thread-safe.
+	void dumpCommandStream(const NullCommandStream& stream, CString cmdbName);
+
+	/// The number of objects that wait for their frame to finish before they get deleted. Thread-safe.
+	U32 getObjectGarbageCount()
+	{
+		LockGuard lock(m_objectGarbageMtx);
+		return m_objectGarbage.getSize();
+	}
+
+private:
+	static constexpr PtrSize kFakeGpuAddressAlignment = 256;
+
+	Atomic<U64> m_fakeGpuAddress = {kFakeGpuAddressAlignment};
+
+	TexturePtr m_swapchainTexture;
+
+	GrDynamicArray<NullCommandStream*> m_freeCommandStreams;
+	Mutex m_commandStreamsMtx;
+
+	GrDynamicArray<U32> m_freeBindlessIndices;
+	U32 m_bindlessIndexCount = 0; ///< The number of the indices that were ever handed out.
+	Mutex m_bindlessIndicesMtx;
+
+	File m_dumpFile;
+	Mutex m_dumpFileMtx;
+
+	GrDynamicArray<GrObject*> m_objectGarbage;
+	Mutex m_objectGarbageMtx;
+
+	void destroy();
+
+	/// Delete the objects that were last used in a frame before firstFrameInFlight.
+	void collectObjectGarbage(U64 firstFrameInFlight);
+
+	void recreateSwapchainTextureIfNeeded();
+};
+/// @}
+
+} // end namespace anki
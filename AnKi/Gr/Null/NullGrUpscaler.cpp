@@ -0,0 +1,29 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullGrUpscaler.h>
+
+namespace anki {
+
+GrUpscaler* GrUpscaler::newInstance(const GrUpscalerInitInfo& initInfo)
+{
+	GrUpscalerImpl* impl = anki::newInstance<GrUpscalerImpl>(GrMemoryPool::getSingleton(), initInfo.getName());
+	const Error err = impl->initInternal(initInfo);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+Error GrUpscalerImpl::initInternal(const GrUpscalerInitInfo& initInfo)
+{
+	ANKI_ASSERT(initInfo.m_upscalerType != GrUpscalerType::kCount);
+	m_upscalerType = initInfo.m_upscalerType;
+	return Error::kNone;
+}
+
+} // end namespace anki
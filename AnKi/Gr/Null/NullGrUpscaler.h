@@ -0,0 +1,33 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/GrUpscaler.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Upscaler implementation. It only records the upscale command.
+class GrUpscalerImpl final : public GrUpscaler
+{
+public:
+	GrUpscalerImpl(CString name)
+		: GrUpscaler(name)
+	{
+	}
+
+	~GrUpscalerImpl()
+	{
+	}
+
+	Error initInternal(const GrUpscalerInitInfo& initInfo);
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,80 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullGraphicsState.h>
+#include <AnKi/Gr/Null/NullCommandStream.h>
+#include <AnKi/Core/StatsSet.h>
+
+namespace anki {
+
+static StatCounter g_nullPipelinesCreatedStatVar(StatCategory::kMisc, "NULL pipelines created", StatFlag::kNone);
+
+GraphicsPipelineFactory::~GraphicsPipelineFactory()
+{
+	m_map.destroy();
+}
+
+void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, NullCommandStream& stream)
+{
+	GraphicsStateTracker::DynamicState& dynState = state.m_dynState;
+
+	// Dynamic state. Only the viewport and the scissor are recorded, the rest are just consumed
+	dynState.m_stencilCompareMaskDirty = false;
+	dynState.m_stencilWriteMaskDirty = false;
+	dynState.m_stencilRefDirty = false;
+	dynState.m_depthBiasDirty = false;
+	dynState.m_lineWidthDirty = false;
+
+	if(dynState.m_viewportDirty)
+	{
+		ANKI_ASSERT(dynState.m_viewport[2] != 0 && dynState.m_viewport[3] != 0);
+		dynState.m_viewportDirty = false;
+
+		NullCmdRect cmd;
+		cmd.m_rect = dynState.m_viewport;
+		stream.pushCommand(NullCommandType::kSetViewport, cmd);
+	}
+
+	if(dynState.m_scissorDirty)
+	{
+		dynState.m_scissorDirty = false;
+
+		const U32 minx = min(dynState.m_scissor[0], state.m_rtsSize.x());
+		const U32 miny = min(dynState.m_scissor[1], state.m_rtsSize.y());
+		NullCmdRect cmd;
+		cmd.m_rect = {minx, miny, min(dynState.m_scissor[2], state.m_rtsSize.x() - minx), min(dynState.m_scissor[3], state.m_rtsSize.y() - miny)};
+		stream.pushCommand(NullCommandType::kSetScissor, cmd);
+	}
+
+	// Static state
+	const Bool rebindPso = state.updateHashes();
+
+	// Find the PSO
+	Bool found = false;
+	{
+		RLockGuard<RWMutex> lock(m_mtx);
+		found = m_map.find(state.m_globalHash) != m_map.getEnd();
+	}
+
+	if(!found) [[unlikely]]
+	{
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		if(m_map.find(state.m_globalHash) == m_map.getEnd())
+		{
+			m_map.emplace(state.m_globalHash, m_map.getSize());
+			g_nullPipelinesCreatedStatVar.increment(1);
+		}
+	}
+
+	if(rebindPso || !found)
+	{
+		NullCmdBindGraphicsPipeline cmd;
+		cmd.m_hash = state.m_globalHash;
+		stream.pushCommand(NullCommandType::kBindGraphicsPipeline, cmd);
+	}
+}
+
+} // end namespace anki
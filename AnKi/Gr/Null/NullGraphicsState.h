@@ -0,0 +1,37 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
+#include <AnKi/Util/SwissHashMap.h>
+
+namespace anki {
+
+// Forward
+class NullCommandStream;
+
+/// @addtogroup null
+/// @{
+
+/// There are no real pipelines. The factory only remembers the state hashes it has seen so the cost of hashing and looking up the state is
+/// the same as in the other backends.
+class GraphicsPipelineFactory
+{
+public:
+	~GraphicsPipelineFactory();
+
+	/// Write state to the command stream.
+	/// @note It's thread-safe.
+	void flushState(GraphicsStateTracker& state, NullCommandStream& stream);
+
+private:
+	GrSwissHashMap<U64, U32> m_map; ///< State hash to pipeline index.
+	RWMutex m_mtx;
+};
+/// @}
+
+} // end namespace anki
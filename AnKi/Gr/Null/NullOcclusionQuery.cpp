@@ -0,0 +1,21 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullOcclusionQuery.h>
+
+namespace anki {
+
+OcclusionQuery* OcclusionQuery::newInstance()
+{
+	return anki::newInstance<OcclusionQueryImpl>(GrMemoryPool::getSingleton(), "N/A");
+}
+
+OcclusionQueryResult OcclusionQuery::getResult() const
+{
+	ANKI_NULL_SELF_CONST(OcclusionQueryImpl);
+	return (self.m_available) ? OcclusionQueryResult::kVisible : OcclusionQueryResult::kNotAvailable;
+}
+
+} // end namespace anki
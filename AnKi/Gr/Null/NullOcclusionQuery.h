@@ -0,0 +1,33 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/OcclusionQuery.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Occlusion query implementation. Everything is visible once the query is submitted.
+class OcclusionQueryImpl final : public OcclusionQuery
+{
+public:
+	Bool m_available = false;
+
+	OcclusionQueryImpl(CString name)
+		: OcclusionQuery(name)
+	{
+	}
+
+	~OcclusionQueryImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,31 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullPipelineQuery.h>
+
+namespace anki {
+
+PipelineQuery* PipelineQuery::newInstance(const PipelineQueryInitInfo& inf)
+{
+	ANKI_ASSERT(inf.m_type < PipelineQueryType::kCount);
+	PipelineQueryImpl* impl = anki::newInstance<PipelineQueryImpl>(GrMemoryPool::getSingleton(), inf.getName());
+	impl->m_type = inf.m_type;
+	return impl;
+}
+
+PipelineQueryResult PipelineQuery::getResult(U64& value) const
+{
+	ANKI_NULL_SELF_CONST(PipelineQueryImpl);
+
+	if(self.m_available)
+	{
+		value = 0;
+		return PipelineQueryResult::kAvailable;
+	}
+
+	return PipelineQueryResult::kNotAvailable;
+}
+
+} // end namespace anki
@@ -0,0 +1,34 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/PipelineQuery.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Pipeline query implementation. Nothing gets executed so the result is always zero.
+class PipelineQueryImpl final : public PipelineQuery
+{
+public:
+	PipelineQueryType m_type = PipelineQueryType::kCount;
+	Bool m_available = false;
+
+	PipelineQueryImpl(CString name)
+		: PipelineQuery(name)
+	{
+	}
+
+	~PipelineQueryImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,28 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullSampler.h>
+
+namespace anki {
+
+Sampler* Sampler::newInstance(const SamplerInitInfo& init)
+{
+	SamplerImpl* impl = anki::newInstance<SamplerImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+Error SamplerImpl::init(const SamplerInitInfo& inf)
+{
+	m_info = inf;
+	return Error::kNone;
+}
+
+} // end namespace anki
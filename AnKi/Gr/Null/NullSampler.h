@@ -0,0 +1,35 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Sampler.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Sampler implementation.
+class SamplerImpl final : public Sampler
+{
+public:
+	SamplerInitInfo m_info;
+
+	SamplerImpl(CString name)
+		: Sampler(name)
+	{
+	}
+
+	~SamplerImpl()
+	{
+	}
+
+	Error init(const SamplerInitInfo& init);
+};
+/// @}
+
+} // end namespace anki
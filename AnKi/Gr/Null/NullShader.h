@@ -0,0 +1,33 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Shader.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Shader implementation. Only the reflection is useful, the binary is never executed.
+class ShaderImpl final : public Shader
+{
+public:
+	ShaderReflection m_reflection;
+
+	ShaderImpl(CString name)
+		: Shader(name)
+	{
+	}
+
+	~ShaderImpl();
+
+	Error init(const ShaderInitInfo& init);
+};
+/// @}
+
+} // end namespace anki
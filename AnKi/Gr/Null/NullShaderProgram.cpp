@@ -0,0 +1,124 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullShaderProgram.h>
+#include <AnKi/Gr/Null/NullShader.h>
+#include <AnKi/Gr/Null/NullGraphicsState.h>
+
+namespace anki {
+
+ShaderProgram* ShaderProgram::newInstance(const ShaderProgramInitInfo& init)
+{
+	ShaderProgramImpl* impl = anki::newInstance<ShaderProgramImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+ConstWeakArray<U8> ShaderProgram::getShaderGroupHandles() const
+{
+	ANKI_ASSERT(!"Ray tracing is not supported by the NULL backend");
+	return ConstWeakArray<U8>();
+}
+
+Buffer& ShaderProgram::getShaderGroupHandlesGpuBuffer() const
+{
+	ANKI_ASSERT(!"Ray tracing is not supported by the NULL backend");
+	void* ptr = nullptr;
+	return *reinterpret_cast<Buffer*>(ptr);
+}
+
+ShaderProgramImpl::~ShaderProgramImpl()
+{
+	deleteInstance(GrMemoryPool::getSingleton(), m_graphics.m_pipelineFactory);
+}
+
+Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	// Create the shader references
+	if(inf.m_computeShader)
+	{
+		m_shaders.emplaceBack(inf.m_computeShader);
+	}
+	else if(inf.m_graphicsShaders[ShaderType::kFragment])
+	{
+		for(Shader* s : inf.m_graphicsShaders)
+		{
+			if(s)
+			{
+				m_shaders.emplaceBack(s);
+			}
+		}
+	}
+	else
+	{
+		for(Shader* s : inf.m_rayTracingShaders.m_rayGenShaders)
+		{
+			m_shaders.emplaceBack(s);
+		}
+
+		for(Shader* s : inf.m_rayTracingShaders.m_missShaders)
+		{
+			m_shaders.emplaceBack(s);
+		}
+
+		for(const RayTracingHitGroup& group : inf.m_rayTracingShaders.m_hitGroups)
+		{
+			if(group.m_anyHitShader)
+			{
+				m_shaders.emplaceBack(group.m_anyHitShader);
+			}
+
+			if(group.m_closestHitShader)
+			{
+				m_shaders.emplaceBack(group.m_closestHitShader);
+			}
+		}
+	}
+
+	ANKI_ASSERT(m_shaders.getSize() > 0);
+
+	// Link reflection
+	Bool firstLink = true;
+	for(ShaderPtr& shader : m_shaders)
+	{
+		m_shaderTypes |= ShaderTypeBit(1 << shader->getShaderType());
+
+		const ShaderImpl& simpl = static_cast<const ShaderImpl&>(*shader);
+		if(firstLink)
+		{
+			m_refl = simpl.m_reflection;
+			firstLink = false;
+		}
+		else
+		{
+			ANKI_CHECK(ShaderReflection::linkShaderReflection(m_refl, simpl.m_reflection, m_refl));
+		}
+
+		m_refl.validate();
+	}
+
+	// Get shader sizes
+	for(const ShaderPtr& s : m_shaders)
+	{
+		m_shaderBinarySizes[s->getShaderType()] = s->getShaderBinarySize();
+	}
+
+	// Misc
+	if(!!(m_shaderTypes & ShaderTypeBit::kAllGraphics))
+	{
+		m_graphics.m_pipelineFactory = anki::newInstance<GraphicsPipelineFactory>(GrMemoryPool::getSingleton());
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
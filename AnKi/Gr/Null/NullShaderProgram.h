@@ -0,0 +1,43 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/ShaderProgram.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Forward
+class GraphicsPipelineFactory;
+
+/// @addtogroup null
+/// @{
+
+/// Shader program implementation.
+class ShaderProgramImpl final : public ShaderProgram
+{
+public:
+	class
+	{
+	public:
+		GraphicsPipelineFactory* m_pipelineFactory = nullptr;
+	} m_graphics;
+
+	ShaderProgramImpl(CString name)
+		: ShaderProgram(name)
+	{
+	}
+
+	~ShaderProgramImpl();
+
+	Error init(const ShaderProgramInitInfo& inf);
+
+private:
+	GrDynamicArray<ShaderPtr> m_shaders;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,77 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullTexture.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+Texture* Texture::newInstance(const TextureInitInfo& init)
+{
+	ANKI_ASSERT(!(init.m_usage & TextureUsageBit::kPresent));
+	TextureImpl* impl = anki::newInstance<TextureImpl>(GrMemoryPool::getSingleton(), init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+U32 Texture::getOrCreateBindlessTextureIndex(const TextureSubresourceDesc& subresource)
+{
+	ANKI_NULL_SELF(TextureImpl);
+	ANKI_ASSERT(TextureView(this, subresource).isGoodForSampling());
+
+	const U64 hash = computeHash(&subresource, sizeof(subresource));
+
+	LockGuard lock(self.m_bindlessIndicesMtx);
+
+	auto it = self.m_bindlessIndices.find(hash);
+	if(it != self.m_bindlessIndices.getEnd())
+	{
+		return *it;
+	}
+
+	const U32 idx = getGrManagerImpl().allocateBindlessIndex();
+	self.m_bindlessIndices.emplace(hash, idx);
+	return idx;
+}
+
+TextureImpl::~TextureImpl()
+{
+	for(U32 idx : m_bindlessIndices)
+	{
+		getGrManagerImpl().freeBindlessIndex(idx);
+	}
+}
+
+Error TextureImpl::init(const TextureInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+	m_width = init.m_width;
+	m_height = init.m_height;
+	m_depth = init.m_depth;
+	m_layerCount = init.m_layerCount;
+	m_texType = init.m_type;
+	m_usage = init.m_usage;
+	m_format = init.m_format;
+	m_aspect = getFormatInfo(init.m_format).isDepth() ? DepthStencilAspectBit::kDepth : DepthStencilAspectBit::kNone;
+	m_aspect |= getFormatInfo(init.m_format).isStencil() ? DepthStencilAspectBit::kStencil : DepthStencilAspectBit::kNone;
+
+	if(m_texType == TextureType::k3D)
+	{
+		m_mipCount = min<U32>(init.m_mipmapCount, computeMaxMipmapCount3d(m_width, m_height, m_depth));
+	}
+	else
+	{
+		m_mipCount = min<U32>(init.m_mipmapCount, computeMaxMipmapCount2d(m_width, m_height));
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
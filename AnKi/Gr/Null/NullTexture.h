@@ -0,0 +1,44 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Texture.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Util/HashMap.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Texture implementation. There is no memory behind it, only the description.
+class TextureImpl final : public Texture
+{
+	friend class Texture;
+
+public:
+	TextureImpl(CString name)
+		: Texture(name)
+	{
+	}
+
+	~TextureImpl();
+
+	/// Only the GrManagerImpl is allowed to create presentable textures.
+	Error init(const TextureInitInfo& init);
+
+	Bool usageValid(TextureUsageBit usage) const
+	{
+		return (m_usage & usage) == usage;
+	}
+
+private:
+	GrHashMap<U64, U32> m_bindlessIndices; ///< Subresource hash to bindless index.
+	Mutex m_bindlessIndicesMtx;
+};
+/// @}
+
+} // end namespace anki
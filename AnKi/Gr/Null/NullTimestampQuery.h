@@ -0,0 +1,34 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/TimestampQuery.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+/// @addtogroup null
+/// @{
+
+/// Timestamp query implementation. The CPU time of the submission is used as the timestamp.
+class TimestampQueryImpl final : public TimestampQuery
+{
+public:
+	Second m_timestamp = 0.0;
+	Bool m_available = false;
+
+	TimestampQueryImpl(CString name)
+		: TimestampQuery(name)
+	{
+	}
+
+	~TimestampQueryImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -14,11 +14,18 @@
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Core/Common.h>
+#include <AnKi/Core/StatsSet.h>
 
 namespace anki {
 
 #define ANKI_DBG_RENDER_GRAPH 0
 
+BoolCVar g_renderGraphCompileCacheCVar(CVarSubsystem::kGr, "RenderGraphCompileCache", true,
+									   "Re-use the previous compilation of the RenderGraph if the topology of the graph didn't change");
+
+static StatCounter g_rgraphCompileTimeStatVar(StatCategory::kTime, "RenderGraph compile", StatFlag::kMilisecond | StatFlag::kShowAverage);
+static StatCounter g_rgraphCompileCacheMissesStatVar(StatCategory::kMisc, "RenderGraph compile cache misses", StatFlag::kNone);
+
 static inline U32 getTextureSurfOrVolCount(const TexturePtr& tex)
 {
 	return tex->getMipmapCount() * tex->getLayerCount() * (textureTypeIsCube(tex->getTextureType()) ? 6 : 1);
@@ -207,6 +214,25 @@ public:
 	}
 };
 
+/// The outcome of a full compilation. The batches and the barriers reference passes and resources by index so they can be re-used by any graph that
+/// has the same topology.
+class RenderGraph::BakeCache
+{
+public:
+	class Batch
+	{
+	public:
+		GrDynamicArray<U32> m_passIndices;
+		GrDynamicArray<TextureBarrier> m_textureBarriersBefore;
+		GrDynamicArray<BufferBarrier> m_bufferBarriersBefore;
+		GrDynamicArray<ASBarrier> m_asBarriersBefore;
+	};
+
+	GrDynamicArray<Batch> m_batches;
+	GrDynamicArray<TextureUsageBit> m_surfOrVolFinalUsages; ///< The usages of all surfaces of all RTs at the end of the graph.
+	U64 m_topologyHash = 0;
+};
+
 RenderGraph::RenderGraph(CString name)
 	: GrObject(kClassType, name)
 {
@@ -215,6 +241,11 @@ RenderGraph::RenderGraph(CString name)
 RenderGraph::~RenderGraph()
 {
 	ANKI_ASSERT(m_ctx == nullptr);
+
+	if(m_bakeCache)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), m_bakeCache);
+	}
 }
 
 RenderGraph* RenderGraph::newInstance()
@@ -586,7 +617,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphBuilder& desc
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphBuilder& descr)
+void RenderGraph::initRenderPasses(const RenderGraphBuilder& descr)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -613,6 +644,18 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphBuilder& descr)
 			ANKI_ASSERT(sizeof(inf) == sizeof(inDep.m_texture));
 			memcpy(&inf, &inDep.m_texture, sizeof(inf));
 		}
+	}
+}
+
+void RenderGraph::setPassDependencies(const RenderGraphBuilder& descr)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 passCount = descr.m_passes.getSize();
+
+	for(U32 passIdx = 0; passIdx < passCount; ++passIdx)
+	{
+		const RenderPassBase& inPass = *descr.m_passes[passIdx];
+		Pass& outPass = ctx.m_passes[passIdx];
 
 		// Set dependencies by checking all previous subpasses.
 		U32 prevPassIdx = passIdx;
@@ -1031,36 +1074,233 @@ void RenderGraph::sortBatchPasses()
 	}
 }
 
+U64 RenderGraph::computeTopologyHash(const RenderGraphBuilder& descr) const
+{
+	ANKI_TRACE_SCOPED_EVENT(GrRenderGraphTopologyHash);
+
+	const BakeContext& ctx = *m_ctx;
+
+	// Pack everything into a flat array and hash it once. Avoid hashing the structs directly because they have padding
+	DynamicArray<U64, MemoryPoolPtrWrapper<StackMemoryPool>> words(descr.m_pool);
+	words.resizeStorage(1 + ctx.m_rts.getSize() * 2 + ctx.m_buffers.getSize() + ctx.m_as.getSize() + descr.m_passes.getSize() * 8);
+
+	words.emplaceBack(U64(descr.m_passes.getSize()) | (U64(ctx.m_rts.getSize()) << 16u) | (U64(ctx.m_buffers.getSize()) << 32u)
+					  | (U64(ctx.m_as.getSize()) << 48u));
+
+	// The barriers depend on the layout of the RTs and the usages the resources have when entering the graph
+	for(const RT& rt : ctx.m_rts)
+	{
+		const Texture& tex = *rt.m_texture;
+		words.emplaceBack(U64(tex.getMipmapCount()) | (U64(tex.getLayerCount()) << 8u) | (U64(textureTypeIsCube(tex.getTextureType())) << 40u));
+
+		for(const TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			words.emplaceBack(U64(usage));
+		}
+	}
+
+	for(const BufferRange& buff : ctx.m_buffers)
+	{
+		words.emplaceBack(U64(buff.m_usage));
+	}
+
+	for(const AS& as : ctx.m_as)
+	{
+		words.emplaceBack(U64(as.m_usage));
+	}
+
+	// The dependencies of the passes
+	for(const RenderPassBase* pass : descr.m_passes)
+	{
+		const Bool hasRenderpass = pass->m_type == RenderPassBase::Type::kGraphics && static_cast<const GraphicsRenderPass*>(pass)->hasRenderpass();
+
+		words.emplaceBack(U64(hasRenderpass) | (U64(pass->m_rtDeps.getSize()) << 1u) | (U64(pass->m_buffDeps.getSize()) << 22u)
+						  | (U64(pass->m_asDeps.getSize()) << 43u));
+
+		for(const RenderPassDependency& dep : pass->m_rtDeps)
+		{
+			words.emplaceBack(U64(dep.m_texture.m_handle.m_idx) | (U64(dep.m_texture.m_usage) << 32u));
+
+			static_assert(sizeof(TextureSubresourceDesc) == sizeof(U64));
+			U64 subresource;
+			memcpy(&subresource, &dep.m_texture.m_subresource, sizeof(subresource));
+			words.emplaceBack(subresource);
+		}
+
+		for(const RenderPassDependency& dep : pass->m_buffDeps)
+		{
+			words.emplaceBack(U64(dep.m_buffer.m_handle.m_idx));
+			words.emplaceBack(U64(dep.m_buffer.m_usage));
+		}
+
+		for(const RenderPassDependency& dep : pass->m_asDeps)
+		{
+			words.emplaceBack(U64(dep.m_as.m_handle.m_idx) | (U64(dep.m_as.m_usage) << 32u));
+		}
+	}
+
+	const U64 hash = computeHash(words.getBegin(), words.getSizeInBytes());
+	return (hash) ? hash : 1;
+}
+
+void RenderGraph::storeBakeCache(U64 topologyHash)
+{
+	ANKI_ASSERT(topologyHash);
+	const BakeContext& ctx = *m_ctx;
+
+	if(!m_bakeCache)
+	{
+		m_bakeCache = anki::newInstance<BakeCache>(GrMemoryPool::getSingleton());
+	}
+
+	BakeCache& cache = *m_bakeCache;
+	cache.m_topologyHash = topologyHash;
+
+	cache.m_batches.destroy();
+	cache.m_batches.resize(ctx.m_batches.getSize());
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		const Batch& inBatch = ctx.m_batches[batchIdx];
+		BakeCache::Batch& outBatch = cache.m_batches[batchIdx];
+
+		outBatch.m_passIndices.resize(inBatch.m_passIndices.getSize());
+		memcpy(outBatch.m_passIndices.getBegin(), inBatch.m_passIndices.getBegin(), inBatch.m_passIndices.getSizeInBytes());
+
+		outBatch.m_textureBarriersBefore.resizeStorage(inBatch.m_textureBarriersBefore.getSize());
+		for(const TextureBarrier& barrier : inBatch.m_textureBarriersBefore)
+		{
+			outBatch.m_textureBarriersBefore.emplaceBack(barrier);
+		}
+
+		outBatch.m_bufferBarriersBefore.resizeStorage(inBatch.m_bufferBarriersBefore.getSize());
+		for(const BufferBarrier& barrier : inBatch.m_bufferBarriersBefore)
+		{
+			outBatch.m_bufferBarriersBefore.emplaceBack(barrier);
+		}
+
+		outBatch.m_asBarriersBefore.resizeStorage(inBatch.m_asBarriersBefore.getSize());
+		for(const ASBarrier& barrier : inBatch.m_asBarriersBefore)
+		{
+			outBatch.m_asBarriersBefore.emplaceBack(barrier);
+		}
+	}
+
+	cache.m_surfOrVolFinalUsages.destroy();
+	for(const RT& rt : ctx.m_rts)
+	{
+		for(const TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			cache.m_surfOrVolFinalUsages.emplaceBack(usage);
+		}
+	}
+}
+
+void RenderGraph::restoreBakeCache()
+{
+	ANKI_ASSERT(m_bakeCache);
+	BakeContext& ctx = *m_ctx;
+	const BakeCache& cache = *m_bakeCache;
+	StackMemoryPool* pool = ctx.m_as.getMemoryPool().m_pool;
+
+	ctx.m_batches.resizeStorage(cache.m_batches.getSize());
+	for(const BakeCache::Batch& inBatch : cache.m_batches)
+	{
+		const U32 batchIdx = ctx.m_batches.getSize();
+		Batch& outBatch = *ctx.m_batches.emplaceBack(pool);
+
+		outBatch.m_passIndices.resize(inBatch.m_passIndices.getSize());
+		memcpy(outBatch.m_passIndices.getBegin(), inBatch.m_passIndices.getBegin(), inBatch.m_passIndices.getSizeInBytes());
+		for(const U32 passIdx : inBatch.m_passIndices)
+		{
+			ctx.m_passIsInBatch.set(passIdx);
+			ctx.m_passes[passIdx].m_batchIdx = batchIdx;
+		}
+
+		outBatch.m_textureBarriersBefore.resizeStorage(inBatch.m_textureBarriersBefore.getSize());
+		for(const TextureBarrier& barrier : inBatch.m_textureBarriersBefore)
+		{
+			outBatch.m_textureBarriersBefore.emplaceBack(barrier);
+		}
+
+		outBatch.m_bufferBarriersBefore.resizeStorage(inBatch.m_bufferBarriersBefore.getSize());
+		for(const BufferBarrier& barrier : inBatch.m_bufferBarriersBefore)
+		{
+			outBatch.m_bufferBarriersBefore.emplaceBack(barrier);
+		}
+
+		outBatch.m_asBarriersBefore.resizeStorage(inBatch.m_asBarriersBefore.getSize());
+		for(const ASBarrier& barrier : inBatch.m_asBarriersBefore)
+		{
+			outBatch.m_asBarriersBefore.emplaceBack(barrier);
+		}
+	}
+
+	// The imported RTs need the final usages to carry them to the next frame
+	U32 count = 0;
+	for(RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit& usage : rt.m_surfOrVolUsages)
+		{
+			usage = cache.m_surfOrVolFinalUsages[count++];
+		}
+	}
+	ANKI_ASSERT(count == cache.m_surfOrVolFinalUsages.getSize());
+}
+
 void RenderGraph::compileNewGraph(const RenderGraphBuilder& descr, StackMemoryPool& pool)
 {
 	ANKI_TRACE_SCOPED_EVENT(GrRenderGraphCompile);
+	const Second startTime = HighRezTimer::getCurrentTime();
 
 	// Init the context
 	BakeContext& ctx = *newContext(descr, pool);
 	m_ctx = &ctx;
 
-	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr);
-
-	// Walk the graph and create pass batches
-	initBatches();
-
-	// Now that we know the batches every pass belongs init the graphics passes
-	initGraphicsPasses(descr);
-
-	// Create barriers between batches
-	setBatchBarriers(descr);
+	// Init the passes
+	initRenderPasses(descr);
 
-	// Sort passes in batches
-	if(GrManager::getSingleton().getDeviceCapabilities().m_gpuVendor == GpuVendor::kNvidia)
+	// The graph is usually identical from frame to frame. If the topology is the same as the last one re-use the batches and the barriers
+	const U64 topologyHash = (g_renderGraphCompileCacheCVar.get() && !ANKI_DBG_RENDER_GRAPH) ? computeTopologyHash(descr) : 0;
+	if(topologyHash && m_bakeCache && m_bakeCache->m_topologyHash == topologyHash)
 	{
-		minimizeSubchannelSwitches();
+		restoreBakeCache();
+
+		initGraphicsPasses(descr);
 	}
 	else
 	{
-		sortBatchPasses();
+		g_rgraphCompileCacheMissesStatVar.increment(1);
+
+		// Find the dependencies between passes
+		setPassDependencies(descr);
+
+		// Walk the graph and create pass batches
+		initBatches();
+
+		// Now that we know the batches every pass belongs init the graphics passes
+		initGraphicsPasses(descr);
+
+		// Create barriers between batches
+		setBatchBarriers(descr);
+
+		// Sort passes in batches
+		if(GrManager::getSingleton().getDeviceCapabilities().m_gpuVendor == GpuVendor::kNvidia)
+		{
+			minimizeSubchannelSwitches();
+		}
+		else
+		{
+			sortBatchPasses();
+		}
+
+		if(topologyHash)
+		{
+			storeBakeCache(topologyHash);
+		}
 	}
 
+	g_rgraphCompileTimeStatVar.set((HighRezTimer::getCurrentTime() - startTime) * 1000.0);
+
 #if ANKI_DBG_RENDER_GRAPH
 	if(dumpDependencyDotFile(descr, ctx, "./"))
 	{
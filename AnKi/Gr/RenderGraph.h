@@ -11,7 +11,7 @@
 #include <AnKi/Gr/TimestampQuery.h>
 #include <AnKi/Gr/CommandBuffer.h>
 #include <AnKi/Gr/AccelerationStructure.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/Function.h>
@@ -21,6 +21,7 @@ namespace anki {
 // Forward
 class RenderGraph;
 class RenderGraphBuilder;
+extern BoolCVar g_renderGraphCompileCacheCVar;
 
 /// @addtogroup graphics
 /// @{
@@ -552,6 +553,7 @@ private:
 	class TextureBarrier;
 	class BufferBarrier;
 	class ASBarrier;
+	class BakeCache;
 
 	/// Render targets of the same type+size+format.
 	class RenderTargetCacheEntry
@@ -568,10 +570,11 @@ private:
 		GrDynamicArray<TextureUsageBit> m_surfOrVolLastUsages; ///< Last TextureUsageBit of the imported RT.
 	};
 
-	GrHashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
+	GrSwissHashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
 	GrHashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
 
 	BakeContext* m_ctx = nullptr;
+	BakeCache* m_bakeCache = nullptr; ///< The outcome of the last full compilation.
 	U64 m_version = 0;
 
 	static constexpr U kMaxBufferedTimestamps = kMaxFramesInFlight + 1;
@@ -590,7 +593,8 @@ private:
 	[[nodiscard]] static RenderGraph* newInstance();
 
 	BakeContext* newContext(const RenderGraphBuilder& descr, StackMemoryPool& pool);
-	void initRenderPassesAndSetDeps(const RenderGraphBuilder& descr);
+	void initRenderPasses(const RenderGraphBuilder& descr);
+	void setPassDependencies(const RenderGraphBuilder& descr);
 	void initBatches();
 	void initGraphicsPasses(const RenderGraphBuilder& descr);
 	void setBatchBarriers(const RenderGraphBuilder& descr);
@@ -598,6 +602,11 @@ private:
 	void minimizeSubchannelSwitches();
 	void sortBatchPasses();
 
+	/// Hash everything that affects the batches and the barriers. If the hash is the same as the last compilation's the bake can be re-used.
+	U64 computeTopologyHash(const RenderGraphBuilder& descr) const;
+	void storeBakeCache(U64 topologyHash);
+	void restoreBakeCache();
+
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
 
 	/// Every N number of frames clean unused cached items.
@@ -0,0 +1,182 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Utils/AsyncComputeScheduler.h>
+
+namespace anki {
+
+/// Max of 2 batch indices where kMaxU32 means no batch.
+static U32 maxBatch(U32 a, U32 b)
+{
+	if(a == kMaxU32)
+	{
+		return b;
+	}
+	else if(b == kMaxU32)
+	{
+		return a;
+	}
+	else
+	{
+		return max(a, b);
+	}
+}
+
+void AsyncComputeScheduler::computeJoins(ConstWeakArray<AsyncComputeSchedulerPass> passes, ConstWeakArray<AsyncComputeSchedulerBatch> batches)
+{
+	for(Batch& batch : m_batches)
+	{
+		batch = Batch();
+	}
+
+	for(U32 passIdx = 0; passIdx < passes.getSize(); ++passIdx)
+	{
+		const AsyncComputeSchedulerPass& pass = passes[passIdx];
+		Batch& batch = m_batches[pass.m_batchIdx];
+
+		if(m_passComputeQueue[passIdx])
+		{
+			batch.m_fork = true;
+		}
+		else
+		{
+			++batch.m_generalPassCount;
+		}
+
+		for(U32 dep : pass.m_dependsOn)
+		{
+			ANKI_ASSERT(passes[dep].m_batchIdx < pass.m_batchIdx);
+			if(m_passComputeQueue[dep])
+			{
+				batch.m_join = maxBatch(batch.m_join, passes[dep].m_batchIdx);
+			}
+		}
+	}
+
+	for(U32 batchIdx = 0; batchIdx < batches.getSize(); ++batchIdx)
+	{
+		Batch& batch = m_batches[batchIdx];
+
+		for(U32 dep : batches[batchIdx].m_barriersDependOn)
+		{
+			ANKI_ASSERT(passes[dep].m_batchIdx < batchIdx);
+			if(m_passComputeQueue[dep])
+			{
+				batch.m_join = maxBatch(batch.m_join, passes[dep].m_batchIdx);
+			}
+		}
+	}
+
+	// Waiting for the async compute work of a batch covers the batches before it as well. Remove the redundant joins
+	U32 joinedUpTo = kMaxU32;
+	U32 lastFork = kMaxU32;
+	for(U32 batchIdx = 0; batchIdx < m_batches.getSize(); ++batchIdx)
+	{
+		Batch& batch = m_batches[batchIdx];
+
+		if(batchIdx == m_batches.getSize() - 1)
+		{
+			// Join everything before the last batch
+			batch.m_join = maxBatch(batch.m_join, lastFork);
+		}
+
+		if(batch.m_join != kMaxU32 && (joinedUpTo == kMaxU32 || batch.m_join > joinedUpTo))
+		{
+			joinedUpTo = batch.m_join;
+		}
+		else
+		{
+			batch.m_join = kMaxU32;
+		}
+
+		if(batch.m_fork)
+		{
+			lastFork = batchIdx;
+		}
+	}
+}
+
+void AsyncComputeScheduler::schedule(ConstWeakArray<AsyncComputeSchedulerPass> passes, ConstWeakArray<AsyncComputeSchedulerBatch> batches)
+{
+	const U32 batchCount = batches.getSize();
+	m_passComputeQueue.resize(passes.getSize(), false);
+	m_batches.resize(batchCount);
+
+	// The last batch can't fork since everything is joined before it
+	for(U32 passIdx = 0; passIdx < passes.getSize(); ++passIdx)
+	{
+		ANKI_ASSERT(passes[passIdx].m_batchIdx < batchCount);
+		m_passComputeQueue[passIdx] = passes[passIdx].m_asyncCompute && passes[passIdx].m_batchIdx + 1 < batchCount;
+	}
+
+	// The window of a fork is the batches from the fork until the join. Async compute work that doesn't overlap with general work only adds
+	// synchronization so move it back to the general queue. That changes the joins so iterate until nothing moves
+	auto forEachWindow = [&](auto func) {
+		for(U32 forkIdx = 0; forkIdx < batchCount; ++forkIdx)
+		{
+			if(!m_batches[forkIdx].m_fork)
+			{
+				continue;
+			}
+
+			U32 end = forkIdx + 1;
+			while(m_batches[end].m_join == kMaxU32 || m_batches[end].m_join < forkIdx)
+			{
+				++end;
+				ANKI_ASSERT(end < batchCount && "The last batch should join everything");
+			}
+
+			func(forkIdx, end);
+		}
+	};
+
+	Bool moved = true;
+	while(moved)
+	{
+		computeJoins(passes, batches);
+
+		moved = false;
+		forEachWindow([&](U32 forkIdx, U32 end) {
+			U32 overlap = 0;
+			for(U32 batchIdx = forkIdx; batchIdx < end; ++batchIdx)
+			{
+				overlap += m_batches[batchIdx].m_generalPassCount;
+			}
+
+			if(overlap == 0)
+			{
+				for(U32 passIdx = 0; passIdx < passes.getSize(); ++passIdx)
+				{
+					if(passes[passIdx].m_batchIdx == forkIdx)
+					{
+						m_passComputeQueue[passIdx] = false;
+					}
+				}
+
+				moved = true;
+			}
+		});
+	}
+
+	// Stats
+	m_asyncComputePassCount = 0;
+	for(const Bool computeQueue : m_passComputeQueue)
+	{
+		m_asyncComputePassCount += computeQueue;
+	}
+
+	m_overlappedPassCount = 0;
+	U32 countedUpTo = 0;
+	forEachWindow([&](U32 forkIdx, U32 end) {
+		for(U32 batchIdx = max(forkIdx, countedUpTo); batchIdx < end; ++batchIdx)
+		{
+			m_overlappedPassCount += m_batches[batchIdx].m_generalPassCount;
+		}
+
+		countedUpTo = max(countedUpTo, end);
+	});
+}
+
+} // end namespace anki
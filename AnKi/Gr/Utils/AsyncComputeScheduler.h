@@ -0,0 +1,104 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Common.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup graphics
+/// @{
+
+/// A pass as AsyncComputeScheduler sees it.
+class AsyncComputeSchedulerPass
+{
+public:
+	ConstWeakArray<U32> m_dependsOn; ///< The passes this pass depends on. They should belong to previous batches.
+	U32 m_batchIdx = kMaxU32;
+	Bool m_asyncCompute = false; ///< The pass is allowed to run in the async compute queue.
+};
+
+/// A batch as AsyncComputeScheduler sees it.
+class AsyncComputeSchedulerBatch
+{
+public:
+	/// The passes of previous batches that use resources the barriers of this batch touch. The barriers can't run while those passes run.
+	ConstWeakArray<U32> m_barriersDependOn;
+};
+
+/// Decides which passes of a RenderGraph run in the async compute queue and how the general and the async compute queues synchronize. It doesn't
+/// touch the GPU so it can be used and tested in isolation.
+///
+/// The general queue executes all the barriers and the passes that stay in it. The async compute work of a batch starts after the barriers of that
+/// batch (fork) and the general queue waits for it before the barriers of the first batch that needs its results (join). All async compute work is
+/// joined before the last batch.
+class AsyncComputeScheduler
+{
+public:
+	AsyncComputeScheduler(StackMemoryPool* pool)
+		: m_passComputeQueue(pool)
+		, m_batches(pool)
+	{
+	}
+
+	AsyncComputeScheduler(const AsyncComputeScheduler&) = delete; // Non-copyable
+
+	AsyncComputeScheduler& operator=(const AsyncComputeScheduler&) = delete; // Non-copyable
+
+	/// Do the scheduling. Passes that wouldn't overlap with any work of the general queue stay in the general queue.
+	void schedule(ConstWeakArray<AsyncComputeSchedulerPass> passes, ConstWeakArray<AsyncComputeSchedulerBatch> batches);
+
+	Bool passRunsOnComputeQueue(U32 passIdx) const
+	{
+		return m_passComputeQueue[passIdx];
+	}
+
+	/// The batch has passes that run in the async compute queue.
+	Bool batchForks(U32 batchIdx) const
+	{
+		return m_batches[batchIdx].m_fork;
+	}
+
+	/// Before its barriers the batch needs to wait for the async compute work of the returned batch and all batches before it. Returns kMaxU32 if
+	/// there is no need to wait.
+	U32 getBatchJoin(U32 batchIdx) const
+	{
+		return m_batches[batchIdx].m_join;
+	}
+
+	/// Number of passes that run in the async compute queue.
+	U32 getAsyncComputePassCount() const
+	{
+		return m_asyncComputePassCount;
+	}
+
+	/// Number of passes of the general queue that run in parallel with async compute work.
+	U32 getOverlappedPassCount() const
+	{
+		return m_overlappedPassCount;
+	}
+
+private:
+	class Batch
+	{
+	public:
+		U32 m_join = kMaxU32;
+		U32 m_generalPassCount = 0;
+		Bool m_fork = false;
+	};
+
+	DynamicArray<Bool, MemoryPoolPtrWrapper<StackMemoryPool>> m_passComputeQueue;
+	DynamicArray<Batch, MemoryPoolPtrWrapper<StackMemoryPool>> m_batches;
+	U32 m_asyncComputePassCount = 0;
+	U32 m_overlappedPassCount = 0;
+
+	void computeJoins(ConstWeakArray<AsyncComputeSchedulerPass> passes, ConstWeakArray<AsyncComputeSchedulerBatch> batches);
+};
+/// @}
+
+} // end namespace anki
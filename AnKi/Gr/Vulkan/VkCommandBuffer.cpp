@@ -13,6 +13,7 @@
 #include <AnKi/Gr/Vulkan/VkSampler.h>
 #include <AnKi/Gr/Vulkan/VkAccelerationStructure.h>
 #include <AnKi/Gr/Vulkan/VkShaderProgram.h>
+#include <AnKi/Core/StatsSet.h>
 
 #if ANKI_DLSS
 #	include <ThirdParty/DlssSdk/sdk/include/nvsdk_ngx.h>
@@ -23,6 +24,9 @@
 
 namespace anki {
 
+static StatCounter g_trackedObjectsStatVar(StatCategory::kMisc, "CommandBuffer tracked objects", StatFlag::kZeroEveryFrame);
+static StatCounter g_commandBufferArenaBytesStatVar(StatCategory::kMisc, "CommandBuffer arena bytes", StatFlag::kZeroEveryFrame | StatFlag::kBytes);
+
 CommandBuffer* CommandBuffer::newInstance(const CommandBufferInitInfo& init)
 {
 	ANKI_TRACE_SCOPED_EVENT(VkNewCommandBuffer);
@@ -1174,6 +1178,8 @@ Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
 
 	m_debugMarkers = !!(getGrManagerImpl().getExtensions() & VulkanExtensions::kEXT_debug_utils);
 
+	m_graphicsState.setExtendedDynamicState(!!(getGrManagerImpl().getExtensions() & VulkanExtensions::kEXT_extended_dynamic_state));
+
 	return Error::kNone;
 }
 
@@ -1229,6 +1235,9 @@ void CommandBufferImpl::endRecording()
 	ANKI_VK_CHECKF(vkEndCommandBuffer(m_handle));
 	m_finalized = true;
 
+	g_trackedObjectsStatVar.increment(m_microCmdb->getTrackedObjectCount());
+	g_commandBufferArenaBytesStatVar.increment(m_pool->getMemoryUsage());
+
 #if ANKI_EXTRA_CHECKS
 	static Atomic<U32> messagePrintCount(0);
 	constexpr U32 MAX_PRINT_COUNT = 10;
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Gr/Vulkan/VkCommandBufferFactory.h>
+#include <AnKi/Gr/GrManager.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Core/StatsSet.h>
 
@@ -53,16 +54,41 @@ void MicroCommandBuffer::reset()
 	ANKI_ASSERT(m_refcount.load() == 0);
 	ANKI_ASSERT(!m_fence.isCreated());
 
-	for(GrObjectType type : EnumIterable<GrObjectType>())
-	{
-		m_objectRefs[type].destroy();
-	}
+	m_trackedObjectCount = 0;
 
 	m_dsAllocator.reset();
 
 	m_fastPool.reset();
 }
 
+void MicroCommandBuffer::onFenceDone()
+{
+	// If the recording didn't fit in a single chunk re-create the pool with one chunk that is big enough. This way the next recordings will have
+	// their memory ready. Do the same for the command buffers that will be created later
+	const PtrSize capacity = m_fastPool.getMemoryCapacity();
+	const Bool smallBatch = !!(m_flags & CommandBufferFlag::kSmallBatch);
+	Atomic<PtrSize>& fastPoolSize = m_threadAlloc->m_fastPoolSizes[smallBatch][m_queue];
+	if(capacity > fastPoolSize.load())
+	{
+		fastPoolSize.max(capacity);
+	}
+
+	reset();
+
+	if(m_fastPoolChunkSize < fastPoolSize.load()) [[unlikely]]
+	{
+		m_fastPool.destroy();
+		initFastPool(fastPoolSize.load());
+	}
+}
+
+void MicroCommandBuffer::initFastPool(PtrSize chunkSize)
+{
+	m_fastPoolChunkSize = chunkSize;
+	m_fastPool.init(GrMemoryPool::getSingleton().getAllocationCallback(), GrMemoryPool::getSingleton().getAllocationCallbackUserData(), chunkSize,
+					2.0f);
+}
+
 Error CommandBufferThreadAllocator::init()
 {
 	for(GpuQueueType qtype : EnumIterable<GpuQueueType>())
@@ -131,30 +157,18 @@ Error CommandBufferThreadAllocator::newCommandBuffer(CommandBufferFlag cmdbFlags
 
 		MicroCommandBuffer* newCmdb = newInstance<MicroCommandBuffer>(GrMemoryPool::getSingleton(), this);
 
-		newCmdb->m_fastPool.init(GrMemoryPool::getSingleton().getAllocationCallback(), GrMemoryPool::getSingleton().getAllocationCallbackUserData(),
-								 256_KB, 2.0f);
-
-		for(DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>& arr : newCmdb->m_objectRefs)
-		{
-			arr = DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>(&newCmdb->m_fastPool);
-		}
-
+		newCmdb->initFastPool(max<PtrSize>(256_KB, m_fastPoolSizes[smallBatch][queue].load()));
 		newCmdb->m_handle = cmdb;
 		newCmdb->m_flags = cmdbFlags;
 		newCmdb->m_queue = queue;
 
 		out = newCmdb;
 	}
-	else
-	{
-		for([[maybe_unused]] GrObjectType type : EnumIterable<GrObjectType>())
-		{
-			ANKI_ASSERT(out->m_objectRefs[type].getSize() == 0);
-		}
-	}
 
 	ANKI_ASSERT(out && out->m_refcount.load() == 0);
 	ANKI_ASSERT(out->m_flags == cmdbFlags);
+	ANKI_ASSERT(out->m_trackedObjectCount == 0);
+	out->m_frameEpoch = GrManager::getSingleton().getFrameEpoch();
 	outPtr.reset(out);
 	return Error::kNone;
 }
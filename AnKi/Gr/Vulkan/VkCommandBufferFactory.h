@@ -29,10 +29,6 @@ public:
 		: m_threadAlloc(allocator)
 	{
 		ANKI_ASSERT(allocator);
-		for(DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>& arr : m_objectRefs)
-		{
-			arr = DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>(&m_fastPool);
-		}
 	}
 
 	~MicroCommandBuffer();
@@ -63,10 +59,7 @@ public:
 	}
 
 	/// Interface method.
-	void onFenceDone()
-	{
-		reset();
-	}
+	void onFenceDone();
 
 	StackMemoryPool& getFastMemoryPool()
 	{
@@ -79,12 +72,20 @@ public:
 		return m_handle;
 	}
 
+	/// Keep the object alive until the GPU is done with the frame this command buffer belongs to.
 	template<typename T>
 	void pushObjectRef(T* x)
 	{
 		ANKI_ASSERT(T::kClassType != GrObjectType::kTexture && T::kClassType != GrObjectType::kBuffer
 					&& "No need to push references of buffers and textures");
-		pushToArray(m_objectRefs[T::kClassType], x);
+		ANKI_ASSERT(x);
+		m_trackedObjectCount += x->markUsedInFrame(m_frameEpoch);
+	}
+
+	/// The number of objects that were marked for the 1st time in this frame by this command buffer.
+	U32 getTrackedObjectCount() const
+	{
+		return m_trackedObjectCount;
 	}
 
 	CommandBufferFlag getFlags() const
@@ -104,13 +105,15 @@ public:
 	}
 
 private:
-	static constexpr U32 kMaxRefObjectSearch = 16;
-
 	StackMemoryPool m_fastPool;
 	VkCommandBuffer m_handle = {};
 
 	MicroFencePtr m_fence;
-	Array<DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>, U(GrObjectType::kCount)> m_objectRefs;
+
+	PtrSize m_fastPoolChunkSize = 0; ///< The size of the 1st chunk of m_fastPool.
+
+	U64 m_frameEpoch = 0; ///< The frame the command buffer is recorded.
+	U32 m_trackedObjectCount = 0;
 
 	DescriptorAllocator m_dsAllocator;
 
@@ -121,25 +124,7 @@ private:
 
 	void reset();
 
-	void pushToArray(DynamicArray<GrObjectPtr, MemoryPoolPtrWrapper<StackMemoryPool>>& arr, GrObject* grobj)
-	{
-		ANKI_ASSERT(grobj);
-
-		// Search the temp cache to avoid setting the ref again
-		if(arr.getSize() >= kMaxRefObjectSearch)
-		{
-			for(U32 i = arr.getSize() - kMaxRefObjectSearch; i < arr.getSize(); ++i)
-			{
-				if(arr[i].get() == grobj)
-				{
-					return;
-				}
-			}
-		}
-
-		// Not found in the temp cache, add it
-		arr.emplaceBack(grobj);
-	}
+	void initFastPool(PtrSize chunkSize);
 };
 
 /// Deleter.
@@ -162,6 +147,13 @@ public:
 	CommandBufferThreadAllocator(ThreadId tid)
 		: m_tid(tid)
 	{
+		for(U32 smallBatch = 0; smallBatch < 2; ++smallBatch)
+		{
+			for(GpuQueueType queue : EnumIterable<GpuQueueType>())
+			{
+				m_fastPoolSizes[smallBatch][queue].setNonAtomically(0);
+			}
+		}
 	}
 
 	~CommandBufferThreadAllocator()
@@ -187,6 +179,9 @@ private:
 #endif
 
 	Array2d<MicroObjectRecycler<MicroCommandBuffer>, 2, U(GpuQueueType::kCount)> m_recyclers;
+
+	/// The size of the fast pool for new command buffers. It's the biggest pool that was needed by the command buffers in the past.
+	Array2d<Atomic<PtrSize>, 2, U(GpuQueueType::kCount)> m_fastPoolSizes;
 };
 
 /// Command bufffer object recycler.
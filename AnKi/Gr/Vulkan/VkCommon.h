@@ -85,6 +85,10 @@ enum class VulkanExtensions : U64
 	kEXT_host_query_reset = 1_U64 << 32_U64,
 	kKHR_fragment_shader_barycentric = 1_U64 << 33_U64,
 	kKHR_dynamic_rendering = 1_U64 << 34_U64,
+	kEXT_extended_dynamic_state = 1_U64 << 35_U64,
+	kEXT_extended_dynamic_state_2 = 1_U64 << 36_U64,
+	kKHR_pipeline_library = 1_U64 << 37_U64,
+	kEXT_graphics_pipeline_library = 1_U64 << 38_U64,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(VulkanExtensions)
 
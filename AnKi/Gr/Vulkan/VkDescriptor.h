@@ -6,7 +6,7 @@
 #pragma once
 
 #include <AnKi/Gr/Vulkan/VkCommon.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 #include <AnKi/Util/WeakArray.h>
 
 namespace anki {
@@ -134,8 +134,8 @@ private:
 		VkDescriptorSetLayout m_handle = {};
 	};
 
-	GrHashMap<U64, PipelineLayout2*> m_pplLayouts;
-	GrHashMap<U64, DescriptorSetLayout*> m_dsLayouts;
+	GrSwissHashMap<U64, PipelineLayout2*> m_pplLayouts;
+	GrSwissHashMap<U64, DescriptorSetLayout*> m_dsLayouts;
 
 	Mutex m_mtx;
 
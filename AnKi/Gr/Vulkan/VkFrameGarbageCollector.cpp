@@ -7,6 +7,7 @@
 #include <AnKi/Gr/Vulkan/VkGrManager.h>
 #include <AnKi/Gr/Vulkan/VkDescriptor.h>
 #include <AnKi/Gr/Fence.h>
+#include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
@@ -161,12 +162,59 @@ void FrameGarbageCollector::newASGarbage(ASGarbage* garbage)
 	frame.m_asGarbage.pushBack(garbage);
 }
 
+void FrameGarbageCollector::newObjectGarbage(GrObject* obj)
+{
+	ANKI_ASSERT(obj);
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(m_initialized);
+	m_objectGarbage.emplaceBack(obj);
+}
+
+void FrameGarbageCollector::collectObjectGarbage(U64 firstFrameInFlight)
+{
+	ANKI_TRACE_SCOPED_EVENT(VkCollectObjectGarbage);
+
+	GrDynamicArray<GrObject*> deadObjects;
+	do
+	{
+		deadObjects.destroy();
+
+		{
+			LockGuard<Mutex> lock(m_mtx);
+
+			U32 aliveCount = 0;
+			for(GrObject* obj : m_objectGarbage)
+			{
+				if(obj->getLastUsedFrame() < firstFrameInFlight)
+				{
+					deadObjects.emplaceBack(obj);
+				}
+				else
+				{
+					m_objectGarbage[aliveCount++] = obj;
+				}
+			}
+
+			m_objectGarbage.resize(aliveCount);
+		}
+
+		// Delete outside the lock because the objects will create more garbage. Objects they reference might come back to the m_objectGarbage so
+		// loop
+		for(GrObject* obj : deadObjects)
+		{
+			deleteInstance(GrMemoryPool::getSingleton(), obj);
+		}
+	} while(deadObjects.getSize());
+}
+
 void FrameGarbageCollector::destroy()
 {
 	LockGuard<Mutex> lock(m_mtx);
 
 	collectGarbage();
 	ANKI_ASSERT(m_frames.isEmpty());
+	ANKI_ASSERT(m_objectGarbage.isEmpty() && "collectObjectGarbage() should have deleted all objects");
+	m_objectGarbage.destroy();
 
 #if ANKI_EXTRA_CHECKS
 	m_initialized = false;
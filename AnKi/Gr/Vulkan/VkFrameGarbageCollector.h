@@ -44,7 +44,8 @@ public:
 };
 
 /// This class gathers various garbages and disposes them when in some later frame where it is safe to do so. This is used on bindless textures and
-/// buffers where we have to wait until the frame where they were deleted is done.
+/// buffers where we have to wait until the frame where they were deleted is done. It also holds the GrObjects that were used by command buffers
+/// and they wait for the frame (epoch) that last used them to finish.
 class FrameGarbageCollector
 {
 public:
@@ -74,6 +75,13 @@ public:
 	/// @note It's thread-safe.
 	void newASGarbage(ASGarbage* garbage);
 
+	/// @note It's thread-safe.
+	void newObjectGarbage(GrObject* obj);
+
+	/// Delete the objects that were last used in a frame before firstFrameInFlight.
+	/// @note It's thread-safe.
+	void collectObjectGarbage(U64 firstFrameInFlight);
+
 private:
 	class FrameGarbage : public IntrusiveListEnabled<FrameGarbage>
 	{
@@ -86,6 +94,7 @@ private:
 
 	Mutex m_mtx;
 	IntrusiveList<FrameGarbage> m_frames;
+	GrDynamicArray<GrObject*> m_objectGarbage;
 
 #if ANKI_EXTRA_CHECKS
 	Bool m_initialized = false;
@@ -50,6 +50,10 @@ static BoolCVar g_samplerFilterMinMaxCVar(CVarSubsystem::kGr, "SamplerFilterMinM
 static BoolCVar g_vrsCVar(CVarSubsystem::kGr, "Vrs", false, "Enable or not VRS");
 BoolCVar g_meshShadersCVar(CVarSubsystem::kGr, "MeshShaders", false, "Enable or not mesh shaders");
 static BoolCVar g_asyncComputeCVar(CVarSubsystem::kGr, "AsyncCompute", true, "Enable or not async compute");
+static BoolCVar g_extendedDynamicStateCVar(CVarSubsystem::kGr, "ExtendedDynamicState", true,
+										   "Enable or not VK_EXT_extended_dynamic_state and VK_EXT_extended_dynamic_state2");
+static BoolCVar g_graphicsPipelineLibraryCVar(CVarSubsystem::kGr, "GraphicsPipelineLibrary", true,
+											  "Enable or not VK_EXT_graphics_pipeline_library. Needs the extended dynamic state");
 static NumericCVar<U8> g_vkMinorCVar(CVarSubsystem::kGr, "VkMinor", 1, 1, 1, "Vulkan minor version");
 static NumericCVar<U8> g_vkMajorCVar(CVarSubsystem::kGr, "VkMajor", 1, 1, 1, "Vulkan major version");
 static StringCVar g_vkLayers(CVarSubsystem::kGr, "VkLayers", "", "VK layers to enable. Seperated by :");
@@ -108,6 +112,28 @@ void GrManager::swapBuffers()
 {
 	ANKI_VK_SELF(GrManagerImpl);
 	self.endFrame();
+
+	// The objects that were last used kMaxFramesInFlight frames ago are not used by the GPU
+	const U64 frameEpoch = self.getFrameEpoch();
+	if(frameEpoch > kMaxFramesInFlight)
+	{
+		self.m_frameGarbageCollector.collectObjectGarbage(frameEpoch - kMaxFramesInFlight);
+	}
+}
+
+void GrManager::deleteObjectDeferred(GrObject* obj)
+{
+	ANKI_VK_SELF(GrManagerImpl);
+
+	if(obj->getLastUsedFrame() + kMaxFramesInFlight < self.getFrameEpoch())
+	{
+		// The frame that used it is done long ago
+		deleteInstance(GrMemoryPool::getSingleton(), obj);
+	}
+	else
+	{
+		self.m_frameGarbageCollector.newObjectGarbage(obj);
+	}
 }
 
 void GrManager::finish()
@@ -231,7 +257,7 @@ void GrManager::submit(WeakArray<CommandBuffer*> cmdbs, WeakArray<Fence*> waitFe
 		LockGuard<Mutex> lock(self.m_globalMtx);
 
 		// Do some special stuff for the last command buffer
-		GrManagerImpl::PerFrame& frame = self.m_perFrame[self.m_frame % kMaxFramesInFlight];
+		GrManagerImpl::PerFrame& frame = self.m_perFrame[self.getFrameEpoch() % kMaxFramesInFlight];
 		if(renderedToDefaultFb)
 		{
 			// Wait semaphore
@@ -317,6 +343,7 @@ GrManagerImpl::~GrManagerImpl()
 
 	// 3rd THING: The destroy everything that has a reference to GrObjects.
 	CommandBufferFactory::freeSingleton();
+	m_frameGarbageCollector.collectObjectGarbage(kMaxU64); // The GPU is idle, delete the objects the factories below need to recycle
 
 	for(PerFrame& frame : m_perFrame)
 	{
@@ -340,6 +367,7 @@ GrManagerImpl::~GrManagerImpl()
 	GpuMemoryManager::freeSingleton();
 	PipelineLayoutFactory2::freeSingleton();
 	BindlessDescriptorSet::freeSingleton();
+	PipelineLibraryCache::freeSingleton(); // Destroy before the PipelineCache
 	PipelineCache::freeSingleton();
 	FenceFactory::freeSingleton();
 
@@ -415,6 +443,7 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 
 	PipelineCache::allocateSingleton();
 	ANKI_CHECK(PipelineCache::getSingleton().init(init.m_cacheDirectory));
+	PipelineLibraryCache::allocateSingleton();
 
 	ANKI_CHECK(initMemory());
 
@@ -1082,6 +1111,26 @@ Error GrManagerImpl::initDevice()
 				// Want it because of dynamic_rendering
 				extensionsToEnable[extensionsToEnableCount++] = extensionName.cstr();
 			}
+			else if(extensionName == VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME && g_extendedDynamicStateCVar.get())
+			{
+				m_extensions |= VulkanExtensions::kEXT_extended_dynamic_state;
+				extensionsToEnable[extensionsToEnableCount++] = extensionName.cstr();
+			}
+			else if(extensionName == VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME && g_extendedDynamicStateCVar.get())
+			{
+				m_extensions |= VulkanExtensions::kEXT_extended_dynamic_state_2;
+				extensionsToEnable[extensionsToEnableCount++] = extensionName.cstr();
+			}
+			else if(extensionName == VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME && g_graphicsPipelineLibraryCVar.get())
+			{
+				m_extensions |= VulkanExtensions::kKHR_pipeline_library;
+				extensionsToEnable[extensionsToEnableCount++] = extensionName.cstr();
+			}
+			else if(extensionName == VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME && g_graphicsPipelineLibraryCVar.get())
+			{
+				m_extensions |= VulkanExtensions::kEXT_graphics_pipeline_library;
+				extensionsToEnable[extensionsToEnableCount++] = extensionName.cstr();
+			}
 		}
 
 		ANKI_VK_LOGI("Will enable the following device extensions:");
@@ -1479,6 +1528,69 @@ Error GrManagerImpl::initDevice()
 		appendPNextList(ci, &dynRenderingFeatures);
 	}
 
+	// Extended dynamic state. Both are needed because the pipelines either make all the state dynamic or nothing
+	VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures = {};
+	VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features = {};
+	if(!!(m_extensions & VulkanExtensions::kEXT_extended_dynamic_state) && !!(m_extensions & VulkanExtensions::kEXT_extended_dynamic_state_2))
+	{
+		extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+		getPhysicalDevicaFeatures2(extendedDynamicStateFeatures);
+
+		extendedDynamicState2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+		getPhysicalDevicaFeatures2(extendedDynamicState2Features);
+
+		if(extendedDynamicStateFeatures.extendedDynamicState && extendedDynamicState2Features.extendedDynamicState2)
+		{
+			extendedDynamicState2Features.extendedDynamicState2LogicOp = false;
+			extendedDynamicState2Features.extendedDynamicState2PatchControlPoints = false;
+
+			appendPNextList(ci, &extendedDynamicStateFeatures);
+			appendPNextList(ci, &extendedDynamicState2Features);
+
+			ANKI_VK_LOGI("Extended dynamic state is supported and enabled");
+		}
+		else
+		{
+			m_extensions &= ~(VulkanExtensions::kEXT_extended_dynamic_state | VulkanExtensions::kEXT_extended_dynamic_state_2);
+			ANKI_VK_LOGI("Extended dynamic state features are not supported by the device");
+		}
+	}
+	else
+	{
+		m_extensions &= ~(VulkanExtensions::kEXT_extended_dynamic_state | VulkanExtensions::kEXT_extended_dynamic_state_2);
+		ANKI_VK_LOGI(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME " or " VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME
+																  " is not supported or disabled");
+	}
+
+	// Graphics pipeline library. The libraries assume that the depth, stencil and some of the raster state is dynamic
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = {};
+	if(!!(m_extensions & VulkanExtensions::kEXT_graphics_pipeline_library) && !!(m_extensions & VulkanExtensions::kKHR_pipeline_library)
+	   && !!(m_extensions & VulkanExtensions::kEXT_extended_dynamic_state))
+	{
+		graphicsPipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		getPhysicalDevicaFeatures2(graphicsPipelineLibraryFeatures);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProps = {};
+		graphicsPipelineLibraryProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+		getPhysicalDeviceProperties2(graphicsPipelineLibraryProps);
+
+		if(graphicsPipelineLibraryFeatures.graphicsPipelineLibrary && graphicsPipelineLibraryProps.graphicsPipelineLibraryFastLinking)
+		{
+			appendPNextList(ci, &graphicsPipelineLibraryFeatures);
+			ANKI_VK_LOGI(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME " is supported and enabled");
+		}
+		else
+		{
+			m_extensions &= ~(VulkanExtensions::kEXT_graphics_pipeline_library | VulkanExtensions::kKHR_pipeline_library);
+			ANKI_VK_LOGI(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME " doesn't support fast linking. Will not use it");
+		}
+	}
+	else
+	{
+		m_extensions &= ~(VulkanExtensions::kEXT_graphics_pipeline_library | VulkanExtensions::kKHR_pipeline_library);
+		ANKI_VK_LOGI(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME " is not supported or disabled");
+	}
+
 	ANKI_VK_CHECK(vkCreateDevice(m_physicalDevice, &ci, nullptr, &m_device));
 
 	return Error::kNone;
@@ -1572,7 +1684,7 @@ TexturePtr GrManagerImpl::acquireNextPresentableTexture()
 
 	LockGuard<Mutex> lock(m_globalMtx);
 
-	PerFrame& frame = m_perFrame[m_frame % kMaxFramesInFlight];
+	PerFrame& frame = m_perFrame[getFrameEpoch() % kMaxFramesInFlight];
 
 	// Create sync objects
 	MicroFencePtr fence = FenceFactory::getSingleton().newInstance();
@@ -1616,10 +1728,10 @@ void GrManagerImpl::endFrame()
 
 	LockGuard<Mutex> lock(m_globalMtx);
 
-	PerFrame& frame = m_perFrame[m_frame % kMaxFramesInFlight];
+	PerFrame& frame = m_perFrame[getFrameEpoch() % kMaxFramesInFlight];
 
 	// Wait for the fence of N-2 frame
-	const U waitFrameIdx = (m_frame + 1) % kMaxFramesInFlight;
+	const U waitFrameIdx = (getFrameEpoch() + 1) % kMaxFramesInFlight;
 	PerFrame& waitFrame = m_perFrame[waitFrameIdx];
 	if(waitFrame.m_presentFence)
 	{
@@ -1669,7 +1781,7 @@ void GrManagerImpl::endFrame()
 	GpuMemoryManager::getSingleton().updateStats();
 
 	// Finalize
-	++m_frame;
+	m_frameEpoch.fetchAdd(1);
 }
 
 void GrManagerImpl::resetFrame(PerFrame& frame)
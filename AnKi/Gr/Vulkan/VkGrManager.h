@@ -128,8 +128,6 @@ public:
 	}
 
 private:
-	U64 m_frame = 0;
-
 #if ANKI_GR_MANAGER_DEBUG_MEMMORY
 	VkAllocationCallbacks m_debugAllocCbs;
 	static constexpr U32 MAX_ALLOC_ALIGNMENT = 64;
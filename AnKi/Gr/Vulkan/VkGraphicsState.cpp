@@ -8,6 +8,7 @@
 #include <AnKi/Gr/Vulkan/VkGrManager.h>
 #include <AnKi/Gr/Vulkan/VkShaderProgram.h>
 #include <AnKi/Util/Filesystem.h>
+#include <AnKi/Core/StatsSet.h>
 
 namespace anki {
 
@@ -53,12 +54,521 @@ static VkRect2D computeScissor(U32* scissor, U32 fbWidth, U32 fbHeight, Bool fli
 	return out;
 }
 
+/// Holds the memory of a VkGraphicsPipelineCreateInfo and all the structures it points to.
+class GraphicsPipelineCreateInfoStorage
+{
+public:
+	VkGraphicsPipelineCreateInfo m_ci = {};
+
+	Array<VkPipelineShaderStageCreateInfo, U32(ShaderType::kLastGraphics - ShaderType::kFirstGraphics) + 1> m_stages;
+
+	Array<VkVertexInputBindingDescription, U32(VertexAttributeSemantic::kCount)> m_vertBindings;
+	Array<VkVertexInputAttributeDescription, U32(VertexAttributeSemantic::kCount)> m_attribs;
+	VkPipelineVertexInputStateCreateInfo m_vertCi = {};
+	VkPipelineInputAssemblyStateCreateInfo m_iaCi = {};
+
+	VkPipelineViewportStateCreateInfo m_vpCi = {};
+	VkPipelineRasterizationStateCreateInfo m_rastCi = {};
+	VkPipelineMultisampleStateCreateInfo m_msCi = {};
+	VkPipelineDepthStencilStateCreateInfo m_dsCi = {};
+
+	Array<VkPipelineColorBlendAttachmentState, kMaxColorRenderTargets> m_colAttachments = {};
+	VkPipelineColorBlendStateCreateInfo m_colCi = {};
+
+	Array<VkFormat, kMaxColorRenderTargets> m_colorFormats = {};
+	VkPipelineRenderingCreateInfoKHR m_dynRendering = {};
+
+	Array<VkDynamicState, 24> m_dynStates;
+	VkPipelineDynamicStateCreateInfo m_dynCi = {};
+
+	VkGraphicsPipelineLibraryCreateInfoEXT m_libraryCi = {};
+
+	GraphicsPipelineCreateInfoStorage()
+	{
+		m_ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		m_vertCi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		m_iaCi.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		m_vpCi.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		m_rastCi.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		m_msCi.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		m_dsCi.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		m_colCi.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		m_dynRendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		m_dynCi.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		m_libraryCi.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+
+		// Almost all state is dynamic. With the extended dynamic state even more
+		static constexpr Array<VkDynamicState, 9> kDyn = {{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+														   VK_DYNAMIC_STATE_DEPTH_BOUNDS, VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+														   VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+														   VK_DYNAMIC_STATE_LINE_WIDTH, VK_DYNAMIC_STATE_DEPTH_BIAS}};
+
+		static constexpr Array<VkDynamicState, 10> kExtendedDyn = {
+			{VK_DYNAMIC_STATE_CULL_MODE_EXT, VK_DYNAMIC_STATE_FRONT_FACE_EXT, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+			 VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+			 VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_STENCIL_OP_EXT, VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+			 VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT}};
+
+		for(VkDynamicState dyn : kDyn)
+		{
+			m_dynStates[m_dynCi.dynamicStateCount++] = dyn;
+		}
+
+		if(getGrManagerImpl().getDeviceCapabilities().m_vrs)
+		{
+			m_dynStates[m_dynCi.dynamicStateCount++] = VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR;
+		}
+
+		if(!!(getGrManagerImpl().getExtensions() & VulkanExtensions::kEXT_extended_dynamic_state))
+		{
+			for(VkDynamicState dyn : kExtendedDyn)
+			{
+				m_dynStates[m_dynCi.dynamicStateCount++] = dyn;
+			}
+		}
+
+		m_dynCi.pDynamicStates = m_dynStates.getBegin();
+		m_ci.pDynamicState = &m_dynCi;
+	}
+
+	GraphicsPipelineCreateInfoStorage(const GraphicsPipelineCreateInfoStorage&) = delete; // Non-copyable
+
+	GraphicsPipelineCreateInfoStorage& operator=(const GraphicsPipelineCreateInfoStorage&) = delete; // Non-copyable
+
+	/// Make it a library.
+	void setLibrary(VkGraphicsPipelineLibraryFlagsEXT flags)
+	{
+		m_ci.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+		m_libraryCi.flags = flags;
+		appendPNextList(m_ci, &m_libraryCi);
+	}
+};
+
+static StatCounter g_graphicsPipelinesCompiledStatVar(StatCategory::kMisc, "Graphics pipelines compiled", StatFlag::kNone);
+static StatCounter g_graphicsPipelinesFastLinkedStatVar(StatCategory::kMisc, "Graphics pipelines fast linked", StatFlag::kNone);
+static StatCounter g_graphicsPipelinesOptimizedStatVar(StatCategory::kMisc, "Graphics pipelines optimized", StatFlag::kNone);
+static StatCounter g_graphicsPipelineLibrariesStatVar(StatCategory::kMisc, "Graphics pipeline libraries", StatFlag::kNone);
+
+static VkPipeline createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& ci)
+{
+	ANKI_TRACE_SCOPED_EVENT(VkPipelineCreate);
+
+#if ANKI_PLATFORM_MOBILE
+	if(PipelineCache::getSingleton().m_globalCreatePipelineMtx)
+	{
+		PipelineCache::getSingleton().m_globalCreatePipelineMtx->lock();
+	}
+#endif
+
+	VkPipeline pso = VK_NULL_HANDLE;
+	ANKI_VK_CHECKF(vkCreateGraphicsPipelines(getVkDevice(), PipelineCache::getSingleton().m_cacheHandle, 1, &ci, nullptr, &pso));
+
+#if ANKI_PLATFORM_MOBILE
+	if(PipelineCache::getSingleton().m_globalCreatePipelineMtx)
+	{
+		PipelineCache::getSingleton().m_globalCreatePipelineMtx->unlock();
+	}
+#endif
+
+	return pso;
+}
+
+static VkPipeline linkGraphicsPipelineLibraries(ConstWeakArray<VkPipeline> libraries, VkPipelineLayout layout, Bool optimize)
+{
+	VkPipelineLibraryCreateInfoKHR libsCi = {};
+	libsCi.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+	libsCi.libraryCount = libraries.getSize();
+	libsCi.pLibraries = libraries.getBegin();
+
+	VkGraphicsPipelineCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	ci.flags = (optimize) ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+	ci.layout = layout;
+	appendPNextList(ci, &libsCi);
+
+	return createGraphicsPipeline(ci);
+}
+
 GraphicsPipelineFactory::~GraphicsPipelineFactory()
 {
+	if(PipelineLibraryCache::getSingleton().isEnabled())
+	{
+		PipelineLibraryCache::getSingleton().cancelOptimizedLinks(*this);
+	}
+
 	for(auto pso : m_map)
 	{
 		vkDestroyPipeline(getVkDevice(), pso, nullptr);
 	}
+
+	for(VkPipeline pso : m_retiredPipelines)
+	{
+		vkDestroyPipeline(getVkDevice(), pso, nullptr);
+	}
+
+	for(VkPipeline lib : m_preRasterizationLibraries)
+	{
+		if(lib)
+		{
+			vkDestroyPipeline(getVkDevice(), lib, nullptr);
+		}
+	}
+
+	if(m_fragmentShaderLibrary)
+	{
+		vkDestroyPipeline(getVkDevice(), m_fragmentShaderLibrary, nullptr);
+	}
+}
+
+Error GraphicsPipelineFactory::init(const ShaderProgramImpl& prog)
+{
+	if(!PipelineLibraryCache::getSingleton().isEnabled())
+	{
+		return Error::kNone;
+	}
+
+	// Compile the parts that depend only on the program now. The solid fill mode is by far the most common so create that only
+	m_preRasterizationLibraries[FillMode::kSolid] = getOrCreatePreRasterizationLibrary(prog, FillMode::kSolid);
+
+	GraphicsPipelineCreateInfoStorage storage;
+	storage.setLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+	setFragmentShaderState(prog, storage);
+
+	ANKI_VK_CHECK(
+		vkCreateGraphicsPipelines(getVkDevice(), PipelineCache::getSingleton().m_cacheHandle, 1, &storage.m_ci, nullptr, &m_fragmentShaderLibrary));
+	g_graphicsPipelineLibrariesStatVar.increment(1);
+
+	return Error::kNone;
+}
+
+void GraphicsPipelineFactory::setVertexInputState(const GraphicsStateTracker& state, GraphicsPipelineCreateInfoStorage& storage)
+{
+	const auto& staticState = state.m_staticState;
+
+	VkPipelineVertexInputStateCreateInfo& vertCi = storage.m_vertCi;
+	vertCi.pVertexAttributeDescriptions = &storage.m_attribs[0];
+	vertCi.pVertexBindingDescriptions = &storage.m_vertBindings[0];
+
+	BitSet<U32(VertexAttributeSemantic::kCount), U8> bindingSet = {false};
+	for(VertexAttributeSemantic semantic : EnumIterable<VertexAttributeSemantic>())
+	{
+		if(staticState.m_vert.m_activeAttribs.get(semantic))
+		{
+			VkVertexInputAttributeDescription& attrib = storage.m_attribs[vertCi.vertexAttributeDescriptionCount++];
+			attrib.binding = staticState.m_vert.m_attribs[semantic].m_binding;
+			attrib.format = convertFormat(staticState.m_vert.m_attribs[semantic].m_fmt);
+			attrib.location = staticState.m_vert.m_attribs[semantic].m_semanticToVertexAttributeLocation;
+			attrib.offset = staticState.m_vert.m_attribs[semantic].m_relativeOffset;
+
+			if(!bindingSet.get(attrib.binding))
+			{
+				bindingSet.set(attrib.binding);
+
+				VkVertexInputBindingDescription& binding = storage.m_vertBindings[vertCi.vertexBindingDescriptionCount++];
+
+				binding.binding = attrib.binding;
+				binding.inputRate = convertVertexStepRate(staticState.m_vert.m_bindings[attrib.binding].m_stepRate);
+				binding.stride = staticState.m_vert.m_bindings[attrib.binding].m_stride;
+			}
+		}
+	}
+
+	storage.m_ci.pVertexInputState = &vertCi;
+
+	// IA. With the extended dynamic state the pipeline needs only the topology class
+	if(state.m_extendedDynamicState)
+	{
+		storage.m_iaCi.topology = convertTopology(getPrimitiveTopologyClass(staticState.m_ia.m_topology));
+	}
+	else
+	{
+		storage.m_iaCi.primitiveRestartEnable = staticState.m_ia.m_primitiveRestartEnabled;
+		storage.m_iaCi.topology = convertTopology(staticState.m_ia.m_topology);
+	}
+
+	storage.m_ci.pInputAssemblyState = &storage.m_iaCi;
+}
+
+void GraphicsPipelineFactory::setPreRasterizationState(const ShaderProgramImpl& prog, FillMode fillMode, FaceSelectionBit cullMode,
+													   Bool rendersToSwapchain, Bool depthBiasEnabled, GraphicsPipelineCreateInfoStorage& storage)
+{
+	U32 stageCount;
+	const VkPipelineShaderStageCreateInfo* stages = prog.getShaderCreateInfos(stageCount);
+	for(U32 i = 0; i < stageCount; ++i)
+	{
+		if(stages[i].stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+		{
+			storage.m_stages[storage.m_ci.stageCount++] = stages[i];
+		}
+	}
+	storage.m_ci.pStages = storage.m_stages.getBegin();
+
+	// Viewport
+	storage.m_vpCi.scissorCount = 1;
+	storage.m_vpCi.viewportCount = 1;
+	storage.m_ci.pViewportState = &storage.m_vpCi;
+
+	// Raster
+	VkPipelineRasterizationStateCreateInfo& rastCi = storage.m_rastCi;
+	rastCi.depthClampEnable = false;
+	rastCi.rasterizerDiscardEnable = false;
+	rastCi.polygonMode = convertFillMode(fillMode);
+	rastCi.cullMode = convertCullMode(cullMode);
+	rastCi.frontFace = (!rendersToSwapchain) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE; // For viewport flip
+	rastCi.depthBiasEnable = depthBiasEnabled;
+	rastCi.lineWidth = 1.0f;
+	storage.m_ci.pRasterizationState = &rastCi;
+
+	storage.m_ci.layout = prog.getPipelineLayout().getHandle();
+}
+
+void GraphicsPipelineFactory::setFragmentShaderState(const ShaderProgramImpl& prog, GraphicsPipelineCreateInfoStorage& storage)
+{
+	U32 stageCount;
+	const VkPipelineShaderStageCreateInfo* stages = prog.getShaderCreateInfos(stageCount);
+	for(U32 i = 0; i < stageCount; ++i)
+	{
+		if(stages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+		{
+			storage.m_stages[storage.m_ci.stageCount++] = stages[i];
+		}
+	}
+	storage.m_ci.pStages = storage.m_stages.getBegin();
+
+	// All depth and stencil state is dynamic
+	storage.m_ci.pDepthStencilState = &storage.m_dsCi;
+
+	storage.m_ci.layout = prog.getPipelineLayout().getHandle();
+}
+
+void GraphicsPipelineFactory::setFragmentOutputState(const GraphicsStateTracker& state, GraphicsPipelineCreateInfoStorage& storage)
+{
+	const auto& staticState = state.m_staticState;
+
+	// MS
+	storage.m_msCi.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	storage.m_ci.pMultisampleState = &storage.m_msCi;
+
+	// Color/blend
+	VkPipelineColorBlendStateCreateInfo& colCi = storage.m_colCi;
+	if(staticState.m_misc.m_colorRtMask.getAnySet())
+	{
+		colCi.attachmentCount = staticState.m_misc.m_colorRtMask.getSetBitCount();
+		colCi.pAttachments = &storage.m_colAttachments[0];
+
+		for(U i = 0; i < colCi.attachmentCount; ++i)
+		{
+			VkPipelineColorBlendAttachmentState& out = storage.m_colAttachments[i];
+			const auto& in = staticState.m_blend.m_colorRts[i];
+
+			out.blendEnable = blendingEnabled(in.m_srcRgb, in.m_dstRgb, in.m_srcA, in.m_dstA, in.m_funcRgb, in.m_funcA);
+			out.srcColorBlendFactor = convertBlendFactor(in.m_srcRgb);
+			out.dstColorBlendFactor = convertBlendFactor(in.m_dstRgb);
+			out.srcAlphaBlendFactor = convertBlendFactor(in.m_srcA);
+			out.dstAlphaBlendFactor = convertBlendFactor(in.m_dstA);
+			out.colorBlendOp = convertBlendOperation(in.m_funcRgb);
+			out.alphaBlendOp = convertBlendOperation(in.m_funcA);
+
+			out.colorWriteMask = convertColorWriteMask(in.m_channelWriteMask);
+		}
+
+		storage.m_ci.pColorBlendState = &colCi;
+	}
+
+	// Renderpass related (Dynamic rendering)
+	VkPipelineRenderingCreateInfoKHR& dynRendering = storage.m_dynRendering;
+	dynRendering.colorAttachmentCount = staticState.m_misc.m_colorRtMask.getSetBitCount();
+	dynRendering.pColorAttachmentFormats = storage.m_colorFormats.getBegin();
+	for(U i = 0; i < kMaxColorRenderTargets; ++i)
+	{
+		storage.m_colorFormats[i] =
+			(staticState.m_misc.m_colorRtMask.get(i)) ? convertFormat(staticState.m_misc.m_colorRtFormats[i]) : VK_FORMAT_UNDEFINED;
+	}
+
+	if(staticState.m_misc.m_depthStencilFormat != Format::kNone)
+	{
+		const FormatInfo& inf = getFormatInfo(staticState.m_misc.m_depthStencilFormat);
+		if(inf.isDepth())
+		{
+			dynRendering.depthAttachmentFormat = convertFormat(staticState.m_misc.m_depthStencilFormat);
+		}
+
+		if(inf.isStencil())
+		{
+			dynRendering.stencilAttachmentFormat = convertFormat(staticState.m_misc.m_depthStencilFormat);
+		}
+	}
+
+	appendPNextList(storage.m_ci, &dynRendering);
+}
+
+VkPipeline GraphicsPipelineFactory::getOrCreatePreRasterizationLibrary(const ShaderProgramImpl& prog, FillMode fillMode)
+{
+	{
+		RLockGuard<RWMutex> lock(m_mtx);
+		if(m_preRasterizationLibraries[fillMode])
+		{
+			return m_preRasterizationLibraries[fillMode];
+		}
+	}
+
+	// The cull mode, front face and depth bias enable are dynamic so their values don't matter
+	GraphicsPipelineCreateInfoStorage storage;
+	storage.setLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+	setPreRasterizationState(prog, fillMode, FaceSelectionBit::kBack, false, false, storage);
+
+	VkPipeline lib = createGraphicsPipeline(storage.m_ci);
+
+	WLockGuard<RWMutex> lock(m_mtx);
+	if(m_preRasterizationLibraries[fillMode])
+	{
+		// Someone else created it in the meantime
+		vkDestroyPipeline(getVkDevice(), lib, nullptr);
+	}
+	else
+	{
+		m_preRasterizationLibraries[fillMode] = lib;
+		g_graphicsPipelineLibrariesStatVar.increment(1);
+	}
+
+	return m_preRasterizationLibraries[fillMode];
+}
+
+VkPipeline GraphicsPipelineFactory::createMonolithicPipeline(const GraphicsStateTracker& state)
+{
+	const auto& staticState = state.m_staticState;
+	const ShaderProgramImpl& prog = static_cast<const ShaderProgramImpl&>(*staticState.m_shaderProg);
+	const Bool extendedDynamicState = state.m_extendedDynamicState;
+
+	GraphicsPipelineCreateInfoStorage storage;
+
+	if(staticState.m_misc.m_pipelineStatisticsEnabled)
+	{
+		storage.m_ci.flags |= VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR;
+	}
+
+	setVertexInputState(state, storage);
+
+	if(extendedDynamicState)
+	{
+		setPreRasterizationState(prog, staticState.m_rast.m_fillMode, FaceSelectionBit::kBack, false, false, storage);
+	}
+	else
+	{
+		setPreRasterizationState(prog, staticState.m_rast.m_fillMode, staticState.m_rast.m_cullMode, staticState.m_misc.m_rendersToSwapchain,
+								 staticState.m_rast.m_depthBiasEnabled, storage);
+	}
+
+	setFragmentShaderState(prog, storage);
+	setFragmentOutputState(state, storage);
+
+	// Depth stencil
+	const Bool hasStencilRt =
+		staticState.m_misc.m_depthStencilFormat != Format::kNone && getFormatInfo(staticState.m_misc.m_depthStencilFormat).isStencil();
+	const Bool hasDepthRt =
+		staticState.m_misc.m_depthStencilFormat != Format::kNone && getFormatInfo(staticState.m_misc.m_depthStencilFormat).isDepth();
+
+	if(extendedDynamicState)
+	{
+		// All dynamic, leave it zero
+	}
+	else if(hasDepthRt || hasStencilRt)
+	{
+		VkPipelineDepthStencilStateCreateInfo& dsCi = storage.m_dsCi;
+
+		if(hasDepthRt)
+		{
+			dsCi.depthTestEnable = depthTestEnabled(staticState.m_depth.m_compare, staticState.m_depth.m_writeEnabled);
+			dsCi.depthWriteEnable = staticState.m_depth.m_writeEnabled;
+			dsCi.depthCompareOp = convertCompareOp(staticState.m_depth.m_compare);
+		}
+
+		if(hasStencilRt)
+		{
+			const auto& ss = staticState.m_stencil;
+
+			dsCi.stencilTestEnable = stencilTestEnabled(ss.m_face[0].m_fail, ss.m_face[0].m_stencilPassDepthFail, ss.m_face[0].m_stencilPassDepthPass,
+														ss.m_face[0].m_compare)
+									 || stencilTestEnabled(ss.m_face[1].m_fail, ss.m_face[1].m_stencilPassDepthFail,
+														   ss.m_face[1].m_stencilPassDepthPass, ss.m_face[1].m_compare);
+			dsCi.front.failOp = convertStencilOp(ss.m_face[0].m_fail);
+			dsCi.front.passOp = convertStencilOp(ss.m_face[0].m_stencilPassDepthPass);
+			dsCi.front.depthFailOp = convertStencilOp(ss.m_face[0].m_stencilPassDepthFail);
+			dsCi.front.compareOp = convertCompareOp(ss.m_face[0].m_compare);
+			dsCi.back.failOp = convertStencilOp(ss.m_face[1].m_fail);
+			dsCi.back.passOp = convertStencilOp(ss.m_face[1].m_stencilPassDepthPass);
+			dsCi.back.depthFailOp = convertStencilOp(ss.m_face[1].m_stencilPassDepthFail);
+			dsCi.back.compareOp = convertCompareOp(ss.m_face[1].m_compare);
+		}
+	}
+	else
+	{
+		storage.m_ci.pDepthStencilState = nullptr;
+	}
+
+	// The rest
+	storage.m_ci.subpass = 0;
+
+	return createGraphicsPipeline(storage.m_ci);
+}
+
+void GraphicsPipelineFactory::flushExtendedDynamicState(GraphicsStateTracker& state, VkCommandBuffer& cmdb)
+{
+	const auto& staticState = state.m_staticState;
+	GraphicsStateTracker::DynamicState& dynState = state.m_dynState;
+
+	if(dynState.m_rastDirty)
+	{
+		dynState.m_rastDirty = false;
+
+		vkCmdSetCullModeEXT(cmdb, convertCullMode(staticState.m_rast.m_cullMode));
+		vkCmdSetFrontFaceEXT(cmdb, (!staticState.m_misc.m_rendersToSwapchain) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE);
+		vkCmdSetDepthBiasEnableEXT(cmdb, staticState.m_rast.m_depthBiasEnabled);
+	}
+
+	if(dynState.m_iaDirty)
+	{
+		dynState.m_iaDirty = false;
+
+		vkCmdSetPrimitiveTopologyEXT(cmdb, convertTopology(staticState.m_ia.m_topology));
+		vkCmdSetPrimitiveRestartEnableEXT(cmdb, staticState.m_ia.m_primitiveRestartEnabled);
+	}
+
+	if(dynState.m_depthStencilDirty)
+	{
+		dynState.m_depthStencilDirty = false;
+
+		// Without a depth or stencil attachment the tests are implicitly disabled so there is no need to check for them
+		vkCmdSetDepthTestEnableEXT(cmdb, depthTestEnabled(staticState.m_depth.m_compare, staticState.m_depth.m_writeEnabled));
+		vkCmdSetDepthWriteEnableEXT(cmdb, staticState.m_depth.m_writeEnabled);
+		vkCmdSetDepthCompareOpEXT(cmdb, convertCompareOp(staticState.m_depth.m_compare));
+
+		const auto& ss = staticState.m_stencil;
+		const Bool stencilTestEnabled = anki::stencilTestEnabled(ss.m_face[0].m_fail, ss.m_face[0].m_stencilPassDepthFail,
+																 ss.m_face[0].m_stencilPassDepthPass, ss.m_face[0].m_compare)
+										|| anki::stencilTestEnabled(ss.m_face[1].m_fail, ss.m_face[1].m_stencilPassDepthFail,
+																	ss.m_face[1].m_stencilPassDepthPass, ss.m_face[1].m_compare);
+		vkCmdSetStencilTestEnableEXT(cmdb, stencilTestEnabled);
+
+		for(U32 face = 0; face < 2; ++face)
+		{
+			vkCmdSetStencilOpEXT(cmdb, (face == 0) ? VK_STENCIL_FACE_FRONT_BIT : VK_STENCIL_FACE_BACK_BIT, convertStencilOp(ss.m_face[face].m_fail),
+								 convertStencilOp(ss.m_face[face].m_stencilPassDepthPass), convertStencilOp(ss.m_face[face].m_stencilPassDepthFail),
+								 convertCompareOp(ss.m_face[face].m_compare));
+		}
+	}
+}
+
+void GraphicsPipelineFactory::replacePipeline(U64 hash, VkPipeline optimizedPso)
+{
+	WLockGuard<RWMutex> lock(m_mtx);
+
+	auto it = m_map.find(hash);
+	ANKI_ASSERT(it != m_map.getEnd());
+
+	// Command buffers might still use the old one so retire it
+	m_retiredPipelines.emplaceBack(*it);
+	*it = optimizedPso;
 }
 
 void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb)
@@ -166,6 +676,11 @@ void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandB
 	// Static state
 	const Bool rebindPso = state.updateHashes();
 
+	if(state.m_extendedDynamicState)
+	{
+		flushExtendedDynamicState(state, cmdb);
+	}
+
 	// Find the PSO
 	VkPipeline pso = VK_NULL_HANDLE;
 	{
@@ -191,227 +706,241 @@ void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandB
 	// PSO not found, proactively create it WITHOUT a lock (we dont't want to serialize pipeline creation)
 
 	const ShaderProgramImpl& prog = static_cast<const ShaderProgramImpl&>(*staticState.m_shaderProg);
+	PipelineLibraryCache& libCache = PipelineLibraryCache::getSingleton();
 
-	VkGraphicsPipelineCreateInfo ci = {};
-	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	// The statistics can't be captured from libraries so use the slow path for them
+	const Bool useLibraries = libCache.isEnabled() && !staticState.m_misc.m_pipelineStatisticsEnabled;
 
-	if(staticState.m_misc.m_pipelineStatisticsEnabled)
+	PipelineLibraryCache::LinkTask linkTask;
+	if(useLibraries)
 	{
-		ci.flags |= VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR;
-	}
+		// Fast link the parts. This is orders of magnitude faster than a full compile. An optimized version will replace it later
+		linkTask.m_factory = this;
+		linkTask.m_hash = state.m_globalHash;
+		linkTask.m_layout = prog.getPipelineLayout().getHandle();
 
-	ci.pStages = prog.getShaderCreateInfos(ci.stageCount);
-
-	// Vertex stuff
-	Array<VkVertexInputBindingDescription, U32(VertexAttributeSemantic::kCount)> vertBindings;
-	Array<VkVertexInputAttributeDescription, U32(VertexAttributeSemantic::kCount)> attribs;
+		if(!(prog.getStages() & ShaderTypeBit::kAllModernGeometry))
+		{
+			// The extended dynamic state is a requirement so the IA hash contains only the topology class
+			const U64 hash = appendObjectHash(state.m_hashes.m_ia, state.m_hashes.m_vert);
+			linkTask.m_libraries[linkTask.m_libraryCount++] = libCache.getOrCreateVertexInputLibrary(hash, state);
+		}
 
-	VkPipelineVertexInputStateCreateInfo vertCi = {};
-	vertCi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertCi.pVertexAttributeDescriptions = &attribs[0];
-	vertCi.pVertexBindingDescriptions = &vertBindings[0];
+		linkTask.m_libraries[linkTask.m_libraryCount++] = getOrCreatePreRasterizationLibrary(prog, staticState.m_rast.m_fillMode);
+		linkTask.m_libraries[linkTask.m_libraryCount++] = m_fragmentShaderLibrary;
+		const U64 hash = appendObjectHash(state.m_hashes.m_misc, state.m_hashes.m_blend);
+		linkTask.m_libraries[linkTask.m_libraryCount++] = libCache.getOrCreateFragmentOutputLibrary(hash, state);
 
-	BitSet<U32(VertexAttributeSemantic::kCount), U8> bindingSet = {false};
-	for(VertexAttributeSemantic semantic : EnumIterable<VertexAttributeSemantic>())
+		pso = linkGraphicsPipelineLibraries(ConstWeakArray<VkPipeline>(linkTask.m_libraries.getBegin(), linkTask.m_libraryCount), linkTask.m_layout,
+											false);
+		g_graphicsPipelinesFastLinkedStatVar.increment(1);
+	}
+	else
 	{
-		if(staticState.m_vert.m_activeAttribs.get(semantic))
-		{
-			VkVertexInputAttributeDescription& attrib = attribs[vertCi.vertexAttributeDescriptionCount++];
-			attrib.binding = staticState.m_vert.m_attribs[semantic].m_binding;
-			attrib.format = convertFormat(staticState.m_vert.m_attribs[semantic].m_fmt);
-			attrib.location = staticState.m_vert.m_attribs[semantic].m_semanticToVertexAttributeLocation;
-			attrib.offset = staticState.m_vert.m_attribs[semantic].m_relativeOffset;
-
-			if(!bindingSet.get(attrib.binding))
-			{
-				bindingSet.set(attrib.binding);
+		pso = createMonolithicPipeline(state);
+		g_graphicsPipelinesCompiledStatVar.increment(1);
+	}
 
-				VkVertexInputBindingDescription& binding = vertBindings[vertCi.vertexBindingDescriptionCount++];
+	// Now try to add the PSO to the hashmap
+	Bool psoAdded = false;
+	{
+		WLockGuard<RWMutex> lock(m_mtx);
 
-				binding.binding = attrib.binding;
-				binding.inputRate = convertVertexStepRate(staticState.m_vert.m_bindings[attrib.binding].m_stepRate);
-				binding.stride = staticState.m_vert.m_bindings[attrib.binding].m_stride;
-			}
+		auto it = m_map.find(state.m_globalHash);
+		if(it == m_map.getEnd())
+		{
+			// Not found, add it
+			m_map.emplace(state.m_globalHash, pso);
+			psoAdded = true;
+		}
+		else
+		{
+			// Found, remove the PSO that was proactively created and use the old one
+			vkDestroyPipeline(getVkDevice(), pso, nullptr);
+			pso = *it;
 		}
 	}
 
-	ci.pVertexInputState = &vertCi;
-
-	// IA
-	VkPipelineInputAssemblyStateCreateInfo iaCi = {};
-	iaCi.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	iaCi.primitiveRestartEnable = staticState.m_ia.m_primitiveRestartEnabled;
-	iaCi.topology = convertTopology(staticState.m_ia.m_topology);
-	ci.pInputAssemblyState = &iaCi;
-
-	// Viewport
-	VkPipelineViewportStateCreateInfo vpCi = {};
-	vpCi.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	vpCi.scissorCount = 1;
-	vpCi.viewportCount = 1;
-	ci.pViewportState = &vpCi;
+	if(useLibraries && psoAdded)
+	{
+		libCache.queueOptimizedLink(linkTask);
+	}
 
-	// Raster
-	VkPipelineRasterizationStateCreateInfo rastCi = {};
-	rastCi.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rastCi.depthClampEnable = false;
-	rastCi.rasterizerDiscardEnable = false;
-	rastCi.polygonMode = convertFillMode(staticState.m_rast.m_fillMode);
-	rastCi.cullMode = convertCullMode(staticState.m_rast.m_cullMode);
-	rastCi.frontFace = (!staticState.m_misc.m_rendersToSwapchain) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE; // For viewport flip
-	rastCi.depthBiasEnable = staticState.m_rast.m_depthBiasEnabled;
-	rastCi.lineWidth = 1.0f;
-	ci.pRasterizationState = &rastCi;
+	// Final thing, bind the PSO
+	vkCmdBindPipeline(cmdb, VK_PIPELINE_BIND_POINT_GRAPHICS, pso);
+}
 
-	// MS
-	VkPipelineMultisampleStateCreateInfo msCi = {};
-	msCi.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	msCi.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	ci.pMultisampleState = &msCi;
+PipelineLibraryCache::PipelineLibraryCache()
+{
+	m_enabled = !!(getGrManagerImpl().getExtensions() & VulkanExtensions::kEXT_graphics_pipeline_library);
 
-	// Depth stencil
-	VkPipelineDepthStencilStateCreateInfo dsCi;
-	if(hasDepthRt || hasStencilRt)
+	if(m_enabled)
 	{
-		dsCi = {};
-		dsCi.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-
-		if(hasDepthRt)
-		{
-			dsCi.depthTestEnable = depthTestEnabled;
-			dsCi.depthWriteEnable = staticState.m_depth.m_writeEnabled;
-			dsCi.depthCompareOp = convertCompareOp(staticState.m_depth.m_compare);
-		}
+		m_thread.start(this, threadMain);
+	}
+}
 
-		if(hasStencilRt)
+PipelineLibraryCache::~PipelineLibraryCache()
+{
+	if(m_enabled)
+	{
 		{
-			const auto& ss = staticState.m_stencil;
-
-			dsCi.stencilTestEnable = stencilTestEnabled;
-			dsCi.front.failOp = convertStencilOp(ss.m_face[0].m_fail);
-			dsCi.front.passOp = convertStencilOp(ss.m_face[0].m_stencilPassDepthPass);
-			dsCi.front.depthFailOp = convertStencilOp(ss.m_face[0].m_stencilPassDepthFail);
-			dsCi.front.compareOp = convertCompareOp(ss.m_face[0].m_compare);
-			dsCi.back.failOp = convertStencilOp(ss.m_face[1].m_fail);
-			dsCi.back.passOp = convertStencilOp(ss.m_face[1].m_stencilPassDepthPass);
-			dsCi.back.depthFailOp = convertStencilOp(ss.m_face[1].m_stencilPassDepthFail);
-			dsCi.back.compareOp = convertCompareOp(ss.m_face[1].m_compare);
+			LockGuard lock(m_tasksMtx);
+			m_quit = true;
+			m_tasks.destroy();
 		}
 
-		ci.pDepthStencilState = &dsCi;
+		m_tasksCondVar.notifyOne();
+		[[maybe_unused]] const Error err = m_thread.join();
 	}
 
-	// Color/blend
-	Array<VkPipelineColorBlendAttachmentState, kMaxColorRenderTargets> colAttachments = {};
+	for(VkPipeline lib : m_vertexInputLibraries)
+	{
+		vkDestroyPipeline(getVkDevice(), lib, nullptr);
+	}
 
-	VkPipelineColorBlendStateCreateInfo colCi = {};
-	colCi.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	if(staticState.m_misc.m_colorRtMask.getAnySet())
+	for(VkPipeline lib : m_fragmentOutputLibraries)
 	{
-		colCi.attachmentCount = staticState.m_misc.m_colorRtMask.getSetBitCount();
-		colCi.pAttachments = &colAttachments[0];
+		vkDestroyPipeline(getVkDevice(), lib, nullptr);
+	}
+}
 
-		for(U i = 0; i < colCi.attachmentCount; ++i)
+VkPipeline PipelineLibraryCache::getOrCreateVertexInputLibrary(U64 hash, const GraphicsStateTracker& state)
+{
+	{
+		RLockGuard<RWMutex> lock(m_librariesMtx);
+		auto it = m_vertexInputLibraries.find(hash);
+		if(it != m_vertexInputLibraries.getEnd())
 		{
-			VkPipelineColorBlendAttachmentState& out = colAttachments[i];
-			const auto& in = staticState.m_blend.m_colorRts[i];
-
-			out.blendEnable = blendingEnabled(in.m_srcRgb, in.m_dstRgb, in.m_srcA, in.m_dstA, in.m_funcRgb, in.m_funcA);
-			out.srcColorBlendFactor = convertBlendFactor(in.m_srcRgb);
-			out.dstColorBlendFactor = convertBlendFactor(in.m_dstRgb);
-			out.srcAlphaBlendFactor = convertBlendFactor(in.m_srcA);
-			out.dstAlphaBlendFactor = convertBlendFactor(in.m_dstA);
-			out.colorBlendOp = convertBlendOperation(in.m_funcRgb);
-			out.alphaBlendOp = convertBlendOperation(in.m_funcA);
-
-			out.colorWriteMask = convertColorWriteMask(in.m_channelWriteMask);
+			return *it;
 		}
-
-		ci.pColorBlendState = &colCi;
 	}
 
-	// Renderpass related (Dynamic rendering)
-	Array<VkFormat, kMaxColorRenderTargets> dynamicRenderingAttachmentFormats = {};
-	VkPipelineRenderingCreateInfoKHR dynRendering = {};
-	dynRendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
-	dynRendering.colorAttachmentCount = staticState.m_misc.m_colorRtMask.getSetBitCount();
-	dynRendering.pColorAttachmentFormats = dynamicRenderingAttachmentFormats.getBegin();
-	for(U i = 0; i < kMaxColorRenderTargets; ++i)
+	GraphicsPipelineCreateInfoStorage storage;
+	storage.setLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+	GraphicsPipelineFactory::setVertexInputState(state, storage);
+
+	VkPipeline lib = createGraphicsPipeline(storage.m_ci);
+
+	WLockGuard<RWMutex> lock(m_librariesMtx);
+	auto it = m_vertexInputLibraries.find(hash);
+	if(it != m_vertexInputLibraries.getEnd())
 	{
-		dynamicRenderingAttachmentFormats[i] =
-			(staticState.m_misc.m_colorRtMask.get(i)) ? convertFormat(staticState.m_misc.m_colorRtFormats[i]) : VK_FORMAT_UNDEFINED;
+		vkDestroyPipeline(getVkDevice(), lib, nullptr);
+		lib = *it;
 	}
-
-	if(hasDepthRt)
+	else
 	{
-		dynRendering.depthAttachmentFormat = convertFormat(staticState.m_misc.m_depthStencilFormat);
+		m_vertexInputLibraries.emplace(hash, lib);
+		g_graphicsPipelineLibrariesStatVar.increment(1);
 	}
 
-	if(hasStencilRt)
+	return lib;
+}
+
+VkPipeline PipelineLibraryCache::getOrCreateFragmentOutputLibrary(U64 hash, const GraphicsStateTracker& state)
+{
 	{
-		dynRendering.stencilAttachmentFormat = convertFormat(staticState.m_misc.m_depthStencilFormat);
+		RLockGuard<RWMutex> lock(m_librariesMtx);
+		auto it = m_fragmentOutputLibraries.find(hash);
+		if(it != m_fragmentOutputLibraries.getEnd())
+		{
+			return *it;
+		}
 	}
 
-	appendPNextList(ci, &dynRendering);
+	GraphicsPipelineCreateInfoStorage storage;
+	storage.setLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+	GraphicsPipelineFactory::setFragmentOutputState(state, storage);
 
-	// Almost all state is dynamic. Depth bias is static
-	VkPipelineDynamicStateCreateInfo dynCi = {};
-	dynCi.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	VkPipeline lib = createGraphicsPipeline(storage.m_ci);
 
-	static constexpr Array<VkDynamicState, 10> kDyn = {
-		{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_BLEND_CONSTANTS, VK_DYNAMIC_STATE_DEPTH_BOUNDS,
-		 VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, VK_DYNAMIC_STATE_STENCIL_REFERENCE, VK_DYNAMIC_STATE_LINE_WIDTH,
-		 VK_DYNAMIC_STATE_DEPTH_BIAS, VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR}};
+	WLockGuard<RWMutex> lock(m_librariesMtx);
+	auto it = m_fragmentOutputLibraries.find(hash);
+	if(it != m_fragmentOutputLibraries.getEnd())
+	{
+		vkDestroyPipeline(getVkDevice(), lib, nullptr);
+		lib = *it;
+	}
+	else
+	{
+		m_fragmentOutputLibraries.emplace(hash, lib);
+		g_graphicsPipelineLibrariesStatVar.increment(1);
+	}
 
-	dynCi.dynamicStateCount = (getGrManagerImpl().getDeviceCapabilities().m_vrs) ? kDyn.getSize() : (kDyn.getSize() - 1);
-	dynCi.pDynamicStates = &kDyn[0];
-	ci.pDynamicState = &dynCi;
+	return lib;
+}
 
-	// The rest
-	ci.layout = prog.getPipelineLayout().getHandle();
-	ci.subpass = 0;
+void PipelineLibraryCache::queueOptimizedLink(const LinkTask& task)
+{
+	ANKI_ASSERT(m_enabled && task.m_factory && task.m_libraryCount > 0);
 
-	// Create the pipeline
 	{
-		ANKI_TRACE_SCOPED_EVENT(VkPipelineCreate);
+		LockGuard lock(m_tasksMtx);
+		m_tasks.emplaceBack(task);
+	}
 
-#if ANKI_PLATFORM_MOBILE
-		if(PipelineCache::getSingleton().m_globalCreatePipelineMtx)
-		{
-			PipelineCache::getSingleton().m_globalCreatePipelineMtx->lock();
-		}
-#endif
+	m_tasksCondVar.notifyOne();
+}
 
-		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(getVkDevice(), PipelineCache::getSingleton().m_cacheHandle, 1, &ci, nullptr, &pso));
+void PipelineLibraryCache::cancelOptimizedLinks(GraphicsPipelineFactory& factory)
+{
+	LockGuard lock(m_tasksMtx);
 
-#if ANKI_PLATFORM_MOBILE
-		if(PipelineCache::getSingleton().m_globalCreatePipelineMtx)
+	for(U32 i = m_tasks.getSize(); i > 0; --i)
+	{
+		if(m_tasks[i - 1].m_factory == &factory)
 		{
-			PipelineCache::getSingleton().m_globalCreatePipelineMtx->unlock();
+			m_tasks.erase(m_tasks.getBegin() + i - 1);
 		}
-#endif
 	}
 
-	// Now try to add the PSO to the hashmap
+	while(m_factoryInFlight == &factory)
 	{
-		WLockGuard<RWMutex> lock(m_mtx);
+		m_taskDoneCondVar.wait(m_tasksMtx);
+	}
+}
 
-		auto it = m_map.find(state.m_globalHash);
-		if(it == m_map.getEnd())
+Error PipelineLibraryCache::threadMain(ThreadCallbackInfo& info)
+{
+	PipelineLibraryCache& self = *static_cast<PipelineLibraryCache*>(info.m_userData);
+
+	while(true)
+	{
+		LinkTask task;
 		{
-			// Not found, add it
-			m_map.emplace(state.m_globalHash, pso);
+			LockGuard lock(self.m_tasksMtx);
+
+			while(!self.m_quit && self.m_tasks.isEmpty())
+			{
+				self.m_tasksCondVar.wait(self.m_tasksMtx);
+			}
+
+			if(self.m_quit)
+			{
+				break;
+			}
+
+			task = self.m_tasks[0];
+			self.m_tasks.erase(self.m_tasks.getBegin());
+			self.m_factoryInFlight = task.m_factory;
 		}
-		else
+
+		// The libraries of the factory can't go away while it's in flight
+		const VkPipeline pso =
+			linkGraphicsPipelineLibraries(ConstWeakArray<VkPipeline>(task.m_libraries.getBegin(), task.m_libraryCount), task.m_layout, true);
+		task.m_factory->replacePipeline(task.m_hash, pso);
+		g_graphicsPipelinesOptimizedStatVar.increment(1);
+
 		{
-			// Found, remove the PSO that was proactively created and use the old one
-			vkDestroyPipeline(getVkDevice(), pso, nullptr);
-			pso = *it;
+			LockGuard lock(self.m_tasksMtx);
+			self.m_factoryInFlight = nullptr;
 		}
+
+		self.m_taskDoneCondVar.notifyAll();
 	}
 
-	// Final thing, bind the PSO
-	vkCmdBindPipeline(cmdb, VK_PIPELINE_BIND_POINT_GRAPHICS, pso);
+	return Error::kNone;
 }
 
 Error PipelineCache::init(CString cacheDir)
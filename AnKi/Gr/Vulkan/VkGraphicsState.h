@@ -8,25 +8,110 @@
 #include <AnKi/Gr/Vulkan/VkCommon.h>
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 
 namespace anki {
 
+// Forward
+class ShaderProgramImpl;
+class GraphicsPipelineCreateInfoStorage;
+
 /// @addtogroup vulkan
 /// @{
 
 class GraphicsPipelineFactory
 {
+	friend class PipelineLibraryCache;
+
 public:
 	~GraphicsPipelineFactory();
 
+	/// Create the parts of the pipeline that depend only on the program. Only used with VK_EXT_graphics_pipeline_library.
+	Error init(const ShaderProgramImpl& prog);
+
 	/// Write state to the command buffer.
 	/// @note It's thread-safe.
 	void flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb);
 
 private:
-	GrHashMap<U64, VkPipeline> m_map;
+	GrSwissHashMap<U64, VkPipeline> m_map;
 	RWMutex m_mtx;
+
+	/// Graphics pipeline library parts that are owned by the program. One pre-rasterization part per fill mode.
+	Array<VkPipeline, U32(FillMode::kCount)> m_preRasterizationLibraries = {};
+	VkPipeline m_fragmentShaderLibrary = VK_NULL_HANDLE;
+
+	/// Fast linked pipelines that got replaced by their optimized version. They might still be referenced by command buffers in flight.
+	GrDynamicArray<VkPipeline> m_retiredPipelines;
+
+	VkPipeline createMonolithicPipeline(const GraphicsStateTracker& state);
+
+	VkPipeline getOrCreatePreRasterizationLibrary(const ShaderProgramImpl& prog, FillMode fillMode);
+
+	/// Called by the PipelineLibraryCache when an optimized pipeline is ready.
+	void replacePipeline(U64 hash, VkPipeline optimizedPso);
+
+	static void flushExtendedDynamicState(GraphicsStateTracker& state, VkCommandBuffer& cmdb);
+
+	static void setVertexInputState(const GraphicsStateTracker& state, GraphicsPipelineCreateInfoStorage& storage);
+	static void setPreRasterizationState(const ShaderProgramImpl& prog, FillMode fillMode, FaceSelectionBit cullMode, Bool rendersToSwapchain,
+										 Bool depthBiasEnabled, GraphicsPipelineCreateInfoStorage& storage);
+	static void setFragmentShaderState(const ShaderProgramImpl& prog, GraphicsPipelineCreateInfoStorage& storage);
+	static void setFragmentOutputState(const GraphicsStateTracker& state, GraphicsPipelineCreateInfoStorage& storage);
+};
+
+/// The graphics pipeline library parts that are shared between programs (vertex input and fragment output) plus a thread that links the
+/// optimized pipelines in the background.
+class PipelineLibraryCache : public MakeSingleton<PipelineLibraryCache>
+{
+	friend class GraphicsPipelineFactory;
+
+public:
+	PipelineLibraryCache();
+
+	~PipelineLibraryCache();
+
+	/// True if VK_EXT_graphics_pipeline_library is used.
+	Bool isEnabled() const
+	{
+		return m_enabled;
+	}
+
+private:
+	class LinkTask
+	{
+	public:
+		GraphicsPipelineFactory* m_factory = nullptr;
+		U64 m_hash = 0;
+		Array<VkPipeline, 4> m_libraries = {};
+		U32 m_libraryCount = 0;
+		VkPipelineLayout m_layout = VK_NULL_HANDLE;
+	};
+
+	GrSwissHashMap<U64, VkPipeline> m_vertexInputLibraries;
+	GrSwissHashMap<U64, VkPipeline> m_fragmentOutputLibraries;
+	RWMutex m_librariesMtx;
+
+	GrDynamicArray<LinkTask> m_tasks;
+	GraphicsPipelineFactory* m_factoryInFlight = nullptr;
+	Mutex m_tasksMtx;
+	ConditionVariable m_tasksCondVar;
+	ConditionVariable m_taskDoneCondVar;
+
+	Thread m_thread = {"PsoLink"};
+	Bool m_quit = false;
+	Bool m_enabled = false;
+
+	VkPipeline getOrCreateVertexInputLibrary(U64 hash, const GraphicsStateTracker& state);
+
+	VkPipeline getOrCreateFragmentOutputLibrary(U64 hash, const GraphicsStateTracker& state);
+
+	void queueOptimizedLink(const LinkTask& task);
+
+	/// Remove the queued tasks of a factory and wait for the one in flight.
+	void cancelOptimizedLinks(GraphicsPipelineFactory& factory);
+
+	static Error threadMain(ThreadCallbackInfo& info);
 };
 
 /// On disk pipeline cache.
@@ -295,6 +295,7 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	if(graphicsProg)
 	{
 		m_graphics.m_pplineFactory = anki::newInstance<GraphicsPipelineFactory>(GrMemoryPool::getSingleton());
+		ANKI_CHECK(m_graphics.m_pplineFactory->init(*this));
 	}
 
 	// Create the pipeline if compute
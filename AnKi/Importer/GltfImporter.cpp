@@ -5,6 +5,7 @@
 
 #include <AnKi/Importer/GltfImporter.h>
 #include <AnKi/Util/System.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/ThreadJobManager.h>
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/Xml.h>
@@ -316,6 +317,12 @@ Error GltfImporter::init(const GltfImporterInitInfo& initInfo)
 
 Error GltfImporter::writeAll()
 {
+	const Second beginTime = HighRezTimer::getCurrentTime();
+	for(Atomic<U64>& ns : m_stageNanoseconds)
+	{
+		ns.setNonAtomically(0);
+	}
+
 	populateNodePtrToIdx();
 
 	ImporterString sceneFname;
@@ -334,28 +341,10 @@ Error GltfImporter::writeAll()
 	}
 
 	// Fire up all requests
+	// Meshes split their work in many tasks themselves
 	for(auto& req : m_meshImportRequests)
 	{
-		if(m_jobManager)
-		{
-			m_jobManager->dispatchTask([&req]([[maybe_unused]] U32 threadId) {
-				Error err = req.m_importer->m_errorInThread.load();
-
-				if(!err)
-				{
-					err = req.m_importer->writeMesh(*req.m_value);
-				}
-
-				if(err)
-				{
-					req.m_importer->m_errorInThread.store(err._getCode());
-				}
-			});
-		}
-		else
-		{
-			ANKI_CHECK(writeMesh(*req.m_value));
-		}
+		ANKI_CHECK(writeMesh(*req.m_value));
 	}
 
 	for(auto& req : m_materialImportRequests)
@@ -448,10 +437,23 @@ Error GltfImporter::writeAll()
 		ANKI_CHECK(writeAnimation(*anim));
 	}
 
+	m_totalTime = HighRezTimer::getCurrentTime() - beginTime;
+
 	ANKI_IMPORTER_LOGV("Importing GLTF has completed");
 	return Error::kNone;
 }
 
+GltfImporterStats GltfImporter::getStats() const
+{
+	GltfImporterStats stats;
+	for(GltfImporterStage stage : EnumIterable<GltfImporterStage>())
+	{
+		stats.m_stageTimes[stage] = Second(m_stageNanoseconds[stage].load()) / 1000000000.0;
+	}
+	stats.m_totalTime = m_totalTime;
+	return stats;
+}
+
 Error GltfImporter::appendExtras(const cgltf_extras& extras, ImporterHashMap<CString, ImporterString>& out) const
 {
 	cgltf_size extrasSize;
@@ -754,6 +756,12 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 			const ImporterString meshFname = computeMeshResourceFilename(*node.mesh);
 			ANKI_CHECK(m_sceneFile.writeTextf("comp:loadMeshResource(\"%s%s\")\n", m_rpath.cstr(), meshFname.cstr()));
 
+			addRequest<const cgltf_mesh*>(node.mesh, m_meshImportRequests);
+			if(!isCollisionMesh(*node.mesh))
+			{
+				m_collisionMeshes.emplace(node.mesh, true);
+			}
+
 			Transform localTrf;
 			ANKI_CHECK(getNodeTransform(node, localTrf));
 			ANKI_CHECK(writeTransform(parentTrf.combineTransformations(localTrf)));
@@ -872,6 +880,11 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 
 				if(selfCollision)
 				{
+					if(!isCollisionMesh(*node.mesh))
+					{
+						m_collisionMeshes.emplace(node.mesh, true);
+					}
+
 					ANKI_CHECK(m_sceneFile.writeText("comp = node:newBodyComponent()\n"));
 
 					const ImporterString meshFname = computeMeshResourceFilename(*node.mesh);
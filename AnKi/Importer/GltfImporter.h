@@ -16,6 +16,9 @@
 
 namespace anki {
 
+// Forward
+class MeshBinaryVertexAttribute;
+
 /// @addtogroup importer
 /// @{
 
@@ -37,6 +40,29 @@ public:
 	Bool m_importTextures = false;
 };
 
+/// @memberof GltfImporter
+enum class GltfImporterStage : U8
+{
+	kMeshLoad,
+	kMeshOptimize,
+	kMeshDecimate,
+	kMeshMeshletize,
+	kMeshWrite,
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(GltfImporterStage)
+
+/// @memberof GltfImporter
+class GltfImporterStats
+{
+public:
+	/// The time spent in each stage. It's the sum of the times of all threads so it can be more than m_totalTime.
+	Array<Second, U32(GltfImporterStage::kCount)> m_stageTimes = {};
+	Second m_totalTime = 0.0;
+};
+
 /// Import GLTF and spit AnKi scenes.
 class GltfImporter
 {
@@ -49,7 +75,12 @@ public:
 
 	Error writeAll();
 
+	/// Get some timings of the last writeAll().
+	GltfImporterStats getStats() const;
+
 private:
+	class MeshImportContext;
+
 	// Data
 	ImporterString m_inputFname;
 	ImporterString m_outDir;
@@ -66,7 +97,11 @@ private:
 
 	mutable Atomic<I32> m_errorInThread = {0};
 
+	mutable Array<Atomic<U64>, U32(GltfImporterStage::kCount)> m_stageNanoseconds = {};
+	Second m_totalTime = 0.0;
+
 	ImporterHashMap<const void*, U32> m_nodePtrToIdx; ///< Need an index for the unnamed nodes.
+	ImporterHashMap<const void*, Bool> m_collisionMeshes; ///< Meshes used by body components.
 
 	F32 m_lodFactor = 1.0f;
 	U32 m_lodCount = 1;
@@ -174,13 +209,33 @@ private:
 
 	// Resources
 	Error writeMesh(const cgltf_mesh& mesh) const;
-	Error writeMeshInternal(const cgltf_mesh& mesh) const;
 	Error writeMaterial(const cgltf_material& mtl, Bool writeRayTracing) const;
 	Error writeMaterialInternal(const cgltf_material& mtl, Bool writeRayTracing) const;
 	Error writeModel(const cgltf_mesh& mesh) const;
 	Error writeAnimation(const cgltf_animation& anim);
 	Error writeSkeleton(const cgltf_skin& skin) const;
 
+	// Mesh import stages. See MeshImportContext
+	template<typename TFunc, typename TNextStageFunc>
+	void dispatchMeshStage(MeshImportContext& ctx, U32 taskCount, TFunc func, TNextStageFunc nextStageFunc) const;
+	Error loadSubmesh(MeshImportContext& ctx, U32 submeshIdx) const;
+	void decimateMesh(MeshImportContext& ctx) const;
+	void meshletizeMesh(MeshImportContext& ctx) const;
+	void finalizeMesh(MeshImportContext& ctx) const;
+	Error writeMeshFile(const MeshImportContext& ctx) const;
+	Error writeCollisionBvhFile(const MeshImportContext& ctx, const MeshBinaryVertexAttribute& posAttrib, F32 posScale,
+								const Vec3& posTranslation) const;
+
+	Bool isCollisionMesh(const cgltf_mesh& mesh) const
+	{
+		return m_collisionMeshes.find(&mesh) != m_collisionMeshes.getEnd();
+	}
+
+	void addStageTime(GltfImporterStage stage, Second time) const
+	{
+		m_stageNanoseconds[stage].fetchAdd(U64(time * 1000000000.0));
+	}
+
 	// Scene
 	Error writeTransform(const Transform& trf);
 	Error visitNode(const cgltf_node& node, const Transform& parentTrf, const ImporterHashMap<CString, ImporterString>& parentExtras);
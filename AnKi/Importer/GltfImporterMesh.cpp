@@ -5,10 +5,15 @@
 
 #include <AnKi/Importer/GltfImporter.h>
 #include <AnKi/Util/StringList.h>
+#include <AnKi/Util/SwissHashMap.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Collision/Plane.h>
 #include <AnKi/Collision/Functions.h>
 #include <AnKi/Collision/Sphere.h>
 #include <AnKi/Resource/MeshBinary.h>
+#include <AnKi/Resource/CpuMeshResource.h>
+#include <AnKi/Physics/PhysicsCollisionShape.h>
 #include <AnKi/Shaders/Include/MeshTypes.h>
 #include <MeshOptimizer/meshoptimizer.h>
 
@@ -145,8 +150,29 @@ public:
 
 	Vec3 m_sphereCenter;
 	F32 m_sphereRadius = 0.0f;
+
+	Bool m_hasBoneWeights = false;
 };
 
+/// A range of the index buffer of a submesh that gets meshletized independently.
+class MeshletChunk
+{
+public:
+	U32 m_lod = 0;
+	U32 m_submeshIdx = 0;
+	U32 m_firstIndex = 0;
+	U32 m_indexCount = 0;
+
+	// The output
+	ImporterDynamicArray<TempVertex> m_verts;
+	ImporterDynamicArray<U32> m_indices;
+	ImporterDynamicArray<ImporterMeshlet> m_meshlets;
+	ImporterDynamicArray<U8> m_localIndices;
+};
+
+/// Big submeshes are meshletized in chunks of that many triangles.
+constexpr U32 kMeshletChunkTriangleCount = 128 * 1024;
+
 static void reindexSubmesh(SubMesh& submesh)
 {
 	const U32 vertSize = sizeof(submesh.m_verts[0]);
@@ -215,62 +241,106 @@ static void optimizeSubmesh(SubMesh& submesh)
 	}
 }
 
-/// Decimate a submesh using meshoptimizer.
-static void decimateSubmesh(F32 factor, SubMesh& submesh)
+/// Decimate a submesh using meshoptimizer. The source is left untouched so more than one LOD can be generated from it at the same time.
+static void decimateSubmesh(F32 factor, const SubMesh& src, SubMesh& dst)
 {
 	ANKI_ASSERT(factor > 0.0f && factor < 1.0f);
-	const PtrSize targetIndexCount = PtrSize(F32(submesh.m_indices.getSize() / 3) * factor) * 3;
+	ANKI_ASSERT(&src != &dst);
+
+	dst.m_aabbMin = src.m_aabbMin;
+	dst.m_aabbMax = src.m_aabbMax;
+	dst.m_sphereCenter = src.m_sphereCenter;
+	dst.m_sphereRadius = src.m_sphereRadius;
+	dst.m_hasBoneWeights = src.m_hasBoneWeights;
+
+	const PtrSize targetIndexCount = PtrSize(F32(src.m_indices.getSize() / 3) * factor) * 3;
 	if(targetIndexCount == 0)
 	{
+		dst.m_verts = src.m_verts;
+		dst.m_indices = src.m_indices;
 		return;
 	}
 
 	// Decimate
 	ImporterDynamicArray<U32> newIndices;
-	newIndices.resize(submesh.m_indices.getSize());
-	newIndices.resize(U32(meshopt_simplify(&newIndices[0], &submesh.m_indices[0], submesh.m_indices.getSize(), &submesh.m_verts[0].m_position.x(),
-										   submesh.m_verts.getSize(), sizeof(TempVertex), targetIndexCount, 1e-2f)));
-
-	// Re-pack
-	ImporterDynamicArray<U32> reindexedIndices;
-	ImporterDynamicArray<TempVertex> newVerts;
-	ImporterHashMap<U32, U32> vertexStored;
+	newIndices.resize(src.m_indices.getSize());
+	newIndices.resize(U32(meshopt_simplify(&newIndices[0], &src.m_indices[0], src.m_indices.getSize(), &src.m_verts[0].m_position[0],
+										   src.m_verts.getSize(), sizeof(TempVertex), targetIndexCount, 1e-2f)));
+
+	// Re-pack. Keep the vertices in the order they are first referenced
+	ImporterDynamicArray<U32> oldToNewVertex;
+	oldToNewVertex.resize(src.m_verts.getSize(), kMaxU32);
+	dst.m_indices.resize(newIndices.getSize());
+	dst.m_verts.destroy();
 	for(U32 idx = 0; idx < newIndices.getSize(); ++idx)
 	{
-		U32 newIdx;
-		auto it = vertexStored.find(newIndices[idx]);
-		if(it == vertexStored.getEnd())
+		U32& newIdx = oldToNewVertex[newIndices[idx]];
+		if(newIdx == kMaxU32)
 		{
 			// Store the vertex
-			newVerts.emplaceBack(submesh.m_verts[newIndices[idx]]);
-			newIdx = newVerts.getSize() - 1;
-			vertexStored.emplace(newIndices[idx], newIdx);
-		}
-		else
-		{
-			// Already stored
-			newIdx = *it;
+			newIdx = dst.m_verts.getSize();
+			dst.m_verts.emplaceBack(src.m_verts[newIndices[idx]]);
 		}
 
-		// Store the new index
-		reindexedIndices.emplaceBack(newIdx);
+		dst.m_indices[idx] = newIdx;
 	}
-
-	// Move back
-	submesh.m_indices = std::move(reindexedIndices);
-	submesh.m_verts = std::move(newVerts);
 }
 
 /// If normal A and normal B have the same position then try to merge them. Do that before optimizations.
 static void fixNormals(const F32 normalsMergeAngle, SubMesh& submesh)
 {
+	// Put the vertices in a grid of cells that are bigger than the merge distance. Then only the vertices of the neighbouring cells need to be
+	// checked
+	constexpr F64 kCellSize = F64(kEpsilonf) * 2.0;
+	auto computeCellHash = [](const Array<F64, 3>& cell) {
+		return computeHash(&cell[0], sizeof(cell));
+	};
+
+	ImporterSwissHashMap<U64, U32> cellToLastVertex;
+	ImporterDynamicArray<U32> prevVertexInCell; // Linked list of the vertices of each cell
+	prevVertexInCell.resize(submesh.m_verts.getSize(), kMaxU32);
+	ImporterDynamicArray<U32> candidates;
+
 	for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
 	{
 		const Vec3& pos = submesh.m_verts[v].m_position;
 		Vec3& normal = submesh.m_verts[v].m_normal;
 
-		for(U32 prevV = 0; prevV < v; ++prevV)
+		// Adding 0.0 turns -0.0 to 0.0 so both end up in the same cell
+		Array<F64, 3> cell;
+		for(U32 c = 0; c < 3; ++c)
 		{
+			cell[c] = floor(F64(pos[c]) / kCellSize) + 0.0;
+		}
+
+		// Gather the previous vertices of the neighbouring cells
+		candidates.resize(0);
+		for(F64 z = -1.0; z <= 1.0; z += 1.0)
+		{
+			for(F64 y = -1.0; y <= 1.0; y += 1.0)
+			{
+				for(F64 x = -1.0; x <= 1.0; x += 1.0)
+				{
+					auto it = cellToLastVertex.find(computeCellHash({cell[0] + x, cell[1] + y, cell[2] + z}));
+					for(U32 prevV = (it != cellToLastVertex.getEnd()) ? *it : kMaxU32; prevV != kMaxU32; prevV = prevVertexInCell[prevV])
+					{
+						candidates.emplaceBack(prevV);
+					}
+				}
+			}
+		}
+
+		// Visit them in the order they appear in the vertex buffer because the merging modifies the normals. Hash collisions can add the same
+		// vertex twice so skip those
+		std::sort(candidates.getBegin(), candidates.getEnd());
+		for(U32 i = 0; i < candidates.getSize(); ++i)
+		{
+			const U32 prevV = candidates[i];
+			if(i > 0 && candidates[i - 1] == prevV)
+			{
+				continue;
+			}
+
 			const Vec3& otherPos = submesh.m_verts[prevV].m_position;
 
 			// Check the positions dist
@@ -293,10 +363,23 @@ static void fixNormals(const F32 normalsMergeAngle, SubMesh& submesh)
 			normal = newNormal;
 			otherNormal = newNormal;
 		}
+
+		// Add the vertex to its cell
+		const U64 cellHash = computeCellHash(cell);
+		auto it = cellToLastVertex.find(cellHash);
+		if(it != cellToLastVertex.getEnd())
+		{
+			prevVertexInCell[v] = *it;
+			*it = v;
+		}
+		else
+		{
+			cellToLastVertex.emplace(cellHash, v);
+		}
 	}
 }
 
-static Bool isConvex(const ImporterList<SubMesh>& submeshes)
+static Bool isConvex(const ImporterDynamicArray<SubMesh>& submeshes)
 {
 	Bool convex = true;
 	for(const SubMesh& submesh : submeshes)
@@ -347,10 +430,15 @@ static Bool isConvex(const ImporterList<SubMesh>& submeshes)
 	return convex;
 }
 
-static void generateMeshlets(SubMesh& submesh)
+/// Meshletize a range of the index buffer of a submesh. The ranges are independent so big submeshes can be split in many tasks.
+static void generateMeshlets(const SubMesh& submesh, MeshletChunk& chunk)
 {
+	ANKI_ASSERT(chunk.m_indexCount > 0 && (chunk.m_indexCount % 3) == 0);
+	ANKI_ASSERT(chunk.m_firstIndex + chunk.m_indexCount <= submesh.m_indices.getSize());
+	const U32* inIndices = &submesh.m_indices[chunk.m_firstIndex];
+
 	// Allocate the arrays
-	const U32 maxMeshlets = U32(meshopt_buildMeshletsBound(submesh.m_indices.getSize(), kMaxVerticesPerMeshlet, kMaxPrimitivesPerMeshlet));
+	const U32 maxMeshlets = U32(meshopt_buildMeshletsBound(chunk.m_indexCount, kMaxVerticesPerMeshlet, kMaxPrimitivesPerMeshlet));
 
 	ImporterDynamicArray<U32> indicesToVertexBuffer;
 	indicesToVertexBuffer.resize(maxMeshlets * kMaxVerticesPerMeshlet);
@@ -363,10 +451,9 @@ static void generateMeshlets(SubMesh& submesh)
 
 	// Meshletize
 	constexpr F32 coneWeight = 0.0f;
-	const U32 meshletCount =
-		U32(meshopt_buildMeshlets(meshlets.getBegin(), indicesToVertexBuffer.getBegin(), localIndices.getBegin(), submesh.m_indices.getBegin(),
-								  submesh.m_indices.getSize(), &submesh.m_verts[0].m_position.x(), submesh.m_verts.getSize(), sizeof(TempVertex),
-								  kMaxVerticesPerMeshlet, kMaxPrimitivesPerMeshlet, coneWeight));
+	const U32 meshletCount = U32(meshopt_buildMeshlets(meshlets.getBegin(), indicesToVertexBuffer.getBegin(), localIndices.getBegin(), inIndices,
+													   chunk.m_indexCount, &submesh.m_verts[0].m_position[0], submesh.m_verts.getSize(),
+													   sizeof(TempVertex), kMaxVerticesPerMeshlet, kMaxPrimitivesPerMeshlet, coneWeight));
 
 	// Trim the arrays
 	const meshopt_Meshlet& last = meshlets[meshletCount - 1u];
@@ -375,21 +462,16 @@ static void generateMeshlets(SubMesh& submesh)
 	meshlets.resize(meshletCount);
 
 	// Create the new vertex and global index buffer
-	submesh.m_meshlets.destroy();
-	submesh.m_meshlets.resize(meshletCount);
-	submesh.m_localIndices.destroy();
-
-	ImporterDynamicArray<U32> newIndexBuffer;
-	ImporterDynamicArray<TempVertex> newVertexBuffer;
+	chunk.m_meshlets.resize(meshletCount);
 
 	for(U32 meshletIdx = 0; meshletIdx < meshletCount; ++meshletIdx)
 	{
 		const meshopt_Meshlet& inMeshlet = meshlets[meshletIdx];
-		ImporterMeshlet& outMeshlet = submesh.m_meshlets[meshletIdx];
+		ImporterMeshlet& outMeshlet = chunk.m_meshlets[meshletIdx];
 
-		outMeshlet.m_firstLocalIndex = submesh.m_localIndices.getSize();
+		outMeshlet.m_firstLocalIndex = chunk.m_localIndices.getSize();
 		outMeshlet.m_localIndexCount = inMeshlet.triangle_count * 3;
-		outMeshlet.m_firstVertex = newVertexBuffer.getSize();
+		outMeshlet.m_firstVertex = chunk.m_verts.getSize();
 		outMeshlet.m_vertexCount = inMeshlet.vertex_count;
 
 		ImporterHashMap<U8, U32> localIndexToNewGlobalIndex;
@@ -409,13 +491,13 @@ static void generateMeshlets(SubMesh& submesh)
 				// Add the vertex, global index
 				if(newVertex)
 				{
-					const U32 newGlobalIdx = newVertexBuffer.getSize();
+					const U32 newGlobalIdx = chunk.m_verts.getSize();
 
-					newIndexBuffer.emplaceBack(newGlobalIdx);
+					chunk.m_indices.emplaceBack(newGlobalIdx);
 
 					const U32 globalIdx = indicesToVertexBuffer[inMeshlet.vertex_offset + localIdx];
 					const TempVertex vert = submesh.m_verts[globalIdx];
-					newVertexBuffer.emplaceBack(vert);
+					chunk.m_verts.emplaceBack(vert);
 
 					localIndexToNewGlobalIndex.emplace(localIdx, newGlobalIdx);
 				}
@@ -423,11 +505,11 @@ static void generateMeshlets(SubMesh& submesh)
 				{
 					const U32 newGlobalIdx = *it;
 
-					newIndexBuffer.emplaceBack(newGlobalIdx);
+					chunk.m_indices.emplaceBack(newGlobalIdx);
 				}
 
 				// Append the local index
-				submesh.m_localIndices.emplaceBack(localIdx);
+				chunk.m_localIndices.emplaceBack(localIdx);
 			}
 		}
 
@@ -436,13 +518,13 @@ static void generateMeshlets(SubMesh& submesh)
 		// Compute bounds
 		const meshopt_Bounds bounds =
 			meshopt_computeMeshletBounds(&indicesToVertexBuffer[inMeshlet.vertex_offset], &localIndices[inMeshlet.triangle_offset],
-										 inMeshlet.triangle_count, &submesh.m_verts[0].m_position.x(), submesh.m_verts.getSize(), sizeof(TempVertex));
+										 inMeshlet.triangle_count, &submesh.m_verts[0].m_position[0], submesh.m_verts.getSize(), sizeof(TempVertex));
 		outMeshlet.m_coneApex = Vec3(&bounds.cone_apex[0]);
 		outMeshlet.m_coneDir = Vec3(&bounds.cone_axis[0]);
 		outMeshlet.m_coneAngle = acos(bounds.cone_cutoff) * 2.0f;
 
 		outMeshlet.m_sphere =
-			computeBoundingSphere(&newVertexBuffer[outMeshlet.m_firstVertex].m_position, outMeshlet.m_vertexCount, sizeof(TempVertex));
+			computeBoundingSphere(&chunk.m_verts[outMeshlet.m_firstVertex].m_position, outMeshlet.m_vertexCount, sizeof(TempVertex));
 
 		if(bounds.radius < outMeshlet.m_sphere.getRadius() && bounds.radius > 0.0f)
 		{
@@ -451,17 +533,69 @@ static void generateMeshlets(SubMesh& submesh)
 			outMeshlet.m_sphere.setRadius(bounds.radius);
 		}
 
-		outMeshlet.m_aabb = computeBoundingAabb(&newVertexBuffer[outMeshlet.m_firstVertex].m_position, outMeshlet.m_vertexCount, sizeof(TempVertex));
+		outMeshlet.m_aabb = computeBoundingAabb(&chunk.m_verts[outMeshlet.m_firstVertex].m_position, outMeshlet.m_vertexCount, sizeof(TempVertex));
 	}
+}
 
-	const F64 avgPrimCountPerMeshlet = F64(newIndexBuffer.getSize() / 3) / F64(meshletCount);
-	const F64 avgVertCountPerMeshlet = F64(newVertexBuffer.getSize()) / F64(meshletCount);
-	ANKI_IMPORTER_LOGV("Meshletization stats: %f%% more vertices, %u meshlets, primitive_count/meshlet %f, vert_count/meshlet %f",
-					   (F32(newVertexBuffer.getSize()) - F32(submesh.m_verts.getSize())) / F32(submesh.m_verts.getSize()) * 100.0f, meshletCount,
-					   avgPrimCountPerMeshlet, avgVertCountPerMeshlet);
+/// Replace the geometry of a submesh with the meshletized geometry of its chunks. The chunks should be in the order of the index buffer.
+static void mergeMeshletChunks(WeakArray<MeshletChunk> chunks, SubMesh& submesh)
+{
+	const U32 oldVertCount = submesh.m_verts.getSize();
+
+	if(chunks.getSize() == 1)
+	{
+		submesh.m_verts = std::move(chunks[0].m_verts);
+		submesh.m_indices = std::move(chunks[0].m_indices);
+		submesh.m_meshlets = std::move(chunks[0].m_meshlets);
+		submesh.m_localIndices = std::move(chunks[0].m_localIndices);
+	}
+	else
+	{
+		submesh.m_verts.destroy();
+		submesh.m_indices.destroy();
+		submesh.m_meshlets.destroy();
+		submesh.m_localIndices.destroy();
+
+		for(MeshletChunk& chunk : chunks)
+		{
+			const U32 firstVertex = submesh.m_verts.getSize();
+			const U32 firstLocalIndex = submesh.m_localIndices.getSize();
 
-	submesh.m_indices = std::move(newIndexBuffer);
-	submesh.m_verts = std::move(newVertexBuffer);
+			for(const TempVertex& vert : chunk.m_verts)
+			{
+				submesh.m_verts.emplaceBack(vert);
+			}
+
+			for(U32 idx : chunk.m_indices)
+			{
+				submesh.m_indices.emplaceBack(idx + firstVertex);
+			}
+
+			for(ImporterMeshlet meshlet : chunk.m_meshlets)
+			{
+				meshlet.m_firstVertex += firstVertex;
+				meshlet.m_firstLocalIndex += firstLocalIndex;
+				submesh.m_meshlets.emplaceBack(meshlet);
+			}
+
+			for(U8 idx : chunk.m_localIndices)
+			{
+				submesh.m_localIndices.emplaceBack(idx);
+			}
+
+			chunk.m_verts.destroy();
+			chunk.m_indices.destroy();
+			chunk.m_meshlets.destroy();
+			chunk.m_localIndices.destroy();
+		}
+	}
+
+	const U32 meshletCount = submesh.m_meshlets.getSize();
+	const F64 avgPrimCountPerMeshlet = F64(submesh.m_indices.getSize() / 3) / F64(meshletCount);
+	const F64 avgVertCountPerMeshlet = F64(submesh.m_verts.getSize()) / F64(meshletCount);
+	ANKI_IMPORTER_LOGV("Meshletization stats: %f%% more vertices, %u meshlets, primitive_count/meshlet %f, vert_count/meshlet %f",
+					   (F32(submesh.m_verts.getSize()) - F32(oldVertCount)) / F32(oldVertCount) * 100.0f, meshletCount, avgPrimCountPerMeshlet,
+					   avgVertCountPerMeshlet);
 }
 
 static void writeVertexAttribAndBufferInfoToHeader(VertexStreamId stream, MeshBinaryHeader& header, const Vec4& scale = Vec4(1.0f),
@@ -490,221 +624,430 @@ U32 GltfImporter::getMeshTotalVertexCount(const cgltf_mesh& mesh)
 	return totalVertexCount;
 }
 
-Error GltfImporter::writeMesh(const cgltf_mesh& mesh) const
+/// The state of a mesh while it's being imported. The import is split into stages and each stage into tasks that run in parallel:
+/// 1. Load and optimize every submesh (GLTF primitive)
+/// 2. Decimate every submesh for every LOD
+/// 3. Meshletize every range of kMeshletChunkTriangleCount triangles of every submesh of every LOD
+/// 4. Merge the meshlet ranges and write the file
+/// The last task of a stage kicks the next stage so the workers never wait for each other.
+class GltfImporter::MeshImportContext
 {
-	const Error err = writeMeshInternal(mesh);
-	if(err)
-	{
-		ANKI_IMPORTER_LOGE("Failed to write mesh: %s", mesh.name);
-	}
+public:
+	const cgltf_mesh* m_mesh = nullptr;
+	ImporterString m_filename;
+	Bool m_bakeCollisionBvh = false; ///< The mesh is used for collision so bake the BVH of its static shape.
 
-	return err;
-}
+	Array<ImporterDynamicArray<SubMesh>, kMaxLodCount> m_submeshes;
+	U32 m_lodCount = 1;
 
-Error GltfImporter::writeMeshInternal(const cgltf_mesh& mesh) const
-{
-	const ImporterString meshName = computeMeshResourceFilename(mesh);
-	ImporterString fname;
-	fname.sprintf("%s%s", m_outDir.cstr(), meshName.cstr());
-	ANKI_IMPORTER_LOGV("Importing mesh (%s): %s", (m_optimizeMeshes) ? "optimize" : "WON'T optimize", fname.cstr());
+	ImporterDynamicArray<Vec3> m_allPositions; ///< Used to calculate the overall bounding sphere.
+	ImporterDynamicArray<U32> m_firstPositions; ///< Where the positions of each submesh go in m_allPositions.
 
-	Array<ImporterList<SubMesh>, kMaxLodCount> submeshes;
-	Vec3 aabbMin(kMaxF32);
-	Vec3 aabbMax(kMinF32);
-	Bool hasBoneWeights = false;
-	ImporterDynamicArray<Vec3> allPositions; // Used to calculate the overall bounding sphere
+	ImporterDynamicArray<MeshletChunk> m_meshletChunks;
 
-	// Iterate primitives. Every primitive is a submesh
-	for(const cgltf_primitive* primitive = mesh.primitives; primitive < mesh.primitives + mesh.primitives_count; ++primitive)
-	{
-		if(primitive->type != cgltf_primitive_type_triangles)
+	Atomic<U32> m_pendingTaskCount = {0};
+	mutable Atomic<I32> m_error = {0};
+};
+
+template<typename TFunc, typename TNextStageFunc>
+void GltfImporter::dispatchMeshStage(MeshImportContext& ctx, U32 taskCount, TFunc func, TNextStageFunc nextStageFunc) const
+{
+	ANKI_ASSERT(taskCount > 0);
+
+	auto runTask = [this, &ctx, func](U32 taskIdx) {
+		Error err = ctx.m_error.load();
+		if(!err)
 		{
-			ANKI_IMPORTER_LOGE("Expecting triangles got %d", primitive->type);
-			return Error::kUserData;
+			err = m_errorInThread.load();
 		}
 
-		SubMesh& submesh = *submeshes[0].emplaceBack();
+		if(!err)
+		{
+			err = func(taskIdx);
+		}
 
-		// All attributes should have the same vertex count
-		U minVertCount = kMaxU;
-		U maxVertCount = kMinU;
-		for(const cgltf_attribute* attrib = primitive->attributes; attrib < primitive->attributes + primitive->attributes_count; ++attrib)
+		if(err)
 		{
-			minVertCount = min(minVertCount, U(attrib->data->count));
-			maxVertCount = max(maxVertCount, U(attrib->data->count));
+			ctx.m_error.store(err._getCode());
 		}
+	};
 
-		if(maxVertCount == 0 || minVertCount != maxVertCount)
+	if(!m_jobManager)
+	{
+		for(U32 i = 0; i < taskCount; ++i)
 		{
-			ANKI_IMPORTER_LOGE("Wrong number of vertices");
-			return Error::kUserData;
+			runTask(i);
 		}
 
-		U32 vertCount = U32(primitive->attributes[0].data->count);
-		submesh.m_verts.resize(vertCount);
+		nextStageFunc();
+		return;
+	}
 
-		//
-		// Gather positions + normals + UVs + bone stuff
-		//
-		for(const cgltf_attribute* attrib = primitive->attributes; attrib < primitive->attributes + primitive->attributes_count; ++attrib)
-		{
-			if(attrib->type == cgltf_attribute_type_position)
+	ctx.m_pendingTaskCount.store(taskCount);
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		auto task = [&ctx, runTask, nextStageFunc, i]([[maybe_unused]] U32 threadId) {
+			runTask(i);
+
+			if(ctx.m_pendingTaskCount.fetchSub(1) == 1)
 			{
-				U32 count = 0;
-				ANKI_CHECK(checkAttribute<Vec3>(*attrib));
-				visitAccessor<Vec3>(*attrib->data, [&](const Vec3& pos) {
-					submesh.m_aabbMin = submesh.m_aabbMin.min(pos);
-					submesh.m_aabbMax = submesh.m_aabbMax.max(pos);
-					submesh.m_verts[count++].m_position = pos;
-
-					allPositions.emplaceBack(pos);
-				});
+				nextStageFunc();
 			}
-			else if(attrib->type == cgltf_attribute_type_normal)
+		};
+
+		// This may run in a worker and the workers can't wait for the queue to drain. Run it in place if the queue is full
+		if(!m_jobManager->tryDispatchTask(task))
+		{
+			task(0);
+		}
+	}
+}
+
+Error GltfImporter::writeMesh(const cgltf_mesh& mesh) const
+{
+	MeshImportContext& ctx = *newInstance<MeshImportContext>(ImporterMemoryPool::getSingleton());
+	ctx.m_mesh = &mesh;
+
+	const ImporterString meshName = computeMeshResourceFilename(mesh);
+	ctx.m_filename.sprintf("%s%s", m_outDir.cstr(), meshName.cstr());
+	ctx.m_bakeCollisionBvh = isCollisionMesh(mesh);
+	ANKI_IMPORTER_LOGV("Importing mesh (%s): %s", (m_optimizeMeshes) ? "optimize" : "WON'T optimize", ctx.m_filename.cstr());
+
+	const U32 submeshCount = U32(mesh.primitives_count);
+	ctx.m_submeshes[0].resize(submeshCount);
+	ctx.m_firstPositions.resize(submeshCount);
+	U32 positionCount = 0;
+	for(U32 i = 0; i < submeshCount; ++i)
+	{
+		ctx.m_firstPositions[i] = positionCount;
+		positionCount += U32(mesh.primitives[i].attributes[0].data->count);
+	}
+	ctx.m_allPositions.resize(positionCount);
+
+	dispatchMeshStage(
+		ctx, submeshCount,
+		[this, &ctx](U32 submeshIdx) {
+			return loadSubmesh(ctx, submeshIdx);
+		},
+		[this, &ctx]() {
+			decimateMesh(ctx);
+		});
+
+	// Without a job manager everything has finished
+	return (m_jobManager) ? Error::kNone : Error(m_errorInThread.load());
+}
+
+Error GltfImporter::loadSubmesh(MeshImportContext& ctx, U32 submeshIdx) const
+{
+	const Second loadBegin = HighRezTimer::getCurrentTime();
+
+	const cgltf_primitive* primitive = &ctx.m_mesh->primitives[submeshIdx];
+	if(primitive->type != cgltf_primitive_type_triangles)
+	{
+		ANKI_IMPORTER_LOGE("Expecting triangles got %d", primitive->type);
+		return Error::kUserData;
+	}
+
+	SubMesh& submesh = ctx.m_submeshes[0][submeshIdx];
+
+	// All attributes should have the same vertex count
+	U minVertCount = kMaxU;
+	U maxVertCount = kMinU;
+	for(const cgltf_attribute* attrib = primitive->attributes; attrib < primitive->attributes + primitive->attributes_count; ++attrib)
+	{
+		minVertCount = min(minVertCount, U(attrib->data->count));
+		maxVertCount = max(maxVertCount, U(attrib->data->count));
+	}
+
+	if(maxVertCount == 0 || minVertCount != maxVertCount)
+	{
+		ANKI_IMPORTER_LOGE("Wrong number of vertices");
+		return Error::kUserData;
+	}
+
+	const U32 vertCount = U32(primitive->attributes[0].data->count);
+	submesh.m_verts.resize(vertCount);
+
+	//
+	// Gather positions + normals + UVs + bone stuff
+	//
+	for(const cgltf_attribute* attrib = primitive->attributes; attrib < primitive->attributes + primitive->attributes_count; ++attrib)
+	{
+		if(attrib->type == cgltf_attribute_type_position)
+		{
+			U32 count = 0;
+			Vec3* allPositions = &ctx.m_allPositions[ctx.m_firstPositions[submeshIdx]];
+			ANKI_CHECK(checkAttribute<Vec3>(*attrib));
+			visitAccessor<Vec3>(*attrib->data, [&](const Vec3& pos) {
+				submesh.m_aabbMin = submesh.m_aabbMin.min(pos);
+				submesh.m_aabbMax = submesh.m_aabbMax.max(pos);
+				allPositions[count] = pos;
+				submesh.m_verts[count++].m_position = pos;
+			});
+		}
+		else if(attrib->type == cgltf_attribute_type_normal)
+		{
+			U32 count = 0;
+			ANKI_CHECK(checkAttribute<Vec3>(*attrib));
+			visitAccessor<Vec3>(*attrib->data, [&](const Vec3& normal) {
+				submesh.m_verts[count++].m_normal = normal;
+			});
+		}
+		else if(attrib->type == cgltf_attribute_type_texcoord && CString(attrib->name) == "TEXCOORD_0")
+		{
+			U32 count = 0;
+			ANKI_CHECK(checkAttribute<Vec2>(*attrib));
+			visitAccessor<Vec2>(*attrib->data, [&](const Vec2& uv) {
+				submesh.m_verts[count++].m_uv = uv;
+			});
+		}
+		else if(attrib->type == cgltf_attribute_type_joints)
+		{
+			U32 count = 0;
+			if(cgltfComponentSize(attrib->data->component_type) == 2)
 			{
-				U32 count = 0;
-				ANKI_CHECK(checkAttribute<Vec3>(*attrib));
-				visitAccessor<Vec3>(*attrib->data, [&](const Vec3& normal) {
-					submesh.m_verts[count++].m_normal = normal;
+				ANKI_CHECK(checkAttribute<U16Vec4>(*attrib));
+				visitAccessor<U16Vec4>(*attrib->data, [&](const U16Vec4& x) {
+					submesh.m_verts[count++].m_boneIds = x;
 				});
 			}
-			else if(attrib->type == cgltf_attribute_type_texcoord && CString(attrib->name) == "TEXCOORD_0")
+			else
 			{
-				U32 count = 0;
-				ANKI_CHECK(checkAttribute<Vec2>(*attrib));
-				visitAccessor<Vec2>(*attrib->data, [&](const Vec2& uv) {
-					submesh.m_verts[count++].m_uv = uv;
+				ANKI_CHECK(checkAttribute<U8Vec4>(*attrib));
+				visitAccessor<U8Vec4>(*attrib->data, [&](const U8Vec4& x) {
+					submesh.m_verts[count++].m_boneIds = U16Vec4(x);
 				});
 			}
-			else if(attrib->type == cgltf_attribute_type_joints)
+			submesh.m_hasBoneWeights = true;
+		}
+		else if(attrib->type == cgltf_attribute_type_weights)
+		{
+			U32 count = 0;
+			ANKI_CHECK(checkAttribute<Vec4>(*attrib));
+			visitAccessor<Vec4>(*attrib->data, [&](const Vec4& bw) {
+				submesh.m_verts[count++].m_boneWeights = bw;
+			});
+		}
+		else
+		{
+			ANKI_IMPORTER_LOGV("Ignoring attribute: %s", attrib->name);
+		}
+	}
+
+	submesh.m_aabbMax += kEpsilonf * 10.0f; // Bump aabbMax a bit
+
+	const Sphere s = computeBoundingSphere(&submesh.m_verts[0].m_position, submesh.m_verts.getSize(), sizeof(submesh.m_verts[0]));
+	submesh.m_sphereCenter = s.getCenter().xyz();
+	submesh.m_sphereRadius = max(kEpsilonf * 10.0f, s.getRadius());
+
+	// Fix normals
+	fixNormals(m_normalsMergeAngle, submesh);
+
+	//
+	// Load indices
+	//
+	{
+		ANKI_ASSERT(primitive->indices);
+		if(primitive->indices->count == 0 || (primitive->indices->count % 3) != 0)
+		{
+			ANKI_IMPORTER_LOGE("Incorect index count: %lu", primitive->indices->count);
+			return Error::kUserData;
+		}
+		submesh.m_indices.resize(U32(primitive->indices->count));
+		const U8* base = static_cast<const U8*>(primitive->indices->buffer_view->buffer->data) + primitive->indices->offset
+						 + primitive->indices->buffer_view->offset;
+		for(U32 i = 0; i < primitive->indices->count; ++i)
+		{
+			U32 idx;
+			if(primitive->indices->component_type == cgltf_component_type_r_32u)
 			{
-				U32 count = 0;
-				if(cgltfComponentSize(attrib->data->component_type) == 2)
-				{
-					ANKI_CHECK(checkAttribute<U16Vec4>(*attrib));
-					visitAccessor<U16Vec4>(*attrib->data, [&](const U16Vec4& x) {
-						submesh.m_verts[count++].m_boneIds = x;
-					});
-				}
-				else
-				{
-					ANKI_CHECK(checkAttribute<U8Vec4>(*attrib));
-					visitAccessor<U8Vec4>(*attrib->data, [&](const U8Vec4& x) {
-						submesh.m_verts[count++].m_boneIds = U16Vec4(x);
-					});
-				}
-				hasBoneWeights = true;
+				idx = *reinterpret_cast<const U32*>(base + sizeof(U32) * i);
 			}
-			else if(attrib->type == cgltf_attribute_type_weights)
+			else if(primitive->indices->component_type == cgltf_component_type_r_16u)
 			{
-				U32 count = 0;
-				ANKI_CHECK(checkAttribute<Vec4>(*attrib));
-				visitAccessor<Vec4>(*attrib->data, [&](const Vec4& bw) {
-					submesh.m_verts[count++].m_boneWeights = bw;
-				});
+				idx = *reinterpret_cast<const U16*>(base + sizeof(U16) * i);
 			}
 			else
 			{
-				ANKI_IMPORTER_LOGV("Ignoring attribute: %s", attrib->name);
+				ANKI_ASSERT(0);
+				idx = 0;
 			}
+
+			submesh.m_indices[i] = idx;
 		}
+	}
 
-		aabbMin = aabbMin.min(submesh.m_aabbMin);
-		submesh.m_aabbMax += kEpsilonf * 10.0f; // Bump aabbMax a bit
-		aabbMax = aabbMax.max(submesh.m_aabbMax);
+	const Second optimizeBegin = HighRezTimer::getCurrentTime();
+	addStageTime(GltfImporterStage::kMeshLoad, optimizeBegin - loadBegin);
 
-		const Sphere s = computeBoundingSphere(&submesh.m_verts[0].m_position, submesh.m_verts.getSize(), sizeof(submesh.m_verts[0]));
-		submesh.m_sphereCenter = s.getCenter().xyz();
-		submesh.m_sphereRadius = max(kEpsilonf * 10.0f, s.getRadius());
+	// Re-index and optimize
+	if(m_optimizeMeshes)
+	{
+		reindexSubmesh(submesh);
+		optimizeSubmesh(submesh);
+	}
 
-		// Fix normals
-		fixNormals(m_normalsMergeAngle, submesh);
+	addStageTime(GltfImporterStage::kMeshOptimize, HighRezTimer::getCurrentTime() - optimizeBegin);
 
-		//
-		// Load indices
-		//
-		{
-			ANKI_ASSERT(primitive->indices);
-			if(primitive->indices->count == 0 || (primitive->indices->count % 3) != 0)
-			{
-				ANKI_IMPORTER_LOGE("Incorect index count: %lu", primitive->indices->count);
-				return Error::kUserData;
-			}
-			submesh.m_indices.resize(U32(primitive->indices->count));
-			const U8* base = static_cast<const U8*>(primitive->indices->buffer_view->buffer->data) + primitive->indices->offset
-							 + primitive->indices->buffer_view->offset;
-			for(U32 i = 0; i < primitive->indices->count; ++i)
-			{
-				U32 idx;
-				if(primitive->indices->component_type == cgltf_component_type_r_32u)
-				{
-					idx = *reinterpret_cast<const U32*>(base + sizeof(U32) * i);
-				}
-				else if(primitive->indices->component_type == cgltf_component_type_r_16u)
-				{
-					idx = *reinterpret_cast<const U16*>(base + sizeof(U16) * i);
-				}
-				else
-				{
-					ANKI_ASSERT(0);
-					idx = 0;
-				}
+	// Finalize
+	if(submesh.m_indices.getSize() == 0 || submesh.m_verts.getSize() == 0)
+	{
+		ANKI_IMPORTER_LOGE("Mesh degenerate: %s", ctx.m_filename.cstr());
+		return Error::kUserData;
+	}
 
-				submesh.m_indices[i] = idx;
-			}
-		}
+	return Error::kNone;
+}
 
-		// Re-index meshes now
-		if(m_optimizeMeshes)
-		{
-			reindexSubmesh(submesh);
-			vertCount = submesh.m_verts.getSize();
-		}
+void GltfImporter::decimateMesh(MeshImportContext& ctx) const
+{
+	if(ctx.m_error.load())
+	{
+		finalizeMesh(ctx);
+		return;
+	}
 
-		// Optimize
-		if(m_optimizeMeshes)
+	// Find the LOD count
+	ANKI_ASSERT(m_lodCount <= kMaxLodCount && m_lodCount > 0);
+	ctx.m_lodCount = 1;
+	for(U32 lod = 1; lod < m_lodCount; ++lod)
+	{
+		if(skipMeshLod(*ctx.m_mesh, lod))
 		{
-			optimizeSubmesh(submesh);
+			break;
 		}
 
-		// Finalize
-		if(submesh.m_indices.getSize() == 0 || submesh.m_verts.getSize() == 0)
-		{
-			ANKI_UTIL_LOGE("Mesh degenerate: %s", meshName.cstr());
-			return Error::kUserData;
-		}
-	} // for all GLTF primitives
+		ctx.m_submeshes[lod].resize(ctx.m_submeshes[0].getSize());
+		ctx.m_lodCount = lod + 1;
+	}
 
-	// Generate submeshes for the other LODs
-	ANKI_ASSERT(m_lodCount <= kMaxLodCount && m_lodCount > 0);
-	U32 maxLod = 0;
-	for(U32 lod = 1; lod < m_lodCount; ++lod)
+	ANKI_IMPORTER_LOGV("Mesh lod count: %s %u", ctx.m_filename.cstr(), ctx.m_lodCount);
+
+	if(ctx.m_lodCount == 1)
 	{
-		if(skipMeshLod(mesh, lod))
+		meshletizeMesh(ctx);
+		return;
+	}
+
+	// Generate submeshes for the other LODs from LOD0
+	const U32 submeshCount = ctx.m_submeshes[0].getSize();
+	dispatchMeshStage(
+		ctx, submeshCount * (ctx.m_lodCount - 1),
+		[this, &ctx, submeshCount](U32 taskIdx) {
+			const Second begin = HighRezTimer::getCurrentTime();
+
+			const U32 lod = taskIdx / submeshCount + 1;
+			const U32 submeshIdx = taskIdx % submeshCount;
+			decimateSubmesh(computeLodFactor(lod), ctx.m_submeshes[0][submeshIdx], ctx.m_submeshes[lod][submeshIdx]);
+
+			addStageTime(GltfImporterStage::kMeshDecimate, HighRezTimer::getCurrentTime() - begin);
+			return Error::kNone;
+		},
+		[this, &ctx]() {
+			meshletizeMesh(ctx);
+		});
+}
+
+void GltfImporter::meshletizeMesh(MeshImportContext& ctx) const
+{
+	if(ctx.m_error.load())
+	{
+		finalizeMesh(ctx);
+		return;
+	}
+
+	// Split the submeshes into chunks of triangles
+	for(U32 lod = 0; lod < ctx.m_lodCount; ++lod)
+	{
+		for(U32 submeshIdx = 0; submeshIdx < ctx.m_submeshes[lod].getSize(); ++submeshIdx)
 		{
-			break;
+			const U32 indexCount = ctx.m_submeshes[lod][submeshIdx].m_indices.getSize();
+			for(U32 firstIndex = 0; firstIndex < indexCount; firstIndex += kMeshletChunkTriangleCount * 3)
+			{
+				MeshletChunk& chunk = *ctx.m_meshletChunks.emplaceBack();
+				chunk.m_lod = lod;
+				chunk.m_submeshIdx = submeshIdx;
+				chunk.m_firstIndex = firstIndex;
+				chunk.m_indexCount = min(indexCount - firstIndex, kMeshletChunkTriangleCount * 3);
+			}
 		}
+	}
+
+	dispatchMeshStage(
+		ctx, ctx.m_meshletChunks.getSize(),
+		[this, &ctx](U32 chunkIdx) {
+			const Second begin = HighRezTimer::getCurrentTime();
+
+			MeshletChunk& chunk = ctx.m_meshletChunks[chunkIdx];
+			generateMeshlets(ctx.m_submeshes[chunk.m_lod][chunk.m_submeshIdx], chunk);
 
-		for(const SubMesh& lod0Submesh : submeshes[0])
+			addStageTime(GltfImporterStage::kMeshMeshletize, HighRezTimer::getCurrentTime() - begin);
+			return Error::kNone;
+		},
+		[this, &ctx]() {
+			finalizeMesh(ctx);
+		});
+}
+
+void GltfImporter::finalizeMesh(MeshImportContext& ctx) const
+{
+	Error err = ctx.m_error.load();
+
+	if(!err)
+	{
+		// The chunks of a submesh are next to each other so merge the runs of them
+		const Second begin = HighRezTimer::getCurrentTime();
+
+		U32 firstChunk = 0;
+		while(firstChunk < ctx.m_meshletChunks.getSize())
 		{
-			SubMesh& newSubmesh = *submeshes[lod].emplaceBack();
-			newSubmesh = lod0Submesh; // Copy LOD0 data to new submesh
+			const MeshletChunk& first = ctx.m_meshletChunks[firstChunk];
+			U32 chunkCount = 1;
+			while(firstChunk + chunkCount < ctx.m_meshletChunks.getSize() && ctx.m_meshletChunks[firstChunk + chunkCount].m_lod == first.m_lod
+				  && ctx.m_meshletChunks[firstChunk + chunkCount].m_submeshIdx == first.m_submeshIdx)
+			{
+				++chunkCount;
+			}
 
-			decimateSubmesh(computeLodFactor(lod), newSubmesh);
+			mergeMeshletChunks(WeakArray<MeshletChunk>(&ctx.m_meshletChunks[firstChunk], chunkCount),
+							   ctx.m_submeshes[first.m_lod][first.m_submeshIdx]);
+			firstChunk += chunkCount;
 		}
 
-		maxLod = lod;
+		ctx.m_meshletChunks.destroy();
+
+		const Second writeBegin = HighRezTimer::getCurrentTime();
+		addStageTime(GltfImporterStage::kMeshMeshletize, writeBegin - begin);
+
+		err = writeMeshFile(ctx);
+
+		addStageTime(GltfImporterStage::kMeshWrite, HighRezTimer::getCurrentTime() - writeBegin);
+	}
+
+	if(err)
+	{
+		ANKI_IMPORTER_LOGE("Failed to write mesh: %s", ctx.m_mesh->name);
+		m_errorInThread.store(err._getCode());
 	}
 
-	ANKI_IMPORTER_LOGV("Mesh lod count: %s %u", fname.cstr(), maxLod + 1);
+	deleteInstance(ImporterMemoryPool::getSingleton(), &ctx);
+}
 
-	// Meshletize
-	for(U32 lod = 0; lod < m_lodCount; ++lod)
+Error GltfImporter::writeMeshFile(const MeshImportContext& ctx) const
+{
+	const auto& submeshes = ctx.m_submeshes;
+	const U32 maxLod = ctx.m_lodCount - 1;
+	const ImporterString& fname = ctx.m_filename;
+	const ImporterDynamicArray<Vec3>& allPositions = ctx.m_allPositions;
+
+	Vec3 aabbMin(kMaxF32);
+	Vec3 aabbMax(kMinF32);
+	Bool hasBoneWeights = false;
+	for(const SubMesh& submesh : submeshes[0])
 	{
-		for(SubMesh& submesh : submeshes[lod])
-		{
-			generateMeshlets(submesh);
-		}
+		aabbMin = aabbMin.min(submesh.m_aabbMin);
+		aabbMax = aabbMax.max(submesh.m_aabbMax);
+		hasBoneWeights = hasBoneWeights || submesh.m_hasBoneWeights;
 	}
 
 	// Start writing the file
@@ -935,6 +1278,63 @@ Error GltfImporter::writeMeshInternal(const cgltf_mesh& mesh) const
 		}
 	}
 
+	if(ctx.m_bakeCollisionBvh && !(header.m_flags & MeshBinaryFlag::kConvex))
+	{
+		ANKI_CHECK(writeCollisionBvhFile(ctx, header.m_vertexAttributes[VertexStreamId::kPosition], posScale, posTranslation));
+	}
+
+	return Error::kNone;
+}
+
+Error GltfImporter::writeCollisionBvhFile(const MeshImportContext& ctx, const MeshBinaryVertexAttribute& posAttrib, F32 posScale,
+										  const Vec3& posTranslation) const
+{
+	// The BVH should be built from the exact same positions CpuMeshResource will get. Quantize them and then de-quantize them the same way
+	// MeshBinaryLoader does
+	ImporterDynamicArray<Vec3> positions;
+	ImporterDynamicArray<U32> indices;
+	for(const SubMesh& submesh : ctx.m_submeshes[0])
+	{
+		const U32 firstVertex = positions.getSize();
+
+		for(const TempVertex& vert : submesh.m_verts)
+		{
+			Vec3 localPos = (vert.m_position + posTranslation) * posScale;
+			localPos = localPos.clamp(0.0f, 1.0f);
+			localPos *= F32(kMaxU16);
+			localPos = localPos.round();
+			const U16Vec4 quantized(localPos.xyz0());
+
+			Vec3 pos = Vec3(quantized.xyz()) / F32(kMaxU16);
+			pos *= Vec3(&posAttrib.m_scale[0]);
+			pos += Vec3(&posAttrib.m_translation[0]);
+			positions.emplaceBack(pos);
+		}
+
+		for(U32 idx : submesh.m_indices)
+		{
+			indices.emplaceBack(idx + firstVertex);
+		}
+	}
+
+	DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>> bvh(&ImporterMemoryPool::getSingleton());
+	PhysicsTriangleSoup::bakeBvh(positions, indices, bvh);
+
+	MeshBinaryCollisionHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(&header.m_magic[0], kMeshCollisionMagic, 8);
+	header.m_meshHash = CpuMeshResource::computeBakedBvhMeshHash(positions, indices);
+	header.m_bvhSize = bvh.getSize();
+
+	ImporterString fname = ctx.m_filename;
+	fname.replaceAll(".ankimesh", ".ankibvh");
+	ANKI_IMPORTER_LOGV("Baking collision BVH: %s", fname.cstr());
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+	ANKI_CHECK(file.write(&bvh[0], bvh.getSizeInBytes()));
+
 	return Error::kNone;
 }
 
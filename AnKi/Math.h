@@ -11,6 +11,8 @@
 #include <AnKi/Math/Euler.h>
 #include <AnKi/Math/Axisang.h>
 #include <AnKi/Math/Transform.h>
+#include <AnKi/Math/SimdPacket.h>
+#include <AnKi/Math/BatchFunctions.h>
 
 #include <AnKi/Math/Functions.h>
 
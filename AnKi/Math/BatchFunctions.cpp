@@ -0,0 +1,155 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Math/BatchFunctions.h>
+#include <AnKi/Math/SimdPacket.h>
+
+namespace anki {
+
+// Without AVX the F32x8 is a pair of SSE/NEON registers and the wider kernels run out of registers
+#if ANKI_SIMD_AVX2
+using BatchPacket = F32x8;
+#else
+using BatchPacket = F32x4;
+#endif
+constexpr U32 kBatchLaneCount = BatchPacket::kLaneCount;
+
+using BatchVec3 = TVec3Packet<BatchPacket>;
+using BatchQuat = TQuatPacket<BatchPacket>;
+using BatchMat3x4 = TMat3x4Packet<BatchPacket>;
+using BatchTransform = TTransformPacket<BatchPacket>;
+
+/// acos for values in [0, 1]. Abramowitz and Stegun 4.4.46, the error is less than 2e-8.
+static BatchPacket acosPositive(const BatchPacket& x)
+{
+	BatchPacket p = BatchPacket(-0.0012624911f);
+	p = p * x + BatchPacket(0.0066700901f);
+	p = p * x + BatchPacket(-0.0170881256f);
+	p = p * x + BatchPacket(0.0308918810f);
+	p = p * x + BatchPacket(-0.0501743046f);
+	p = p * x + BatchPacket(0.0889789874f);
+	p = p * x + BatchPacket(-0.2145988016f);
+	p = p * x + BatchPacket(1.5707963050f);
+	return (BatchPacket(1.0f) - x).sqrt() * p;
+}
+
+/// sin for values in [0, PI/2]. Taylor series up to the 11th power, the error is less than 6e-8.
+static BatchPacket sinFirstQuadrant(const BatchPacket& x)
+{
+	const BatchPacket x2 = x * x;
+	BatchPacket p = BatchPacket(-1.0f / 39916800.0f);
+	p = p * x2 + BatchPacket(1.0f / 362880.0f);
+	p = p * x2 + BatchPacket(-1.0f / 5040.0f);
+	p = p * x2 + BatchPacket(1.0f / 120.0f);
+	p = p * x2 + BatchPacket(-1.0f / 6.0f);
+	p = p * x2 + BatchPacket(1.0f);
+	return p * x;
+}
+
+void batchInvertTransformations(ConstWeakArray<Transform> in, WeakArray<Transform> out)
+{
+	ANKI_ASSERT(in.getSize() == out.getSize());
+	const U32 count = out.getSize();
+
+	U32 i = 0;
+	for(; i + kBatchLaneCount <= count; i += kBatchLaneCount)
+	{
+		BatchTransform::load(&in[i]).getInverse().store(&out[i]);
+	}
+
+	for(; i < count; ++i)
+	{
+		out[i] = in[i].getInverse();
+	}
+}
+
+void batchSlerp(ConstWeakArray<Quat> q0s, ConstWeakArray<Quat> q1s, ConstWeakArray<F32> ts, WeakArray<Quat> out)
+{
+	ANKI_ASSERT(q0s.getSize() == q1s.getSize() && q0s.getSize() == ts.getSize() && q0s.getSize() == out.getSize());
+	const U32 count = out.getSize();
+
+	U32 i = 0;
+	for(; i + kBatchLaneCount <= count; i += kBatchLaneCount)
+	{
+		const BatchQuat q0 = BatchQuat::load(&q0s[i]);
+		BatchQuat q1 = BatchQuat::load(&q1s[i]);
+		const BatchPacket t = BatchPacket::load(&ts[i]);
+
+		// Take the shortest path
+		BatchPacket cosHalfTheta = q0.dot(q1);
+		const BatchPacket sign = BatchPacket::select(cosHalfTheta < BatchPacket(0.0f), BatchPacket(-1.0f), BatchPacket(1.0f));
+		q1 = q1 * sign;
+		cosHalfTheta = cosHalfTheta.abs();
+
+		// The lanes that don't need interpolation will produce garbage that is thrown away
+		const BatchPacket one(1.0f);
+		const BatchPacket halfTheta = acosPositive(cosHalfTheta.min(one));
+		const BatchPacket sinHalfTheta = (one - cosHalfTheta * cosHalfTheta).max(BatchPacket(0.0f)).sqrt();
+		const BatchPacket invSinHalfTheta = one / sinHalfTheta;
+		const BatchPacket ratioA = sinFirstQuadrant((one - t) * halfTheta) * invSinHalfTheta;
+		const BatchPacket ratioB = sinFirstQuadrant(t * halfTheta) * invSinHalfTheta;
+
+		BatchQuat result = (q0 * ratioA + q1 * ratioB).getNormalized();
+		result = BatchQuat::select(sinHalfTheta < BatchPacket(0.001f), (q0 + q1) * BatchPacket(0.5f), result);
+		result = BatchQuat::select(cosHalfTheta >= one, q0, result);
+		result.store(&out[i]);
+	}
+
+	for(; i < count; ++i)
+	{
+		out[i] = q0s[i].slerp(q1s[i], ts[i]);
+	}
+}
+
+void batchTransformAabbs(ConstWeakArray<Transform> trfs, ConstWeakArray<Vec4> mins, ConstWeakArray<Vec4> maxs, WeakArray<Vec4> outMins,
+						 WeakArray<Vec4> outMaxs)
+{
+	ANKI_ASSERT(trfs.getSize() == mins.getSize() && trfs.getSize() == maxs.getSize() && trfs.getSize() == outMins.getSize()
+				&& trfs.getSize() == outMaxs.getSize());
+	const U32 count = trfs.getSize();
+
+	U32 i = 0;
+	for(; i + kBatchLaneCount <= count; i += kBatchLaneCount)
+	{
+		const BatchTransform trf = BatchTransform::load(&trfs[i]);
+		const BatchVec3 aabbMin = BatchVec3::loadVec4s(&mins[i]);
+		const BatchVec3 aabbMax = BatchVec3::loadVec4s(&maxs[i]);
+
+		const BatchPacket half(0.5f);
+		const BatchVec3 center = (aabbMin + aabbMax) * half;
+		const BatchVec3 extend = (aabbMax - aabbMin) * half;
+
+		BatchMat3x4 absRotation;
+		for(U32 j = 0; j < 12; ++j)
+		{
+			absRotation.m_m[j] = trf.m_rotation.m_m[j].abs();
+		}
+
+		const BatchVec3 newCenter = trf.m_rotation.transformDirections(center * trf.m_scale) + trf.m_origin;
+		const BatchVec3 newExtend = absRotation.transformDirections(extend * trf.m_scale);
+
+		(newCenter - newExtend).storeVec4s(&outMins[i], 0.0f);
+		(newCenter + newExtend).storeVec4s(&outMaxs[i], 0.0f);
+	}
+
+	for(; i < count; ++i)
+	{
+		const Transform& trf = trfs[i];
+		Mat3x4 absRotation;
+		for(U32 j = 0; j < 12; ++j)
+		{
+			absRotation[j] = absolute(trf.getRotation()[j]);
+		}
+
+		const Vec4 center = (mins[i] + maxs[i]) * 0.5f;
+		const Vec4 extend = (maxs[i] - mins[i]) * 0.5f;
+		const Vec4 newCenter = trf.transform(center);
+		const Vec4 newExtend = Vec4(absRotation * (extend * trf.getScale()), 0.0f);
+		outMins[i] = newCenter - newExtend;
+		outMaxs[i] = newCenter + newExtend;
+	}
+}
+
+} // end namespace anki
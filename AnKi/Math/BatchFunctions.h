@@ -0,0 +1,34 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Math/Mat.h>
+#include <AnKi/Math/Quat.h>
+#include <AnKi/Math/Transform.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup math
+/// @{
+
+/// @note There are no batched multiplications of Mat3x4 and Transform arrays. The rows of Mat3x4 are already SIMD registers so the transposes to
+/// SoA cost more than what they save. Use TMat3x4Packet and TTransformPacket when the data is already in SoA.
+
+/// Invert an array of transformations. The same as out[i] = in[i].getInverse(). The output can be the input.
+void batchInvertTransformations(ConstWeakArray<Transform> in, WeakArray<Transform> out);
+
+/// Interpolate arrays of quaternions. The same as out[i] = q0[i].slerp(q1[i], t[i]) but a bit more accurate since Quat::slerp() normalizes using an
+/// approximate reciprocal square root. The output can be one of the inputs.
+void batchSlerp(ConstWeakArray<Quat> q0, ConstWeakArray<Quat> q1, ConstWeakArray<F32> t, WeakArray<Quat> out);
+
+/// Transform an array of AABBs given as min and max points. The same as Aabb::getTransformed() minus the epsilon it adds. The output can be the
+/// input.
+void batchTransformAabbs(ConstWeakArray<Transform> trfs, ConstWeakArray<Vec4> mins, ConstWeakArray<Vec4> maxs, WeakArray<Vec4> outMins,
+						 WeakArray<Vec4> outMaxs);
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,924 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Math/Mat.h>
+#include <AnKi/Math/Quat.h>
+#include <AnKi/Math/Transform.h>
+#if ANKI_SIMD_AVX2
+#	include <immintrin.h>
+#endif
+
+namespace anki {
+
+/// @addtogroup math
+/// @{
+
+/// 4 F32 lanes. It's the building block of the structure of arrays (SoA) math. The comparison operators return masks where a lane has all its bits
+/// set if the comparison is true.
+class F32x4
+{
+public:
+	static constexpr U32 kLaneCount = 4;
+
+	F32x4() = default;
+
+	explicit F32x4(F32 f)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_set1_ps(f);
+#elif ANKI_SIMD_NEON
+		m_simd = vdupq_n_f32(f);
+#else
+		m_simd = {f, f, f, f};
+#endif
+	}
+
+	/// Unaligned load.
+	static F32x4 load(const F32* ptr)
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_loadu_ps(ptr);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vld1q_f32(ptr);
+#else
+		memcpy(&out.m_simd[0], ptr, sizeof(out.m_simd));
+#endif
+		return out;
+	}
+
+	/// Unaligned store.
+	void store(F32* ptr) const
+	{
+#if ANKI_SIMD_SSE
+		_mm_storeu_ps(ptr, m_simd);
+#elif ANKI_SIMD_NEON
+		vst1q_f32(ptr, m_simd);
+#else
+		memcpy(ptr, &m_simd[0], sizeof(m_simd));
+#endif
+	}
+
+	/// Load 4 consecutive floats from kLaneCount addresses and transpose them. out[i] has the i-th float of every address.
+	static void loadTransposed(const F32* const* ptrs, Array<F32x4, 4>& out)
+	{
+		for(U32 i = 0; i < 4; ++i)
+		{
+			out[i] = load(ptrs[i]);
+		}
+
+		transpose(out);
+	}
+
+	/// The opposite of loadTransposed.
+	static void storeTransposed(const Array<F32x4, 4>& in, F32* const* ptrs)
+	{
+		Array<F32x4, 4> tmp = in;
+		transpose(tmp);
+		for(U32 i = 0; i < 4; ++i)
+		{
+			tmp[i].store(ptrs[i]);
+		}
+	}
+
+	/// Transpose a 4x4 matrix whose rows are the 4 packets.
+	static void transpose(Array<F32x4, 4>& m)
+	{
+#if ANKI_SIMD_SSE
+		_MM_TRANSPOSE4_PS(m[0].m_simd, m[1].m_simd, m[2].m_simd, m[3].m_simd);
+#elif ANKI_SIMD_NEON
+		const float32x4x2_t t01 = vtrnq_f32(m[0].m_simd, m[1].m_simd);
+		const float32x4x2_t t23 = vtrnq_f32(m[2].m_simd, m[3].m_simd);
+		m[0].m_simd = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+		m[1].m_simd = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+		m[2].m_simd = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+		m[3].m_simd = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+		for(U32 i = 0; i < 4; ++i)
+		{
+			for(U32 j = i + 1; j < 4; ++j)
+			{
+				std::swap(m[i].m_simd[j], m[j].m_simd[i]);
+			}
+		}
+#endif
+	}
+
+	F32 operator[](U32 i) const
+	{
+		ANKI_ASSERT(i < kLaneCount);
+		alignas(16) F32 lanes[kLaneCount];
+		store(lanes);
+		return lanes[i];
+	}
+
+	/// Get a bitmask with one bit per lane. The bit is the sign bit of the lane so it's meant for masks.
+	U32 getMask() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_ps(m_simd));
+#elif ANKI_SIMD_NEON
+		const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_f32(m_simd), 31);
+		const int32x4_t shifts = {0, 1, 2, 3};
+		return vaddvq_u32(vshlq_u32(signs, shifts));
+#else
+		U32 out = 0;
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out |= U32(std::signbit(m_simd[i])) << i;
+		}
+		return out;
+#endif
+	}
+
+#define ANKI_F32X4_BINARY_OP(op, sse, neon) \
+	F32x4 operator op(const F32x4& b) const \
+	{ \
+		F32x4 out; \
+		ANKI_F32X4_BINARY_OP_IMPL(sse, neon, op) \
+		return out; \
+	} \
+	F32x4& operator op##=(const F32x4& b) \
+	{ \
+		*this = *this op b; \
+		return *this; \
+	}
+
+#if ANKI_SIMD_SSE
+#	define ANKI_F32X4_BINARY_OP_IMPL(sse, neon, op) out.m_simd = sse(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+#	define ANKI_F32X4_BINARY_OP_IMPL(sse, neon, op) out.m_simd = neon(m_simd, b.m_simd);
+#else
+#	define ANKI_F32X4_BINARY_OP_IMPL(sse, neon, op) \
+		for(U32 i = 0; i < kLaneCount; ++i) \
+		{ \
+			out.m_simd[i] = m_simd[i] op b.m_simd[i]; \
+		}
+#endif
+
+	ANKI_F32X4_BINARY_OP(+, _mm_add_ps, vaddq_f32)
+	ANKI_F32X4_BINARY_OP(-, _mm_sub_ps, vsubq_f32)
+	ANKI_F32X4_BINARY_OP(*, _mm_mul_ps, vmulq_f32)
+	ANKI_F32X4_BINARY_OP(/, _mm_div_ps, vdivq_f32)
+
+#undef ANKI_F32X4_BINARY_OP
+#undef ANKI_F32X4_BINARY_OP_IMPL
+
+	F32x4 operator-() const
+	{
+		return F32x4(0.0f) - *this;
+	}
+
+#define ANKI_F32X4_COMPARE_OP(op, sse, neon) \
+	F32x4 operator op(const F32x4& b) const \
+	{ \
+		F32x4 out; \
+		ANKI_F32X4_COMPARE_OP_IMPL(sse, neon, op) \
+		return out; \
+	}
+
+#if ANKI_SIMD_SSE
+#	define ANKI_F32X4_COMPARE_OP_IMPL(sse, neon, op) out.m_simd = sse(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+#	define ANKI_F32X4_COMPARE_OP_IMPL(sse, neon, op) out.m_simd = vreinterpretq_f32_u32(neon(m_simd, b.m_simd));
+#else
+#	define ANKI_F32X4_COMPARE_OP_IMPL(sse, neon, op) \
+		for(U32 i = 0; i < kLaneCount; ++i) \
+		{ \
+			out.m_simd[i] = maskFromBool(m_simd[i] op b.m_simd[i]); \
+		}
+#endif
+
+	ANKI_F32X4_COMPARE_OP(<, _mm_cmplt_ps, vcltq_f32)
+	ANKI_F32X4_COMPARE_OP(<=, _mm_cmple_ps, vcleq_f32)
+	ANKI_F32X4_COMPARE_OP(>, _mm_cmpgt_ps, vcgtq_f32)
+	ANKI_F32X4_COMPARE_OP(>=, _mm_cmpge_ps, vcgeq_f32)
+
+#undef ANKI_F32X4_COMPARE_OP
+#undef ANKI_F32X4_COMPARE_OP_IMPL
+
+	/// Bitwise AND. Meant for masks.
+	F32x4 operator&(const F32x4& b) const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_and_ps(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(m_simd), vreinterpretq_u32_f32(b.m_simd)));
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = bitCast(bitCast(m_simd[i]) & bitCast(b.m_simd[i]));
+		}
+#endif
+		return out;
+	}
+
+	/// Bitwise OR. Meant for masks.
+	F32x4 operator|(const F32x4& b) const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_or_ps(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(m_simd), vreinterpretq_u32_f32(b.m_simd)));
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = bitCast(bitCast(m_simd[i]) | bitCast(b.m_simd[i]));
+		}
+#endif
+		return out;
+	}
+
+	/// Pick a's lanes where the mask is set and b's where it isn't.
+	static F32x4 select(const F32x4& mask, const F32x4& a, const F32x4& b)
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_blendv_ps(b.m_simd, a.m_simd, mask.m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vbslq_f32(vreinterpretq_u32_f32(mask.m_simd), a.m_simd, b.m_simd);
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = bitCast(mask.m_simd[i]) ? a.m_simd[i] : b.m_simd[i];
+		}
+#endif
+		return out;
+	}
+
+	F32x4 min(const F32x4& b) const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_min_ps(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vminq_f32(m_simd, b.m_simd);
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = (m_simd[i] < b.m_simd[i]) ? m_simd[i] : b.m_simd[i];
+		}
+#endif
+		return out;
+	}
+
+	F32x4 max(const F32x4& b) const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_max_ps(m_simd, b.m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vmaxq_f32(m_simd, b.m_simd);
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = (m_simd[i] > b.m_simd[i]) ? m_simd[i] : b.m_simd[i];
+		}
+#endif
+		return out;
+	}
+
+	F32x4 abs() const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_andnot_ps(_mm_set1_ps(-0.0f), m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vabsq_f32(m_simd);
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = std::fabs(m_simd[i]);
+		}
+#endif
+		return out;
+	}
+
+	F32x4 sqrt() const
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_sqrt_ps(m_simd);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vsqrtq_f32(m_simd);
+#else
+		for(U32 i = 0; i < kLaneCount; ++i)
+		{
+			out.m_simd[i] = std::sqrt(m_simd[i]);
+		}
+#endif
+		return out;
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128 m_simd;
+#elif ANKI_SIMD_NEON
+	float32x4_t m_simd;
+#else
+	Array<F32, 4> m_simd;
+
+	static U32 bitCast(F32 f)
+	{
+		U32 u;
+		memcpy(&u, &f, sizeof(u));
+		return u;
+	}
+
+	static F32 bitCast(U32 u)
+	{
+		F32 f;
+		memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+
+	static F32 maskFromBool(Bool b)
+	{
+		return bitCast(b ? kMaxU32 : 0u);
+	}
+#endif
+
+	friend class F32x8;
+};
+
+/// 8 F32 lanes. It uses AVX if the compiler targets it (see ANKI_SIMD_AVX2), else it's a pair of F32x4. See F32x4.
+class F32x8
+{
+public:
+	static constexpr U32 kLaneCount = 8;
+
+	F32x8() = default;
+
+	explicit F32x8(F32 f)
+	{
+#if ANKI_SIMD_AVX2
+		m_simd = _mm256_set1_ps(f);
+#else
+		m_lo = m_hi = F32x4(f);
+#endif
+	}
+
+	F32x8(const F32x4& lo, const F32x4& hi)
+	{
+#if ANKI_SIMD_AVX2
+		m_simd = _mm256_set_m128(hi.m_simd, lo.m_simd);
+#else
+		m_lo = lo;
+		m_hi = hi;
+#endif
+	}
+
+	F32x4 getLow() const
+	{
+#if ANKI_SIMD_AVX2
+		F32x4 out;
+		out.m_simd = _mm256_castps256_ps128(m_simd);
+		return out;
+#else
+		return m_lo;
+#endif
+	}
+
+	F32x4 getHigh() const
+	{
+#if ANKI_SIMD_AVX2
+		F32x4 out;
+		out.m_simd = _mm256_extractf128_ps(m_simd, 1);
+		return out;
+#else
+		return m_hi;
+#endif
+	}
+
+	/// Unaligned load.
+	static F32x8 load(const F32* ptr)
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_loadu_ps(ptr);
+		return out;
+#else
+		return F32x8(F32x4::load(ptr), F32x4::load(ptr + 4));
+#endif
+	}
+
+	/// Unaligned store.
+	void store(F32* ptr) const
+	{
+#if ANKI_SIMD_AVX2
+		_mm256_storeu_ps(ptr, m_simd);
+#else
+		m_lo.store(ptr);
+		m_hi.store(ptr + 4);
+#endif
+	}
+
+	/// @copydoc F32x4::loadTransposed
+	static void loadTransposed(const F32* const* ptrs, Array<F32x8, 4>& out)
+	{
+		Array<F32x4, 4> lo, hi;
+		F32x4::loadTransposed(ptrs, lo);
+		F32x4::loadTransposed(ptrs + 4, hi);
+		for(U32 i = 0; i < 4; ++i)
+		{
+			out[i] = F32x8(lo[i], hi[i]);
+		}
+	}
+
+	/// @copydoc F32x4::storeTransposed
+	static void storeTransposed(const Array<F32x8, 4>& in, F32* const* ptrs)
+	{
+		Array<F32x4, 4> lo, hi;
+		for(U32 i = 0; i < 4; ++i)
+		{
+			lo[i] = in[i].getLow();
+			hi[i] = in[i].getHigh();
+		}
+		F32x4::storeTransposed(lo, ptrs);
+		F32x4::storeTransposed(hi, ptrs + 4);
+	}
+
+	F32 operator[](U32 i) const
+	{
+		ANKI_ASSERT(i < kLaneCount);
+		return (i < 4) ? getLow()[i] : getHigh()[i - 4];
+	}
+
+	/// @copydoc F32x4::getMask
+	U32 getMask() const
+	{
+#if ANKI_SIMD_AVX2
+		return U32(_mm256_movemask_ps(m_simd));
+#else
+		return m_lo.getMask() | (m_hi.getMask() << 4);
+#endif
+	}
+
+#if ANKI_SIMD_AVX2
+#	define ANKI_F32X8_BINARY_OP(op, avx) \
+		F32x8 operator op(const F32x8& b) const \
+		{ \
+			F32x8 out; \
+			out.m_simd = avx(m_simd, b.m_simd); \
+			return out; \
+		}
+#	define ANKI_F32X8_CMP_OP(op, avxPredicate) \
+		F32x8 operator op(const F32x8& b) const \
+		{ \
+			F32x8 out; \
+			out.m_simd = _mm256_cmp_ps(m_simd, b.m_simd, avxPredicate); \
+			return out; \
+		}
+#else
+#	define ANKI_F32X8_BINARY_OP(op, avx) \
+		F32x8 operator op(const F32x8& b) const \
+		{ \
+			return F32x8(m_lo op b.m_lo, m_hi op b.m_hi); \
+		}
+#	define ANKI_F32X8_CMP_OP(op, avxPredicate) ANKI_F32X8_BINARY_OP(op, _)
+#endif
+
+	ANKI_F32X8_BINARY_OP(+, _mm256_add_ps)
+	ANKI_F32X8_BINARY_OP(-, _mm256_sub_ps)
+	ANKI_F32X8_BINARY_OP(*, _mm256_mul_ps)
+	ANKI_F32X8_BINARY_OP(/, _mm256_div_ps)
+	ANKI_F32X8_BINARY_OP(&, _mm256_and_ps)
+	ANKI_F32X8_BINARY_OP(|, _mm256_or_ps)
+	ANKI_F32X8_CMP_OP(<, _CMP_LT_OQ)
+	ANKI_F32X8_CMP_OP(<=, _CMP_LE_OQ)
+	ANKI_F32X8_CMP_OP(>, _CMP_GT_OQ)
+	ANKI_F32X8_CMP_OP(>=, _CMP_GE_OQ)
+
+#undef ANKI_F32X8_BINARY_OP
+#undef ANKI_F32X8_CMP_OP
+
+	F32x8& operator+=(const F32x8& b)
+	{
+		*this = *this + b;
+		return *this;
+	}
+
+	F32x8& operator-=(const F32x8& b)
+	{
+		*this = *this - b;
+		return *this;
+	}
+
+	F32x8& operator*=(const F32x8& b)
+	{
+		*this = *this * b;
+		return *this;
+	}
+
+	F32x8& operator/=(const F32x8& b)
+	{
+		*this = *this / b;
+		return *this;
+	}
+
+	F32x8 operator-() const
+	{
+		return F32x8(0.0f) - *this;
+	}
+
+	/// @copydoc F32x4::select
+	static F32x8 select(const F32x8& mask, const F32x8& a, const F32x8& b)
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_blendv_ps(b.m_simd, a.m_simd, mask.m_simd);
+		return out;
+#else
+		return F32x8(F32x4::select(mask.m_lo, a.m_lo, b.m_lo), F32x4::select(mask.m_hi, a.m_hi, b.m_hi));
+#endif
+	}
+
+	F32x8 min(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_min_ps(m_simd, b.m_simd);
+		return out;
+#else
+		return F32x8(m_lo.min(b.m_lo), m_hi.min(b.m_hi));
+#endif
+	}
+
+	F32x8 max(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_max_ps(m_simd, b.m_simd);
+		return out;
+#else
+		return F32x8(m_lo.max(b.m_lo), m_hi.max(b.m_hi));
+#endif
+	}
+
+	F32x8 abs() const
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), m_simd);
+		return out;
+#else
+		return F32x8(m_lo.abs(), m_hi.abs());
+#endif
+	}
+
+	F32x8 sqrt() const
+	{
+#if ANKI_SIMD_AVX2
+		F32x8 out;
+		out.m_simd = _mm256_sqrt_ps(m_simd);
+		return out;
+#else
+		return F32x8(m_lo.sqrt(), m_hi.sqrt());
+#endif
+	}
+
+private:
+#if ANKI_SIMD_AVX2
+	__m256 m_simd;
+#else
+	F32x4 m_lo;
+	F32x4 m_hi;
+#endif
+};
+
+/// A packet of 3D vectors in SoA layout. TPacket is F32x4 or F32x8.
+template<typename TPacket>
+class TVec3Packet
+{
+public:
+	TPacket m_x;
+	TPacket m_y;
+	TPacket m_z;
+
+	TVec3Packet() = default;
+
+	TVec3Packet(const TPacket& x, const TPacket& y, const TPacket& z)
+		: m_x(x)
+		, m_y(y)
+		, m_z(z)
+	{
+	}
+
+	TVec3Packet operator+(const TVec3Packet& b) const
+	{
+		return TVec3Packet(m_x + b.m_x, m_y + b.m_y, m_z + b.m_z);
+	}
+
+	TVec3Packet operator-(const TVec3Packet& b) const
+	{
+		return TVec3Packet(m_x - b.m_x, m_y - b.m_y, m_z - b.m_z);
+	}
+
+	TVec3Packet operator*(const TVec3Packet& b) const
+	{
+		return TVec3Packet(m_x * b.m_x, m_y * b.m_y, m_z * b.m_z);
+	}
+
+	TVec3Packet operator*(const TPacket& f) const
+	{
+		return TVec3Packet(m_x * f, m_y * f, m_z * f);
+	}
+
+	TVec3Packet operator-() const
+	{
+		return TVec3Packet(-m_x, -m_y, -m_z);
+	}
+
+	TPacket dot(const TVec3Packet& b) const
+	{
+		return m_x * b.m_x + m_y * b.m_y + m_z * b.m_z;
+	}
+
+	TVec3Packet cross(const TVec3Packet& b) const
+	{
+		return TVec3Packet(m_y * b.m_z - m_z * b.m_y, m_z * b.m_x - m_x * b.m_z, m_x * b.m_y - m_y * b.m_x);
+	}
+
+	TVec3Packet abs() const
+	{
+		return TVec3Packet(m_x.abs(), m_y.abs(), m_z.abs());
+	}
+
+	/// Load the xyz of TPacket::kLaneCount Vec4s.
+	/// @param first The 1st vector.
+	/// @param stride The distance in bytes between the vectors. Use it to load vectors that are members of bigger structures.
+	static TVec3Packet loadVec4s(const Vec4* first, PtrSize stride = sizeof(Vec4))
+	{
+		Array<const F32*, TPacket::kLaneCount> ptrs;
+		for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+		{
+			ptrs[i] = reinterpret_cast<const F32*>(reinterpret_cast<const U8*>(first) + i * stride);
+		}
+
+		Array<TPacket, 4> comps;
+		TPacket::loadTransposed(ptrs.getBegin(), comps);
+		return TVec3Packet(comps[0], comps[1], comps[2]);
+	}
+
+	/// Store to TPacket::kLaneCount Vec4s. The W is set to the given value.
+	void storeVec4s(Vec4* vecs, F32 w) const
+	{
+		Array<F32*, TPacket::kLaneCount> ptrs;
+		for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+		{
+			ptrs[i] = &vecs[i][0];
+		}
+
+		TPacket::storeTransposed(Array<TPacket, 4>{m_x, m_y, m_z, TPacket(w)}, ptrs.getBegin());
+	}
+};
+
+/// A packet of quaternions in SoA layout. TPacket is F32x4 or F32x8.
+template<typename TPacket>
+class TQuatPacket
+{
+public:
+	TPacket m_x;
+	TPacket m_y;
+	TPacket m_z;
+	TPacket m_w;
+
+	TQuatPacket() = default;
+
+	TQuatPacket(const TPacket& x, const TPacket& y, const TPacket& z, const TPacket& w)
+		: m_x(x)
+		, m_y(y)
+		, m_z(z)
+		, m_w(w)
+	{
+	}
+
+	TQuatPacket operator+(const TQuatPacket& b) const
+	{
+		return TQuatPacket(m_x + b.m_x, m_y + b.m_y, m_z + b.m_z, m_w + b.m_w);
+	}
+
+	TQuatPacket operator*(const TPacket& f) const
+	{
+		return TQuatPacket(m_x * f, m_y * f, m_z * f, m_w * f);
+	}
+
+	TPacket dot(const TQuatPacket& b) const
+	{
+		return m_x * b.m_x + m_y * b.m_y + m_z * b.m_z + m_w * b.m_w;
+	}
+
+	TQuatPacket getNormalized() const
+	{
+		return *this * (TPacket(1.0f) / dot(*this).sqrt());
+	}
+
+	/// Pick a's lanes where the mask is set and b's where it isn't.
+	static TQuatPacket select(const TPacket& mask, const TQuatPacket& a, const TQuatPacket& b)
+	{
+		return TQuatPacket(TPacket::select(mask, a.m_x, b.m_x), TPacket::select(mask, a.m_y, b.m_y), TPacket::select(mask, a.m_z, b.m_z),
+						   TPacket::select(mask, a.m_w, b.m_w));
+	}
+
+	/// Load TPacket::kLaneCount quaternions.
+	static TQuatPacket load(const Quat* quats)
+	{
+		Array<const F32*, TPacket::kLaneCount> ptrs;
+		for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+		{
+			ptrs[i] = &quats[i][0];
+		}
+
+		Array<TPacket, 4> comps;
+		TPacket::loadTransposed(ptrs.getBegin(), comps);
+		return TQuatPacket(comps[0], comps[1], comps[2], comps[3]);
+	}
+
+	/// Store TPacket::kLaneCount quaternions.
+	void store(Quat* quats) const
+	{
+		Array<F32*, TPacket::kLaneCount> ptrs;
+		for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+		{
+			ptrs[i] = &quats[i][0];
+		}
+
+		TPacket::storeTransposed(Array<TPacket, 4>{m_x, m_y, m_z, m_w}, ptrs.getBegin());
+	}
+};
+
+/// A packet of 3x4 matrices in SoA layout. The elements are in the same row major order as Mat3x4. TPacket is F32x4 or F32x8.
+template<typename TPacket>
+class TMat3x4Packet
+{
+public:
+	Array<TPacket, 12> m_m;
+
+	TPacket& operator()(U32 j, U32 i)
+	{
+		return m_m[j * 4 + i];
+	}
+
+	const TPacket& operator()(U32 j, U32 i) const
+	{
+		return m_m[j * 4 + i];
+	}
+
+	/// Transform points. Same as Mat3x4 * Vec4(v, 1).
+	TVec3Packet<TPacket> transformPoints(const TVec3Packet<TPacket>& v) const
+	{
+		const TMat3x4Packet& m = *this;
+		return TVec3Packet<TPacket>(m(0, 0) * v.m_x + m(0, 1) * v.m_y + m(0, 2) * v.m_z + m(0, 3),
+									m(1, 0) * v.m_x + m(1, 1) * v.m_y + m(1, 2) * v.m_z + m(1, 3),
+									m(2, 0) * v.m_x + m(2, 1) * v.m_y + m(2, 2) * v.m_z + m(2, 3));
+	}
+
+	/// Transform directions. Same as Mat3x4 * Vec4(v, 0).
+	TVec3Packet<TPacket> transformDirections(const TVec3Packet<TPacket>& v) const
+	{
+		const TMat3x4Packet& m = *this;
+		return TVec3Packet<TPacket>(m(0, 0) * v.m_x + m(0, 1) * v.m_y + m(0, 2) * v.m_z, m(1, 0) * v.m_x + m(1, 1) * v.m_y + m(1, 2) * v.m_z,
+									m(2, 0) * v.m_x + m(2, 1) * v.m_y + m(2, 2) * v.m_z);
+	}
+
+	/// Same as Mat3x4::combineTransformations.
+	TMat3x4Packet combineTransformations(const TMat3x4Packet& b) const
+	{
+		const TMat3x4Packet& a = *this;
+		TMat3x4Packet c;
+		for(U32 j = 0; j < 3; ++j)
+		{
+			for(U32 i = 0; i < 4; ++i)
+			{
+				c(j, i) = a(j, 0) * b(0, i) + a(j, 1) * b(1, i) + a(j, 2) * b(2, i);
+			}
+
+			c(j, 3) += a(j, 3);
+		}
+
+		return c;
+	}
+
+	/// Transpose the 3x3 part. The translation is left as it is.
+	void transposeRotationPart()
+	{
+		std::swap((*this)(0, 1), (*this)(1, 0));
+		std::swap((*this)(0, 2), (*this)(2, 0));
+		std::swap((*this)(1, 2), (*this)(2, 1));
+	}
+
+	/// Load TPacket::kLaneCount matrices. See TVec3Packet::loadVec4s for the stride.
+	static TMat3x4Packet load(const Mat3x4* first, PtrSize stride = sizeof(Mat3x4))
+	{
+		TMat3x4Packet out;
+		Array<const F32*, TPacket::kLaneCount> ptrs;
+		for(U32 row = 0; row < 3; ++row)
+		{
+			for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+			{
+				ptrs[i] = &reinterpret_cast<const Mat3x4*>(reinterpret_cast<const U8*>(first) + i * stride)->getRow(row)[0];
+			}
+
+			Array<TPacket, 4> comps;
+			TPacket::loadTransposed(ptrs.getBegin(), comps);
+			for(U32 col = 0; col < 4; ++col)
+			{
+				out(row, col) = comps[col];
+			}
+		}
+
+		return out;
+	}
+
+	/// Store TPacket::kLaneCount matrices.
+	void store(Mat3x4* mats) const
+	{
+		Array<F32*, TPacket::kLaneCount> ptrs;
+		for(U32 row = 0; row < 3; ++row)
+		{
+			for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+			{
+				ptrs[i] = &mats[i](row, 0);
+			}
+
+			const TMat3x4Packet& m = *this;
+			TPacket::storeTransposed(Array<TPacket, 4>{m(row, 0), m(row, 1), m(row, 2), m(row, 3)}, ptrs.getBegin());
+		}
+	}
+};
+
+/// A packet of Transforms in SoA layout. TPacket is F32x4 or F32x8.
+template<typename TPacket>
+class TTransformPacket
+{
+public:
+	TVec3Packet<TPacket> m_origin;
+	TMat3x4Packet<TPacket> m_rotation;
+	TVec3Packet<TPacket> m_scale;
+
+	/// Same as Transform::combineTransformations.
+	TTransformPacket combineTransformations(const TTransformPacket& b) const
+	{
+		TTransformPacket c;
+		c.m_origin = m_rotation.transformDirections(b.m_origin * m_scale) + m_origin;
+		c.m_rotation = m_rotation.combineTransformations(b.m_rotation);
+		c.m_scale = m_scale * b.m_scale;
+		return c;
+	}
+
+	/// Same as Transform::getInverse.
+	TTransformPacket getInverse() const
+	{
+		TTransformPacket o;
+		o.m_rotation = m_rotation;
+		o.m_rotation.transposeRotationPart();
+		const TPacket one(1.0f);
+		o.m_scale = TVec3Packet<TPacket>(one / m_scale.m_x, one / m_scale.m_y, one / m_scale.m_z);
+		o.m_origin = -o.m_rotation.transformDirections(o.m_scale * m_origin);
+		return o;
+	}
+
+	/// Load TPacket::kLaneCount transforms.
+	static TTransformPacket load(const Transform* trfs)
+	{
+		TTransformPacket out;
+		out.m_origin = TVec3Packet<TPacket>::loadVec4s(&trfs[0].getOrigin(), sizeof(Transform));
+		out.m_rotation = TMat3x4Packet<TPacket>::load(&trfs[0].getRotation(), sizeof(Transform));
+		out.m_scale = TVec3Packet<TPacket>::loadVec4s(&trfs[0].getScale(), sizeof(Transform));
+		return out;
+	}
+
+	/// Store TPacket::kLaneCount transforms.
+	void store(Transform* trfs) const
+	{
+		Array<Vec4, TPacket::kLaneCount> origins;
+		Array<Mat3x4, TPacket::kLaneCount> rotations;
+		Array<Vec4, TPacket::kLaneCount> scales;
+		m_origin.storeVec4s(origins.getBegin(), 0.0f);
+		m_rotation.store(rotations.getBegin());
+		m_scale.storeVec4s(scales.getBegin(), 0.0f);
+
+		for(U32 i = 0; i < TPacket::kLaneCount; ++i)
+		{
+			trfs[i] = Transform(origins[i], rotations[i], scales[i]);
+		}
+	}
+};
+
+using Vec3Packet4 = TVec3Packet<F32x4>;
+using Vec3Packet8 = TVec3Packet<F32x8>;
+using QuatPacket4 = TQuatPacket<F32x4>;
+using QuatPacket8 = TQuatPacket<F32x8>;
+using Mat3x4Packet4 = TMat3x4Packet<F32x4>;
+using Mat3x4Packet8 = TMat3x4Packet<F32x8>;
+using TransformPacket4 = TTransformPacket<F32x4>;
+using TransformPacket8 = TTransformPacket<F32x8>;
+/// @}
+
+} // end namespace anki
@@ -169,7 +169,7 @@ public:
 		TTransform o;
 		o.m_rotation = m_rotation;
 		o.m_rotation.transposeRotationPart();
-		o.m_scale = T(1) / m_scale.xyz1();
+		o.m_scale = (T(1) / m_scale.xyz1()).xyz0();
 		o.m_origin = -(o.m_rotation * (o.m_scale * m_origin)).xyz0();
 		check();
 		return o;
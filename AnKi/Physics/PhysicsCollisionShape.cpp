@@ -34,28 +34,89 @@ PhysicsBox::~PhysicsBox()
 	m_box.destroy();
 }
 
-PhysicsTriangleSoup::PhysicsTriangleSoup(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex)
+const btCollisionShape* PhysicsCollisionShape::getBtShapeInternal(Bool forDynamicBodies) const
+{
+	switch(m_type)
+	{
+	case ShapeType::kBox:
+		return m_box.get();
+	case ShapeType::kSphere:
+		return m_sphere.get();
+	case ShapeType::kConvex:
+		return m_convex.get();
+	case ShapeType::kTrimesh:
+		if(forDynamicBodies)
+		{
+			return static_cast<const PhysicsTriangleSoup*>(this)->getOrCreateDynamicShape();
+		}
+		else
+		{
+			return m_triMesh.m_static.get();
+		}
+	default:
+		ANKI_ASSERT(0);
+		return nullptr;
+	}
+}
+
+/// Make Bullet reference the positions and indices without copying them.
+static void initMeshInterface(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, btTriangleIndexVertexArray& mesh)
+{
+	ANKI_ASSERT(positions.getSize() > 0 && indices.getSize() > 0 && (indices.getSize() % 3) == 0);
+
+	btIndexedMesh part;
+	part.m_numTriangles = I32(indices.getSize() / 3);
+	part.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(&indices[0]);
+	part.m_triangleIndexStride = 3 * sizeof(U32);
+	part.m_numVertices = I32(positions.getSize());
+	part.m_vertexBase = reinterpret_cast<const unsigned char*>(&positions[0]);
+	part.m_vertexStride = sizeof(Vec3);
+	part.m_indexType = PHY_INTEGER;
+	part.m_vertexType = PHY_FLOAT;
+
+	mesh.addIndexedMesh(part, PHY_INTEGER);
+}
+
+PhysicsTriangleSoup::PhysicsTriangleSoup(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex, ConstWeakArray<U8> bakedBvh)
 	: PhysicsCollisionShape(ShapeType::kTrimesh)
 {
+	m_positions.resize(positions.getSize());
+	memcpy(m_positions.getBegin(), positions.getBegin(), positions.getSizeInBytes());
+	m_indices.resize(indices.getSize());
+	memcpy(m_indices.getBegin(), indices.getBegin(), indices.getSizeInBytes());
+
 	if(!convex)
 	{
-		ANKI_ASSERT((indices.getSize() % 3) == 0);
-
 		m_mesh.init();
+		initMeshInterface(m_positions, m_indices, *m_mesh);
 
-		for(U32 i = 0; i < indices.getSize(); i += 3)
+		// Create the static shape. The dynamic one is created on demand because few meshes are used by dynamic bodies
+		if(bakedBvh.getSize())
 		{
-			m_mesh->addTriangle(toBt(positions[indices[i]]), toBt(positions[indices[i + 1]]), toBt(positions[indices[i + 2]]));
+			// The BVH is deserialized in place so it needs a copy with the correct alignment
+			m_bakedBvhMemory = PhysicsMemoryPool::getSingleton().allocate(bakedBvh.getSizeInBytes(), 16);
+			memcpy(m_bakedBvhMemory, bakedBvh.getBegin(), bakedBvh.getSizeInBytes());
+
+			// Note that Bullet gives it the vtable of btQuantizedBvh so don't call the virtuals of btOptimizedBvh
+			m_bakedBvh = btOptimizedBvh::deSerializeInPlace(m_bakedBvhMemory, U32(bakedBvh.getSizeInBytes()), false);
+			if(!m_bakedBvh)
+			{
+				ANKI_PHYS_LOGW("Failed to deserialize the baked BVH. Will build it");
+				PhysicsMemoryPool::getSingleton().free(m_bakedBvhMemory);
+				m_bakedBvhMemory = nullptr;
+			}
 		}
 
-		// Create the dynamic shape
-		m_triMesh.m_dynamic.init(m_mesh.get());
-		m_triMesh.m_dynamic->setMargin(PhysicsWorld::getSingleton().getCollisionMargin());
-		m_triMesh.m_dynamic->updateBound();
-		m_triMesh.m_dynamic->setUserPointer(static_cast<PhysicsObject*>(this));
+		if(m_bakedBvh)
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true, false);
+			m_triMesh.m_static->setOptimizedBvh(m_bakedBvh);
+		}
+		else
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true);
+		}
 
-		// And the static one
-		m_triMesh.m_static.init(m_mesh.get(), true);
 		m_triMesh.m_static->setMargin(PhysicsWorld::getSingleton().getCollisionMargin());
 		m_triMesh.m_static->setUserPointer(static_cast<PhysicsObject*>(this));
 	}
@@ -73,8 +134,20 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 {
 	if(m_type == ShapeType::kTrimesh)
 	{
-		m_triMesh.m_dynamic.destroy();
+		if(m_dynamicShapeCreated.load())
+		{
+			m_triMesh.m_dynamic.destroy();
+		}
+
 		m_triMesh.m_static.destroy();
+
+		if(m_bakedBvh)
+		{
+			// The BVH doesn't own any memory, it points to m_bakedBvhMemory
+			m_bakedBvh->~btOptimizedBvh();
+			PhysicsMemoryPool::getSingleton().free(m_bakedBvhMemory);
+		}
+
 		m_mesh.destroy();
 	}
 	else
@@ -84,4 +157,47 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 	}
 }
 
+const btGImpactMeshShape* PhysicsTriangleSoup::getOrCreateDynamicShape() const
+{
+	ANKI_ASSERT(m_type == ShapeType::kTrimesh);
+
+	if(!m_dynamicShapeCreated.load())
+	{
+		LockGuard<Mutex> lock(m_dynamicShapeMtx);
+
+		if(!m_dynamicShapeCreated.load())
+		{
+			PhysicsTriangleSoup& self = *const_cast<PhysicsTriangleSoup*>(this);
+			self.m_triMesh.m_dynamic.init(self.m_mesh.get());
+			self.m_triMesh.m_dynamic->setMargin(PhysicsWorld::getSingleton().getCollisionMargin());
+			self.m_triMesh.m_dynamic->updateBound();
+			self.m_triMesh.m_dynamic->setUserPointer(static_cast<PhysicsObject*>(&self));
+
+			m_dynamicShapeCreated.store(1);
+		}
+	}
+
+	return m_triMesh.m_dynamic.get();
+}
+
+void PhysicsTriangleSoup::bakeBvh(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices,
+								  DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>>& bvh)
+{
+	// Build it the same way the constructor does
+	btTriangleIndexVertexArray mesh;
+	initMeshInterface(positions, indices, mesh);
+	btBvhTriangleMeshShape shape(&mesh, true);
+
+	const btOptimizedBvh& optimizedBvh = *shape.getOptimizedBvh();
+	const U32 size = optimizedBvh.calculateSerializeBufferSize();
+
+	void* mem = btAlignedAlloc(size, 16);
+	[[maybe_unused]] const Bool success = optimizedBvh.serializeInPlace(mem, size, false);
+	ANKI_ASSERT(success);
+
+	bvh.resize(size);
+	memcpy(bvh.getBegin(), mem, size);
+	btAlignedFree(mem);
+}
+
 } // end namespace anki
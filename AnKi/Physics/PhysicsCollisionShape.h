@@ -8,6 +8,8 @@
 #include <AnKi/Physics/PhysicsObject.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/ClassWrapper.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
@@ -42,7 +44,7 @@ protected:
 	class TriMesh
 	{
 	public:
-		ClassWrapper<btGImpactMeshShape> m_dynamic;
+		ClassWrapper<btGImpactMeshShape> m_dynamic; ///< Created the 1st time it's needed. See PhysicsTriangleSoup.
 		ClassWrapper<btBvhTriangleMeshShape> m_static;
 	};
 
@@ -63,30 +65,7 @@ protected:
 	{
 	}
 
-	const btCollisionShape* getBtShapeInternal(Bool forDynamicBodies) const
-	{
-		switch(m_type)
-		{
-		case ShapeType::kBox:
-			return m_box.get();
-		case ShapeType::kSphere:
-			return m_sphere.get();
-		case ShapeType::kConvex:
-			return m_convex.get();
-		case ShapeType::kTrimesh:
-			if(forDynamicBodies)
-			{
-				return m_triMesh.m_dynamic.get();
-			}
-			else
-			{
-				return m_triMesh.m_static.get();
-			}
-		default:
-			ANKI_ASSERT(0);
-			return nullptr;
-		}
-	}
+	const btCollisionShape* getBtShapeInternal(Bool forDynamicBodies) const;
 
 	void registerToWorld() override
 	{
@@ -130,17 +109,48 @@ private:
 	~PhysicsConvexHull();
 };
 
-/// Static triangle mesh shape.
+/// Static triangle mesh shape. It keeps an indexed copy of the geometry that Bullet references. The BVH of the static shape can be baked offline
+/// and the shape for dynamic bodies is created the 1st time it's needed.
 class PhysicsTriangleSoup final : public PhysicsCollisionShape
 {
 	ANKI_PHYSICS_OBJECT(PhysicsObjectType::kCollisionShape)
 
+	friend class PhysicsCollisionShape;
+
+public:
+	ConstWeakArray<Vec3> getPositions() const
+	{
+		return m_positions;
+	}
+
+	ConstWeakArray<U32> getIndices() const
+	{
+		return m_indices;
+	}
+
+	/// Build the BVH of the static shape offline. Pass it to the constructor to skip building it at load time.
+	/// @param positions The positions that will be given to the constructor.
+	/// @param indices The indices that will be given to the constructor.
+	/// @param[out] bvh The serialized BVH.
+	static void bakeBvh(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>>& bvh);
+
 private:
-	ClassWrapper<btTriangleMesh> m_mesh;
+	PhysicsDynamicArray<Vec3> m_positions;
+	PhysicsDynamicArray<U32> m_indices;
+	ClassWrapper<btTriangleIndexVertexArray> m_mesh;
 
-	PhysicsTriangleSoup(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex = false);
+	void* m_bakedBvhMemory = nullptr; ///< The BVH of the static shape lives there if it was baked.
+	btOptimizedBvh* m_bakedBvh = nullptr;
+
+	mutable Atomic<U32> m_dynamicShapeCreated = {0};
+	mutable Mutex m_dynamicShapeMtx;
+
+	/// @param bakedBvh The output of bakeBvh(). If it's empty the BVH will be built.
+	PhysicsTriangleSoup(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex = false, ConstWeakArray<U8> bakedBvh = {});
 
 	~PhysicsTriangleSoup();
+
+	const btGImpactMeshShape* getOrCreateDynamicShape() const;
 };
 /// @}
 
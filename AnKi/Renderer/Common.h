@@ -11,6 +11,7 @@
 #include <AnKi/Shaders/Include/MiscRendererTypes.h>
 #include <AnKi/Shaders/Include/ClusteredShadingTypes.h>
 #include <AnKi/Scene/GpuSceneArray.h>
+#include <AnKi/Scene/Components/SkyboxComponent.h>
 
 namespace anki {
 
@@ -70,12 +71,38 @@ constexpr U32 kDownscaleBurDownTo = 32;
 inline constexpr Array<Format, kGBufferColorRenderTargetCount> kGBufferColorRenderTargetFormats = {
 	{Format::kR8G8B8A8_Unorm, Format::kR8G8B8A8_Unorm, Format::kA2B10G10R10_Unorm_Pack32, Format::kR16G16_Snorm}};
 
+/// A copy of the scene state that the render passes need while recording command buffers. With pipelined frames (see the PipelinedFrames
+/// CVar) the scene is updating in parallel with the recording so the passes can't access the scene components directly.
+class RenderingSceneSnapshot
+{
+public:
+	Bool m_skyboxExists = false;
+	SkyboxType m_skyboxType = SkyboxType::kSolidColor;
+	Vec3 m_skyboxSolidColor = Vec3(0.0f);
+	Vec3 m_skyboxImageScale = Vec3(1.0f);
+	Vec3 m_skyboxImageBias = Vec3(0.0f);
+	TexturePtr m_skyboxImage; ///< Hold a reference because the skybox might change its image in the meantime.
+
+	Vec3 m_fogDiffuseColor = Vec3(0.0f);
+	F32 m_fogScatteringCoefficient = 0.0f;
+	F32 m_fogAbsorptionCoefficient = 0.0f;
+	F32 m_minFogDensity = 0.0f;
+	F32 m_maxFogDensity = 0.0f;
+	F32 m_heightOfMinFogDensity = 0.0f;
+	F32 m_heightOfMaxFogDensity = 0.0f;
+
+	Bool m_directionalLightExists = false;
+	Bool m_directionalLightShadowEnabled = false;
+};
+
 /// Rendering context.
 class RenderingContext
 {
 public:
 	RenderGraphBuilder m_renderGraphDescr;
 
+	RenderingSceneSnapshot m_scene;
+
 	CommonMatrices m_matrices;
 	CommonMatrices m_prevMatrices;
 
@@ -170,7 +170,7 @@ void FinalComposite::run(RenderPassWorkContext& rgraphCtx)
 	drawQuad(cmdb);
 
 	// Draw UI
-	getRenderer().getUiStage().draw(getRenderer().getPostProcessResolution().x(), getRenderer().getPostProcessResolution().y(), cmdb);
+	getRenderer().getUiStage().draw(cmdb);
 }
 
 } // end namespace anki
@@ -420,12 +420,11 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 				}
 
 				pass.setWork([this, visibleLightsBuffer = lightVis.m_visiblesBuffer, viewProjMat = frustum.getViewProjectionMatrix(), cellCenter,
-							  gbufferColorRts, gbufferDepthRt, probeToRefresh, cascadeViewProjMat, shadowsRt, faceIdx = f,
-							  &rctx](RenderPassWorkContext& rgraphCtx) {
+							  gbufferColorRts, gbufferDepthRt, shadowsRenderRadius = probeToRefresh->getShadowsRenderRadius(), cascadeViewProjMat,
+							  shadowsRt, faceIdx = f, &rctx](RenderPassWorkContext& rgraphCtx) {
 					ANKI_TRACE_SCOPED_EVENT(RIndirectDiffuse);
 
-					const LightComponent* dirLightc = SceneGraph::getSingleton().getDirectionalLight();
-					const Bool doShadows = dirLightc && dirLightc->getShadowEnabled();
+					const Bool doShadows = rctx.m_scene.m_directionalLightShadowEnabled;
 
 					CommandBuffer& cmdb = *rgraphCtx.m_commandBuffer;
 
@@ -438,7 +437,7 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 					dsInfo.m_invViewProjectionMatrix = viewProjMat.getInverse();
 					dsInfo.m_cameraPosWSpace = cellCenter.xyz1();
 					dsInfo.m_viewport = UVec4(0, 0, m_tileSize, m_tileSize);
-					dsInfo.m_effectiveShadowDistance = (doShadows) ? probeToRefresh->getShadowsRenderRadius() : -1.0f;
+					dsInfo.m_effectiveShadowDistance = (doShadows) ? shadowsRenderRadius : -1.0f;
 
 					if(doShadows)
 					{
@@ -462,6 +461,7 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 					dsInfo.m_directionalLightShadowmapRenderTarget = shadowsRt;
 					dsInfo.m_skyLutRenderTarget = (getRenderer().getSky().isEnabled()) ? getRenderer().getSky().getSkyLutRt() : RenderTargetHandle();
 					dsInfo.m_globalRendererConsts = rctx.m_globalRenderingUniformsBuffer;
+					dsInfo.m_scene = &rctx.m_scene;
 					dsInfo.m_renderpassContext = &rgraphCtx;
 
 					m_lightShading.m_deferred.drawLights(dsInfo);
@@ -480,7 +480,8 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 				pass.newTextureDependency(gbufferColorRts[i], TextureUsageBit::kSampledCompute);
 			}
 
-			pass.setWork([this, lightShadingRt, gbufferColorRts, irradianceVolume, cellIdx, probeToRefresh](RenderPassWorkContext& rgraphCtx) {
+			pass.setWork([this, lightShadingRt, gbufferColorRts, irradianceVolume, cellIdx,
+						  cellCounts = probeToRefresh->getCellCountsPerDimension()](RenderPassWorkContext& rgraphCtx) {
 				ANKI_TRACE_SCOPED_EVENT(RIndirectDiffuse);
 
 				CommandBuffer& cmdb = *rgraphCtx.m_commandBuffer;
@@ -506,11 +507,10 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 				} unis;
 
 				U32 x, y, z;
-				unflatten3dArrayIndex(probeToRefresh->getCellCountsPerDimension().x(), probeToRefresh->getCellCountsPerDimension().y(),
-									  probeToRefresh->getCellCountsPerDimension().z(), cellIdx, x, y, z);
+				unflatten3dArrayIndex(cellCounts.x(), cellCounts.y(), cellCounts.z(), cellIdx, x, y, z);
 				unis.m_volumeTexel = IVec3(x, y, z);
 
-				unis.m_nextTexelOffsetInU = probeToRefresh->getCellCountsPerDimension().x();
+				unis.m_nextTexelOffsetInU = cellCounts.x();
 				cmdb.setPushConstants(&unis, sizeof(unis));
 
 				// Dispatch
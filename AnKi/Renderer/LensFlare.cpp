@@ -51,6 +51,18 @@ void LensFlare::populateRenderGraph(RenderingContext& ctx)
 		return;
 	}
 
+	// Gather the flares
+	m_runCtx.m_flares.resize(flareCount);
+	U32 count = 0;
+	for(const LensFlareComponent& comp : SceneGraph::getSingleton().getComponentArrays().getLensFlares())
+	{
+		Flare& flare = m_runCtx.m_flares[count++];
+		flare.m_worldPosition = comp.getWorldPosition();
+		flare.m_firstFlareSize = flare.m_firstFlareSize;
+		flare.m_colorMultiplier = flare.m_colorMultiplier;
+		flare.m_image.reset(&comp.getImage().getTexture());
+	}
+
 	RenderGraphBuilder& rgraph = ctx.m_renderGraphDescr;
 
 	// Create indirect buffer
@@ -68,7 +80,7 @@ void LensFlare::populateRenderGraph(RenderingContext& ctx)
 		ANKI_TRACE_SCOPED_EVENT(LensFlare);
 		CommandBuffer& cmdb = *rgraphCtx.m_commandBuffer;
 
-		const U32 flareCount = SceneGraph::getSingleton().getComponentArrays().getLensFlares().getSize();
+		const U32 flareCount = m_runCtx.m_flares.getSize();
 		ANKI_ASSERT(flareCount > 0);
 
 		cmdb.bindShaderProgram(m_updateIndirectBuffGrProg.get());
@@ -77,9 +89,9 @@ void LensFlare::populateRenderGraph(RenderingContext& ctx)
 
 		// Write flare info
 		Vec4* flarePositions = allocateAndBindStorageBuffer<Vec4>(cmdb, ANKI_REG(t0), flareCount);
-		for(const LensFlareComponent& comp : SceneGraph::getSingleton().getComponentArrays().getLensFlares())
+		for(const Flare& flare : m_runCtx.m_flares)
 		{
-			*flarePositions = Vec4(comp.getWorldPosition(), 1.0f);
+			*flarePositions = Vec4(flare.m_worldPosition, 1.0f);
 			++flarePositions;
 		}
 
@@ -94,7 +106,7 @@ void LensFlare::populateRenderGraph(RenderingContext& ctx)
 
 void LensFlare::runDrawFlares(const RenderingContext& ctx, CommandBuffer& cmdb)
 {
-	const U32 flareCount = SceneGraph::getSingleton().getComponentArrays().getLensFlares().getSize();
+	const U32 flareCount = m_runCtx.m_flares.getSize();
 
 	if(flareCount == 0)
 	{
@@ -106,10 +118,10 @@ void LensFlare::runDrawFlares(const RenderingContext& ctx, CommandBuffer& cmdb)
 	cmdb.setDepthWrite(false);
 
 	U32 count = 0;
-	for(const LensFlareComponent& comp : SceneGraph::getSingleton().getComponentArrays().getLensFlares())
+	for(const Flare& flare : m_runCtx.m_flares)
 	{
 		// Compute position
-		Vec4 lfPos = Vec4(comp.getWorldPosition(), 1.0f);
+		Vec4 lfPos = Vec4(flare.m_worldPosition, 1.0f);
 		Vec4 posClip = ctx.m_matrices.m_viewProjectionJitter * lfPos;
 
 		/*if(posClip.x() > posClip.w() || posClip.x() < -posClip.w() || posClip.y() > posClip.w()
@@ -130,16 +142,16 @@ void LensFlare::runDrawFlares(const RenderingContext& ctx, CommandBuffer& cmdb)
 		Vec2 posNdc = posClip.xy() / posClip.w();
 
 		// First flare
-		sprites[c].m_posScale = Vec4(posNdc, comp.getFirstFlareSize() * Vec2(1.0f, getRenderer().getAspectRatio()));
+		sprites[c].m_posScale = Vec4(posNdc, flare.m_firstFlareSize * Vec2(1.0f, getRenderer().getAspectRatio()));
 		sprites[c].m_depthPad3 = Vec4(0.0f);
-		const F32 alpha = comp.getColorMultiplier().w() * (1.0f - pow(absolute(posNdc.x()), 6.0f))
+		const F32 alpha = flare.m_colorMultiplier.w() * (1.0f - pow(absolute(posNdc.x()), 6.0f))
 						  * (1.0f - pow(absolute(posNdc.y()), 6.0f)); // Fade the flare on the edges
-		sprites[c].m_color = Vec4(comp.getColorMultiplier().xyz(), alpha);
+		sprites[c].m_color = Vec4(flare.m_colorMultiplier.xyz(), alpha);
 		++c;
 
 		// Render
 		cmdb.bindSampler(ANKI_REG(s0), getRenderer().getSamplers().m_trilinearRepeat.get());
-		cmdb.bindTexture(ANKI_REG(t1), TextureView(&comp.getImage().getTexture(), TextureSubresourceDesc::all()));
+		cmdb.bindTexture(ANKI_REG(t1), TextureView(flare.m_image.get(), TextureSubresourceDesc::all()));
 
 		cmdb.drawIndirect(PrimitiveTopology::kTriangleStrip, BufferView(m_runCtx.m_indirectBuff).incrementOffset(count * sizeof(DrawIndirectArgs)));
 
@@ -40,11 +40,22 @@ private:
 	ShaderProgramPtr m_realGrProg;
 	U8 m_maxSpritesPerFlare;
 
+	/// A copy of the component data because the scene might be updating while recording.
+	class Flare
+	{
+	public:
+		Vec3 m_worldPosition;
+		Vec2 m_firstFlareSize;
+		Vec4 m_colorMultiplier;
+		TexturePtr m_image;
+	};
+
 	class
 	{
 	public:
 		BufferView m_indirectBuff;
 		BufferHandle m_indirectBuffHandle;
+		RendererDynamicArray<Flare> m_flares;
 	} m_runCtx;
 
 	Error initInternal();
@@ -136,20 +136,19 @@ void LightShading::run(const RenderingContext& ctx, RenderPassWorkContext& rgrap
 	{
 		cmdb.setDepthCompareOperation(CompareOperation::kEqual);
 
-		const SkyboxComponent* sky = SceneGraph::getSingleton().getSkybox();
-		const LightComponent* dirLight = SceneGraph::getSingleton().getDirectionalLight();
+		const RenderingSceneSnapshot& scene = ctx.m_scene;
 
-		const Bool isSolidColor =
-			(!sky || sky->getSkyboxType() == SkyboxType::kSolidColor || (!dirLight && sky->getSkyboxType() == SkyboxType::kGenerated));
+		const Bool isSolidColor = (!scene.m_skyboxExists || scene.m_skyboxType == SkyboxType::kSolidColor
+								   || (!scene.m_directionalLightExists && scene.m_skyboxType == SkyboxType::kGenerated));
 
 		if(isSolidColor)
 		{
 			cmdb.bindShaderProgram(m_skybox.m_grProgs[0].get());
 
-			const Vec4 color((sky) ? sky->getSolidColor() : Vec3(0.0f), 0.0);
+			const Vec4 color(scene.m_skyboxSolidColor, 0.0);
 			cmdb.setPushConstants(&color, sizeof(color));
 		}
-		else if(sky->getSkyboxType() == SkyboxType::kImage2D)
+		else if(scene.m_skyboxType == SkyboxType::kImage2D)
 		{
 			cmdb.bindShaderProgram(m_skybox.m_grProgs[1].get());
 
@@ -170,13 +169,13 @@ void LightShading::run(const RenderingContext& ctx, RenderPassWorkContext& rgrap
 
 			pc.m_invertedViewProjectionJitterMat = ctx.m_matrices.m_invertedViewProjectionJitter;
 			pc.m_cameraPos = ctx.m_matrices.m_cameraTransform.getTranslationPart().xyz();
-			pc.m_scale = sky->getImageScale();
-			pc.m_bias = sky->getImageBias();
+			pc.m_scale = scene.m_skyboxImageScale;
+			pc.m_bias = scene.m_skyboxImageBias;
 
 			cmdb.setPushConstants(&pc, sizeof(pc));
 
 			cmdb.bindSampler(ANKI_REG(s0), getRenderer().getSamplers().m_trilinearRepeatAnisoResolutionScalingBias.get());
-			cmdb.bindTexture(ANKI_REG(t0), TextureView(&sky->getImageResource().getTexture(), TextureSubresourceDesc::all()));
+			cmdb.bindTexture(ANKI_REG(t0), TextureView(scene.m_skyboxImage.get(), TextureSubresourceDesc::all()));
 		}
 		else
 		{
@@ -78,8 +78,16 @@ Error MainRenderer::init(const MainRendererInitInfo& inf)
 }
 
 Error MainRenderer::render(Texture* presentTex)
+{
+	ANKI_CHECK(populateRenderGraph(presentTex));
+	recordAndSubmit();
+	return Error::kNone;
+}
+
+Error MainRenderer::populateRenderGraph(Texture* presentTex)
 {
 	ANKI_TRACE_SCOPED_EVENT(Render);
+	ANKI_ASSERT(m_runCtx.m_ctx == nullptr && "recordAndSubmit() wasn't called");
 
 	const Second startTime = HighRezTimer::getCurrentTime();
 
@@ -87,8 +95,8 @@ Error MainRenderer::render(Texture* presentTex)
 	m_framePool.reset();
 
 	// Run renderer
-	RenderingContext ctx(&m_framePool);
-	m_runCtx.m_ctx = &ctx;
+	m_runCtx.m_ctx = newInstance<RenderingContext>(m_framePool, &m_framePool);
+	RenderingContext& ctx = *m_runCtx.m_ctx;
 	m_runCtx.m_secondaryTaskId.setNonAtomically(0);
 	ctx.m_renderGraphDescr.setStatisticsEnabled(ANKI_STATS_ENABLED);
 
@@ -141,18 +149,32 @@ Error MainRenderer::render(Texture* presentTex)
 	// Bake the render graph
 	m_rgraph->compileNewGraph(ctx.m_renderGraphDescr, m_framePool);
 
+	m_runCtx.m_populateDuration = HighRezTimer::getCurrentTime() - startTime;
+	return Error::kNone;
+}
+
+void MainRenderer::recordAndSubmit()
+{
+	ANKI_TRACE_SCOPED_EVENT(RenderRecord);
+	ANKI_ASSERT(m_runCtx.m_ctx && "populateRenderGraph() wasn't called");
+
+	const Second startTime = HighRezTimer::getCurrentTime();
+
 	// Flush
 	FencePtr fence;
 	m_rgraph->recordAndSubmitCommandBuffers(&fence);
 
 	// Reset for the next frame
 	m_rgraph->reset();
-	m_r->finalize(ctx, fence.get());
+	m_r->finalize(*m_runCtx.m_ctx, fence.get());
+
+	deleteInstance(m_framePool, m_runCtx.m_ctx);
+	m_runCtx.m_ctx = nullptr;
 
 	// Stats
 	if(ANKI_STATS_ENABLED || ANKI_TRACING_ENABLED)
 	{
-		g_rendererCpuTimeStatVar.set((HighRezTimer::getCurrentTime() - startTime) * 1000.0);
+		g_rendererCpuTimeStatVar.set((HighRezTimer::getCurrentTime() - startTime + m_runCtx.m_populateDuration) * 1000.0);
 
 		RenderGraphStatistics rgraphStats;
 		m_rgraph->getStatistics(rgraphStats);
@@ -164,8 +186,6 @@ Error MainRenderer::render(Texture* presentTex)
 			ANKI_TRACE_CUSTOM_EVENT(GpuFrameTime, rgraphStats.m_cpuStartTime, rgraphStats.m_gpuTime);
 		}
 	}
-
-	return Error::kNone;
 }
 
 Dbg& MainRenderer::getDbg()
@@ -32,8 +32,15 @@ class MainRenderer : public MakeSingleton<MainRenderer>
 public:
 	Error init(const MainRendererInitInfo& inf);
 
+	/// Render a frame. Same as calling populateRenderGraph() and recordAndSubmit().
 	Error render(Texture* presentTex);
 
+	/// 1st half of render(). It reads the scene and prepares the frame.
+	Error populateRenderGraph(Texture* presentTex);
+
+	/// 2nd half of render(). It doesn't access the scene so the scene can be updating in parallel.
+	void recordAndSubmit();
+
 	Dbg& getDbg();
 
 	F32 getAspectRatio() const;
@@ -65,8 +72,9 @@ private:
 	class
 	{
 	public:
-		const RenderingContext* m_ctx = nullptr;
+		RenderingContext* m_ctx = nullptr;
 		Atomic<U32> m_secondaryTaskId = {0};
+		Second m_populateDuration = 0.0;
 	} m_runCtx;
 
 	MainRenderer();
@@ -413,16 +413,17 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			}
 
 			pass.setWork([this, visResult = lightVis.m_visiblesBuffer, viewProjMat = frustum.getViewProjectionMatrix(),
-						  cascadeViewProjMat = cascadeViewProjMat, probeToRefresh, gbufferColorRts, gbufferDepthRt, shadowMapRt, faceIdx = f,
+						  cascadeViewProjMat = cascadeViewProjMat, probePosition = probeToRefresh->getWorldPosition(),
+						  shadowsRenderRadius = probeToRefresh->getShadowsRenderRadius(), gbufferColorRts, gbufferDepthRt, shadowMapRt, faceIdx = f,
 						  &rctx](RenderPassWorkContext& rgraphCtx) {
 				ANKI_TRACE_SCOPED_EVENT(ProbeReflections);
 
 				TraditionalDeferredLightShadingDrawInfo dsInfo;
 				dsInfo.m_viewProjectionMatrix = viewProjMat;
 				dsInfo.m_invViewProjectionMatrix = viewProjMat.getInverse();
-				dsInfo.m_cameraPosWSpace = probeToRefresh->getWorldPosition().xyz1();
+				dsInfo.m_cameraPosWSpace = probePosition.xyz1();
 				dsInfo.m_viewport = UVec4(0, 0, m_lightShading.m_tileSize, m_lightShading.m_tileSize);
-				dsInfo.m_effectiveShadowDistance = probeToRefresh->getShadowsRenderRadius();
+				dsInfo.m_effectiveShadowDistance = shadowsRenderRadius;
 
 				const Mat4 biasMat4(0.5f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 				dsInfo.m_dirLightMatrix = biasMat4 * cascadeViewProjMat;
@@ -441,6 +442,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 				}
 				dsInfo.m_skyLutRenderTarget = (getRenderer().getSky().isEnabled()) ? getRenderer().getSky().getSkyLutRt() : RenderTargetHandle();
 				dsInfo.m_globalRendererConsts = rctx.m_globalRenderingUniformsBuffer;
+				dsInfo.m_scene = &rctx.m_scene;
 				dsInfo.m_renderpassContext = &rgraphCtx;
 
 				m_lightShading.m_deferred.drawLights(dsInfo);
@@ -284,6 +284,8 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	ctx.m_cameraNear = cam.getNear();
 	ctx.m_cameraFar = cam.getFar();
 
+	gatherSceneSnapshot(ctx);
+
 	// Allocate global constants
 	GlobalRendererUniforms* globalUnis;
 	ctx.m_globalRenderingUniformsBuffer = RebarTransientMemoryPool::getSingleton().allocateFrame(1, globalUnis);
@@ -333,6 +335,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_bloom->populateRenderGraph(ctx);
 	m_dbg->populateRenderGraph(ctx);
 
+	m_uiStage->buildUi(getPostProcessResolution().x(), getPostProcessResolution().y());
 	m_finalComposite->populateRenderGraph(ctx);
 
 	writeGlobalRendererConstants(ctx, *globalUnis);
@@ -340,6 +343,41 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	return Error::kNone;
 }
 
+void Renderer::gatherSceneSnapshot(RenderingContext& ctx)
+{
+	RenderingSceneSnapshot& out = ctx.m_scene;
+
+	const SkyboxComponent* sky = SceneGraph::getSingleton().getSkybox();
+	out.m_skyboxExists = sky != nullptr;
+	if(sky)
+	{
+		out.m_skyboxType = sky->getSkyboxType();
+		if(out.m_skyboxType == SkyboxType::kSolidColor)
+		{
+			out.m_skyboxSolidColor = sky->getSolidColor();
+		}
+		else if(out.m_skyboxType == SkyboxType::kImage2D)
+		{
+			out.m_skyboxImage.reset(&sky->getImageResource().getTexture());
+		}
+
+		out.m_skyboxImageScale = sky->getImageScale();
+		out.m_skyboxImageBias = sky->getImageBias();
+
+		out.m_fogDiffuseColor = sky->getFogDiffuseColor();
+		out.m_fogScatteringCoefficient = sky->getFogScatteringCoefficient();
+		out.m_fogAbsorptionCoefficient = sky->getFogAbsorptionCoefficient();
+		out.m_minFogDensity = sky->getMinFogDensity();
+		out.m_maxFogDensity = sky->getMaxFogDensity();
+		out.m_heightOfMinFogDensity = sky->getHeightOfMinFogDensity();
+		out.m_heightOfMaxFogDensity = sky->getHeightOfMaxFogDensity();
+	}
+
+	const LightComponent* dirLight = SceneGraph::getSingleton().getDirectionalLight();
+	out.m_directionalLightExists = dirLight != nullptr;
+	out.m_directionalLightShadowEnabled = dirLight && dirLight->getShadowEnabled();
+}
+
 void Renderer::writeGlobalRendererConstants(RenderingContext& ctx, GlobalRendererUniforms& unis)
 {
 	ANKI_TRACE_SCOPED_EVENT(RWriteGlobalRendererConstants);
@@ -680,7 +718,8 @@ void Renderer::gpuSceneCopy(RenderingContext& ctx)
 	if(GpuSceneMicroPatcher::getSingleton().patchingIsNeeded())
 	{
 		NonGraphicsRenderPass& rpass = rgraph.newNonGraphicsRenderPass("GPU scene patching");
-		rpass.newBufferDependency(m_runCtx.m_gpuSceneHandle, BufferUsageBit::kStorageComputeWrite);
+		// The patcher might also move data around with transfers before patching
+		rpass.newBufferDependency(m_runCtx.m_gpuSceneHandle, BufferUsageBit::kStorageComputeWrite | BufferUsageBit::kAllTransfer);
 
 		rpass.setWork([](RenderPassWorkContext& rgraphCtx) {
 			GpuSceneMicroPatcher::getSingleton().patchGpuScene(*rgraphCtx.m_commandBuffer);
@@ -230,6 +230,8 @@ private:
 
 	void gpuSceneCopy(RenderingContext& ctx);
 
+	void gatherSceneSnapshot(RenderingContext& ctx);
+
 #if ANKI_STATS_ENABLED
 	void updatePipelineStats();
 #endif
@@ -27,7 +27,23 @@ static NumericCVar<U32> g_shadowMappingTileCountPerRowOrColumnCVar(CVarSubsystem
 NumericCVar<U32> g_shadowMappingPcfCVar(CVarSubsystem::kRenderer, "ShadowMappingPcf", (ANKI_PLATFORM_MOBILE) ? 0 : 1, 0, 1,
 										"Shadow PCF (CVarSubsystem::kRenderer, 0: off, 1: on)");
 
+static BoolCVar g_shadowCascadeCachingCVar(CVarSubsystem::kRenderer, "ShadowCascadeCaching", false,
+										   "Cache the far cascades of the directional light and update them less often");
+static NumericCVar<U8> g_shadowCascadeFirstCachedCVar(CVarSubsystem::kRenderer, "ShadowCascadeFirstCached", 1, 0, kMaxShadowCascades,
+													  "The first cascade that will be cached. The ones before it are rendered every frame");
+static NumericCVar<U32> g_shadowCascadeCacheMaxAgeCVar(CVarSubsystem::kRenderer, "ShadowCascadeCacheMaxAge", 256, 0, kMaxU32,
+													   "Redraw a cached cascade after that many frames. 0 means never");
+
 static StatCounter g_tilesAllocatedStatVar(StatCategory::kRenderer, "Shadow tiles (re)allocated", StatFlag::kMainThreadUpdates);
+static StatCounter g_cascadesRedrawnStatVar(StatCategory::kRenderer, "Shadow cascades redrawn",
+											StatFlag::kMainThreadUpdates | StatFlag::kZeroEveryFrame);
+static StatCounter g_cascadesScrolledStatVar(StatCategory::kRenderer, "Shadow cascades scrolled",
+											 StatFlag::kMainThreadUpdates | StatFlag::kZeroEveryFrame);
+static StatCounter g_cascadeTexelsRedrawnStatVar(StatCategory::kRenderer, "Shadow cascade texels redrawn",
+												 StatFlag::kMainThreadUpdates | StatFlag::kZeroEveryFrame);
+
+/// A cached cascade follows the camera when it drifts that many texels even if it's not its time to update.
+static constexpr U32 kCascadeMaxDriftTexels = 8;
 
 class LightHash
 {
@@ -100,7 +116,11 @@ Error ShadowMapping::initInternal()
 	m_tileAlloc.init(m_tileCountBothAxis, m_tileCountBothAxis, kTileAllocHierarchyCount, true);
 
 	ANKI_CHECK(loadShaderProgram("ShaderBinaries/ShadowMappingClearDepth.ankiprogbin", m_clearDepthProg, m_clearDepthGrProg));
-	ANKI_CHECK(loadShaderProgram("ShaderBinaries/ShadowMappingVetVisibility.ankiprogbin", m_vetVisibilityProg, m_vetVisibilityGrProg));
+	ANKI_CHECK(loadShaderProgram("ShaderBinaries/ShadowMappingVetVisibility.ankiprogbin", {{"DIRECTIONAL_CASCADE", 0}}, m_vetVisibilityProg,
+								 m_vetVisibilityGrProg));
+	ANKI_CHECK(loadShaderProgram("ShaderBinaries/ShadowMappingVetVisibility.ankiprogbin", {{"DIRECTIONAL_CASCADE", 1}}, m_vetVisibilityProg,
+								 m_vetCascadeVisibilityGrProg));
+	ANKI_CHECK(loadShaderProgram("ShaderBinaries/ShadowMappingScrollDepth.ankiprogbin", m_scrollDepthProg, m_scrollDepthGrProg));
 
 	for(U32 i = 0; i < kMaxShadowCascades; ++i)
 	{
@@ -114,6 +134,20 @@ Error ShadowMapping::initInternal()
 		m_cascadeHzbRtDescrs[i] = getRenderer().create2DRenderTargetDescription(size.x(), size.y(), Format::kR32_Sfloat, name);
 		m_cascadeHzbRtDescrs[i].m_mipmapCount = U8(computeMaxMipmapCount2d(m_cascadeHzbRtDescrs[i].m_width, m_cascadeHzbRtDescrs[i].m_height));
 		m_cascadeHzbRtDescrs[i].bake();
+
+		name.sprintf("DirLight scroll #%d", i);
+		m_cascadeScrollRtDescrs[i] = getRenderer().create2DRenderTargetDescription(cascadeResolution, cascadeResolution, Format::kD16_Unorm, name);
+		m_cascadeScrollRtDescrs[i].bake();
+	}
+
+	// Cached cascades
+	{
+		BufferInitInfo buffInit("ShadowCascadeHashes");
+		buffInit.m_size = sizeof(U32) * kMaxShadowCascades;
+		buffInit.m_usage = BufferUsageBit::kStorageComputeWrite | BufferUsageBit::kStorageComputeRead | BufferUsageBit::kTransferDestination;
+		m_cascadeHashesBuffer = GrManager::getSingleton().newBuffer(buffInit);
+
+		zeroBuffer(m_cascadeHashesBuffer.get());
 	}
 
 	return Error::kNone;
@@ -284,6 +318,7 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 	}
 
 	Array<UVec4, kMaxShadowCascades> dirLightAtlasViewports;
+	TileAllocatorResult2 dirLightTilesResult = TileAllocatorResult2::kAllocationFailed;
 	if(dirLight)
 	{
 		const U32 cascadeCount = g_shadowCascadeCountCVar.get();
@@ -295,8 +330,8 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 			hierarchies[cascade] = kTileAllocHierarchyCount - 1 - chooseDirectionalLightShadowCascadeDetail(cascade);
 		}
 
-		[[maybe_unused]] const TileAllocatorResult2 res = allocateAtlasTiles(kMaxU32, 0, cascadeCount, &hierarchies[0], &dirLightAtlasViewports[0]);
-		ANKI_ASSERT(!!(res & TileAllocatorResult2::kAllocationSucceded) && "Dir light should never fail");
+		dirLightTilesResult = allocateAtlasTiles(kMaxU32, 0, cascadeCount, &hierarchies[0], &dirLightAtlasViewports[0]);
+		ANKI_ASSERT(!!(dirLightTilesResult & TileAllocatorResult2::kAllocationSucceded) && "Dir light should never fail");
 	}
 
 	// Process the point lights first
@@ -498,6 +533,10 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 	{
 		const U32 cascadeCount = g_shadowCascadeCountCVar.get();
 
+		// The cascades starting from that one are cached
+		const U32 firstCachedCascade =
+			(g_shadowCascadeCachingCVar.get()) ? min<U32>(g_shadowCascadeFirstCachedCVar.get(), cascadeCount) : cascadeCount;
+
 		// Compute the view projection matrices
 		Array<F32, kMaxShadowCascades> cascadeDistances;
 		static_assert(kMaxShadowCascades == 4);
@@ -509,21 +548,69 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 		Array<Mat4, kMaxShadowCascades> cascadeViewProjMats;
 		Array<Mat3x4, kMaxShadowCascades> cascadeViewMats;
 		Array<Mat4, kMaxShadowCascades> cascadeProjMats;
+		Array<Sphere, kMaxShadowCascades> cascadeSpheres;
 		dirLight->computeCascadeFrustums(mainCam.getFrustum(), {&cascadeDistances[0], cascadeCount}, {&cascadeProjMats[0], cascadeCount},
-										 {&cascadeViewMats[0], cascadeCount});
+										 {&cascadeViewMats[0], cascadeCount}, {&cascadeSpheres[0], cascadeCount});
+
+		// Decide what to do with the cached cascades. They don't follow the camera every frame so they have their own matrices
+		Array<ShadowCascadeUpdateInfo, kMaxShadowCascades> cascadeUpdates;
+		BufferView cascadeRedrawsBuffer;
+		if(firstCachedCascade < cascadeCount)
+		{
+			if(!(dirLightTilesResult & TileAllocatorResult2::kTileCached))
+			{
+				// Someone else might have rendered to the tiles
+				m_cascadeCache.invalidateAll();
+			}
+
+			// Gather the stats of the cascades the GPU decided to redraw some frames ago
+			DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> redraws(&getRenderer().getFrameMemoryPool());
+			getRenderer().getReadbackManager().readMostRecentData(m_cascadeRedrawsReadback, redraws);
+			for(U32 cascade = firstCachedCascade; cascade < min(cascadeCount, redraws.getSize()); ++cascade)
+			{
+				if(redraws[cascade])
+				{
+					g_cascadesRedrawnStatVar.increment(1);
+					g_cascadeTexelsRedrawnStatVar.increment(dirLightAtlasViewports[cascade].z() * dirLightAtlasViewports[cascade].w());
+				}
+			}
+
+			getRenderer().getReadbackManager().allocateData(m_cascadeRedrawsReadback, sizeof(U32) * kMaxShadowCascades, cascadeRedrawsBuffer);
+
+			const Array<Vec3, 2> sceneBounds = SceneGraph::getSingleton().getSceneBounds();
+			for(U32 cascade = firstCachedCascade; cascade < cascadeCount; ++cascade)
+			{
+				// The further the cascade the less often it follows the camera
+				const U32 updateInterval = 1u << (cascade - firstCachedCascade + 1);
+				m_cascadeCache.setCascadeParameters(cascade, updateInterval, kCascadeMaxDriftTexels, g_shadowCascadeCacheMaxAgeCVar.get());
+
+				const ShadowCascadePlacement placement = ShadowCascadeCache::computePlacement(
+					dirLight->getDirection(), cascadeSpheres[cascade].getCenter().xyz(), cascadeSpheres[cascade].getRadius(), sceneBounds,
+					dirLightAtlasViewports[cascade], kCascadeMaxDriftTexels);
+
+				cascadeUpdates[cascade] = m_cascadeCache.update(cascade, placement, getRenderer().getFrameCount());
+				cascadeUpdates[cascade].m_placement.computeMatrices(cascadeViewMats[cascade], cascadeProjMats[cascade]);
+			}
+		}
+		else
+		{
+			m_cascadeCache.invalidateAll();
+		}
+
 		for(U cascade = 0; cascade < cascadeCount; ++cascade)
 		{
 			cascadeViewProjMats[cascade] = cascadeProjMats[cascade] * Mat4(cascadeViewMats[cascade], Vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		}
 
-		// HZB generation
+		// HZB generation. Only for the cascades that are rendered every frame. The cached cascades need the casters of receivers the camera
+		// doesn't see yet
 		HzbDirectionalLightInput hzbGenIn;
-		hzbGenIn.m_cascadeCount = cascadeCount;
+		hzbGenIn.m_cascadeCount = firstCachedCascade;
 		hzbGenIn.m_depthBufferRt = getRenderer().getGBuffer().getDepthRt();
 		hzbGenIn.m_depthBufferRtSize = getRenderer().getInternalResolution();
 		hzbGenIn.m_cameraProjectionMatrix = ctx.m_matrices.m_projection;
 		hzbGenIn.m_cameraInverseViewProjectionMatrix = ctx.m_matrices.m_invertedViewProjection;
-		for(U cascade = 0; cascade < cascadeCount; ++cascade)
+		for(U cascade = 0; cascade < firstCachedCascade; ++cascade)
 		{
 			hzbGenIn.m_cascades[cascade].m_hzbRt = rgraph.newRenderTarget(m_cascadeHzbRtDescrs[cascade]);
 			hzbGenIn.m_cascades[cascade].m_hzbRtSize = UVec2(m_cascadeHzbRtDescrs[cascade].m_width, m_cascadeHzbRtDescrs[cascade].m_height);
@@ -532,11 +619,27 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 			hzbGenIn.m_cascades[cascade].m_cascadeMaxDistance = cascadeDistances[cascade];
 		}
 
-		getRenderer().getHzbGenerator().populateRenderGraphDirectionalLight(hzbGenIn, rgraph);
+		if(hzbGenIn.m_cascadeCount)
+		{
+			getRenderer().getHzbGenerator().populateRenderGraphDirectionalLight(hzbGenIn, rgraph);
+		}
 
 		// Create passes per cascade
 		for(U32 cascade = 0; cascade < cascadeCount; ++cascade)
 		{
+			// Update the texture matrix to point to the correct region in the atlas
+			ctx.m_dirLightTextureMatrices[cascade] = createSpotLightTextureMatrix(dirLightAtlasViewports[cascade]) * cascadeViewProjMats[cascade];
+
+			if(cascade >= firstCachedCascade)
+			{
+				processCachedCascade(ctx, cascade, cascadeUpdates[cascade], cascadeViewProjMats[cascade], cascadeViewMats[cascade],
+									 cascadeRedrawsBuffer);
+				continue;
+			}
+
+			g_cascadesRedrawnStatVar.increment(1);
+			g_cascadeTexelsRedrawnStatVar.increment(dirLightAtlasViewports[cascade].z() * dirLightAtlasViewports[cascade].w());
+
 			// Vis testing
 			const Array<F32, kMaxLodCount - 1> lodDistances = {g_lod0MaxDistanceCVar.get(), g_lod1MaxDistanceCVar.get()};
 			FrustumGpuVisibilityInput visIn;
@@ -572,9 +675,6 @@ void ShadowMapping::processLights(RenderingContext& ctx)
 			createDrawShadowsPass(dirLightAtlasViewports[cascade], cascadeViewProjMats[cascade], cascadeViewMats[cascade], visOut, meshletVisOut, {},
 								  hzbGenIn.m_cascades[cascade].m_hzbRt,
 								  generateTempPassName("Shadows: Dir light lightIdx:%u cascade:%u", lightIdx, cascade), rgraph);
-
-			// Update the texture matrix to point to the correct region in the atlas
-			ctx.m_dirLightTextureMatrices[cascade] = createSpotLightTextureMatrix(dirLightAtlasViewports[cascade]) * cascadeViewProjMats[cascade];
 		}
 	}
 }
@@ -591,13 +691,13 @@ BufferView ShadowMapping::createVetVisibilityPass(CString passName, const LightC
 	// The shader doesn't actually write to the handle but have it as a write dependency for the drawer to correctly wait for this pass
 	pass.newBufferDependency(visOut.m_dependency, BufferUsageBit::kStorageComputeWrite);
 
-	pass.setWork([this, &lightc, hashBuff = visOut.m_visiblesHashBuffer, mdiBuff = visOut.m_legacy.m_mdiDrawCountsBuffer, clearTileIndirectArgs,
+	pass.setWork([this, lightIndex = UVec4(lightc.getGpuSceneLightAllocation().getIndex(), 0, 0, 0), hashBuff = visOut.m_visiblesHashBuffer,
+				  mdiBuff = visOut.m_legacy.m_mdiDrawCountsBuffer, clearTileIndirectArgs,
 				  taskShadersIndirectArgs = visOut.m_mesh.m_taskShaderIndirectArgsBuffer](RenderPassWorkContext& rpass) {
 		CommandBuffer& cmdb = *rpass.m_commandBuffer;
 
 		cmdb.bindShaderProgram(m_vetVisibilityGrProg.get());
 
-		const UVec4 lightIndex(lightc.getGpuSceneLightAllocation().getIndex());
 		cmdb.setPushConstants(&lightIndex, sizeof(lightIndex));
 
 		cmdb.bindStorageBuffer(ANKI_REG(t0), hashBuff);
@@ -614,6 +714,191 @@ BufferView ShadowMapping::createVetVisibilityPass(CString passName, const LightC
 	return clearTileIndirectArgs;
 }
 
+BufferView ShadowMapping::createVetCascadeVisibilityPass(CString passName, U32 cascade, Bool forceRedraw, Bool ignoreRenderablesChange,
+														 const BufferView& redrawsBuffer, const GpuVisibilityOutput& visOut,
+														 RenderGraphBuilder& rgraph) const
+{
+	const BufferView clearTileIndirectArgs = GpuVisibleTransientMemoryPool::getSingleton().allocate(sizeof(DrawIndirectArgs));
+
+	NonGraphicsRenderPass& pass = rgraph.newNonGraphicsRenderPass(passName);
+
+	// Same as createVetVisibilityPass
+	pass.newBufferDependency(visOut.m_dependency, BufferUsageBit::kStorageComputeWrite);
+
+	pass.setWork([this, unis = UVec4(cascade, forceRedraw, ignoreRenderablesChange, 0), hashBuff = visOut.m_visiblesHashBuffer,
+				  mdiBuff = visOut.m_legacy.m_mdiDrawCountsBuffer, redrawsBuffer, clearTileIndirectArgs,
+				  taskShadersIndirectArgs = visOut.m_mesh.m_taskShaderIndirectArgsBuffer](RenderPassWorkContext& rpass) {
+		CommandBuffer& cmdb = *rpass.m_commandBuffer;
+
+		cmdb.bindShaderProgram(m_vetCascadeVisibilityGrProg.get());
+
+		cmdb.setPushConstants(&unis, sizeof(unis));
+
+		cmdb.bindStorageBuffer(ANKI_REG(t0), hashBuff);
+		cmdb.bindStorageBuffer(ANKI_REG(u0), mdiBuff);
+		cmdb.bindStorageBuffer(ANKI_REG(u1), BufferView(m_cascadeHashesBuffer.get()));
+		cmdb.bindStorageBuffer(ANKI_REG(u2), redrawsBuffer);
+		cmdb.bindStorageBuffer(ANKI_REG(u3), clearTileIndirectArgs);
+		cmdb.bindStorageBuffer(ANKI_REG(u4), taskShadersIndirectArgs);
+
+		ANKI_ASSERT(RenderStateBucketContainer::getSingleton().getBucketCount(RenderingTechnique::kDepth) <= 64 && "TODO");
+		cmdb.dispatchCompute(1, 1, 1);
+	});
+
+	return clearTileIndirectArgs;
+}
+
+void ShadowMapping::createScrollCascadePasses(U32 cascade, const UVec4& atlasViewport, IVec2 scroll, RenderGraphBuilder& rgraph)
+{
+	const U32 resolution = atlasViewport.z();
+	ANKI_ASSERT(m_cascadeScrollRtDescrs[cascade].m_width == resolution);
+	const IVec2 tileOrigin(atlasViewport.xy());
+
+	// Can't read and write the atlas at the same time so move the content to a temp RT first. The texels that scroll in from outside the tile
+	// get the far depth
+	const RenderTargetHandle scrollRt = rgraph.newRenderTarget(m_cascadeScrollRtDescrs[cascade]);
+	{
+		GraphicsRenderPass& pass = rgraph.newGraphicsRenderPass(generateTempPassName("Shadows: Dir light scroll cascade:%u", cascade));
+
+		GraphicsRenderPassTargetDesc rti(scrollRt);
+		rti.m_loadOperation = RenderTargetLoadOperation::kDontCare;
+		rti.m_subresource.m_depthStencilAspect = DepthStencilAspectBit::kDepth;
+		pass.setRenderpassInfo({}, &rti, 0, 0, resolution, resolution);
+
+		pass.newTextureDependency(scrollRt, TextureUsageBit::kFramebufferWrite);
+		pass.newTextureDependency(m_runCtx.m_rt, TextureUsageBit::kSampledFragment);
+
+		const Array<IVec4, 2> unis = {IVec4(tileOrigin + scroll, 0, 0), IVec4(tileOrigin, tileOrigin + I32(resolution))};
+		pass.setWork([this, unis, resolution](RenderPassWorkContext& rgraphCtx) {
+			CommandBuffer& cmdb = *rgraphCtx.m_commandBuffer;
+
+			cmdb.bindShaderProgram(m_scrollDepthGrProg.get());
+			cmdb.setViewport(0, 0, resolution, resolution);
+			cmdb.setDepthCompareOperation(CompareOperation::kAlways);
+
+			rgraphCtx.bindTexture(ANKI_REG(t0), m_runCtx.m_rt);
+			cmdb.setPushConstants(&unis, sizeof(unis));
+
+			cmdb.draw(PrimitiveTopology::kTriangles, 3);
+
+			cmdb.setDepthCompareOperation(CompareOperation::kLess);
+		});
+	}
+
+	// Copy it back
+	{
+		GraphicsRenderPass& pass = rgraph.newGraphicsRenderPass(generateTempPassName("Shadows: Dir light scroll back cascade:%u", cascade));
+
+		GraphicsRenderPassTargetDesc rti(m_runCtx.m_rt);
+		rti.m_loadOperation = RenderTargetLoadOperation::kDontCare;
+		rti.m_subresource.m_depthStencilAspect = DepthStencilAspectBit::kDepth;
+		pass.setRenderpassInfo({}, &rti, atlasViewport[0], atlasViewport[1], atlasViewport[2], atlasViewport[3]);
+
+		pass.newTextureDependency(m_runCtx.m_rt, TextureUsageBit::kFramebufferWrite);
+		pass.newTextureDependency(scrollRt, TextureUsageBit::kSampledFragment);
+
+		const Array<IVec4, 2> unis = {IVec4(-tileOrigin, 0, 0), IVec4(0, 0, I32(resolution), I32(resolution))};
+		pass.setWork([this, unis, scrollRt, atlasViewport](RenderPassWorkContext& rgraphCtx) {
+			CommandBuffer& cmdb = *rgraphCtx.m_commandBuffer;
+
+			cmdb.bindShaderProgram(m_scrollDepthGrProg.get());
+			cmdb.setViewport(atlasViewport[0], atlasViewport[1], atlasViewport[2], atlasViewport[3]);
+			cmdb.setDepthCompareOperation(CompareOperation::kAlways);
+
+			rgraphCtx.bindTexture(ANKI_REG(t0), scrollRt);
+			cmdb.setPushConstants(&unis, sizeof(unis));
+
+			cmdb.draw(PrimitiveTopology::kTriangles, 3);
+
+			cmdb.setDepthCompareOperation(CompareOperation::kLess);
+		});
+	}
+}
+
+void ShadowMapping::processCachedCascade(RenderingContext& ctx, U32 cascade, const ShadowCascadeUpdateInfo& update, const Mat4& viewProjMat,
+										 const Mat3x4& viewMat, const BufferView& redrawsBuffer)
+{
+	RenderGraphBuilder& rgraph = ctx.m_renderGraphDescr;
+	const UVec4& atlasViewport = update.m_placement.m_atlasViewport;
+	const Array<F32, kMaxLodCount - 1> lodDistances = {g_lod0MaxDistanceCVar.get(), g_lod1MaxDistanceCVar.get()};
+
+	auto populateVisibility = [&](CString passesName, const Mat4& visViewProjMat, UVec2 viewportSize, Bool hashVisibles, GpuVisibilityOutput& visOut,
+								  BufferView* clearTileIndirectArgs, GpuMeshletVisibilityOutput& meshletVisOut) {
+		FrustumGpuVisibilityInput visIn;
+		visIn.m_passesName = passesName;
+		visIn.m_technique = RenderingTechnique::kDepth;
+		visIn.m_viewProjectionMatrix = visViewProjMat;
+		visIn.m_lodReferencePoint = ctx.m_matrices.m_cameraTransform.getTranslationPart().xyz();
+		visIn.m_lodDistances = lodDistances;
+		visIn.m_rgraph = &rgraph;
+		visIn.m_viewportSize = viewportSize;
+		visIn.m_hashVisibles = hashVisibles;
+
+		getRenderer().getGpuVisibility().populateRenderGraph(visIn, visOut);
+
+		if(clearTileIndirectArgs)
+		{
+			*clearTileIndirectArgs = createVetCascadeVisibilityPass(generateTempPassName("Shadows: Vet dir light cascade:%u", cascade), cascade,
+																	update.m_update == ShadowCascadeUpdate::kRedraw,
+																	update.m_update == ShadowCascadeUpdate::kScroll, redrawsBuffer, visOut, rgraph);
+		}
+
+		if(getRenderer().runSoftwareMeshletRendering())
+		{
+			GpuMeshletVisibilityInput meshIn;
+			meshIn.m_passesName = passesName;
+			meshIn.m_technique = RenderingTechnique::kDepth;
+			meshIn.m_viewProjectionMatrix = visViewProjMat;
+			meshIn.m_cameraTransform = viewMat.getInverseTransformation();
+			meshIn.m_viewportSize = viewportSize;
+			meshIn.m_rgraph = &rgraph;
+			meshIn.fillBuffers(visOut);
+
+			getRenderer().getGpuVisibility().populateRenderGraph(meshIn, meshletVisOut);
+		}
+	};
+
+	// Move the old content and render the border that got exposed
+	if(update.m_update == ShadowCascadeUpdate::kScroll)
+	{
+		g_cascadesScrolledStatVar.increment(1);
+
+		createScrollCascadePasses(cascade, atlasViewport, update.m_scroll, rgraph);
+
+		const F32 resolution = F32(atlasViewport.z());
+		for(U32 i = 0; i < update.m_dirtyRectCount; ++i)
+		{
+			const UVec4& rect = update.m_dirtyRects[i];
+			g_cascadeTexelsRedrawnStatVar.increment(rect.z() * rect.w());
+
+			// Crop the projection to the rect
+			const Vec2 scale = Vec2(resolution) / Vec2(rect.zw());
+			const Vec2 offset = -((Vec2(rect.xy()) * 2.0f + Vec2(rect.zw())) / resolution - 1.0f) * scale;
+			const Mat4 cropMat(scale.x(), 0.0f, 0.0f, offset.x(), 0.0f, scale.y(), 0.0f, offset.y(), 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+			const Mat4 rectViewProjMat = cropMat * viewProjMat;
+
+			GpuVisibilityOutput visOut;
+			GpuMeshletVisibilityOutput meshletVisOut;
+			populateVisibility(generateTempPassName("Shadows: Dir light cascade:%u border:%u", cascade, i), rectViewProjMat, rect.zw(), false, visOut,
+							   nullptr, meshletVisOut);
+
+			const UVec4 viewport(atlasViewport.xy() + rect.xy(), rect.zw());
+			createDrawShadowsPass(viewport, rectViewProjMat, viewMat, visOut, meshletVisOut, {}, {},
+								  generateTempPassName("Shadows: Dir light cascade:%u border:%u", cascade, i), rgraph);
+		}
+	}
+
+	// The whole cascade. The vet pass will skip the drawing if it's not forced and the casters didn't change
+	GpuVisibilityOutput visOut;
+	GpuMeshletVisibilityOutput meshletVisOut;
+	BufferView clearTileIndirectArgs;
+	populateVisibility(generateTempPassName("Shadows: Dir light cascade:%u", cascade), viewProjMat, atlasViewport.zw(), true, visOut,
+					   &clearTileIndirectArgs, meshletVisOut);
+
+	createDrawShadowsPass(atlasViewport, viewProjMat, viewMat, visOut, meshletVisOut, clearTileIndirectArgs, {},
+						  generateTempPassName("Shadows: Dir light cascade:%u", cascade), rgraph);
+}
+
 void ShadowMapping::createDrawShadowsPass(const UVec4& viewport, const Mat4& viewProjMat, const Mat3x4& viewMat, const GpuVisibilityOutput& visOut,
 										  const GpuMeshletVisibilityOutput& meshletVisOut, const BufferView& clearTileIndirectArgs,
 										  const RenderTargetHandle hzbRt, CString passName, RenderGraphBuilder& rgraph)
@@ -658,7 +943,8 @@ void ShadowMapping::createDrawShadowsPass(ConstWeakArray<ShadowSubpassInfo> subp
 	// Create the pass
 	GraphicsRenderPass& pass = rgraph.newGraphicsRenderPass(passName);
 
-	const Bool loadFb = !(subpasses.getSize() == 1 && subpasses[0].m_clearTileIndirectArgs.isValid());
+	// A single subpass that draws unconditionally clears with the load operation. The rest clear with a draw
+	const Bool loadFb = !(subpasses.getSize() == 1 && !subpasses[0].m_clearTileIndirectArgs.isValid());
 
 	GraphicsRenderPassTargetDesc smRti(m_runCtx.m_rt);
 	smRti.m_loadOperation = (loadFb) ? RenderTargetLoadOperation::kLoad : RenderTargetLoadOperation::kClear;
@@ -9,6 +9,8 @@
 #include <AnKi/Gr.h>
 #include <AnKi/Resource/ImageResource.h>
 #include <AnKi/Renderer/Utils/TileAllocator.h>
+#include <AnKi/Renderer/Utils/ShadowCascadeCache.h>
+#include <AnKi/Renderer/Utils/Readback.h>
 
 namespace anki {
 
@@ -61,9 +63,21 @@ private:
 
 	ShaderProgramResourcePtr m_vetVisibilityProg;
 	ShaderProgramPtr m_vetVisibilityGrProg;
+	ShaderProgramPtr m_vetCascadeVisibilityGrProg;
+
+	ShaderProgramResourcePtr m_scrollDepthProg;
+	ShaderProgramPtr m_scrollDepthGrProg;
 
 	Array<RenderTargetDesc, kMaxShadowCascades> m_cascadeHzbRtDescrs;
 
+	/// @name Cached cascades
+	/// @{
+	ShadowCascadeCache m_cascadeCache;
+	BufferPtr m_cascadeHashesBuffer; ///< The hash of the visible renderables of each cascade.
+	MultiframeReadbackToken m_cascadeRedrawsReadback; ///< Which cascades the GPU redrawn.
+	Array<RenderTargetDesc, kMaxShadowCascades> m_cascadeScrollRtDescrs;
+	/// @}
+
 	class
 	{
 	public:
@@ -83,6 +97,14 @@ private:
 	BufferView createVetVisibilityPass(CString passName, const LightComponent& lightc, const GpuVisibilityOutput& visOut,
 									   RenderGraphBuilder& rgraph) const;
 
+	BufferView createVetCascadeVisibilityPass(CString passName, U32 cascade, Bool forceRedraw, Bool ignoreRenderablesChange,
+											  const BufferView& redrawsBuffer, const GpuVisibilityOutput& visOut, RenderGraphBuilder& rgraph) const;
+
+	void createScrollCascadePasses(U32 cascade, const UVec4& atlasViewport, IVec2 scroll, RenderGraphBuilder& rgraph);
+
+	void processCachedCascade(RenderingContext& ctx, U32 cascade, const ShadowCascadeUpdateInfo& update, const Mat4& viewProjMat,
+							  const Mat3x4& viewMat, const BufferView& redrawsBuffer);
+
 	void createDrawShadowsPass(const UVec4& viewport, const Mat4& viewProjMat, const Mat3x4& viewMat, const GpuVisibilityOutput& visOut,
 							   const GpuMeshletVisibilityOutput& meshletVisOut, const BufferView& clearTileIndirectArgs,
 							   const RenderTargetHandle hzbRt, CString passName, RenderGraphBuilder& rgraph);
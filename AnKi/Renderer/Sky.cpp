@@ -56,9 +56,10 @@ void Sky::populateRenderGraph(RenderingContext& ctx)
 {
 	ANKI_TRACE_SCOPED_EVENT(Sky);
 
-	if(!isEnabled())
+	m_runCtx = {};
+	m_runCtx.m_enabled = ctx.m_scene.m_skyboxExists && ctx.m_scene.m_skyboxType == SkyboxType::kGenerated && ctx.m_scene.m_directionalLightExists;
+	if(!m_runCtx.m_enabled)
 	{
-		m_runCtx = {};
 		return;
 	}
 
@@ -188,12 +189,4 @@ void Sky::populateRenderGraph(RenderingContext& ctx)
 	}
 }
 
-Bool Sky::isEnabled() const
-{
-	const SkyboxComponent* skyc = SceneGraph::getSingleton().getSkybox();
-	const LightComponent* dirLightc = SceneGraph::getSingleton().getDirectionalLight();
-
-	return skyc && skyc->getSkyboxType() == SkyboxType::kGenerated && dirLightc;
-}
-
 } // end namespace anki
@@ -39,7 +39,11 @@ public:
 		return m_runCtx.m_skyLutRt;
 	}
 
-	ANKI_PURE Bool isEnabled() const;
+	/// Valid after populateRenderGraph(). It doesn't access the scene so it's safe to call it while recording.
+	Bool isEnabled() const
+	{
+		return m_runCtx.m_enabled;
+	}
 
 public:
 	ShaderProgramResourcePtr m_prog;
@@ -66,6 +70,7 @@ public:
 	{
 	public:
 		RenderTargetHandle m_skyLutRt;
+		Bool m_enabled = false;
 	} m_runCtx;
 
 	Error initInternal();
@@ -22,9 +22,10 @@ Error UiStage::init()
 	return Error::kNone;
 }
 
-void UiStage::draw(U32 width, U32 height, CommandBuffer& cmdb)
+void UiStage::buildUi(U32 width, U32 height)
 {
-	if(SceneGraph::getSingleton().getComponentArrays().getUis().getSize() == 0)
+	m_uiBuilt = SceneGraph::getSingleton().getComponentArrays().getUis().getSize() > 0;
+	if(!m_uiBuilt)
 	{
 		// Early exit
 		return;
@@ -41,6 +42,16 @@ void UiStage::draw(U32 width, U32 height, CommandBuffer& cmdb)
 		comp.drawUi(m_canvas);
 	}
 
+	m_canvas->endBuilding();
+}
+
+void UiStage::draw(CommandBuffer& cmdb)
+{
+	if(!m_uiBuilt)
+	{
+		return;
+	}
+
 	m_canvas->appendToCommandBuffer(cmdb);
 
 	// UI messes with the state, restore it
@@ -20,11 +20,16 @@ class UiStage : public RendererObject
 public:
 	Error init();
 
-	void draw(U32 width, U32 height, CommandBuffer& cmdb);
+	/// Build the UI of the UI components. It's called when populating the render graph since it reads the scene.
+	void buildUi(U32 width, U32 height);
+
+	/// Draw what buildUi() built.
+	void draw(CommandBuffer& cmdb);
 
 private:
 	FontPtr m_font;
 	CanvasPtr m_canvas;
+	Bool m_uiBuilt = false;
 };
 /// @}
 
@@ -0,0 +1,130 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Renderer/Utils/ShadowCascadeCache.h>
+
+namespace anki {
+
+/// Quantize the depth range of the cascades so small changes of the scene bounds won't invalidate them.
+static constexpr F32 kDepthRangeQuantum = 16.0f;
+
+void ShadowCascadePlacement::computeMatrices(Mat3x4& viewMat, Mat4& projMat) const
+{
+	const F32 texelSize = getTexelSize();
+	const Vec3 xAxis = m_lightRotation.getXAxis();
+	const Vec3 yAxis = m_lightRotation.getYAxis();
+	const Vec3 zAxis = m_lightRotation.getZAxis();
+
+	const Vec3 eye = xAxis * (F32(m_texelPosition.x()) * texelSize) + yAxis * (F32(m_texelPosition.y()) * texelSize) + zAxis * m_eyeDepth;
+
+	const Transform cascadeTransform(eye.xyz0(), m_lightRotation, Vec4(1.0f, 1.0f, 1.0f, 0.0f));
+	viewMat = Mat3x4(Mat4(cascadeTransform.getInverse()));
+
+	projMat = Mat4::calculateOrthographicProjectionMatrix(m_radius, -m_radius, m_radius, -m_radius, kClusterObjectFrustumNearPlane, m_far);
+}
+
+ShadowCascadePlacement ShadowCascadeCache::computePlacement(const Vec3& lightDirection, const Vec3& center, F32 radius,
+															const Array<Vec3, 2>& sceneBounds, const UVec4& atlasViewport, U32 maxDriftTexels)
+{
+	const U32 resolution = atlasViewport.z();
+	ANKI_ASSERT(resolution > maxDriftTexels * 2);
+
+	ShadowCascadePlacement out;
+	out.m_atlasViewport = atlasViewport;
+
+	// Same as LightComponent::computeCascadeFrustums
+	const Vec3 zAxis = -lightDirection;
+	const Vec3 xAxis = Vec3(0.0f, 1.0f, 0.0f).cross(zAxis).getNormalized();
+	const Vec3 yAxis = zAxis.cross(xAxis).getNormalized();
+	out.m_lightRotation.setXAxis(xAxis);
+	out.m_lightRotation.setYAxis(yAxis);
+	out.m_lightRotation.setZAxis(zAxis);
+	out.m_lightRotation.setTranslationPart(Vec3(0.0f));
+
+	// Make it a bit bigger to cover the parts the camera sees while the cascade lags behind
+	out.m_radius = radius * F32(resolution) / F32(resolution - maxDriftTexels * 2);
+
+	// Snap the center to the texels
+	const F32 texelSize = out.getTexelSize();
+	out.m_texelPosition.x() = I32(std::round(center.dot(xAxis) / texelSize));
+	out.m_texelPosition.y() = I32(std::round(center.dot(yAxis) / texelSize));
+
+	// The depth range covers the whole scene so it doesn't depend on the camera
+	F32 minDepth = kMaxF32;
+	F32 maxDepth = kMinF32;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const Vec3 corner((i & 1) ? sceneBounds[1].x() : sceneBounds[0].x(), (i & 2) ? sceneBounds[1].y() : sceneBounds[0].y(),
+						  (i & 4) ? sceneBounds[1].z() : sceneBounds[0].z());
+		const F32 depth = corner.dot(zAxis);
+		minDepth = min(minDepth, depth);
+		maxDepth = max(maxDepth, depth);
+	}
+
+	out.m_eyeDepth = std::ceil((maxDepth + kDepthRangeQuantum) / kDepthRangeQuantum) * kDepthRangeQuantum;
+	out.m_far = out.m_eyeDepth - std::floor(minDepth / kDepthRangeQuantum) * kDepthRangeQuantum;
+
+	return out;
+}
+
+ShadowCascadeUpdateInfo ShadowCascadeCache::update(U32 cascade, const ShadowCascadePlacement& wantedPlacement, U64 frame)
+{
+	Cascade& c = m_cascades[cascade];
+	ShadowCascadeUpdateInfo out;
+
+	const U32 resolution = wantedPlacement.m_atlasViewport.z();
+	const IVec2 scroll = wantedPlacement.m_texelPosition - c.m_placement.m_texelPosition;
+	const U32 drift = U32(max(absolute(scroll.x()), absolute(scroll.y())));
+
+	const Bool tooOld = c.m_maxAge > 0 && frame - c.m_lastRedrawFrame >= c.m_maxAge;
+	if(!c.m_valid || !c.m_placement.isCompatible(wantedPlacement) || tooOld || drift * 2 >= resolution)
+	{
+		// Render everything. Scrolling more than half the cascade costs more than rendering it whole
+		c.m_placement = wantedPlacement;
+		c.m_lastRedrawFrame = frame;
+		c.m_lastMoveFrame = frame;
+		c.m_valid = true;
+
+		out.m_placement = wantedPlacement;
+		out.m_update = ShadowCascadeUpdate::kRedraw;
+		return out;
+	}
+
+	const Bool move = drift > 0 && (drift > c.m_maxDriftTexels || frame - c.m_lastMoveFrame >= c.m_updateInterval);
+	if(!move)
+	{
+		out.m_placement = c.m_placement;
+		out.m_update = ShadowCascadeUpdate::kReuse;
+		return out;
+	}
+
+	// Scroll. The old content moves by -scroll texels and the border it leaves behind needs rendering
+	c.m_placement = wantedPlacement;
+	c.m_lastMoveFrame = frame;
+
+	out.m_placement = wantedPlacement;
+	out.m_update = ShadowCascadeUpdate::kScroll;
+	out.m_scroll = scroll;
+
+	const U32 absX = U32(absolute(scroll.x()));
+	const U32 absY = U32(absolute(scroll.y()));
+	if(absX)
+	{
+		const U32 x = (scroll.x() > 0) ? resolution - absX : 0;
+		out.m_dirtyRects[out.m_dirtyRectCount++] = UVec4(x, 0, absX, resolution);
+	}
+
+	if(absY)
+	{
+		// Skip the columns the previous rect covers
+		const U32 x = (scroll.x() < 0) ? absX : 0;
+		const U32 y = (scroll.y() > 0) ? resolution - absY : 0;
+		out.m_dirtyRects[out.m_dirtyRectCount++] = UVec4(x, y, resolution - absX, absY);
+	}
+
+	return out;
+}
+
+} // end namespace anki
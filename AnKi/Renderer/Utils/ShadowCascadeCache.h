@@ -0,0 +1,124 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Renderer/Common.h>
+
+namespace anki {
+
+/// @addtogroup renderer
+/// @{
+
+/// How a cached directional light cascade should be updated.
+enum class ShadowCascadeUpdate : U8
+{
+	kRedraw, ///< Render the whole cascade.
+	kScroll, ///< Move the cached content and render the newly exposed border.
+	kReuse ///< Keep the cached content. Casters that moved might still trigger a redraw on the GPU.
+};
+
+/// Where a directional light cascade is in light space. The position is snapped to the texels of the shadow map so moving the cascade moves its
+/// content by whole texels.
+class ShadowCascadePlacement
+{
+public:
+	Mat3x4 m_lightRotation = Mat3x4::getIdentity();
+	F32 m_radius = 0.0f; ///< Half the size of the orthographic projection.
+	F32 m_eyeDepth = 0.0f; ///< The position of the eye on the light's Z axis.
+	F32 m_far = 0.0f;
+	IVec2 m_texelPosition = IVec2(0); ///< The position of the center of the cascade on the light's XY plane in texels.
+	UVec4 m_atlasViewport = UVec4(0u); ///< The tile of the shadow atlas.
+
+	F32 getTexelSize() const
+	{
+		ANKI_ASSERT(m_atlasViewport.z() > 0);
+		return 2.0f * m_radius / F32(m_atlasViewport.z());
+	}
+
+	/// Two placements are compatible if they only differ in their position.
+	Bool isCompatible(const ShadowCascadePlacement& b) const
+	{
+		return m_lightRotation == b.m_lightRotation && m_radius == b.m_radius && m_eyeDepth == b.m_eyeDepth && m_far == b.m_far
+			   && m_atlasViewport == b.m_atlasViewport;
+	}
+
+	void computeMatrices(Mat3x4& viewMat, Mat4& projMat) const;
+};
+
+/// The result of ShadowCascadeCache::update.
+class ShadowCascadeUpdateInfo
+{
+public:
+	ShadowCascadePlacement m_placement; ///< Render and sample the cascade using this placement.
+	ShadowCascadeUpdate m_update = ShadowCascadeUpdate::kRedraw;
+
+	/// Only for kScroll. The texel (x, y) of the tile will get its content from the texel (x, y) + m_scroll of the old content.
+	IVec2 m_scroll = IVec2(0);
+
+	/// Only for kScroll. The parts of the tile that need rendering. In texels relative to the tile (x, y, width, height).
+	Array<UVec4, 2> m_dirtyRects;
+	U32 m_dirtyRectCount = 0;
+};
+
+/// Decides how the cached directional light cascades are updated. It only does bookkeeping so it can be tested without a GPU.
+class ShadowCascadeCache
+{
+public:
+	/// @param updateInterval The cascade follows the camera once every that many frames.
+	/// @param maxDriftTexels Follow the camera immediately if it drifted more than that.
+	/// @param maxAge Redraw the cascade after that many frames even if nothing changed. Zero means never.
+	void setCascadeParameters(U32 cascade, U32 updateInterval, U32 maxDriftTexels, U32 maxAge)
+	{
+		ANKI_ASSERT(updateInterval > 0);
+		Cascade& c = m_cascades[cascade];
+		c.m_updateInterval = updateInterval;
+		c.m_maxDriftTexels = maxDriftTexels;
+		c.m_maxAge = maxAge;
+	}
+
+	/// Compute the placement a cascade wants to have this frame.
+	/// @param lightDirection The direction of the light.
+	/// @param center The center of the bounding sphere of the cascade.
+	/// @param radius The radius of the bounding sphere of the cascade.
+	/// @param sceneBounds The min and max of the scene. They decide the depth range of the cascade.
+	/// @param maxDriftTexels Enlarge the cascade by that much to cover the camera when the cascade lags behind.
+	static ShadowCascadePlacement computePlacement(const Vec3& lightDirection, const Vec3& center, F32 radius, const Array<Vec3, 2>& sceneBounds,
+												   const UVec4& atlasViewport, U32 maxDriftTexels);
+
+	/// Decide what will happen to a cascade this frame.
+	ShadowCascadeUpdateInfo update(U32 cascade, const ShadowCascadePlacement& wantedPlacement, U64 frame);
+
+	void invalidate(U32 cascade)
+	{
+		m_cascades[cascade].m_valid = false;
+	}
+
+	void invalidateAll()
+	{
+		for(U32 i = 0; i < kMaxShadowCascades; ++i)
+		{
+			invalidate(i);
+		}
+	}
+
+private:
+	class Cascade
+	{
+	public:
+		ShadowCascadePlacement m_placement; ///< The placement of the cached content.
+		U64 m_lastRedrawFrame = 0;
+		U64 m_lastMoveFrame = 0;
+		U32 m_updateInterval = 1;
+		U32 m_maxDriftTexels = 0;
+		U32 m_maxAge = 0;
+		Bool m_valid = false;
+	};
+
+	Array<Cascade, kMaxShadowCascades> m_cascades;
+};
+/// @}
+
+} // end namespace anki
@@ -9,9 +9,6 @@
 #include <AnKi/Resource/MeshResource.h>
 #include <AnKi/Resource/ImageResource.h>
 #include <AnKi/Shaders/Include/TraditionalDeferredShadingTypes.h>
-#include <AnKi/Scene/SceneGraph.h>
-#include <AnKi/Scene/Components/SkyboxComponent.h>
-#include <AnKi/Scene/Components/LightComponent.h>
 
 namespace anki {
 
@@ -53,11 +50,11 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 	cmdb.setViewport(info.m_viewport.x(), info.m_viewport.y(), info.m_viewport.z(), info.m_viewport.w());
 
 	// Skybox first
-	const SkyboxComponent* skyc = SceneGraph::getSingleton().getSkybox();
-	const LightComponent* dirLightc = SceneGraph::getSingleton().getDirectionalLight();
-	if(skyc && !(skyc->getSkyboxType() == SkyboxType::kGenerated && !dirLightc))
+	ANKI_ASSERT(info.m_scene);
+	const RenderingSceneSnapshot& scene = *info.m_scene;
+	if(scene.m_skyboxExists && !(scene.m_skyboxType == SkyboxType::kGenerated && !scene.m_directionalLightExists))
 	{
-		cmdb.bindShaderProgram(m_skyboxGrProgs[skyc->getSkyboxType()].get());
+		cmdb.bindShaderProgram(m_skyboxGrProgs[scene.m_skyboxType].get());
 
 		cmdb.bindSampler(ANKI_REG(s0), getRenderer().getSamplers().m_nearestNearestClamp.get());
 		rgraphCtx.bindTexture(ANKI_REG(t0), info.m_gbufferDepthRenderTarget, info.m_gbufferDepthRenderTargetSubresource);
@@ -65,17 +62,17 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		TraditionalDeferredSkyboxUniforms unis = {};
 		unis.m_invertedViewProjectionMat = info.m_invViewProjectionMatrix;
 		unis.m_cameraPos = info.m_cameraPosWSpace.xyz();
-		unis.m_scale = skyc->getImageScale();
-		unis.m_bias = skyc->getImageBias();
+		unis.m_scale = scene.m_skyboxImageScale;
+		unis.m_bias = scene.m_skyboxImageBias;
 
-		if(skyc->getSkyboxType() == SkyboxType::kSolidColor)
+		if(scene.m_skyboxType == SkyboxType::kSolidColor)
 		{
-			unis.m_solidColor = skyc->getSolidColor();
+			unis.m_solidColor = scene.m_skyboxSolidColor;
 		}
-		else if(skyc->getSkyboxType() == SkyboxType::kImage2D)
+		else if(scene.m_skyboxType == SkyboxType::kImage2D)
 		{
 			cmdb.bindSampler(ANKI_REG(s1), getRenderer().getSamplers().m_trilinearRepeatAniso.get());
-			cmdb.bindTexture(ANKI_REG(t1), TextureView(&skyc->getImageResource().getTexture(), TextureSubresourceDesc::all()));
+			cmdb.bindTexture(ANKI_REG(t1), TextureView(scene.m_skyboxImage.get(), TextureSubresourceDesc::all()));
 		}
 		else
 		{
@@ -97,7 +94,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		unis->m_invViewProjMat = info.m_invViewProjectionMatrix;
 		unis->m_cameraPos = info.m_cameraPosWSpace.xyz();
 
-		if(dirLightc)
+		if(scene.m_directionalLightExists)
 		{
 			unis->m_dirLight.m_effectiveShadowDistance = info.m_effectiveShadowDistance;
 			unis->m_dirLight.m_lightMatrix = info.m_dirLightMatrix;
@@ -123,7 +120,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		rgraphCtx.bindTexture(ANKI_REG(t5), info.m_gbufferDepthRenderTarget, info.m_gbufferDepthRenderTargetSubresource);
 
 		cmdb.bindSampler(ANKI_REG(s1), m_shadowSampler.get());
-		if(dirLightc && dirLightc->getShadowEnabled())
+		if(scene.m_directionalLightShadowEnabled)
 		{
 			ANKI_ASSERT(info.m_directionalLightShadowmapRenderTarget.isValid());
 			rgraphCtx.bindTexture(ANKI_REG(t6), info.m_directionalLightShadowmapRenderTarget,
@@ -41,6 +41,8 @@ public:
 	RenderTargetHandle m_skyLutRenderTarget;
 	BufferView m_globalRendererConsts;
 
+	const RenderingSceneSnapshot* m_scene = nullptr; ///< Skybox and directional light info.
+
 	RenderPassWorkContext* m_renderpassContext = nullptr;
 };
 
@@ -63,12 +63,12 @@ void VolumetricFog::populateRenderGraph(RenderingContext& ctx)
 
 		rgraphCtx.bindTexture(ANKI_REG(u0), m_runCtx.m_rt);
 
-		const SkyboxComponent* sky = SceneGraph::getSingleton().getSkybox();
+		const RenderingSceneSnapshot& scene = ctx.m_scene;
 
 		VolumetricFogUniforms regs;
-		regs.m_fogDiffuse = (sky) ? sky->getFogDiffuseColor() : Vec3(0.0f);
-		regs.m_fogScatteringCoeff = (sky) ? sky->getFogScatteringCoefficient() : 0.0f;
-		regs.m_fogAbsorptionCoeff = (sky) ? sky->getFogAbsorptionCoefficient() : 0.0f;
+		regs.m_fogDiffuse = (scene.m_skyboxExists) ? scene.m_fogDiffuseColor : Vec3(0.0f);
+		regs.m_fogScatteringCoeff = (scene.m_skyboxExists) ? scene.m_fogScatteringCoefficient : 0.0f;
+		regs.m_fogAbsorptionCoeff = (scene.m_skyboxExists) ? scene.m_fogAbsorptionCoefficient : 0.0f;
 		regs.m_near = ctx.m_cameraNear;
 		regs.m_far = ctx.m_cameraFar;
 		regs.m_zSplitCountf = F32(getRenderer().getZSplitCount());
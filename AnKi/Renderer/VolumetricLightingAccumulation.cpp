@@ -116,29 +116,29 @@ void VolumetricLightingAccumulation::populateRenderGraph(RenderingContext& ctx)
 							   getRenderer().getClusterBinning().getPackedObjectsBuffer(GpuSceneNonRenderableObjectType::kFogDensityVolume));
 		cmdb.bindStorageBuffer(ANKI_REG(t7), getRenderer().getClusterBinning().getClustersBuffer());
 
-		const SkyboxComponent* sky = SceneGraph::getSingleton().getSkybox();
+		const RenderingSceneSnapshot& scene = ctx.m_scene;
 
 		VolumetricLightingUniforms unis;
-		if(!sky)
+		if(!scene.m_skyboxExists)
 		{
 			unis.m_minHeight = 0.0f;
 			unis.m_oneOverMaxMinusMinHeight = 0.0f;
 			unis.m_densityAtMinHeight = 0.0f;
 			unis.m_densityAtMaxHeight = 0.0f;
 		}
-		else if(sky->getHeightOfMaxFogDensity() > sky->getHeightOfMaxFogDensity())
+		else if(scene.m_heightOfMaxFogDensity > scene.m_heightOfMaxFogDensity)
 		{
-			unis.m_minHeight = sky->getHeightOfMinFogDensity();
-			unis.m_oneOverMaxMinusMinHeight = 1.0f / (sky->getHeightOfMaxFogDensity() - unis.m_minHeight + kEpsilonf);
-			unis.m_densityAtMinHeight = sky->getMinFogDensity();
-			unis.m_densityAtMaxHeight = sky->getMaxFogDensity();
+			unis.m_minHeight = scene.m_heightOfMinFogDensity;
+			unis.m_oneOverMaxMinusMinHeight = 1.0f / (scene.m_heightOfMaxFogDensity - unis.m_minHeight + kEpsilonf);
+			unis.m_densityAtMinHeight = scene.m_minFogDensity;
+			unis.m_densityAtMaxHeight = scene.m_maxFogDensity;
 		}
 		else
 		{
-			unis.m_minHeight = sky->getHeightOfMaxFogDensity();
-			unis.m_oneOverMaxMinusMinHeight = 1.0f / (sky->getHeightOfMinFogDensity() - unis.m_minHeight + kEpsilonf);
-			unis.m_densityAtMinHeight = sky->getMaxFogDensity();
-			unis.m_densityAtMaxHeight = sky->getMinFogDensity();
+			unis.m_minHeight = scene.m_heightOfMaxFogDensity;
+			unis.m_oneOverMaxMinusMinHeight = 1.0f / (scene.m_heightOfMinFogDensity - unis.m_minHeight + kEpsilonf);
+			unis.m_densityAtMinHeight = scene.m_maxFogDensity;
+			unis.m_densityAtMaxHeight = scene.m_minFogDensity;
 		}
 		unis.m_volumeSize = UVec3(m_volumeSize);
 
@@ -7,19 +7,75 @@
 #include <AnKi/Resource/MeshBinaryLoader.h>
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Physics/PhysicsWorld.h>
+#include <AnKi/Util/Hash.h>
 
 namespace anki {
 
+U64 CpuMeshResource::computeBakedBvhMeshHash(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices)
+{
+	const U64 hash = computeHash(positions.getBegin(), positions.getSizeInBytes());
+	return appendHash(indices.getBegin(), indices.getSizeInBytes(), hash);
+}
+
 Error CpuMeshResource::load(const ResourceFilename& filename, [[maybe_unused]] Bool async)
 {
 	MeshBinaryLoader loader(&ResourceMemoryPool::getSingleton());
 
+	ResourceDynamicArray<U32> indices;
+	ResourceDynamicArray<Vec3> positions;
 	ANKI_CHECK(loader.load(filename));
-	ANKI_CHECK(loader.storeIndicesAndPosition(0, m_indices, m_positions));
+	ANKI_CHECK(loader.storeIndicesAndPosition(0, indices, positions));
 
-	// Create the collision shape
+	// Try to skip building the BVH of the static shape
 	const Bool convex = !!(loader.getHeader().m_flags & MeshBinaryFlag::kConvex);
-	m_physicsShape = PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(m_positions, m_indices, convex);
+	ResourceDynamicArray<U8> bvh;
+	if(!convex)
+	{
+		ANKI_CHECK(loadBakedBvh(filename, positions, indices, bvh));
+	}
+
+	// Create the collision shape
+	m_physicsShape = PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(positions, indices, convex, bvh);
+
+	return Error::kNone;
+}
+
+Error CpuMeshResource::loadBakedBvh(const ResourceFilename& meshFilename, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices,
+									ResourceDynamicArray<U8>& bvh)
+{
+	ResourceString bvhFilename = meshFilename;
+	bvhFilename.replaceAll(".ankimesh", ".ankibvh");
+	if(bvhFilename == meshFilename || !ResourceManager::getSingleton().getFilesystem().fileExists(bvhFilename))
+	{
+		return Error::kNone;
+	}
+
+	ResourceFilePtr file;
+	ANKI_CHECK(openFile(bvhFilename, file));
+
+	MeshBinaryCollisionHeader header;
+	ANKI_CHECK(file->read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], kMeshCollisionMagic, 8) != 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic: %s", bvhFilename.cstr());
+		return Error::kUserData;
+	}
+
+	if(header.m_meshHash != computeBakedBvhMeshHash(positions, indices))
+	{
+		ANKI_RESOURCE_LOGW("The baked BVH is out of date and it will be ignored. Re-export the mesh: %s", bvhFilename.cstr());
+		return Error::kNone;
+	}
+
+	if(header.m_bvhSize == 0)
+	{
+		ANKI_RESOURCE_LOGE("Empty BVH: %s", bvhFilename.cstr());
+		return Error::kUserData;
+	}
+
+	bvh.resize(header.m_bvhSize);
+	ANKI_CHECK(file->read(&bvh[0], bvh.getSizeInBytes()));
 
 	return Error::kNone;
 }
@@ -29,23 +29,27 @@ public:
 
 	ConstWeakArray<Vec3> getPositions() const
 	{
-		return m_positions;
+		return m_physicsShape->getPositions();
 	}
 
 	ConstWeakArray<U32> getIndices() const
 	{
-		return m_indices;
+		return m_physicsShape->getIndices();
 	}
 
-	const PhysicsCollisionShapePtr& getCollisionShape() const
+	PhysicsCollisionShapePtr getCollisionShape() const
 	{
-		return m_physicsShape;
+		return PhysicsCollisionShapePtr(m_physicsShape.get());
 	}
 
+	/// The hash that identifies the LOD 0 geometry a baked BVH was built from. See MeshBinaryCollisionHeader.
+	static U64 computeBakedBvhMeshHash(ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices);
+
 private:
-	ResourceDynamicArray<Vec3> m_positions;
-	ResourceDynamicArray<U32> m_indices;
-	PhysicsCollisionShapePtr m_physicsShape;
+	PhysicsPtr<PhysicsTriangleSoup> m_physicsShape; ///< It holds the positions and indices as well.
+
+	Error loadBakedBvh(const ResourceFilename& meshFilename, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices,
+					   ResourceDynamicArray<U8>& bvh);
 };
 /// @}
 
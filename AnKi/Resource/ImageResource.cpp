@@ -22,6 +22,7 @@ public:
 	U32 m_layerCount = 0;
 	TextureType m_texType;
 	TexturePtr m_tex;
+	TransferPriority m_priority = TransferPriority::kHigh;
 };
 
 /// Image upload async task.
@@ -50,6 +51,7 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 	{
 		task = ResourceManager::getSingleton().getAsyncLoader().newTask<TexUploadTask>();
 		ctx = &task->m_ctx;
+		ctx->m_priority = TransferPriority::kLow;
 	}
 	else
 	{
@@ -237,12 +239,44 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 
 Error ImageResource::load(LoadingContext& ctx)
 {
+	TransferGpuAllocator& transferAlloc = ResourceManager::getSingleton().getTransferGpuAllocator();
 	const U32 copyCount = ctx.m_layerCount * ctx.m_faces * ctx.m_loader.getMipmapCount();
 
-	for(U32 b = 0; b < copyCount; b += kMaxCopiesBeforeFlush)
+	// Don't hold too much of the transfer memory before submitting or the allocations of other threads will wait for too long
+	const PtrSize maxBatchSize = transferAlloc.getMaxSize() / 4;
+
+	auto computeAllocationSize = [&](U32 mip) {
+		if(ctx.m_texType == TextureType::k3D)
+		{
+			return computeVolumeSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getDepth() >> mip,
+									 ctx.m_tex->getFormat());
+		}
+		else
+		{
+			return computeSurfaceSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getFormat());
+		}
+	};
+
+	U32 begin = 0;
+	while(begin < copyCount)
 	{
-		const U32 begin = b;
-		const U32 end = min(copyCount, b + kMaxCopiesBeforeFlush);
+		// Batch as many surfaces as possible in a single submission
+		U32 end = begin;
+		PtrSize batchSize = 0;
+		while(end < copyCount && end - begin < kMaxCopiesBeforeFlush)
+		{
+			U32 mip, layer, face;
+			unflatten3dArrayIndex(ctx.m_layerCount, ctx.m_faces, ctx.m_loader.getMipmapCount(), end, layer, face, mip);
+
+			const PtrSize allocationSize = getAlignedRoundUp(TransferGpuAllocator::kGpuBufferAlignment, computeAllocationSize(mip));
+			if(end > begin && batchSize + allocationSize > maxBatchSize)
+			{
+				break;
+			}
+
+			batchSize += allocationSize;
+			++end;
+		}
 
 		CommandBufferInitInfo ci;
 		ci.m_flags = CommandBufferFlag::kGeneralWork | CommandBufferFlag::kSmallBatch;
@@ -271,29 +305,24 @@ Error ImageResource::load(LoadingContext& ctx)
 
 			PtrSize surfOrVolSize;
 			const void* surfOrVolData;
-			PtrSize allocationSize;
 
 			if(ctx.m_texType == TextureType::k3D)
 			{
 				const auto& vol = ctx.m_loader.getVolume(mip);
 				surfOrVolSize = vol.m_data.getSize();
 				surfOrVolData = &vol.m_data[0];
-
-				allocationSize = computeVolumeSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getDepth() >> mip,
-												   ctx.m_tex->getFormat());
 			}
 			else
 			{
 				const auto& surf = ctx.m_loader.getSurface(mip, face, layer);
 				surfOrVolSize = surf.m_data.getSize();
 				surfOrVolData = &surf.m_data[0];
-
-				allocationSize = computeSurfaceSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getFormat());
 			}
 
+			const PtrSize allocationSize = computeAllocationSize(mip);
 			ANKI_ASSERT(allocationSize >= surfOrVolSize);
 			TransferGpuAllocatorHandle& handle = handles[handleCount++];
-			ANKI_CHECK(ResourceManager::getSingleton().getTransferGpuAllocator().allocate(allocationSize, handle));
+			ANKI_CHECK(transferAlloc.allocate(allocationSize, handle, ctx.m_priority));
 			void* data = handle.getMappedMemory();
 			ANKI_ASSERT(data);
 
@@ -323,9 +352,11 @@ Error ImageResource::load(LoadingContext& ctx)
 
 		for(U i = 0; i < handleCount; ++i)
 		{
-			ResourceManager::getSingleton().getTransferGpuAllocator().release(handles[i], fence);
+			transferAlloc.release(handles[i], fence);
 		}
 		cmdb.reset(nullptr);
+
+		begin = end;
 	}
 
 	return Error::kNone;
@@ -56,7 +56,7 @@ public:
 	}
 
 private:
-	static constexpr U32 kMaxCopiesBeforeFlush = 4;
+	static constexpr U32 kMaxCopiesBeforeFlush = 16;
 
 	class TexUploadTask;
 	class LoadingContext;
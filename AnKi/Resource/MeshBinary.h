@@ -17,6 +17,7 @@ namespace anki {
 /// @{
 
 inline constexpr const char* kMeshMagic = "ANKIMES8";
+inline constexpr const char* kMeshCollisionMagic = "ANKIBVH1";
 
 enum class MeshBinaryFlag : U32
 {
@@ -295,6 +296,40 @@ public:
 	}
 };
 
+/// The header of the optional file with the baked collision BVH of a mesh. Same filename as the mesh but with .ankibvh extension. The BVH follows.
+class MeshBinaryCollisionHeader
+{
+public:
+	Array<U8, 8> m_magic;
+
+	/// Hash of the positions and indices of LOD 0 the BVH was built from.
+	U64 m_meshHash;
+
+	U32 m_bvhSize;
+	U32 m_padding;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(MeshBinaryCollisionHeader, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_meshHash", offsetof(MeshBinaryCollisionHeader, m_meshHash), self.m_meshHash);
+		s.doValue("m_bvhSize", offsetof(MeshBinaryCollisionHeader, m_bvhSize), self.m_bvhSize);
+		s.doValue("m_padding", offsetof(MeshBinaryCollisionHeader, m_padding), self.m_padding);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MeshBinaryCollisionHeader&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MeshBinaryCollisionHeader&>(serializer, *this);
+	}
+};
+
 /// @}
 
 } // end namespace anki
@@ -488,4 +488,25 @@ Error ResourceFilesystem::openFileInternal(const ResourceFilename& filename, Res
 	return Error::kNone;
 }
 
+Bool ResourceFilesystem::fileExists(const ResourceFilename& filename) const
+{
+	for(const Path& p : m_paths)
+	{
+		for(const ResourceString& pfname : p.m_files)
+		{
+			if(pfname == filename)
+			{
+				return true;
+			}
+		}
+	}
+
+	// Same as openFileInternal(), try outside the resource dirs
+#if ANKI_OS_ANDROID
+	return false;
+#else
+	return anki::fileExists(filename);
+#endif
+}
+
 } // end namespace anki
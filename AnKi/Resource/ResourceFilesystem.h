@@ -97,6 +97,9 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
+	/// Search the path list to find if a file exists. Use it for optional files. It's thread-safe.
+	Bool fileExists(const ResourceFilename& filename) const;
+
 	/// Iterate all the filenames from all paths provided.
 	template<typename TFunc>
 	Error iterateAllFilenames(TFunc func) const
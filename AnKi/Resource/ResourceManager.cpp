@@ -27,6 +27,8 @@ namespace anki {
 
 static NumericCVar<PtrSize> g_transferScratchMemorySizeCVar(CVarSubsystem::kResource, "TransferScratchMemorySize", 256_MB, 1_MB, 4_GB,
 															"Memory that is used fot texture and buffer uploads");
+static NumericCVar<PtrSize> g_transferFrameBudgetCVar(CVarSubsystem::kResource, "TransferFrameBudget", 0, 0, 4_GB,
+													  "Max bytes of low priority uploads per frame. 0 means no limit");
 
 ResourceManager::ResourceManager()
 {
@@ -57,7 +59,7 @@ Error ResourceManager::init(AllocAlignedCallback allocCallback, void* allocCallb
 	m_asyncLoader = newInstance<AsyncLoader>(ResourceMemoryPool::getSingleton());
 
 	m_transferGpuAlloc = newInstance<TransferGpuAllocator>(ResourceMemoryPool::getSingleton());
-	ANKI_CHECK(m_transferGpuAlloc->init(g_transferScratchMemorySizeCVar.get()));
+	ANKI_CHECK(m_transferGpuAlloc->init(g_transferScratchMemorySizeCVar.get(), g_transferFrameBudgetCVar.get()));
 
 	// Init the programs
 	m_shaderProgramSystem = newInstance<ShaderProgramResourceSystem>(ResourceMemoryPool::getSingleton());
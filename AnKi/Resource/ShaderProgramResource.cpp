@@ -84,19 +84,18 @@ void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVarian
 	}
 
 	// Compute variant hash
-	U64 hash = computeHash(&info.m_shaderTypes, sizeof(info.m_shaderTypes));
+	StreamingHasher hasher;
+	hasher.appendObject(info.m_shaderTypes);
 
 	for(ShaderType stype : EnumBitsIterable<ShaderType, ShaderTypeBit>(info.m_shaderTypes))
 	{
 		const PtrSize len = strlen(info.m_techniqueNames[stype].getBegin());
 		ANKI_ASSERT(len > 0);
-		hash = appendHash(info.m_techniqueNames[stype].getBegin(), len, hash);
+		hasher.append(info.m_techniqueNames[stype].getBegin(), len);
 	}
 
-	if(m_binary->m_mutators.getSize())
-	{
-		hash = appendHash(info.m_mutation.getBegin(), m_binary->m_mutators.getSize() * sizeof(info.m_mutation[0]), hash);
-	}
+	hasher.append(info.m_mutation.getBegin(), m_binary->m_mutators.getSize() * sizeof(info.m_mutation[0]));
+	const U64 hash = hasher.getHash();
 
 	// Check if the variant is in the cache
 	{
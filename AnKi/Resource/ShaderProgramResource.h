@@ -11,7 +11,7 @@
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/String.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Math.h>
 
@@ -135,7 +135,7 @@ public:
 private:
 	ShaderBinary* m_binary = nullptr;
 
-	mutable ResourceHashMap<U64, ShaderProgramResourceVariant*> m_variants;
+	mutable ResourceSwissHashMap<U64, ShaderProgramResourceVariant*> m_variants;
 	mutable RWMutex m_mtx;
 
 	ShaderProgramResourceVariant* createNewVariant(const ShaderProgramResourceVariantInitInfo& info) const;
@@ -169,22 +169,24 @@ Error ShaderProgramResourceSystem::createRayTracingPrograms(ResourceDynamicArray
 			return Error::kNone;
 		}
 
-		// Get the binary
+		// Get the binary. Read the whole file in one go and use it in place, all the binaries are loaded here so that matters
 		ResourceFilePtr file;
 		ANKI_CHECK(ResourceManager::getSingleton().getFilesystem().openFile(filename, file));
-		ShaderBinary* binary;
-		ANKI_CHECK(deserializeShaderBinaryFromAnyFile(*file, binary, ResourceMemoryPool::getSingleton()));
 
 		class Dummy
 		{
 		public:
-			ShaderBinary* m_binary;
+			U8* m_blob;
 
 			~Dummy()
 			{
-				ResourceMemoryPool::getSingleton().free(m_binary);
+				ResourceMemoryPool::getSingleton().free(m_blob);
 			}
-		} dummy{binary};
+		} dummy{static_cast<U8*>(ResourceMemoryPool::getSingleton().allocate(file->getSize(), ANKI_SAFE_ALIGNMENT))};
+
+		ANKI_CHECK(file->read(dummy.m_blob, file->getSize()));
+		ShaderBinary* binary;
+		ANKI_CHECK(deserializeShaderBinaryInPlace(WeakArray<U8, PtrSize>(dummy.m_blob, file->getSize()), binary));
 
 		if(!(binary->m_shaderTypes & ShaderTypeBit::kAllRayTracing))
 		{
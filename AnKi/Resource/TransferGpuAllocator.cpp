@@ -4,33 +4,21 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Resource/TransferGpuAllocator.h>
+#include <AnKi/Core/StatsSet.h>
 #include <AnKi/Gr/Fence.h>
 #include <AnKi/Gr/Buffer.h>
 #include <AnKi/Gr/GrManager.h>
 #include <AnKi/Util/Tracer.h>
+#include <AnKi/Util/HighRezTimer.h>
 
 namespace anki {
 
-Error TransferGpuAllocator::StackAllocatorBuilderInterface::allocateChunk(PtrSize size, Chunk*& out)
-{
-	out = newInstance<Chunk>(ResourceMemoryPool::getSingleton());
-
-	BufferInitInfo bufferInit(size, BufferUsageBit::kTransferSource, BufferMapAccessBit::kWrite, "Transfer");
-	out->m_buffer = GrManager::getSingleton().newBuffer(bufferInit);
-
-	out->m_mappedBuffer = out->m_buffer->map(0, kMaxPtrSize, BufferMapAccessBit::kWrite);
-
-	return Error::kNone;
-}
-
-void TransferGpuAllocator::StackAllocatorBuilderInterface::freeChunk(Chunk* chunk)
-{
-	ANKI_ASSERT(chunk);
-
-	chunk->m_buffer->unmap();
+static StatCounter g_transferBytesStatVar(StatCategory::kMisc, "Transfer bytes", StatFlag::kZeroEveryFrame | StatFlag::kBytes);
+static StatCounter g_transferStallTimeStatVar(StatCategory::kTime, "Transfer stall", StatFlag::kZeroEveryFrame | StatFlag::kMilisecond);
+static StatCounter g_transferMemoryInFlightStatVar(StatCategory::kGpuMem, "Transfer in flight", StatFlag::kBytes);
 
-	deleteInstance(ResourceMemoryPool::getSingleton(), chunk);
-}
+/// How often a low priority allocation checks if a new frame started.
+static constexpr Second kBudgetPollTime = 1.0_ms;
 
 TransferGpuAllocator::TransferGpuAllocator()
 {
@@ -38,102 +26,111 @@ TransferGpuAllocator::TransferGpuAllocator()
 
 TransferGpuAllocator::~TransferGpuAllocator()
 {
+	if(m_buffer)
+	{
+		m_buffer->unmap();
+	}
+
+	m_ring.destroy();
 }
 
-Error TransferGpuAllocator::init(PtrSize maxSize)
+Error TransferGpuAllocator::init(PtrSize maxSize, PtrSize frameBudget)
 {
-	m_maxAllocSize = getAlignedRoundUp(kChunkInitialSize * kPoolCount, maxSize);
-	ANKI_RESOURCE_LOGI("Will use %zuMB of memory for transfer scratch", m_maxAllocSize / PtrSize(1_MB));
+	maxSize = getAlignedRoundUp(kGpuBufferAlignment, maxSize);
+	ANKI_RESOURCE_LOGI("Will use %zuMB of memory for transfer scratch", maxSize / PtrSize(1_MB));
 
-	for(Pool& pool : m_pools)
-	{
-		pool.m_stackAlloc.getInterface().m_parent = this;
-	}
+	BufferInitInfo bufferInit(maxSize, BufferUsageBit::kTransferSource, BufferMapAccessBit::kWrite, "Transfer");
+	m_buffer = GrManager::getSingleton().newBuffer(bufferInit);
+	m_mappedBuffer = static_cast<U8*>(m_buffer->map(0, kMaxPtrSize, BufferMapAccessBit::kWrite));
+
+	m_ring.init(maxSize);
+	m_frameBudget = frameBudget;
 
 	return Error::kNone;
 }
 
-Error TransferGpuAllocator::allocate(PtrSize size, TransferGpuAllocatorHandle& handle)
+Error TransferGpuAllocator::allocate(PtrSize size, TransferGpuAllocatorHandle& handle, TransferPriority priority)
 {
 	ANKI_TRACE_SCOPED_EVENT(RsrcAllocateTransfer);
+	ANKI_ASSERT(size > 0 && !handle.valid());
 
-	const PtrSize poolSize = m_maxAllocSize / kPoolCount;
+	if(size > m_ring.getSize()) [[unlikely]]
+	{
+		ANKI_RESOURCE_LOGE("Transfer allocation is larger than the transfer scratch memory: %zu", size);
+		return Error::kOutOfMemory;
+	}
+
+	Second stallTime = 0.0;
 
 	LockGuard<Mutex> lock(m_mtx);
 
-	Pool* pool;
-	if(m_crntPoolAllocatedSize + size <= poolSize)
+	// Respect the frame budget. Always allow one allocation per frame or big uploads will never happen
+	while(true)
 	{
-		// Have enough space in the pool
+		const U64 frame = GrManager::getSingleton().getFrameEpoch();
+		if(frame != m_budgetFrame)
+		{
+			m_budgetFrame = frame;
+			m_bytesThisFrame = 0;
+		}
 
-		pool = &m_pools[m_crntPool];
+		if(priority == TransferPriority::kHigh || m_frameBudget == 0 || m_bytesThisFrame == 0 || m_bytesThisFrame + size <= m_frameBudget)
+		{
+			break;
+		}
+
+		ANKI_TRACE_SCOPED_EVENT(RsrcWaitTransfer);
+		m_mtx.unlock();
+		HighRezTimer::sleep(kBudgetPollTime);
+		stallTime += kBudgetPollTime;
+		m_mtx.lock();
 	}
-	else
+
+	// Get some memory from the ring. If it's full wait for the oldest submission that used it
+	U64 allocationId;
+	PtrSize offset;
+	while(true)
 	{
-		// Don't have enough space. Wait for one pool used in the past
+		m_ring.reclaim();
+		offset = m_ring.allocate(size, kGpuBufferAlignment, allocationId);
+		if(offset != kMaxPtrSize)
+		{
+			break;
+		}
 
-		m_crntPool = U8((m_crntPool + 1) % kPoolCount);
-		pool = &m_pools[m_crntPool];
+		ANKI_TRACE_SCOPED_EVENT(RsrcWaitTransfer);
+		const Second startTime = HighRezTimer::getCurrentTime();
 
+		FencePtr fence = m_ring.getOldestFence();
+		if(fence)
+		{
+			// Don't hold the lock while waiting on the GPU
+			m_mtx.unlock();
+			fence->clientWait(kMaxFenceWaitTime);
+			m_mtx.lock();
+		}
+		else
 		{
-			ANKI_TRACE_SCOPED_EVENT(RsrcWaitTransfer);
-
-			// Wait for all memory to be released
-			while(pool->m_pendingReleases != 0)
-			{
-				m_condVar.wait(m_mtx);
-			}
-
-			// All memory is released, loop until all fences are triggered
-			while(!pool->m_fences.isEmpty())
-			{
-				FencePtr fence = pool->m_fences.getFront();
-
-				const Bool done = fence->clientWait(kMaxFenceWaitTime);
-				if(done)
-				{
-					pool->m_fences.popFront();
-				}
-			}
+			// The oldest allocation is not released yet
+			m_condVar.wait(m_mtx);
 		}
 
-		pool->m_stackAlloc.reset();
-		m_crntPoolAllocatedSize = 0;
+		stallTime += HighRezTimer::getCurrentTime() - startTime;
 	}
 
-	Chunk* chunk;
-	PtrSize offset;
-	[[maybe_unused]] const Error err = pool->m_stackAlloc.allocate(size, kGpuBufferAlignment, chunk, offset);
-	ANKI_ASSERT(!err);
+	m_bytesThisFrame += size;
 
-	handle.m_buffer = chunk->m_buffer;
-	handle.m_mappedMemory = static_cast<U8*>(chunk->m_mappedBuffer) + offset;
+	handle.m_buffer = m_buffer;
+	handle.m_mappedMemory = m_mappedBuffer + offset;
 	handle.m_offsetInBuffer = offset;
 	handle.m_range = size;
-	handle.m_pool = U8(pool - &m_pools[0]);
+	handle.m_allocationId = allocationId;
 
-	m_crntPoolAllocatedSize += size;
-	++pool->m_pendingReleases;
-
-	// Do a cleanup of done fences. Do that to avoid having too many fences alive. Fences are implemented with file
-	// decriptors in Linux and we don't want to exceed the process' limit of max open file descriptors
-	for(Pool& p : m_pools)
+	g_transferBytesStatVar.increment(size);
+	g_transferMemoryInFlightStatVar.set(m_ring.getUsedSize());
+	if(stallTime > 0.0)
 	{
-		ResourceList<FencePtr>::Iterator it = p.m_fences.getBegin();
-		while(it != p.m_fences.getEnd())
-		{
-			const Bool fenceDone = (*it)->clientWait(0.0);
-			if(fenceDone)
-			{
-				auto nextIt = it + 1;
-				p.m_fences.erase(it);
-				it = nextIt;
-			}
-			else
-			{
-				++it;
-			}
-		}
+		g_transferStallTimeStatVar.increment(stallTime * 1000.0);
 	}
 
 	return Error::kNone;
@@ -144,17 +141,17 @@ void TransferGpuAllocator::release(TransferGpuAllocatorHandle& handle, FencePtr
 	ANKI_ASSERT(fence);
 	ANKI_ASSERT(handle.valid());
 
-	Pool& pool = m_pools[handle.m_pool];
-
 	{
 		LockGuard<Mutex> lock(m_mtx);
 
-		pool.m_fences.pushBack(fence);
+		m_ring.release(handle.m_allocationId, fence);
 
-		ANKI_ASSERT(pool.m_pendingReleases > 0);
-		--pool.m_pendingReleases;
+		// Drop the signaled fences early. Fences are implemented with file decriptors in Linux and we don't want to exceed the process' limit
+		// of max open file descriptors
+		m_ring.reclaim();
+		g_transferMemoryInFlightStatVar.set(m_ring.getUsedSize());
 
-		m_condVar.notifyOne();
+		m_condVar.notifyAll();
 	}
 
 	handle.invalidate();
@@ -6,7 +6,6 @@
 #pragma once
 
 #include <AnKi/Resource/Common.h>
-#include <AnKi/Util/StackAllocatorBuilder.h>
 #include <AnKi/Util/List.h>
 #include <AnKi/Gr/Buffer.h>
 
@@ -15,6 +14,105 @@ namespace anki {
 /// @addtogroup resource
 /// @{
 
+/// The priority of an upload. Low priority uploads respect the per frame upload budget.
+enum class TransferPriority : U8
+{
+	kHigh,
+	kLow
+};
+
+/// The bookkeeping of the TransferGpuAllocator's ring buffer. The allocations are consecutive ranges of the ring and they are reclaimed in the
+/// order they were allocated once they are released and their fence is signaled. It doesn't touch any GPU memory so it can be tested with fake
+/// fences. It's not thread-safe.
+/// @tparam TFencePtr A pointer to an object that has a "Bool clientWait(Second)" method.
+template<typename TFencePtr>
+class TransferRing
+{
+public:
+	TransferRing() = default;
+
+	TransferRing(const TransferRing&) = delete; // Non-copyable
+
+	~TransferRing()
+	{
+		ANKI_ASSERT(m_allocations.isEmpty() && "Some allocations are still alive");
+	}
+
+	TransferRing& operator=(const TransferRing&) = delete; // Non-copyable
+
+	void init(PtrSize size)
+	{
+		ANKI_ASSERT(size > 0 && m_size == 0);
+		m_size = size;
+	}
+
+	void destroy()
+	{
+		m_allocations.destroy();
+		m_head = 0;
+	}
+
+	/// Allocate a range of the ring.
+	/// @return The offset of the allocation or kMaxPtrSize if there is not enough contiguous space.
+	PtrSize allocate(PtrSize size, PtrSize alignment, U64& allocationId);
+
+	/// Release an allocation. Its memory will be reclaimed after the fence is signaled.
+	void release(U64 allocationId, TFencePtr fence);
+
+	/// Reclaim the memory of the oldest allocations that are released and their fences are signaled. It doesn't block.
+	void reclaim();
+
+	/// The fence that needs to signal for the oldest allocation to get reclaimed. It's null if that allocation is not released yet.
+	TFencePtr getOldestFence() const
+	{
+		return (m_allocations.isEmpty() || !m_allocations.getFront().m_released) ? TFencePtr() : m_allocations.getFront().m_fence;
+	}
+
+	PtrSize getSize() const
+	{
+		return m_size;
+	}
+
+	/// The memory that can't be allocated because it's used or it waits for a fence.
+	PtrSize getUsedSize() const
+	{
+		if(m_allocations.isEmpty())
+		{
+			return 0;
+		}
+
+		const PtrSize tail = getTail();
+		return (m_head > tail) ? m_head - tail : m_size - tail + m_head;
+	}
+
+	U32 getAllocationCount() const
+	{
+		return U32(m_allocations.getSize());
+	}
+
+private:
+	class Allocation
+	{
+	public:
+		PtrSize m_offset;
+		U64 m_id;
+		TFencePtr m_fence = {};
+		Bool m_released = false;
+	};
+
+	ResourceList<Allocation> m_allocations; ///< From oldest to newest.
+	PtrSize m_size = 0;
+	PtrSize m_head = 0; ///< Where the next allocation will start.
+	U64 m_nextAllocationId = 1;
+
+	/// Where the oldest allocation starts.
+	PtrSize getTail() const
+	{
+		ANKI_ASSERT(!m_allocations.isEmpty());
+		return m_allocations.getFront().m_offset;
+	}
+};
+
 /// Memory handle.
 class TransferGpuAllocatorHandle
 {
@@ -43,7 +141,7 @@ public:
 		m_mappedMemory = b.m_mappedMemory;
 		m_offsetInBuffer = b.m_offsetInBuffer;
 		m_range = b.m_range;
-		m_pool = b.m_pool;
+		m_allocationId = b.m_allocationId;
 		b.invalidate();
 		return *this;
 	}
@@ -81,11 +179,11 @@ private:
 	void* m_mappedMemory = nullptr;
 	PtrSize m_offsetInBuffer = kMaxPtrSize;
 	PtrSize m_range = 0;
-	U8 m_pool = kMaxU8;
+	U64 m_allocationId = 0;
 
 	Bool valid() const
 	{
-		return m_range != 0 && m_pool < kMaxU8;
+		return m_range != 0 && m_allocationId != 0;
 	}
 
 	void invalidate()
@@ -94,11 +192,12 @@ private:
 		m_mappedMemory = nullptr;
 		m_offsetInBuffer = kMaxPtrSize;
 		m_range = 0;
-		m_pool = kMaxU8;
+		m_allocationId = 0;
 	}
 };
 
-/// GPU memory allocator for GPU buffers used in transfer operations.
+/// GPU memory allocator for GPU buffers used in transfer operations. It's a persistently mapped ring buffer. The memory of an allocation is
+/// reclaimed when the fence of the submission that used it is signaled.
 class TransferGpuAllocator
 {
 	friend class TransferGpuAllocatorHandle;
@@ -108,108 +207,44 @@ public:
 	/// of the buffer to image copies.
 	static constexpr U32 kGpuBufferAlignment = 16 * 3;
 
-	static constexpr U32 kPoolCount = 2;
-	static constexpr PtrSize kChunkInitialSize = 64_MB;
 	static constexpr Second kMaxFenceWaitTime = 500.0_ms;
 
 	TransferGpuAllocator();
 
 	~TransferGpuAllocator();
 
-	Error init(PtrSize maxSize);
+	/// @param maxSize The size of the ring buffer.
+	/// @param frameBudget The bytes low priority uploads can allocate per frame. Zero means no limit.
+	Error init(PtrSize maxSize, PtrSize frameBudget = 0);
 
-	/// Allocate some transfer memory. If there is not enough memory it will block until some is releaced. It's
-	/// threadsafe.
-	Error allocate(PtrSize size, TransferGpuAllocatorHandle& handle);
+	/// Allocate some transfer memory. If there is not enough memory it will block until some is released. Low priority allocations will also
+	/// block until there is room in the budget of the frame. It's thread-safe.
+	Error allocate(PtrSize size, TransferGpuAllocatorHandle& handle, TransferPriority priority = TransferPriority::kHigh);
 
-	/// Release the memory. It will not be recycled before the fence is signaled. It's threadsafe.
+	/// Release the memory. It will not be recycled before the fence is signaled. It's thread-safe.
 	void release(TransferGpuAllocatorHandle& handle, FencePtr fence);
 
-private:
-	/// This is the chunk the StackAllocatorBuilder will be allocating.
-	class Chunk
-	{
-	public:
-		/// Required by StackAllocatorBuilder.
-		Chunk* m_nextChunk;
-
-		/// Required by StackAllocatorBuilder.
-		Atomic<PtrSize> m_offsetInChunk;
-
-		/// Required by StackAllocatorBuilder.
-		PtrSize m_chunkSize;
-
-		/// The GPU memory.
-		BufferPtr m_buffer;
-
-		/// Points to the mapped m_buffer.
-		void* m_mappedBuffer;
-	};
-
-	/// Implements the StackAllocatorBuilder TInterface
-	class StackAllocatorBuilderInterface
+	/// The size of the ring buffer. The uploads shouldn't hold more than a fraction of it before they submit their work.
+	PtrSize getMaxSize() const
 	{
-	public:
-		TransferGpuAllocator* m_parent = nullptr; // TODO glob: maybe rm
-
-		// The rest of the functions implement the StackAllocatorBuilder TInterface.
-
-		constexpr PtrSize getMaxAlignment()
-		{
-			return kGpuBufferAlignment;
-		}
-
-		constexpr PtrSize getInitialChunkSize() const
-		{
-			return kChunkInitialSize;
-		}
-
-		constexpr F64 getNextChunkGrowScale() const
-		{
-			return 1.0;
-		}
-
-		constexpr PtrSize getNextChunkGrowBias() const
-		{
-			return 0;
-		}
-
-		constexpr Bool ignoreDeallocationErrors() const
-		{
-			return false;
-		}
-
-		Error allocateChunk(PtrSize size, Chunk*& out);
-
-		void freeChunk(Chunk* chunk);
-
-		void recycleChunk([[maybe_unused]] Chunk& chunk)
-		{
-			// Do nothing
-		}
-
-		constexpr Atomic<U32>* getAllocationCount()
-		{
-			return nullptr;
-		}
-	};
+		return m_ring.getSize();
+	}
 
-	class Pool
-	{
-	public:
-		StackAllocatorBuilder<Chunk, StackAllocatorBuilderInterface, DummyMutex> m_stackAlloc;
-		ResourceList<FencePtr> m_fences;
-		U32 m_pendingReleases = 0;
-	};
+private:
+	BufferPtr m_buffer;
+	U8* m_mappedBuffer = nullptr;
 
-	PtrSize m_maxAllocSize = 0;
+	PtrSize m_frameBudget = 0;
 
 	Mutex m_mtx; ///< Protect all members bellow.
 	ConditionVariable m_condVar;
-	Array<Pool, kPoolCount> m_pools;
-	U8 m_crntPool = 0;
-	PtrSize m_crntPoolAllocatedSize = 0;
+	TransferRing<FencePtr> m_ring;
+
+	U64 m_budgetFrame = 0; ///< The frame m_bytesThisFrame refers to.
+	PtrSize m_bytesThisFrame = 0;
 };
 /// @}
 
 } // end namespace anki
+
+#include <AnKi/Resource/TransferGpuAllocator.inl.h>
@@ -0,0 +1,103 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/TransferGpuAllocator.h>
+
+namespace anki {
+
+template<typename TFencePtr>
+PtrSize TransferRing<TFencePtr>::allocate(PtrSize size, PtrSize alignment, U64& allocationId)
+{
+	ANKI_ASSERT(m_size > 0 && size > 0 && alignment > 0);
+
+	PtrSize offset = kMaxPtrSize;
+	if(size > m_size)
+	{
+		// Will never fit
+	}
+	else if(m_allocations.isEmpty())
+	{
+		// Start from the beginning to have the whole ring available
+		offset = 0;
+	}
+	else
+	{
+		const PtrSize tail = getTail();
+		const PtrSize alignedHead = getAlignedRoundUp(alignment, m_head);
+
+		if(m_head > tail)
+		{
+			// The used range doesn't wrap. Try the end of the ring and then its beginning
+			if(alignedHead + size <= m_size)
+			{
+				offset = alignedHead;
+			}
+			else if(size <= tail)
+			{
+				offset = 0;
+			}
+		}
+		else
+		{
+			// The used range wraps (or the ring is full if the head reached the tail). The free space is between the head and the tail
+			if(alignedHead + size <= tail)
+			{
+				offset = alignedHead;
+			}
+		}
+	}
+
+	if(offset != kMaxPtrSize)
+	{
+		Allocation& alloc = *m_allocations.emplaceBack();
+		alloc.m_offset = offset;
+		alloc.m_id = m_nextAllocationId++;
+
+		m_head = offset + size;
+		allocationId = alloc.m_id;
+	}
+
+	return offset;
+}
+
+template<typename TFencePtr>
+void TransferRing<TFencePtr>::release(U64 allocationId, TFencePtr fence)
+{
+	ANKI_ASSERT(fence);
+
+	// Releases happen in roughly the same order as allocations so search from the front
+	auto it = m_allocations.getBegin();
+	while(it != m_allocations.getEnd() && it->m_id != allocationId)
+	{
+		++it;
+	}
+
+	ANKI_ASSERT(it != m_allocations.getEnd() && !it->m_released && "Allocation not found or released twice");
+	it->m_fence = fence;
+	it->m_released = true;
+}
+
+template<typename TFencePtr>
+void TransferRing<TFencePtr>::reclaim()
+{
+	// Fences signal in submission order so there is no point looking past the first one that is not signaled
+	while(!m_allocations.isEmpty())
+	{
+		Allocation& front = m_allocations.getFront();
+		if(!front.m_released || !front.m_fence->clientWait(0.0))
+		{
+			break;
+		}
+
+		m_allocations.popFront();
+	}
+
+	if(m_allocations.isEmpty())
+	{
+		m_head = 0;
+	}
+}
+
+} // end namespace anki
@@ -8,6 +8,7 @@
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Shaders/Include/ClusteredShadingTypes.h>
 #include <AnKi/Core/GpuMemory/GpuSceneBuffer.h>
+#include <AnKi/Collision/Functions.h>
 
 namespace anki {
 
@@ -15,6 +16,7 @@ DecalComponent::DecalComponent(SceneNode* node)
 	: SceneComponent(node, kClassType)
 {
 	m_gpuSceneDecal.allocate();
+	m_spatialProxy.m_userData = static_cast<SceneComponent*>(this);
 }
 
 DecalComponent::~DecalComponent()
@@ -68,6 +70,7 @@ Error DecalComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		const Vec4 extend(halfBoxSize.x(), halfBoxSize.y(), halfBoxSize.z(), 0.0f);
 		const Obb obbL(center, Mat3x4::getIdentity(), extend);
 		const Obb obbW = obbL.getTransformed(info.m_node->getWorldTransform());
+		SceneGraph::getSingleton().getSpatialIndex().updateProxy(m_spatialProxy, computeAabb(obbW));
 
 		// Upload to the GPU scene
 		GpuSceneDecal gpuDecal;
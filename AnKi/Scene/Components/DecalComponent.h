@@ -9,6 +9,7 @@
 #include <AnKi/Scene/GpuSceneArray.h>
 #include <AnKi/Resource/ImageAtlasResource.h>
 #include <AnKi/Collision/Obb.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -77,6 +78,8 @@ private:
 
 	GpuSceneArrays::Decal::Allocation m_gpuSceneDecal;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	Bool m_dirty = true;
 
 	void setLayer(CString fname, F32 blendFactor, LayerType type);
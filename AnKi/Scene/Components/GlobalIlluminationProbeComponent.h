@@ -9,6 +9,7 @@
 #include <AnKi/Scene/Frustum.h>
 #include <AnKi/Scene/GpuSceneArray.h>
 #include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -127,6 +128,8 @@ private:
 
 	GpuSceneArrays::GlobalIlluminationProbe::Allocation m_gpuSceneProbe;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	ShaderProgramResourcePtr m_clearTextureProg;
 
 	U32 m_uuid = 0;
@@ -20,6 +20,7 @@ LightComponent::LightComponent(SceneNode* node)
 	, m_type(LightComponentType::kPoint)
 {
 	m_point.m_radius = 1.0f;
+	m_spatialProxy.m_userData = static_cast<SceneComponent*>(this);
 
 	setLightComponentType(LightComponentType::kPoint);
 	m_worldTransform = node->getWorldTransform();
@@ -49,8 +50,13 @@ void LightComponent::setLightComponentType(LightComponentType newType)
 
 		if(newType == LightComponentType::kDirectional)
 		{
-			// Now it's directional, inform the scene
+			// Now it's directional, inform the scene. Directional lights affect everything so they are not in the spatial index
 			SceneGraph::getSingleton().addDirectionalLight(this);
+
+			if(m_spatialProxy.isRegistered())
+			{
+				SceneGraph::getSingleton().getSpatialIndex().removeProxy(m_spatialProxy);
+			}
 		}
 		else if(oldType == LightComponentType::kDirectional)
 		{
@@ -118,6 +124,10 @@ Error LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 			m_gpuSceneLight.allocate();
 		}
 		m_gpuSceneLight.uploadToGpuScene(gpuLight);
+
+		const Vec4 radius(m_point.m_radius, m_point.m_radius, m_point.m_radius, 0.0f);
+		SceneGraph::getSingleton().getSpatialIndex().updateProxy(
+			m_spatialProxy, Aabb(m_worldTransform.getOrigin().xyz0() - radius, m_worldTransform.getOrigin().xyz0() + radius));
 	}
 	else if(updated && m_type == LightComponentType::kSpot)
 	{
@@ -163,12 +173,18 @@ Error LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 
 		Array<Vec3, 4> points;
 		computeEdgesOfFrustum(m_spot.m_distance, m_spot.m_outerAngle, m_spot.m_outerAngle, &points[0]);
+		Vec4 aabbMin = m_worldTransform.getOrigin().xyz0();
+		Vec4 aabbMax = aabbMin;
 		for(U32 i = 0; i < 4; ++i)
 		{
 			points[i] = m_worldTransform.transform(points[i]);
 			gpuLight.m_edgePoints[i] = points[i].xyz0();
+			aabbMin = aabbMin.min(points[i].xyz0());
+			aabbMax = aabbMax.max(points[i].xyz0());
 		}
 
+		SceneGraph::getSingleton().getSpatialIndex().updateProxy(m_spatialProxy, Aabb(aabbMin, aabbMax));
+
 		if(reallyShadow)
 		{
 			const Mat4 biasMat4(0.5f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
@@ -205,7 +221,7 @@ Error LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 }
 
 void LightComponent::computeCascadeFrustums(const Frustum& primaryFrustum, ConstWeakArray<F32> cascadeDistances, WeakArray<Mat4> cascadeProjMats,
-											WeakArray<Mat3x4> cascadeViewMats) const
+											WeakArray<Mat3x4> cascadeViewMats, WeakArray<Sphere> cascadeBoundingSpheres) const
 {
 	ANKI_ASSERT(m_type == LightComponentType::kDirectional);
 	ANKI_ASSERT(m_shadow);
@@ -318,7 +334,15 @@ void LightComponent::computeCascadeFrustums(const Frustum& primaryFrustum, Const
 
 			// Write the results
 			cascadeProjMats[cascade] = cascadeProjMat;
-			cascadeViewMats[cascade] = Mat3x4(cascadeViewMat);
+			if(cascadeViewMats.getSize())
+			{
+				cascadeViewMats[cascade] = Mat3x4(cascadeViewMat);
+			}
+
+			if(cascadeBoundingSpheres.getSize())
+			{
+				cascadeBoundingSpheres[cascade] = sphere;
+			}
 		}
 	}
 	else
@@ -8,6 +8,7 @@
 #include <AnKi/Scene/Components/SceneComponent.h>
 #include <AnKi/Scene/GpuSceneArray.h>
 #include <AnKi/Math.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -145,8 +146,9 @@ public:
 	/// @param cascadeDistances The distances of the cascades.
 	/// @param cascadeProjMats View projection matrices for each cascade.
 	/// @param cascadeViewMats View matrices for each cascade. Optional.
+	/// @param cascadeBoundingSpheres The spheres that enclose the part of the camera frustum each cascade covers. Optional.
 	void computeCascadeFrustums(const Frustum& cameraFrustum, ConstWeakArray<F32> cascadeDistances, WeakArray<Mat4> cascadeProjMats,
-								WeakArray<Mat3x4> cascadeViewMats = {}) const;
+								WeakArray<Mat3x4> cascadeViewMats = {}, WeakArray<Sphere> cascadeBoundingSpheres = {}) const;
 
 	U32 getUuid() const
 	{
@@ -189,6 +191,8 @@ private:
 
 	Array<Vec4, 6> m_shadowAtlasUvViewports;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	U32 m_uuid = 0;
 
 	LightComponentType m_type;
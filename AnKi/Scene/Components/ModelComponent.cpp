@@ -19,6 +19,7 @@ ModelComponent::ModelComponent(SceneNode* node)
 	: SceneComponent(node, kClassType)
 {
 	m_gpuSceneTransforms.allocate();
+	m_spatialProxy.m_userData = static_cast<SceneComponent*>(this);
 }
 
 ModelComponent::~ModelComponent()
@@ -246,12 +247,13 @@ Error ModelComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		m_gpuSceneTransforms.uploadToGpuScene(trfs);
 	}
 
-	// Scene bounds update
+	// Scene bounds and spatial index update
 	const Bool aabbUpdated = moved || resourceUpdated || m_skinComponent;
 	if(aabbUpdated) [[unlikely]]
 	{
 		const Aabb aabbWorld = computeAabbWorldSpace(info.m_node->getWorldTransform());
 		SceneGraph::getSingleton().updateSceneBounds(aabbWorld.getMin().xyz(), aabbWorld.getMax().xyz());
+		SceneGraph::getSingleton().getSpatialIndex().updateProxy(m_spatialProxy, aabbWorld);
 	}
 
 	// Update the buckets
@@ -11,6 +11,7 @@
 #include <AnKi/Resource/Forward.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -69,6 +70,8 @@ private:
 	GpuSceneBufferAllocation m_gpuSceneUniforms;
 	GpuSceneArrays::Transform::Allocation m_gpuSceneTransforms;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	// Other stuff
 	Bool m_resourceChanged : 1 = true;
 	Bool m_castsShadow : 1 = false;
@@ -196,6 +196,8 @@ public:
 ParticleEmitterComponent::ParticleEmitterComponent(SceneNode* node)
 	: SceneComponent(node, kClassType)
 {
+	m_spatialProxy.m_userData = static_cast<SceneComponent*>(this);
+
 	// Allocate and populate a quad
 	const U32 vertCount = 4;
 	const U32 indexCount = 6;
@@ -350,6 +352,8 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 				 scales, alphas, aabbWorld);
 	}
 
+	SceneGraph::getSingleton().getSpatialIndex().updateProxy(m_spatialProxy, aabbWorld);
+
 	// Upload particles to the GPU scene
 	GpuSceneMicroPatcher& patcher = GpuSceneMicroPatcher::getSingleton();
 	if(m_aliveParticleCount > 0)
@@ -359,6 +363,12 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 		patcher.newCopy(*info.m_framePool, m_gpuSceneAlphas, sizeof(F32) * m_aliveParticleCount, alphas);
 	}
 
+	// The GpuSceneRenderable points to the emitter using an absolute offset. If the array of the emitters moved upload everything again
+	if(m_gpuSceneParticleEmitter.isValid() && m_gpuSceneParticleEmitter.getGpuSceneOffset() != m_uploadedGpuSceneParticleEmitterOffset)
+	{
+		m_resourceUpdated = true;
+	}
+
 	if(m_resourceUpdated)
 	{
 		// Upload GpuSceneParticleEmitter
@@ -401,6 +411,7 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 		renderable.m_uniformsOffset = m_gpuSceneUniforms.getOffset();
 		renderable.m_meshLodsIndex = m_gpuSceneMeshLods.getIndex() * kMaxLodCount;
 		renderable.m_particleEmitterOffset = m_gpuSceneParticleEmitter.getGpuSceneOffset();
+		m_uploadedGpuSceneParticleEmitterOffset = renderable.m_particleEmitterOffset;
 		renderable.m_worldTransformsIndex = 0;
 		renderable.m_uuid = SceneGraph::getSingleton().getNewUuid();
 		if(!m_gpuSceneRenderable.isValid())
@@ -11,6 +11,7 @@
 #include <AnKi/Resource/ParticleEmitterResource.h>
 #include <AnKi/Core/GpuMemory/UnifiedGeometryBuffer.h>
 #include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 #include <AnKi/Util/WeakArray.h>
 
 namespace anki {
@@ -72,9 +73,12 @@ private:
 	GpuSceneArrays::RenderableBoundingVolumeGBuffer::Allocation m_gpuSceneRenderableAabbGBuffer;
 	GpuSceneArrays::RenderableBoundingVolumeDepth::Allocation m_gpuSceneRenderableAabbDepth;
 	GpuSceneArrays::RenderableBoundingVolumeForward::Allocation m_gpuSceneRenderableAabbForward;
+	U32 m_uploadedGpuSceneParticleEmitterOffset = 0; ///< The offset the GpuSceneRenderable points to.
 
 	Array<RenderStateBucketIndex, U32(RenderingTechnique::kCount)> m_renderStateBuckets;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	Bool m_resourceUpdated = true;
 	SimulationType m_simulationType = SimulationType::kUndefined;
 
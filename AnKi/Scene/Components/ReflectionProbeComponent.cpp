@@ -20,6 +20,7 @@ ReflectionProbeComponent::ReflectionProbeComponent(SceneNode* node)
 {
 	m_worldPos = node->getWorldTransform().getOrigin().xyz();
 	m_gpuSceneProbe.allocate();
+	m_spatialProxy.m_userData = static_cast<SceneComponent*>(this);
 
 	TextureInitInfo texInit("ReflectionProbe");
 	texInit.m_format =
@@ -66,6 +67,7 @@ Error ReflectionProbeComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 		const Aabb aabbWorld(-m_halfSize + m_worldPos, m_halfSize + m_worldPos);
 		gpuProbe.m_aabbMin = aabbWorld.getMin().xyz();
 		gpuProbe.m_aabbMax = aabbWorld.getMax().xyz();
+		SceneGraph::getSingleton().getSpatialIndex().updateProxy(m_spatialProxy, aabbWorld);
 
 		gpuProbe.m_uuid = m_uuid;
 		gpuProbe.m_componentArrayIndex = getArrayIndex();
@@ -9,6 +9,7 @@
 #include <AnKi/Scene/Frustum.h>
 #include <AnKi/Scene/GpuSceneArray.h>
 #include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -78,6 +79,8 @@ private:
 
 	GpuSceneArrays::ReflectionProbe::Allocation m_gpuSceneProbe;
 
+	DynamicAabbTreeProxy m_spatialProxy;
+
 	TexturePtr m_reflectionTex;
 	U32 m_reflectionTexBindlessIndex = kMaxU32;
 	U32 m_uuid = 0;
@@ -9,11 +9,17 @@
 #include <AnKi/Resource/ScriptResource.h>
 #include <AnKi/Script/ScriptManager.h>
 #include <AnKi/Script/ScriptEnvironment.h>
+#include <AnKi/Core/CVarSet.h>
+#include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
+static BoolCVar g_shareScriptVmsCVar(CVarSubsystem::kScene, "ShareScriptVms", false,
+									 "The script components share a few LUA VMs instead of creating one each. Saves memory and load time");
+
 ScriptComponent::ScriptComponent(SceneNode* node)
 	: SceneComponent(node, kClassType)
+	, m_node(node)
 {
 	ANKI_ASSERT(node);
 }
@@ -33,13 +39,18 @@ void ScriptComponent::loadScriptResource(CString fname)
 	ScriptEnvironment* newEnv = nullptr;
 	if(!err)
 	{
-		newEnv = newInstance<ScriptEnvironment>(SceneMemoryPool::getSingleton());
+		newEnv = newInstance<ScriptEnvironment>(SceneMemoryPool::getSingleton(), g_shareScriptVmsCVar.get());
 	}
 
 	// Exec the script
 	if(!err)
 	{
-		err = newEnv->evalString(m_script->getSource());
+		err = newEnv->evalScript(rsrc->getSource(), rsrc->getFilename());
+	}
+
+	if(!err)
+	{
+		newEnv->setBatchCallArgument(m_node);
 	}
 
 	// Error
@@ -56,51 +67,116 @@ void ScriptComponent::loadScriptResource(CString fname)
 	}
 }
 
-Error ScriptComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
+Error ScriptComponent::update([[maybe_unused]] SceneComponentUpdateInfo& info, Bool& updated)
 {
-	updated = false;
-	if(m_env == nullptr)
-	{
-		return Error::kNone;
-	}
+	// The script ran in updateAll, just report what happened
+	updated = m_updateResult == UpdateResult::kUpdated;
+	const Bool failed = m_updateResult == UpdateResult::kError;
+	m_updateResult = UpdateResult::kNotUpdated;
 
-	lua_State* lua = &m_env->getLuaState();
+	return (failed) ? Error::kUserData : Error::kNone;
+}
 
-	// Push function name
-	lua_getglobal(lua, "update");
+void ScriptComponent::updateAll(Second prevTime, Second crntTime, StackMemoryPool& framePool)
+{
+	ANKI_TRACE_SCOPED_EVENT(SceneScriptsUpdate);
 
-	// Push args
-	LuaBinder::pushVariableToTheStack(lua, info.m_node);
-	lua_pushnumber(lua, info.m_previousTime);
-	lua_pushnumber(lua, info.m_currentTime);
+	using FrameArray = DynamicArray<ScriptComponent*, MemoryPoolPtrWrapper<StackMemoryPool>>;
 
-	// Do the call (3 arguments, 1 result)
-	if(lua_pcall(lua, 3, 1, 0) != 0)
+	// Gather the scripts that are due. Group the ones that share a VM so they can be updated together. The rest get a group of their own
+	const U32 sharedVmCount = ScriptManager::getSingleton().getSharedVmCount();
+	DynamicArray<FrameArray, MemoryPoolPtrWrapper<StackMemoryPool>> sharedVmGroups(&framePool);
+	sharedVmGroups.resize(sharedVmCount, FrameArray(&framePool));
+	FrameArray ownVmComps(&framePool);
+	U32 dueCount = 0;
+	for(ScriptComponent& comp : SceneGraph::getSingleton().getComponentArrays().getScripts())
 	{
-		ANKI_SCENE_LOGE("Error running ScriptComponent's \"update\": %s", lua_tostring(lua, -1));
-		return Error::kUserData;
+		if(comp.m_env == nullptr || crntTime < comp.m_nextUpdateTime)
+		{
+			continue;
+		}
+
+		if(comp.m_env->isVmShared())
+		{
+			sharedVmGroups[comp.m_env->getSharedVmIndex()].emplaceBack(&comp);
+		}
+		else
+		{
+			ownVmComps.emplaceBack(&comp);
+		}
+
+		++dueCount;
 	}
 
-	if(!lua_isnumber(lua, -1))
+	ANKI_TRACE_INC_COUNTER(SceneScriptsUpdated, dueCount);
+	ANKI_TRACE_INC_COUNTER(SceneScriptsSkipped, SceneGraph::getSingleton().getComponentArrays().getScripts().getSize() - dueCount);
+
+	if(dueCount == 0)
 	{
-		ANKI_SCENE_LOGE("ScriptComponent's \"update\" should return a number");
-		lua_pop(lua, 1);
-		return Error::kUserData;
+		return;
 	}
 
-	// Get the result
-	lua_Number result = lua_tonumber(lua, -1);
-	lua_pop(lua, 1);
-
-	if(result < 0)
+	auto updateGroup = [&](WeakArray<ScriptComponent*> comps) {
+		constexpr U32 kMaxBatchSize = 128;
+		Array<ScriptEnvironment*, kMaxBatchSize> envs;
+		Array<ScriptBatchCallResult, kMaxBatchSize> results;
+
+		for(U32 first = 0; first < comps.getSize(); first += kMaxBatchSize)
+		{
+			const U32 count = min(kMaxBatchSize, comps.getSize() - first);
+			for(U32 i = 0; i < count; ++i)
+			{
+				envs[i] = comps[first + i]->m_env;
+			}
+
+			ScriptEnvironment::batchCall("update", ConstWeakArray<ScriptEnvironment*>(&envs[0], count), prevTime, crntTime,
+										 WeakArray<ScriptBatchCallResult>(&results[0], count));
+
+			for(U32 i = 0; i < count; ++i)
+			{
+				ScriptComponent& comp = *comps[first + i];
+				const ScriptBatchCallResult& result = results[i];
+
+				comp.m_lastUpdateTime = crntTime;
+				comp.m_nextUpdateTime = crntTime + max(comp.m_updatePeriod, result.m_sleep);
+
+				if(result.m_error || result.m_return < 0.0)
+				{
+					ANKI_SCENE_LOGE("ScriptComponent's \"update\" failed: %s", comp.m_script->getFilename().cstr());
+					comp.m_updateResult = UpdateResult::kError;
+				}
+				else
+				{
+					comp.m_updateResult = (result.m_return != 0.0) ? UpdateResult::kUpdated : UpdateResult::kNotUpdated;
+				}
+			}
+		}
+	};
+
+	CoreThreadJobManager& jobManager = CoreThreadJobManager::getSingleton();
+	for(FrameArray& group : sharedVmGroups)
 	{
-		ANKI_SCENE_LOGE("ScriptComponent's \"update\" return an error code");
-		return Error::kUserData;
+		if(group.getSize())
+		{
+			jobManager.dispatchTask([&updateGroup, &group]([[maybe_unused]] U32 tid) {
+				updateGroup(WeakArray<ScriptComponent*>(group));
+			});
+		}
 	}
 
-	updated = (result != 0);
+	// Every component with its own VM is a group of one. Split them between the threads
+	const U32 taskCount = min(jobManager.getThreadCount(), ownVmComps.getSize());
+	for(U32 t = 0; t < taskCount; ++t)
+	{
+		jobManager.dispatchTask([&updateGroup, &ownVmComps, t, taskCount]([[maybe_unused]] U32 tid) {
+			for(U32 i = t; i < ownVmComps.getSize(); i += taskCount)
+			{
+				updateGroup(WeakArray<ScriptComponent*>(&ownVmComps[i], 1));
+			}
+		});
+	}
 
-	return Error::kNone;
+	jobManager.waitForAllTasksToFinish();
 }
 
 } // end namespace anki
@@ -14,7 +14,9 @@ namespace anki {
 /// @addtogroup scene
 /// @{
 
-/// Component of scripts.
+/// Component of scripts. The script's update(node, prevTime, crntTime) is called every frame and it should return a number. Zero means that nothing
+/// changed, a negative number is an error. An optional 2nd return value puts the script to sleep for that many seconds (math.huge sleeps until
+/// wakeUp() is called).
 class ScriptComponent : public SceneComponent
 {
 	ANKI_SCENE_COMPONENT(ScriptComponent)
@@ -31,10 +33,46 @@ public:
 		return m_script.isCreated();
 	}
 
+	/// How many times per second to call the update of the script. Zero means every frame.
+	void setUpdateFrequency(F32 timesPerSecond)
+	{
+		ANKI_ASSERT(timesPerSecond >= 0.0f);
+		m_updatePeriod = (timesPerSecond > 0.0f) ? 1.0 / timesPerSecond : 0.0;
+	}
+
+	/// Skip the update of the script for some time.
+	void sleep(Second duration)
+	{
+		m_nextUpdateTime = m_lastUpdateTime + duration;
+	}
+
+	/// Update the script in the next frame even if it sleeps.
+	void wakeUp()
+	{
+		m_nextUpdateTime = 0.0;
+	}
+
+	/// Call the update of all the scripts that are due. The scripts that share a VM are updated with a single call into the VM.
+	ANKI_INTERNAL static void updateAll(Second prevTime, Second crntTime, StackMemoryPool& framePool);
+
 private:
+	enum class UpdateResult : U8
+	{
+		kNotUpdated,
+		kUpdated,
+		kError
+	};
+
+	SceneNode* m_node = nullptr;
 	ScriptResourcePtr m_script;
 	ScriptEnvironment* m_env = nullptr;
 
+	Second m_updatePeriod = 0.0;
+	Second m_lastUpdateTime = 0.0;
+	Second m_nextUpdateTime = 0.0;
+
+	UpdateResult m_updateResult = UpdateResult::kNotUpdated; ///< Written by updateAll and consumed by update.
+
 	Error update(SceneComponentUpdateInfo& info, Bool& updated) override;
 };
 /// @}
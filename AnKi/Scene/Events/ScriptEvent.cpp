@@ -35,7 +35,7 @@ Error ScriptEvent::init(Second startTime, Second duration, CString script)
 		ANKI_CHECK(ResourceManager::getSingleton().loadResource(script, m_scriptRsrc));
 
 		// Exec the script
-		ANKI_CHECK(m_env.evalString(m_scriptRsrc->getSource()));
+		ANKI_CHECK(m_env.evalScript(m_scriptRsrc->getSource(), m_scriptRsrc->getFilename()));
 	}
 	else
 	{
@@ -9,6 +9,7 @@
 #include <AnKi/Collision/Obb.h>
 #include <AnKi/Collision/ConvexHullShape.h>
 #include <AnKi/Collision/Plane.h>
+#include <AnKi/Collision/BatchCulling.h>
 
 namespace anki {
 
@@ -186,6 +187,20 @@ public:
 		return true;
 	}
 
+	/// Check if a batch of shapes is inside the frustum. See testPlanes(ConstWeakArray<Plane>, const AabbSoa&, WeakArray<U64>).
+	void insideFrustum(const AabbSoa& aabbs, WeakArray<U64> insideMask) const
+	{
+		ANKI_ASSERT(!isDirty());
+		testPlanes(ConstWeakArray<Plane>(m_viewPlanesW), aabbs, insideMask);
+	}
+
+	/// @copydoc insideFrustum(const AabbSoa&, WeakArray<U64>) const
+	void insideFrustum(const SphereSoa& spheres, WeakArray<U64> insideMask) const
+	{
+		ANKI_ASSERT(!isDirty());
+		testPlanes(ConstWeakArray<Plane>(m_viewPlanesW), spheres, insideMask);
+	}
+
 	const ConvexHullShape& getPerspectiveBoundingShapeWorldSpace() const
 	{
 		ANKI_ASSERT(m_frustumType == FrustumType::kPerspective);
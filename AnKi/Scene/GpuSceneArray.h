@@ -9,6 +9,7 @@
 #include <AnKi/Core/GpuMemory/GpuSceneBuffer.h>
 #include <AnKi/Scene/SceneGraph.h>
 #include <AnKi/Util/Thread.h>
+#include <AnKi/Util/IndexAllocator.h>
 
 namespace anki {
 
@@ -96,10 +97,11 @@ class GpuSceneArray : public MakeSingleton<GpuSceneArray<TGpuSceneObject, kId>>
 public:
 	using Allocation = GpuSceneArrayAllocation<TGpuSceneObject, kId>;
 
+	/// The offset of the array as it was during the last flush(). The array may move to a bigger region of the GPU scene when it grows.
 	/// @note Thread-safe
 	PtrSize getGpuSceneOffsetOfArrayBase() const
 	{
-		return m_gpuSceneAllocation.getOffset();
+		return m_flushedGpuSceneOffset.load();
 	}
 
 	/// @note Thread-safe
@@ -109,11 +111,11 @@ public:
 	}
 
 	/// This count contains elements that may be innactive after a free. Frees in the middle of the array will not re-arrange other elements.
+	/// It's the count as it was during the last flush() so it's consistent with the data that the GPU scene will have after patching.
 	/// @note Thread-safe
 	U32 getElementCount() const
 	{
-		LockGuard lock(m_mtx);
-		return (m_inUseIndicesCount) ? m_maxInUseIndex + 1 : 0;
+		return m_flushedElementCount.load();
 	}
 
 	constexpr static U32 getElementSize()
@@ -127,7 +129,7 @@ public:
 		return {&GpuSceneBuffer::getSingleton().getBuffer(), getGpuSceneOffsetOfArrayBase(), getBufferRange()};
 	}
 
-	/// Some bookeeping. Needs to be called once per frame.
+	/// Some bookeeping. Needs to be called once per frame when the scene hands off its state to the renderer.
 	/// @note Thread-safe
 	void flush()
 	{
@@ -135,20 +137,20 @@ public:
 	}
 
 private:
-	using SubMask = BitSet<64, U64>;
-
 	GpuSceneBufferAllocation m_gpuSceneAllocation;
+	Atomic<U32> m_gpuSceneOffset = {0}; ///< Offset of m_gpuSceneAllocation. Read without locking.
+	Atomic<U32> m_flushedGpuSceneOffset = {0};
 
-	SceneDynamicArray<SubMask> m_inUseIndicesMask;
+	IndexAllocator<SingletonMemoryPoolWrapper<SceneMemoryPool>> m_indexAllocator;
 
-	U32 m_inUseIndicesCount = 0; ///< Doesn't count null elements.
 	U32 m_maxInUseIndex = 0; ///< Counts null elements.
+	Atomic<U32> m_flushedElementCount = {0};
 
-	SceneDynamicArray<U32> m_freedAllocations;
+	SceneDynamicArray<U32> m_freedAllocations; ///< Some of them might have been re-allocated in the same frame.
 
 	mutable SpinLock m_mtx;
 
-	GpuSceneArray(U32 maxArraySize);
+	GpuSceneArray(U32 initialArraySize);
 
 	~GpuSceneArray();
 
@@ -157,9 +159,13 @@ private:
 	U32 getGpuSceneOffset(const Allocation& idx) const
 	{
 		ANKI_ASSERT(idx.isValid());
-		return U32(getGpuSceneOffsetOfArrayBase() + sizeof(TGpuSceneObject) * idx.m_index);
+		return m_gpuSceneOffset.load() + U32(sizeof(TGpuSceneObject) * idx.m_index);
 	}
 
+	/// Move the array to a region of the GPU scene that is twice as big.
+	void grow();
+
+	/// Get the lowest free index. If the array is full it will grow.
 	/// @note Thread-safe
 	Allocation allocate();
 
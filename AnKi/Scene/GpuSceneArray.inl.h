@@ -10,14 +10,15 @@
 namespace anki {
 
 template<typename TGpuSceneObject, U32 kId>
-GpuSceneArray<TGpuSceneObject, kId>::GpuSceneArray(U32 maxArraySize)
+GpuSceneArray<TGpuSceneObject, kId>::GpuSceneArray(U32 initialArraySize)
 {
-	maxArraySize = getAlignedRoundUp(sizeof(SubMask), maxArraySize);
+	initialArraySize = getAlignedRoundUp(64u, max(initialArraySize, 1u));
 	const U32 alignment = GrManager::getSingleton().getDeviceCapabilities().m_storageBufferBindOffsetAlignment;
-	m_gpuSceneAllocation = GpuSceneBuffer::getSingleton().allocate(sizeof(TGpuSceneObject) * maxArraySize, alignment);
+	m_gpuSceneAllocation = GpuSceneBuffer::getSingleton().allocate(sizeof(TGpuSceneObject) * initialArraySize, alignment);
+	m_gpuSceneOffset.store(m_gpuSceneAllocation.getOffset());
+	m_flushedGpuSceneOffset.store(m_gpuSceneAllocation.getOffset());
 
-	m_inUseIndicesMask.resize(maxArraySize / sizeof(SubMask), false);
-	ANKI_ASSERT(m_inUseIndicesCount == 0);
+	m_indexAllocator.init(initialArraySize);
 	m_maxInUseIndex = 0;
 }
 
@@ -26,52 +27,46 @@ GpuSceneArray<TGpuSceneObject, kId>::~GpuSceneArray()
 {
 	flushInternal(false);
 	validate();
-	ANKI_ASSERT(m_inUseIndicesCount == 0 && "Forgot to free");
+	ANKI_ASSERT(m_indexAllocator.getAllocatedCount() == 0 && "Forgot to free");
 }
 
 template<typename TGpuSceneObject, U32 kId>
-GpuSceneArrayAllocation<TGpuSceneObject, kId> GpuSceneArray<TGpuSceneObject, kId>::allocate()
+void GpuSceneArray<TGpuSceneObject, kId>::grow()
 {
-	LockGuard lock(m_mtx);
-
-	U32 idx = kMaxU32;
-	if(m_freedAllocations.getSize())
+	const U32 oldArraySize = m_indexAllocator.getCapacity();
+	const U32 newArraySize = min(oldArraySize * 2, decltype(m_indexAllocator)::kMaxCapacity);
+	if(newArraySize == oldArraySize)
 	{
-		// There are freed indices this frame, use one
-
-		idx = m_freedAllocations[0];
-		m_freedAllocations.erase(m_freedAllocations.getBegin());
+		ANKI_SCENE_LOGF("Reached the limit of GPU scene objects");
 	}
-	else
-	{
-		// No freed indices this frame, get a new one
 
-		for(U32 maskGroup = 0; maskGroup < m_inUseIndicesMask.getSize(); ++maskGroup)
-		{
-			SubMask submask = m_inUseIndicesMask[maskGroup];
-			submask = ~submask;
-			const U32 bit = submask.getLeastSignificantBit();
-			if(bit != kMaxU32)
-			{
-				// Found an index
-				idx = maskGroup * 64 + bit;
-				break;
-			}
-		}
-	}
+	const U32 alignment = GrManager::getSingleton().getDeviceCapabilities().m_storageBufferBindOffsetAlignment;
+	GpuSceneBufferAllocation newAllocation = GpuSceneBuffer::getSingleton().allocate(sizeof(TGpuSceneObject) * newArraySize, alignment);
 
-	if(idx == kMaxU32)
+	// The old region stays alive for a few frames so the GPU can copy from it
+	GpuSceneMicroPatcher::getSingleton().relocate(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuSceneAllocation.getOffset(),
+												  newAllocation.getOffset(), sizeof(TGpuSceneObject) * oldArraySize);
+	GpuSceneBuffer::getSingleton().deferredFree(m_gpuSceneAllocation);
+	m_gpuSceneAllocation = std::move(newAllocation);
+	m_gpuSceneOffset.store(m_gpuSceneAllocation.getOffset());
+
+	m_indexAllocator.grow(newArraySize);
+}
+
+template<typename TGpuSceneObject, U32 kId>
+GpuSceneArrayAllocation<TGpuSceneObject, kId> GpuSceneArray<TGpuSceneObject, kId>::allocate()
+{
+	LockGuard lock(m_mtx);
+
+	if(m_indexAllocator.isFull()) [[unlikely]]
 	{
-		ANKI_SCENE_LOGF("Reached the limit of GPU scene objects");
+		grow();
 	}
 
-	ANKI_ASSERT(idx < m_inUseIndicesMask.getSize() * 64);
-
-	ANKI_ASSERT(m_inUseIndicesMask[idx / 64].get(idx % 64) == false);
-	m_inUseIndicesMask[idx / 64].set(idx % 64);
+	const U32 idx = m_indexAllocator.allocate();
+	ANKI_ASSERT(idx != kMaxU32);
 
 	m_maxInUseIndex = max(m_maxInUseIndex, idx);
-	++m_inUseIndicesCount;
 
 	Allocation out;
 	out.m_index = idx;
@@ -92,14 +87,7 @@ void GpuSceneArray<TGpuSceneObject, kId>::free(Allocation& alloc)
 	LockGuard lock(m_mtx);
 
 	m_freedAllocations.emplaceBack(idx);
-	ANKI_ASSERT(m_inUseIndicesMask[idx / 64].get(idx % 64) == true);
-	m_inUseIndicesMask[idx / 64].unset(idx % 64);
-
-	ANKI_ASSERT(m_inUseIndicesCount > 0);
-	--m_inUseIndicesCount;
-
-	// Sort because allocations later on should preferably grab the lowest index possible
-	std::sort(m_freedAllocations.getBegin(), m_freedAllocations.getEnd());
+	m_indexAllocator.free(idx);
 }
 
 template<typename TGpuSceneObject, U32 kId>
@@ -115,27 +103,27 @@ void GpuSceneArray<TGpuSceneObject, kId>::flushInternal(Bool nullifyElements)
 			TGpuSceneObject nullObj = {};
 			for(U32 idx : m_freedAllocations)
 			{
+				// Skip the ones that got re-allocated in this frame. The new owner has uploaded its own data
+				if(m_indexAllocator.isAllocated(idx))
+				{
+					continue;
+				}
+
 				const PtrSize offset = idx * sizeof(TGpuSceneObject) + m_gpuSceneAllocation.getOffset();
 				GpuSceneMicroPatcher::getSingleton().newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), offset, nullObj);
 			}
 		}
 
 		// Update the the last index
-		U32 maskGroup = m_maxInUseIndex / 64 + 1;
-		m_maxInUseIndex = 0;
-		while(maskGroup--)
-		{
-			const U32 bit = m_inUseIndicesMask[maskGroup].getMostSignificantBit();
-			if(bit != kMaxU32)
-			{
-				m_maxInUseIndex = maskGroup * 64 + bit;
-				break;
-			}
-		}
+		const U32 lastIdx = m_indexAllocator.findLastAllocated(m_maxInUseIndex);
+		m_maxInUseIndex = (lastIdx != kMaxU32) ? lastIdx : 0;
 
 		m_freedAllocations.destroy();
 	}
 
+	m_flushedElementCount.store((m_indexAllocator.getAllocatedCount()) ? m_maxInUseIndex + 1 : 0);
+	m_flushedGpuSceneOffset.store(m_gpuSceneAllocation.getOffset());
+
 	validate();
 }
 
@@ -143,18 +131,10 @@ template<typename TGpuSceneObject, U32 kId>
 void GpuSceneArray<TGpuSceneObject, kId>::validate() const
 {
 #if ANKI_ASSERTIONS_ENABLED
-	U32 count = 0;
-	U32 maxIdx = 0;
-	U32 maskGroupCount = 0;
-	for(const SubMask& mask : m_inUseIndicesMask)
-	{
-		count += mask.getSetBitCount();
-		maxIdx = max(maxIdx, (mask.getMostSignificantBit() != kMaxU32) ? (mask.getMostSignificantBit() + maskGroupCount * 64) : 0);
-		++maskGroupCount;
-	}
+	m_indexAllocator.validate();
 
-	ANKI_ASSERT(count == m_inUseIndicesCount);
-	ANKI_ASSERT(maxIdx == m_maxInUseIndex);
+	const U32 lastIdx = m_indexAllocator.findLastAllocated(kMaxU32);
+	ANKI_ASSERT(((lastIdx != kMaxU32) ? lastIdx : 0) == m_maxInUseIndex);
 #endif
 }
 
@@ -11,14 +11,14 @@ RenderStateBucketContainer::~RenderStateBucketContainer()
 {
 	for(RenderingTechnique t : EnumIterable<RenderingTechnique>())
 	{
-		for([[maybe_unused]] ExtendedBucket& b : m_buckets[t])
+		for([[maybe_unused]] ExtendedBucket& b : m_state.m_buckets[t])
 		{
 			ANKI_ASSERT(!b.m_program.isCreated() && b.m_userCount == 0 && b.m_lod0MeshletGroupCount == 0 && b.m_lod0MeshletCount == 0);
 		}
 
-		ANKI_ASSERT(m_bucketActiveUserCount[t] == 0);
-		ANKI_ASSERT(m_activeBucketCount[t] == 0);
-		ANKI_ASSERT(m_lod0MeshletGroupCount[t] == 0);
+		ANKI_ASSERT(m_state.m_bucketActiveUserCount[t] == 0);
+		ANKI_ASSERT(m_state.m_activeBucketCount[t] == 0);
+		ANKI_ASSERT(m_state.m_lod0MeshletGroupCount[t] == 0);
 	}
 }
 
@@ -33,16 +33,18 @@ RenderStateBucketIndex RenderStateBucketContainer::addUser(const RenderStateInfo
 
 	const U32 meshletGroupCount = (lod0MeshletCount + (kMeshletGroupSize - 1)) / kMeshletGroupSize;
 
-	SceneDynamicArray<ExtendedBucket>& buckets = m_buckets[technique];
+	SceneDynamicArray<ExtendedBucket>& buckets = m_state.m_buckets[technique];
 
 	RenderStateBucketIndex out;
 	out.m_technique = technique;
 
 	LockGuard lock(m_mtx);
 
-	++m_bucketActiveUserCount[technique];
-	m_lod0MeshletGroupCount[technique] += meshletGroupCount;
-	m_lod0MeshletCount[technique] += lod0MeshletCount;
+	m_stateChanged = true;
+
+	++m_state.m_bucketActiveUserCount[technique];
+	m_state.m_lod0MeshletGroupCount[technique] += meshletGroupCount;
+	m_state.m_lod0MeshletCount[technique] += lod0MeshletCount;
 
 	// Search bucket
 	for(U32 i = 0; i < buckets.getSize(); ++i)
@@ -58,7 +60,7 @@ RenderStateBucketIndex RenderStateBucketContainer::addUser(const RenderStateInfo
 				ANKI_ASSERT(!buckets[i].m_program.isCreated());
 				ANKI_ASSERT(buckets[i].m_lod0MeshletGroupCount == meshletGroupCount && buckets[i].m_lod0MeshletCount == lod0MeshletCount);
 				buckets[i].m_program = state.m_program;
-				++m_activeBucketCount[technique];
+				++m_state.m_activeBucketCount[technique];
 
 				createPerfOrder(technique);
 			}
@@ -83,7 +85,7 @@ RenderStateBucketIndex RenderStateBucketContainer::addUser(const RenderStateInfo
 	newBucket.m_lod0MeshletGroupCount = meshletGroupCount;
 	newBucket.m_lod0MeshletCount = lod0MeshletCount;
 
-	++m_activeBucketCount[technique];
+	++m_state.m_activeBucketCount[technique];
 
 	createPerfOrder(technique);
 
@@ -107,18 +109,20 @@ void RenderStateBucketContainer::removeUser(RenderStateBucketIndex& bucketIndex)
 
 	LockGuard lock(m_mtx);
 
-	ANKI_ASSERT(idx < m_buckets[technique].getSize());
+	m_stateChanged = true;
+
+	ANKI_ASSERT(idx < m_state.m_buckets[technique].getSize());
 
-	ANKI_ASSERT(m_bucketActiveUserCount[technique] > 0);
-	--m_bucketActiveUserCount[technique];
+	ANKI_ASSERT(m_state.m_bucketActiveUserCount[technique] > 0);
+	--m_state.m_bucketActiveUserCount[technique];
 
-	ANKI_ASSERT(m_lod0MeshletGroupCount[technique] >= meshletGroupCount);
-	m_lod0MeshletGroupCount[technique] -= meshletGroupCount;
+	ANKI_ASSERT(m_state.m_lod0MeshletGroupCount[technique] >= meshletGroupCount);
+	m_state.m_lod0MeshletGroupCount[technique] -= meshletGroupCount;
 
-	ANKI_ASSERT(m_lod0MeshletCount[technique] >= meshletCount);
-	m_lod0MeshletCount[technique] -= meshletCount;
+	ANKI_ASSERT(m_state.m_lod0MeshletCount[technique] >= meshletCount);
+	m_state.m_lod0MeshletCount[technique] -= meshletCount;
 
-	ExtendedBucket& bucket = m_buckets[technique][idx];
+	ExtendedBucket& bucket = m_state.m_buckets[technique][idx];
 	ANKI_ASSERT(bucket.m_userCount > 0 && bucket.m_program.isCreated() && bucket.m_lod0MeshletGroupCount >= meshletGroupCount
 				&& bucket.m_lod0MeshletCount >= meshletCount);
 
@@ -131,24 +135,35 @@ void RenderStateBucketContainer::removeUser(RenderStateBucketIndex& bucketIndex)
 		// No more users, make sure you release any references
 		bucket.m_program.reset(nullptr);
 
-		ANKI_ASSERT(m_activeBucketCount[technique] > 0);
-		--m_activeBucketCount[technique];
+		ANKI_ASSERT(m_state.m_activeBucketCount[technique] > 0);
+		--m_state.m_activeBucketCount[technique];
 
 		createPerfOrder(technique);
 	}
 }
 
+void RenderStateBucketContainer::latch()
+{
+	LockGuard lock(m_mtx);
+
+	if(m_stateChanged)
+	{
+		m_latchedState = m_state;
+		m_stateChanged = false;
+	}
+}
+
 void RenderStateBucketContainer::createPerfOrder(RenderingTechnique t)
 {
-	const U32 bucketCount = m_buckets[t].getSize();
+	const U32 bucketCount = m_state.m_buckets[t].getSize();
 
-	m_bucketPerfOrder[t].resize(bucketCount);
+	m_state.m_bucketPerfOrder[t].resize(bucketCount);
 	for(U32 i = 0; i < bucketCount; ++i)
 	{
-		m_bucketPerfOrder[t][i] = i;
+		m_state.m_bucketPerfOrder[t][i] = i;
 	}
 
-	std::sort(m_bucketPerfOrder[t].getBegin(), m_bucketPerfOrder[t].getBegin() + bucketCount, [&, this](U32 a, U32 b) {
+	std::sort(m_state.m_bucketPerfOrder[t].getBegin(), m_state.m_bucketPerfOrder[t].getBegin() + bucketCount, [&, this](U32 a, U32 b) {
 		auto getProgramHeaviness = [](const ShaderProgram& p) {
 			U64 size = U64(p.getShaderBinarySize(ShaderType::kFragment)) << 32u; // Fragment is more important
 			if(!!(p.getShaderTypes() & ShaderTypeBit::kVertex))
@@ -163,12 +178,12 @@ void RenderStateBucketContainer::createPerfOrder(RenderingTechnique t)
 			return size;
 		};
 
-		const Bool aIsActive = m_buckets[t][a].m_program.isCreated();
-		const Bool bIsActive = m_buckets[t][b].m_program.isCreated();
-		const Bool aHasDiscard = (aIsActive) ? m_buckets[t][a].m_program->hasDiscard() : false;
-		const Bool bHasDiscard = (bIsActive) ? m_buckets[t][b].m_program->hasDiscard() : false;
-		const U64 aProgramHeaviness = (aIsActive) ? getProgramHeaviness(*m_buckets[t][a].m_program) : 0;
-		const U64 bProgramHeaviness = (bIsActive) ? getProgramHeaviness(*m_buckets[t][b].m_program) : 0;
+		const Bool aIsActive = m_state.m_buckets[t][a].m_program.isCreated();
+		const Bool bIsActive = m_state.m_buckets[t][b].m_program.isCreated();
+		const Bool aHasDiscard = (aIsActive) ? m_state.m_buckets[t][a].m_program->hasDiscard() : false;
+		const Bool bHasDiscard = (bIsActive) ? m_state.m_buckets[t][b].m_program->hasDiscard() : false;
+		const U64 aProgramHeaviness = (aIsActive) ? getProgramHeaviness(*m_state.m_buckets[t][a].m_program) : 0;
+		const U64 bProgramHeaviness = (bIsActive) ? getProgramHeaviness(*m_state.m_buckets[t][b].m_program) : 0;
 
 		if(aHasDiscard != bHasDiscard)
 		{
@@ -90,11 +90,16 @@ public:
 	/// @note It's thread-safe against addUser and removeUser
 	void removeUser(RenderStateBucketIndex& bucketIndex);
 
+	/// Make the changes of addUser and removeUser visible to the iterate and get methods. The iterate and get methods will return the same
+	/// results until the next latch. That way the renderer can read the buckets while the scene is updating.
+	/// @note It's thread-safe against addUser and removeUser
+	void latch();
+
 	/// Iterate empty and non-empty buckets.
 	template<typename TFunc>
 	void iterateBuckets(RenderingTechnique technique, TFunc func) const
 	{
-		for(const ExtendedBucket& b : m_buckets[technique])
+		for(const ExtendedBucket& b : m_latchedState.m_buckets[technique])
 		{
 			func(static_cast<const RenderStateInfo&>(b), b.m_userCount, b.m_lod0MeshletGroupCount, b.m_lod0MeshletCount);
 		}
@@ -104,9 +109,9 @@ public:
 	template<typename TFunc>
 	void iterateBucketsPerformanceOrder(RenderingTechnique technique, TFunc func) const
 	{
-		for(U32 i : m_bucketPerfOrder[technique])
+		for(U32 i : m_latchedState.m_bucketPerfOrder[technique])
 		{
-			const ExtendedBucket& b = m_buckets[technique][i];
+			const ExtendedBucket& b = m_latchedState.m_buckets[technique][i];
 			func(static_cast<const RenderStateInfo&>(b), i, b.m_userCount, b.m_lod0MeshletGroupCount, b.m_lod0MeshletCount);
 		}
 	}
@@ -114,31 +119,31 @@ public:
 	/// Get the number of renderables of all the buckets of a specific rendering technique.
 	U32 getBucketsActiveUserCount(RenderingTechnique technique) const
 	{
-		return m_bucketActiveUserCount[technique];
+		return m_latchedState.m_bucketActiveUserCount[technique];
 	}
 
 	/// Get the number of meshlet groups of a technique.
 	U32 getBucketsLod0MeshletGroupCount(RenderingTechnique technique) const
 	{
-		return m_lod0MeshletGroupCount[technique];
+		return m_latchedState.m_lod0MeshletGroupCount[technique];
 	}
 
 	/// Get the number of meshlets of a technique of LOD 0.
 	U32 getBucketsLod0MeshletCount(RenderingTechnique technique) const
 	{
-		return m_lod0MeshletCount[technique];
+		return m_latchedState.m_lod0MeshletCount[technique];
 	}
 
 	/// Get number of empty and non-empty buckets.
 	U32 getBucketCount(RenderingTechnique technique) const
 	{
-		return m_buckets[technique].getSize();
+		return m_latchedState.m_buckets[technique].getSize();
 	}
 
 	/// Get number of non-empty buckets.
 	U32 getActiveBucketCount(RenderingTechnique technique) const
 	{
-		return m_activeBucketCount[technique];
+		return m_latchedState.m_activeBucketCount[technique];
 	}
 
 private:
@@ -151,12 +156,20 @@ private:
 		U32 m_lod0MeshletCount = 0;
 	};
 
-	Array<SceneDynamicArray<ExtendedBucket>, U32(RenderingTechnique::kCount)> m_buckets;
-	Array<U32, U32(RenderingTechnique::kCount)> m_bucketActiveUserCount = {};
-	Array<U32, U32(RenderingTechnique::kCount)> m_lod0MeshletGroupCount = {};
-	Array<U32, U32(RenderingTechnique::kCount)> m_lod0MeshletCount = {};
-	Array<U32, U32(RenderingTechnique::kCount)> m_activeBucketCount = {};
-	Array<SceneDynamicArray<U32>, U32(RenderingTechnique::kCount)> m_bucketPerfOrder; ///< Orders the buckets from the least heavy to the most.
+	class State
+	{
+	public:
+		Array<SceneDynamicArray<ExtendedBucket>, U32(RenderingTechnique::kCount)> m_buckets;
+		Array<U32, U32(RenderingTechnique::kCount)> m_bucketActiveUserCount = {};
+		Array<U32, U32(RenderingTechnique::kCount)> m_lod0MeshletGroupCount = {};
+		Array<U32, U32(RenderingTechnique::kCount)> m_lod0MeshletCount = {};
+		Array<U32, U32(RenderingTechnique::kCount)> m_activeBucketCount = {};
+		Array<SceneDynamicArray<U32>, U32(RenderingTechnique::kCount)> m_bucketPerfOrder; ///< Orders the buckets from the least heavy to the most.
+	};
+
+	State m_state; ///< The state that addUser and removeUser modify.
+	State m_latchedState; ///< A copy of m_state taken in latch().
+	Bool m_stateChanged = false;
 
 	Mutex m_mtx;
 
@@ -10,6 +10,7 @@
 #include <AnKi/Renderer/MainRenderer.h>
 #include <AnKi/Core/CVarSet.h>
 #include <AnKi/Core/StatsSet.h>
+#include <AnKi/Core/GpuMemory/GpuSceneBuffer.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Core/App.h>
@@ -37,12 +38,12 @@
 
 namespace anki {
 
-static StatCounter g_sceneUpdateTimeStatVar(StatCategory::kTime, "All scene update",
-											StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
-static StatCounter g_scenePhysicsTimeStatVar(StatCategory::kTime, "Physics",
-											 StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
+// Not kMainThreadUpdates because the update might run in the scene update thread (PipelinedFrames)
+static StatCounter g_sceneUpdateTimeStatVar(StatCategory::kTime, "All scene update", StatFlag::kMilisecond | StatFlag::kShowAverage);
+static StatCounter g_scenePhysicsTimeStatVar(StatCategory::kTime, "Physics", StatFlag::kMilisecond | StatFlag::kShowAverage);
 
-static NumericCVar<U32> g_octreeMaxDepthCVar(CVarSubsystem::kScene, "OctreeMaxDepth", 5, 2, 10, "The max depth of the octree");
+static NumericCVar<F32> g_spatialIndexFatMarginCVar(CVarSubsystem::kScene, "SpatialIndexFatMargin", 0.2f, 0.0f, 10.0f,
+													"How much the AABBs of the spatial index are enlarged to absorb small moves");
 
 NumericCVar<F32> g_probeEffectiveDistanceCVar(CVarSubsystem::kScene, "ProbeEffectiveDistance", 256.0f, 1.0f, kMaxF32,
 											  "How far various probes can render");
@@ -94,6 +95,11 @@ SceneGraph::~SceneGraph()
 
 	deleteNodesMarkedForDeletion();
 
+	if(m_spatialIndex)
+	{
+		deleteInstance(SceneMemoryPool::getSingleton(), m_spatialIndex);
+	}
+
 #define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) GpuSceneArrays::arrayName::freeSingleton();
 #include <AnKi/Scene/GpuSceneArrays.def.h>
 
@@ -104,7 +110,13 @@ Error SceneGraph::init(AllocAlignedCallback allocCallback, void* allocCallbackDa
 {
 	SceneMemoryPool::allocateSingleton(allocCallback, allocCallbackData);
 
-	m_framePool.init(allocCallback, allocCallbackData, 1_MB, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, "SceneGraphFramePool");
+	for(StackMemoryPool& pool : m_framePools)
+	{
+		pool.init(allocCallback, allocCallbackData, 1_MB, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, "SceneGraphFramePool");
+	}
+
+	m_spatialIndex =
+		newInstance<DynamicAabbTree>(SceneMemoryPool::getSingleton(), &SceneMemoryPool::getSingleton(), g_spatialIndexFatMarginCVar.get());
 
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<SceneNode>("mainCamera", m_defaultMainCam));
@@ -222,18 +234,48 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 
 	const Second startUpdateTime = HighRezTimer::getCurrentTime();
 
-	// Reset the framepool
-	m_framePool.reset();
+	swapFramePools();
+	deleteMarkedForDeletion();
+	ANKI_CHECK(simulate(prevUpdateTime, crntTime));
+	handoffToRenderer();
 
-	// Delete stuff
-	{
-		ANKI_TRACE_SCOPED_EVENT(SceneRemoveMarkedForDeletion);
-		const Bool fullCleanup = m_objectsMarkedForDeletionCount.load() != 0;
-		m_events.deleteEventsMarkedForDeletion(fullCleanup);
-		deleteNodesMarkedForDeletion();
-	}
+	g_sceneUpdateTimeStatVar.set((HighRezTimer::getCurrentTime() - startUpdateTime) * 1000.0);
+	return Error::kNone;
+}
+
+Error SceneGraph::pipelinedUpdate(Second prevUpdateTime, Second crntTime)
+{
+	ANKI_ASSERT(m_mainCam);
+	ANKI_TRACE_SCOPED_EVENT(SceneUpdate);
 
-	// Update
+	const Second startUpdateTime = HighRezTimer::getCurrentTime();
+
+	swapFramePools();
+	ANKI_CHECK(simulate(prevUpdateTime, crntTime));
+
+	g_sceneUpdateTimeStatVar.set((HighRezTimer::getCurrentTime() - startUpdateTime) * 1000.0);
+	return Error::kNone;
+}
+
+void SceneGraph::deleteMarkedForDeletion()
+{
+	ANKI_TRACE_SCOPED_EVENT(SceneRemoveMarkedForDeletion);
+	const Bool fullCleanup = m_objectsMarkedForDeletionCount.load() != 0;
+	m_events.deleteEventsMarkedForDeletion(fullCleanup);
+	deleteNodesMarkedForDeletion();
+}
+
+void SceneGraph::handoffToRenderer()
+{
+#define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) GpuSceneArrays::arrayName::getSingleton().flush();
+#include <AnKi/Scene/GpuSceneArrays.def.h>
+
+	RenderStateBucketContainer::getSingleton().latch();
+	GpuSceneMicroPatcher::getSingleton().latchCopies();
+}
+
+Error SceneGraph::simulate(Second prevUpdateTime, Second crntTime)
+{
 	{
 		ANKI_TRACE_SCOPED_EVENT(ScenePhysics);
 		const Second physicsUpdate = HighRezTimer::getCurrentTime();
@@ -247,6 +289,9 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		ANKI_TRACE_SCOPED_EVENT(SceneNodesUpdate);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
+		// Run the scripts before the nodes. The script components will pick the results up when their nodes update
+		ScriptComponent::updateAll(prevUpdateTime, crntTime, getFrameMemoryPool());
+
 		UpdateSceneNodesCtx updateCtx;
 		updateCtx.m_crntNode = m_nodes.getBegin();
 		updateCtx.m_prevUpdateTime = prevUpdateTime;
@@ -265,10 +310,11 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
 	}
 
-#define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) GpuSceneArrays::arrayName::getSingleton().flush();
-#include <AnKi/Scene/GpuSceneArrays.def.h>
+	{
+		ANKI_TRACE_SCOPED_EVENT(SceneSpatialIndexUpdate);
+		m_spatialIndex->update(&CoreThreadJobManager::getSingleton());
+	}
 
-	g_sceneUpdateTimeStatVar.set((HighRezTimer::getCurrentTime() - startUpdateTime) * 1000.0);
 	return Error::kNone;
 }
 
@@ -280,7 +326,7 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 
 	// Components update
 	SceneComponentUpdateInfo componentUpdateInfo(prevTime, crntTime);
-	componentUpdateInfo.m_framePool = &m_framePool;
+	componentUpdateInfo.m_framePool = &getFrameMemoryPool();
 
 	Bool atLeastOneComponentUpdated = false;
 	node.iterateComponents([&](SceneComponent& comp) {
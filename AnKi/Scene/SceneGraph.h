@@ -13,6 +13,7 @@
 #include <AnKi/Scene/Events/EventManager.h>
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Core/CVarSet.h>
+#include <AnKi/Collision/DynamicAabbTree.h>
 
 namespace anki {
 
@@ -54,7 +55,7 @@ public:
 
 	StackMemoryPool& getFrameMemoryPool() const
 	{
-		return m_framePool;
+		return m_framePools[m_crntFramePool];
 	}
 
 	SceneNode& getActiveCameraNode()
@@ -90,8 +91,20 @@ public:
 		return m_events;
 	}
 
+	/// Do a full scene update. It deletes what is marked for deletion, simulates and hands off the results to the renderer.
 	Error update(Second prevUpdateTime, Second crntTime);
 
+	/// Simulate only. It's meant to run in parallel with the renderer recording the previous frame so it doesn't delete anything and it
+	/// doesn't hand off to the renderer. The caller needs to call deleteMarkedForDeletion() and handoffToRenderer() when it's done and the
+	/// renderer is not recording.
+	Error pipelinedUpdate(Second prevUpdateTime, Second crntTime);
+
+	/// Delete the nodes and events that are marked for deletion.
+	void deleteMarkedForDeletion();
+
+	/// Make the results of the last update visible to the renderer (GPU scene counts, render state buckets and GPU scene patches).
+	void handoffToRenderer();
+
 	SceneNode& findSceneNode(const CString& name);
 	SceneNode* tryFindSceneNode(const CString& name);
 
@@ -152,6 +165,18 @@ public:
 		return m_componentArrays;
 	}
 
+	/// A BVH of the spatial components (models, lights, probes etc). The user data of the proxies are SceneComponent pointers. It's updated at
+	/// the end of the scene update so query it after that.
+	DynamicAabbTree& getSpatialIndex()
+	{
+		return *m_spatialIndex;
+	}
+
+	const DynamicAabbTree& getSpatialIndex() const
+	{
+		return *m_spatialIndex;
+	}
+
 	void addDirectionalLight(LightComponent* comp)
 	{
 		ANKI_ASSERT(m_dirLights.find(comp) == m_dirLights.getEnd());
@@ -221,7 +246,9 @@ private:
 		}
 	} m_initMemPoolDummy;
 
-	mutable StackMemoryPool m_framePool;
+	/// Double buffered because when pipelining the pool of an update needs to live until the renderer is done with it.
+	mutable Array<StackMemoryPool, 2> m_framePools;
+	U32 m_crntFramePool = 0;
 
 	IntrusiveList<SceneNode> m_nodes;
 	U32 m_nodesCount = 0;
@@ -243,6 +270,8 @@ private:
 
 	SceneComponentArrays m_componentArrays;
 
+	DynamicAabbTree* m_spatialIndex = nullptr;
+
 	SceneDynamicArray<LightComponent*> m_dirLights;
 	SceneDynamicArray<SkyboxComponent*> m_skyboxes;
 
@@ -257,6 +286,14 @@ private:
 	/// Delete the nodes that are marked for deletion
 	void deleteNodesMarkedForDeletion();
 
+	void swapFramePools()
+	{
+		m_crntFramePool = (m_crntFramePool + 1) % m_framePools.getSize();
+		m_framePools[m_crntFramePool].reset();
+	}
+
+	Error simulate(Second prevUpdateTime, Second crntTime);
+
 	Error updateNodes(UpdateSceneNodesCtx& ctx);
 	Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
 };
@@ -117,6 +117,61 @@ Error LuaBinder::evalString(lua_State* state, const CString& str)
 	return err;
 }
 
+Error LuaBinder::evalChunk(lua_State* state, const void* chunk, PtrSize chunkSize, I32 envRef)
+{
+	ANKI_TRACE_SCOPED_EVENT(LuaExec);
+
+	int e = luaL_loadbufferx(state, static_cast<const char*>(chunk), chunkSize, "=script", nullptr);
+	if(!e)
+	{
+		if(envRef != LUA_NOREF)
+		{
+			// The 1st upvalue of a main chunk is always the _ENV
+			lua_rawgeti(state, LUA_REGISTRYINDEX, envRef);
+			[[maybe_unused]] const char* upvalueName = lua_setupvalue(state, -2, 1);
+			ANKI_ASSERT(upvalueName);
+		}
+
+		e = lua_pcall(state, 0, 0, 0);
+	}
+
+	if(e)
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return Error::kUserData;
+	}
+
+	return Error::kNone;
+}
+
+Error LuaBinder::compileString(lua_State* state, const CString& str, const CString& name, ScriptDynamicArray<U8, PtrSize>& bytecode)
+{
+	ScriptString chunkName;
+	chunkName.sprintf("@%s", name.cstr());
+
+	if(luaL_loadbufferx(state, str.cstr(), str.getLength(), chunkName.cstr(), "t"))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return Error::kUserData;
+	}
+
+	auto writer = [](lua_State*, const void* data, size_t size, void* userData) -> int {
+		ScriptDynamicArray<U8, PtrSize>& out = *static_cast<ScriptDynamicArray<U8, PtrSize>*>(userData);
+		const PtrSize offset = out.getSize();
+		out.resize(offset + size);
+		memcpy(&out[offset], data, size);
+		return 0;
+	};
+
+	bytecode.destroy();
+	lua_dump(state, writer, &bytecode);
+	lua_pop(state, 1);
+
+	return Error::kNone;
+}
+
 void LuaBinder::createClass(lua_State* l, const LuaUserDataTypeInfo* typeInfo)
 {
 	ANKI_ASSERT(typeInfo);
@@ -240,11 +295,18 @@ Error LuaBinder::checkArgsCount(lua_State* l, I argsCount)
 	return Error::kNone;
 }
 
-void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback)
+void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback, I32 envRef)
 {
 	ANKI_ASSERT(l);
 
-	lua_pushglobaltable(l);
+	if(envRef != LUA_NOREF)
+	{
+		lua_rawgeti(l, LUA_REGISTRYINDEX, envRef);
+	}
+	else
+	{
+		lua_pushglobaltable(l);
+	}
 	lua_pushnil(l);
 
 	while(lua_next(l, -2) != 0)
@@ -344,14 +406,25 @@ void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback
 
 		lua_pop(l, 1);
 	}
+
+	lua_pop(l, 1); // Pop the table
 }
 
-void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize)
+void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize, I32 envRef)
 {
 	ANKI_ASSERT(dataSize > 0 && data);
 	const U8* ptr = static_cast<const U8*>(data);
 	const U8* end = ptr + dataSize;
 
+	if(envRef != LUA_NOREF)
+	{
+		lua_rawgeti(l, LUA_REGISTRYINDEX, envRef);
+	}
+	else
+	{
+		lua_pushglobaltable(l);
+	}
+
 	while(ptr < end)
 	{
 		// Get name
@@ -371,7 +444,7 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			const F64 val = *reinterpret_cast<const F64*>(ptr);
 			ptr += sizeof(F64);
 			lua_pushnumber(l, val);
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, -2, name.cstr());
 			break;
 		}
 		case LUA_TSTRING:
@@ -381,7 +454,7 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			ptr += len + 1;
 			ANKI_ASSERT(len > 0);
 			lua_pushstring(l, val.cstr());
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, -2, name.cstr());
 			break;
 		}
 		case LUA_TUSERDATA:
@@ -410,12 +483,14 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			typeInfo->m_deserializeCallback(ptr, *userData);
 			ptr += dataSize;
 			luaL_setmetatable(l, typeInfo->m_typeName);
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, -2, name.cstr());
 
 			break;
 		}
 		}
 	}
+
+	lua_pop(l, 1); // Pop the table
 }
 
 } // end namespace anki
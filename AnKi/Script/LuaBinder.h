@@ -11,6 +11,7 @@
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/Functions.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/WeakArray.h>
 #include <Lua/lua.hpp>
 #ifndef ANKI_LUA_HPP
 #	error "Wrong LUA header included"
@@ -178,6 +179,14 @@ public:
 	/// Evaluate a string
 	static Error evalString(lua_State* state, const CString& str);
 
+	/// Load a chunk of source or bytecode and run it.
+	/// @param envRef A reference (in the registry) to a table that will be the chunk's _ENV. If it's LUA_NOREF the chunk will use the globals.
+	static Error evalChunk(lua_State* state, const void* chunk, PtrSize chunkSize, I32 envRef = LUA_NOREF);
+
+	/// Compile a string to bytecode without running it.
+	/// @param name The name of the chunk. It will appear in the error messages.
+	static Error compileString(lua_State* state, const CString& str, const CString& name, ScriptDynamicArray<U8, PtrSize>& bytecode);
+
 	static void garbageCollect(lua_State* state)
 	{
 		lua_gc(state, LUA_GCCOLLECT, 0);
@@ -199,10 +208,12 @@ public:
 	static void pushLuaCFunc(lua_State* l, const char* name, lua_CFunction luafunc);
 
 	/// Dump global variables.
-	static void serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback);
+	/// @param envRef A reference (in the registry) to a table that holds the globals. If it's LUA_NOREF it will use the real globals.
+	static void serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback, I32 envRef = LUA_NOREF);
 
 	/// Deserialize global variables.
-	static void deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize);
+	/// @param envRef See serializeGlobals.
+	static void deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize, I32 envRef = LUA_NOREF);
 
 	/// Make sure that the arguments match the argsCount number
 	static Error checkArgsCount(lua_State* l, I argsCount);
@@ -0,0 +1,274 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Script/ScriptEnvironment.h>
+#include <AnKi/Script/ScriptManager.h>
+#include <AnKi/Util/Tracer.h>
+#include <AnKi/Util/HighRezTimer.h>
+
+namespace anki {
+
+/// Calls the functions of a number of environments. It catches the errors so one bad script won't stop the rest.
+static constexpr const char* kBatchCallSource = R"(
+local pcall = pcall
+
+return function(instances, results, funcName, first, last, arg1, arg2)
+	for i = first, last do
+		local instance = instances[i]
+		instances[i] = nil
+
+		local ok, ret, sleep = pcall(instance.env[funcName], instance.arg, arg1, arg2)
+		results[2 * i - 1] = ret
+		results[2 * i] = ok and (sleep or 0)
+	end
+end
+)";
+
+/// Push a table with the dispatcher function and the tables it works with. There is one per VM.
+static void pushBatchCallState(lua_State* l)
+{
+	lua_getfield(l, LUA_REGISTRYINDEX, "AnKiBatchCallState");
+	if(!lua_isnil(l, -1))
+	{
+		return;
+	}
+
+	lua_pop(l, 1);
+	lua_createtable(l, 3, 0);
+
+	[[maybe_unused]] const int err = luaL_loadstring(l, kBatchCallSource) || lua_pcall(l, 0, 1, 0);
+	ANKI_ASSERT(!err);
+	lua_rawseti(l, -2, 1);
+
+	lua_newtable(l);
+	lua_rawseti(l, -2, 2);
+
+	lua_newtable(l);
+	lua_rawseti(l, -2, 3);
+
+	lua_pushvalue(l, -1);
+	lua_setfield(l, LUA_REGISTRYINDEX, "AnKiBatchCallState");
+}
+
+ScriptEnvironment::ScriptEnvironment(Bool shareVm)
+{
+	if(!shareVm)
+	{
+		m_binder = newInstance<LuaBinder>(ScriptMemoryPool::getSingleton());
+		return;
+	}
+
+	m_binder = &ScriptManager::getSingleton().acquireSharedVm(m_sharedVmMtx, m_sharedVmIdx);
+
+	LockGuard lock(*m_sharedVmMtx);
+	lua_State* l = m_binder->getLuaState();
+
+	// Create the table that will hold the globals of the environment. Whatever is not there will be looked up in the real globals where the
+	// bindings live
+	lua_newtable(l);
+	if(luaL_newmetatable(l, "AnKiScriptEnvironment"))
+	{
+		// 1st time, populate the metatable that is shared by all environments
+		lua_pushglobaltable(l);
+		lua_setfield(l, -2, "__index");
+	}
+	lua_setmetatable(l, -2);
+
+	m_envRef = luaL_ref(l, LUA_REGISTRYINDEX);
+}
+
+ScriptEnvironment::~ScriptEnvironment()
+{
+	if(m_sharedVmMtx)
+	{
+		// Drop the globals. The GC will take care of the rest
+		LockGuard lock(*m_sharedVmMtx);
+		luaL_unref(m_binder->getLuaState(), LUA_REGISTRYINDEX, m_envRef);
+		luaL_unref(m_binder->getLuaState(), LUA_REGISTRYINDEX, m_batchCallInstanceRef);
+	}
+	else
+	{
+		deleteInstance(ScriptMemoryPool::getSingleton(), m_binder);
+	}
+}
+
+Error ScriptEnvironment::evalString(const CString& str)
+{
+	LockGuard lock(*this);
+
+	if(m_envRef == LUA_NOREF)
+	{
+		return LuaBinder::evalString(m_binder->getLuaState(), str);
+	}
+	else
+	{
+		// Don't garbage collect here. A full collection walks the environments of all the scripts that share the VM
+		return LuaBinder::evalChunk(m_binder->getLuaState(), str.cstr(), str.getLength(), m_envRef);
+	}
+}
+
+Error ScriptEnvironment::evalScript(const CString& source, const CString& name)
+{
+	const ScriptBytecode* bytecode;
+	ANKI_CHECK(ScriptManager::getSingleton().getOrCompileBytecode(source, name, bytecode));
+	m_scriptName = bytecode->m_name;
+
+	LockGuard lock(*this);
+
+	const Error err = LuaBinder::evalChunk(m_binder->getLuaState(), bytecode->m_bytecode.getBegin(), bytecode->m_bytecode.getSize(), m_envRef);
+
+	if(m_envRef == LUA_NOREF)
+	{
+		LuaBinder::garbageCollect(m_binder->getLuaState());
+	}
+
+	return err;
+}
+
+void ScriptEnvironment::pushGlobalTable()
+{
+	lua_State* l = m_binder->getLuaState();
+
+	if(m_envRef == LUA_NOREF)
+	{
+		lua_pushglobaltable(l);
+	}
+	else
+	{
+		lua_rawgeti(l, LUA_REGISTRYINDEX, m_envRef);
+	}
+}
+
+void ScriptEnvironment::pushGlobal(const CString& name)
+{
+	lua_State* l = m_binder->getLuaState();
+
+	if(m_envRef == LUA_NOREF)
+	{
+		lua_getglobal(l, name.cstr());
+	}
+	else
+	{
+		lua_rawgeti(l, LUA_REGISTRYINDEX, m_envRef);
+		lua_getfield(l, -1, name.cstr());
+		lua_remove(l, -2);
+	}
+}
+
+void ScriptEnvironment::createBatchCallInstance()
+{
+	lua_State* l = m_binder->getLuaState();
+
+	// The argument is at the top of the stack
+	lua_createtable(l, 0, 2);
+	lua_insert(l, -2);
+	lua_setfield(l, -2, "arg");
+	pushGlobalTable();
+	lua_setfield(l, -2, "env");
+
+	luaL_unref(l, LUA_REGISTRYINDEX, m_batchCallInstanceRef);
+	m_batchCallInstanceRef = luaL_ref(l, LUA_REGISTRYINDEX);
+}
+
+void ScriptEnvironment::batchCall(CString funcName, ConstWeakArray<ScriptEnvironment*> envs, F64 arg1, F64 arg2,
+								  WeakArray<ScriptBatchCallResult> results)
+{
+	ANKI_TRACE_SCOPED_EVENT(LuaBatchCall);
+	ANKI_ASSERT(envs.getSize() > 0 && envs.getSize() == results.getSize());
+
+	LockGuard lock(*envs[0]);
+	lua_State* l = envs[0]->m_binder->getLuaState();
+
+	pushBatchCallState(l);
+	const int stateIdx = lua_gettop(l);
+	lua_rawgeti(l, stateIdx, 2);
+	const int instancesIdx = lua_gettop(l);
+	lua_rawgeti(l, stateIdx, 3);
+	const int resultsIdx = lua_gettop(l);
+
+	// Gather the instances
+	for(U32 i = 0; i < envs.getSize(); ++i)
+	{
+		ScriptEnvironment& env = *envs[i];
+		ANKI_ASSERT(env.m_binder == envs[0]->m_binder && "All environments should share the VM");
+
+		if(env.m_batchCallInstanceRef == LUA_NOREF)
+		{
+			lua_pushnil(l);
+			env.createBatchCallInstance();
+		}
+
+		lua_rawgeti(l, LUA_REGISTRYINDEX, env.m_batchCallInstanceRef);
+		lua_rawseti(l, instancesIdx, I32(i + 1));
+	}
+
+	auto call = [&](U32 first, U32 last) {
+		lua_rawgeti(l, stateIdx, 1);
+		lua_pushvalue(l, instancesIdx);
+		lua_pushvalue(l, resultsIdx);
+		lua_pushstring(l, funcName.cstr());
+		lua_pushinteger(l, first + 1);
+		lua_pushinteger(l, last + 1);
+		lua_pushnumber(l, arg1);
+		lua_pushnumber(l, arg2);
+
+		if(lua_pcall(l, 7, 0, 0))
+		{
+			ANKI_SCRIPT_LOGE("Batch call failed: %s", lua_tostring(l, -1));
+			lua_pop(l, 1);
+		}
+	};
+
+#if ANKI_TRACING_ENABLED
+	if(Tracer::getSingleton().getEnabled())
+	{
+		// Call them one by one to time each script
+		for(U32 i = 0; i < envs.getSize(); ++i)
+		{
+			const Second begin = HighRezTimer::getCurrentTime();
+			call(i, i);
+			const CString name = envs[i]->m_scriptName;
+			Tracer::getSingleton().addCustomEvent((name.isEmpty()) ? "tLuaUnnamedScript" : name.cstr(), begin,
+												  HighRezTimer::getCurrentTime() - begin);
+		}
+	}
+	else
+#endif
+	{
+		call(0, envs.getSize() - 1);
+	}
+
+	// Gather the results
+	for(U32 i = 0; i < envs.getSize(); ++i)
+	{
+		ScriptBatchCallResult& result = results[i];
+
+		lua_rawgeti(l, resultsIdx, I32(2 * i + 1));
+		lua_rawgeti(l, resultsIdx, I32(2 * i + 2));
+
+		if(lua_isboolean(l, -1))
+		{
+			ANKI_SCRIPT_LOGE("Error running \"%s\" of script %s: %s", funcName.cstr(), envs[i]->m_scriptName.cstr(), lua_tostring(l, -2));
+			result.m_error = true;
+		}
+		else if(!lua_isnumber(l, -2))
+		{
+			ANKI_SCRIPT_LOGE("\"%s\" of script %s should return a number", funcName.cstr(), envs[i]->m_scriptName.cstr());
+			result.m_error = true;
+		}
+		else
+		{
+			result.m_return = lua_tonumber(l, -2);
+			result.m_sleep = lua_tonumber(l, -1);
+			result.m_error = false;
+		}
+
+		lua_pop(l, 2);
+	}
+
+	lua_pop(l, 3);
+}
+
+} // end namespace anki
@@ -6,46 +6,150 @@
 #pragma once
 
 #include <AnKi/Script/LuaBinder.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
 /// @addtogroup script
 /// @{
 
-/// A sandboxed LUA environment.
+/// The outcome of a function call of ScriptEnvironment::batchCall.
+/// @memberof ScriptEnvironment
+class ScriptBatchCallResult
+{
+public:
+	F64 m_return = 0.0; ///< The 1st value the function returned.
+	F64 m_sleep = 0.0; ///< The 2nd value the function returned. It's optional so it defaults to zero.
+	Bool m_error = false; ///< The function failed or it didn't return a number.
+};
+
+/// A sandboxed LUA environment. It either owns a LUA VM or it uses one of the VMs of the ScriptManager that are shared between many
+/// environments. In the later case the globals of the scripts live in a table that is private to the environment and everything that touches the
+/// VM needs to lock the environment first.
 class ScriptEnvironment
 {
 public:
+	/// @param shareVm See the class docs.
+	ScriptEnvironment(Bool shareVm = false);
+
+	ScriptEnvironment(const ScriptEnvironment&) = delete; // Non-copyable
+
+	~ScriptEnvironment();
+
+	ScriptEnvironment& operator=(const ScriptEnvironment&) = delete; // Non-copyable
+
 	/// Expose a variable to the scripting engine.
 	template<typename T>
 	void exposeVariable(const char* name, T* y)
 	{
-		LuaBinder::exposeVariable<T>(m_thread.getLuaState(), name, y);
+		LockGuard lock(*this);
+
+		if(m_envRef == LUA_NOREF)
+		{
+			LuaBinder::exposeVariable<T>(m_binder->getLuaState(), name, y);
+		}
+		else
+		{
+			lua_State* l = m_binder->getLuaState();
+			lua_rawgeti(l, LUA_REGISTRYINDEX, m_envRef);
+			LuaBinder::pushVariableToTheStack<T>(l, y);
+			lua_setfield(l, -2, name);
+			lua_pop(l, 1);
+		}
+	}
+
+	/// Set the 1st argument of the functions that batchCall() will call.
+	template<typename T>
+	void setBatchCallArgument(T* y)
+	{
+		LockGuard lock(*this);
+		LuaBinder::pushVariableToTheStack<T>(m_binder->getLuaState(), y);
+		createBatchCallInstance();
 	}
 
+	/// Call a global function of many environments that live in the same VM with a single call into the VM. It's the fast path for things like the
+	/// per frame updates. Each function is called as func(batchCallArgument, arg1, arg2) and it should return a number and optionally a 2nd number.
+	/// @note It will lock the environments.
+	static void batchCall(CString funcName, ConstWeakArray<ScriptEnvironment*> envs, F64 arg1, F64 arg2, WeakArray<ScriptBatchCallResult> results);
+
 	/// Evaluate a string
-	Error evalString(const CString& str)
+	Error evalString(const CString& str);
+
+	/// Same as evalString but it runs the bytecode that the ScriptManager compiled and cached. Use it for scripts that are loaded many times.
+	/// @param name The name of the script (usually the filename). See getScriptName().
+	Error evalScript(const CString& source, const CString& name = "script");
+
+	/// The name of the last script passed to evalScript(). The string lives as long as the ScriptManager.
+	CString getScriptName() const
 	{
-		return LuaBinder::evalString(m_thread.getLuaState(), str);
+		return m_scriptName;
 	}
 
 	void serializeGlobals(LuaBinderSerializeGlobalsCallback& callback)
 	{
-		LuaBinder::serializeGlobals(m_thread.getLuaState(), callback);
+		LockGuard lock(*this);
+		LuaBinder::serializeGlobals(m_binder->getLuaState(), callback, m_envRef);
 	}
 
 	void deserializeGlobals(const void* data, PtrSize dataSize)
 	{
-		LuaBinder::deserializeGlobals(m_thread.getLuaState(), data, dataSize);
+		LockGuard lock(*this);
+		LuaBinder::deserializeGlobals(m_binder->getLuaState(), data, dataSize, m_envRef);
 	}
 
+	/// Push the table that holds the globals of this environment to the stack.
+	/// @note Need to lock the environment if the VM is shared.
+	void pushGlobalTable();
+
+	/// Push a global of this environment to the stack.
+	/// @note Need to lock the environment if the VM is shared.
+	void pushGlobal(const CString& name);
+
+	/// @note Need to lock the environment if the VM is shared.
 	lua_State& getLuaState()
 	{
-		return *m_thread.getLuaState();
+		return *m_binder->getLuaState();
+	}
+
+	Bool isVmShared() const
+	{
+		return m_sharedVmMtx != nullptr;
+	}
+
+	/// The index of the shared VM. See ScriptManager::acquireSharedVm.
+	U32 getSharedVmIndex() const
+	{
+		ANKI_ASSERT(isVmShared());
+		return m_sharedVmIdx;
+	}
+
+	/// Lock the VM. Does nothing if the VM is not shared.
+	void lock()
+	{
+		if(m_sharedVmMtx)
+		{
+			m_sharedVmMtx->lock();
+		}
+	}
+
+	/// @copydoc lock
+	void unlock()
+	{
+		if(m_sharedVmMtx)
+		{
+			m_sharedVmMtx->unlock();
+		}
 	}
 
 private:
-	LuaBinder m_thread;
+	LuaBinder* m_binder = nullptr;
+	Mutex* m_sharedVmMtx = nullptr; ///< Non-null if the VM is shared.
+	I32 m_envRef = LUA_NOREF; ///< A reference to the table with the globals if the VM is shared.
+	U32 m_sharedVmIdx = kMaxU32;
+	CString m_scriptName;
+	I32 m_batchCallInstanceRef = LUA_NOREF; ///< A reference to a table with the globals and the argument of batchCall().
+
+	void createBatchCallInstance();
 };
 /// @}
 
@@ -6,6 +6,8 @@
 #include <AnKi/Script/ScriptManager.h>
 #include <AnKi/Script/ScriptEnvironment.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
 
 namespace anki {
 
@@ -19,15 +21,116 @@ ScriptManager::PoolInit ::~PoolInit()
 	ScriptMemoryPool::freeSingleton();
 }
 
-ScriptManager::ScriptManager(AllocAlignedCallback allocCb, void* allocCbData)
+ScriptManager::ScriptManager(AllocAlignedCallback allocCb, void* allocCbData, CString cacheDir, U32 sharedVmCount)
 	: m_poolInit(allocCb, allocCbData)
 {
 	ANKI_SCRIPT_LOGI("Initializing scripting");
+
+	m_cacheDir = cacheDir;
+
+	ANKI_ASSERT(sharedVmCount > 0);
+	m_sharedVms.resize(sharedVmCount, nullptr);
 }
 
 ScriptManager::~ScriptManager()
 {
 	ANKI_SCRIPT_LOGI("Destroying scripting");
+
+	for(SharedVm* vm : m_sharedVms)
+	{
+		deleteInstance(ScriptMemoryPool::getSingleton(), vm);
+	}
+
+	for(ScriptBytecode* bytecode : m_bytecodeCache)
+	{
+		deleteInstance(ScriptMemoryPool::getSingleton(), bytecode);
+	}
+}
+
+Error ScriptManager::getOrCompileBytecode(CString source, CString name, const ScriptBytecode*& bytecode)
+{
+	ANKI_ASSERT(!name.isEmpty());
+	const U64 hash = appendHash(name.cstr(), name.getLength(), computeHash(source.cstr(), source.getLength()));
+
+	LockGuard lock(m_bytecodeCacheMtx);
+
+	auto it = m_bytecodeCache.find(hash);
+	if(it != m_bytecodeCache.getEnd())
+	{
+		bytecode = *it;
+		return Error::kNone;
+	}
+
+	ScriptBytecode* newBytecode = newInstance<ScriptBytecode>(ScriptMemoryPool::getSingleton());
+	newBytecode->m_name = name;
+
+	// Try the cache dir
+	ScriptString fname;
+	Bool loaded = false;
+	if(!m_cacheDir.isEmpty())
+	{
+		fname.sprintf("%s/LuaBytecode_%016" PRIx64 ".luac", m_cacheDir.cstr(), hash);
+		if(fileExists(fname))
+		{
+			File file;
+			if(!file.open(fname, FileOpenFlag::kRead | FileOpenFlag::kBinary))
+			{
+				newBytecode->m_bytecode.resize(file.getSize());
+				loaded = newBytecode->m_bytecode.getSize() > 0 && !file.read(newBytecode->m_bytecode.getBegin(), newBytecode->m_bytecode.getSize());
+			}
+		}
+	}
+
+	// Compile
+	if(!loaded)
+	{
+		Error err = Error::kNone;
+		{
+			LockGuard lock2(n_luaMtx);
+			err = LuaBinder::compileString(m_lua.getLuaState(), source, name, newBytecode->m_bytecode);
+		}
+
+		if(err)
+		{
+			deleteInstance(ScriptMemoryPool::getSingleton(), newBytecode);
+			return err;
+		}
+
+		if(!fname.isEmpty())
+		{
+			File file;
+			if(file.open(fname, FileOpenFlag::kWrite | FileOpenFlag::kBinary)
+			   || file.write(newBytecode->m_bytecode.getBegin(), newBytecode->m_bytecode.getSize()))
+			{
+				ANKI_SCRIPT_LOGW("Failed to write the bytecode to the cache: %s", fname.cstr());
+			}
+		}
+	}
+
+	m_bytecodeCache.emplace(hash, newBytecode);
+	bytecode = newBytecode;
+	return Error::kNone;
+}
+
+LuaBinder& ScriptManager::acquireSharedVm(Mutex*& mtx, U32& vmIdx)
+{
+	const U32 idx = m_nextSharedVm.fetchAdd(1) % m_sharedVms.getSize();
+	vmIdx = idx;
+
+	SharedVm* vm;
+	{
+		// Create the VMs lazily because their creation is not cheap
+		LockGuard lock(m_sharedVmsMtx);
+		if(m_sharedVms[idx] == nullptr)
+		{
+			m_sharedVms[idx] = newInstance<SharedVm>(ScriptMemoryPool::getSingleton());
+		}
+
+		vm = m_sharedVms[idx];
+	}
+
+	mtx = &vm->m_mtx;
+	return vm->m_binder;
 }
 
 } // end namespace anki
@@ -12,6 +12,14 @@ namespace anki {
 /// @addtogroup script
 /// @{
 
+/// The bytecode of a script. It's owned by the ScriptManager.
+class ScriptBytecode
+{
+public:
+	ScriptDynamicArray<U8, PtrSize> m_bytecode;
+	ScriptString m_name;
+};
+
 /// The scripting manager.
 class ScriptManager : public MakeSingleton<ScriptManager>
 {
@@ -39,6 +47,25 @@ public:
 		return m_lua;
 	}
 
+	/// Compile a script to LUA bytecode. The bytecode is cached in memory and in the cache directory (if there is one) so every source is compiled
+	/// once.
+	/// @param source The source of the script.
+	/// @param name The name of the script (usually the filename). Used in error messages and in the tracer.
+	/// @param[out] bytecode The bytecode. It stays valid as long as the ScriptManager is alive.
+	/// @note Thread-safe
+	Error getOrCompileBytecode(CString source, CString name, const ScriptBytecode*& bytecode);
+
+	/// Pick one of the VMs that are shared between many ScriptEnvironments. The VMs are assigned in a round robin fashion.
+	/// @param[out] mtx The mutex that protects the VM.
+	/// @param[out] vmIdx The index of the VM. It's less than getSharedVmCount().
+	/// @note Thread-safe
+	ANKI_INTERNAL LuaBinder& acquireSharedVm(Mutex*& mtx, U32& vmIdx);
+
+	U32 getSharedVmCount() const
+	{
+		return m_sharedVms.getSize();
+	}
+
 private:
 	class PoolInit
 	{
@@ -48,11 +75,29 @@ private:
 		~PoolInit();
 	};
 
+	class SharedVm
+	{
+	public:
+		LuaBinder m_binder;
+		Mutex m_mtx;
+	};
+
 	PoolInit m_poolInit;
 	LuaBinder m_lua;
 	Mutex n_luaMtx;
 
-	ScriptManager(AllocAlignedCallback allocCb, void* allocCbData);
+	ScriptString m_cacheDir;
+
+	ScriptHashMap<U64, ScriptBytecode*> m_bytecodeCache;
+	Mutex m_bytecodeCacheMtx;
+
+	ScriptDynamicArray<SharedVm*> m_sharedVms;
+	Atomic<U32> m_nextSharedVm = {0};
+	Mutex m_sharedVmsMtx;
+
+	/// @param cacheDir A directory to store the bytecode of the scripts. Can be empty.
+	/// @param sharedVmCount The max number of VMs that will be shared between the ScriptEnvironments. See acquireSharedVm.
+	ScriptManager(AllocAlignedCallback allocCb, void* allocCbData, CString cacheDir = {}, U32 sharedVmCount = 1);
 
 	~ScriptManager();
 };
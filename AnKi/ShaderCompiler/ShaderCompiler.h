@@ -14,23 +14,44 @@ namespace anki {
 /// @addtogroup shader_compiler
 /// @{
 
-inline constexpr const char* kShaderBinaryMagic = "ANKISP1"; // WARNING: If changed change kShaderBinaryVersion
-constexpr U32 kShaderBinaryVersion = 1;
+inline constexpr const char* kShaderBinaryMagic = "ANKISP2"; // WARNING: If changed change kShaderBinaryVersion
+constexpr U32 kShaderBinaryVersion = 2;
+
+inline Error checkShaderBinaryMagic(const ShaderBinary& binary)
+{
+	if(memcmp(kShaderBinaryMagic, &binary.m_magic[0], strlen(kShaderBinaryMagic)) != 0)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Corrupted or wrong version of shader binary.");
+		return Error::kUserData;
+	}
+
+	return Error::kNone;
+}
 
 template<typename TFile>
 Error deserializeShaderBinaryFromAnyFile(TFile& file, ShaderBinary*& binary, BaseMemoryPool& pool)
 {
 	BinaryDeserializer deserializer;
 	ANKI_CHECK(deserializer.deserialize(binary, pool, file));
-	if(memcmp(kShaderBinaryMagic, &binary->m_magic[0], strlen(kShaderBinaryMagic)) != 0)
+	if(checkShaderBinaryMagic(*binary))
 	{
-		ANKI_SHADER_COMPILER_LOGE("Corrupted or wrong version of shader binary.");
+		pool.free(binary);
+		binary = nullptr;
 		return Error::kUserData;
 	}
 
 	return Error::kNone;
 }
 
+/// Use the contents of a shader binary file in place. See BinaryDeserializer::deserializeInPlace.
+/// @param blob The whole file. It will be modified.
+/// @param[out] binary Points inside the blob.
+inline Error deserializeShaderBinaryInPlace(WeakArray<U8, PtrSize> blob, ShaderBinary*& binary)
+{
+	ANKI_CHECK(BinaryDeserializer::deserializeInPlace(binary, blob));
+	return checkShaderBinaryMagic(*binary);
+}
+
 inline Error deserializeShaderBinaryFromFile(CString fname, ShaderBinary*& binary, BaseMemoryPool& pool)
 {
 	File file;
@@ -165,6 +165,20 @@ void Canvas::beginBuilding()
 
 	ImGui::NewFrame();
 	ImGui::PushFont(&m_font->getImFont(m_dfltFontHeight));
+
+	m_building = true;
+}
+
+void Canvas::endBuilding()
+{
+	ANKI_ASSERT(m_building);
+	ImGui::SetCurrentContext(m_imCtx);
+
+	ImGui::PopFont();
+	ImGui::Render();
+
+	ImGui::SetCurrentContext(nullptr);
+	m_building = false;
 }
 
 void Canvas::pushFont(const FontPtr& font, U32 fontHeight)
@@ -175,6 +189,14 @@ void Canvas::pushFont(const FontPtr& font, U32 fontHeight)
 
 void Canvas::appendToCommandBuffer(CommandBuffer& cmdb)
 {
+	if(m_building)
+	{
+		endBuilding();
+	}
+
+	// The building might have happened in another thread, the context is thread local
+	ImGui::SetCurrentContext(m_imCtx);
+
 	appendToCommandBufferInternal(cmdb);
 
 	// Done
@@ -185,8 +207,6 @@ void Canvas::appendToCommandBuffer(CommandBuffer& cmdb)
 
 void Canvas::appendToCommandBufferInternal(CommandBuffer& cmdb)
 {
-	ImGui::PopFont();
-	ImGui::Render();
 	ImDrawData& drawData = *ImGui::GetDrawData();
 
 	// Allocate index and vertex buffers
@@ -63,6 +63,10 @@ public:
 		ImGui::PopFont();
 	}
 
+	/// Stop building the UI. The UI can be appended to a command buffer after that, even from a different thread. If it's not called
+	/// appendToCommandBuffer() will call it.
+	void endBuilding();
+
 	void appendToCommandBuffer(CommandBuffer& cmdb);
 	/// @}
 
@@ -72,6 +76,7 @@ private:
 	ImGuiContext* m_imCtx = nullptr;
 	U32 m_width;
 	U32 m_height;
+	Bool m_building = false;
 
 	enum ShaderType
 	{
@@ -6,6 +6,7 @@
 #include <AnKi/Util/Assert.h>
 #include <AnKi/Util/System.h>
 #include <AnKi/Util/Functions.h>
+#include <AnKi/Util/Logger.h>
 #include <cstdlib>
 #include <cstdio>
 #if ANKI_OS_ANDROID
@@ -18,6 +19,12 @@ namespace anki {
 
 void akassert(const char* exprTxt, const char* file, int line, const char* func)
 {
+	// Write the log messages that are still queued. They might explain the assertion
+	if(Logger::isAllocated())
+	{
+		Logger::getSingleton().flush();
+	}
+
 #	if ANKI_OS_ANDROID
 	__android_log_print(ANDROID_LOG_ERROR, "AnKi", "Assertion failed: %s (%s:%d %s)", exprTxt, file, line, func);
 #	else
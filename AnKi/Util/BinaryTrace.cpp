@@ -0,0 +1,257 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/BinaryTrace.h>
+
+namespace anki {
+
+/// Reads varints from a payload.
+class BinaryTraceVarintReader
+{
+public:
+	ConstWeakArray<U8, PtrSize> m_data;
+	PtrSize m_pos = 0;
+
+	Error read(U64& out)
+	{
+		out = 0;
+		U32 shift = 0;
+		while(true)
+		{
+			if(m_pos >= m_data.getSize() || shift >= 64)
+			{
+				ANKI_UTIL_LOGE("Binary trace: Corrupted varint");
+				return Error::kUserData;
+			}
+
+			const U8 byte = m_data[m_pos++];
+			out |= U64(byte & 0x7Fu) << shift;
+			shift += 7;
+
+			if((byte & 0x80u) == 0)
+			{
+				break;
+			}
+		}
+
+		return Error::kNone;
+	}
+};
+
+void BinaryTraceWriter::writeHeader()
+{
+	writeBytes(&kBinaryTraceMagic[0], sizeof(kBinaryTraceMagic));
+}
+
+void BinaryTraceWriter::writeDropped(U64 frame, U64 droppedEventCount, U64 droppedCounterCount)
+{
+	const PtrSize recordBegin = beginRecord(BinaryTraceRecordType::kDropped);
+	writeVarint(frame);
+	writeVarint(droppedEventCount);
+	writeVarint(droppedCounterCount);
+	endRecord(recordBegin);
+}
+
+U32 BinaryTraceWriter::internString(CString str)
+{
+	const U64 hash = str.computeHash();
+	auto it = m_stringIds.find(hash);
+	if(it != m_stringIds.getEnd())
+	{
+		return *it;
+	}
+
+	const U32 id = m_nextStringId++;
+	m_stringIds.emplace(hash, id);
+
+	const PtrSize recordBegin = beginRecord(BinaryTraceRecordType::kString);
+	writeVarint(id);
+	writeVarint(str.getLength());
+	writeBytes(str.cstr(), str.getLength());
+	endRecord(recordBegin);
+
+	return id;
+}
+
+PtrSize BinaryTraceWriter::beginRecord(BinaryTraceRecordType type)
+{
+	const PtrSize recordBegin = m_bufferSize;
+	const U8 typeu8 = U8(type);
+	const U32 placeholderSize = 0;
+	writeBytes(&typeu8, sizeof(typeu8));
+	writeBytes(&placeholderSize, sizeof(placeholderSize));
+	return recordBegin;
+}
+
+void BinaryTraceWriter::endRecord(PtrSize recordBegin)
+{
+	const PtrSize payloadSize = m_bufferSize - recordBegin - kBinaryTraceRecordHeaderSize;
+	ANKI_ASSERT(payloadSize <= kMaxU32);
+	const U32 payloadSizeU32 = U32(payloadSize);
+	memcpy(&m_buffer[recordBegin + sizeof(U8)], &payloadSizeU32, sizeof(payloadSizeU32));
+}
+
+void BinaryTraceWriter::writeVarint(U64 value)
+{
+	Array<U8, 10> bytes;
+	U32 count = 0;
+	do
+	{
+		U8 byte = U8(value & 0x7Fu);
+		value >>= 7;
+		if(value)
+		{
+			byte |= 0x80u;
+		}
+		bytes[count++] = byte;
+	} while(value);
+
+	writeBytes(&bytes[0], count);
+}
+
+void BinaryTraceWriter::writeBytes(const void* data, PtrSize size)
+{
+	if(m_bufferSize + size > m_buffer.getSize())
+	{
+		m_buffer.resize(max<PtrSize>(m_bufferSize + size, m_buffer.getSize() * 2));
+	}
+
+	memcpy(&m_buffer[m_bufferSize], data, size);
+	m_bufferSize += size;
+}
+
+Error BinaryTraceReader::decode(ConstWeakArray<U8, PtrSize> data, BinaryTraceVisitor& visitor, PtrSize& bytesConsumed)
+{
+	bytesConsumed = 0;
+
+	if(!m_headerRead)
+	{
+		if(data.getSize() < sizeof(kBinaryTraceMagic))
+		{
+			return Error::kNone;
+		}
+
+		if(memcmp(&data[0], &kBinaryTraceMagic[0], sizeof(kBinaryTraceMagic)) != 0)
+		{
+			ANKI_UTIL_LOGE("Binary trace: Wrong magic");
+			return Error::kUserData;
+		}
+
+		m_headerRead = true;
+		bytesConsumed += sizeof(kBinaryTraceMagic);
+	}
+
+	while(data.getSize() - bytesConsumed >= kBinaryTraceRecordHeaderSize)
+	{
+		const U8 type = data[bytesConsumed];
+		U32 payloadSize;
+		memcpy(&payloadSize, &data[bytesConsumed + sizeof(U8)], sizeof(payloadSize));
+
+		if(data.getSize() - bytesConsumed - kBinaryTraceRecordHeaderSize < payloadSize)
+		{
+			// Incomplete record, wait for more data
+			break;
+		}
+
+		const ConstWeakArray<U8, PtrSize> payload(&data[bytesConsumed + kBinaryTraceRecordHeaderSize], payloadSize);
+		if(type < U8(BinaryTraceRecordType::kCount))
+		{
+			ANKI_CHECK(decodeRecord(BinaryTraceRecordType(type), payload, visitor));
+		}
+		else
+		{
+			// Unknown record, skip it to be forward compatible
+		}
+
+		bytesConsumed += kBinaryTraceRecordHeaderSize + payloadSize;
+	}
+
+	return Error::kNone;
+}
+
+Error BinaryTraceReader::decodeRecord(BinaryTraceRecordType type, ConstWeakArray<U8, PtrSize> payload, BinaryTraceVisitor& visitor)
+{
+	BinaryTraceVarintReader reader;
+	reader.m_data = payload;
+
+	switch(type)
+	{
+	case BinaryTraceRecordType::kString:
+	{
+		U64 id, length;
+		ANKI_CHECK(reader.read(id));
+		ANKI_CHECK(reader.read(length));
+		if(reader.m_pos + length > payload.getSize() || id > kMaxU32)
+		{
+			ANKI_UTIL_LOGE("Binary trace: Corrupted string record");
+			return Error::kUserData;
+		}
+
+		if(id >= m_strings.getSize())
+		{
+			m_strings.resize(U32(id + 1), BaseString<Pool>(m_pool));
+		}
+
+		const Char* begin = reinterpret_cast<const Char*>(&payload[reader.m_pos]);
+		m_strings[U32(id)] = BaseString<Pool>(begin, begin + length, m_pool);
+		break;
+	}
+	case BinaryTraceRecordType::kThreadEvents:
+	{
+		U64 tid, frame, count;
+		ANKI_CHECK(reader.read(tid));
+		ANKI_CHECK(reader.read(frame));
+		ANKI_CHECK(reader.read(count));
+
+		U64 start = 0;
+		for(U64 i = 0; i < count; ++i)
+		{
+			U64 nameId, zigzagDelta, duration;
+			ANKI_CHECK(reader.read(nameId));
+			ANKI_CHECK(reader.read(zigzagDelta));
+			ANKI_CHECK(reader.read(duration));
+
+			const I64 delta = I64(zigzagDelta >> 1u) ^ -I64(zigzagDelta & 1u);
+			start += U64(delta);
+
+			visitor.visitEvent(tid, frame, getString(nameId), start, duration);
+		}
+		break;
+	}
+	case BinaryTraceRecordType::kCounters:
+	{
+		U64 frame, timestamp, count;
+		ANKI_CHECK(reader.read(frame));
+		ANKI_CHECK(reader.read(timestamp));
+		ANKI_CHECK(reader.read(count));
+
+		for(U64 i = 0; i < count; ++i)
+		{
+			U64 nameId, value;
+			ANKI_CHECK(reader.read(nameId));
+			ANKI_CHECK(reader.read(value));
+
+			visitor.visitCounter(frame, timestamp, getString(nameId), value);
+		}
+		break;
+	}
+	case BinaryTraceRecordType::kDropped:
+	{
+		U64 frame, droppedEvents, droppedCounters;
+		ANKI_CHECK(reader.read(frame));
+		ANKI_CHECK(reader.read(droppedEvents));
+		ANKI_CHECK(reader.read(droppedCounters));
+
+		visitor.visitDropped(frame, droppedEvents, droppedCounters);
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
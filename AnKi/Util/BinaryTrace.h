@@ -0,0 +1,216 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/String.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup util_other
+/// @{
+
+/// The binary trace is a stream of records that follow a small header. Every record is a U8 type, a U32 payload size and the payload. Integers
+/// inside the payload are LEB128 varints. Event and counter names are interned and sent once as kString records. Event timestamps are in
+/// nanoseconds and they are delta-encoded inside a per-thread block.
+/// @memberof BinaryTraceWriter
+enum class BinaryTraceRecordType : U8
+{
+	kString, ///< varint id, varint length, chars.
+	kThreadEvents, ///< varint tid, varint frame, varint count, then count x (varint nameId, zigzag varint start delta, varint duration).
+	kCounters, ///< varint frame, varint timestamp, varint count, then count x (varint nameId, varint value).
+	kDropped, ///< varint frame, varint dropped event count, varint dropped counter count.
+
+	kCount
+};
+
+/// @memberof BinaryTraceWriter
+inline constexpr Array<Char, 8> kBinaryTraceMagic = {'A', 'N', 'K', 'I', 'T', 'R', 'C', '1'};
+
+/// @memberof BinaryTraceWriter
+inline constexpr U32 kBinaryTraceRecordHeaderSize = sizeof(U8) + sizeof(U32);
+
+/// Encodes trace events and counters to the binary trace format. It doesn't do any IO, it just populates a buffer.
+class BinaryTraceWriter
+{
+public:
+	BinaryTraceWriter(BaseMemoryPool* pool)
+		: m_buffer(pool)
+		, m_stringIds(pool)
+	{
+	}
+
+	BinaryTraceWriter(const BinaryTraceWriter&) = delete; // Non-copyable
+
+	BinaryTraceWriter& operator=(const BinaryTraceWriter&) = delete; // Non-copyable
+
+	/// Append the file header.
+	void writeHeader();
+
+	/// Append a block of events of a single thread. TEvent needs to have m_name (CString), m_start (Second) and m_duration (Second) members.
+	/// Events sorted by start time will produce a smaller stream.
+	template<typename TEvent>
+	void writeThreadEvents(U64 tid, U64 frame, ConstWeakArray<TEvent> events)
+	{
+		if(events.getSize() == 0)
+		{
+			return;
+		}
+
+		// Intern first so the string records land before the event block
+		for(const TEvent& e : events)
+		{
+			internString(e.m_name);
+		}
+
+		const PtrSize recordBegin = beginRecord(BinaryTraceRecordType::kThreadEvents);
+		writeVarint(tid);
+		writeVarint(frame);
+		writeVarint(events.getSize());
+
+		U64 prevStart = 0;
+		for(const TEvent& e : events)
+		{
+			const U64 start = secondsToNanoseconds(e.m_start);
+			writeVarint(internString(e.m_name));
+			writeVarint(zigzagEncode(I64(start - prevStart)));
+			writeVarint(secondsToNanoseconds(e.m_duration));
+			prevStart = start;
+		}
+
+		endRecord(recordBegin);
+	}
+
+	/// Append the counters of a frame. TCounter needs to have m_name (CString) and m_value (U64) members.
+	template<typename TCounter>
+	void writeCounters(U64 frame, Second timestamp, ConstWeakArray<TCounter> counters)
+	{
+		if(counters.getSize() == 0)
+		{
+			return;
+		}
+
+		for(const TCounter& c : counters)
+		{
+			internString(c.m_name);
+		}
+
+		const PtrSize recordBegin = beginRecord(BinaryTraceRecordType::kCounters);
+		writeVarint(frame);
+		writeVarint(secondsToNanoseconds(timestamp));
+		writeVarint(counters.getSize());
+		for(const TCounter& c : counters)
+		{
+			writeVarint(internString(c.m_name));
+			writeVarint(c.m_value);
+		}
+
+		endRecord(recordBegin);
+	}
+
+	/// Append a record that informs the reader that some data got lost.
+	void writeDropped(U64 frame, U64 droppedEventCount, U64 droppedCounterCount);
+
+	/// Get the data written since the last resetBuffer().
+	ConstWeakArray<U8, PtrSize> getBuffer() const
+	{
+		return ConstWeakArray<U8, PtrSize>((m_bufferSize) ? &m_buffer[0] : nullptr, m_bufferSize);
+	}
+
+	/// Reset the buffer but keep its memory and the interned strings.
+	void resetBuffer()
+	{
+		m_bufferSize = 0;
+	}
+
+	/// Forget all interned strings. Use it when starting a new stream.
+	void resetStrings()
+	{
+		m_stringIds.destroy();
+		m_nextStringId = 0;
+	}
+
+private:
+	using Pool = MemoryPoolPtrWrapper<BaseMemoryPool>;
+
+	DynamicArray<U8, Pool, PtrSize> m_buffer;
+	PtrSize m_bufferSize = 0;
+	HashMap<U64, U32, DefaultHasher<U64>, Pool> m_stringIds; ///< Hash of the string to ID.
+	U32 m_nextStringId = 0;
+
+	U32 internString(CString str);
+
+	PtrSize beginRecord(BinaryTraceRecordType type);
+
+	void endRecord(PtrSize recordBegin);
+
+	void writeVarint(U64 value);
+
+	void writeBytes(const void* data, PtrSize size);
+
+	static U64 secondsToNanoseconds(Second s)
+	{
+		return (s > 0.0) ? U64(s * 1000000000.0) : 0;
+	}
+
+	static U64 zigzagEncode(I64 v)
+	{
+		return (U64(v) << 1u) ^ U64(v >> 63);
+	}
+};
+
+/// The interface that BinaryTraceReader uses to pass the decoded data.
+class BinaryTraceVisitor
+{
+public:
+	virtual void visitEvent(U64 tid, U64 frame, CString name, U64 startNs, U64 durationNs) = 0;
+
+	virtual void visitCounter(U64 frame, U64 timestampNs, CString name, U64 value) = 0;
+
+	virtual void visitDropped([[maybe_unused]] U64 frame, [[maybe_unused]] U64 droppedEventCount, [[maybe_unused]] U64 droppedCounterCount)
+	{
+	}
+};
+
+/// Decodes the binary trace format. It can be fed incrementally (for example from a socket).
+class BinaryTraceReader
+{
+public:
+	BinaryTraceReader(BaseMemoryPool* pool)
+		: m_pool(pool)
+		, m_strings(pool)
+	{
+	}
+
+	BinaryTraceReader(const BinaryTraceReader&) = delete; // Non-copyable
+
+	BinaryTraceReader& operator=(const BinaryTraceReader&) = delete; // Non-copyable
+
+	/// Decode as many complete records as possible.
+	/// @param data The data to decode. The 1st call should include the header.
+	/// @param visitor Will be called for all the decoded data.
+	/// @param bytesConsumed How many bytes got decoded. The rest should be passed again in the next call along with new data.
+	Error decode(ConstWeakArray<U8, PtrSize> data, BinaryTraceVisitor& visitor, PtrSize& bytesConsumed);
+
+private:
+	using Pool = MemoryPoolPtrWrapper<BaseMemoryPool>;
+
+	Pool m_pool;
+	DynamicArray<BaseString<Pool>, Pool> m_strings; ///< Indexed by string ID.
+	Bool m_headerRead = false;
+
+	Error decodeRecord(BinaryTraceRecordType type, ConstWeakArray<U8, PtrSize> payload, BinaryTraceVisitor& visitor);
+
+	CString getString(U64 id) const
+	{
+		return (id < m_strings.getSize()) ? m_strings[U32(id)].toCString() : CString("?");
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -30,6 +30,9 @@ class DefaultHasher;
 
 class HashMapSparseArrayConfig;
 
+template<typename, typename, typename, typename>
+class SwissHashMap;
+
 template<typename T, typename TMemoryPool>
 class Hierarchy;
 
@@ -87,6 +90,8 @@ class XmlDocument;
 	using submoduleName##DynamicArrayLarge = DynamicArray<T, submoduleName##MemPoolWrapper, TSize>; \
 	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
 	using submoduleName##HashMap = HashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper, HashMapSparseArrayConfig>; \
+	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
+	using submoduleName##SwissHashMap = SwissHashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper>; \
 	template<typename T> \
 	using submoduleName##List = List<T, submoduleName##MemPoolWrapper>; \
 	using submoduleName##StringList = BaseStringList<submoduleName##MemPoolWrapper>; \
@@ -5,53 +5,371 @@
 
 #include <AnKi/Util/Hash.h>
 #include <AnKi/Util/Assert.h>
+#include <cstring>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+#if ANKI_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
 namespace anki {
 
-constexpr U64 kHashM = 0xc6a4a7935bd1e995;
-constexpr U64 kHashR = 47;
+// The XXH3 constants
+constexpr U32 kPrime32_1 = 0x9E3779B1u;
+constexpr U32 kPrime32_2 = 0x85EBCA77u;
+constexpr U32 kPrime32_3 = 0xC2B2AE3Du;
+constexpr U64 kPrime64_1 = 0x9E3779B185EBCA87_U64;
+constexpr U64 kPrime64_2 = 0xC2B2AE3D27D4EB4F_U64;
+constexpr U64 kPrime64_3 = 0x165667B19E3779F9_U64;
+constexpr U64 kPrime64_4 = 0x85EBCA77C2B2AE63_U64;
+constexpr U64 kPrime64_5 = 0x27D4EB2F165667C5_U64;
 
-U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
+constexpr U32 kStripeSize = 64;
+constexpr U32 kSecretSize = 192;
+constexpr U32 kStripesPerBlock = (kSecretSize - kStripeSize) / 8;
+constexpr U32 kBlockSize = kStripeSize * kStripesPerBlock;
+constexpr U32 kMidSizeMax = 240;
+
+alignas(64) constexpr U8 kSecret[kSecretSize] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+	0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+	0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+	0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+	0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e};
+
+/// All the platforms we support are little endian.
+static U64 read64(const U8* ptr)
+{
+	U64 out;
+	memcpy(&out, ptr, sizeof(out));
+	return out;
+}
+
+static U32 read32(const U8* ptr)
+{
+	U32 out;
+	memcpy(&out, ptr, sizeof(out));
+	return out;
+}
+
+static U64 rotl64(U64 x, U32 r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static U64 swap64(U64 x)
+{
+#if ANKI_COMPILER_MSVC
+	return _byteswap_uint64(x);
+#else
+	return __builtin_bswap64(x);
+#endif
+}
+
+static U32 swap32(U32 x)
+{
+#if ANKI_COMPILER_MSVC
+	return _byteswap_ulong(x);
+#else
+	return __builtin_bswap32(x);
+#endif
+}
+
+/// Multiply 2 64bit numbers and xor the high and low 64bits of the result.
+static U64 mul128Fold64(U64 a, U64 b)
+{
+#if ANKI_COMPILER_MSVC
+	U64 hi;
+	const U64 lo = _umul128(a, b, &hi);
+	return lo ^ hi;
+#else
+	const __uint128_t product = __uint128_t(a) * __uint128_t(b);
+	return U64(product) ^ U64(product >> 64);
+#endif
+}
+
+static U64 xxh64Avalanche(U64 h)
+{
+	h ^= h >> 33;
+	h *= kPrime64_2;
+	h ^= h >> 29;
+	h *= kPrime64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static U64 avalanche(U64 h)
+{
+	h ^= h >> 37;
+	h *= 0x165667919E3779F9_U64;
+	h ^= h >> 32;
+	return h;
+}
+
+static U64 rrmxmx(U64 h, U64 len)
+{
+	h ^= rotl64(h, 49) ^ rotl64(h, 24);
+	h *= 0x9FB21C651E98DF25_U64;
+	h ^= (h >> 35) + len;
+	h *= 0x9FB21C651E98DF25_U64;
+	h ^= h >> 28;
+	return h;
+}
+
+static U64 hash0To16(const U8* input, PtrSize len, U64 seed)
+{
+	if(len > 8)
+	{
+		const U64 bitflip1 = (read64(kSecret + 24) ^ read64(kSecret + 32)) + seed;
+		const U64 bitflip2 = (read64(kSecret + 40) ^ read64(kSecret + 48)) - seed;
+		const U64 lo = read64(input) ^ bitflip1;
+		const U64 hi = read64(input + len - 8) ^ bitflip2;
+		const U64 acc = len + swap64(lo) + hi + mul128Fold64(lo, hi);
+		return avalanche(acc);
+	}
+	else if(len >= 4)
+	{
+		seed ^= U64(swap32(U32(seed))) << 32;
+		const U64 input1 = read32(input);
+		const U64 input2 = read32(input + len - 4);
+		const U64 bitflip = (read64(kSecret + 8) ^ read64(kSecret + 16)) - seed;
+		const U64 input64 = input2 + (input1 << 32);
+		return rrmxmx(input64 ^ bitflip, len);
+	}
+	else if(len > 0)
+	{
+		const U32 c1 = input[0];
+		const U32 c2 = input[len >> 1];
+		const U32 c3 = input[len - 1];
+		const U32 combined = (c1 << 16) | (c2 << 24) | c3 | (U32(len) << 8);
+		const U64 bitflip = (read32(kSecret) ^ read32(kSecret + 4)) + seed;
+		return xxh64Avalanche(U64(combined) ^ bitflip);
+	}
+	else
+	{
+		return xxh64Avalanche(seed ^ (read64(kSecret + 56) ^ read64(kSecret + 64)));
+	}
+}
+
+static U64 mix16(const U8* input, const U8* secret, U64 seed)
+{
+	return mul128Fold64(read64(input) ^ (read64(secret) + seed), read64(input + 8) ^ (read64(secret + 8) - seed));
+}
+
+static U64 hash17To128(const U8* input, PtrSize len, U64 seed)
+{
+	U64 acc = len * kPrime64_1;
+	if(len > 32)
+	{
+		if(len > 64)
+		{
+			if(len > 96)
+			{
+				acc += mix16(input + 48, kSecret + 96, seed);
+				acc += mix16(input + len - 64, kSecret + 112, seed);
+			}
+
+			acc += mix16(input + 32, kSecret + 64, seed);
+			acc += mix16(input + len - 48, kSecret + 80, seed);
+		}
+
+		acc += mix16(input + 16, kSecret + 32, seed);
+		acc += mix16(input + len - 32, kSecret + 48, seed);
+	}
+
+	acc += mix16(input, kSecret, seed);
+	acc += mix16(input + len - 16, kSecret + 16, seed);
+	return avalanche(acc);
+}
+
+static U64 hash129To240(const U8* input, PtrSize len, U64 seed)
+{
+	constexpr U32 kStartOffset = 3;
+	constexpr U32 kLastOffset = 17;
+
+	U64 acc = len * kPrime64_1;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		acc += mix16(input + 16 * i, kSecret + 16 * i, seed);
+	}
+	acc = avalanche(acc);
+
+	const U32 roundCount = U32(len / 16);
+	for(U32 i = 8; i < roundCount; ++i)
+	{
+		acc += mix16(input + 16 * i, kSecret + 16 * (i - 8) + kStartOffset, seed);
+	}
+
+	acc += mix16(input + len - 16, kSecret + 136 - kLastOffset, seed);
+	return avalanche(acc);
+}
+
+static U64 hashShort(const U8* input, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len <= kMidSizeMax);
+	if(len <= 16)
+	{
+		return hash0To16(input, len, seed);
+	}
+	else if(len <= 128)
+	{
+		return hash17To128(input, len, seed);
+	}
+	else
+	{
+		return hash129To240(input, len, seed);
+	}
+}
+
+static void initSecret(U64 seed, U8* secret)
+{
+	for(U32 i = 0; i < kSecretSize / 16; ++i)
+	{
+		const U64 lo = read64(kSecret + 16 * i) + seed;
+		const U64 hi = read64(kSecret + 16 * i + 8) - seed;
+		memcpy(secret + 16 * i, &lo, sizeof(lo));
+		memcpy(secret + 16 * i + 8, &hi, sizeof(hi));
+	}
+}
+
+static void initAccumulators(U64* acc)
 {
-	const U64* data = static_cast<const U64*>(buffer);
-	const U64* const end = data + (bufferSize / sizeof(U64));
+	acc[0] = kPrime32_3;
+	acc[1] = kPrime64_1;
+	acc[2] = kPrime64_2;
+	acc[3] = kPrime64_3;
+	acc[4] = kPrime64_4;
+	acc[5] = kPrime32_2;
+	acc[6] = kPrime64_5;
+	acc[7] = kPrime32_1;
+}
 
-	while(data != end)
+/// Accumulate one stripe. The SIMD versions give the same results as the scalar one.
+static void accumulateStripe(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT input, const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+		const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+		const __m128i dataKey = _mm_xor_si128(data, key);
+		const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i product = _mm_mul_epu32(dataKey, dataKeyHi);
+		const __m128i dataSwap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+		xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], dataSwap));
+	}
+#elif ANKI_SIMD_NEON
+	uint64x2_t* xacc = reinterpret_cast<uint64x2_t*>(acc);
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(input + 16 * i));
+		const uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+		const uint64x2_t dataKey = veorq_u64(data, key);
+		const uint64x2_t sum = vaddq_u64(xacc[i], vextq_u64(data, data, 1));
+		xacc[i] = vmlal_u32(sum, vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+	}
+#else
+	for(U32 i = 0; i < 8; ++i)
 	{
-		U64 k = *data++;
+		const U64 data = read64(input + 8 * i);
+		const U64 dataKey = data ^ read64(secret + 8 * i);
+		acc[i ^ 1] += data;
+		acc[i] += U64(U32(dataKey)) * (dataKey >> 32);
+	}
+#endif
+}
 
-		k *= kHashM;
-		k ^= k >> kHashR;
-		k *= kHashM;
+static void scrambleAccumulators(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+	const __m128i prime = _mm_set1_epi32(I32(kPrime32_1));
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const __m128i a = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+		const __m128i dataKey = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+		const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i productLo = _mm_mul_epu32(dataKey, prime);
+		const __m128i productHi = _mm_mul_epu32(dataKeyHi, prime);
+		xacc[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+	}
+#elif ANKI_SIMD_NEON
+	uint64x2_t* xacc = reinterpret_cast<uint64x2_t*>(acc);
+	const uint32x2_t prime = vdup_n_u32(kPrime32_1);
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const uint64x2_t a = veorq_u64(xacc[i], vshrq_n_u64(xacc[i], 47));
+		const uint64x2_t dataKey = veorq_u64(a, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+		const uint64x2_t productHi = vshlq_n_u64(vmull_u32(vshrn_n_u64(dataKey, 32), prime), 32);
+		xacc[i] = vmlal_u32(productHi, vmovn_u64(dataKey), prime);
+	}
+#else
+	for(U32 i = 0; i < 8; ++i)
+	{
+		U64 a = acc[i];
+		a ^= a >> 47;
+		a ^= read64(secret + 8 * i);
+		acc[i] = a * kPrime32_1;
+	}
+#endif
+}
 
-		h ^= k;
-		h *= kHashM;
+static void accumulateStripes(U64* acc, const U8* input, const U8* secret, U32 stripeCount)
+{
+	for(U32 i = 0; i < stripeCount; ++i)
+	{
+		accumulateStripe(acc, input + i * kStripeSize, secret + i * 8);
 	}
+}
+
+static U64 mergeAccumulators(const U64* acc, const U8* secret, U64 start)
+{
+	U64 result = start;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		result += mul128Fold64(acc[2 * i] ^ read64(secret + 16 * i), acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+	}
+
+	return avalanche(result);
+}
+
+static U64 hashLong(const U8* input, PtrSize len, U64 seed)
+{
+	alignas(16) U8 secret[kSecretSize];
+	initSecret(seed, secret);
 
-	const U8* data2 = reinterpret_cast<const U8*>(data);
+	alignas(16) U64 acc[8];
+	initAccumulators(acc);
 
-	switch(bufferSize & (sizeof(U64) - 1))
+	const PtrSize blockCount = (len - 1) / kBlockSize;
+	for(PtrSize i = 0; i < blockCount; ++i)
 	{
-	case 7:
-		h ^= U64(data2[6]) << 48;
-	case 6:
-		h ^= U64(data2[5]) << 40;
-	case 5:
-		h ^= U64(data2[4]) << 32;
-	case 4:
-		h ^= U64(data2[3]) << 24;
-	case 3:
-		h ^= U64(data2[2]) << 16;
-	case 2:
-		h ^= U64(data2[1]) << 8;
-	case 1:
-		h ^= U64(data2[0]);
-		h *= kHashM;
-	};
+		accumulateStripes(acc, input + i * kBlockSize, secret, kStripesPerBlock);
+		scrambleAccumulators(acc, secret + kSecretSize - kStripeSize);
+	}
+
+	// Last partial block
+	const U32 stripeCount = U32(((len - 1) - kBlockSize * blockCount) / kStripeSize);
+	accumulateStripes(acc, input + blockCount * kBlockSize, secret, stripeCount);
 
-	h ^= h >> kHashR;
-	h *= kHashM;
-	h ^= h >> kHashR;
+	// Last stripe
+	accumulateStripe(acc, input + len - kStripeSize, secret + kSecretSize - kStripeSize - 7);
+
+	return mergeAccumulators(acc, secret + 11, len * kPrime64_1);
+}
+
+U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	ANKI_ASSERT(buffer || bufferSize == 0);
+	const U8* input = static_cast<const U8*>(buffer);
+	const U64 h = (bufferSize <= kMidSizeMax) ? hashShort(input, bufferSize, prevHash) : hashLong(input, bufferSize, prevHash);
 
 	ANKI_ASSERT(h != 0);
 	return h;
@@ -59,8 +377,126 @@ U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
 
 U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
 {
-	const U64 h = seed ^ (bufferSize * kHashM);
-	return appendHash(buffer, bufferSize, h);
+	return appendHash(buffer, bufferSize, seed);
+}
+
+StreamingHasher::StreamingHasher(U64 seed)
+	: m_seed(seed)
+{
+	static_assert(kStripeSize == anki::kStripeSize && kSecretSize == anki::kSecretSize && kBufferSize % kStripeSize == 0);
+	// The secret and the accumulators are initialized when the data don't fit in the buffer. Most keys are small and don't need them
+}
+
+/// Accumulate a number of stripes and scramble when a block is complete.
+static void consumeStripes(U64* acc, U32& stripesSoFar, const U8* input, U32 stripeCount, const U8* secret)
+{
+	ANKI_ASSERT(stripesSoFar < kStripesPerBlock);
+	if(kStripesPerBlock - stripesSoFar <= stripeCount)
+	{
+		const U32 stripesToBlockEnd = kStripesPerBlock - stripesSoFar;
+		accumulateStripes(acc, input, secret + stripesSoFar * 8, stripesToBlockEnd);
+		scrambleAccumulators(acc, secret + kSecretSize - kStripeSize);
+		accumulateStripes(acc, input + stripesToBlockEnd * kStripeSize, secret, stripeCount - stripesToBlockEnd);
+		stripesSoFar = stripeCount - stripesToBlockEnd;
+	}
+	else
+	{
+		accumulateStripes(acc, input, secret + stripesSoFar * 8, stripeCount);
+		stripesSoFar += stripeCount;
+	}
+}
+
+void StreamingHasher::appendInternal(const void* buffer, PtrSize bufferSize)
+{
+	ANKI_ASSERT(buffer && m_bufferedSize + bufferSize > kBufferSize);
+	const U8* input = static_cast<const U8*>(buffer);
+	const U8* const end = input + bufferSize;
+	m_totalSize += bufferSize;
+
+	constexpr U32 kStripesPerBuffer = kBufferSize / kStripeSize;
+
+	// First time the data don't fit in the buffer
+	if(m_totalSize - bufferSize <= kBufferSize)
+	{
+		initSecret(m_seed, m_secret);
+		initAccumulators(m_accumulators);
+	}
+
+	// Fill the buffer and consume it
+	if(m_bufferedSize)
+	{
+		const U32 loadSize = kBufferSize - m_bufferedSize;
+		memcpy(m_buffer + m_bufferedSize, input, loadSize);
+		input += loadSize;
+		consumeStripes(m_accumulators, m_stripesSoFar, m_buffer, kStripesPerBuffer, m_secret);
+		m_bufferedSize = 0;
+	}
+
+	// Consume the input directly. Always leave something in the buffer because getHash() needs it for the last stripe
+	if(PtrSize(end - input) > kBufferSize)
+	{
+		do
+		{
+			consumeStripes(m_accumulators, m_stripesSoFar, input, kStripesPerBuffer, m_secret);
+			input += kBufferSize;
+		} while(PtrSize(end - input) > kBufferSize);
+
+		// The last stripe might need the tail of the data that got consumed
+		memcpy(m_buffer + kBufferSize - kStripeSize, input - kStripeSize, kStripeSize);
+	}
+
+	m_bufferedSize = U32(end - input);
+	memcpy(m_buffer, input, m_bufferedSize);
+}
+
+U64 StreamingHasher::getHash() const
+{
+	U64 h;
+	if(m_totalSize <= kMidSizeMax)
+	{
+		h = hashShort(m_buffer, m_totalSize, m_seed);
+	}
+	else
+	{
+		alignas(16) U64 acc[8];
+		alignas(16) U8 secretStorage[kSecretSize];
+		const U8* secret;
+		if(m_totalSize <= kBufferSize)
+		{
+			// Nothing consumed yet, the secret and the accumulators are not initialized
+			initSecret(m_seed, secretStorage);
+			initAccumulators(acc);
+			secret = secretStorage;
+		}
+		else
+		{
+			memcpy(acc, m_accumulators, sizeof(acc));
+			secret = m_secret;
+		}
+
+		const U8* lastStripe;
+		alignas(16) U8 lastStripeStorage[kStripeSize];
+		if(m_bufferedSize >= kStripeSize)
+		{
+			U32 stripesSoFar = m_stripesSoFar;
+			consumeStripes(acc, stripesSoFar, m_buffer, (m_bufferedSize - 1) / kStripeSize, secret);
+			lastStripe = m_buffer + m_bufferedSize - kStripeSize;
+		}
+		else
+		{
+			// Stitch the last stripe from the end of the previous buffer and what's in the buffer now
+			const U32 catchupSize = kStripeSize - m_bufferedSize;
+			memcpy(lastStripeStorage, m_buffer + kBufferSize - catchupSize, catchupSize);
+			memcpy(lastStripeStorage + catchupSize, m_buffer, m_bufferedSize);
+			lastStripe = lastStripeStorage;
+		}
+
+		accumulateStripe(acc, lastStripe, secret + kSecretSize - kStripeSize - 7);
+		h = mergeAccumulators(acc, secret + 11, m_totalSize * kPrime64_1);
+	}
+
+	ANKI_ASSERT(h != 0);
+	return h;
 }
 
 } // end namespace anki
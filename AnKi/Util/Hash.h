@@ -6,20 +6,22 @@
 #pragma once
 
 #include <AnKi/Util/StdTypes.h>
+#include <cstring>
 
 namespace anki {
 
 /// @addtogroup util_other
 /// @{
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer. This function implements the 64bit XXH3 algorithm by Yann Collet. The result is the same on all platforms and it
+/// doesn't depend on the SIMD path so it can be stored to disk.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param seed A unique seed.
 /// @return The hash.
 [[nodiscard]] ANKI_PURE U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer using a previous hash as a seed. See computeHash.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param prevHash The hash to append to.
@@ -39,6 +41,54 @@ template<typename T>
 {
 	return appendHash(&obj, sizeof(obj), prevHash);
 }
+
+/// Computes the hash of data that come in pieces. The result is the same as calling computeHash() with all the data in one buffer. It's faster than
+/// chaining appendHash() calls for keys that are built from many small parts.
+class StreamingHasher
+{
+public:
+	StreamingHasher(U64 seed = 123);
+
+	/// Hash some more data.
+	void append(const void* buffer, PtrSize bufferSize)
+	{
+		// Fast path for small keys, just copy to the buffer
+		if(m_bufferedSize + bufferSize <= kBufferSize)
+		{
+			memcpy(m_buffer + m_bufferedSize, buffer, bufferSize);
+			m_bufferedSize += U32(bufferSize);
+			m_totalSize += bufferSize;
+		}
+		else
+		{
+			appendInternal(buffer, bufferSize);
+		}
+	}
+
+	template<typename T>
+	void appendObject(const T& obj)
+	{
+		append(&obj, sizeof(obj));
+	}
+
+	/// Get the hash of all the data so far. More data can be appended afterwards.
+	[[nodiscard]] U64 getHash() const;
+
+private:
+	static constexpr U32 kStripeSize = 64;
+	static constexpr U32 kSecretSize = 192;
+	static constexpr U32 kBufferSize = 256;
+
+	alignas(16) U64 m_accumulators[8];
+	alignas(16) U8 m_secret[kSecretSize];
+	alignas(16) U8 m_buffer[kBufferSize];
+	U64 m_seed;
+	U64 m_totalSize = 0;
+	U32 m_bufferedSize = 0;
+	U32 m_stripesSoFar = 0; ///< The stripes of the current block that have been consumed.
+
+	void appendInternal(const void* buffer, PtrSize bufferSize);
+};
 /// @}
 
 } // end namespace anki
@@ -0,0 +1,110 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Array.h>
+
+namespace anki {
+
+/// @addtogroup util_memory
+/// @{
+
+/// Allocates integer indices in the range [0, capacity). It always returns the lowest free index. It's a hierarchy of bit masks where the bottom
+/// level has one bit per index (set if the index is in use) and every level above it has one bit per word of the level bellow (set if that word is
+/// full). Allocation and free touch one word per level so they are O(levels) and the levels are at most 4.
+/// @tparam TMemoryPool The type of the pool to be used in internal CPU allocations.
+/// @note Not thread-safe.
+template<typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>>
+class IndexAllocator
+{
+public:
+	static constexpr U32 kMaxLevels = 4;
+	static constexpr U32 kMaxCapacity = 64u * 64u * 64u * 64u;
+
+	IndexAllocator() = default;
+
+	/// @copydoc init
+	IndexAllocator(U32 capacity, const TMemoryPool& pool = TMemoryPool())
+	{
+		init(capacity, pool);
+	}
+
+	IndexAllocator(const IndexAllocator&) = delete; // Non-copyable
+
+	~IndexAllocator()
+	{
+		destroy();
+	}
+
+	IndexAllocator& operator=(const IndexAllocator&) = delete; // Non-copyable
+
+	/// Init the allocator.
+	/// @param capacity The number of indices. Can be changed later with grow().
+	void init(U32 capacity, const TMemoryPool& pool = TMemoryPool());
+
+	/// Destroy the allocator.
+	void destroy();
+
+	/// Increase the capacity keeping the current allocations intact.
+	void grow(U32 newCapacity);
+
+	/// Allocate the lowest free index.
+	/// @return The index or kMaxU32 if the allocator is full.
+	[[nodiscard]] U32 allocate();
+
+	/// Free an index.
+	void free(U32 idx);
+
+	Bool isAllocated(U32 idx) const
+	{
+		ANKI_ASSERT(idx < m_capacity);
+		return (m_levels[0][idx / 64] & (1_U64 << (idx % 64))) != 0;
+	}
+
+	/// Find the highest index that is in use starting from a known upper bound and going down.
+	/// @return The index or kMaxU32 if nothing is allocated.
+	U32 findLastAllocated(U32 startIdx) const;
+
+	U32 getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	U32 getAllocatedCount() const
+	{
+		return m_allocatedCount;
+	}
+
+	Bool isFull() const
+	{
+		return m_allocatedCount == m_capacity;
+	}
+
+	/// Check the internal structures.
+	void validate() const;
+
+private:
+	using Level = DynamicArray<U64, TMemoryPool>;
+
+	Array<Level, kMaxLevels> m_levels;
+	U32 m_levelCount = 0;
+	U32 m_capacity = 0;
+	U32 m_allocatedCount = 0;
+
+	/// Re-create the upper levels from the bottom one and mark the bits past the end as in use.
+	void rebuildLevels(U32 oldCapacity);
+
+	static U32 getWordCount(U32 bitCount)
+	{
+		return (bitCount + 63) / 64;
+	}
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/IndexAllocator.inl.h>
@@ -0,0 +1,217 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/IndexAllocator.h>
+
+namespace anki {
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::init(U32 capacity, const TMemoryPool& pool)
+{
+	ANKI_ASSERT(capacity > 0 && capacity <= kMaxCapacity);
+	ANKI_ASSERT(m_capacity == 0 && "Already initialized");
+
+	for(Level& level : m_levels)
+	{
+		level = Level(pool);
+	}
+
+	m_levels[0].resize(getWordCount(capacity), 0);
+	m_capacity = capacity;
+	rebuildLevels(0);
+}
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::destroy()
+{
+	ANKI_ASSERT(m_allocatedCount == 0 && "Forgot to free all indices");
+
+	for(Level& level : m_levels)
+	{
+		level.destroy();
+	}
+
+	m_levelCount = 0;
+	m_capacity = 0;
+}
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::grow(U32 newCapacity)
+{
+	ANKI_ASSERT(m_capacity > 0 && "Not initialized");
+	ANKI_ASSERT(newCapacity >= m_capacity && newCapacity <= kMaxCapacity);
+
+	if(newCapacity == m_capacity)
+	{
+		return;
+	}
+
+	const U32 oldCapacity = m_capacity;
+	m_levels[0].resize(getWordCount(newCapacity), 0);
+	m_capacity = newCapacity;
+	rebuildLevels(oldCapacity);
+}
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::rebuildLevels(U32 oldCapacity)
+{
+	Level& bottom = m_levels[0];
+
+	// Un-mark the padding of the old capacity in the last word that was there before
+	if(oldCapacity % 64)
+	{
+		bottom[oldCapacity / 64] &= (1_U64 << (oldCapacity % 64)) - 1;
+	}
+
+	// Mark the bits past the end as in use so they won't be allocated
+	if(m_capacity % 64)
+	{
+		bottom[m_capacity / 64] |= ~((1_U64 << (m_capacity % 64)) - 1);
+	}
+
+	// Build the upper levels
+	m_levelCount = 1;
+	while(m_levels[m_levelCount - 1].getSize() > 1)
+	{
+		ANKI_ASSERT(m_levelCount < kMaxLevels);
+		const Level& lower = m_levels[m_levelCount - 1];
+		Level& upper = m_levels[m_levelCount];
+
+		upper.resize(getWordCount(lower.getSize()));
+		for(U32 w = 0; w < upper.getSize(); ++w)
+		{
+			U64 word = 0;
+			for(U32 bit = 0; bit < 64; ++bit)
+			{
+				const U32 lowerWord = w * 64 + bit;
+				if(lowerWord >= lower.getSize() || lower[lowerWord] == kMaxU64)
+				{
+					word |= 1_U64 << bit;
+				}
+			}
+
+			upper[w] = word;
+		}
+
+		++m_levelCount;
+	}
+
+	for(U32 l = m_levelCount; l < kMaxLevels; ++l)
+	{
+		m_levels[l].destroy();
+	}
+}
+
+template<typename TMemoryPool>
+U32 IndexAllocator<TMemoryPool>::allocate()
+{
+	if(isFull())
+	{
+		return kMaxU32;
+	}
+
+	// Walk down the levels following the 1st word that is not full
+	U32 idx = 0;
+	U32 level = m_levelCount;
+	while(level--)
+	{
+		const U64 word = m_levels[level][idx];
+		ANKI_ASSERT(word != kMaxU64);
+		idx = idx * 64 + U32(__builtin_ctzll(~word));
+	}
+
+	ANKI_ASSERT(idx < m_capacity);
+
+	// Mark it and propagate the fullness upwards
+	U32 pos = idx;
+	for(level = 0; level < m_levelCount; ++level)
+	{
+		U64& word = m_levels[level][pos / 64];
+		ANKI_ASSERT(!(word & (1_U64 << (pos % 64))));
+		word |= 1_U64 << (pos % 64);
+
+		if(word != kMaxU64)
+		{
+			break;
+		}
+
+		pos /= 64;
+	}
+
+	++m_allocatedCount;
+	return idx;
+}
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::free(U32 idx)
+{
+	ANKI_ASSERT(isAllocated(idx));
+	ANKI_ASSERT(m_allocatedCount > 0);
+
+	// Un-mark it and propagate the non-fullness upwards
+	U32 pos = idx;
+	for(U32 level = 0; level < m_levelCount; ++level)
+	{
+		U64& word = m_levels[level][pos / 64];
+		const Bool wasFull = word == kMaxU64;
+		word &= ~(1_U64 << (pos % 64));
+
+		if(!wasFull)
+		{
+			break;
+		}
+
+		pos /= 64;
+	}
+
+	--m_allocatedCount;
+}
+
+template<typename TMemoryPool>
+U32 IndexAllocator<TMemoryPool>::findLastAllocated(U32 startIdx) const
+{
+	startIdx = min(startIdx, m_capacity - 1);
+
+	U32 w = startIdx / 64;
+	U64 mask = (startIdx % 64 == 63) ? kMaxU64 : (1_U64 << (startIdx % 64 + 1)) - 1;
+	do
+	{
+		const U64 bits = m_levels[0][w] & mask;
+		if(bits)
+		{
+			return w * 64 + 63 - U32(__builtin_clzll(bits));
+		}
+
+		mask = kMaxU64;
+	} while(w--);
+
+	return kMaxU32;
+}
+
+template<typename TMemoryPool>
+void IndexAllocator<TMemoryPool>::validate() const
+{
+#if ANKI_ASSERTIONS_ENABLED
+	U32 count = 0;
+	for(U64 word : m_levels[0])
+	{
+		count += __builtin_popcountll(word);
+	}
+	count -= m_levels[0].getSize() * 64 - m_capacity; // Remove the padding
+	ANKI_ASSERT(count == m_allocatedCount);
+
+	for(U32 level = 1; level < m_levelCount; ++level)
+	{
+		const Level& lower = m_levels[level - 1];
+		for(U32 w = 0; w < lower.getSize(); ++w)
+		{
+			const Bool full = (m_levels[level][w / 64] & (1_U64 << (w % 64))) != 0;
+			ANKI_ASSERT(full == (lower[w] == kMaxU64));
+		}
+	}
+#endif
+}
+
+} // end namespace anki
@@ -6,10 +6,15 @@
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/System.h>
+#include <AnKi/Util/MemoryPool.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cstdint>
+#include <cinttypes>
+#include <cstddef>
+#include <thread>
 #if ANKI_OS_ANDROID
 #	include <android/log.h>
 #endif
@@ -21,8 +26,579 @@ namespace anki {
 
 inline constexpr Array<const Char*, U(LoggerMessageType::kCount)> kMessageTypeTxt = {"I", "V", "E", "W", "F"};
 
+inline constexpr U32 kQueuedMessageCount = 2048; ///< Power of 2.
+inline constexpr U32 kMaxMessagesPerBatch = 64;
+inline constexpr U32 kMaxInlinePayloadSize = 176;
+inline constexpr U32 kMaxPayloadSize = 1024; ///< Bigger payloads are formatted by the caller.
+
+/// The logger thread can't wait for itself if the queue is full.
+static thread_local Bool g_isLoggerThread = false;
+
+/// A message in the queue of the asynchronous logger.
+class alignas(ANKI_CACHE_LINE_SIZE) Logger::Message
+{
+public:
+	Atomic<U64> m_sequence;
+	const Char* m_file;
+	const Char* m_func;
+	const Char* m_subsystem;
+	const Char* m_fmt; ///< If it's nullptr the payload is the formatted message.
+	U8* m_heapPayload; ///< If it's not nullptr the payload didn't fit in m_payload.
+	I32 m_line;
+	U32 m_payloadSize;
+	LoggerMessageType m_type;
+	Array<Char, Thread::kThreadNameMaxLength + 1> m_threadName;
+	Array<U8, kMaxInlinePayloadSize> m_payload;
+
+	const U8* getPayload() const
+	{
+		return (m_heapPayload) ? m_heapPayload : &m_payload[0];
+	}
+};
+
+/// A growable string that is used to format the messages.
+class Logger::FormatBuffer
+{
+public:
+	FormatBuffer()
+	{
+		m_inline[0] = '\0';
+	}
+
+	FormatBuffer(const FormatBuffer&) = delete; // Non-copyable
+
+	~FormatBuffer()
+	{
+		free(m_heap);
+	}
+
+	FormatBuffer& operator=(const FormatBuffer&) = delete; // Non-copyable
+
+	const Char* cstr() const
+	{
+		return (m_heap) ? m_heap : &m_inline[0];
+	}
+
+	void reset()
+	{
+		m_length = 0;
+		getBegin()[0] = '\0';
+	}
+
+	void append(const Char* str, U32 length)
+	{
+		reserve(m_length + length);
+		memcpy(getBegin() + m_length, str, length);
+		m_length += length;
+		getBegin()[m_length] = '\0';
+	}
+
+	/// @note It's not annotated with ANKI_CHECK_FORMAT because the format strings are built at runtime.
+	Bool appendf(const Char* fmt, ...)
+	{
+		va_list args;
+		va_start(args, fmt);
+		const Bool ok = appendv(fmt, args);
+		va_end(args);
+		return ok;
+	}
+
+	Bool appendv(const Char* fmt, va_list args)
+	{
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+		const I32 len = vsnprintf(getBegin() + m_length, m_capacity - m_length, fmt, argsCopy);
+		va_end(argsCopy);
+
+		if(len < 0) [[unlikely]]
+		{
+			getBegin()[m_length] = '\0';
+			return false;
+		}
+
+		if(U32(len) >= m_capacity - m_length)
+		{
+			reserve(m_length + U32(len));
+			vsnprintf(getBegin() + m_length, m_capacity - m_length, fmt, args);
+		}
+
+		m_length += U32(len);
+		return true;
+	}
+
+private:
+	Array<Char, 512> m_inline;
+	Char* m_heap = nullptr;
+	U32 m_capacity = 512; ///< Including the null terminator.
+	U32 m_length = 0;
+
+	Char* getBegin()
+	{
+		return (m_heap) ? m_heap : &m_inline[0];
+	}
+
+	void reserve(U32 length)
+	{
+		if(length + 1 <= m_capacity)
+		{
+			return;
+		}
+
+		const U32 newCapacity = (length + 1 > m_capacity * 2) ? length + 1 : m_capacity * 2;
+		Char* newHeap = static_cast<Char*>(malloc(newCapacity));
+		memcpy(newHeap, getBegin(), m_length + 1);
+		free(m_heap);
+		m_heap = newHeap;
+		m_capacity = newCapacity;
+	}
+};
+
+namespace {
+
+/// The type of the argument that a printf conversion specification consumes.
+enum class FormatArgType : U8
+{
+	kNone, ///< It's "%%".
+	kInt,
+	kLong,
+	kLongLong,
+	kIntMax,
+	kSize,
+	kPtrDiff,
+	kDouble,
+	kLongDouble,
+	kString,
+	kPointer,
+	kUnsupported
+};
+
+/// A printf conversion specification.
+class FormatSpec
+{
+public:
+	Array<Char, 32> m_spec; ///< The specification including the '%'. Null terminated.
+	FormatArgType m_argType = FormatArgType::kUnsupported;
+	U8 m_starCount = 0; ///< Number of '*' for width and precision.
+	Bool m_precisionStar = false;
+	I32 m_precision = -1; ///< -1 if there is no precision.
+};
+
+/// Parse a conversion specification and move the iterator after it.
+Bool parseFormatSpec(const Char*& it, FormatSpec& spec)
+{
+	ANKI_ASSERT(*it == '%');
+	const Char* begin = it;
+	++it;
+
+	if(*it == '%')
+	{
+		++it;
+		spec.m_argType = FormatArgType::kNone;
+	}
+	else
+	{
+		// Flags
+		while(*it == '-' || *it == '+' || *it == ' ' || *it == '#' || *it == '0')
+		{
+			++it;
+		}
+
+		// Width
+		if(*it == '*')
+		{
+			++spec.m_starCount;
+			++it;
+		}
+		else
+		{
+			while(*it >= '0' && *it <= '9')
+			{
+				++it;
+			}
+		}
+
+		// Precision
+		if(*it == '.')
+		{
+			++it;
+			if(*it == '*')
+			{
+				++spec.m_starCount;
+				spec.m_precisionStar = true;
+				++it;
+			}
+			else
+			{
+				spec.m_precision = 0;
+				while(*it >= '0' && *it <= '9')
+				{
+					spec.m_precision = min(spec.m_precision * 10 + (*it - '0'), kMaxI32 / 10);
+					++it;
+				}
+			}
+		}
+
+		// Length modifier
+		enum class Length : U8
+		{
+			kNone,
+			kChar,
+			kShort,
+			kLong,
+			kLongLong,
+			kIntMax,
+			kSize,
+			kPtrDiff,
+			kLongDouble
+		};
+
+		Length length = Length::kNone;
+		switch(*it)
+		{
+		case 'h':
+			++it;
+			length = (*it == 'h') ? Length::kChar : Length::kShort;
+			it += (length == Length::kChar) ? 1 : 0;
+			break;
+		case 'l':
+			++it;
+			length = (*it == 'l') ? Length::kLongLong : Length::kLong;
+			it += (length == Length::kLongLong) ? 1 : 0;
+			break;
+		case 'j':
+			++it;
+			length = Length::kIntMax;
+			break;
+		case 'z':
+			++it;
+			length = Length::kSize;
+			break;
+		case 't':
+			++it;
+			length = Length::kPtrDiff;
+			break;
+		case 'L':
+			++it;
+			length = Length::kLongDouble;
+			break;
+		default:
+			break;
+		}
+
+		// Conversion
+		const Char conversion = *it;
+		if(conversion == '\0')
+		{
+			return false;
+		}
+		++it;
+
+		switch(conversion)
+		{
+		case 'c':
+			spec.m_argType = (length == Length::kNone) ? FormatArgType::kInt : FormatArgType::kUnsupported;
+			break;
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			switch(length)
+			{
+			case Length::kNone:
+			case Length::kChar:
+			case Length::kShort:
+				spec.m_argType = FormatArgType::kInt;
+				break;
+			case Length::kLong:
+				spec.m_argType = FormatArgType::kLong;
+				break;
+			case Length::kLongLong:
+				spec.m_argType = FormatArgType::kLongLong;
+				break;
+			case Length::kIntMax:
+				spec.m_argType = FormatArgType::kIntMax;
+				break;
+			case Length::kSize:
+				spec.m_argType = FormatArgType::kSize;
+				break;
+			case Length::kPtrDiff:
+				spec.m_argType = FormatArgType::kPtrDiff;
+				break;
+			default:
+				spec.m_argType = FormatArgType::kUnsupported;
+			}
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec.m_argType = (length == Length::kNone || length == Length::kLong) ? FormatArgType::kDouble
+							 : (length == Length::kLongDouble)                    ? FormatArgType::kLongDouble
+																				  : FormatArgType::kUnsupported;
+			break;
+		case 's':
+			spec.m_argType = (length == Length::kNone) ? FormatArgType::kString : FormatArgType::kUnsupported;
+			break;
+		case 'p':
+			spec.m_argType = (length == Length::kNone) ? FormatArgType::kPointer : FormatArgType::kUnsupported;
+			break;
+		default:
+			// %n, positional arguments and whatever else
+			spec.m_argType = FormatArgType::kUnsupported;
+		}
+	}
+
+	const PtrSize specLength = PtrSize(it - begin);
+	if(specLength >= spec.m_spec.getSize())
+	{
+		return false;
+	}
+
+	memcpy(&spec.m_spec[0], begin, specLength);
+	spec.m_spec[specLength] = '\0';
+	return spec.m_argType != FormatArgType::kUnsupported;
+}
+
+/// Holds the arguments of writeFormated() until the logger thread formats them.
+class PayloadWriter
+{
+public:
+	Array<U8, kMaxPayloadSize> m_data;
+	U32 m_size = 0;
+
+	template<typename T>
+	Bool write(T x)
+	{
+		if(m_size + sizeof(T) > m_data.getSize())
+		{
+			return false;
+		}
+
+		memcpy(&m_data[m_size], &x, sizeof(T));
+		m_size += sizeof(T);
+		return true;
+	}
+
+	Bool writeString(const Char* str, U32 length)
+	{
+		if(m_size + sizeof(U32) + length + 1 > m_data.getSize())
+		{
+			return false;
+		}
+
+		write(length);
+		memcpy(&m_data[m_size], str, length);
+		m_data[m_size + length] = '\0';
+		m_size += length + 1;
+		return true;
+	}
+};
+
+class PayloadReader
+{
+public:
+	const U8* m_data;
+	U32 m_size;
+	U32 m_offset = 0;
+
+	template<typename T>
+	T read()
+	{
+		ANKI_ASSERT(m_offset + sizeof(T) <= m_size);
+		T x;
+		memcpy(&x, m_data + m_offset, sizeof(T));
+		m_offset += sizeof(T);
+		return x;
+	}
+
+	const Char* readString()
+	{
+		const U32 length = read<U32>();
+		ANKI_ASSERT(m_offset + length + 1 <= m_size);
+		const Char* str = reinterpret_cast<const Char*>(m_data + m_offset);
+		m_offset += length + 1;
+		return str;
+	}
+};
+
+/// Copy the arguments in their exact types. Strings are copied by value since they may not outlive the call.
+Bool packArguments(const Char* fmt, va_list args, PayloadWriter& writer)
+{
+	const Char* it = fmt;
+	while((it = strchr(it, '%')) != nullptr)
+	{
+		FormatSpec spec;
+		if(!parseFormatSpec(it, spec))
+		{
+			return false;
+		}
+
+		Bool ok = true;
+		for(U32 i = 0; i < spec.m_starCount; ++i)
+		{
+			const int x = va_arg(args, int);
+			ok = ok && writer.write(x);
+
+			if(spec.m_precisionStar && i == spec.m_starCount - 1U)
+			{
+				spec.m_precision = (x >= 0) ? x : -1;
+			}
+		}
+
+		switch(spec.m_argType)
+		{
+		case FormatArgType::kNone:
+			break;
+		case FormatArgType::kInt:
+			ok = ok && writer.write(va_arg(args, int));
+			break;
+		case FormatArgType::kLong:
+			ok = ok && writer.write(va_arg(args, long));
+			break;
+		case FormatArgType::kLongLong:
+			ok = ok && writer.write(va_arg(args, long long));
+			break;
+		case FormatArgType::kIntMax:
+			ok = ok && writer.write(va_arg(args, intmax_t));
+			break;
+		case FormatArgType::kSize:
+			ok = ok && writer.write(va_arg(args, size_t));
+			break;
+		case FormatArgType::kPtrDiff:
+			ok = ok && writer.write(va_arg(args, ptrdiff_t));
+			break;
+		case FormatArgType::kDouble:
+			ok = ok && writer.write(va_arg(args, double));
+			break;
+		case FormatArgType::kLongDouble:
+			ok = ok && writer.write(va_arg(args, long double));
+			break;
+		case FormatArgType::kString:
+		{
+			const Char* str = va_arg(args, const Char*);
+			str = (str) ? str : "(null)";
+			const PtrSize length = (spec.m_precision >= 0) ? strnlen(str, spec.m_precision) : strlen(str);
+			ok = ok && length < kMaxPayloadSize && writer.writeString(str, U32(length));
+			break;
+		}
+		case FormatArgType::kPointer:
+			ok = ok && writer.write(va_arg(args, void*));
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+
+		if(!ok)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename TBuffer, typename T>
+Bool appendArgument(TBuffer& buffer, const FormatSpec& spec, const Array<int, 2>& stars, T value)
+{
+	switch(spec.m_starCount)
+	{
+	case 0:
+		return buffer.appendf(&spec.m_spec[0], value);
+	case 1:
+		return buffer.appendf(&spec.m_spec[0], stars[0], value);
+	default:
+		return buffer.appendf(&spec.m_spec[0], stars[0], stars[1], value);
+	}
+}
+
+/// The opposite of packArguments().
+template<typename TBuffer>
+void formatPackedArguments(const Char* fmt, const U8* payload, U32 payloadSize, TBuffer& buffer)
+{
+	PayloadReader reader = {payload, payloadSize};
+
+	const Char* it = fmt;
+	while(*it != '\0')
+	{
+		const Char* percent = strchr(it, '%');
+		if(!percent)
+		{
+			buffer.append(it, U32(strlen(it)));
+			break;
+		}
+
+		buffer.append(it, U32(percent - it));
+		it = percent;
+
+		FormatSpec spec;
+		[[maybe_unused]] const Bool ok = parseFormatSpec(it, spec);
+		ANKI_ASSERT(ok && "The producer has parsed that already");
+
+		Array<int, 2> stars = {};
+		for(U32 i = 0; i < spec.m_starCount; ++i)
+		{
+			stars[i] = reader.read<int>();
+		}
+
+		switch(spec.m_argType)
+		{
+		case FormatArgType::kNone:
+			buffer.append("%", 1);
+			break;
+		case FormatArgType::kInt:
+			appendArgument(buffer, spec, stars, reader.read<int>());
+			break;
+		case FormatArgType::kLong:
+			appendArgument(buffer, spec, stars, reader.read<long>());
+			break;
+		case FormatArgType::kLongLong:
+			appendArgument(buffer, spec, stars, reader.read<long long>());
+			break;
+		case FormatArgType::kIntMax:
+			appendArgument(buffer, spec, stars, reader.read<intmax_t>());
+			break;
+		case FormatArgType::kSize:
+			appendArgument(buffer, spec, stars, reader.read<size_t>());
+			break;
+		case FormatArgType::kPtrDiff:
+			appendArgument(buffer, spec, stars, reader.read<ptrdiff_t>());
+			break;
+		case FormatArgType::kDouble:
+			appendArgument(buffer, spec, stars, reader.read<double>());
+			break;
+		case FormatArgType::kLongDouble:
+			appendArgument(buffer, spec, stars, reader.read<long double>());
+			break;
+		case FormatArgType::kString:
+			appendArgument(buffer, spec, stars, reader.readString());
+			break;
+		case FormatArgType::kPointer:
+			appendArgument(buffer, spec, stars, reader.read<void*>());
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+}
+
+const Char* getBaseFilename(const Char* file)
+{
+	const Char* baseFile = strrchr(file, (ANKI_OS_WINDOWS) ? '\\' : '/');
+	return (baseFile) ? baseFile + 1 : file;
+}
+
+} // end anonymous namespace
+
 Logger::Logger()
 {
+	static_assert(sizeof(Message) == 256, "Try to keep it small");
+
 	addMessageHandler(this, &defaultSystemMessageHandler);
 
 	const Char* envVar = getenv("ANKI_LOG_VERBOSE");
@@ -30,10 +606,23 @@ Logger::Logger()
 	{
 		m_verbosityEnabled = true;
 	}
+
+	envVar = getenv("ANKI_LOG_SYNC");
+	if(!envVar || envVar != CString("1"))
+	{
+		enableAsync(true);
+	}
 }
 
 Logger::~Logger()
 {
+	enableAsync(false);
+
+	if(m_messages)
+	{
+		freeAligned(m_messages);
+		m_messages = nullptr;
+	}
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -65,28 +654,94 @@ void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callb
 	}
 }
 
-void Logger::write(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
-				   const Char* msg)
+void Logger::enableDefaultMessageHandler(Bool enable)
 {
-	// Note: m_verbosityEnabled is not accessed in a thread-safe way. It doesn't really matter though
-	if(type == LoggerMessageType::kVerbose && !m_verbosityEnabled) [[likely]]
+	removeMessageHandler(this, &defaultSystemMessageHandler);
+
+	if(enable)
+	{
+		addMessageHandler(this, &defaultSystemMessageHandler);
+	}
+}
+
+void Logger::enableAsync(Bool enable)
+{
+	if(enable == m_threadRunning)
 	{
 		return;
 	}
 
-	const Char* baseFile = strrchr(file, (ANKI_OS_WINDOWS) ? '\\' : '/');
-	baseFile = (baseFile) ? baseFile + 1 : file;
+	if(enable)
+	{
+		if(!m_messages)
+		{
+			m_messages = static_cast<Message*>(mallocAligned(sizeof(Message) * kQueuedMessageCount, alignof(Message)));
+			for(U32 i = 0; i < kQueuedMessageCount; ++i)
+			{
+				::new(&m_messages[i]) Message();
+				m_messages[i].m_sequence.setNonAtomically(i);
+				m_messages[i].m_heapPayload = nullptr;
+			}
+		}
 
-	LoggerMessageInfo inf = {baseFile, line, func, type, msg, subsystem, threadName};
+		m_quitThread = false;
+		m_threadSleeping.store(0, AtomicMemoryOrder::kSeqCst);
+		m_threadRunning = true;
+		m_thread.start(this, threadMain);
+		m_asyncEnabled.store(1, AtomicMemoryOrder::kSeqCst);
+	}
+	else
+	{
+		m_asyncEnabled.store(0, AtomicMemoryOrder::kSeqCst);
 
-	m_mutex.lock();
+		{
+			LockGuard<Mutex> lock(m_threadMtx);
+			m_quitThread = true;
+			m_threadCondVar.notifyOne();
+		}
+
+		[[maybe_unused]] const Error err = m_thread.join();
+		m_threadRunning = false;
 
+		// Write the messages that some thread might have queued while the logger thread was quitting
+		FormatBuffer buffer;
+		while(processQueuedMessages(buffer) > 0)
+		{
+		}
+	}
+}
+
+void Logger::dispatch(const LoggerMessageInfo& info)
+{
 	U count = m_handlersCount;
 	while(count-- != 0)
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
+void Logger::write(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+				   const Char* msg)
+{
+	// Note: m_verbosityEnabled is not accessed in a thread-safe way. It doesn't really matter though
+	if(type == LoggerMessageType::kVerbose && !m_verbosityEnabled) [[likely]]
+	{
+		return;
 	}
 
+	if(type != LoggerMessageType::kFatal && m_asyncEnabled.load(AtomicMemoryOrder::kRelaxed)) [[likely]]
+	{
+		enqueue(file, line, func, subsystem, type, threadName, nullptr, msg, U32(strlen(msg) + 1));
+		return;
+	}
+
+	// Write whatever is queued first. Keeps the order and makes sure that everything is written before a fatal error aborts
+	flush();
+
+	const LoggerMessageInfo inf = {getBaseFilename(file), line, func, type, msg, subsystem, threadName};
+
+	m_mutex.lock();
+	dispatch(inf);
 	m_mutex.unlock();
 
 	if(type == LoggerMessageType::kFatal)
@@ -98,37 +753,236 @@ void Logger::write(const Char* file, int line, const Char* func, const Char* sub
 void Logger::writeFormated(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 						   const Char* fmt, ...)
 {
-	Array<Char, 256> buffer;
-	va_list args;
+	if(type == LoggerMessageType::kVerbose && !m_verbosityEnabled) [[likely]]
+	{
+		return;
+	}
 
+	va_list args;
 	va_start(args, fmt);
-	I len = vsnprintf(&buffer[0], sizeof(buffer), fmt, args);
-	if(len < 0)
+
+	if(type != LoggerMessageType::kFatal && m_asyncEnabled.load(AtomicMemoryOrder::kRelaxed)) [[likely]]
+	{
+		// Copy the arguments and let the logger thread do the formatting
+		PayloadWriter payload;
+
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+		const Bool packed = packArguments(fmt, argsCopy, payload);
+		va_end(argsCopy);
+
+		if(packed) [[likely]]
+		{
+			va_end(args);
+			enqueue(file, line, func, subsystem, type, threadName, fmt, &payload.m_data[0], payload.m_size);
+			return;
+		}
+	}
+
+	// Format it now
+	FormatBuffer buffer;
+	if(!buffer.appendv(fmt, args))
 	{
 		fprintf(stderr, "Logger::writeFormated() failed. Will not recover");
 		abort();
 	}
-	else if(len < I(sizeof(buffer)))
+	va_end(args);
+
+	write(file, line, func, subsystem, type, threadName, buffer.cstr());
+}
+
+void Logger::enqueue(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+					 const Char* fmt, const void* payload, U32 payloadSize)
+{
+	// Reserve a message. It's Dmitry Vyukov's bounded MPMC queue with a single consumer
+	U64 pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+	Message* msg;
+	while(true)
 	{
-		write(file, line, func, subsystem, type, threadName, &buffer[0]);
-		va_end(args);
+		msg = &m_messages[pos & (kQueuedMessageCount - 1)];
+		const U64 seq = msg->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I64 diff = I64(seq - pos);
+
+		if(diff == 0)
+		{
+			if(m_enqueuePos.compareExchange(pos, pos + 1, AtomicMemoryOrder::kRelaxed, AtomicMemoryOrder::kRelaxed))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Queue is full
+			if(m_overflowPolicy == LoggerOverflowPolicy::kDrop || g_isLoggerThread)
+			{
+				m_droppedMessageCount.fetchAdd(1, AtomicMemoryOrder::kRelaxed);
+				return;
+			}
+
+			wakeThread();
+			std::this_thread::yield();
+			pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
+		else
+		{
+			pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
 	}
-	else
+
+	// Write it
+	msg->m_file = file;
+	msg->m_func = func;
+	msg->m_subsystem = subsystem;
+	msg->m_fmt = fmt;
+	msg->m_line = line;
+	msg->m_type = type;
+
+	const PtrSize threadNameLength = (threadName) ? strnlen(threadName, Thread::kThreadNameMaxLength) : 0;
+	memcpy(&msg->m_threadName[0], threadName, threadNameLength);
+	msg->m_threadName[threadNameLength] = '\0';
+
+	U8* payloadOut = &msg->m_payload[0];
+	if(payloadSize > kMaxInlinePayloadSize)
 	{
-		// Not enough space.
+		msg->m_heapPayload = static_cast<U8*>(malloc(payloadSize));
+		payloadOut = msg->m_heapPayload;
+	}
+	memcpy(payloadOut, payload, payloadSize);
+	msg->m_payloadSize = payloadSize;
 
-		va_end(args);
-		va_start(args, fmt);
+	// Publish it. Sequentially consistent to pair with the m_threadSleeping in wakeThread()
+	msg->m_sequence.store(pos + 1, AtomicMemoryOrder::kSeqCst);
 
-		const PtrSize newSize = len + 1;
-		Char* newBuffer = static_cast<Char*>(malloc(newSize));
-		len = vsnprintf(newBuffer, newSize, fmt, args);
+	wakeThread();
+}
 
-		write(file, line, func, subsystem, type, threadName, newBuffer);
+void Logger::wakeThread()
+{
+	// Only one of the callers will have to pay for the notification
+	if(m_threadSleeping.load(AtomicMemoryOrder::kSeqCst) && m_threadSleeping.exchange(0, AtomicMemoryOrder::kSeqCst))
+	{
+		LockGuard<Mutex> lock(m_threadMtx);
+		m_threadCondVar.notifyOne();
+	}
+}
 
-		free(newBuffer);
-		va_end(args);
+Bool Logger::hasQueuedMessages() const
+{
+	const U64 pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+	const Message& msg = m_messages[pos & (kQueuedMessageCount - 1)];
+	return msg.m_sequence.load(AtomicMemoryOrder::kSeqCst) == pos + 1;
+}
+
+U32 Logger::processQueuedMessages(FormatBuffer& buffer)
+{
+	const U64 droppedCount = m_droppedMessageCount.load(AtomicMemoryOrder::kRelaxed);
+	if(!hasQueuedMessages() && droppedCount == m_reportedDroppedMessageCount)
+	{
+		return 0;
 	}
+
+	U64 pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+	U32 count = 0;
+
+	LockGuard<Mutex> lock(m_mutex);
+
+	for(; count < kMaxMessagesPerBatch; ++count)
+	{
+		Message& msg = m_messages[pos & (kQueuedMessageCount - 1)];
+		if(msg.m_sequence.load(AtomicMemoryOrder::kAcquire) != pos + 1)
+		{
+			break;
+		}
+
+		const Char* text;
+		if(msg.m_fmt)
+		{
+			buffer.reset();
+			formatPackedArguments(msg.m_fmt, msg.getPayload(), msg.m_payloadSize, buffer);
+			text = buffer.cstr();
+		}
+		else
+		{
+			text = reinterpret_cast<const Char*>(msg.getPayload());
+		}
+
+		const LoggerMessageInfo inf = {getBaseFilename(msg.m_file), msg.m_line, msg.m_func, msg.m_type, text, msg.m_subsystem, &msg.m_threadName[0]};
+		dispatch(inf);
+
+		if(msg.m_heapPayload)
+		{
+			free(msg.m_heapPayload);
+			msg.m_heapPayload = nullptr;
+		}
+
+		// Give it back to the producers
+		msg.m_sequence.store(pos + kQueuedMessageCount, AtomicMemoryOrder::kRelease);
+		++pos;
+	}
+
+	if(droppedCount != m_reportedDroppedMessageCount)
+	{
+		buffer.reset();
+		buffer.appendf("%" PRIu64 " log messages were dropped because the queue was full", droppedCount - m_reportedDroppedMessageCount);
+		m_reportedDroppedMessageCount = droppedCount;
+
+		const LoggerMessageInfo inf = {getBaseFilename(ANKI_FILE),    __LINE__, ANKI_FUNC, LoggerMessageType::kWarning, buffer.cstr(), "UTIL",
+									   Thread::getCurrentThreadName()};
+		dispatch(inf);
+	}
+
+	m_dequeuePos.store(pos, AtomicMemoryOrder::kRelease);
+	// Return non-zero if only the dropped messages were reported to keep the logger thread awake for one more iteration
+	return (count > 0) ? count : 1;
+}
+
+void Logger::flush()
+{
+	if(!m_asyncEnabled.load(AtomicMemoryOrder::kSeqCst) || g_isLoggerThread)
+	{
+		return;
+	}
+
+	const U64 target = m_enqueuePos.load(AtomicMemoryOrder::kAcquire);
+	while(m_dequeuePos.load(AtomicMemoryOrder::kAcquire) < target)
+	{
+		wakeThread();
+		std::this_thread::yield();
+	}
+}
+
+Error Logger::threadMain(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+	g_isLoggerThread = true;
+	FormatBuffer buffer;
+
+	while(true)
+	{
+		if(self.processQueuedMessages(buffer) > 0)
+		{
+			continue;
+		}
+
+		LockGuard<Mutex> lock(self.m_threadMtx);
+
+		self.m_threadSleeping.store(1, AtomicMemoryOrder::kSeqCst);
+		const Bool empty = !self.hasQueuedMessages();
+		if(empty && self.m_quitThread)
+		{
+			self.m_threadSleeping.store(0, AtomicMemoryOrder::kSeqCst);
+			break;
+		}
+
+		if(empty)
+		{
+			self.m_threadCondVar.wait(self.m_threadMtx);
+		}
+
+		self.m_threadSleeping.store(0, AtomicMemoryOrder::kSeqCst);
+	}
+
+	return Error::kNone;
 }
 
 void Logger::defaultSystemMessageHandler(void*, const LoggerMessageInfo& info)
@@ -43,6 +43,14 @@ public:
 	const Char* m_threadName;
 };
 
+/// What happens when a message is logged and the queue of the asynchronous logger is full.
+/// @memberof Logger
+enum class LoggerOverflowPolicy : U8
+{
+	kBlock, ///< Wait for the logger thread to make room.
+	kDrop ///< Drop the message and increase a counter. The logger thread will report the count.
+};
+
 /// The message handler callback.
 /// @memberof Logger
 using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& info);
@@ -51,6 +59,10 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+///
+/// By default the logger is asynchronous. The callers of writeFormated() only copy the format string pointer and the arguments to a lock-free
+/// queue. A logger thread formats the messages and calls the handlers in batches. The handlers are called from the logger thread. Fatal
+/// messages flush the queue and they are written synchronously. Set the ANKI_LOG_SYNC=1 environment variable to have a synchronous logger.
 class Logger : public MakeSingleton<Logger>
 {
 	template<typename>
@@ -70,6 +82,7 @@ public:
 	void write(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName, const Char* msg);
 
 	/// Send a formated message.
+	/// @note The fmt should be a string literal or have static storage because it's formatted later.
 	ANKI_CHECK_FORMAT(7, 8)
 	void writeFormated(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 					   const Char* fmt, ...);
@@ -80,6 +93,27 @@ public:
 		m_verbosityEnabled = enable;
 	}
 
+	/// Enable or disable the asynchronous logging. Disabling it writes the queued messages.
+	/// @note It's not thread-safe against the other methods of the logger.
+	void enableAsync(Bool enable);
+
+	/// Enable or disable the handler that writes to the terminal (or logcat etc).
+	void enableDefaultMessageHandler(Bool enable);
+
+	void setOverflowPolicy(LoggerOverflowPolicy policy)
+	{
+		m_overflowPolicy = policy;
+	}
+
+	/// Wait until the queued messages are written.
+	void flush();
+
+	/// The number of messages dropped because of LoggerOverflowPolicy::kDrop.
+	U64 getDroppedMessageCount() const
+	{
+		return m_droppedMessageCount.load(AtomicMemoryOrder::kRelaxed);
+	}
+
 private:
 	class Handler
 	{
@@ -88,16 +122,49 @@ private:
 		LoggerMessageHandlerCallback m_callback = nullptr;
 	};
 
+	class Message;
+	class FormatBuffer;
+
 	Mutex m_mutex; ///< For thread safety
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 	Bool m_verbosityEnabled = false;
 
+	// Asynchronous logging. The queue is a bounded MPSC ring. Every message has a sequence number that tells if it's free or written
+	Message* m_messages = nullptr;
+	Atomic<U64> m_enqueuePos = {0};
+	Atomic<U64> m_dequeuePos = {0}; ///< Written by the logger thread after it writes a batch of messages.
+	Atomic<U64> m_droppedMessageCount = {0};
+	U64 m_reportedDroppedMessageCount = 0;
+
+	Thread m_thread = {"Logger"};
+	Mutex m_threadMtx;
+	ConditionVariable m_threadCondVar;
+	Atomic<U32> m_threadSleeping = {0};
+	Atomic<U32> m_asyncEnabled = {0};
+	Bool m_threadRunning = false;
+	Bool m_quitThread = false;
+	LoggerOverflowPolicy m_overflowPolicy = LoggerOverflowPolicy::kBlock;
+
 	/// Initialize the logger and add the default message handler
 	Logger();
 
 	~Logger();
 
+	/// Call the handlers. m_mutex should be locked.
+	void dispatch(const LoggerMessageInfo& info);
+
+	void enqueue(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName, const Char* fmt,
+				 const void* payload, U32 payloadSize);
+
+	U32 processQueuedMessages(FormatBuffer& buffer);
+
+	Bool hasQueuedMessages() const;
+
+	void wakeThread();
+
+	static Error threadMain(ThreadCallbackInfo& info);
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
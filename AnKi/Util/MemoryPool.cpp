@@ -13,6 +13,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
+#include <new>
 
 namespace anki {
 
@@ -47,6 +48,228 @@ static void invalidateMemory([[maybe_unused]] TPtr ptr, [[maybe_unused]] TSize s
 
 #define ANKI_OOM_ACTION() ANKI_UTIL_LOGE("Out of memory. Expect segfault")
 
+/// @name HeapMemoryPool thread cache
+/// @{
+constexpr Array<U32, 12> kSizeClassSlotSizes = {32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512};
+constexpr U32 kSizeClassCount = kSizeClassSlotSizes.getSize();
+
+/// Every allocation served by the thread cache is preceded by a header. The 1st word of the header is the free list link (when the slot is free)
+/// and the 2nd is the tag that tells how to free the allocation. It keeps the allocations aligned to ANKI_SAFE_ALIGNMENT.
+constexpr U32 kSizeClassHeaderSize = 16;
+static_assert(kSizeClassHeaderSize >= ANKI_SAFE_ALIGNMENT);
+
+constexpr PtrSize kMaxSizeClassAllocationSize = kSizeClassSlotSizes[kSizeClassCount - 1] - kSizeClassHeaderSize;
+constexpr PtrSize kSizeClassChunkSize = 16_KB;
+constexpr U32 kThreadCacheBatchSize = 32; ///< Number of slots that move between the thread and the central free lists in one go.
+constexpr U32 kMaxThreadCachedPools = 16;
+
+/// The tag of allocations that didn't fit in any size class. The rest of the bits is the offset from the start of the allocation.
+constexpr U64 kLargeAllocationTag = 0xFF;
+
+/// Map (size + header) / 16 to a size class.
+static constexpr Array<U8, kSizeClassSlotSizes[kSizeClassCount - 1] / 16 + 1> kSizeClassLut = []() {
+	Array<U8, kSizeClassSlotSizes[kSizeClassCount - 1] / 16 + 1> lut = {};
+	U32 sizeClass = 0;
+	for(U32 i = 0; i < lut.getSize(); ++i)
+	{
+		while(kSizeClassSlotSizes[sizeClass] < i * 16)
+		{
+			++sizeClass;
+		}
+		lut[i] = U8(sizeClass);
+	}
+	return lut;
+}();
+
+static U32 computeSizeClass(PtrSize size)
+{
+	ANKI_ASSERT(size <= kMaxSizeClassAllocationSize);
+	return kSizeClassLut[(size + kSizeClassHeaderSize + 15) / 16];
+}
+
+static void*& getSlotLink(void* slot)
+{
+	return *static_cast<void**>(slot);
+}
+
+static U64& getSlotTag(void* slot)
+{
+	return *reinterpret_cast<U64*>(static_cast<U8*>(slot) + sizeof(void*));
+}
+
+/// A singly linked list of free slots.
+class SizeClassFreeList
+{
+public:
+	void* m_head = nullptr;
+	U32 m_count = 0;
+
+	void push(void* slot)
+	{
+		getSlotLink(slot) = m_head;
+		m_head = slot;
+		++m_count;
+	}
+
+	void* pop()
+	{
+		ANKI_ASSERT(m_head);
+		void* slot = m_head;
+		m_head = getSlotLink(slot);
+		--m_count;
+		return slot;
+	}
+};
+
+/// The part of the HeapMemoryPool's thread cache that is shared between threads. It carves the slots of the size classes from chunks and keeps
+/// the slots that the threads returned.
+class alignas(ANKI_CACHE_LINE_SIZE) SizeClassAllocator
+{
+public:
+	class alignas(ANKI_CACHE_LINE_SIZE) CentralList
+	{
+	public:
+		SpinLock m_lock;
+		SizeClassFreeList m_list;
+	};
+
+	Array<CentralList, kSizeClassCount> m_centralLists;
+
+	SpinLock m_chunksLock;
+	void* m_chunks = nullptr; ///< All chunks linked through their 1st word.
+
+	U64 m_epoch = 0; ///< Unique among all the SizeClassAllocators ever created. Used to invalidate stale thread caches.
+	U32 m_index = kMaxU32; ///< Index in the thread cache.
+
+	/// Move a batch of slots to a thread's free list.
+	void refill(HeapMemoryPool& pool, U32 sizeClass, SizeClassFreeList& out)
+	{
+		CentralList& central = m_centralLists[sizeClass];
+		LockGuard lock(central.m_lock);
+
+		if(central.m_list.m_count == 0)
+		{
+			// Carve a new chunk
+
+			void* chunk = pool.getAllocationCallback()(pool.getAllocationCallbackUserData(), nullptr, kSizeClassChunkSize, kSizeClassHeaderSize);
+			if(!chunk) [[unlikely]]
+			{
+				return;
+			}
+
+			{
+				LockGuard lock2(m_chunksLock);
+				getSlotLink(chunk) = m_chunks;
+				m_chunks = chunk;
+			}
+
+			const U32 slotSize = kSizeClassSlotSizes[sizeClass];
+			const U32 slotCount = (kSizeClassChunkSize - kSizeClassHeaderSize) / slotSize;
+			U8* slot = static_cast<U8*>(chunk) + kSizeClassHeaderSize;
+			for(U32 i = 0; i < slotCount; ++i)
+			{
+				getSlotTag(slot) = sizeClass;
+				central.m_list.push(slot);
+				slot += slotSize;
+			}
+		}
+
+		const U32 count = min(central.m_list.m_count, kThreadCacheBatchSize);
+		for(U32 i = 0; i < count; ++i)
+		{
+			out.push(central.m_list.pop());
+		}
+	}
+
+	/// Return a batch of slots (or all of them) from a thread's free list.
+	void release(U32 sizeClass, SizeClassFreeList& in, U32 count)
+	{
+		ANKI_ASSERT(count > 0 && count <= in.m_count);
+
+		// Walk the list outside the lock
+		void* first = in.m_head;
+		void* last = first;
+		for(U32 i = 1; i < count; ++i)
+		{
+			last = getSlotLink(last);
+		}
+
+		in.m_head = getSlotLink(last);
+		in.m_count -= count;
+
+		CentralList& central = m_centralLists[sizeClass];
+		LockGuard lock(central.m_lock);
+		getSlotLink(last) = central.m_list.m_head;
+		central.m_list.m_head = first;
+		central.m_list.m_count += count;
+	}
+};
+
+/// Keeps track of the live SizeClassAllocators. It's needed to return the slots of threads that exit.
+class SizeClassAllocatorRegistry
+{
+public:
+	Mutex m_mtx;
+	Array<SizeClassAllocator*, kMaxThreadCachedPools> m_allocators = {};
+	U64 m_nextEpoch = 1;
+};
+
+static SizeClassAllocatorRegistry g_sizeClassAllocatorRegistry;
+
+/// The free lists of a single thread.
+class SizeClassThreadCache
+{
+public:
+	class PoolCache
+	{
+	public:
+		U64 m_epoch = 0;
+		Array<SizeClassFreeList, kSizeClassCount> m_lists;
+	};
+
+	Array<PoolCache, kMaxThreadCachedPools> m_pools;
+
+	~SizeClassThreadCache()
+	{
+		// Give the slots back to the pools that are still alive
+		LockGuard lock(g_sizeClassAllocatorRegistry.m_mtx);
+
+		for(U32 i = 0; i < kMaxThreadCachedPools; ++i)
+		{
+			SizeClassAllocator* allocator = g_sizeClassAllocatorRegistry.m_allocators[i];
+			if(!allocator || allocator->m_epoch != m_pools[i].m_epoch)
+			{
+				continue;
+			}
+
+			for(U32 sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass)
+			{
+				SizeClassFreeList& list = m_pools[i].m_lists[sizeClass];
+				if(list.m_count)
+				{
+					allocator->release(sizeClass, list, list.m_count);
+				}
+			}
+		}
+	}
+
+	/// Get the free lists of a pool. Drops whatever the thread had cached if it belongs to an older pool.
+	Array<SizeClassFreeList, kSizeClassCount>& getLists(const SizeClassAllocator& allocator)
+	{
+		PoolCache& cache = m_pools[allocator.m_index];
+		if(cache.m_epoch != allocator.m_epoch) [[unlikely]]
+		{
+			cache = PoolCache();
+			cache.m_epoch = allocator.m_epoch;
+		}
+
+		return cache.m_lists;
+	}
+};
+
+static thread_local SizeClassThreadCache g_sizeClassThreadCache;
+/// @}
+
 void* mallocAligned(PtrSize size, PtrSize alignmentBytes)
 {
 	ANKI_ASSERT(size > 0);
@@ -163,12 +386,33 @@ void BaseMemoryPool::destroy()
 	m_allocationCount.setNonAtomically(0);
 }
 
-void HeapMemoryPool::init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name)
+void HeapMemoryPool::init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name, Bool enableThreadCache)
 {
 	BaseMemoryPool::init(allocCb, allocCbUserData, name);
 #if ANKI_MEM_EXTRA_CHECKS
 	m_signature = computePoolSignature(this);
 #endif
+
+	if(enableThreadCache)
+	{
+		LockGuard lock(g_sizeClassAllocatorRegistry.m_mtx);
+
+		for(U32 i = 0; i < kMaxThreadCachedPools; ++i)
+		{
+			if(g_sizeClassAllocatorRegistry.m_allocators[i] == nullptr)
+			{
+				void* mem = m_allocCb(m_allocCbUserData, nullptr, sizeof(SizeClassAllocator), alignof(SizeClassAllocator));
+				m_sizeClassAllocator = ::new(mem) SizeClassAllocator();
+				m_sizeClassAllocator->m_index = i;
+				m_sizeClassAllocator->m_epoch = g_sizeClassAllocatorRegistry.m_nextEpoch++;
+
+				g_sizeClassAllocatorRegistry.m_allocators[i] = m_sizeClassAllocator;
+				break;
+			}
+		}
+
+		// If there are too many pools with thread caches this one will work without one
+	}
 }
 
 void HeapMemoryPool::destroy()
@@ -178,6 +422,28 @@ void HeapMemoryPool::destroy()
 	{
 		ANKI_UTIL_LOGE("Memory pool destroyed before all memory being released (%u deallocations missed): %s", count, getName());
 	}
+
+	if(m_sizeClassAllocator)
+	{
+		{
+			LockGuard lock(g_sizeClassAllocatorRegistry.m_mtx);
+			g_sizeClassAllocatorRegistry.m_allocators[m_sizeClassAllocator->m_index] = nullptr;
+		}
+
+		// The thread caches might still point to the chunks but the epoch will prevent them from using them
+		void* chunk = m_sizeClassAllocator->m_chunks;
+		while(chunk)
+		{
+			void* next = getSlotLink(chunk);
+			m_allocCb(m_allocCbUserData, chunk, 0, 0);
+			chunk = next;
+		}
+
+		m_sizeClassAllocator->~SizeClassAllocator();
+		m_allocCb(m_allocCbUserData, m_sizeClassAllocator, 0, 0);
+		m_sizeClassAllocator = nullptr;
+	}
+
 	BaseMemoryPool::destroy();
 }
 
@@ -189,7 +455,37 @@ void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 	size += kAllocationHeaderSize;
 #endif
 
-	void* mem = m_allocCb(m_allocCbUserData, nullptr, size, alignment);
+	void* mem;
+	if(!m_sizeClassAllocator)
+	{
+		mem = m_allocCb(m_allocCbUserData, nullptr, size, alignment);
+	}
+	else if(size <= kMaxSizeClassAllocationSize && alignment <= kSizeClassHeaderSize)
+	{
+		// Small allocation, get a slot from the thread cache
+
+		const U32 sizeClass = computeSizeClass(size);
+		SizeClassFreeList& list = g_sizeClassThreadCache.getLists(*m_sizeClassAllocator)[sizeClass];
+		if(list.m_count == 0) [[unlikely]]
+		{
+			m_sizeClassAllocator->refill(*this, sizeClass, list);
+		}
+
+		mem = (list.m_count) ? static_cast<U8*>(list.pop()) + kSizeClassHeaderSize : nullptr;
+	}
+	else
+	{
+		// Large allocation, go to the callback but add a header to be able to tell it apart on free
+
+		const PtrSize offset = max<PtrSize>(alignment, kSizeClassHeaderSize);
+		U8* base = static_cast<U8*>(m_allocCb(m_allocCbUserData, nullptr, size + offset, offset));
+		mem = nullptr;
+		if(base)
+		{
+			mem = base + offset;
+			getSlotTag(static_cast<U8*>(mem) - kSizeClassHeaderSize) = (U64(offset) << 8u) | kLargeAllocationTag;
+		}
+	}
 
 	if(mem != nullptr)
 	{
@@ -231,7 +527,33 @@ void HeapMemoryPool::free(void* ptr)
 	invalidateMemory(ptr, header.m_allocationSize);
 #endif
 	m_allocationCount.fetchSub(1);
-	m_allocCb(m_allocCbUserData, ptr, 0, 0);
+
+	if(!m_sizeClassAllocator)
+	{
+		m_allocCb(m_allocCbUserData, ptr, 0, 0);
+		return;
+	}
+
+	void* slot = static_cast<U8*>(ptr) - kSizeClassHeaderSize;
+	const U64 tag = getSlotTag(slot);
+	if((tag & 0xFFu) == kLargeAllocationTag)
+	{
+		m_allocCb(m_allocCbUserData, static_cast<U8*>(ptr) - (tag >> 8u), 0, 0);
+	}
+	else
+	{
+		// Give it back to the thread cache and return some slots to the central free list if the thread has too many
+
+		const U32 sizeClass = U32(tag);
+		ANKI_ASSERT(sizeClass < kSizeClassCount);
+		SizeClassFreeList& list = g_sizeClassThreadCache.getLists(*m_sizeClassAllocator)[sizeClass];
+		list.push(slot);
+
+		if(list.m_count >= kThreadCacheBatchSize * 2) [[unlikely]]
+		{
+			m_sizeClassAllocator->release(sizeClass, list, kThreadCacheBatchSize);
+		}
+	}
 }
 
 Error StackMemoryPool::StackAllocatorBuilderInterface::allocateChunk(PtrSize size, Chunk*& out)
@@ -123,6 +123,9 @@ private:
 	Type m_type = Type::kNone;
 };
 
+// Forward
+class SizeClassAllocator;
+
 /// A dummy interface to match the StackMemoryPool interfaces in order to be used by the same allocator template.
 class HeapMemoryPool : public BaseMemoryPool
 {
@@ -134,10 +137,10 @@ public:
 	}
 
 	/// @see init
-	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr)
+	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr, Bool enableThreadCache = false)
 		: HeapMemoryPool()
 	{
-		init(allocCb, allocCbUserData, name);
+		init(allocCb, allocCbUserData, name, enableThreadCache);
 	}
 
 	/// Destroy
@@ -150,7 +153,9 @@ public:
 	/// @param allocCb The allocation function callback.
 	/// @param allocCbUserData The user data to pass to the allocation function.
 	/// @param name An optional name.
-	void init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr);
+	/// @param enableThreadCache Serve the small allocations from thread local free lists of size classes instead of calling the allocation
+	///                          callback every time. Worth it for pools that get many small allocations from many threads.
+	void init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr, Bool enableThreadCache = false);
 
 	/// Manual destroy. The destructor calls that as well.
 	void destroy();
@@ -166,6 +171,8 @@ private:
 #if ANKI_MEM_EXTRA_CHECKS
 	PoolSignature m_signature = 0;
 #endif
+
+	SizeClassAllocator* m_sizeClassAllocator = nullptr; ///< Non-null if the thread cache is enabled.
 };
 
 /// The default global memory pool.
@@ -176,7 +183,7 @@ class DefaultMemoryPool : public HeapMemoryPool, public MakeSingleton<DefaultMem
 
 private:
 	DefaultMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData)
-		: HeapMemoryPool(allocCb, allocCbUserData, "DefaultMemPool")
+		: HeapMemoryPool(allocCb, allocCbUserData, "DefaultMemPool", true)
 	{
 	}
 
@@ -247,6 +254,13 @@ public:
 		return m_builder.getMemoryCapacity();
 	}
 
+	/// Get the memory that was allocated since the last reset.
+	/// @note It's not thread safe with other methods.
+	PtrSize getMemoryUsage() const
+	{
+		return m_builder.getMemoryUsage();
+	}
+
 private:
 	/// This is the absolute max alignment.
 	static constexpr U32 kMaxAlignment = ANKI_SAFE_ALIGNMENT;
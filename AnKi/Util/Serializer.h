@@ -13,6 +13,10 @@ namespace anki {
 /// @addtogroup util_file
 /// @{
 
+namespace detail {
+class BinarySerializerHeader;
+} // end namespace detail
+
 #define _ANKI_SIMPLE_TYPE (std::is_integral<T>::value || std::is_floating_point<T>::value || std::is_enum<T>::value)
 
 /// Serialize functor. Used to add serialization code to classes that you can't add a serialize() method.
@@ -208,6 +212,14 @@ public:
 	template<typename T, typename TFile>
 	static Error deserialize(T*& x, BaseMemoryPool& pool, TFile& file);
 
+	/// Use the contents of a serialized file in place. The file is position independent (the pointers are offsets) so it can be mmapped or read in
+	/// one go and then used after the pointers are patched.
+	/// @param[out] x Points inside the blob.
+	/// @param blob The contents of the whole file. Needs to be writable and aligned to ANKI_SAFE_ALIGNMENT. It's patched so it can't be used
+	///             more than once.
+	template<typename T>
+	static Error deserializeInPlace(T*& x, WeakArray<U8, PtrSize> blob);
+
 	/// Read a single value. Can't call this directly.
 	template<typename T>
 	void doValue([[maybe_unused]] CString varName, [[maybe_unused]] PtrSize memberOffset, [[maybe_unused]] T& x)
@@ -236,6 +248,13 @@ public:
 	{
 		// Do nothing
 	}
+
+private:
+	template<typename T>
+	static Error validateHeader(const detail::BinarySerializerHeader& header, PtrSize fileSize);
+
+	/// Turn the offsets into pointers. Checks the offsets so a corrupt file won't cause writes or pointers outside the data.
+	static Error patchPointers(U8* data, PtrSize dataSize, const U8* pointerOffsets, PtrSize pointerCount);
 };
 /// @}
 
@@ -164,6 +164,69 @@ Error BinarySerializer::doDynamicArrayComplexType(const T* arr, PtrSize size, Pt
 	return Error::kNone;
 }
 
+template<typename T>
+Error BinaryDeserializer::validateHeader(const detail::BinarySerializerHeader& header, PtrSize fileSize)
+{
+	constexpr PtrSize dataFilePos = sizeof(header);
+
+	if(memcmp(&header.m_magic[0], detail::kBinarySerializerMagic, 8) != 0)
+	{
+		ANKI_UTIL_LOGE("Wrong magic work in header");
+		return Error::kUserData;
+	}
+
+	if(header.m_dataSize < sizeof(T))
+	{
+		ANKI_UTIL_LOGE("Wrong data size");
+		return Error::kUserData;
+	}
+
+	if(fileSize < dataFilePos || header.m_dataSize > fileSize - dataFilePos)
+	{
+		ANKI_UTIL_LOGE("File size doesn't match expectations");
+		return Error::kUserData;
+	}
+
+	if(header.m_pointerCount
+	   && (header.m_pointerArrayFilePosition < dataFilePos + header.m_dataSize || header.m_pointerArrayFilePosition > fileSize
+		   || header.m_pointerCount > (fileSize - header.m_pointerArrayFilePosition) / sizeof(PtrSize)))
+	{
+		ANKI_UTIL_LOGE("File size doesn't match expectations");
+		return Error::kUserData;
+	}
+
+	return Error::kNone;
+}
+
+inline Error BinaryDeserializer::patchPointers(U8* data, PtrSize dataSize, const U8* pointerOffsets, PtrSize pointerCount)
+{
+	for(PtrSize i = 0; i < pointerCount; ++i)
+	{
+		// The offsets might not be aligned in the file
+		PtrSize offsetFromBeginOfData;
+		memcpy(&offsetFromBeginOfData, pointerOffsets + i * sizeof(PtrSize), sizeof(PtrSize));
+
+		if(offsetFromBeginOfData >= dataSize || dataSize - offsetFromBeginOfData < sizeof(PtrSize)
+		   || !isAligned(alignof(PtrSize), offsetFromBeginOfData))
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::kUserData;
+		}
+
+		// Add to the location the actual base address
+		PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(data + offsetFromBeginOfData);
+		if(ptrValue >= dataSize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::kUserData;
+		}
+
+		ptrValue += ptrToNumber(data);
+	}
+
+	return Error::kNone;
+}
+
 template<typename T, typename TFile>
 Error BinaryDeserializer::deserialize(T*& x, BaseMemoryPool& pool, TFile& file)
 {
@@ -171,64 +234,68 @@ Error BinaryDeserializer::deserialize(T*& x, BaseMemoryPool& pool, TFile& file)
 
 	detail::BinarySerializerHeader header;
 	ANKI_CHECK(file.read(&header, sizeof(header)));
-	const PtrSize dataFilePos = sizeof(header);
+	ANKI_CHECK(validateHeader<T>(header, file.getSize()));
+
+	// Allocate & read data
+	U8* const baseAddress = static_cast<U8*>(pool.allocate(header.m_dataSize, ANKI_SAFE_ALIGNMENT));
+	Error err = file.read(baseAddress, header.m_dataSize);
 
-	// Sanity checks
+	// Fix pointers. Read the offsets in one go, it's much faster than reading them one by one
+	if(!err && header.m_pointerCount)
 	{
-		if(memcmp(&header.m_magic[0], detail::kBinarySerializerMagic, 8) != 0)
+		const PtrSize pointerArraySize = header.m_pointerCount * sizeof(PtrSize);
+		U8* pointerOffsets = static_cast<U8*>(pool.allocate(pointerArraySize, alignof(PtrSize)));
+
+		if(header.m_pointerArrayFilePosition != sizeof(header) + header.m_dataSize)
 		{
-			ANKI_UTIL_LOGE("Wrong magic work in header");
-			return Error::kUserData;
+			err = file.seek(header.m_pointerArrayFilePosition, FileSeekOrigin::kBeginning);
 		}
 
-		if(header.m_dataSize < sizeof(T))
+		if(!err)
 		{
-			ANKI_UTIL_LOGE("Wrong data size");
-			return Error::kUserData;
+			err = file.read(pointerOffsets, pointerArraySize);
 		}
 
-		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
-		const PtrSize actualSizeAfterHeader = file.getSize() - dataFilePos;
-		if(expectedSizeAfterHeader > actualSizeAfterHeader)
+		if(!err)
 		{
-			ANKI_UTIL_LOGE("File size doesn't match expectations");
-			return Error::kUserData;
+			err = patchPointers(baseAddress, header.m_dataSize, pointerOffsets, header.m_pointerCount);
 		}
+
+		pool.free(pointerOffsets);
 	}
 
-	// Allocate & read data
-	U8* const baseAddress = static_cast<U8*>(pool.allocate(header.m_dataSize, ANKI_SAFE_ALIGNMENT));
-	ANKI_CHECK(file.read(baseAddress, header.m_dataSize));
+	if(err)
+	{
+		pool.free(baseAddress);
+		return err;
+	}
 
-	// Fix pointers
+	// Done
+	x = reinterpret_cast<T*>(baseAddress);
+	return Error::kNone;
+}
+
+template<typename T>
+Error BinaryDeserializer::deserializeInPlace(T*& x, WeakArray<U8, PtrSize> blob)
+{
+	x = nullptr;
+	ANKI_ASSERT(isAligned(ANKI_SAFE_ALIGNMENT, blob.getBegin()));
+
+	if(blob.getSize() < sizeof(detail::BinarySerializerHeader))
+	{
+		ANKI_UTIL_LOGE("File size doesn't match expectations");
+		return Error::kUserData;
+	}
+
+	const detail::BinarySerializerHeader& header = *reinterpret_cast<const detail::BinarySerializerHeader*>(blob.getBegin());
+	ANKI_CHECK(validateHeader<T>(header, blob.getSize()));
+
+	U8* const baseAddress = blob.getBegin() + sizeof(header);
 	if(header.m_pointerCount)
 	{
-		ANKI_CHECK(file.seek(header.m_pointerArrayFilePosition, FileSeekOrigin::kBeginning));
-		for(PtrSize i = 0; i < header.m_pointerCount; ++i)
-		{
-			// Read the location of the pointer
-			PtrSize offsetFromBeginOfData;
-			ANKI_CHECK(file.read(&offsetFromBeginOfData, sizeof(offsetFromBeginOfData)));
-			if(offsetFromBeginOfData >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::kUserData;
-			}
-
-			// Add to the location the actual base address
-			U8* ptrLocation = baseAddress + offsetFromBeginOfData;
-			PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(ptrLocation);
-			if(ptrValue >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::kUserData;
-			}
-
-			ptrValue += ptrToNumber(baseAddress);
-		}
+		ANKI_CHECK(patchPointers(baseAddress, header.m_dataSize, blob.getBegin() + header.m_pointerArrayFilePosition, header.m_pointerCount));
 	}
 
-	// Done
 	x = reinterpret_cast<T*>(baseAddress);
 	return Error::kNone;
 }
@@ -86,6 +86,10 @@ public:
 		return m_memoryCapacity;
 	}
 
+	/// Get the memory that was handed out since the last reset. It includes the unused space at the end of the full chunks.
+	/// @note Not thread safe. Don't call it while calling allocate.
+	PtrSize getMemoryUsage() const;
+
 private:
 	/// The current chunk. Chose the more strict memory order to avoid compiler re-ordering of instructions
 	Atomic<TChunk*, AtomicMemoryOrder::kSeqCst> m_crntChunk = {nullptr};
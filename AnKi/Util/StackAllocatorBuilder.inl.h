@@ -182,6 +182,28 @@ void StackAllocatorBuilder<TChunk, TInterface, TLock>::free()
 	}
 }
 
+template<typename TChunk, typename TInterface, typename TLock>
+PtrSize StackAllocatorBuilder<TChunk, TInterface, TLock>::getMemoryUsage() const
+{
+	const TChunk* crntChunk = m_crntChunk.load();
+	PtrSize usage = 0;
+	const TChunk* chunk = m_chunksListHead;
+	for(U32 i = 0; i < m_chunksInUse; ++i)
+	{
+		ANKI_ASSERT(chunk);
+		if(chunk == crntChunk)
+		{
+			usage += min(chunk->m_offsetInChunk.load(), chunk->m_chunkSize);
+			break;
+		}
+
+		usage += chunk->m_chunkSize;
+		chunk = chunk->m_nextChunk;
+	}
+
+	return usage;
+}
+
 template<typename TChunk, typename TInterface, typename TLock>
 void StackAllocatorBuilder<TChunk, TInterface, TLock>::reset()
 {
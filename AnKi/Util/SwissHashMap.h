@@ -0,0 +1,463 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/HashMap.h>
+
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+namespace detail {
+
+/// The control bytes of a SwissHashMap. One byte per slot. The slots that hold an element store 7 bits of the hash, the rest have the top bit set.
+class SwissHashMapControl
+{
+public:
+	static constexpr U8 kEmpty = 0b10000000;
+	static constexpr U8 kDeleted = 0b11111110;
+
+	static constexpr U32 kGroupSize = 16;
+
+#if ANKI_SIMD_NEON
+	static constexpr U32 kLaneShift = 2; ///< The masks have 4 bits per slot.
+#else
+	static constexpr U32 kLaneShift = 0; ///< The masks have 1 bit per slot.
+#endif
+
+	static Bool isFull(U8 c)
+	{
+		return (c & kEmpty) == 0;
+	}
+};
+
+/// A group of SwissHashMapControl::kGroupSize control bytes that are tested in parallel.
+class SwissHashMapGroup
+{
+public:
+	/// @param ctrl Pointer to the 1st control byte. Needs to be aligned to kGroupSize.
+	explicit SwissHashMapGroup(const U8* ctrl)
+	{
+		ANKI_ASSERT(isAligned(SwissHashMapControl::kGroupSize, ctrl));
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_u8(ctrl);
+#else
+		m_ctrl = ctrl;
+#endif
+	}
+
+	/// Get a mask of the slots that match the 7 bits of the hash.
+	U64 match(U8 h2) const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(I8(h2)), m_ctrl)));
+#elif ANKI_SIMD_NEON
+		return toMask(vceqq_u8(m_ctrl, vdupq_n_u8(h2)));
+#else
+		return matchScalar([h2](U8 c) {
+			return c == h2;
+		});
+#endif
+	}
+
+	/// Get a mask of the empty slots.
+	U64 matchEmpty() const
+	{
+		return match(SwissHashMapControl::kEmpty);
+	}
+
+	/// Get a mask of the empty and deleted slots.
+	U64 matchEmptyOrDeleted() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(m_ctrl));
+#elif ANKI_SIMD_NEON
+		return toMask(vcltq_s8(vreinterpretq_s8_u8(m_ctrl), vdupq_n_s8(0)));
+#else
+		return matchScalar([](U8 c) {
+			return !SwissHashMapControl::isFull(c);
+		});
+#endif
+	}
+
+	/// Get the index of the lowest slot of a mask.
+	static U32 getFirstSlot(U64 mask)
+	{
+		ANKI_ASSERT(mask);
+		return U32(__builtin_ctzll(mask)) >> SwissHashMapControl::kLaneShift;
+	}
+
+	/// Remove the lowest slot from a mask.
+	static U64 removeFirstSlot(U64 mask)
+	{
+		return mask & (mask - 1);
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	uint8x16_t m_ctrl;
+
+	static U64 toMask(uint8x16_t v)
+	{
+		// Narrow every byte to 4 bits and keep one of them
+		const uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(narrow), 0) & 0x8888888888888888_U64;
+	}
+#else
+	const U8* m_ctrl;
+
+	template<typename TFunc>
+	U64 matchScalar(TFunc func) const
+	{
+		U64 mask = 0;
+		for(U32 i = 0; i < SwissHashMapControl::kGroupSize; ++i)
+		{
+			mask |= U64(func(m_ctrl[i])) << i;
+		}
+		return mask;
+	}
+#endif
+};
+
+} // end namespace detail
+
+/// SwissHashMap iterator.
+template<typename TValuePointer, typename TValueReference, typename TMapPtr>
+class SwissHashMapIterator
+{
+	template<typename, typename, typename, typename>
+	friend class SwissHashMap;
+
+	template<typename, typename, typename>
+	friend class SwissHashMapIterator;
+
+public:
+	SwissHashMapIterator() = default;
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YValuePointer, typename YValueReference, typename YMapPtr>
+	SwissHashMapIterator(const SwissHashMapIterator<YValuePointer, YValueReference, YMapPtr>& b)
+		: m_map(b.m_map)
+		, m_slot(b.m_slot)
+	{
+	}
+
+	SwissHashMapIterator(TMapPtr map, U32 slot)
+		: m_map(map)
+		, m_slot(slot)
+	{
+		ANKI_ASSERT(map);
+	}
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_map->m_slots[m_slot].m_value;
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_map->m_slots[m_slot].m_value;
+	}
+
+	SwissHashMapIterator& operator++()
+	{
+		check();
+		m_slot = m_map->findNextFull(m_slot + 1);
+		return *this;
+	}
+
+	SwissHashMapIterator operator++(int)
+	{
+		SwissHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const SwissHashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+		return m_slot == b.m_slot;
+	}
+
+	Bool operator!=(const SwissHashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+	/// Get the hash of the key.
+	U64 getKey() const
+	{
+		check();
+		return m_map->m_slots[m_slot].m_key;
+	}
+
+private:
+	TMapPtr m_map = nullptr;
+	U32 m_slot = kMaxU32;
+
+	void check() const
+	{
+		ANKI_ASSERT(m_map);
+		ANKI_ASSERT(m_slot < m_map->m_capacity && detail::SwissHashMapControl::isFull(m_map->m_controlBytes[m_slot]));
+	}
+};
+
+/// An open addressing hash map that has the same interface as HashMap. The slots are split in groups of 16 and each slot has a control byte that
+/// holds 7 bits of the hash. Lookups test a whole group of control bytes at once using SIMD and they only compare the keys of the slots whose
+/// control byte matched. Like HashMap it only stores the hash of the key so the hash needs to be unique.
+/// Erasing an element from a group that has empty slots makes the slot empty again. Otherwise it leaves a tombstone that will be reused by
+/// insertions and cleaned by the next rehash.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>>
+class SwissHashMap
+{
+	template<typename, typename, typename>
+	friend class SwissHashMapIterator;
+
+public:
+	// Typedefs
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+	using Iterator = SwissHashMapIterator<TValue*, TValue&, SwissHashMap*>;
+	using ConstIterator = SwissHashMapIterator<const TValue*, const TValue&, const SwissHashMap*>;
+
+	/// Default constructor.
+	SwissHashMap(const TMemoryPool& pool = TMemoryPool())
+		: m_pool(pool)
+	{
+	}
+
+	/// Move.
+	SwissHashMap(SwissHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// Copy.
+	SwissHashMap(const SwissHashMap& b)
+	{
+		*this = b;
+	}
+
+	~SwissHashMap()
+	{
+		destroy();
+	}
+
+	/// Move.
+	SwissHashMap& operator=(SwissHashMap&& b)
+	{
+		destroy();
+		m_pool = b.m_pool;
+		m_controlBytes = b.m_controlBytes;
+		m_slots = b.m_slots;
+		m_capacity = b.m_capacity;
+		m_elementCount = b.m_elementCount;
+		m_growthLeft = b.m_growthLeft;
+		b.resetMembers();
+		return *this;
+	}
+
+	/// Copy.
+	SwissHashMap& operator=(const SwissHashMap& b);
+
+	/// Get begin.
+	Iterator getBegin()
+	{
+		return Iterator(this, findNextFull(0));
+	}
+
+	/// Get begin.
+	ConstIterator getBegin() const
+	{
+		return ConstIterator(this, findNextFull(0));
+	}
+
+	/// Get end.
+	Iterator getEnd()
+	{
+		return Iterator(this, kMaxU32);
+	}
+
+	/// Get end.
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(this, kMaxU32);
+	}
+
+	/// Get begin.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Get begin.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Get end.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Get end.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Return true if map is empty.
+	Bool isEmpty() const
+	{
+		return m_elementCount == 0;
+	}
+
+	PtrSize getSize() const
+	{
+		return m_elementCount;
+	}
+
+	/// Destroy the map and free its storage.
+	void destroy();
+
+	/// Construct an element inside the map. If the key exists its value will be replaced.
+	template<typename... TArgs>
+	Iterator emplace(const TKey& key, TArgs&&... args);
+
+	/// Erase element.
+	void erase(Iterator it);
+
+	/// Find a value using a key.
+	Iterator find(const Key& key)
+	{
+		return Iterator(this, findInternal(THasher()(key)));
+	}
+
+	/// Find a value using a key.
+	ConstIterator find(const Key& key) const
+	{
+		return ConstIterator(this, findInternal(THasher()(key)));
+	}
+
+	/// Check the validity of the map.
+	void validate() const;
+
+private:
+	using Control = detail::SwissHashMapControl;
+	using Group = detail::SwissHashMapGroup;
+
+	static constexpr U32 kInitialCapacity = Control::kGroupSize;
+
+	/// Walks the groups in triangular steps. Visits all the groups once if the group count is a power of 2.
+	class ProbeSequence
+	{
+	public:
+		U32 m_group;
+		U32 m_step = 0;
+		U32 m_groupMask;
+
+		ProbeSequence(U64 hash, U32 groupCount)
+			: m_group(U32(hash >> 7) & (groupCount - 1))
+			, m_groupMask(groupCount - 1)
+		{
+		}
+
+		U32 getFirstSlot() const
+		{
+			return m_group * Control::kGroupSize;
+		}
+
+		void next()
+		{
+			++m_step;
+			ANKI_ASSERT(m_step <= m_groupMask && "Went through all groups");
+			m_group = (m_group + m_step) & m_groupMask;
+		}
+	};
+
+	/// Keep the key next to the value so a lookup touches one cache line after the control bytes.
+	class Slot
+	{
+	public:
+		U64 m_key;
+		Value m_value;
+	};
+
+	TMemoryPool m_pool;
+	U8* m_controlBytes = nullptr; ///< It's also the start of the allocation that holds the slots.
+	Slot* m_slots = nullptr;
+	U32 m_capacity = 0;
+	U32 m_elementCount = 0;
+	U32 m_growthLeft = 0; ///< The number of empty slots that can be filled before growing.
+
+	/// Mix the user's hash because it's common to have hashers that return the key as is.
+	static U64 mixHash(U64 hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCD_U64;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	static U8 getH2(U64 mixedHash)
+	{
+		return U8(mixedHash & 0x7F);
+	}
+
+	static U32 getMaxLoad(U32 capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	U32 getGroupCount() const
+	{
+		return m_capacity / Control::kGroupSize;
+	}
+
+	/// Find the slot of a key or kMaxU32.
+	U32 findInternal(U64 hash) const;
+
+	/// Find the 1st slot starting from a slot that holds an element or kMaxU32.
+	U32 findNextFull(U32 slot) const;
+
+	/// Find the 1st empty or deleted slot in the probe sequence of a hash.
+	U32 findFirstNonFull(U64 mixedHash) const;
+
+	/// Allocate new storage and move the elements.
+	void rehash(U32 newCapacity);
+
+	void allocateStorage(U32 capacity);
+
+	void resetMembers()
+	{
+		m_controlBytes = nullptr;
+		m_slots = nullptr;
+		m_capacity = 0;
+		m_elementCount = 0;
+		m_growthLeft = 0;
+	}
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/SwissHashMap.inl.h>
@@ -0,0 +1,278 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/SwissHashMap.h>
+
+namespace anki {
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+SwissHashMap<TKey, TValue, THasher, TMemoryPool>& SwissHashMap<TKey, TValue, THasher, TMemoryPool>::operator=(const SwissHashMap& b)
+{
+	destroy();
+
+	m_pool = b.m_pool;
+
+	if(b.m_capacity == 0)
+	{
+		return *this;
+	}
+
+	allocateStorage(b.m_capacity);
+	memcpy(m_controlBytes, b.m_controlBytes, m_capacity);
+
+	for(U32 i = 0; i < m_capacity; ++i)
+	{
+		if(Control::isFull(m_controlBytes[i]))
+		{
+			m_slots[i].m_key = b.m_slots[i].m_key;
+			::new(&m_slots[i].m_value) Value(b.m_slots[i].m_value);
+		}
+	}
+
+	m_elementCount = b.m_elementCount;
+	m_growthLeft = b.m_growthLeft;
+
+	return *this;
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::allocateStorage(U32 capacity)
+{
+	ANKI_ASSERT(capacity >= Control::kGroupSize && isPowerOfTwo(capacity));
+
+	// Put everything in one allocation
+	const PtrSize slotsOffset = getAlignedRoundUp(alignof(Slot), PtrSize(capacity));
+	const PtrSize size = slotsOffset + capacity * sizeof(Slot);
+	const PtrSize alignment = max<PtrSize>(Control::kGroupSize, alignof(Slot));
+
+	U8* mem = static_cast<U8*>(m_pool.allocate(size, alignment));
+	m_controlBytes = mem;
+	m_slots = reinterpret_cast<Slot*>(mem + slotsOffset);
+	m_capacity = capacity;
+
+	memset(m_controlBytes, Control::kEmpty, capacity);
+	m_elementCount = 0;
+	m_growthLeft = getMaxLoad(capacity);
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::destroy()
+{
+	if(m_controlBytes)
+	{
+		if constexpr(!std::is_trivially_destructible_v<Value>)
+		{
+			for(U32 i = 0; i < m_capacity; ++i)
+			{
+				if(Control::isFull(m_controlBytes[i]))
+				{
+					m_slots[i].m_value.~Value();
+				}
+			}
+		}
+
+		m_pool.free(m_controlBytes);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findInternal(U64 hash) const
+{
+	if(m_elementCount == 0) [[unlikely]]
+	{
+		return kMaxU32;
+	}
+
+	const U64 mixedHash = mixHash(hash);
+	const U8 h2 = getH2(mixedHash);
+
+	ProbeSequence seq(mixedHash, getGroupCount());
+	while(true)
+	{
+		const U32 firstSlot = seq.getFirstSlot();
+		const Group group(m_controlBytes + firstSlot);
+
+		for(U64 mask = group.match(h2); mask; mask = Group::removeFirstSlot(mask))
+		{
+			const U32 slot = firstSlot + Group::getFirstSlot(mask);
+			if(m_slots[slot].m_key == hash) [[likely]]
+			{
+				return slot;
+			}
+		}
+
+		// The key would have been placed in this group if it had an empty slot
+		if(group.matchEmpty())
+		{
+			return kMaxU32;
+		}
+
+		seq.next();
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findFirstNonFull(U64 mixedHash) const
+{
+	ProbeSequence seq(mixedHash, getGroupCount());
+	while(true)
+	{
+		const U32 firstSlot = seq.getFirstSlot();
+		const U64 mask = Group(m_controlBytes + firstSlot).matchEmptyOrDeleted();
+		if(mask)
+		{
+			return firstSlot + Group::getFirstSlot(mask);
+		}
+
+		seq.next();
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findNextFull(U32 slot) const
+{
+	for(; slot < m_capacity; ++slot)
+	{
+		if(Control::isFull(m_controlBytes[slot]))
+		{
+			return slot;
+		}
+	}
+
+	return kMaxU32;
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+template<typename... TArgs>
+typename SwissHashMap<TKey, TValue, THasher, TMemoryPool>::Iterator SwissHashMap<TKey, TValue, THasher, TMemoryPool>::emplace(const TKey& key,
+																															  TArgs&&... args)
+{
+	const U64 hash = THasher()(key);
+
+	// Replace if it's already there
+	U32 slot = findInternal(hash);
+	if(slot != kMaxU32)
+	{
+		m_slots[slot].m_value.~Value();
+		::new(&m_slots[slot].m_value) Value(std::forward<TArgs>(args)...);
+		return Iterator(this, slot);
+	}
+
+	if(m_capacity == 0)
+	{
+		allocateStorage(kInitialCapacity);
+	}
+
+	const U64 mixedHash = mixHash(hash);
+	slot = findFirstNonFull(mixedHash);
+
+	// Tombstones can be reused without growing
+	if(m_growthLeft == 0 && m_controlBytes[slot] == Control::kEmpty)
+	{
+		// If half the storage is tombstones rehash in place, else grow
+		rehash((m_elementCount <= getMaxLoad(m_capacity) / 2) ? m_capacity : m_capacity * 2);
+		slot = findFirstNonFull(mixedHash);
+	}
+
+	m_growthLeft -= (m_controlBytes[slot] == Control::kEmpty);
+	m_controlBytes[slot] = getH2(mixedHash);
+	m_slots[slot].m_key = hash;
+	::new(&m_slots[slot].m_value) Value(std::forward<TArgs>(args)...);
+	++m_elementCount;
+
+	return Iterator(this, slot);
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::erase(Iterator it)
+{
+	ANKI_ASSERT(it.m_map == this);
+	it.check();
+	const U32 slot = it.m_slot;
+
+	m_slots[slot].m_value.~Value();
+	--m_elementCount;
+
+	// If the group has an empty slot no probe sequence continued past it so the slot can become empty. Else leave a tombstone
+	const U32 firstSlot = getAlignedRoundDown(Control::kGroupSize, slot);
+	if(Group(m_controlBytes + firstSlot).matchEmpty())
+	{
+		m_controlBytes[slot] = Control::kEmpty;
+		++m_growthLeft;
+	}
+	else
+	{
+		m_controlBytes[slot] = Control::kDeleted;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::rehash(U32 newCapacity)
+{
+	U8* const oldControlBytes = m_controlBytes;
+	Slot* const oldSlots = m_slots;
+	const U32 oldCapacity = m_capacity;
+	[[maybe_unused]] const U32 oldElementCount = m_elementCount;
+
+	allocateStorage(newCapacity);
+
+	for(U32 i = 0; i < oldCapacity; ++i)
+	{
+		if(!Control::isFull(oldControlBytes[i]))
+		{
+			continue;
+		}
+
+		Slot& oldSlot = oldSlots[i];
+		const U64 mixedHash = mixHash(oldSlot.m_key);
+		const U32 slot = findFirstNonFull(mixedHash);
+		m_controlBytes[slot] = getH2(mixedHash);
+		m_slots[slot].m_key = oldSlot.m_key;
+		::new(&m_slots[slot].m_value) Value(std::move(oldSlot.m_value));
+		oldSlot.m_value.~Value();
+	}
+
+	m_elementCount = oldElementCount;
+	m_growthLeft -= m_elementCount;
+	ANKI_ASSERT(m_growthLeft > 0);
+
+	m_pool.free(oldControlBytes);
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::validate() const
+{
+	if(m_capacity == 0)
+	{
+		ANKI_ASSERT(m_elementCount == 0 && m_controlBytes == nullptr);
+		return;
+	}
+
+	[[maybe_unused]] U32 elementCount = 0;
+	[[maybe_unused]] U32 emptyCount = 0;
+	for(U32 i = 0; i < m_capacity; ++i)
+	{
+		const U8 c = m_controlBytes[i];
+		if(Control::isFull(c))
+		{
+			++elementCount;
+			ANKI_ASSERT(c == getH2(mixHash(m_slots[i].m_key)));
+			ANKI_ASSERT(findInternal(m_slots[i].m_key) == i);
+		}
+		else
+		{
+			ANKI_ASSERT(c == Control::kEmpty || c == Control::kDeleted);
+			emptyCount += (c == Control::kEmpty);
+		}
+	}
+
+	ANKI_ASSERT(elementCount == m_elementCount);
+	ANKI_ASSERT(emptyCount > 0);
+	ANKI_ASSERT(m_growthLeft <= emptyCount);
+}
+
+} // end namespace anki
@@ -90,6 +90,9 @@ public:
 	/// @param coreAffintyMask Pin the thread to a number of cores.
 	void pinToCores(const ThreadCoreAffinityMask& coreAffintyMask);
 
+	/// Same as pinToCores but for the calling thread.
+	static void pinCurrentThreadToCores(const ThreadCoreAffinityMask& coreAffintyMask);
+
 	/// Name the current thread.
 	static void setCurrentThreadName(const Char* name);
 
@@ -43,6 +43,22 @@ public:
 		m_cvar.notifyOne();
 	}
 
+	/// Try to assign a task to a working thread. Unlike dispatchTask() it won't wait if the queue is full so it's safe to call it from a task.
+	/// @return True if the task was dispatched.
+	Bool tryDispatchTask(const Func& func)
+	{
+		m_tasksInFlightCount.fetchAdd(1);
+
+		if(!pushBackTask(func))
+		{
+			m_tasksInFlightCount.fetchSub(1);
+			return false;
+		}
+
+		m_cvar.notifyOne();
+		return true;
+	}
+
 	/// Wait for all tasks to finish.
 	void waitForAllTasksToFinish()
 	{
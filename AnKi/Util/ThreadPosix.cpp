@@ -67,10 +67,8 @@ Error Thread::join()
 	return Error(I32(ptrToNumber(out)));
 }
 
-void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+static void pinThreadToCores(pthread_t handle, const ThreadCoreAffinityMask& coreAffintyMask)
 {
-	ANKI_ASSERT(m_started);
-
 	cpu_set_t cpus;
 	CPU_ZERO(&cpus);
 
@@ -84,15 +82,26 @@ void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
 	}
 
 #if ANKI_OS_ANDROID
-	if(sched_setaffinity(pthread_gettid_np(m_handle), sizeof(cpu_set_t), &cpus))
+	if(sched_setaffinity(pthread_gettid_np(handle), sizeof(cpu_set_t), &cpus))
 #else
-	if(pthread_setaffinity_np(m_handle, sizeof(cpu_set_t), &cpus))
+	if(pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpus))
 #endif
 	{
 		ANKI_UTIL_LOGF("pthread_setaffinity_np() failed");
 	}
 }
 
+void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+{
+	ANKI_ASSERT(m_started);
+	pinThreadToCores(m_handle, coreAffintyMask);
+}
+
+void Thread::pinCurrentThreadToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+{
+	pinThreadToCores(pthread_self(), coreAffintyMask);
+}
+
 void Thread::setCurrentThreadName(const Char* name)
 {
 	// Copy the string first and limit its size
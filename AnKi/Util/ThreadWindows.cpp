@@ -74,7 +74,7 @@ Error Thread::join()
 	return m_returnCode;
 }
 
-void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+static void pinThreadToCores(HANDLE handle, const ThreadCoreAffinityMask& coreAffintyMask)
 {
 	static_assert(std::is_same<DWORD_PTR, U64>::value, "See file");
 
@@ -89,7 +89,7 @@ void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
 		}
 	}
 
-	if(SetThreadAffinityMask(m_handle, affinity) == 0)
+	if(SetThreadAffinityMask(handle, affinity) == 0)
 	{
 		ANKI_UTIL_LOGF("SetThreadAffinityMask() failed");
 	}
@@ -100,6 +100,16 @@ void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
 	}
 }
 
+void Thread::pinToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+{
+	pinThreadToCores(m_handle, coreAffintyMask);
+}
+
+void Thread::pinCurrentThreadToCores(const ThreadCoreAffinityMask& coreAffintyMask)
+{
+	pinThreadToCores(GetCurrentThread(), coreAffintyMask);
+}
+
 void Thread::setCurrentThreadName(const Char* name)
 {
 	// Copy the string first and limit its size
@@ -0,0 +1,248 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Collision.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <random>
+#include <vector>
+
+using namespace anki;
+
+namespace {
+
+class SoaShapes
+{
+public:
+	std::vector<F32> m_min[3];
+	std::vector<F32> m_max[3];
+	std::vector<F32> m_center[3];
+	std::vector<F32> m_radius;
+
+	AabbSoa getAabbs() const
+	{
+		AabbSoa out;
+		for(U32 c = 0; c < 3; ++c)
+		{
+			out.m_min[c] = m_min[c].data();
+			out.m_max[c] = m_max[c].data();
+		}
+		out.m_count = U32(m_radius.size());
+		return out;
+	}
+
+	SphereSoa getSpheres() const
+	{
+		SphereSoa out;
+		for(U32 c = 0; c < 3; ++c)
+		{
+			out.m_center[c] = m_center[c].data();
+		}
+		out.m_radius = m_radius.data();
+		out.m_count = U32(m_radius.size());
+		return out;
+	}
+
+	Aabb getAabb(U32 i) const
+	{
+		return Aabb(Vec3(m_min[0][i], m_min[1][i], m_min[2][i]), Vec3(m_max[0][i], m_max[1][i], m_max[2][i]));
+	}
+
+	Sphere getSphere(U32 i) const
+	{
+		return Sphere(Vec3(m_center[0][i], m_center[1][i], m_center[2][i]), m_radius[i]);
+	}
+};
+
+} // end namespace
+
+static SoaShapes createRandomShapes(U32 count, U32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<F32> posDist(-100.0f, 100.0f);
+	std::uniform_real_distribution<F32> sizeDist(0.1f, 10.0f);
+
+	SoaShapes shapes;
+	for(U32 i = 0; i < count; ++i)
+	{
+		for(U32 c = 0; c < 3; ++c)
+		{
+			const F32 center = posDist(rng);
+			const F32 extend = sizeDist(rng);
+			shapes.m_min[c].push_back(center - extend);
+			shapes.m_max[c].push_back(center + extend);
+			shapes.m_center[c].push_back(center);
+		}
+
+		shapes.m_radius.push_back(sizeDist(rng));
+	}
+
+	return shapes;
+}
+
+static std::vector<Plane> createFrustumPlanes(U32 extraPlaneCount)
+{
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(60.0f), toRad(45.0f), 0.1f, 80.0f);
+	const Mat4 view(Vec3(10.0f, 5.0f, -3.0f), Mat3(Euler(toRad(20.0f), toRad(-30.0f), 0.0f)), Vec3(1.0f));
+	Array<Plane, 6> frustumPlanes;
+	extractClipPlanes(proj * view.getInverse(), frustumPlanes);
+
+	std::vector<Plane> planes(frustumPlanes.getBegin(), frustumPlanes.getEnd());
+
+	std::mt19937 rng(extraPlaneCount);
+	std::uniform_real_distribution<F32> dist(-1.0f, 1.0f);
+	for(U32 i = 0; i < extraPlaneCount; ++i)
+	{
+		planes.push_back(Plane(Vec4(dist(rng), dist(rng), dist(rng), 0.0f).getNormalized(), dist(rng) * 50.0f - 120.0f));
+	}
+
+	return planes;
+}
+
+template<typename TShape, typename TGetShape>
+static void validateMask(const std::vector<Plane>& planes, U32 count, const std::vector<U64>& mask, TGetShape getShape)
+{
+	for(U32 i = 0; i < count; ++i)
+	{
+		const TShape shape = getShape(i);
+		Bool inside = true;
+		for(const Plane& plane : planes)
+		{
+			inside = inside && testPlane(plane, shape) >= 0.0f;
+		}
+
+		const Bool batchInside = !!(mask[i / 64] & (1_U64 << (i % 64)));
+		ANKI_TEST_EXPECT_EQ(batchInside, inside);
+	}
+
+	// Bits past the end should be zero
+	if(count % 64)
+	{
+		ANKI_TEST_EXPECT_EQ(mask[count / 64] >> (count % 64), 0);
+	}
+}
+
+ANKI_TEST(Collision, BatchCulling)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager jobManager(4);
+
+		// Sizes that exercise the SIMD remainders and the parallel split. 12 extra planes to test more planes than what a single pass can handle
+		const Array<U32, 6> counts = {0, 3, 64, 1001, 4099, 100003};
+		const Array<U32, 2> extraPlaneCounts = {0, 12};
+
+		for(U32 extraPlaneCount : extraPlaneCounts)
+		{
+			const std::vector<Plane> planes = createFrustumPlanes(extraPlaneCount);
+			const ConstWeakArray<Plane> planesArr(planes.data(), U32(planes.size()));
+
+			for(U32 count : counts)
+			{
+				const SoaShapes shapes = createRandomShapes(count, count + extraPlaneCount);
+				std::vector<U64> mask(getBatchCullingMaskWordCount(count) + 1, 0xDEADBEEF);
+				const WeakArray<U64> maskArr(mask.data(), U32(mask.size()));
+
+				testPlanes(planesArr, shapes.getAabbs(), maskArr);
+				validateMask<Aabb>(planes, count, mask, [&](U32 i) {
+					return shapes.getAabb(i);
+				});
+
+				testPlanes(planesArr, shapes.getSpheres(), maskArr);
+				validateMask<Sphere>(planes, count, mask, [&](U32 i) {
+					return shapes.getSphere(i);
+				});
+
+				testPlanes(planesArr, shapes.getAabbs(), maskArr, jobManager);
+				validateMask<Aabb>(planes, count, mask, [&](U32 i) {
+					return shapes.getAabb(i);
+				});
+
+				testPlanes(planesArr, shapes.getSpheres(), maskArr, jobManager);
+				validateMask<Sphere>(planes, count, mask, [&](U32 i) {
+					return shapes.getSphere(i);
+				});
+			}
+		}
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_BENCH(Collision, BatchCulling)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager jobManager(4);
+
+		constexpr U32 kCount = 64 * 1024;
+		const SoaShapes shapes = createRandomShapes(kCount, 123);
+		const std::vector<Plane> planes = createFrustumPlanes(0);
+		const ConstWeakArray<Plane> planesArr(planes.data(), U32(planes.size()));
+		std::vector<U64> mask(getBatchCullingMaskWordCount(kCount));
+		const WeakArray<U64> maskArr(mask.data(), U32(mask.size()));
+
+		std::vector<Aabb> aabbs;
+		std::vector<Sphere> spheres;
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			aabbs.push_back(shapes.getAabb(i));
+			spheres.push_back(shapes.getSphere(i));
+		}
+
+		auto scalarCull = [&](const auto& shapeArray) {
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				Bool inside = true;
+				for(const Plane& plane : planes)
+				{
+					if(testPlane(plane, shapeArray[i]) < 0.0f)
+					{
+						inside = false;
+						break;
+					}
+				}
+
+				if(inside)
+				{
+					mask[i / 64] |= 1_U64 << (i % 64);
+				}
+			}
+			benchmarkDoNotOptimize(mask[0]);
+		};
+
+		bench.run("Aabb/Scalar/64K", [&]() {
+			scalarCull(aabbs);
+		});
+
+		bench.run("Aabb/Batch/64K", [&]() {
+			testPlanes(planesArr, shapes.getAabbs(), maskArr);
+			benchmarkDoNotOptimize(mask[0]);
+		});
+
+		bench.run("Aabb/BatchParallel/64K", [&]() {
+			testPlanes(planesArr, shapes.getAabbs(), maskArr, jobManager);
+			benchmarkDoNotOptimize(mask[0]);
+		});
+
+		bench.run("Sphere/Scalar/64K", [&]() {
+			scalarCull(spheres);
+		});
+
+		bench.run("Sphere/Batch/64K", [&]() {
+			testPlanes(planesArr, shapes.getSpheres(), maskArr);
+			benchmarkDoNotOptimize(mask[0]);
+		});
+
+		bench.run("Sphere/BatchParallel/64K", [&]() {
+			testPlanes(planesArr, shapes.getSpheres(), maskArr, jobManager);
+			benchmarkDoNotOptimize(mask[0]);
+		});
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,404 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Collision.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <random>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+using namespace anki;
+
+namespace {
+
+class Object
+{
+public:
+	DynamicAabbTreeProxy m_proxy;
+	Aabb m_aabb;
+	Bool m_inTree = false;
+	U32 m_idx = 0;
+};
+
+class World
+{
+public:
+	std::vector<std::unique_ptr<Object>> m_objects;
+	std::mt19937 m_rng;
+
+	World(U32 count, U32 seed)
+		: m_rng(seed)
+	{
+		for(U32 i = 0; i < count; ++i)
+		{
+			m_objects.emplace_back(new Object());
+			m_objects.back()->m_idx = i;
+			m_objects.back()->m_proxy.m_userData = m_objects.back().get();
+			m_objects.back()->m_aabb = createRandomAabb();
+		}
+	}
+
+	Aabb createRandomAabb()
+	{
+		std::uniform_real_distribution<F32> posDist(-100.0f, 100.0f);
+		std::uniform_real_distribution<F32> sizeDist(0.1f, 5.0f);
+		const Vec3 center(posDist(m_rng), posDist(m_rng), posDist(m_rng));
+		const Vec3 extend(sizeDist(m_rng), sizeDist(m_rng), sizeDist(m_rng));
+		return Aabb(center - extend, center + extend);
+	}
+
+	/// Move a random subset of the objects. Small moves stay inside the fat AABBs, big ones don't.
+	void move(F32 ratio, F32 distance)
+	{
+		std::uniform_real_distribution<F32> dist(-distance, distance);
+		std::uniform_real_distribution<F32> select(0.0f, 1.0f);
+		for(auto& obj : m_objects)
+		{
+			if(select(m_rng) < ratio)
+			{
+				const Vec4 offset(dist(m_rng), dist(m_rng), dist(m_rng), 0.0f);
+				obj->m_aabb = Aabb(obj->m_aabb.getMin() + offset, obj->m_aabb.getMax() + offset);
+			}
+		}
+	}
+};
+
+} // end namespace
+
+static std::vector<Plane> createFrustumPlanes(F32 yaw)
+{
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(60.0f), toRad(45.0f), 0.1f, 80.0f);
+	const Mat4 view(Vec3(10.0f, 5.0f, -3.0f), Mat3(Euler(toRad(20.0f), yaw, 0.0f)), Vec3(1.0f));
+	Array<Plane, 6> frustumPlanes;
+	extractClipPlanes(proj * view.getInverse(), frustumPlanes);
+	return std::vector<Plane>(frustumPlanes.getBegin(), frustumPlanes.getEnd());
+}
+
+/// Returns the distance where the ray enters the AABB or -1 if it misses it.
+static F32 computeRayEnterDistance(const Aabb& aabb, const Ray& ray)
+{
+	F32 enter = 0.0f;
+	F32 exit = kMaxF32;
+	for(U32 c = 0; c < 3; ++c)
+	{
+		const F32 t0 = (aabb.getMin()[c] - ray.getOrigin()[c]) / ray.getDirection()[c];
+		const F32 t1 = (aabb.getMax()[c] - ray.getOrigin()[c]) / ray.getDirection()[c];
+		enter = max(enter, min(t0, t1));
+		exit = min(exit, max(t0, t1));
+	}
+	return (enter <= exit) ? enter : -1.0f;
+}
+
+static void validateQueries(const DynamicAabbTree& tree, World& world)
+{
+	std::uniform_real_distribution<F32> posDist(-100.0f, 100.0f);
+	std::uniform_real_distribution<F32> radiusDist(1.0f, 30.0f);
+
+	// 70 queries to test more than a single pass
+	constexpr U32 kQueryCount = 70;
+	std::vector<Aabb> aabbs;
+	std::vector<Sphere> spheres;
+	std::vector<Ray> rays;
+	std::vector<std::vector<Plane>> frustumPlanes;
+	std::vector<ConstWeakArray<Plane>> frustums;
+	for(U32 i = 0; i < kQueryCount; ++i)
+	{
+		aabbs.push_back(world.createRandomAabb());
+		aabbs.back() = Aabb(aabbs.back().getMin() - Vec4(10.0f, 10.0f, 10.0f, 0.0f), aabbs.back().getMax() + Vec4(10.0f, 10.0f, 10.0f, 0.0f));
+		spheres.push_back(Sphere(Vec3(posDist(world.m_rng), posDist(world.m_rng), posDist(world.m_rng)), radiusDist(world.m_rng)));
+		rays.push_back(Ray(Vec3(posDist(world.m_rng), posDist(world.m_rng), posDist(world.m_rng)),
+						   Vec3(posDist(world.m_rng), posDist(world.m_rng), posDist(world.m_rng)).getNormalized()));
+		frustumPlanes.push_back(createFrustumPlanes(F32(i) * 0.3f));
+	}
+
+	for(const std::vector<Plane>& planes : frustumPlanes)
+	{
+		frustums.push_back(ConstWeakArray<Plane>(planes.data(), U32(planes.size())));
+	}
+
+	const U32 objCount = U32(world.m_objects.size());
+	std::vector<U8> results(kQueryCount * objCount);
+
+	auto check = [&](auto testFunc) {
+		for(U32 q = 0; q < kQueryCount; ++q)
+		{
+			for(U32 o = 0; o < objCount; ++o)
+			{
+				const Object& obj = *world.m_objects[o];
+				const Bool expected = obj.m_inTree && testFunc(q, obj.m_aabb);
+				ANKI_TEST_EXPECT_EQ(U32(results[q * objCount + o]), U32(expected));
+			}
+		}
+		std::fill(results.begin(), results.end(), U8(0));
+	};
+
+	auto visit = [&](U32 queryIdx, void* userData) {
+		U8& result = results[queryIdx * objCount + static_cast<Object*>(userData)->m_idx];
+		ANKI_TEST_EXPECT_EQ(result, 0);
+		result = 1;
+	};
+
+	tree.queryAabbs(ConstWeakArray<Aabb>(aabbs.data(), kQueryCount), visit);
+	check([&](U32 q, const Aabb& aabb) {
+		return testCollision(aabbs[q], aabb);
+	});
+
+	tree.querySpheres(ConstWeakArray<Sphere>(spheres.data(), kQueryCount), visit);
+	check([&](U32 q, const Aabb& aabb) {
+		return testCollision(spheres[q], aabb);
+	});
+
+	tree.queryFrustums(ConstWeakArray<ConstWeakArray<Plane>>(frustums.data(), kQueryCount), visit);
+	check([&](U32 q, const Aabb& aabb) {
+		for(const Plane& plane : frustumPlanes[q])
+		{
+			if(testPlane(plane, aabb) < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	});
+
+	tree.queryRays(ConstWeakArray<Ray>(rays.data(), kQueryCount), kMaxF32, [&](U32 queryIdx, void* userData, [[maybe_unused]] F32 distance) {
+		visit(queryIdx, userData);
+		return kMaxF32;
+	});
+	check([&](U32 q, const Aabb& aabb) {
+		return computeRayEnterDistance(aabb, rays[q]) >= 0.0f;
+	});
+
+	// The single versions
+	U32 count = 0;
+	tree.queryAabb(aabbs[0], [&]([[maybe_unused]] void* userData) {
+		++count;
+	});
+	U32 expectedCount = 0;
+	for(const auto& obj : world.m_objects)
+	{
+		expectedCount += obj->m_inTree && testCollision(aabbs[0], obj->m_aabb);
+	}
+	ANKI_TEST_EXPECT_EQ(count, expectedCount);
+
+	// Closest hit. Shrink the ray every time
+	F32 closest = kMaxF32;
+	tree.queryRay(rays[0], kMaxF32, [&]([[maybe_unused]] void* userData, F32 distance) {
+		closest = min(closest, distance);
+		return distance;
+	});
+	F32 expectedClosest = kMaxF32;
+	for(const auto& obj : world.m_objects)
+	{
+		const F32 enter = computeRayEnterDistance(obj->m_aabb, rays[0]);
+		if(obj->m_inTree && enter >= 0.0f)
+		{
+			expectedClosest = min(expectedClosest, enter);
+		}
+	}
+	ANKI_TEST_EXPECT_NEAR(closest, expectedClosest, 0.001f);
+}
+
+ANKI_TEST(Collision, DynamicAabbTree)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		// Enough objects to refit in parallel
+		constexpr U32 kCount = 10000;
+		ThreadJobManager jobManager(4);
+		World world(kCount, 42);
+
+		DynamicAabbTree tree(&DefaultMemoryPool::getSingleton(), 0.5f);
+		ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+
+		// Nothing happens before the update
+		for(auto& obj : world.m_objects)
+		{
+			tree.updateProxy(obj->m_proxy, obj->m_aabb);
+			obj->m_inTree = true;
+		}
+		ANKI_TEST_EXPECT_EQ(tree.getProxyCount(), 0);
+
+		tree.update(&jobManager);
+		ANKI_TEST_EXPECT_EQ(tree.getProxyCount(), kCount);
+		ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+		ANKI_TEST_EXPECT_LT(tree.getHeight(), 40);
+		validateQueries(tree, world);
+
+		// Small moves that stay inside the fat AABBs and big moves that get re-inserted
+		for(F32 distance : {0.2f, 20.0f})
+		{
+			world.move(0.5f, distance);
+			for(auto& obj : world.m_objects)
+			{
+				tree.updateProxy(obj->m_proxy, obj->m_aabb);
+			}
+
+			tree.update(&jobManager);
+			ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+			validateQueries(tree, world);
+		}
+
+		// Force the refit path, in parallel and serially
+		tree.setMaxReinsertsPerUpdate(10);
+		for(ThreadJobManager* manager : {&jobManager, static_cast<ThreadJobManager*>(nullptr)})
+		{
+			world.move(1.0f, 20.0f);
+			for(auto& obj : world.m_objects)
+			{
+				tree.updateProxy(obj->m_proxy, obj->m_aabb);
+			}
+
+			tree.update(manager);
+			ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+			validateQueries(tree, world);
+		}
+
+		// Remove some, including some that are pending
+		for(U32 i = 0; i < kCount; i += 3)
+		{
+			Object& obj = *world.m_objects[i];
+			if(i % 2)
+			{
+				tree.updateProxy(obj.m_proxy, obj.m_aabb);
+			}
+			tree.removeProxy(obj.m_proxy);
+			obj.m_inTree = false;
+		}
+		tree.update();
+		ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+		validateQueries(tree, world);
+
+		// Destroying proxies removes them
+		const U32 countBefore = tree.getProxyCount();
+		world.m_objects[1].reset();
+		world.m_objects[1].reset(new Object());
+		world.m_objects[1]->m_idx = 1;
+		world.m_objects[1]->m_proxy.m_userData = world.m_objects[1].get();
+		world.m_objects[1]->m_aabb = world.createRandomAabb();
+		ANKI_TEST_EXPECT_EQ(tree.getProxyCount(), countBefore - 1);
+		ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+
+		// Remove everything
+		for(auto& obj : world.m_objects)
+		{
+			if(obj->m_inTree)
+			{
+				tree.removeProxy(obj->m_proxy);
+				obj->m_inTree = false;
+			}
+		}
+		ANKI_TEST_EXPECT_EQ(tree.getProxyCount(), 0);
+		ANKI_TEST_EXPECT_EQ(tree.getHeight(), 0);
+		ANKI_TEST_EXPECT_EQ(tree.isValid(), true);
+
+		// Re-add some and let the tree die first
+		for(U32 i = 0; i < 100; ++i)
+		{
+			tree.updateProxy(world.m_objects[i]->m_proxy, world.m_objects[i]->m_aabb);
+		}
+		tree.update();
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_BENCH(Collision, DynamicAabbTree)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager jobManager(4);
+
+		constexpr U32 kCount = 100 * 1000;
+		World world(kCount, 123);
+
+		DynamicAabbTree tree(&DefaultMemoryPool::getSingleton());
+		for(auto& obj : world.m_objects)
+		{
+			tree.updateProxy(obj->m_proxy, obj->m_aabb);
+		}
+		tree.update(&jobManager);
+
+		ANKI_TEST_LOGI("%u proxies, height %u, SAH cost %f", tree.getProxyCount(), tree.getHeight(), tree.computeSahCost());
+
+		// Move a quarter of the objects every frame. Half of the moves escape the fat AABBs
+		auto moveAll = [&]() {
+			world.move(0.125f, 0.05f);
+			world.move(0.125f, 1.0f);
+			for(auto& obj : world.m_objects)
+			{
+				tree.updateProxy(obj->m_proxy, obj->m_aabb);
+			}
+		};
+
+		bench.run("Update/Serial/100K", [&]() {
+			moveAll();
+			tree.update();
+		});
+
+		bench.run("Update/Parallel/100K", [&]() {
+			moveAll();
+			tree.update(&jobManager);
+		});
+
+		ANKI_TEST_LOGI("After the updates: height %u, SAH cost %f", tree.getHeight(), tree.computeSahCost());
+
+		const std::vector<Plane> planes = createFrustumPlanes(0.0f);
+		const ConstWeakArray<Plane> planesArr(planes.data(), U32(planes.size()));
+
+		bench.run("QueryFrustum/Tree/100K", [&]() {
+			U32 count = 0;
+			tree.queryFrustum(planesArr, [&]([[maybe_unused]] void* userData) {
+				++count;
+			});
+			benchmarkDoNotOptimize(count);
+		});
+
+		bench.run("QueryFrustum/BruteForce/100K", [&]() {
+			U32 count = 0;
+			for(const auto& obj : world.m_objects)
+			{
+				Bool inside = true;
+				for(const Plane& plane : planes)
+				{
+					inside = inside && testPlane(plane, obj->m_aabb) >= 0.0f;
+				}
+				count += inside;
+			}
+			benchmarkDoNotOptimize(count);
+		});
+
+		std::vector<Sphere> spheres;
+		for(U32 i = 0; i < 64; ++i)
+		{
+			spheres.push_back(Sphere(world.createRandomAabb().getMin().xyz(), 10.0f));
+		}
+
+		bench.run("QuerySpheres/Batched/64", [&]() {
+			U32 count = 0;
+			tree.querySpheres(ConstWeakArray<Sphere>(spheres.data(), U32(spheres.size())),
+							  [&]([[maybe_unused]] U32 queryIdx, [[maybe_unused]] void* userData) {
+								  ++count;
+							  });
+			benchmarkDoNotOptimize(count);
+		});
+
+		bench.run("QuerySpheres/OneByOne/64", [&]() {
+			U32 count = 0;
+			for(const Sphere& sphere : spheres)
+			{
+				tree.querySphere(sphere, [&]([[maybe_unused]] void* userData) {
+					++count;
+				});
+			}
+			benchmarkDoNotOptimize(count);
+		});
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -5,8 +5,10 @@
 
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/System.h>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include <malloc.h>
 #if ANKI_OS_ANDROID
 #	include <android/log.h>
@@ -41,7 +43,16 @@ void Test::run()
 	struct mallinfo a = mallinfo();
 #endif
 
-	callback(*this);
+	if(benchmarkCallback)
+	{
+		Benchmark bench;
+		bench.test = this;
+		benchmarkCallback(bench);
+	}
+	else
+	{
+		callback(*this);
+	}
 
 #if ANKI_OS_LINUX
 	struct mallinfo b = mallinfo();
@@ -58,7 +69,59 @@ void Test::run()
 #endif
 }
 
-void Tester::addTest(const char* name, const char* suiteName, TestCallback callback)
+void Benchmark::pinThread(Bool pin)
+{
+	// Restore the affinity to all cores when done because the threads that the benchmarks spawn inherit it
+	const U32 coreCount = getCpuCoresCount();
+	ThreadCoreAffinityMask mask(false);
+	if(pin)
+	{
+		const I32 core = getTesterSingleton().benchmarkCore;
+		mask.set((core >= 0) ? min(U32(core), coreCount - 1) : coreCount - 1);
+	}
+	else
+	{
+		for(U32 i = 0; i < coreCount; ++i)
+		{
+			mask.set(i);
+		}
+	}
+
+	Thread::pinCurrentThreadToCores(mask);
+}
+
+void Benchmark::storeResult(const char* label, U64 iterationsPerSample, std::vector<Second>& samples)
+{
+	ANKI_ASSERT(samples.size() > 0);
+	std::sort(samples.begin(), samples.end());
+
+	const F64 toNs = 1000.0 * 1000.0 * 1000.0 / F64(iterationsPerSample);
+	const PtrSize count = samples.size();
+
+	BenchmarkResult result;
+	result.suite = test->suite->name;
+	result.name = test->name;
+	result.label = label;
+	result.iterationsPerSample = iterationsPerSample;
+	result.sampleCount = U32(count);
+	result.min = samples[0] * toNs;
+	result.median = ((count % 2) ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0) * toNs;
+	result.p99 = samples[min<PtrSize>(count - 1, PtrSize(F64(count) * 0.99))] * toNs;
+
+	F64 sum = 0.0;
+	for(Second s : samples)
+	{
+		sum += s;
+	}
+	result.mean = sum / F64(count) * toNs;
+
+	ANKI_TEST_LOG("%-32s min %12.2fns  median %12.2fns  p99 %12.2fns  (%llu iterations x %u samples)", label, result.min, result.median, result.p99,
+				  (unsigned long long)(iterationsPerSample), result.sampleCount);
+
+	getTesterSingleton().benchmarkResults.push_back(result);
+}
+
+void Tester::addTest(const char* name, const char* suiteName, TestCallback callback, BenchmarkCallback benchmarkCallback)
 {
 	std::vector<TestSuite*>::iterator it;
 	for(it = suites.begin(); it != suites.end(); it++)
@@ -99,6 +162,7 @@ void Tester::addTest(const char* name, const char* suiteName, TestCallback callb
 	test->name = name;
 	test->suite = suite;
 	test->callback = callback;
+	test->benchmarkCallback = benchmarkCallback;
 }
 
 int Tester::run(int argc, char** argv)
@@ -112,10 +176,15 @@ Options:
   --help         Print this message
   --list-tests   List all the tests
   --suite <name> Run tests only from this suite
-  --test <name>  Run this test. --suite needs to be specified)";
+  --test <name>  Run this test. --suite needs to be specified
+  --benchmarks   Run all the benchmarks. They don't run by default
+  --bench-samples <count>  The number of samples per benchmark. Default 30
+  --bench-core <index>     The core to pin the benchmarks to. Default is the last core
+  --bench-json <file>      Write the results of the benchmarks to a JSON file)";
 
 	std::string suiteName;
 	std::string testName;
+	Bool runBenchmarks = false;
 
 	for(int i = 1; i < argc; i++)
 	{
@@ -150,6 +219,32 @@ Options:
 			}
 			testName = argv[i];
 		}
+		else if(strcmp(arg, "--benchmarks") == 0)
+		{
+			runBenchmarks = true;
+		}
+		else if(strcmp(arg, "--bench-samples") == 0 || strcmp(arg, "--bench-core") == 0 || strcmp(arg, "--bench-json") == 0)
+		{
+			++i;
+			if(i >= argc)
+			{
+				ANKI_TEST_LOG("Value is missing after %s", arg);
+				return 1;
+			}
+
+			if(strcmp(arg, "--bench-samples") == 0)
+			{
+				benchmarkSampleCount = max(1, atoi(argv[i]));
+			}
+			else if(strcmp(arg, "--bench-core") == 0)
+			{
+				benchmarkCore = atoi(argv[i]);
+			}
+			else
+			{
+				benchmarkJsonFilename = argv[i];
+			}
+		}
 	}
 
 	// Sanity check
@@ -163,16 +258,19 @@ Options:
 	//
 	int passed = 0;
 	int run = 0;
-	if(argc == 1)
+	if(suiteName.length() == 0)
 	{
-		// Run all
+		// Run all tests or all benchmarks
 		for(TestSuite* suite : suites)
 		{
 			for(Test* test : suite->tests)
 			{
-				++run;
-				test->run();
-				++passed;
+				if((test->benchmarkCallback != nullptr) == runBenchmarks)
+				{
+					++run;
+					test->run();
+					++passed;
+				}
 			}
 		}
 	}
@@ -195,6 +293,11 @@ Options:
 		}
 	}
 
+	if(benchmarkJsonFilename.length() > 0 && !writeBenchmarkResults())
+	{
+		return 1;
+	}
+
 	int failed = run - passed;
 	ANKI_TEST_LOG("========\nRun %d tests, failed %d", run, failed);
 
@@ -210,13 +313,39 @@ Options:
 	return run - passed;
 }
 
+Bool Tester::writeBenchmarkResults() const
+{
+	FILE* file = fopen(benchmarkJsonFilename.c_str(), "w");
+	if(!file)
+	{
+		ANKI_TEST_LOG("Can't open file: %s", benchmarkJsonFilename.c_str());
+		return false;
+	}
+
+	fprintf(file, "{\n\t\"benchmarks\": [\n");
+	for(PtrSize i = 0; i < benchmarkResults.size(); ++i)
+	{
+		const BenchmarkResult& r = benchmarkResults[i];
+		fprintf(file,
+				"\t\t{\"suite\": \"%s\", \"name\": \"%s\", \"label\": \"%s\", \"iterations_per_sample\": %llu, \"samples\": %u, \"min_ns\": %f, "
+				"\"median_ns\": %f, \"p99_ns\": %f, \"mean_ns\": %f}%s\n",
+				r.suite.c_str(), r.name.c_str(), r.label.c_str(), (unsigned long long)(r.iterationsPerSample), r.sampleCount, r.min, r.median, r.p99,
+				r.mean, (i + 1 < benchmarkResults.size()) ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+
+	fclose(file);
+	return true;
+}
+
 int Tester::listTests()
 {
 	for(TestSuite* suite : suites)
 	{
 		for(Test* test : suite->tests)
 		{
-			ANKI_TEST_LOG("%s --suite %s --test %s", programName.c_str(), suite->name.c_str(), test->name.c_str());
+			ANKI_TEST_LOG("%s --suite %s --test %s%s", programName.c_str(), suite->name.c_str(), test->name.c_str(),
+						  (test->benchmarkCallback) ? " (benchmark)" : "");
 		}
 	}
 
@@ -8,6 +8,7 @@
 #include <AnKi/Util/Singleton.h>
 #include <AnKi/Math.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Core.h>
 #include <AnKi/Window.h>
 #include <AnKi/Gr.h>
@@ -24,6 +25,7 @@ namespace anki {
 class TestSuite;
 class Test;
 class Tester;
+class Benchmark;
 
 #define ANKI_TEST_LOGI(...) ANKI_LOG("TEST", kNormal, __VA_ARGS__)
 #define ANKI_TEST_LOGE(...) ANKI_LOG("TEST", kError, __VA_ARGS__)
@@ -33,6 +35,9 @@ class Tester;
 /// The actual test
 using TestCallback = void (*)(Test&);
 
+/// The actual benchmark
+using BenchmarkCallback = void (*)(Benchmark&);
+
 /// Test suite
 class TestSuite
 {
@@ -50,10 +55,26 @@ public:
 	std::string name;
 	TestSuite* suite = nullptr;
 	TestCallback callback = nullptr;
+	BenchmarkCallback benchmarkCallback = nullptr; ///< If it's not null it's a benchmark.
 
 	void run();
 };
 
+/// The timings of a Benchmark::run. In nanoseconds per iteration.
+class BenchmarkResult
+{
+public:
+	std::string suite;
+	std::string name;
+	std::string label;
+	U64 iterationsPerSample = 0;
+	U32 sampleCount = 0;
+	F64 min = 0.0;
+	F64 median = 0.0;
+	F64 p99 = 0.0;
+	F64 mean = 0.0;
+};
+
 /// A container of test suites
 class Tester
 {
@@ -61,7 +82,15 @@ public:
 	std::vector<TestSuite*> suites;
 	std::string programName;
 
-	void addTest(const char* name, const char* suite, TestCallback callback);
+	// Benchmark options
+	U32 benchmarkSampleCount = 30;
+	Second benchmarkMinSampleTime = 2.0 / 1000.0;
+	Second benchmarkWarmupTime = 50.0 / 1000.0;
+	I32 benchmarkCore = -1; ///< The core to pin the benchmarks to. -1 is the last core.
+	std::string benchmarkJsonFilename;
+	std::vector<BenchmarkResult> benchmarkResults;
+
+	void addTest(const char* name, const char* suite, TestCallback callback, BenchmarkCallback benchmarkCallback = nullptr);
 
 	int run(int argc, char** argv);
 
@@ -74,11 +103,82 @@ public:
 			delete s;
 		}
 	}
+
+private:
+	Bool writeBenchmarkResults() const;
 };
 
 /// Singleton so we can do the ANKI_TEST trick
 extern Tester& getTesterSingleton();
 
+/// Runs a piece of code many times and gathers statistics. It's passed to the ANKI_BENCH functions.
+class Benchmark
+{
+public:
+	Test* test = nullptr;
+
+	/// Measure a function. It first finds an iteration count that takes more than Tester::benchmarkMinSampleTime, warms up and then takes
+	/// Tester::benchmarkSampleCount samples. The thread is pinned to a single core while it runs. Can be called multiple times per benchmark.
+	/// @param label A name for this measurement.
+	/// @param func The function to measure. Called with no arguments. Use benchmarkDoNotOptimize() for its results.
+	template<typename TFunc>
+	void run(const char* label, TFunc func)
+	{
+		auto runSample = [&](U64 iterations) -> Second {
+			const Second begin = HighRezTimer::getCurrentTime();
+			for(U64 i = 0; i < iterations; ++i)
+			{
+				func();
+			}
+			return HighRezTimer::getCurrentTime() - begin;
+		};
+
+		const Tester& tester = getTesterSingleton();
+		pinThread(true);
+
+		// Calibrate
+		U64 iterations = 1;
+		Second sampleTime;
+		while((sampleTime = runSample(iterations)) < tester.benchmarkMinSampleTime)
+		{
+			iterations *= (sampleTime > tester.benchmarkMinSampleTime / 100.0) ? 2 : 10;
+		}
+
+		// Warm up
+		for(Second warmupTime = sampleTime; warmupTime < tester.benchmarkWarmupTime;)
+		{
+			warmupTime += runSample(iterations);
+		}
+
+		// Measure
+		std::vector<Second> samples(tester.benchmarkSampleCount);
+		for(Second& sample : samples)
+		{
+			sample = runSample(iterations);
+		}
+
+		pinThread(false);
+		storeResult(label, iterations, samples);
+	}
+
+private:
+	void pinThread(Bool pin);
+
+	void storeResult(const char* label, U64 iterationsPerSample, std::vector<Second>& samples);
+};
+
+/// Prevent the compiler from optimizing away a value that a benchmark computed.
+template<typename T>
+inline void benchmarkDoNotOptimize(const T& value)
+{
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	const volatile T* ptr = &value;
+	(void)ptr;
+#endif
+}
+
 /// Delete the instance to make valgrind a bit happy
 extern void deleteTesterSingleton();
 
@@ -98,6 +198,20 @@ extern void deleteTesterSingleton();
 	static Foo##suiteName_##name_ yada##suiteName_##name_; \
 	void test_##suiteName_##name_(Test&)
 
+/// Create a new benchmark. It's a test that gets a Benchmark. It doesn't run with the rest of the tests, see the --benchmarks option.
+#define ANKI_BENCH(suiteName_, name_) \
+	using namespace anki; \
+	void bench_##suiteName_##name_(Benchmark&); \
+	struct BenchFoo##suiteName_##name_ \
+	{ \
+		BenchFoo##suiteName_##name_() \
+		{ \
+			getTesterSingleton().addTest(#name_, #suiteName_, nullptr, bench_##suiteName_##name_); \
+		} \
+	}; \
+	static BenchFoo##suiteName_##name_ benchYada##suiteName_##name_; \
+	void bench_##suiteName_##name_([[maybe_unused]] Benchmark& bench)
+
 /// Intermediate macro
 #define ANKI_TEST_EXPECT_EQ_IMPL(file_, line_, func_, x, y) \
 	do \
@@ -19,7 +19,7 @@ inline ShaderPtr createShader(CString src, ShaderType type)
 	ShaderCompilerDynamicArray<U8> bin;
 	ShaderCompilerString errorLog;
 
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 	const Error err = compileHlslToSpirv(header, type, false, bin, errorLog);
 #else
 	const Error err = compileHlslToDxil(header, type, false, bin, errorLog);
@@ -32,7 +32,7 @@ inline ShaderPtr createShader(CString src, ShaderType type)
 
 	ShaderReflection refl;
 	ShaderCompilerString errorStr;
-#if ANKI_GR_BACKEND_VULKAN
+#if ANKI_GR_BACKEND_VULKAN || ANKI_GR_BACKEND_NULL
 	ANKI_TEST_EXPECT_NO_ERR(doReflectionSpirv(WeakArray(bin.getBegin(), bin.getSize()), type, refl, errorStr));
 #else
 	ANKI_TEST_EXPECT_NO_ERR(doReflectionDxil(bin, type, refl, errorStr));
@@ -0,0 +1,391 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Config.h>
+
+#if ANKI_GR_BACKEND_NULL
+
+#	include <Tests/Framework/Framework.h>
+#	include <AnKi/Gr.h>
+#	include <AnKi/Gr/Null/NullCommandStream.h>
+#	include <AnKi/Gr/Null/NullGrManager.h>
+#	include <AnKi/Gr/RenderGraph.h>
+#	include <AnKi/Core/Common.h>
+#	include <AnKi/Util/HighRezTimer.h>
+#	include <AnKi/Window/NativeWindow.h>
+#	include <AnKi/Window/Input.h>
+#	include <AnKi/Util/Filesystem.h>
+
+using namespace anki;
+
+ANKI_TEST(Gr, NullCommandStream)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	GrMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		NullCommandStream stream;
+
+		NullCmdPushDebugMarker marker = {};
+		marker.m_nameLength = 4;
+		stream.pushCommand(NullCommandType::kPushDebugMarker, marker, "Test", 4);
+
+		NullCmdDispatch dispatch;
+		dispatch.m_groupCount = {1, 2, 3};
+		stream.pushCommand(NullCommandType::kDispatchCompute, dispatch);
+
+		stream.pushCommand(NullCommandType::kPopDebugMarker, NullCmdEmpty());
+
+		ANKI_TEST_EXPECT_EQ(stream.getCommandCount(), 3);
+
+		String tmpDir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(tmpDir));
+		String fname;
+		fname.sprintf("%s/NullCommandStream.txt", tmpDir.cstr());
+
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(stream.dump(file));
+		}
+
+		String txt;
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::kRead));
+			ANKI_TEST_EXPECT_NO_ERR(file.readAllText(txt));
+		}
+
+		ANKI_TEST_EXPECT_EQ(txt, "  PushDebugMarker \"Test\"\n    DispatchCompute groups:1,2,3\n  PopDebugMarker\n");
+
+		// Reset keeps the memory
+		stream.reset();
+		ANKI_TEST_EXPECT_EQ(stream.getCommandCount(), 0);
+		ANKI_TEST_EXPECT_EQ(stream.getSizeInBytes(), 0);
+	}
+
+	GrMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Gr, NullSubmit)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	initWindow();
+	ANKI_TEST_EXPECT_NO_ERR(Input::allocateSingleton().init());
+	initGrManager();
+
+	{
+		BufferInitInfo buffInit("Test");
+		buffInit.m_size = 1_KB;
+		buffInit.m_usage = BufferUsageBit::kTransferDestination;
+		buffInit.m_mapAccess = BufferMapAccessBit::kRead;
+		BufferPtr buff = GrManager::getSingleton().newBuffer(buffInit);
+
+		CommandBufferInitInfo cmdbInit;
+		cmdbInit.m_flags |= CommandBufferFlag::kSmallBatch;
+		CommandBufferPtr cmdb = GrManager::getSingleton().newCommandBuffer(cmdbInit);
+
+		cmdb->fillBuffer(BufferView(buff.get()), 0xFF);
+		cmdb->endRecording();
+
+		FencePtr fence;
+		GrManager::getSingleton().submit(cmdb.get(), {}, &fence);
+		ANKI_TEST_EXPECT_EQ(fence->clientWait(kMaxSecond), true);
+	}
+
+	GrManager::freeSingleton();
+	Input::freeSingleton();
+	NativeWindow::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Gr, NullObjectLifetime)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	initWindow();
+	ANKI_TEST_EXPECT_NO_ERR(Input::allocateSingleton().init());
+	initGrManager();
+
+	{
+		GrManagerImpl& gr = static_cast<GrManagerImpl&>(GrManager::getSingleton());
+
+		// Never used by the GPU so it's deleted right away
+		{
+			SamplerPtr sampler = gr.newSampler(SamplerInitInfo("Unused"));
+			ANKI_TEST_EXPECT_EQ(sampler->getLastUsedFrame(), 0);
+		}
+		ANKI_TEST_EXPECT_EQ(gr.getObjectGarbageCount(), 0);
+
+		// Used in this frame so it waits for the frame to end
+		SamplerPtr sampler = gr.newSampler(SamplerInitInfo("Used"));
+
+		CommandBufferInitInfo cmdbInit;
+		cmdbInit.m_flags |= CommandBufferFlag::kSmallBatch;
+		CommandBufferPtr cmdb = gr.newCommandBuffer(cmdbInit);
+		cmdb->bindSampler(ANKI_REG(s0), sampler.get());
+		cmdb->bindSampler(ANKI_REG(s1), sampler.get());
+		ANKI_TEST_EXPECT_EQ(sampler->getLastUsedFrame(), gr.getFrameEpoch());
+
+		sampler.reset(nullptr);
+		ANKI_TEST_EXPECT_EQ(gr.getObjectGarbageCount(), 1);
+
+		cmdb->endRecording();
+		gr.submit(cmdb.get());
+		cmdb.reset(nullptr);
+		ANKI_TEST_EXPECT_EQ(gr.getObjectGarbageCount(), 1);
+
+		gr.swapBuffers();
+		ANKI_TEST_EXPECT_EQ(gr.getObjectGarbageCount(), 0);
+
+		// Objects of old frames are deleted right away
+		sampler = gr.newSampler(SamplerInitInfo("Old"));
+		cmdb = gr.newCommandBuffer(cmdbInit);
+		cmdb->bindSampler(ANKI_REG(s0), sampler.get());
+		cmdb->endRecording();
+		gr.submit(cmdb.get());
+		cmdb.reset(nullptr);
+		gr.swapBuffers();
+		sampler.reset(nullptr);
+		ANKI_TEST_EXPECT_EQ(gr.getObjectGarbageCount(), 0);
+	}
+
+	GrManager::freeSingleton();
+	Input::freeSingleton();
+	NativeWindow::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+/// Build a synthetic graph that looks a bit like a frame: graphics passes that write render targets and compute passes that read and write
+/// render targets and buffers.
+static void populateSyntheticRenderGraph(RenderGraphBuilder& descr, U32 passCount, Texture& importedTex, ConstWeakArray<BufferPtr> buffers)
+{
+	constexpr U32 kRtCount = 16;
+	Array<RenderTargetHandle, kRtCount> rts;
+	for(U32 i = 0; i < kRtCount; ++i)
+	{
+		String name;
+		name.sprintf("RT%u", i);
+		RenderTargetDesc rtDesc(name);
+		rtDesc.m_width = rtDesc.m_height = 64;
+		rtDesc.m_format = Format::kR8G8B8A8_Unorm;
+		rtDesc.bake();
+		rts[i] = descr.newRenderTarget(rtDesc);
+	}
+
+	const RenderTargetHandle importedRt = descr.importRenderTarget(&importedTex, TextureUsageBit::kSampledFragment);
+
+	DynamicArray<BufferHandle> buffHandles;
+	for(const BufferPtr& buff : buffers)
+	{
+		buffHandles.emplaceBack(descr.importBuffer(BufferView(buff.get()), BufferUsageBit::kStorageComputeRead));
+	}
+
+	for(U32 i = 0; i < passCount - 1; ++i)
+	{
+		String name;
+		name.sprintf("Pass%u", i);
+
+		switch(i % 4)
+		{
+		case 0:
+		{
+			GraphicsRenderPass& pass = descr.newGraphicsRenderPass(name);
+			const RenderTargetHandle colorRt = rts[(i / 4) % kRtCount];
+			pass.setRenderpassInfo({GraphicsRenderPassTargetDesc(colorRt)});
+			pass.newTextureDependency(colorRt, TextureUsageBit::kFramebufferWrite);
+			pass.newTextureDependency(rts[(i / 4 + 7) % kRtCount], TextureUsageBit::kSampledFragment);
+			pass.setWork([](RenderPassWorkContext&) {});
+			break;
+		}
+		case 1:
+		{
+			NonGraphicsRenderPass& pass = descr.newNonGraphicsRenderPass(name);
+			pass.newBufferDependency(buffHandles[i % buffHandles.getSize()], BufferUsageBit::kStorageComputeRead);
+			pass.newBufferDependency(buffHandles[(i + 1) % buffHandles.getSize()], BufferUsageBit::kStorageComputeWrite);
+			pass.newTextureDependency(rts[i % kRtCount], TextureUsageBit::kSampledCompute);
+			pass.setWork([](RenderPassWorkContext&) {});
+			break;
+		}
+		case 2:
+		{
+			NonGraphicsRenderPass& pass = descr.newNonGraphicsRenderPass(name);
+			pass.newTextureDependency(rts[i % kRtCount], TextureUsageBit::kStorageComputeWrite);
+			pass.setWork([](RenderPassWorkContext&) {});
+			break;
+		}
+		default:
+		{
+			NonGraphicsRenderPass& pass = descr.newNonGraphicsRenderPass(name);
+			pass.newTextureDependency(importedRt, TextureUsageBit::kSampledCompute);
+			pass.newBufferDependency(buffHandles[i % buffHandles.getSize()], BufferUsageBit::kStorageComputeRead);
+			pass.setWork([](RenderPassWorkContext&) {});
+		}
+		}
+	}
+
+	// Last pass writes the imported RT
+	GraphicsRenderPass& pass = descr.newGraphicsRenderPass("Final");
+	pass.setRenderpassInfo({GraphicsRenderPassTargetDesc(importedRt)});
+	pass.newTextureDependency(importedRt, TextureUsageBit::kFramebufferWrite);
+	pass.newTextureDependency(rts[0], TextureUsageBit::kSampledFragment);
+	pass.setWork([](RenderPassWorkContext&) {});
+}
+
+class SyntheticRenderGraphResources
+{
+public:
+	TexturePtr m_importedTex;
+	Array<BufferPtr, 8> m_buffers;
+
+	SyntheticRenderGraphResources()
+	{
+		TextureInitInfo texInit("Imported");
+		texInit.m_width = texInit.m_height = 64;
+		texInit.m_format = Format::kR8G8B8A8_Unorm;
+		texInit.m_usage = TextureUsageBit::kAllSampled | TextureUsageBit::kFramebufferWrite;
+		m_importedTex = GrManager::getSingleton().newTexture(texInit);
+
+		for(BufferPtr& buff : m_buffers)
+		{
+			buff = GrManager::getSingleton().newBuffer(BufferInitInfo(1_KB, BufferUsageBit::kAllStorage, BufferMapAccessBit::kNone, "Synthetic"));
+		}
+	}
+};
+
+ANKI_TEST(Gr, NullRenderGraphCompileCache)
+{
+	constexpr U32 kPassCount = 300;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	String dumpFname;
+	ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(dumpFname));
+	dumpFname += "/NullRenderGraphCompileCache.txt";
+	g_nullCommandDumpCVar.set(dumpFname);
+
+	initWindow();
+	ANKI_TEST_EXPECT_NO_ERR(Input::allocateSingleton().init());
+	initGrManager();
+	CoreThreadJobManager::allocateSingleton(4);
+
+	{
+		SyntheticRenderGraphResources rsrc;
+		RenderGraphPtr rgraph = GrManager::getSingleton().newRenderGraph();
+
+		auto runFrame = [&](U32 passCount, Bool useCache) {
+			g_renderGraphCompileCacheCVar.set(useCache);
+
+			StackMemoryPool pool(allocAligned, nullptr, 2_MB);
+			RenderGraphBuilder descr(&pool);
+			populateSyntheticRenderGraph(descr, passCount, *rsrc.m_importedTex, rsrc.m_buffers);
+
+			rgraph->compileNewGraph(descr, pool);
+			rgraph->recordAndSubmitCommandBuffers();
+			rgraph->reset();
+
+			GrManager::getSingleton().swapBuffers();
+		};
+
+		runFrame(kPassCount, true); // Full compilation
+		runFrame(kPassCount, true); // Should re-use the previous
+		runFrame(kPassCount, false); // Full compilation without the cache
+		runFrame(kPassCount + 1, true); // Topology changed, full compilation
+		runFrame(kPassCount, true); // Topology changed again
+	}
+
+	CoreThreadJobManager::freeSingleton();
+	GrManager::freeSingleton();
+	Input::freeSingleton();
+	NativeWindow::freeSingleton();
+	g_nullCommandDumpCVar.set("");
+	g_renderGraphCompileCacheCVar.set(true);
+
+	// All frames with the same graph should have recorded the same commands
+	{
+		String txt;
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(dumpFname, FileOpenFlag::kRead));
+		ANKI_TEST_EXPECT_NO_ERR(file.readAllText(txt));
+
+		DynamicArray<String> frames;
+		frames.emplaceBack();
+		const Char* line = txt.cstr();
+		while(*line)
+		{
+			const Char* lineEnd = strchr(line, '\n');
+			lineEnd = (lineEnd) ? lineEnd + 1 : line + strlen(line);
+
+			if(strncmp(line, "Frame ", 6) == 0)
+			{
+				frames.emplaceBack();
+			}
+			else
+			{
+				frames.getBack().append(line, lineEnd);
+			}
+
+			line = lineEnd;
+		}
+
+		ANKI_TEST_EXPECT_EQ(frames.getSize(), 6);
+		ANKI_TEST_EXPECT_GT(frames[0].getLength(), 0);
+		ANKI_TEST_EXPECT_EQ(frames[0], frames[1]);
+		ANKI_TEST_EXPECT_EQ(frames[0], frames[2]);
+		ANKI_TEST_EXPECT_NEQ(frames[0], frames[3]);
+		ANKI_TEST_EXPECT_EQ(frames[0], frames[4]);
+	}
+
+	dumpFname.destroy();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Gr, NullRenderGraphCompileBenchmark)
+{
+	constexpr U32 kPassCount = 300;
+	constexpr U32 kIterations = 100;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	initWindow();
+	ANKI_TEST_EXPECT_NO_ERR(Input::allocateSingleton().init());
+	initGrManager();
+
+	{
+		SyntheticRenderGraphResources rsrc;
+		RenderGraphPtr rgraph = GrManager::getSingleton().newRenderGraph();
+
+		auto benchmark = [&](Bool useCache) {
+			g_renderGraphCompileCacheCVar.set(useCache);
+
+			Second compileTime = 0.0;
+			for(U32 i = 0; i < kIterations; ++i)
+			{
+				StackMemoryPool pool(allocAligned, nullptr, 2_MB);
+				RenderGraphBuilder descr(&pool);
+				populateSyntheticRenderGraph(descr, kPassCount, *rsrc.m_importedTex, rsrc.m_buffers);
+
+				const Second begin = HighRezTimer::getCurrentTime();
+				rgraph->compileNewGraph(descr, pool);
+				compileTime += HighRezTimer::getCurrentTime() - begin;
+
+				rgraph->reset();
+			}
+
+			return compileTime / Second(kIterations);
+		};
+
+		const Second uncachedTime = benchmark(false);
+		const Second cachedTime = benchmark(true);
+		ANKI_TEST_LOGI("RenderGraph compile of %u passes: full %fms, cached %fms", kPassCount, uncachedTime * 1000.0, cachedTime * 1000.0);
+	}
+
+	g_renderGraphCompileCacheCVar.set(true);
+	GrManager::freeSingleton();
+	Input::freeSingleton();
+	NativeWindow::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+#endif
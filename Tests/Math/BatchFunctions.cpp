@@ -0,0 +1,362 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Math.h>
+#include <AnKi/Math/SimdPacket.h>
+#include <AnKi/Collision/Aabb.h>
+#include <random>
+#include <vector>
+
+using namespace anki;
+
+namespace {
+
+class RandomMath
+{
+public:
+	std::mt19937 m_rng{123};
+
+	F32 getF32(F32 min, F32 max)
+	{
+		return std::uniform_real_distribution<F32>(min, max)(m_rng);
+	}
+
+	Vec3 getVec3(F32 min, F32 max)
+	{
+		return Vec3(getF32(min, max), getF32(min, max), getF32(min, max));
+	}
+
+	Quat getQuat()
+	{
+		return Quat(Euler(getF32(-kPi, kPi), getF32(-kPi, kPi), getF32(-kPi, kPi)));
+	}
+
+	Transform getTransform()
+	{
+		return Transform(getVec3(-100.0f, 100.0f).xyz0(), Mat3x4(Vec3(0.0f), Mat3(getQuat())), getVec3(0.1f, 4.0f).xyz0());
+	}
+};
+
+} // end namespace
+
+template<typename TVec>
+static Bool vecsEqual(const TVec& a, const TVec& b, F32 epsilon)
+{
+	for(U32 i = 0; i < TVec::kComponentCount; ++i)
+	{
+		if(absolute(a[i] - b[i]) > epsilon * max(1.0f, absolute(a[i])))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static Bool transformsEqual(const Transform& a, const Transform& b, F32 epsilon)
+{
+	Bool rotationEqual = true;
+	for(U32 i = 0; i < 12; ++i)
+	{
+		rotationEqual = rotationEqual && absolute(a.getRotation()[i] - b.getRotation()[i]) <= epsilon;
+	}
+
+	return rotationEqual && vecsEqual(a.getOrigin(), b.getOrigin(), epsilon) && vecsEqual(a.getScale().xyz(), b.getScale().xyz(), epsilon);
+}
+
+template<typename TPacket>
+static void testPackets()
+{
+	constexpr U32 kLaneCount = TPacket::kLaneCount;
+	Array<F32, kLaneCount> a, b;
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		a[i] = F32(i) - 2.5f;
+		b[i] = F32(i * i) * 0.5f + 1.0f;
+	}
+
+	const TPacket pa = TPacket::load(a.getBegin());
+	const TPacket pb = TPacket::load(b.getBegin());
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ((pa + pb)[i], a[i] + b[i]);
+		ANKI_TEST_EXPECT_EQ((pa - pb)[i], a[i] - b[i]);
+		ANKI_TEST_EXPECT_EQ((pa * pb)[i], a[i] * b[i]);
+		ANKI_TEST_EXPECT_EQ((pa / pb)[i], a[i] / b[i]);
+		ANKI_TEST_EXPECT_EQ(pa.min(pb)[i], min(a[i], b[i]));
+		ANKI_TEST_EXPECT_EQ(pa.max(pb)[i], max(a[i], b[i]));
+		ANKI_TEST_EXPECT_EQ(pa.abs()[i], absolute(a[i]));
+		ANKI_TEST_EXPECT_EQ(pb.sqrt()[i], sqrt(b[i]));
+		ANKI_TEST_EXPECT_EQ(TPacket::select(pa < TPacket(0.0f), pa, pb)[i], (a[i] < 0.0f) ? a[i] : b[i]);
+		ANKI_TEST_EXPECT_EQ(!!((pa >= TPacket(0.0f)).getMask() & (1u << i)), a[i] >= 0.0f);
+	}
+
+	// Transposed loads and stores
+	Array<Vec4, kLaneCount> vecs;
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		vecs[i] = Vec4(F32(i), F32(i) + 0.25f, F32(i) + 0.5f, F32(i) + 0.75f);
+	}
+
+	const TVec3Packet<TPacket> pvecs = TVec3Packet<TPacket>::loadVec4s(vecs.getBegin());
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(pvecs.m_x[i], vecs[i].x());
+		ANKI_TEST_EXPECT_EQ(pvecs.m_y[i], vecs[i].y());
+		ANKI_TEST_EXPECT_EQ(pvecs.m_z[i], vecs[i].z());
+	}
+
+	Array<Vec4, kLaneCount> vecs2;
+	pvecs.storeVec4s(vecs2.getBegin(), 0.0f);
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(vecs2[i], vecs[i].xyz0());
+	}
+}
+
+template<typename TPacket>
+static void testPacketMultiplications(RandomMath& rnd)
+{
+	constexpr U32 kLaneCount = TPacket::kLaneCount;
+	constexpr F32 kEpsilon = 1.0e-5f;
+
+	Array<Mat3x4, kLaneCount> matsA, matsB, matsOut;
+	Array<Transform, kLaneCount> trfsA, trfsB, trfsOut;
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		matsA[i] = Mat3x4(rnd.getVec3(-10.0f, 10.0f), Mat3(rnd.getQuat()), rnd.getVec3(0.5f, 2.0f));
+		matsB[i] = Mat3x4(rnd.getVec3(-10.0f, 10.0f), Mat3(rnd.getQuat()), rnd.getVec3(0.5f, 2.0f));
+		trfsA[i] = rnd.getTransform();
+		trfsB[i] = rnd.getTransform();
+	}
+
+	TMat3x4Packet<TPacket>::load(matsA.getBegin()).combineTransformations(TMat3x4Packet<TPacket>::load(matsB.getBegin())).store(matsOut.getBegin());
+	TTransformPacket<TPacket>::load(trfsA.getBegin())
+		.combineTransformations(TTransformPacket<TPacket>::load(trfsB.getBegin()))
+		.store(trfsOut.getBegin());
+
+	for(U32 i = 0; i < kLaneCount; ++i)
+	{
+		const Mat3x4 expected = matsA[i].combineTransformations(matsB[i]);
+		Bool equal = true;
+		for(U32 j = 0; j < 12; ++j)
+		{
+			equal = equal && absolute(expected[j] - matsOut[i][j]) <= kEpsilon * max(1.0f, absolute(expected[j]));
+		}
+		ANKI_TEST_EXPECT_EQ(equal, true);
+
+		ANKI_TEST_EXPECT_EQ(transformsEqual(trfsOut[i], trfsA[i].combineTransformations(trfsB[i]), kEpsilon), true);
+	}
+}
+
+ANKI_TEST(Math, BatchFunctions)
+{
+	testPackets<F32x4>();
+	testPackets<F32x8>();
+
+	RandomMath rnd;
+
+	// Odd count to test the remainders
+	constexpr U32 kCount = 1003;
+	constexpr F32 kEpsilon = 1.0e-5f;
+
+	// Packet multiplications
+	testPacketMultiplications<F32x4>(rnd);
+	testPacketMultiplications<F32x8>(rnd);
+
+	// Transform invert
+	{
+		std::vector<Transform> in, out(kCount);
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			in.push_back(rnd.getTransform());
+		}
+
+		batchInvertTransformations(ConstWeakArray<Transform>(in.data(), kCount), WeakArray<Transform>(out.data(), kCount));
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(transformsEqual(out[i], in[i].getInverse(), kEpsilon), true);
+		}
+	}
+
+	// Slerp. Include some edge cases: Same quats, opposite quats and quats that are very close
+	{
+		std::vector<Quat> q0, q1, out(kCount);
+		std::vector<F32> t;
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			q0.push_back(rnd.getQuat());
+			if(i % 10 == 0)
+			{
+				q1.push_back(q0.back());
+			}
+			else if(i % 10 == 1)
+			{
+				q1.push_back(-q0.back());
+			}
+			else if(i % 10 == 2)
+			{
+				q1.push_back((q0.back() + Quat(1.0e-4f, 0.0f, 0.0f, 0.0f)).getNormalized());
+			}
+			else
+			{
+				q1.push_back(rnd.getQuat());
+			}
+
+			t.push_back(rnd.getF32(0.0f, 1.0f));
+		}
+
+		batchSlerp(ConstWeakArray<Quat>(q0.data(), kCount), ConstWeakArray<Quat>(q1.data(), kCount), ConstWeakArray<F32>(t.data(), kCount),
+				   WeakArray<Quat>(out.data(), kCount));
+		// The scalar slerp normalizes using an approximate reciprocal square root that has ~12 bits of precision
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(vecsEqual(out[i], q0[i].slerp(q1[i], t[i]), 1.0e-3f), true);
+		}
+	}
+
+	// AABBs
+	{
+		std::vector<Transform> trfs;
+		std::vector<Vec4> mins, maxs, outMins(kCount), outMaxs(kCount);
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			trfs.push_back(rnd.getTransform());
+			const Vec3 center = rnd.getVec3(-50.0f, 50.0f);
+			const Vec3 extend = rnd.getVec3(0.1f, 10.0f);
+			mins.push_back((center - extend).xyz0());
+			maxs.push_back((center + extend).xyz0());
+		}
+
+		batchTransformAabbs(ConstWeakArray<Transform>(trfs.data(), kCount), ConstWeakArray<Vec4>(mins.data(), kCount),
+							ConstWeakArray<Vec4>(maxs.data(), kCount), WeakArray<Vec4>(outMins.data(), kCount),
+							WeakArray<Vec4>(outMaxs.data(), kCount));
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			const Aabb expected = Aabb(mins[i], maxs[i]).getTransformed(trfs[i]);
+			const F32 epsilon = kEpsilonf * 100.0f;
+			ANKI_TEST_EXPECT_EQ(vecsEqual(outMins[i], expected.getMin(), kEpsilon), true);
+			ANKI_TEST_EXPECT_EQ(vecsEqual(outMaxs[i] + Vec4(epsilon, epsilon, epsilon, 0.0f), expected.getMax(), kEpsilon), true);
+		}
+	}
+}
+
+ANKI_BENCH(Math, BatchFunctions)
+{
+	RandomMath rnd;
+	constexpr U32 kCount = 4 * 1024;
+
+	std::vector<Mat3x4> matsA, matsB, matsOut(kCount);
+	std::vector<Transform> trfsA, trfsB, trfsOut(kCount);
+	std::vector<Quat> q0, q1, quatsOut(kCount);
+	std::vector<F32> t;
+	std::vector<Vec4> mins, maxs, outMins(kCount), outMaxs(kCount);
+	for(U32 i = 0; i < kCount; ++i)
+	{
+		matsA.push_back(Mat3x4(rnd.getVec3(-10.0f, 10.0f), Mat3(rnd.getQuat()), Vec3(1.0f)));
+		matsB.push_back(Mat3x4(rnd.getVec3(-10.0f, 10.0f), Mat3(rnd.getQuat()), Vec3(1.0f)));
+		trfsA.push_back(rnd.getTransform());
+		trfsB.push_back(rnd.getTransform());
+		q0.push_back(rnd.getQuat());
+		q1.push_back(rnd.getQuat());
+		t.push_back(rnd.getF32(0.0f, 1.0f));
+		mins.push_back(rnd.getVec3(-10.0f, 0.0f).xyz0());
+		maxs.push_back(rnd.getVec3(0.0f, 10.0f).xyz0());
+	}
+
+	// The packet multiplications are meant for data that is already in SoA so convert it before the benchmark
+#if ANKI_SIMD_AVX2
+	using Packet = F32x8;
+#else
+	using Packet = F32x4;
+#endif
+	constexpr U32 kLaneCount = Packet::kLaneCount;
+	std::vector<TMat3x4Packet<Packet>> matPacketsA, matPacketsB, matPacketsOut(kCount / kLaneCount);
+	std::vector<TTransformPacket<Packet>> trfPacketsA, trfPacketsB, trfPacketsOut(kCount / kLaneCount);
+	for(U32 i = 0; i < kCount; i += kLaneCount)
+	{
+		matPacketsA.push_back(TMat3x4Packet<Packet>::load(&matsA[i]));
+		matPacketsB.push_back(TMat3x4Packet<Packet>::load(&matsB[i]));
+		trfPacketsA.push_back(TTransformPacket<Packet>::load(&trfsA[i]));
+		trfPacketsB.push_back(TTransformPacket<Packet>::load(&trfsB[i]));
+	}
+
+	bench.run("Mat3x4Combine/Scalar/4K", [&]() {
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			matsOut[i] = matsA[i].combineTransformations(matsB[i]);
+		}
+		benchmarkDoNotOptimize(matsOut[0]);
+	});
+
+	bench.run("Mat3x4Combine/Packet/4K", [&]() {
+		for(U32 i = 0; i < kCount / kLaneCount; ++i)
+		{
+			matPacketsOut[i] = matPacketsA[i].combineTransformations(matPacketsB[i]);
+		}
+		benchmarkDoNotOptimize(matPacketsOut[0]);
+	});
+
+	bench.run("TransformCombine/Scalar/4K", [&]() {
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			trfsOut[i] = trfsA[i].combineTransformations(trfsB[i]);
+		}
+		benchmarkDoNotOptimize(trfsOut[0]);
+	});
+
+	bench.run("TransformCombine/Packet/4K", [&]() {
+		for(U32 i = 0; i < kCount / kLaneCount; ++i)
+		{
+			trfPacketsOut[i] = trfPacketsA[i].combineTransformations(trfPacketsB[i]);
+		}
+		benchmarkDoNotOptimize(trfPacketsOut[0]);
+	});
+
+	bench.run("TransformInvert/Scalar/4K", [&]() {
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			trfsOut[i] = trfsA[i].getInverse();
+		}
+		benchmarkDoNotOptimize(trfsOut[0]);
+	});
+
+	bench.run("TransformInvert/Batch/4K", [&]() {
+		batchInvertTransformations(ConstWeakArray<Transform>(trfsA.data(), kCount), WeakArray<Transform>(trfsOut.data(), kCount));
+		benchmarkDoNotOptimize(trfsOut[0]);
+	});
+
+	bench.run("Slerp/Scalar/4K", [&]() {
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			quatsOut[i] = q0[i].slerp(q1[i], t[i]);
+		}
+		benchmarkDoNotOptimize(quatsOut[0]);
+	});
+
+	bench.run("Slerp/Batch/4K", [&]() {
+		batchSlerp(ConstWeakArray<Quat>(q0.data(), kCount), ConstWeakArray<Quat>(q1.data(), kCount), ConstWeakArray<F32>(t.data(), kCount),
+				   WeakArray<Quat>(quatsOut.data(), kCount));
+		benchmarkDoNotOptimize(quatsOut[0]);
+	});
+
+	bench.run("AabbTransform/Scalar/4K", [&]() {
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			const Aabb aabb = Aabb(mins[i], maxs[i]).getTransformed(trfsA[i]);
+			outMins[i] = aabb.getMin();
+			outMaxs[i] = aabb.getMax();
+		}
+		benchmarkDoNotOptimize(outMins[0]);
+	});
+
+	bench.run("AabbTransform/Batch/4K", [&]() {
+		batchTransformAabbs(ConstWeakArray<Transform>(trfsA.data(), kCount), ConstWeakArray<Vec4>(mins.data(), kCount),
+							ConstWeakArray<Vec4>(maxs.data(), kCount), WeakArray<Vec4>(outMins.data(), kCount),
+							WeakArray<Vec4>(outMaxs.data(), kCount));
+		benchmarkDoNotOptimize(outMins[0]);
+	});
+}
@@ -0,0 +1,143 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Physics/PhysicsWorld.h>
+#include <AnKi/Physics/PhysicsCollisionShape.h>
+#include <vector>
+
+using namespace anki;
+
+namespace {
+
+class GridMesh
+{
+public:
+	std::vector<Vec3> m_positions;
+	std::vector<U32> m_indices;
+
+	GridMesh(U32 quadsPerSide)
+	{
+		const U32 vertsPerSide = quadsPerSide + 1;
+		for(U32 z = 0; z < vertsPerSide; ++z)
+		{
+			for(U32 x = 0; x < vertsPerSide; ++x)
+			{
+				const F32 height = sin(F32(x) * 0.3f) * cos(F32(z) * 0.2f);
+				m_positions.push_back(Vec3(F32(x), height, F32(z)));
+			}
+		}
+
+		for(U32 z = 0; z < quadsPerSide; ++z)
+		{
+			for(U32 x = 0; x < quadsPerSide; ++x)
+			{
+				const U32 i = z * vertsPerSide + x;
+				m_indices.insert(m_indices.end(), {i, i + vertsPerSide, i + 1, i + 1, i + vertsPerSide, i + vertsPerSide + 1});
+			}
+		}
+	}
+
+	ConstWeakArray<Vec3> getPositions() const
+	{
+		return ConstWeakArray<Vec3>(m_positions.data(), U32(m_positions.size()));
+	}
+
+	ConstWeakArray<U32> getIndices() const
+	{
+		return ConstWeakArray<U32>(m_indices.data(), U32(m_indices.size()));
+	}
+};
+
+std::vector<U8> serializeBvh(PhysicsCollisionShape& shape)
+{
+	const btOptimizedBvh& bvh = *static_cast<btBvhTriangleMeshShape*>(shape.getBtShape(false))->getOptimizedBvh();
+	const U32 size = bvh.calculateSerializeBufferSize();
+	void* mem = btAlignedAlloc(size, 16);
+	// Call the base class because deserialized BVHs have the vtable of btQuantizedBvh
+	static_cast<const btQuantizedBvh&>(bvh).serialize(mem, size, false);
+	std::vector<U8> out(static_cast<U8*>(mem), static_cast<U8*>(mem) + size);
+	btAlignedFree(mem);
+	return out;
+}
+
+} // end anonymous namespace
+
+ANKI_TEST(Physics, PhysicsTriangleSoup)
+{
+	ANKI_TEST_EXPECT_NO_ERR(PhysicsWorld::allocateSingleton().init(allocAligned, nullptr));
+
+	{
+		const GridMesh mesh(32);
+
+		DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>> bakedBvh(&PhysicsMemoryPool::getSingleton());
+		PhysicsTriangleSoup::bakeBvh(mesh.getPositions(), mesh.getIndices(), bakedBvh);
+		ANKI_TEST_EXPECT_GT(bakedBvh.getSize(), 0);
+
+		PhysicsPtr<PhysicsTriangleSoup> built = PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(mesh.getPositions(), mesh.getIndices());
+		PhysicsPtr<PhysicsTriangleSoup> baked =
+			PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(mesh.getPositions(), mesh.getIndices(), false, bakedBvh);
+
+		// The baked BVH should be identical to the one built at load time
+		const std::vector<U8> builtBytes = serializeBvh(*built);
+		const std::vector<U8> bakedBytes = serializeBvh(*baked);
+		ANKI_TEST_EXPECT_EQ(builtBytes.size(), bakedBytes.size());
+		ANKI_TEST_EXPECT_EQ(builtBytes.size(), bakedBvh.getSize());
+		ANKI_TEST_EXPECT_EQ(memcmp(builtBytes.data(), bakedBytes.data(), builtBytes.size()), 0);
+
+		// The geometry is kept indexed
+		ANKI_TEST_EXPECT_EQ(baked->getPositions().getSize(), mesh.m_positions.size());
+		ANKI_TEST_EXPECT_EQ(baked->getIndices().getSize(), mesh.m_indices.size());
+
+		// The dynamic shape is created on demand and only once
+		const btCollisionShape* dynamicShape = baked->getBtShape(true);
+		ANKI_TEST_EXPECT_NEQ(dynamicShape, nullptr);
+		ANKI_TEST_EXPECT_NEQ(dynamicShape, baked->getBtShape(false));
+		ANKI_TEST_EXPECT_EQ(dynamicShape, baked->getBtShape(true));
+
+		// Garbage should be ignored
+		bakedBvh.resize(64, 0xFF);
+		PhysicsPtr<PhysicsTriangleSoup> garbage =
+			PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(mesh.getPositions(), mesh.getIndices(), false, bakedBvh);
+		const std::vector<U8> garbageBytes = serializeBvh(*garbage);
+		ANKI_TEST_EXPECT_EQ(garbageBytes.size(), builtBytes.size());
+	}
+
+	PhysicsWorld::freeSingleton();
+}
+
+ANKI_BENCH(Physics, PhysicsTriangleSoup)
+{
+	ANKI_TEST_EXPECT_NO_ERR(PhysicsWorld::allocateSingleton().init(allocAligned, nullptr));
+
+	{
+		const GridMesh mesh(128);
+
+		DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>> bakedBvh(&PhysicsMemoryPool::getSingleton());
+		PhysicsTriangleSoup::bakeBvh(mesh.getPositions(), mesh.getIndices(), bakedBvh);
+
+		ANKI_TEST_LOGI("Grid of %zu triangles. Positions %zu bytes, indices %zu bytes, baked BVH %u bytes", mesh.m_indices.size() / 3,
+					   mesh.m_positions.size() * sizeof(Vec3), mesh.m_indices.size() * sizeof(U32), U32(bakedBvh.getSizeInBytes()));
+
+		// Update the world to free the released shapes
+		bench.run("Load/Build/32K", [&]() {
+			PhysicsPtr<PhysicsTriangleSoup> shape =
+				PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(mesh.getPositions(), mesh.getIndices());
+			benchmarkDoNotOptimize(shape.get());
+			shape.reset(nullptr);
+			PhysicsWorld::getSingleton().update(0.0);
+		});
+
+		bench.run("Load/Baked/32K", [&]() {
+			PhysicsPtr<PhysicsTriangleSoup> shape =
+				PhysicsWorld::getSingleton().newInstance<PhysicsTriangleSoup>(mesh.getPositions(), mesh.getIndices(), false, bakedBvh);
+			benchmarkDoNotOptimize(shape.get());
+			shape.reset(nullptr);
+			PhysicsWorld::getSingleton().update(0.0);
+		});
+	}
+
+	PhysicsWorld::freeSingleton();
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Renderer/Utils/ShadowCascadeCache.h>
+
+ANKI_TEST(Renderer, ShadowCascadeCache)
+{
+	const Vec3 lightDir = Vec3(0.2f, -1.0f, 0.3f).getNormalized();
+	const Array<Vec3, 2> sceneBounds = {Vec3(-100.0f), Vec3(100.0f)};
+	const UVec4 viewport(256, 0, 512, 512);
+	constexpr F32 kRadius = 50.0f;
+	constexpr U32 kMaxDrift = 4;
+
+	// Placement
+	{
+		const ShadowCascadePlacement a = ShadowCascadeCache::computePlacement(lightDir, Vec3(0.0f), kRadius, sceneBounds, viewport, kMaxDrift);
+		ANKI_TEST_EXPECT_GT(a.m_radius, kRadius);
+		ANKI_TEST_EXPECT_EQ(a.m_texelPosition, IVec2(0));
+
+		// Moving along the light's axes moves by whole texels
+		const F32 texelSize = a.getTexelSize();
+		const Vec3 center = a.m_lightRotation.getXAxis() * (texelSize * 3.2f) - a.m_lightRotation.getYAxis() * (texelSize * 7.9f);
+		const ShadowCascadePlacement b = ShadowCascadeCache::computePlacement(lightDir, center, kRadius, sceneBounds, viewport, kMaxDrift);
+		ANKI_TEST_EXPECT_EQ(b.m_texelPosition, IVec2(3, -8));
+		ANKI_TEST_EXPECT_EQ(a.isCompatible(b), true);
+
+		// A point stays at the same place relative to the texels
+		Mat3x4 viewA, viewB;
+		Mat4 projA, projB;
+		a.computeMatrices(viewA, projA);
+		b.computeMatrices(viewB, projB);
+
+		const Vec4 point(12.3f, -4.5f, 6.7f, 1.0f);
+		const Vec4 ndcA = projA * Mat4(viewA, Vec4(0.0f, 0.0f, 0.0f, 1.0f)) * point;
+		const Vec4 ndcB = projB * Mat4(viewB, Vec4(0.0f, 0.0f, 0.0f, 1.0f)) * point;
+		const Vec2 texelA = (ndcA.xy() * 0.5f + 0.5f) * F32(viewport.z());
+		const Vec2 texelB = (ndcB.xy() * 0.5f + 0.5f) * F32(viewport.z());
+		ANKI_TEST_EXPECT_NEAR(texelA.x() - texelB.x(), 3.0f, 0.01f);
+		ANKI_TEST_EXPECT_NEAR(texelA.y() - texelB.y(), -8.0f, 0.01f);
+		ANKI_TEST_EXPECT_NEAR(ndcA.z(), ndcB.z(), 0.0001f);
+
+		// The scene is inside the depth range
+		for(U32 i = 0; i < 8; ++i)
+		{
+			const Vec4 corner((i & 1) ? sceneBounds[1].x() : sceneBounds[0].x(), (i & 2) ? sceneBounds[1].y() : sceneBounds[0].y(),
+							  (i & 4) ? sceneBounds[1].z() : sceneBounds[0].z(), 1.0f);
+			const F32 depth = (projA * Mat4(viewA, Vec4(0.0f, 0.0f, 0.0f, 1.0f)) * corner).z();
+			ANKI_TEST_EXPECT_GEQ(depth, 0.0f);
+			ANKI_TEST_EXPECT_LEQ(depth, 1.0f);
+		}
+
+		// Small changes of the scene bounds don't change the depth range
+		const Array<Vec3, 2> sceneBounds2 = {Vec3(-100.0f), Vec3(101.0f)};
+		const ShadowCascadePlacement c = ShadowCascadeCache::computePlacement(lightDir, Vec3(0.0f), kRadius, sceneBounds2, viewport, kMaxDrift);
+		ANKI_TEST_EXPECT_EQ(a.isCompatible(c), true);
+
+		// Other tile or light direction
+		const ShadowCascadePlacement d =
+			ShadowCascadeCache::computePlacement(lightDir, Vec3(0.0f), kRadius, sceneBounds, UVec4(0, 0, 512, 512), kMaxDrift);
+		ANKI_TEST_EXPECT_EQ(a.isCompatible(d), false);
+		const ShadowCascadePlacement e =
+			ShadowCascadeCache::computePlacement(Vec3(0.0f, -1.0f, 0.3f).getNormalized(), Vec3(0.0f), kRadius, sceneBounds, viewport, kMaxDrift);
+		ANKI_TEST_EXPECT_EQ(a.isCompatible(e), false);
+	}
+
+	// Scheduling
+	{
+		ShadowCascadeCache cache;
+		cache.setCascadeParameters(0, 4, kMaxDrift, 100);
+
+		auto placementAt = [&](IVec2 texelPos) {
+			ShadowCascadePlacement p = ShadowCascadeCache::computePlacement(lightDir, Vec3(0.0f), kRadius, sceneBounds, viewport, kMaxDrift);
+			p.m_texelPosition = texelPos;
+			return p;
+		};
+
+		U64 frame = 1;
+
+		// First time it's a redraw
+		ShadowCascadeUpdateInfo info = cache.update(0, placementAt(IVec2(0)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kRedraw);
+
+		// Not moving
+		info = cache.update(0, placementAt(IVec2(0)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kReuse);
+
+		// Small drift. Wait for the update interval and keep the old placement
+		info = cache.update(0, placementAt(IVec2(2, 0)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kReuse);
+		ANKI_TEST_EXPECT_EQ(info.m_placement.m_texelPosition, IVec2(0));
+
+		info = cache.update(0, placementAt(IVec2(2, 0)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kScroll);
+		ANKI_TEST_EXPECT_EQ(info.m_placement.m_texelPosition, IVec2(2, 0));
+		ANKI_TEST_EXPECT_EQ(info.m_scroll, IVec2(2, 0));
+		ANKI_TEST_EXPECT_EQ(info.m_dirtyRectCount, 1);
+		ANKI_TEST_EXPECT_EQ(info.m_dirtyRects[0], UVec4(510, 0, 2, 512));
+
+		// Big drift scrolls immediately. The rects don't overlap
+		info = cache.update(0, placementAt(IVec2(-8, 9)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kScroll);
+		ANKI_TEST_EXPECT_EQ(info.m_scroll, IVec2(-10, 9));
+		ANKI_TEST_EXPECT_EQ(info.m_dirtyRectCount, 2);
+		ANKI_TEST_EXPECT_EQ(info.m_dirtyRects[0], UVec4(0, 0, 10, 512));
+		ANKI_TEST_EXPECT_EQ(info.m_dirtyRects[1], UVec4(10, 503, 502, 9));
+
+		// Scrolling more than half the cascade redraws it
+		info = cache.update(0, placementAt(IVec2(300, 9)), frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kRedraw);
+
+		// Incompatible placement
+		ShadowCascadePlacement p = placementAt(IVec2(300, 9));
+		p.m_radius *= 2.0f;
+		info = cache.update(0, p, frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kRedraw);
+		info = cache.update(0, p, frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kReuse);
+
+		// Too old
+		frame += 100;
+		info = cache.update(0, p, frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kRedraw);
+
+		// Invalidation
+		cache.invalidateAll();
+		info = cache.update(0, p, frame++);
+		ANKI_TEST_EXPECT_EQ(info.m_update, ShadowCascadeUpdate::kRedraw);
+	}
+}
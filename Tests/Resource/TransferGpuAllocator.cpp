@@ -0,0 +1,208 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Resource/TransferGpuAllocator.h>
+
+using namespace anki;
+
+namespace {
+
+class FakeFence
+{
+public:
+	Bool m_signaled = false;
+
+	Bool clientWait([[maybe_unused]] Second seconds) const
+	{
+		return m_signaled;
+	}
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Resource, TransferRing)
+{
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Allocate, release and reclaim in order
+	{
+		TransferRing<FakeFence*> ring;
+		ring.init(100);
+
+		U64 id0, id1, id2;
+		ANKI_TEST_EXPECT_EQ(ring.allocate(30, 1, id0), 0);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(30, 1, id1), 30);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(30, 1, id2), 60);
+		ANKI_TEST_EXPECT_EQ(ring.getUsedSize(), 90);
+
+		// Full
+		U64 id;
+		ANKI_TEST_EXPECT_EQ(ring.allocate(20, 1, id), kMaxPtrSize);
+		ANKI_TEST_EXPECT_EQ(ring.getOldestFence(), nullptr);
+
+		FakeFence fence0, fence1;
+		ring.release(id0, &fence0);
+		ring.release(id1, &fence1);
+		ANKI_TEST_EXPECT_EQ(ring.getOldestFence(), &fence0);
+
+		// Fences not signaled, nothing is reclaimed
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 3);
+
+		// The first is signaled. Wrap around
+		fence0.m_signaled = true;
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 2);
+		ANKI_TEST_EXPECT_EQ(ring.getOldestFence(), &fence1);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(20, 1, id), 0);
+		ANKI_TEST_EXPECT_EQ(ring.getUsedSize(), 90);
+
+		// The head can't pass the tail
+		U64 idb;
+		ANKI_TEST_EXPECT_EQ(ring.allocate(20, 1, idb), kMaxPtrSize);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(10, 1, idb), 20);
+		ANKI_TEST_EXPECT_EQ(ring.getUsedSize(), 100);
+
+		FakeFence fence2;
+		fence1.m_signaled = true;
+		fence2.m_signaled = true;
+		ring.release(id2, &fence2);
+		ring.release(id, &fence2);
+		ring.release(idb, &fence2);
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 0);
+		ANKI_TEST_EXPECT_EQ(ring.getUsedSize(), 0);
+
+		// Empty ring starts from the beginning
+		ANKI_TEST_EXPECT_EQ(ring.allocate(100, 1, id), 0);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(1, 1, idb), kMaxPtrSize);
+		ring.release(id, &fence2);
+		ring.reclaim();
+	}
+
+	// Out of order releases and alignment
+	{
+		TransferRing<FakeFence*> ring;
+		ring.init(256);
+
+		U64 id0, id1, id2;
+		ANKI_TEST_EXPECT_EQ(ring.allocate(10, 48, id0), 0);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(10, 48, id1), 48);
+		ANKI_TEST_EXPECT_EQ(ring.allocate(10, 48, id2), 96);
+
+		FakeFence fence;
+		fence.m_signaled = true;
+
+		// The oldest is still used so nothing can be reclaimed
+		ring.release(id2, &fence);
+		ring.release(id1, &fence);
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 3);
+		ANKI_TEST_EXPECT_EQ(ring.getOldestFence(), nullptr);
+
+		ring.release(id0, &fence);
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 0);
+
+		// Too big
+		ANKI_TEST_EXPECT_EQ(ring.allocate(257, 1, id0), kMaxPtrSize);
+	}
+
+	// Stress it with random sizes and fences that signal in order
+	{
+		constexpr U32 kIterations = 10000;
+		constexpr PtrSize kRingSize = 1024;
+
+		TransferRing<FakeFence*> ring;
+		ring.init(kRingSize);
+
+		class Alloc
+		{
+		public:
+			U64 m_id;
+			PtrSize m_offset;
+			PtrSize m_size;
+		};
+
+		ResourceDynamicArray<Alloc> history; // All allocations in the order they were made
+		ResourceDynamicArray<Alloc> live; // Allocations not released yet
+		ResourceDynamicArray<FakeFence*> fences;
+
+		U32 signaledFenceCount = 0;
+		for(U32 i = 0; i < kIterations; ++i)
+		{
+			ring.reclaim();
+
+			const PtrSize size = getRandomRange<PtrSize>(1, 200);
+			Alloc alloc;
+			alloc.m_size = size;
+			alloc.m_offset = ring.allocate(size, 16, alloc.m_id);
+
+			if(alloc.m_offset != kMaxPtrSize)
+			{
+				ANKI_TEST_EXPECT_EQ(alloc.m_offset % 16, 0);
+				ANKI_TEST_EXPECT_LEQ(alloc.m_offset + size, kRingSize);
+
+				// No overlap with the allocations that are not reclaimed. They are the most recent ones
+				const U32 inRingCount = ring.getAllocationCount() - 1;
+				for(U32 j = history.getSize() - inRingCount; j < history.getSize(); ++j)
+				{
+					const Alloc& other = history[j];
+					const Bool overlap = alloc.m_offset < other.m_offset + other.m_size && other.m_offset < alloc.m_offset + alloc.m_size;
+					ANKI_TEST_EXPECT_EQ(overlap, false);
+				}
+
+				history.emplaceBack(alloc);
+				live.emplaceBack(alloc);
+			}
+
+			// Submit some
+			if(live.getSize() > 0 && (alloc.m_offset == kMaxPtrSize || getRandom() % 3 == 0))
+			{
+				FakeFence* fence = newInstance<FakeFence>(ResourceMemoryPool::getSingleton());
+				fences.emplaceBack(fence);
+
+				const U32 count = getRandomRange<U32>(1, U32(live.getSize()));
+				for(U32 j = 0; j < count; ++j)
+				{
+					ring.release(live[0].m_id, fence);
+					live.erase(live.getBegin());
+				}
+			}
+
+			// Signal some
+			if(signaledFenceCount < fences.getSize() && getRandom() % 2 == 0)
+			{
+				fences[signaledFenceCount++]->m_signaled = true;
+			}
+
+			ANKI_TEST_EXPECT_LEQ(ring.getUsedSize(), kRingSize);
+		}
+
+		// Cleanup
+		for(const Alloc& alloc : live)
+		{
+			FakeFence* fence = newInstance<FakeFence>(ResourceMemoryPool::getSingleton());
+			fences.emplaceBack(fence);
+			ring.release(alloc.m_id, fence);
+		}
+
+		for(FakeFence* fence : fences)
+		{
+			fence->m_signaled = true;
+		}
+
+		ring.reclaim();
+		ANKI_TEST_EXPECT_EQ(ring.getAllocationCount(), 0);
+
+		for(FakeFence* fence : fences)
+		{
+			deleteInstance(ResourceMemoryPool::getSingleton(), fence);
+		}
+	}
+
+	ResourceMemoryPool::freeSingleton();
+}
@@ -0,0 +1,386 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Script.h>
+#include <AnKi/Math.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/ThreadJobManager.h>
+
+using namespace anki;
+
+namespace {
+
+/// An allocation callback that keeps track of the memory that is in use.
+class CountingAllocator
+{
+public:
+	static constexpr PtrSize kHeaderSize = 16;
+
+	Atomic<PtrSize> m_inUse = {0};
+
+	static void* allocate(void* userData, void* ptr, PtrSize size, PtrSize alignment)
+	{
+		CountingAllocator& self = *static_cast<CountingAllocator*>(userData);
+
+		if(ptr == nullptr)
+		{
+			ANKI_ASSERT(alignment <= kHeaderSize);
+			U8* mem = static_cast<U8*>(mallocAligned(size + kHeaderSize, kHeaderSize));
+			*reinterpret_cast<PtrSize*>(mem) = size;
+			self.m_inUse.fetchAdd(size);
+			return mem + kHeaderSize;
+		}
+		else
+		{
+			U8* mem = static_cast<U8*>(ptr) - kHeaderSize;
+			self.m_inUse.fetchSub(*reinterpret_cast<PtrSize*>(mem));
+			freeAligned(mem);
+			return nullptr;
+		}
+	}
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Script, ScriptEnvironmentSharedVm)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ScriptManager::allocateSingleton(allocAligned, nullptr, CString(), 1);
+
+	{
+		ScriptEnvironment envA(true);
+		ScriptEnvironment envB(true);
+		ANKI_TEST_EXPECT_EQ(envA.isVmShared(), true);
+		ANKI_TEST_EXPECT_EQ(&envA.getLuaState(), &envB.getLuaState());
+
+		Vec4 a(0.0f);
+		Vec4 b(0.0f);
+		envA.exposeVariable("vec", &a);
+		envB.exposeVariable("vec", &b);
+
+		// Same source with the same global names. The environments shouldn't see each other's globals
+		static const char* script = R"(
+counter = 0
+
+function update(x)
+	counter = counter + x
+	vec:setX(counter)
+	return counter
+end
+)";
+
+		ANKI_TEST_EXPECT_NO_ERR(envA.evalScript(script));
+		ANKI_TEST_EXPECT_NO_ERR(envB.evalScript(script));
+
+		ANKI_TEST_EXPECT_NO_ERR(envA.evalString("update(1)"));
+		ANKI_TEST_EXPECT_NO_ERR(envA.evalString("update(1)"));
+		ANKI_TEST_EXPECT_NO_ERR(envB.evalString("update(10)"));
+		ANKI_TEST_EXPECT_EQ(a.x(), 2.0f);
+		ANKI_TEST_EXPECT_EQ(b.x(), 10.0f);
+
+		// Call a function of the environment from C++
+		{
+			LockGuard lock(envA);
+			lua_State* l = &envA.getLuaState();
+			envA.pushGlobal("update");
+			lua_pushnumber(l, 5.0);
+			ANKI_TEST_EXPECT_EQ(lua_pcall(l, 1, 1, 0), 0);
+			ANKI_TEST_EXPECT_EQ(lua_tonumber(l, -1), 7.0);
+			lua_pop(l, 1);
+		}
+
+		// The real globals are untouched
+		ANKI_TEST_EXPECT_NO_ERR(envA.evalString("assert(_G.counter == nil)"));
+
+		// The bindings are visible
+		ANKI_TEST_EXPECT_NO_ERR(envB.evalString("local v = Vec3.new(1, 2, 3)\nassert(v:getY() == 2)"));
+
+		// Serialize the globals of one environment to another
+		class Callback : public LuaBinderSerializeGlobalsCallback
+		{
+		public:
+			Array<U8, 1024> m_buff;
+			U32 m_offset = 0;
+
+			void write(const void* data, PtrSize dataSize)
+			{
+				memcpy(&m_buff[m_offset], data, dataSize);
+				m_offset += U32(dataSize);
+			}
+		} callback;
+
+		envA.serializeGlobals(callback);
+
+		ScriptEnvironment envC(true);
+		envC.deserializeGlobals(&callback.m_buff[0], callback.m_offset);
+		ANKI_TEST_EXPECT_NO_ERR(envC.evalString("assert(counter == 7)"));
+		ANKI_TEST_EXPECT_NO_ERR(envB.evalString("assert(counter == 10)"));
+
+		// Errors are reported
+		ANKI_TEST_EXPECT_EQ(envC.evalScript("this is not lua") != Error::kNone, true);
+	}
+
+	ScriptManager::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Script, ScriptEnvironmentBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	constexpr U32 kEnvCount = 10000;
+	constexpr U32 kUpdateCount = 10;
+	constexpr U32 kThreadCount = 8;
+
+	static const char* script = R"(
+time = 0
+pos = Vec3.new(0, 0, 0)
+
+function update(dt)
+	time = time + dt
+	pos:setX(math.sin(time))
+	pos:setY(math.cos(time))
+	return 1
+end
+)";
+
+	{
+		ThreadJobManager jobManager(kThreadCount);
+
+		for(Bool shareVm : {false, true})
+		{
+			CountingAllocator counter;
+			ScriptManager::allocateSingleton(CountingAllocator::allocate, &counter, CString(), kThreadCount);
+
+			DynamicArray<ScriptEnvironment*> envs;
+			envs.resize(kEnvCount);
+
+			const PtrSize memBefore = counter.m_inUse.load();
+			Second begin = HighRezTimer::getCurrentTime();
+			for(ScriptEnvironment*& env : envs)
+			{
+				env = newInstance<ScriptEnvironment>(DefaultMemoryPool::getSingleton(), shareVm);
+				ANKI_TEST_EXPECT_NO_ERR(env->evalScript(script));
+			}
+			const Second createTime = HighRezTimer::getCurrentTime() - begin;
+			const PtrSize memUsed = counter.m_inUse.load() - memBefore;
+
+			begin = HighRezTimer::getCurrentTime();
+			for(U32 u = 0; u < kUpdateCount; ++u)
+			{
+				for(U32 t = 0; t < kThreadCount; ++t)
+				{
+					jobManager.dispatchTask([&envs, t]([[maybe_unused]] U32 threadId) {
+						for(U32 i = t; i < envs.getSize(); i += kThreadCount)
+						{
+							ScriptEnvironment& env = *envs[i];
+							LockGuard lock(env);
+							lua_State* l = &env.getLuaState();
+							env.pushGlobal("update");
+							lua_pushnumber(l, 0.016);
+							[[maybe_unused]] const int err = lua_pcall(l, 1, 1, 0);
+							ANKI_ASSERT(err == 0);
+							lua_pop(l, 1);
+						}
+					});
+				}
+
+				jobManager.waitForAllTasksToFinish();
+			}
+			const Second updateTime = HighRezTimer::getCurrentTime() - begin;
+
+			ANKI_TEST_LOGI("%u environments (%s): memory %zuKB, creation %fms, %u parallel updates %fms", kEnvCount,
+						   (shareVm) ? "shared VMs" : "one VM each", memUsed / 1024, createTime * 1000.0, kUpdateCount, updateTime * 1000.0);
+
+			for(ScriptEnvironment* env : envs)
+			{
+				deleteInstance(DefaultMemoryPool::getSingleton(), env);
+			}
+			envs.destroy();
+
+			ScriptManager::freeSingleton();
+		}
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Script, ScriptEnvironmentBatchCall)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ScriptManager::allocateSingleton(allocAligned, nullptr, CString(), 1);
+
+	{
+		static const char* script = R"(
+function update(v, a, b)
+	v:setX(v:getX() + a)
+	if v:getX() > 2 then
+		return 1, b
+	end
+	return 0
+end
+)";
+
+		Array<Vec4, 3> vecs = {Vec4(0.0f), Vec4(10.0f), Vec4(0.0f)};
+		Array<ScriptEnvironment*, 3> envs;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			envs[i] = newInstance<ScriptEnvironment>(DefaultMemoryPool::getSingleton(), true);
+			ANKI_TEST_EXPECT_NO_ERR(envs[i]->evalScript((i < 2) ? script : "function update() error('oh no') end"));
+			envs[i]->setBatchCallArgument(&vecs[i]);
+		}
+
+		Array<ScriptBatchCallResult, 3> results;
+		ScriptEnvironment::batchCall("update", ConstWeakArray<ScriptEnvironment*>(envs), 1.0, 5.0, WeakArray<ScriptBatchCallResult>(results));
+
+		ANKI_TEST_EXPECT_EQ(vecs[0].x(), 1.0f);
+		ANKI_TEST_EXPECT_EQ(results[0].m_error, false);
+		ANKI_TEST_EXPECT_EQ(results[0].m_return, 0.0);
+		ANKI_TEST_EXPECT_EQ(results[0].m_sleep, 0.0);
+
+		ANKI_TEST_EXPECT_EQ(vecs[1].x(), 11.0f);
+		ANKI_TEST_EXPECT_EQ(results[1].m_error, false);
+		ANKI_TEST_EXPECT_EQ(results[1].m_return, 1.0);
+		ANKI_TEST_EXPECT_EQ(results[1].m_sleep, 5.0);
+
+		ANKI_TEST_EXPECT_EQ(results[2].m_error, true);
+
+		// Only some of them
+		ScriptEnvironment::batchCall("update", ConstWeakArray<ScriptEnvironment*>(&envs[0], 1), 2.0, 0.0,
+									 WeakArray<ScriptBatchCallResult>(&results[0], 1));
+		ANKI_TEST_EXPECT_EQ(vecs[0].x(), 3.0f);
+		ANKI_TEST_EXPECT_EQ(results[0].m_return, 1.0);
+		ANKI_TEST_EXPECT_EQ(vecs[1].x(), 11.0f);
+
+		for(ScriptEnvironment* env : envs)
+		{
+			deleteInstance(DefaultMemoryPool::getSingleton(), env);
+		}
+	}
+
+	ScriptManager::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Script, ScriptEnvironmentBatchCallBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ScriptManager::allocateSingleton(allocAligned, nullptr, CString(), 1);
+
+	{
+		constexpr U32 kEnvCount = 10000;
+		constexpr U32 kFrameCount = 60;
+		constexpr Second kDt = 1.0 / 60.0;
+
+		// Most scripts do nothing most of the time. They go to sleep for a second
+		static const char* script = R"(
+time = 0
+
+function update(v, prevTime, crntTime)
+	time = time + crntTime - prevTime
+	if v:getW() > 0.5 then
+		v:setX(math.sin(time))
+		return 1
+	end
+	return 0, 1
+end
+)";
+
+		DynamicArray<Vec4> vecs;
+		vecs.resize(kEnvCount);
+		DynamicArray<ScriptEnvironment*> envs;
+		envs.resize(kEnvCount);
+		for(U32 i = 0; i < kEnvCount; ++i)
+		{
+			vecs[i] = Vec4(0.0f, 0.0f, 0.0f, (i % 10 == 0) ? 1.0f : 0.0f);
+			envs[i] = newInstance<ScriptEnvironment>(DefaultMemoryPool::getSingleton(), true);
+			ANKI_TEST_EXPECT_NO_ERR(envs[i]->evalScript(script));
+			envs[i]->setBatchCallArgument(&vecs[i]);
+		}
+
+		// The old way. One call per script per frame
+		Second time = 0.0;
+		Second begin = HighRezTimer::getCurrentTime();
+		for(U32 f = 0; f < kFrameCount; ++f)
+		{
+			for(U32 i = 0; i < kEnvCount; ++i)
+			{
+				ScriptEnvironment& env = *envs[i];
+				LockGuard lock(env);
+				lua_State* l = &env.getLuaState();
+				env.pushGlobal("update");
+				LuaBinder::pushVariableToTheStack(l, &vecs[i]);
+				lua_pushnumber(l, time);
+				lua_pushnumber(l, time + kDt);
+				[[maybe_unused]] const int err = lua_pcall(l, 3, 1, 0);
+				ANKI_ASSERT(err == 0 && lua_isnumber(l, -1));
+				lua_pop(l, 1);
+			}
+
+			time += kDt;
+		}
+		const Second perScriptTime = HighRezTimer::getCurrentTime() - begin;
+
+		// One call into the VM for all of them
+		DynamicArray<ScriptBatchCallResult> results;
+		results.resize(kEnvCount);
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 f = 0; f < kFrameCount; ++f)
+		{
+			ScriptEnvironment::batchCall("update", ConstWeakArray<ScriptEnvironment*>(envs), time, time + kDt,
+										 WeakArray<ScriptBatchCallResult>(results));
+			time += kDt;
+		}
+		const Second batchTime = HighRezTimer::getCurrentTime() - begin;
+
+		// Batched and skip the ones that sleep
+		DynamicArray<Second> wakeTimes;
+		wakeTimes.resize(kEnvCount, 0.0);
+		DynamicArray<ScriptEnvironment*> dueEnvs;
+		dueEnvs.resize(kEnvCount);
+		DynamicArray<U32> dueIndices;
+		dueIndices.resize(kEnvCount);
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 f = 0; f < kFrameCount; ++f)
+		{
+			U32 dueCount = 0;
+			for(U32 i = 0; i < kEnvCount; ++i)
+			{
+				if(time >= wakeTimes[i])
+				{
+					dueEnvs[dueCount] = envs[i];
+					dueIndices[dueCount] = i;
+					++dueCount;
+				}
+			}
+
+			if(dueCount)
+			{
+				ScriptEnvironment::batchCall("update", ConstWeakArray<ScriptEnvironment*>(&dueEnvs[0], dueCount), time, time + kDt,
+											 WeakArray<ScriptBatchCallResult>(&results[0], dueCount));
+			}
+
+			for(U32 i = 0; i < dueCount; ++i)
+			{
+				wakeTimes[dueIndices[i]] = time + kDt + results[i].m_sleep;
+			}
+
+			time += kDt;
+		}
+		const Second sleepTime = HighRezTimer::getCurrentTime() - begin;
+
+		ANKI_TEST_LOGI("%u scripts for %u frames: per script calls %fms, batched %fms, batched with sleeping %fms", kEnvCount, kFrameCount,
+					   perScriptTime * 1000.0, batchTime * 1000.0, sleepTime * 1000.0);
+
+		for(ScriptEnvironment* env : envs)
+		{
+			deleteInstance(DefaultMemoryPool::getSingleton(), env);
+		}
+	}
+
+	ScriptManager::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
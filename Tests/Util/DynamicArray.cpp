@@ -315,3 +315,38 @@ ANKI_TEST(Util, DynamicArrayErase)
 		ANKI_TEST_EXPECT_EQ(g_constructor0Count + g_constructor1Count + g_constructor2Count + g_constructor3Count, g_destructorCount);
 	}
 }
+
+ANKI_BENCH(Util, DynamicArrayOperations)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		bench.run("EmplaceBack1024", [&]() {
+			DynamicArray<U32> arr;
+			for(U32 i = 0; i < 1024; ++i)
+			{
+				arr.emplaceBack(i);
+			}
+			benchmarkDoNotOptimize(arr[512]);
+		});
+
+		bench.run("ResizeNonTrivial1024", [&]() {
+			DynamicArray<DynamicArrayFoo> arr;
+			arr.resize(1024);
+			benchmarkDoNotOptimize(arr[512].m_x);
+		});
+
+		DynamicArray<U32> arr;
+		arr.resize(64 * 1024, 1);
+		bench.run("Iterate64K", [&]() {
+			U32 sum = 0;
+			for(U32 x : arr)
+			{
+				sum += x;
+			}
+			benchmarkDoNotOptimize(sum);
+		});
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,163 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Hash.h>
+#include <vector>
+#include <unordered_set>
+#include <random>
+#include <bit>
+
+ANKI_TEST(Util, Hash)
+{
+	std::vector<U8> buffer(2048);
+	for(PtrSize i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = U8(i * 7 + 3);
+	}
+
+	// Known values of the reference XXH3 implementation. Values that are stored to disk depend on these never changing
+	{
+		ANKI_TEST_EXPECT_EQ(computeHash("hello", 5, 0), 0x9555e8555c62dcfd_U64);
+
+		const Array<std::pair<PtrSize, U64>, 8> knownValues = {{{0, 0x3616479b9a94fda7_U64},
+																{3, 0x42aedd4f9dc265b1_U64},
+																{8, 0x50ec3e20eca2c3aa_U64},
+																{16, 0x974b6de31ce19b63_U64},
+																{100, 0xf70c343509ea2b0a_U64},
+																{200, 0xf1af972cafb940bd_U64},
+																{1000, 0x65e28e6a92d1c800_U64},
+																{2048, 0xc686b9dcb99db180_U64}}};
+
+		for(const auto& it : knownValues)
+		{
+			ANKI_TEST_EXPECT_EQ(computeHash(buffer.data(), it.first), it.second);
+		}
+	}
+
+	// Streaming gives the same results as the one-shot version no matter how the data are split
+	{
+		std::mt19937 rng(123);
+		for(U32 i = 0; i < 2000; ++i)
+		{
+			const PtrSize size = rng() % buffer.size();
+			const U64 seed = rng();
+
+			StreamingHasher hasher(seed);
+			PtrSize offset = 0;
+			while(offset < size)
+			{
+				const PtrSize pieceSize = min<PtrSize>(size - offset, (rng() % 4) ? rng() % 32 : rng() % 600);
+				hasher.append(buffer.data() + offset, pieceSize);
+				offset += pieceSize;
+			}
+
+			ANKI_TEST_EXPECT_EQ(hasher.getHash(), computeHash(buffer.data(), size, seed));
+		}
+	}
+
+	// No collisions on sequential integers
+	{
+		std::unordered_set<U64> hashes;
+		for(U32 i = 0; i < 1000000; ++i)
+		{
+			hashes.insert(computeObjectHash(i));
+		}
+
+		ANKI_TEST_EXPECT_EQ(hashes.size(), 1000000);
+	}
+
+	// Avalanche: Flipping one bit of the input should flip about half the bits of the hash
+	{
+		const Array<PtrSize, 5> sizes = {4, 16, 64, 200, 1024};
+		for(PtrSize size : sizes)
+		{
+			std::vector<U8> data(buffer.begin(), buffer.begin() + size);
+			const U64 h = computeHash(data.data(), size);
+
+			U64 flippedBitCount = 0;
+			for(PtrSize bit = 0; bit < size * 8; ++bit)
+			{
+				data[bit / 8] ^= U8(1u << (bit % 8));
+				flippedBitCount += std::popcount(h ^ computeHash(data.data(), size));
+				data[bit / 8] ^= U8(1u << (bit % 8));
+			}
+
+			const F64 avgFlippedBits = F64(flippedBitCount) / F64(size * 8);
+			ANKI_TEST_EXPECT_GT(avgFlippedBits, 30.0);
+			ANKI_TEST_EXPECT_LT(avgFlippedBits, 34.0);
+		}
+	}
+}
+
+ANKI_BENCH(Util, ComputeHash)
+{
+	std::vector<U8> buffer(1_MB);
+	for(PtrSize i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = U8(i * 31);
+	}
+
+	bench.run("16B", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), 16));
+	});
+
+	bench.run("32B", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), 32));
+	});
+
+	bench.run("64B", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), 64));
+	});
+
+	bench.run("256B", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), 256));
+	});
+
+	bench.run("4KB", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), 4_KB));
+	});
+
+	bench.run("1MB", [&]() {
+		benchmarkDoNotOptimize(computeHash(buffer.data(), buffer.size()));
+	});
+}
+
+ANKI_BENCH(Util, StreamingHasher)
+{
+	std::vector<U8> buffer(1_MB);
+	for(PtrSize i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = U8(i * 31);
+	}
+
+	// A key made of many small parts, like the pipeline state keys
+	bench.run("AppendHash/16x8B", [&]() {
+		U64 hash = computeHash(buffer.data(), 8);
+		for(U32 i = 1; i < 16; ++i)
+		{
+			hash = appendHash(buffer.data() + i * 8, 8, hash);
+		}
+		benchmarkDoNotOptimize(hash);
+	});
+
+	bench.run("StreamingHasher/16x8B", [&]() {
+		StreamingHasher hasher;
+		for(U32 i = 0; i < 16; ++i)
+		{
+			hasher.append(buffer.data() + i * 8, 8);
+		}
+		benchmarkDoNotOptimize(hasher.getHash());
+	});
+
+	bench.run("StreamingHasher/1MB", [&]() {
+		StreamingHasher hasher;
+		for(PtrSize offset = 0; offset < buffer.size(); offset += 4_KB)
+		{
+			hasher.append(buffer.data() + offset, 4_KB);
+		}
+		benchmarkDoNotOptimize(hasher.getHash());
+	});
+}
@@ -274,3 +274,44 @@ ANKI_TEST(Util, HashMap)
 		akMap.destroy();
 	}
 }
+
+ANKI_BENCH(Util, HashMapOperations)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kCount = 64 * 1024;
+		DynamicArray<int> vals;
+		vals.resize(kCount);
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			vals[i] = int(i * 2654435761u);
+		}
+
+		HashMap<int, int, Hasher> map;
+		for(int v : vals)
+		{
+			map.emplace(v, v);
+		}
+
+		U32 i = 0;
+		bench.run("Find", [&]() {
+			auto it = map.find(vals[i++ % kCount]);
+			benchmarkDoNotOptimize(*it);
+		});
+
+		bench.run("FindMissing", [&]() {
+			auto it = map.find(int(i++ * 2654435761u) | 1);
+			benchmarkDoNotOptimize(it);
+		});
+
+		bench.run("EmplaceErase", [&]() {
+			const int key = vals[i++ % kCount] | 1;
+			map.erase(map.emplace(key, key));
+		});
+
+		map.destroy();
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,179 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/IndexAllocator.h>
+#include <AnKi/Util/BitSet.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <set>
+#include <random>
+
+using namespace anki;
+
+ANKI_TEST(Util, IndexAllocator)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Simple
+	{
+		IndexAllocator<> alloc(3);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), 0);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), 1);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), 2);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), kMaxU32);
+
+		alloc.free(1);
+		ANKI_TEST_EXPECT_EQ(alloc.findLastAllocated(kMaxU32), 2);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), 1);
+
+		alloc.grow(200);
+		ANKI_TEST_EXPECT_EQ(alloc.allocate(), 3);
+
+		alloc.free(0);
+		alloc.free(1);
+		alloc.free(2);
+		alloc.free(3);
+		ANKI_TEST_EXPECT_EQ(alloc.findLastAllocated(kMaxU32), kMaxU32);
+	}
+
+	// Random against a reference implementation
+	{
+		std::mt19937 gen(123);
+		IndexAllocator<> alloc(1000);
+		std::set<U32> allocated;
+		std::set<U32> free;
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			free.insert(i);
+		}
+
+		for(U32 it = 0; it < 200000; ++it)
+		{
+			const U32 op = gen() % 100;
+			if(op < 55)
+			{
+				const U32 idx = alloc.allocate();
+				if(free.empty())
+				{
+					ANKI_TEST_EXPECT_EQ(idx, kMaxU32);
+				}
+				else
+				{
+					ANKI_TEST_EXPECT_EQ(idx, *free.begin());
+					free.erase(free.begin());
+					allocated.insert(idx);
+				}
+			}
+			else if(op < 99 && !allocated.empty())
+			{
+				auto itToFree = allocated.begin();
+				std::advance(itToFree, gen() % allocated.size());
+				alloc.free(*itToFree);
+				free.insert(*itToFree);
+				allocated.erase(itToFree);
+			}
+			else if(alloc.getCapacity() < 300000)
+			{
+				const U32 oldCapacity = alloc.getCapacity();
+				const U32 newCapacity = oldCapacity + gen() % 70000;
+				alloc.grow(newCapacity);
+				for(U32 i = oldCapacity; i < newCapacity; ++i)
+				{
+					free.insert(i);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(alloc.getAllocatedCount(), allocated.size());
+			ANKI_TEST_EXPECT_EQ(alloc.findLastAllocated(kMaxU32), (allocated.empty()) ? kMaxU32 : *allocated.rbegin());
+		}
+
+		alloc.validate();
+
+		for(U32 idx : allocated)
+		{
+			alloc.free(idx);
+		}
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, IndexAllocatorBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Spawn a burst of objects into an array that is almost full, free some of them and spawn again. The linear scan over the bit set is how
+	// GpuSceneArray used to find free indices
+	constexpr U32 kCapacity = 256 * 1024;
+	constexpr U32 kBurst = 32 * 1024;
+	constexpr U32 kRounds = 8;
+
+	using SubMask = BitSet<64, U64>;
+	DynamicArray<SubMask> linear;
+	linear.resize(kCapacity / 64, SubMask(false));
+	IndexAllocator<> hierarchical(kCapacity);
+
+	// Pre-fill most of the array
+	for(U32 i = 0; i < kCapacity - kBurst; ++i)
+	{
+		linear[i / 64].set(i % 64);
+		[[maybe_unused]] const U32 idx = hierarchical.allocate();
+	}
+
+	Second linearTime = 0.0;
+	Second hierarchicalTime = 0.0;
+	DynamicArray<U32> indices;
+	indices.resize(kBurst);
+	for(U32 round = 0; round < kRounds; ++round)
+	{
+		Second begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < kBurst; ++i)
+		{
+			U32 idx = kMaxU32;
+			for(U32 maskGroup = 0; maskGroup < linear.getSize(); ++maskGroup)
+			{
+				const U32 bit = (~linear[maskGroup]).getLeastSignificantBit();
+				if(bit != kMaxU32)
+				{
+					idx = maskGroup * 64 + bit;
+					break;
+				}
+			}
+
+			linear[idx / 64].set(idx % 64);
+			indices[i] = idx;
+		}
+		linearTime += HighRezTimer::getCurrentTime() - begin;
+
+		for(U32 idx : indices)
+		{
+			linear[idx / 64].unset(idx % 64);
+		}
+
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < kBurst; ++i)
+		{
+			indices[i] = hierarchical.allocate();
+		}
+		hierarchicalTime += HighRezTimer::getCurrentTime() - begin;
+
+		for(U32 idx : indices)
+		{
+			hierarchical.free(idx);
+		}
+	}
+
+	ANKI_TEST_LOGI("%u allocations: linear scan %fms, hierarchical %fms", kBurst * kRounds, linearTime * 1000.0, hierarchicalTime * 1000.0);
+
+	for(U32 i = 0; i < kCapacity - kBurst; ++i)
+	{
+		hierarchical.free(i);
+	}
+
+	indices.destroy();
+	linear.destroy();
+	hierarchical.destroy();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,292 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+using namespace anki;
+
+namespace {
+
+class LogCapture
+{
+public:
+	std::vector<std::string> m_messages;
+	std::vector<LoggerMessageType> m_types;
+	Atomic<U32> m_blockHandler = {0};
+
+	LogCapture()
+	{
+		Logger::getSingleton().enableDefaultMessageHandler(false);
+		Logger::getSingleton().addMessageHandler(this, handler);
+	}
+
+	~LogCapture()
+	{
+		Logger::getSingleton().flush();
+		Logger::getSingleton().removeMessageHandler(this, handler);
+		Logger::getSingleton().enableDefaultMessageHandler(true);
+	}
+
+	static void handler(void* ud, const LoggerMessageInfo& info)
+	{
+		LogCapture& self = *static_cast<LogCapture*>(ud);
+		while(self.m_blockHandler.load(AtomicMemoryOrder::kAcquire))
+		{
+			std::this_thread::yield();
+		}
+
+		self.m_messages.push_back(info.m_msg);
+		self.m_types.push_back(info.m_type);
+	}
+};
+
+} // end anonymous namespace
+
+/// Log something and remember what snprintf would have written.
+#define ANKI_TEST_LOG_AND_EXPECT(...) \
+	do \
+	{ \
+		std::vector<Char> expected_(snprintf(nullptr, 0, __VA_ARGS__) + 1); \
+		snprintf(expected_.data(), expected_.size(), __VA_ARGS__); \
+		expectedMessages.push_back(expected_.data()); \
+		ANKI_TEST_LOGI(__VA_ARGS__); \
+	} while(false)
+
+static void logManyFormats(std::vector<std::string>& expectedMessages)
+{
+	const std::string longString(300, 'x');
+	const std::string veryLongString(5000, 'y');
+	Array<Char, 8> notTerminated = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
+	int local = 0;
+
+	ANKI_TEST_LOG_AND_EXPECT("Plain message");
+	ANKI_TEST_LOG_AND_EXPECT("100%% sure");
+	ANKI_TEST_LOG_AND_EXPECT("%d %i %u %x %X %o", -123, 456, 789u, 0xABCu, 0xDEFu, 8u);
+	ANKI_TEST_LOG_AND_EXPECT("%hhd %hd %ld %lld %lu %llu", (signed char)-5, (short)-300, -123456789l, -1234567890123ll, 123456789ul,
+							 1234567890123ull);
+	ANKI_TEST_LOG_AND_EXPECT("%zu %td %jd", size_t(12345), ptrdiff_t(-9876), intmax_t(-1));
+	ANKI_TEST_LOG_AND_EXPECT("%" PRIu64 " %" PRIi64 " %" PRIx64, kMaxU64, kMinI64, U64(0xDEADBEEFCAFE));
+	ANKI_TEST_LOG_AND_EXPECT("%f %.3f %e %g %a %10.2f|%-10.2f|%+f", 3.14159, 2.71828, 1.0e-10, 0.0001, 1.5, -3.5, 3.5, 1.0);
+	ANKI_TEST_LOG_AND_EXPECT("%Lf %.20Lg", 1.5L, 3.14159265358979323846L);
+	ANKI_TEST_LOG_AND_EXPECT("%c%c%c", 'a', 'b', 'c');
+	ANKI_TEST_LOG_AND_EXPECT("%s|%10s|%-10s|%.2s", "str", "right", "left", "truncated");
+	ANKI_TEST_LOG_AND_EXPECT("%*d|%-*d|%.*f|%*.*s", 6, 42, 6, 42, 2, 1.23456, 8, 3, "precision");
+	ANKI_TEST_LOG_AND_EXPECT("%.*s", 8, notTerminated.getBegin());
+	ANKI_TEST_LOG_AND_EXPECT("%p", static_cast<void*>(&local));
+	ANKI_TEST_LOG_AND_EXPECT("%#x %08d %+d % d", 255u, 42, 42, 42);
+	ANKI_TEST_LOG_AND_EXPECT("Long %s end", longString.c_str());
+	ANKI_TEST_LOG_AND_EXPECT("Very long %s end", veryLongString.c_str());
+	ANKI_TEST_LOG_AND_EXPECT("%s %d %s %f %s", "mixed", 1, longString.c_str(), 2.0, "end");
+}
+
+ANKI_TEST(Util, Logger)
+{
+	Logger& logger = Logger::getSingleton();
+
+	// Compare the deferred formatting with snprintf
+	for(Bool async : {true, false})
+	{
+		logger.enableAsync(async);
+
+		std::vector<std::string> expectedMessages;
+		LogCapture capture;
+		logManyFormats(expectedMessages);
+		logger.flush();
+
+		ANKI_TEST_EXPECT_EQ(capture.m_messages.size(), expectedMessages.size());
+		for(U32 i = 0; i < std::min(capture.m_messages.size(), expectedMessages.size()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(capture.m_messages[i], expectedMessages[i]);
+		}
+	}
+
+	logger.enableAsync(true);
+
+	// Many threads, block policy. Nothing is lost and the messages of every thread keep their order
+	{
+		constexpr U32 kThreadCount = 8;
+		constexpr U32 kMessagesPerThread = 2000;
+
+		LogCapture capture;
+		std::vector<std::thread> threads;
+		for(U32 t = 0; t < kThreadCount; ++t)
+		{
+			threads.emplace_back([t]() {
+				for(U32 i = 0; i < kMessagesPerThread; ++i)
+				{
+					ANKI_TEST_LOGI("%u %u", t, i);
+				}
+			});
+		}
+
+		for(std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		logger.flush();
+
+		ANKI_TEST_EXPECT_EQ(capture.m_messages.size(), kThreadCount * kMessagesPerThread);
+
+		std::vector<U32> nextMessage(kThreadCount, 0);
+		for(const std::string& msg : capture.m_messages)
+		{
+			U32 t, i;
+			ANKI_TEST_EXPECT_EQ(sscanf(msg.c_str(), "%u %u", &t, &i), 2);
+			ANKI_TEST_EXPECT_EQ(nextMessage[t], i);
+			++nextMessage[t];
+		}
+	}
+
+	// Drop policy. Block the logger thread to fill the queue
+	{
+		constexpr U32 kMessageCount = 5000;
+
+		logger.setOverflowPolicy(LoggerOverflowPolicy::kDrop);
+		const U64 droppedBefore = logger.getDroppedMessageCount();
+
+		LogCapture capture;
+		capture.m_blockHandler.store(1, AtomicMemoryOrder::kRelease);
+		for(U32 i = 0; i < kMessageCount; ++i)
+		{
+			ANKI_TEST_LOGI("%u", i);
+		}
+		capture.m_blockHandler.store(0, AtomicMemoryOrder::kRelease);
+		logger.flush();
+
+		const U64 dropped = logger.getDroppedMessageCount() - droppedBefore;
+		ANKI_TEST_EXPECT_GT(dropped, 0);
+
+		U32 receivedCount = 0;
+		Bool droppedReported = false;
+		for(U32 i = 0; i < capture.m_messages.size(); ++i)
+		{
+			if(capture.m_types[i] == LoggerMessageType::kWarning)
+			{
+				droppedReported = droppedReported || capture.m_messages[i].find("dropped") != std::string::npos;
+			}
+			else
+			{
+				++receivedCount;
+			}
+		}
+
+		ANKI_TEST_EXPECT_EQ(receivedCount + dropped, kMessageCount);
+		ANKI_TEST_EXPECT_EQ(droppedReported, true);
+
+		logger.setOverflowPolicy(LoggerOverflowPolicy::kBlock);
+	}
+}
+
+static void writeToFile(void* file, const LoggerMessageInfo& info)
+{
+	[[maybe_unused]] const Error err =
+		static_cast<File*>(file)->writeTextf("[%s] %s (%s:%d %s)\n", info.m_subsystem, info.m_msg, info.m_file, info.m_line, info.m_func);
+}
+
+ANKI_BENCH(Util, Logger)
+{
+	constexpr U32 kThreadCount = 16;
+	constexpr U32 kMessagesPerThread = 64;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	Logger& logger = Logger::getSingleton();
+
+	{
+		String fname;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(fname));
+		fname += "/LoggerBench.txt";
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::kWrite));
+
+		// The producers are created before Benchmark::run() pins the calling thread because threads inherit the affinity
+		Atomic<U32> round = {0};
+		Atomic<U32> finishedCount = {0};
+		Bool quit = false;
+		Array<Second, kThreadCount> producerTimes = {};
+		std::vector<std::thread> threads;
+		for(U32 t = 0; t < kThreadCount; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				U32 lastRound = 0;
+				while(true)
+				{
+					while(round.load(AtomicMemoryOrder::kAcquire) == lastRound)
+					{
+						std::this_thread::yield();
+					}
+					++lastRound;
+
+					if(quit)
+					{
+						break;
+					}
+
+					const Second begin = HighRezTimer::getCurrentTime();
+					for(U32 i = 0; i < kMessagesPerThread; ++i)
+					{
+						ANKI_TEST_LOGI("Thread %u message %u value %f name %s", t, i, F64(i) * 0.5, "some_name");
+					}
+					producerTimes[t] += HighRezTimer::getCurrentTime() - begin;
+
+					finishedCount.fetchAdd(1, AtomicMemoryOrder::kRelease);
+				}
+			});
+		}
+
+		auto runRound = [&]() {
+			finishedCount.store(0, AtomicMemoryOrder::kRelaxed);
+			round.fetchAdd(1, AtomicMemoryOrder::kRelease);
+			while(finishedCount.load(AtomicMemoryOrder::kAcquire) < kThreadCount)
+			{
+				std::this_thread::yield();
+			}
+		};
+
+		for(Bool async : {false, true})
+		{
+			logger.enableAsync(async);
+			logger.enableDefaultMessageHandler(false);
+			logger.addMessageHandler(&file, writeToFile);
+
+			producerTimes = {};
+			U32 roundCount = 0;
+			bench.run((async) ? "Async/16Threads" : "Sync/16Threads", [&]() {
+				runRound();
+				++roundCount;
+			});
+
+			logger.flush();
+			logger.removeMessageHandler(&file, writeToFile);
+			logger.enableDefaultMessageHandler(true);
+
+			// The average time a thread spends in a single log call
+			Second producerTime = 0.0;
+			for(Second time : producerTimes)
+			{
+				producerTime += time;
+			}
+			ANKI_TEST_LOGI("%s: %f ns per log call", (async) ? "Async" : "Sync",
+						   producerTime / F64(roundCount * kThreadCount * kMessagesPerThread) * 1000000000.0);
+		}
+
+		quit = true;
+		round.fetchAdd(1, AtomicMemoryOrder::kRelease);
+		for(std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	logger.enableAsync(true);
+	DefaultMemoryPool::freeSingleton();
+}
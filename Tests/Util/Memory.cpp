@@ -7,6 +7,7 @@
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/MemoryPool.h>
 #include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <type_traits>
 #include <cstring>
 
@@ -33,6 +34,177 @@ ANKI_TEST(Util, HeapMemoryPool)
 	}
 }
 
+ANKI_TEST(Util, HeapMemoryPoolThreadCache)
+{
+	constexpr U32 kThreadCount = 8;
+	constexpr U32 kAllocationsPerThread = 1024;
+
+	class Allocation
+	{
+	public:
+		U8* m_ptr = nullptr;
+		U32 m_size = 0;
+		U8 m_magic = 0;
+	};
+
+	// Allocate in one thread and free in another
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "ThreadCached", true);
+		ThreadPool threadPool(kThreadCount);
+
+		class AllocateTask : public ThreadPoolTask
+		{
+		public:
+			HeapMemoryPool* m_pool = nullptr;
+			Array<Allocation, kAllocationsPerThread> m_allocations;
+
+			Error operator()(U32 taskId, [[maybe_unused]] PtrSize threadsCount)
+			{
+				for(U32 i = 0; i < kAllocationsPerThread; ++i)
+				{
+					// Mix small, large and over-aligned allocations
+					Allocation& alloc = m_allocations[i];
+					alloc.m_size = (i % 7 == 0) ? 1000 + i : 1 + (i * 13) % 500;
+					const PtrSize alignment = (i % 11 == 0) ? 64 : 1u << (i % 5);
+					alloc.m_ptr = static_cast<U8*>(m_pool->allocate(alloc.m_size, alignment));
+					if(!isAligned(alignment, alloc.m_ptr))
+					{
+						return Error::kFunctionFailed;
+					}
+
+					alloc.m_magic = U8(taskId * 31 + i);
+					memset(alloc.m_ptr, alloc.m_magic, alloc.m_size);
+				}
+
+				return Error::kNone;
+			}
+		};
+
+		class FreeTask : public ThreadPoolTask
+		{
+		public:
+			HeapMemoryPool* m_pool = nullptr;
+			AllocateTask* m_allocTask = nullptr;
+
+			Error operator()([[maybe_unused]] U32 taskId, [[maybe_unused]] PtrSize threadsCount)
+			{
+				Error err = Error::kNone;
+				for(Allocation& alloc : m_allocTask->m_allocations)
+				{
+					for(U32 k = 0; k < alloc.m_size; ++k)
+					{
+						if(alloc.m_ptr[k] != alloc.m_magic)
+						{
+							err = Error::kFunctionFailed;
+						}
+					}
+
+					m_pool->free(alloc.m_ptr);
+				}
+
+				return err;
+			}
+		};
+
+		Array<AllocateTask, kThreadCount> allocTasks;
+		Array<FreeTask, kThreadCount> freeTasks;
+
+		for(U32 round = 0; round < 3; ++round)
+		{
+			for(U32 i = 0; i < kThreadCount; ++i)
+			{
+				allocTasks[i].m_pool = &pool;
+				threadPool.assignNewTask(i, &allocTasks[i]);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), kThreadCount * kAllocationsPerThread);
+
+			for(U32 i = 0; i < kThreadCount; ++i)
+			{
+				freeTasks[i].m_pool = &pool;
+				freeTasks[i].m_allocTask = &allocTasks[(i + 1) % kThreadCount];
+				threadPool.assignNewTask(i, &freeTasks[i]);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		}
+	}
+
+	// Re-create pools while the threads still have cached slots of the old ones
+	for(U32 i = 0; i < 4; ++i)
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "ThreadCached", true);
+		Array<void*, 64> ptrs;
+		for(void*& ptr : ptrs)
+		{
+			ptr = pool.allocate(24, 8);
+			ANKI_TEST_EXPECT_NEQ(ptr, nullptr);
+		}
+
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+	}
+}
+
+ANKI_TEST(Util, HeapMemoryPoolThreadCacheBenchmark)
+{
+	constexpr U32 kThreadCount = 8;
+	constexpr U32 kIterations = 200000;
+	constexpr U32 kLiveAllocations = 64;
+
+	class BenchTask : public ThreadPoolTask
+	{
+	public:
+		HeapMemoryPool* m_pool = nullptr;
+
+		Error operator()(U32 taskId, [[maybe_unused]] PtrSize threadsCount)
+		{
+			// Small short lived allocations with a few of them staying alive, the typical pattern of the engine's containers
+			Array<void*, kLiveAllocations> live = {};
+			for(U32 i = 0; i < kIterations; ++i)
+			{
+				void*& slot = live[(i * 7 + taskId) % kLiveAllocations];
+				m_pool->free(slot);
+				slot = m_pool->allocate(8 + (i * 24) % 256, 8);
+			}
+
+			for(void* ptr : live)
+			{
+				m_pool->free(ptr);
+			}
+
+			return Error::kNone;
+		}
+	};
+
+	ThreadPool threadPool(kThreadCount);
+	Array<BenchTask, kThreadCount> tasks;
+
+	auto bench = [&](Bool threadCache) {
+		HeapMemoryPool pool(allocAligned, nullptr, "Bench", threadCache);
+
+		const Second begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			tasks[i].m_pool = &pool;
+			threadPool.assignNewTask(i, &tasks[i]);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+		const Second end = HighRezTimer::getCurrentTime();
+
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		return end - begin;
+	};
+
+	const Second withoutCache = bench(false);
+	const Second withCache = bench(true);
+
+	ANKI_TEST_LOGI("%u threads x %u allocations: without thread cache %fms, with thread cache %fms", kThreadCount, kIterations, withoutCache * 1000.0,
+				   withCache * 1000.0);
+}
+
 ANKI_TEST(Util, StackMemoryPool)
 {
 	// Create/destroy test
@@ -77,6 +249,15 @@ ANKI_TEST(Util, StackMemoryPool)
 		a = pool.allocate(kSize, 1);
 		ANKI_TEST_EXPECT_NEQ(a, nullptr);
 		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 4);
+
+		// Memory usage
+		pool.reset();
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 0);
+		a = pool.allocate(kSize, 1);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), getAlignedRoundUp(ANKI_SAFE_ALIGNMENT, kSize));
+		a = pool.allocate(kSize, 1);
+		ANKI_TEST_EXPECT_GEQ(pool.getMemoryUsage(), 2 * getAlignedRoundUp(ANKI_SAFE_ALIGNMENT, kSize));
+		ANKI_TEST_EXPECT_LEQ(pool.getMemoryUsage(), pool.getMemoryCapacity());
 	}
 
 	// Parallel
@@ -157,3 +338,29 @@ ANKI_TEST(Util, StackMemoryPool)
 		}
 	}
 }
+
+ANKI_BENCH(Util, StackMemoryPoolAllocations)
+{
+	StackMemoryPool pool(allocAligned, nullptr, 1_MB);
+
+	bench.run("Allocate16x64B", [&]() {
+		for(U32 i = 0; i < 16; ++i)
+		{
+			void* ptr = pool.allocate(64, 16);
+			benchmarkDoNotOptimize(ptr);
+		}
+		pool.reset();
+	});
+
+	bench.run("AllocateFree16x64B", [&]() {
+		Array<void*, 16> ptrs;
+		for(void*& ptr : ptrs)
+		{
+			ptr = pool.allocate(64, 16);
+		}
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+	});
+}
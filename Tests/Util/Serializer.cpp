@@ -6,6 +6,7 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/Serializer.h>
 #include <Tests/Util/SerializerTest.h>
+#include <AnKi/Util/HighRezTimer.h>
 
 ANKI_TEST(Util, BinarySerializer)
 {
@@ -66,4 +67,109 @@ ANKI_TEST(Util, BinarySerializer)
 
 		deleteInstance(pool, pa);
 	}
+
+	// In place
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::kRead | FileOpenFlag::kBinary));
+		DynamicArray<U8, MemoryPoolPtrWrapper<HeapMemoryPool>, PtrSize> blob(&pool);
+		blob.resize(file.getSize());
+		ANKI_TEST_EXPECT_NO_ERR(file.read(blob.getBegin(), blob.getSize()));
+
+		// Corrupt a pointer and the size of the file
+		DynamicArray<U8, MemoryPoolPtrWrapper<HeapMemoryPool>, PtrSize> corruptBlob(&pool);
+		corruptBlob.resize(blob.getSize());
+		memcpy(corruptBlob.getBegin(), blob.getBegin(), blob.getSize());
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NEQ(BinaryDeserializer::deserializeInPlace(pa, WeakArray<U8, PtrSize>(corruptBlob.getBegin(), blob.getSize() - 1)),
+							 Error::kNone);
+		const PtrSize offsetOfDarray = offsetof(ClassA, m_darray);
+		corruptBlob[32 + offsetOfDarray] = 0xFF;
+		corruptBlob[32 + offsetOfDarray + 5] = 0xFF;
+		ANKI_TEST_EXPECT_NEQ(BinaryDeserializer::deserializeInPlace(pa, WeakArray<U8, PtrSize>(corruptBlob)), Error::kNone);
+
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(pa, WeakArray<U8, PtrSize>(blob)));
+		ANKI_TEST_EXPECT_EQ(PtrSize(pa), PtrSize(blob.getBegin() + 32));
+		ANKI_TEST_EXPECT_EQ(pa->m_u64, a.m_u64);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), a.m_darray.getSize());
+		for(U32 i = 0; i < pa->m_darray.getSize(); ++i)
+		{
+			for(U32 j = 0; j < pa->m_darray[i].m_darray.getSize(); ++j)
+			{
+				ANKI_TEST_EXPECT_EQ(pa->m_darray[i].m_darray[j], b[i].m_darray[j]);
+			}
+		}
+	}
+}
+
+ANKI_TEST(Util, BinarySerializerBenchmark)
+{
+	// Something with as many pointers as a big shader binary
+	constexpr U32 kBCount = 50000;
+	constexpr U32 kIterations = 20;
+
+	HeapMemoryPool pool(allocAligned, nullptr);
+
+	{
+		DynamicArray<ClassB, MemoryPoolPtrWrapper<HeapMemoryPool>> bs(&pool);
+		bs.resize(kBCount);
+		DynamicArray<U32, MemoryPoolPtrWrapper<HeapMemoryPool>> u32s(&pool);
+		u32s.resize(kBCount * 4);
+		for(U32 i = 0; i < kBCount; ++i)
+		{
+			bs[i] = {};
+			bs[i].m_array[0] = U8(i);
+			for(U32 j = 0; j < 4; ++j)
+			{
+				u32s[i * 4 + j] = i * 4 + j;
+			}
+			bs[i].m_darray = WeakArray<U32>(&u32s[i * 4], 4);
+		}
+
+		ClassA a = {};
+		a.m_darray = WeakArray<ClassB>(bs);
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, pool, file));
+	}
+
+	Second time = 0.0;
+	for(U32 i = 0; i < kIterations; ++i)
+	{
+		const Second begin = HighRezTimer::getCurrentTime();
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::kRead | FileOpenFlag::kBinary));
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserialize(pa, pool, file));
+
+		time += HighRezTimer::getCurrentTime() - begin;
+
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), kBCount);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[kBCount - 1].m_darray[3], kBCount * 4 - 1);
+		pool.free(pa);
+	}
+
+	Second inPlaceTime = 0.0;
+	for(U32 i = 0; i < kIterations; ++i)
+	{
+		const Second begin = HighRezTimer::getCurrentTime();
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::kRead | FileOpenFlag::kBinary));
+		U8* blob = static_cast<U8*>(pool.allocate(file.getSize(), ANKI_SAFE_ALIGNMENT));
+		ANKI_TEST_EXPECT_NO_ERR(file.read(blob, file.getSize()));
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(pa, WeakArray<U8, PtrSize>(blob, file.getSize())));
+
+		inPlaceTime += HighRezTimer::getCurrentTime() - begin;
+
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), kBCount);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[kBCount - 1].m_darray[3], kBCount * 4 - 1);
+		pool.free(blob);
+	}
+
+	ANKI_TEST_LOGI("Deserializing %u pointers: %fms, in place %fms", kBCount + 1, time / kIterations * 1000.0, inPlaceTime / kIterations * 1000.0);
 }
@@ -0,0 +1,203 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <Tests/Util/Foo.h>
+#include <AnKi/Util/SwissHashMap.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <unordered_map>
+#include <random>
+
+using namespace anki;
+
+namespace {
+
+class IdentityHasher
+{
+public:
+	U64 operator()(U64 x) const
+	{
+		return x;
+	}
+};
+
+} // end namespace
+
+ANKI_TEST(Util, SwissHashMap)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Simple
+	{
+		SwissHashMap<int, int> map;
+		ANKI_TEST_EXPECT_EQ(map.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(map.find(1), map.getEnd());
+
+		map.emplace(20, 1);
+		map.emplace(21, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(20), 1);
+		ANKI_TEST_EXPECT_EQ(*map.find(21), 2);
+
+		// Replace
+		map.emplace(20, 3);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(20), 3);
+
+		map.erase(map.find(20));
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(map.find(20), map.getEnd());
+		map.validate();
+	}
+
+	// Non trivial values, copy and move
+	{
+		SwissHashMap<U64, Foo, IdentityHasher> map;
+		for(U64 i = 0; i < 100; ++i)
+		{
+			map.emplace(i, I32(i));
+		}
+
+		SwissHashMap<U64, Foo, IdentityHasher> copy = map;
+		SwissHashMap<U64, Foo, IdentityHasher> moved = std::move(map);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 0);
+		ANKI_TEST_EXPECT_EQ(copy.getSize(), 100);
+		ANKI_TEST_EXPECT_EQ(moved.getSize(), 100);
+
+		I64 sum = 0;
+		for(const Foo& foo : copy)
+		{
+			sum += foo.x;
+		}
+		ANKI_TEST_EXPECT_EQ(sum, 99 * 100 / 2);
+
+		for(auto it = moved.getBegin(); it != moved.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(U64(it->x), it.getKey());
+		}
+	}
+	ANKI_TEST_EXPECT_EQ(Foo::constructorCallCount, Foo::destructorCallCount);
+
+	// Random operations against the STL. Use a narrow key range to force many replacements and tombstones
+	{
+		SwissHashMap<U64, U64, IdentityHasher> akMap;
+		std::unordered_map<U64, U64> stdMap;
+		std::mt19937_64 rng(123);
+
+		for(U32 i = 0; i < 200000; ++i)
+		{
+			const U64 key = rng() % 5000;
+			const U32 op = U32(rng() % 3);
+			if(op < 2)
+			{
+				akMap.emplace(key, i);
+				stdMap[key] = i;
+			}
+			else
+			{
+				auto it = akMap.find(key);
+				ANKI_TEST_EXPECT_EQ(it != akMap.getEnd(), stdMap.find(key) != stdMap.end());
+				if(it != akMap.getEnd())
+				{
+					akMap.erase(it);
+					stdMap.erase(key);
+				}
+			}
+
+			if(i % 10000 == 0)
+			{
+				akMap.validate();
+			}
+		}
+
+		akMap.validate();
+		ANKI_TEST_EXPECT_EQ(akMap.getSize(), stdMap.size());
+		for(const auto& it : stdMap)
+		{
+			auto it2 = akMap.find(it.first);
+			ANKI_TEST_EXPECT_NEQ(it2, akMap.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it2, it.second);
+		}
+
+		PtrSize count = 0;
+		for([[maybe_unused]] U64 v : akMap)
+		{
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, stdMap.size());
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+template<typename TMap>
+static void benchmarkMap(Benchmark& bench, const char* mapName)
+{
+	constexpr Array<U32, 4> kSizes = {1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024};
+
+	for(U32 size : kSizes)
+	{
+		std::mt19937_64 rng(size);
+		DynamicArray<U64> keys;
+		keys.resize(size);
+		for(U64& key : keys)
+		{
+			key = rng();
+		}
+
+		const U32 mask = size - 1;
+		char label[128];
+		auto makeLabel = [&](const char* op) {
+			snprintf(label, sizeof(label), "%s/%s/%u", mapName, op, size);
+			return label;
+		};
+
+		if(size <= 64 * 1024)
+		{
+			bench.run(makeLabel("InsertAllThenErase"), [&]() {
+				TMap map;
+				for(U64 key : keys)
+				{
+					map.emplace(key, key);
+				}
+
+				for(U64 key : keys)
+				{
+					map.erase(map.find(key));
+				}
+			});
+		}
+
+		TMap map;
+		for(U64 key : keys)
+		{
+			map.emplace(key, key);
+		}
+
+		U32 i = 0;
+		bench.run(makeLabel("FindHit"), [&]() {
+			benchmarkDoNotOptimize(*map.find(keys[i++ & mask]));
+		});
+
+		bench.run(makeLabel("FindMiss"), [&]() {
+			benchmarkDoNotOptimize(map.find(keys[i++ & mask] + 1) == map.getEnd());
+		});
+
+		bench.run(makeLabel("InsertErase"), [&]() {
+			const U64 key = keys[i++ & mask] + 1;
+			map.erase(map.emplace(key, key));
+		});
+	}
+}
+
+ANKI_BENCH(Util, SwissHashMapVsHashMap)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	benchmarkMap<HashMap<U64, U64>>(bench, "HashMap");
+	benchmarkMap<SwissHashMap<U64, U64>>(bench, "SwissHashMap");
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -69,3 +69,26 @@ ANKI_TEST(Util, ThreadJobManagerBench)
 
 	DefaultMemoryPool::freeSingleton();
 }
+
+ANKI_BENCH(Util, ThreadJobManagerDispatch)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager manager(getCpuCoresCount(), true, 256);
+		Atomic<U32> atomic(0);
+
+		bench.run("Dispatch1024EmptyTasks", [&]() {
+			for(U32 i = 0; i < 1024; ++i)
+			{
+				manager.dispatchTask([&atomic]([[maybe_unused]] U32 tid) {
+					atomic.fetchAdd(1);
+				});
+			}
+
+			manager.waitForAllTasksToFinish();
+		});
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
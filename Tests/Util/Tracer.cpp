@@ -7,6 +7,7 @@
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Core/CoreTracer.h>
 #include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/BinaryTrace.h>
 
 #if ANKI_TRACING_ENABLED
 ANKI_TEST(Util, Tracer)
@@ -55,3 +56,107 @@ ANKI_TEST(Util, Tracer)
 	CoreTracer::freeSingleton();
 }
 #endif
+
+ANKI_TEST(Util, BinaryTrace)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		class Event
+		{
+		public:
+			CString m_name;
+			Second m_start;
+			Second m_duration;
+		};
+
+		class Counter
+		{
+		public:
+			CString m_name;
+			U64 m_value;
+		};
+
+		const Array<Event, 4> events = {{{"tA", 10.0, 0.5}, {"tB", 10.25, 0.001}, {"tA", 11.0, 0.000001}, {"tC", 10.5, 2.0}}};
+		const Array<Counter, 2> counters = {{{"cA", 100}, {"cB", 1ull << 40}}};
+
+		BinaryTraceWriter writer(&DefaultMemoryPool::getSingleton());
+		writer.writeHeader();
+		writer.writeThreadEvents(123, 2, ConstWeakArray<Event>(events));
+		writer.writeCounters(2, 12.0, ConstWeakArray<Counter>(counters));
+		writer.writeDropped(3, 10, 20);
+		writer.writeThreadEvents(456, 3, ConstWeakArray<Event>(events));
+
+		class Visitor : public BinaryTraceVisitor
+		{
+		public:
+			DynamicArray<String> m_eventNames;
+			DynamicArray<U64> m_eventStarts;
+			DynamicArray<U64> m_eventDurations;
+			DynamicArray<U64> m_eventTids;
+			DynamicArray<String> m_counterNames;
+			DynamicArray<U64> m_counterValues;
+			U64 m_droppedEvents = 0;
+
+			void visitEvent(U64 tid, [[maybe_unused]] U64 frame, CString name, U64 startNs, U64 durationNs) override
+			{
+				m_eventNames.emplaceBack(name);
+				m_eventStarts.emplaceBack(startNs);
+				m_eventDurations.emplaceBack(durationNs);
+				m_eventTids.emplaceBack(tid);
+			}
+
+			void visitCounter(U64 frame, U64 timestampNs, CString name, U64 value) override
+			{
+				ANKI_TEST_EXPECT_EQ(frame, 2);
+				ANKI_TEST_EXPECT_EQ(timestampNs, 12000000000ull);
+				m_counterNames.emplaceBack(name);
+				m_counterValues.emplaceBack(value);
+			}
+
+			void visitDropped(U64 frame, U64 droppedEventCount, U64 droppedCounterCount) override
+			{
+				ANKI_TEST_EXPECT_EQ(frame, 3);
+				ANKI_TEST_EXPECT_EQ(droppedCounterCount, 20);
+				m_droppedEvents += droppedEventCount;
+			}
+		} visitor;
+
+		// Feed it in 2 parts to test the incremental decoding
+		const ConstWeakArray<U8, PtrSize> data = writer.getBuffer();
+		BinaryTraceReader reader(&DefaultMemoryPool::getSingleton());
+		const PtrSize firstPartSize = data.getSize() / 2 + 1;
+		PtrSize consumed;
+		ANKI_TEST_EXPECT_NO_ERR(reader.decode(ConstWeakArray<U8, PtrSize>(data.getBegin(), firstPartSize), visitor, consumed));
+		ANKI_TEST_EXPECT_LEQ(consumed, firstPartSize);
+		const PtrSize firstConsumed = consumed;
+		ANKI_TEST_EXPECT_NO_ERR(reader.decode(ConstWeakArray<U8, PtrSize>(data.getBegin() + consumed, data.getSize() - consumed), visitor, consumed));
+		ANKI_TEST_EXPECT_EQ(firstConsumed + consumed, data.getSize());
+
+		ANKI_TEST_EXPECT_EQ(visitor.m_eventNames.getSize(), 8);
+		for(U32 i = 0; i < visitor.m_eventNames.getSize(); ++i)
+		{
+			const Event& e = events[i % events.getSize()];
+			ANKI_TEST_EXPECT_EQ(visitor.m_eventNames[i], e.m_name);
+			ANKI_TEST_EXPECT_EQ(visitor.m_eventStarts[i], U64(e.m_start * 1000000000.0));
+			ANKI_TEST_EXPECT_EQ(visitor.m_eventDurations[i], U64(e.m_duration * 1000000000.0));
+			ANKI_TEST_EXPECT_EQ(visitor.m_eventTids[i], (i < events.getSize()) ? 123 : 456);
+		}
+
+		ANKI_TEST_EXPECT_EQ(visitor.m_counterNames.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(visitor.m_counterNames[0], "cA");
+		ANKI_TEST_EXPECT_EQ(visitor.m_counterValues[1], 1ull << 40);
+		ANKI_TEST_EXPECT_EQ(visitor.m_droppedEvents, 10);
+
+		// Strings are interned so the 2nd block should be smaller than the 1st
+		writer.resetBuffer();
+		writer.writeThreadEvents(456, 4, ConstWeakArray<Event>(events));
+		const PtrSize secondBlockSize = writer.getBuffer().getSize();
+		writer.resetStrings();
+		writer.resetBuffer();
+		writer.writeThreadEvents(456, 4, ConstWeakArray<Event>(events));
+		ANKI_TEST_EXPECT_LT(secondBlockSize, writer.getBuffer().getSize());
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/python3
+
+# Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+# All rights reserved.
+# Code licensed under the BSD License.
+# http://www.anki3d.org/LICENSE
+
+import argparse
+import json
+import sys
+
+
+def parse_commandline():
+    """ Parse the command line arguments """
+    parser = argparse.ArgumentParser(description="Compare the JSON output of two runs of \"Tests --benchmarks --bench-json <file>\"",
+                                     formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+    parser.add_argument("baseline", help="The JSON file with the baseline results")
+    parser.add_argument("current", help="The JSON file with the new results")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="A median that is slower than the baseline by more than this percentage is a regression")
+    parser.add_argument("-m", "--metric", default="median_ns", choices=["min_ns", "median_ns", "p99_ns", "mean_ns"],
+                        help="The value to compare")
+
+    return parser.parse_args()
+
+
+def load_results(filename):
+    """ Load a JSON file and return a dictionary of results keyed by suite/name/label """
+    with open(filename, "r") as f:
+        data = json.load(f)
+
+    results = {}
+    for bench in data["benchmarks"]:
+        key = "%s/%s/%s" % (bench["suite"], bench["name"], bench["label"])
+        results[key] = bench
+
+    return results
+
+
+def main():
+    args = parse_commandline()
+
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+
+    regression_count = 0
+    print("%-64s %14s %14s %9s" % ("Benchmark", "Baseline", "Current", "Diff"))
+    for key, bench in current.items():
+        if key not in baseline:
+            print("%-64s %14s %12.2fns %9s" % (key, "-", bench[args.metric], "new"))
+            continue
+
+        old = baseline[key][args.metric]
+        new = bench[args.metric]
+        diff = (new - old) / old * 100.0 if old > 0.0 else 0.0
+
+        status = ""
+        if diff > args.threshold:
+            status = " REGRESSION"
+            regression_count += 1
+        elif diff < -args.threshold:
+            status = " improvement"
+
+        print("%-64s %12.2fns %12.2fns %+8.1f%%%s" % (key, old, new, diff, status))
+
+    for key in baseline:
+        if key not in current:
+            print("%-64s %12.2fns %14s %9s" % (key, baseline[key][args.metric], "-", "missing"))
+
+    if regression_count > 0:
+        print("%d regression(s) over %.1f%%" % (regression_count, args.threshold))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
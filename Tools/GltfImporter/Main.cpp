@@ -18,6 +18,7 @@ Options:
 -lod-factor <float>        : The decimate factor for each LOD. Default 0.25
 -light-scale <float>       : Multiply the light intensity with this number. Default is 1.0
 -import-textures <0|1>     : Import textures. Default is 0
+-stats                     : Print the time spent in each stage of the import
 -v                         : Enable verbose log
 )";
 
@@ -31,6 +32,7 @@ public:
 	Bool m_optimizeMeshes = true;
 	Bool m_optimizeAnimations = true;
 	Bool m_importTextures = false;
+	Bool m_printStats = false;
 	U32 m_threadCount = kMaxU32;
 	U32 m_lodCount = 1;
 	F32 m_lodFactor = 0.25f;
@@ -78,6 +80,10 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 		{
 			Logger::getSingleton().enableVerbosity(true);
 		}
+		else if(strcmp(argv[i], "-stats") == 0)
+		{
+			info.m_printStats = true;
+		}
 		else if(strcmp(argv[i], "-rpath") == 0)
 		{
 			rpathFound = true;
@@ -285,5 +291,20 @@ int myMain(int argc, char** argv)
 
 	ANKI_IMPORTER_LOGI("File written: %s", cmdArgs.m_inputFname.cstr());
 
+	if(cmdArgs.m_printStats)
+	{
+		static constexpr Array<const char*, U32(GltfImporterStage::kCount)> kStageNames = {"Mesh load", "Mesh optimize", "Mesh decimate",
+																						   "Mesh meshletize", "Mesh write"};
+
+		// The stages run in parallel so their sum can be more than the total
+		const GltfImporterStats stats = importer.getStats();
+		ANKI_IMPORTER_LOGI("Import stats (thread time):");
+		for(GltfImporterStage stage : EnumIterable<GltfImporterStage>())
+		{
+			ANKI_IMPORTER_LOGI("  %-16s: %.3fs", kStageNames[stage], stats.m_stageTimes[stage]);
+		}
+		ANKI_IMPORTER_LOGI("Total time (wall time): %.3fs", stats.m_totalTime);
+	}
+
 	return 0;
 }
@@ -0,0 +1,276 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/BinaryTrace.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Logger.h>
+#if ANKI_POSIX
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#	include <cerrno>
+#	include <cstring>
+#endif
+
+using namespace anki;
+
+static const char* kUsage = R"(Convert a binary trace (.ankitrace) to the Chrome/Perfetto JSON format
+Usage: %s [options] input output
+Options:
+-listen : The input is a socket path. Wait for the engine to connect (TracingStreamSocket CVar) and convert the trace live. It also prints
+          a summary of every frame to stdout
+)";
+
+/// Writes the decoded data as Chrome's trace event format.
+class JsonTraceVisitor : public BinaryTraceVisitor
+{
+public:
+	File m_file;
+	Error m_err = Error::kNone;
+
+	Bool m_printFrameSummary = false;
+	U64 m_currentFrame = kMaxU64;
+	U64 m_currentFrameEventCount = 0;
+	U64 m_currentFrameDroppedCount = 0;
+
+	void visitEvent(U64 tid, U64 frame, CString name, U64 startNs, U64 durationNs) override
+	{
+		beginFrame(frame);
+		++m_currentFrameEventCount;
+
+		write(m_file.writeTextf("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", \"pid\": 1, \"tid\": %" PRIu64 ", \"ts\": %f, \"dur\": %f},\n",
+								name.cstr(), tid, F64(startNs) / 1000.0, F64(durationNs) / 1000.0));
+	}
+
+	void visitCounter(U64 frame, U64 timestampNs, CString name, U64 value) override
+	{
+		beginFrame(frame);
+
+		write(m_file.writeTextf("{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"ts\": %f, \"args\": {\"value\": %" PRIu64 "}},\n", name.cstr(),
+								F64(timestampNs) / 1000.0, value));
+	}
+
+	void visitDropped(U64 frame, U64 droppedEventCount, U64 droppedCounterCount) override
+	{
+		beginFrame(frame);
+		m_currentFrameDroppedCount += droppedEventCount;
+
+		ANKI_LOGW("Frame %" PRIu64 ": The engine dropped %" PRIu64 " events and %" PRIu64 " counters", frame, droppedEventCount, droppedCounterCount);
+	}
+
+	void endFrame()
+	{
+		if(m_printFrameSummary && m_currentFrame != kMaxU64)
+		{
+			printf("Frame %" PRIu64 ": %" PRIu64 " events, %" PRIu64 " dropped\n", m_currentFrame, m_currentFrameEventCount,
+				   m_currentFrameDroppedCount);
+			fflush(stdout);
+		}
+
+		m_currentFrameEventCount = 0;
+		m_currentFrameDroppedCount = 0;
+	}
+
+private:
+	void beginFrame(U64 frame)
+	{
+		if(frame != m_currentFrame)
+		{
+			endFrame();
+			m_currentFrame = frame;
+		}
+	}
+
+	void write(Error err)
+	{
+		if(err && !m_err)
+		{
+			m_err = err;
+		}
+	}
+};
+
+static Error convertFile(CString inFilename, JsonTraceVisitor& visitor)
+{
+	File inFile;
+	ANKI_CHECK(inFile.open(inFilename, FileOpenFlag::kRead | FileOpenFlag::kBinary));
+
+	DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> data;
+	data.resize(inFile.getSize());
+	if(data.getSize())
+	{
+		ANKI_CHECK(inFile.read(&data[0], data.getSize()));
+	}
+
+	BinaryTraceReader reader(&DefaultMemoryPool::getSingleton());
+	PtrSize bytesConsumed;
+	ANKI_CHECK(reader.decode(ConstWeakArray<U8, PtrSize>(data), visitor, bytesConsumed));
+
+	if(bytesConsumed != data.getSize())
+	{
+		ANKI_LOGW("The trace is truncated. %zu bytes got ignored", data.getSize() - bytesConsumed);
+	}
+
+	return visitor.m_err;
+}
+
+#if ANKI_POSIX
+static Error convertStream(CString socketPath, JsonTraceVisitor& visitor)
+{
+	sockaddr_un addr = {};
+	if(socketPath.getLength() >= sizeof(addr.sun_path))
+	{
+		ANKI_LOGE("Socket path too long");
+		return Error::kUserData;
+	}
+
+	const int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listenSocket < 0)
+	{
+		ANKI_LOGE("socket() failed: %s", strerror(errno));
+		return Error::kFunctionFailed;
+	}
+
+	class SocketCleanup
+	{
+	public:
+		int m_listenSocket;
+		int m_socket = -1;
+		CString m_path;
+
+		~SocketCleanup()
+		{
+			if(m_socket >= 0)
+			{
+				close(m_socket);
+			}
+			close(m_listenSocket);
+			unlink(m_path.cstr());
+		}
+	} cleanup{listenSocket, -1, socketPath};
+
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, socketPath.cstr(), socketPath.getLength() + 1);
+	unlink(socketPath.cstr());
+	if(bind(listenSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenSocket, 1) != 0)
+	{
+		ANKI_LOGE("Failed to listen to %s: %s", socketPath.cstr(), strerror(errno));
+		return Error::kFunctionFailed;
+	}
+
+	ANKI_LOGI("Waiting for the engine to connect to %s", socketPath.cstr());
+	cleanup.m_socket = accept(listenSocket, nullptr, nullptr);
+	if(cleanup.m_socket < 0)
+	{
+		ANKI_LOGE("accept() failed: %s", strerror(errno));
+		return Error::kFunctionFailed;
+	}
+
+	ANKI_LOGI("Engine connected");
+
+	BinaryTraceReader reader(&DefaultMemoryPool::getSingleton());
+	DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> data;
+	data.resize(1_MB);
+	PtrSize dataSize = 0;
+
+	while(true)
+	{
+		if(dataSize == data.getSize())
+		{
+			// A huge record, grow
+			data.resize(data.getSize() * 2);
+		}
+
+		const ssize_t received = recv(cleanup.m_socket, &data[dataSize], data.getSize() - dataSize, 0);
+		if(received < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else if(received <= 0)
+		{
+			break;
+		}
+
+		dataSize += PtrSize(received);
+
+		PtrSize bytesConsumed;
+		ANKI_CHECK(reader.decode(ConstWeakArray<U8, PtrSize>(&data[0], dataSize), visitor, bytesConsumed));
+		ANKI_CHECK(visitor.m_err);
+
+		// Keep the incomplete record for the next iteration
+		memmove(&data[0], &data[bytesConsumed], dataSize - bytesConsumed);
+		dataSize -= bytesConsumed;
+
+		ANKI_CHECK(visitor.m_file.flush());
+	}
+
+	ANKI_LOGI("Engine disconnected");
+	return Error::kNone;
+}
+#endif
+
+static Error convert(CString in, CString out, Bool listen)
+{
+	JsonTraceVisitor visitor;
+	ANKI_CHECK(visitor.m_file.open(out, FileOpenFlag::kWrite));
+	ANKI_CHECK(visitor.m_file.writeText("[\n"));
+
+	if(listen)
+	{
+#if ANKI_POSIX
+		visitor.m_printFrameSummary = true;
+		ANKI_CHECK(convertStream(in, visitor));
+#else
+		ANKI_LOGE("Listening is not supported on this platform");
+		return Error::kFunctionFailed;
+#endif
+	}
+	else
+	{
+		ANKI_CHECK(convertFile(in, visitor));
+	}
+
+	visitor.endFrame();
+	ANKI_CHECK(visitor.m_file.writeText("{}\n]\n"));
+
+	return Error::kNone;
+}
+
+ANKI_MAIN_FUNCTION(myMain)
+int myMain(int argc, char** argv)
+{
+	class Dummy
+	{
+	public:
+		~Dummy()
+		{
+			DefaultMemoryPool::freeSingleton();
+		}
+	} dummy;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	Bool listen = false;
+	I32 argIdx = 1;
+	if(argc > 1 && CString(argv[1]) == "-listen")
+	{
+		listen = true;
+		++argIdx;
+	}
+
+	if(argc - argIdx != 2)
+	{
+		ANKI_LOGE(kUsage, argv[0]);
+		return 1;
+	}
+
+	if(convert(argv[argIdx], argv[argIdx + 1], listen))
+	{
+		ANKI_LOGE("Conversion failed");
+		return 1;
+	}
+
+	return 0;
+}
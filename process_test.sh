@@ -0,0 +1,5 @@
+#!/bin/bash
+
+echo Hello from script
+exit 6
+